@@ -98,6 +98,22 @@ extern "C" {
  * To force repainting of one or more items, when the underlying data change,
  * the application is supposed to use the message @ref MC_GM_REDRAWCELLS.
  *
+ * If even a single retrieval of the data may take long (e.g. a query to a
+ * remote server), the application can install an asynchronous data provider
+ * with the message @ref MC_GM_SETDATAPROVIDER. The control then keeps its own
+ * cache of the cell data (with the least recently used cells being dropped
+ * when it is full) and fills it from a worker thread, by calling the
+ * provider's callback for the visible cells and also for cells around them,
+ * ahead of scrolling. Painting never waits for the data: Cells which are not
+ * in the cache yet are painted empty and they are repainted as soon as their
+ * data arrive. @ref MC_GM_REDRAWCELLS also drops the cells from the cache.
+ * (The control still sends @ref MC_GN_GETDISPINFO when it needs the data
+ * immediately, e.g. when starting the label editing.)
+ *
+ * The messages and notifications of the control address the rows with 16-bit
+ * indexes, so the virtual table may have up to 65534 rows that way. Larger
+ * virtual tables are described in @ref grid_large.
+ *
  * Please remember that when the style @ref MC_GS_OWNERDATA is used, some
  * control messages and styles behave differently:
  *
@@ -113,6 +129,58 @@ extern "C" {
  *   actually does what @ref MC_GS_NOTABLECREATE and much more).
  *
  *
+ * @section grid_large Large Grids
+ *
+ * The table (or, with the style @ref MC_GS_OWNERDATA, the virtual table) may
+ * have many more rows than 65534 (e.g. when presenting a log with millions of
+ * records). The application then has to set the size of the table with @ref
+ * MC_GM_RESIZEEX instead of @ref MC_GM_RESIZE (or with @ref mcTable_ResizeEx
+ * if it manipulates the table directly). The number of rows is limited
+ * only by the requirement that the total height of all the rows (in pixels)
+ * must fit into @c INT_MAX. The number of columns is still limited to 65534.
+ *
+ * The cells of such table cannot be all addressed by @ref MC_GM_SETCELL and
+ * @ref MC_GM_GETCELL. The application has to use @ref mcTable_SetCellEx and
+ * @ref mcTable_GetCellEx on the table (see @ref MC_GM_GETTABLE) instead.
+ *
+ * @ref MC_GM_RESIZEEX also switches the control to the extended mode, where
+ * it identifies the rows with 32-bit indexes. (The control switches to it
+ * also when its table grows to more than 65534 rows, or when such table is
+ * installed with @ref MC_GM_SETTABLE.)
+ *
+ * - The control sends the extended variants of the notifications which refer
+ *   to a cell or a row: @ref MC_GN_GETDISPINFOEX, @ref MC_GN_SETDISPINFOEX,
+ *   @ref MC_GN_ODCACHEHINTEX, @ref MC_GN_FOCUSEDCELLCHANGINGEX, @ref
+ *   MC_GN_FOCUSEDCELLCHANGEDEX, @ref MC_GN_SELECTIONCHANGINGEX, @ref
+ *   MC_GN_SELECTIONCHANGEDEX, @ref MC_GN_BEGINLABELEDITEX, @ref
+ *   MC_GN_ENDLABELEDITEX, @ref MC_GN_BEGINROWTRACKEX, @ref
+ *   MC_GN_ENDROWTRACKEX, @ref MC_GN_ROWHEIGHTCHANGINGEX and @ref
+ *   MC_GN_ROWHEIGHTCHANGEDEX. They are sent instead of the respective
+ *   notifications without the @c EX suffix.
+ *
+ * - The application should use the extended variants of the messages which
+ *   refer to a cell or a row: @ref MC_GM_REDRAWCELLSEX, @ref MC_GM_HITTESTEX,
+ *   @ref MC_GM_GETCELLRECTEX, @ref MC_GM_ENSUREVISIBLEEX, @ref
+ *   MC_GM_SETFOCUSEDCELLEX, @ref MC_GM_GETFOCUSEDCELLEX, @ref
+ *   MC_GM_SETSELECTIONEX, @ref MC_GM_GETSELECTIONEX and @ref
+ *   MC_GM_EDITLABELEX. The messages @ref MC_GM_GETROWCOUNT, @ref
+ *   MC_GM_SETROWHEIGHT and @ref MC_GM_GETROWHEIGHT take or return the
+ *   32-bit row index in the extended mode.
+ *
+ * - Header cells are addressed with @ref MC_GHEADEREX instead of @ref
+ *   MC_TABLE_HEADER in the extended messages and notifications.
+ *
+ * - In the notification @c NM_CUSTOMDRAW, the cell is identified by @ref
+ *   MC_NMGCUSTOMDRAW::dwColumn and @ref MC_NMGCUSTOMDRAW::dwRow.
+ *
+ * The asynchronous data provider (see @ref MC_GM_SETDATAPROVIDER) always gets
+ * the extended structure @ref MC_NMGDISPINFOEX. Painting does not depend on
+ * the number of rows (it only computes which rows are visible), so scrolling
+ * through a large virtual table is as fast as through a small one.
+ *
+ * @ref MC_GM_RESIZE switches the control back to the normal mode.
+ *
+ *
  * @section grid_header Column and Row Headers
  *
  * The application can manipulate also with headers of columns and rows. For
@@ -130,6 +198,30 @@ extern "C" {
  * indexes is set to @ref MC_TABLE_HEADER.
  *
  *
+ * @section grid_sort Sorting and Filtering
+ *
+ * The control can present rows of its table sorted and/or with some of the
+ * rows hidden, without changing the table itself. Use the message
+ * @ref MC_GM_SORT to sort the rows by one or more columns, and the message
+ * @ref MC_GM_SHOWROW to hide or show a row.
+ *
+ * The control then keeps only an index of the rows to present, so even
+ * re-ordering a large table does not copy any data. When a cell in a column
+ * the rows are sorted by changes, the control just moves the row to its new
+ * place.
+ *
+ * Note that all the other messages and notifications then address the rows
+ * as they are presented by the control (this includes also @ref
+ * MC_GM_SETCELL and @ref MC_GM_GETCELL), while @ref MC_HTABLE functions
+ * address the rows of the table. Use @ref MC_GM_GETTABLEROW and @ref
+ * MC_GM_GETVIEWROW to translate between the two. Also note the focused cell,
+ * the selection, and row heights stay on the presented positions when the
+ * rows get re-ordered.
+ *
+ * Sorting and filtering is not supported with the style @ref
+ * MC_GS_OWNERDATA. Installing another table resets it.
+ *
+ *
  * @section grid_selection Selection
  *
  * The grid control supports four distinct selection modes. These modes
@@ -391,6 +483,31 @@ void MCTRL_API mcGrid_Terminate(void);
 /*@}*/
 
 
+/**
+ * @name Miscellaneous Constants
+ */
+/*@{*/
+
+/** @brief Index of the header column or row in the extended messages and
+ *  notifications. (It corresponds to @ref MC_TABLE_HEADER.)
+ *  @details See @ref grid_large for more info. */
+#define MC_GHEADEREX                ((DWORD) 0xffffffff)
+
+/*@}*/
+
+
+/**
+ * @name MC_GSORTKEY::dwFlags Bits
+ * @anchor MC_GSKF_xxxx
+ */
+/*@{*/
+
+/** @brief Sort in the descending order. (Empty cells go last anyway.) */
+#define MC_GSKF_DESCENDING          0x00000001
+
+/*@}*/
+
+
 /**
  * @name Structures
  */
@@ -414,6 +531,25 @@ typedef struct MC_GRECT_tag {
     WORD wRowTo;
 } MC_GRECT;
 
+/**
+ * @brief A miscellaneous structure determining a rectangular area in the grid
+ * (extended variant).
+ *
+ * Same as @ref MC_GRECT but with 32-bit members.
+ *
+ * @sa grid_large
+ */
+typedef struct MC_GRECTEX_tag {
+    /** The left column coordinate. */
+    DWORD dwColumnFrom;
+    /** The top row coordinate. */
+    DWORD dwRowFrom;
+    /** The right column coordinate. */
+    DWORD dwColumnTo;
+    /** The bottom row coordinate. */
+    DWORD dwRowTo;
+} MC_GRECTEX;
+
 /**
  * @brief Structure describing inner geometry of the grid.
  * @sa MC_GM_SETGEOMETRY MC_GM_GETGEOMETRY
@@ -449,6 +585,21 @@ typedef struct MC_GHITTESTINFO_tag {
     WORD wRow;
 } MC_GHITTESTINFO;
 
+/**
+ * @brief Structure for message @ref MC_GM_HITTESTEX.
+ * @sa grid_large
+ */
+typedef struct MC_GHITTESTINFOEX_tag {
+    /** Client coordinate of the point to test. */
+    POINT pt;
+    /** Flag receiving detail about result of the test. See @ref MC_GHT_xxxx */
+    UINT flags;
+    /** Column index of the cell that occupies the point. */
+    DWORD dwColumn;
+    /** Row index of the cell that occupies the point. */
+    DWORD dwRow;
+} MC_GHITTESTINFOEX;
+
 /**
  * @brief Structure describing a selection.
  *
@@ -490,6 +641,35 @@ typedef struct MC_GSELECTION_tag {
     MC_GRECT* rcData;
 } MC_GSELECTION;
 
+/**
+ * @brief Structure describing a selection (extended variant).
+ *
+ * Same as @ref MC_GSELECTION, but the rectangles have 32-bit members.
+ *
+ * @sa MC_GM_SETSELECTIONEX MC_GM_GETSELECTIONEX
+ * @sa MC_GN_SELECTIONCHANGINGEX MC_GN_SELECTIONCHANGEDEX
+ */
+typedef struct MC_GSELECTIONEX_tag {
+    /** Extents rectangle of the selection. This member is ignored on input. */
+    MC_GRECTEX rcExtents;
+    /** Count of rectangles in the @c rcData array. */
+    UINT uDataCount;
+    /** Pointer to array (of @c uCount members) of rectangles describing the
+     *  selection. */
+    MC_GRECTEX* rcData;
+} MC_GSELECTIONEX;
+
+/**
+ * @brief Structure describing a sort key.
+ * @sa MC_GM_SORT
+ */
+typedef struct MC_GSORTKEY_tag {
+    /** Column to sort by. */
+    WORD wColumn;
+    /** Flags. See @ref MC_GSKF_xxxx. */
+    DWORD dwFlags;
+} MC_GSORTKEY;
+
 /**
  * @brief Structure used by notification @ref MC_GN_ODCACHEHINT.
  */
@@ -506,6 +686,22 @@ typedef struct MC_NMGCACHEHINT_tag {
     WORD wRowTo;
 } MC_NMGCACHEHINT;
 
+/**
+ * @brief Structure used by notification @ref MC_GN_ODCACHEHINTEX.
+ */
+typedef struct MC_NMGCACHEHINTEX_tag {
+    /** Common notification structure header. */
+    NMHDR hdr;
+    /** First column of the region to be cached. */
+    DWORD dwColumnFrom;
+    /** First row of the region to be cached. */
+    DWORD dwRowFrom;
+    /** Last column of the region to be cached. */
+    DWORD dwColumnTo;
+    /** Last row of the region to be cached. */
+    DWORD dwRowTo;
+} MC_NMGCACHEHINTEX;
+
 /**
  * @brief Structure used by the standard notification @c NM_CUSTOMDRAW.
  */
@@ -519,6 +715,13 @@ typedef struct MC_NMGCUSTOMDRAW_tag {
     COLORREF clrText;
     /** Item background color. */
     COLORREF clrTextBk;
+    /** Column index (for the draw stages related to a cell). Unlike
+     *  @c nmcd.dwItemSpec, it is not limited to 16 bits. */
+    DWORD dwColumn;
+    /** Row index (for the draw stages related to a cell). Unlike
+     *  @c nmcd.dwItemSpec, it is not limited to 16 bits. For header cells,
+     *  @c dwColumn or @c dwRow is @ref MC_GHEADEREX. */
+    DWORD dwRow;
 } MC_NMGCUSTOMDRAW;
 
 /**
@@ -551,6 +754,40 @@ typedef struct MC_NMGDISPINFOA_tag {
     MC_TABLECELLA cell;
 } MC_NMGDISPINFOA;
 
+/**
+ * @brief Structure used by notifications @ref MC_GN_GETDISPINFOEX and
+ * @ref MC_GN_SETDISPINFOEX (Unicode variant).
+ *
+ * @sa grid_large
+ */
+typedef struct MC_NMGDISPINFOEXW_tag {
+    /** Common notification structure header. */
+    NMHDR hdr;
+    /** Column index. */
+    DWORD dwColumn;
+    /** Row index. */
+    DWORD dwRow;
+    /** Structure describing the contents of the cell. */
+    MC_TABLECELLW cell;
+} MC_NMGDISPINFOEXW;
+
+/**
+ * @brief Structure used by notifications @ref MC_GN_GETDISPINFOEX and
+ * @ref MC_GN_SETDISPINFOEX (ANSI variant).
+ *
+ * @sa grid_large
+ */
+typedef struct MC_NMGDISPINFOEXA_tag {
+    /** Common notification structure header. */
+    NMHDR hdr;
+    /** Column index. */
+    DWORD dwColumn;
+    /** Row index. */
+    DWORD dwRow;
+    /** Structure describing the contents of the cell. */
+    MC_TABLECELLA cell;
+} MC_NMGDISPINFOEXA;
+
 /**
  * @brief Structure used by notifications related to resizing of column and
  * headers.
@@ -571,6 +808,22 @@ typedef struct MC_NMGCOLROWSIZECHANGE_tag {
     WORD wWidthOrHeight;
 } MC_NMGCOLROWSIZECHANGE;
 
+/**
+ * @brief Structure used by the extended notifications related to resizing of
+ * rows.
+ *
+ * @sa MC_GN_BEGINROWTRACKEX MC_GN_ENDROWTRACKEX
+ * @sa MC_GN_ROWHEIGHTCHANGINGEX MC_GN_ROWHEIGHTCHANGEDEX
+ */
+typedef struct MC_NMGCOLROWSIZECHANGEEX_tag {
+    /** Common notification structure header. */
+    NMHDR hdr;
+    /** Row index. */
+    DWORD dwColumnOrRow;
+    /** Row height. */
+    WORD wWidthOrHeight;
+} MC_NMGCOLROWSIZECHANGEEX;
+
 /**
  * @brief Structure used by notifications related to focused cell.
  *
@@ -589,6 +842,25 @@ typedef struct MC_NMGFOCUSEDCELLCHANGE_tag {
     WORD wNewRow;
 } MC_NMGFOCUSEDCELLCHANGE;
 
+/**
+ * @brief Structure used by the extended notifications related to focused
+ * cell.
+ *
+ * @sa MC_GN_FOCUSEDCELLCHANGINGEX MC_GN_FOCUSEDCELLCHANGEDEX
+ */
+typedef struct MC_NMGFOCUSEDCELLCHANGEEX_tag {
+    /** Common notification structure header. */
+    NMHDR hdr;
+    /** Column of old focused cell. */
+    DWORD dwOldColumn;
+    /** Row of old focused cell. */
+    DWORD dwOldRow;
+    /** Column of new focused cell. */
+    DWORD dwNewColumn;
+    /** Row of new focused cell. */
+    DWORD dwNewRow;
+} MC_NMGFOCUSEDCELLCHANGEEX;
+
 /**
  * @brief  Structure used by notifications related to selection change.
  *
@@ -603,6 +875,77 @@ typedef struct MC_NMGSELECTIONCHANGE_tag {
     MC_GSELECTION newSelection;
 } MC_NMGSELECTIONCHANGE;
 
+/**
+ * @brief  Structure used by the extended notifications related to selection
+ * change.
+ *
+ * @sa MC_GN_SELECTIONCHANGINGEX MC_GN_SELECTIONCHANGEDEX
+ */
+typedef struct MC_NMGSELECTIONCHANGEEX_tag {
+    /** Common notification structure header. */
+    NMHDR hdr;
+    /** Old selection description. */
+    MC_GSELECTIONEX oldSelection;
+    /** New selection description. */
+    MC_GSELECTIONEX newSelection;
+} MC_NMGSELECTIONCHANGEEX;
+
+/**
+ * @brief Callback of an asynchronous data provider (Unicode variant).
+ *
+ * The callback is called on a worker thread of the control, so it must be
+ * thread-safe. It must not send any messages to the control or to its parent
+ * window (it may only post them).
+ *
+ * The control sets @c pDispInfo in the same way as for the notification
+ * @ref MC_GN_GETDISPINFOEX, asking for @ref MC_TCMF_TEXT and @ref
+ * MC_TCMF_FLAGS. (The extended structure is used regardless whether the
+ * control is in the extended mode, see @ref grid_large.) The text set by the
+ * callback has to stay valid only until the callback returns (the control
+ * makes its own copy).
+ *
+ * @param pDispInfo The cell to retrieve and the data to be set.
+ * @param pContext The context as specified in @ref MC_GDATAPROVIDERW.
+ * @return @c TRUE if the data have been retrieved, @c FALSE otherwise (then
+ * the cell is painted empty until it is asked for again).
+ */
+typedef BOOL (CALLBACK* MC_GDATAPROCW)(MC_NMGDISPINFOEXW* pDispInfo, void* pContext);
+
+/**
+ * @brief Callback of an asynchronous data provider (ANSI variant).
+ *
+ * @sa MC_GDATAPROCW
+ */
+typedef BOOL (CALLBACK* MC_GDATAPROCA)(MC_NMGDISPINFOEXA* pDispInfo, void* pContext);
+
+/**
+ * @brief Structure describing asynchronous data provider (Unicode variant).
+ *
+ * @sa MC_GM_SETDATAPROVIDERW
+ */
+typedef struct MC_GDATAPROVIDERW_tag {
+    /** The callback retrieving data of a cell. */
+    MC_GDATAPROCW pfnGetData;
+    /** Context passed into the callback. */
+    void* pContext;
+    /** Count of cells the control may cache. Set to zero for a default. */
+    UINT uCacheSize;
+} MC_GDATAPROVIDERW;
+
+/**
+ * @brief Structure describing asynchronous data provider (ANSI variant).
+ *
+ * @sa MC_GM_SETDATAPROVIDERA
+ */
+typedef struct MC_GDATAPROVIDERA_tag {
+    /** The callback retrieving data of a cell. */
+    MC_GDATAPROCA pfnGetData;
+    /** Context passed into the callback. */
+    void* pContext;
+    /** Count of cells the control may cache. Set to zero for a default. */
+    UINT uCacheSize;
+} MC_GDATAPROVIDERA;
+
 /*@}*/
 
 
@@ -655,7 +998,8 @@ typedef struct MC_NMGSELECTIONCHANGE_tag {
  *
  * @param wParam Reserved, set to zero.
  * @param lParam Reserved, set to zero.
- * @return (@c WORD) Returns count of table rows.
+ * @return (@c WORD) Returns count of table rows. In the extended mode (see
+ * @ref grid_large), the return value is a @c DWORD.
  */
 #define MC_GM_GETROWCOUNT         (MC_GM_FIRST + 3)
 
@@ -808,7 +1152,8 @@ typedef struct MC_NMGSELECTIONCHANGE_tag {
  * Note this message can set only height of an ordinary grid row.
  * To change the height of column headers, use @ref MC_GM_SETGEOMETRY.
  *
- * @param[in] wParam (@c WORD) Index of the row.
+ * @param[in] wParam (@c WORD) Index of the row. In the extended mode (see
+ * @ref grid_large), it is a @c DWORD.
  * @param[in] lParam (@c DWORD) Set low word to the desired height in pixels,
  * high word to zero.
  * @return (@c BOOL) @c TRUE on success, @c FALSE on failure.
@@ -818,7 +1163,8 @@ typedef struct MC_NMGSELECTIONCHANGE_tag {
 /**
  * @brief Get height of specified row.
  *
- * @param[in] wParam (@c WORD) Index of the row.
+ * @param[in] wParam (@c WORD) Index of the row. In the extended mode (see
+ * @ref grid_large), it is a @c DWORD.
  * @param lParam Reserved, set to zero.
  * @return (@c LRESULT) If the message fails, the return value is @c -1.
  * On success, low word is the height in pixels, high word is reserved for
@@ -945,6 +1291,203 @@ typedef struct MC_NMGSELECTIONCHANGE_tag {
  */
 #define MC_GM_CANCELEDITLABEL     (MC_GM_FIRST + 26)
 
+/**
+ * @brief Sort the presented rows.
+ *
+ * The rows are sorted by the first key; rows equal in it by the second key
+ * and so on. Rows equal in all the keys keep their order from the table.
+ * Columns of the type @ref MC_TCT_TEXT are compared as texts, while columns
+ * of the numeric types are compared by their values. Columns of the type
+ * @ref MC_TCT_CALLBACK cannot be sorted by.
+ *
+ * The order is then maintained when the cells change. If a column the rows
+ * are sorted by gets removed, its key is dropped.
+ *
+ * @param[in] wParam (@c UINT) Count of the keys. Zero means the rows are
+ * presented in the table order.
+ * @param[in] lParam (@ref MC_GSORTKEY*) Pointer to an array of the keys.
+ * @return (@c BOOL) @c TRUE on success, @c FALSE otherwise.
+ * @sa grid_sort
+ */
+#define MC_GM_SORT                (MC_GM_FIRST + 27)
+
+/**
+ * @brief Hide or show a row.
+ * @param[in] wParam (@c WORD) The table row index, or @ref MC_TABLE_HEADER
+ * to hide or show all rows.
+ * @param[in] lParam (@c BOOL) @c TRUE to show the row, @c FALSE to hide it.
+ * @return (@c BOOL) @c TRUE on success, @c FALSE otherwise.
+ * @sa grid_sort
+ */
+#define MC_GM_SHOWROW             (MC_GM_FIRST + 28)
+
+/**
+ * @brief Get index of the table row presented on the given row.
+ * @param[in] wParam (@c WORD) Index of the row as presented by the control.
+ * @param lParam Reserved, set to zero.
+ * @return (@c WORD) The table row index, or @c (WORD)-1 if there is no such
+ * row.
+ * @sa grid_sort
+ */
+#define MC_GM_GETTABLEROW         (MC_GM_FIRST + 29)
+
+/**
+ * @brief Get index of the row where the given table row is presented.
+ * @param[in] wParam (@c WORD) The table row index.
+ * @param lParam Reserved, set to zero.
+ * @return (@c WORD) Index of the row as presented by the control, or
+ * @c (WORD)-1 if the row is hidden (or does not exist).
+ * @sa grid_sort
+ */
+#define MC_GM_GETVIEWROW          (MC_GM_FIRST + 30)
+
+/**
+ * @brief Installs an asynchronous data provider (Unicode variant).
+ *
+ * The message is supported only when the control has the style @ref
+ * MC_GS_OWNERDATA. Any previously installed provider is uninstalled (the
+ * control waits until its callback returns, if it is just running) and the
+ * cache of the cell data is reset. Changing the style @ref MC_GS_OWNERDATA
+ * uninstalls the provider too.
+ *
+ * @param wParam Reserved, set to zero.
+ * @param[in] lParam (@ref MC_GDATAPROVIDERW*) The provider, or @c NULL to
+ * just uninstall the current one.
+ * @return (@c BOOL) @c TRUE on success, @c FALSE on failure.
+ * @sa grid_virtual
+ */
+#define MC_GM_SETDATAPROVIDERW    (MC_GM_FIRST + 31)
+
+/**
+ * @brief Installs an asynchronous data provider (ANSI variant).
+ *
+ * @param wParam Reserved, set to zero.
+ * @param[in] lParam (@ref MC_GDATAPROVIDERA*) The provider, or @c NULL to
+ * just uninstall the current one.
+ * @return (@c BOOL) @c TRUE on success, @c FALSE on failure.
+ * @sa MC_GM_SETDATAPROVIDERW
+ */
+#define MC_GM_SETDATAPROVIDERA    (MC_GM_FIRST + 32)
+
+/**
+ * @brief Resizes the table (or the virtual table) and switches the control
+ * to the extended mode.
+ *
+ * See @ref grid_large for more info.
+ *
+ * @param[in] wParam (@c WORD) Count of columns.
+ * @param[in] lParam (@c DWORD) Count of rows. It must be lower then @ref
+ * MC_GHEADEREX and the total height of all the rows (with the default row
+ * height) must not exceed @c INT_MAX pixels.
+ * @return (@c BOOL) @c TRUE on success, @c FALSE on failure.
+ */
+#define MC_GM_RESIZEEX            (MC_GM_FIRST + 33)
+
+/**
+ * @brief Requests control to repaint a rectangular region of cells (extended
+ * variant).
+ *
+ * Same as @ref MC_GM_REDRAWCELLS, but the cells are specified with 32-bit
+ * indexes.
+ *
+ * @param wParam Reserved, set to zero.
+ * @param[in] lParam (@ref MC_GRECTEX*) The region to be (re)painted. The
+ * members @c dwColumnTo and @c dwRowTo are exclusive. @c dwColumnFrom and
+ * @c dwRowFrom may be @ref MC_GHEADEREX to include the header cells.
+ * @return (@c BOOL) @c TRUE on success, @c FALSE on failure.
+ * @sa grid_large
+ */
+#define MC_GM_REDRAWCELLSEX       (MC_GM_FIRST + 34)
+
+/**
+ * @brief Tests which cell (and its part) is placed on specified position
+ * (extended variant).
+ *
+ * @param wParam Reserved, set to zero.
+ * @param[in,out] lParam (@ref MC_GHITTESTINFOEX*) Pointer to a hit test
+ * structure. Set @ref MC_GHITTESTINFOEX::pt on input.
+ * @return (@c BOOL) @c TRUE if the point is on a cell, @c FALSE otherwise.
+ * @sa grid_large
+ */
+#define MC_GM_HITTESTEX           (MC_GM_FIRST + 35)
+
+/**
+ * @brief Get cell rectangle (extended variant).
+ *
+ * @param[in] wParam (@c DWORD) Row index of the cell.
+ * @param[in,out] lParam (@c RECT*) Pointer to rectangle. On input, set
+ * @c RECT::left to the column index of the cell.
+ * @return (@c BOOL) @c TRUE on success, @c FALSE otherwise.
+ * @sa grid_large
+ */
+#define MC_GM_GETCELLRECTEX       (MC_GM_FIRST + 36)
+
+/**
+ * @brief Ensure the cell is visible (extended variant).
+ *
+ * @param[in] wParam (@c DWORD) Row index of the cell.
+ * @param[in] lParam (@c DWORD) Low word specifies column index of the cell.
+ * High word specifies whether entire cell should be visible (see @ref
+ * MC_GM_ENSUREVISIBLE).
+ * @return (@c BOOL) @c TRUE on success, @c FALSE otherwise.
+ * @sa grid_large
+ */
+#define MC_GM_ENSUREVISIBLEEX     (MC_GM_FIRST + 37)
+
+/**
+ * @brief Set cell which has focus (extended variant).
+ *
+ * @param[in] wParam (@c WORD) Column index.
+ * @param[in] lParam (@c DWORD) Row index.
+ * @return (@c BOOL) @c TRUE on success, @c FALSE otherwise.
+ * @sa grid_large
+ */
+#define MC_GM_SETFOCUSEDCELLEX    (MC_GM_FIRST + 38)
+
+/**
+ * @brief Get cell which has focus (extended variant).
+ *
+ * @param[out] wParam (@c WORD*) Pointer to a variable receiving the column
+ * index. May be @c NULL.
+ * @param lParam Reserved, set to zero.
+ * @return (@c DWORD) Row index.
+ * @sa grid_large
+ */
+#define MC_GM_GETFOCUSEDCELLEX    (MC_GM_FIRST + 39)
+
+/**
+ * @brief Set selection (extended variant).
+ *
+ * @param wParam Reserved, set to zero.
+ * @param[in] lParam (@ref MC_GSELECTIONEX*) Pointer to structure describing
+ * the selection, or @c NULL to reset selection.
+ * @return (@c BOOL) @c TRUE on success, @c FALSE otherwise.
+ * @sa MC_GM_SETSELECTION grid_large
+ */
+#define MC_GM_SETSELECTIONEX      (MC_GM_FIRST + 40)
+
+/**
+ * @brief Get selection (extended variant).
+ *
+ * @param wParam Reserved, set to zero.
+ * @param[out] lParam (@ref MC_GSELECTIONEX*) Pointer to structure to be
+ * filled with the selection, or @c NULL. See @ref MC_GM_GETSELECTION.
+ * @return (@c UINT) Count of rectangles required for @c
+ * MC_GSELECTIONEX::rcData on success. Zero means the selection is empty.
+ * @sa MC_GM_GETSELECTION grid_large
+ */
+#define MC_GM_GETSELECTIONEX      (MC_GM_FIRST + 41)
+
+/**
+ * @brief Begins in-place editing of the specified cell (extended variant).
+ *
+ * @param[in] wParam (@c WORD) Column index.
+ * @param[in] lParam (@c DWORD) Row index.
+ * @return (@c HWND) Handle of edit control on success, @c NULL otherwise.
+ * @sa MC_GM_EDITLABEL grid_large
+ */
+#define MC_GM_EDITLABELEX         (MC_GM_FIRST + 42)
+
 /*@}*/
 
 
@@ -1273,6 +1816,194 @@ typedef struct MC_NMGSELECTIONCHANGE_tag {
 #define MC_GN_ENDLABELEDITA       (MC_GN_FIRST + 20)
 
 
+/**
+ * @brief Extended variant of @ref MC_GN_ODCACHEHINT.
+ *
+ * @param[in] wParam (@c int) Id of the control sending the notification.
+ * @param[in] lParam (@ref MC_NMGCACHEHINTEX*) Pointer to @ref
+ * MC_NMGCACHEHINTEX structure.
+ * @return None.
+ * @sa grid_large
+ */
+#define MC_GN_ODCACHEHINTEX       (MC_GN_FIRST + 32)
+
+/**
+ * @brief Extended variant of @ref MC_GN_SETDISPINFO (Unicode variant).
+ *
+ * @param[in] wParam (@c int) Id of the control sending the notification.
+ * @param[in,out] lParam (@ref MC_NMGDISPINFOEX*) Pointer to @ref
+ * MC_NMGDISPINFOEX structure.
+ * @return None.
+ * @sa grid_large
+ */
+#define MC_GN_SETDISPINFOEXW      (MC_GN_FIRST + 33)
+
+/**
+ * @brief Extended variant of @ref MC_GN_SETDISPINFO (ANSI variant).
+ *
+ * @param[in] wParam (@c int) Id of the control sending the notification.
+ * @param[in,out] lParam (@ref MC_NMGDISPINFOEX*) Pointer to @ref
+ * MC_NMGDISPINFOEX structure.
+ * @return None.
+ * @sa grid_large
+ */
+#define MC_GN_SETDISPINFOEXA      (MC_GN_FIRST + 34)
+
+/**
+ * @brief Extended variant of @ref MC_GN_GETDISPINFO (Unicode variant).
+ *
+ * @param[in] wParam (@c int) Id of the control sending the notification.
+ * @param[in,out] lParam (@ref MC_NMGDISPINFOEX*) Pointer to @ref
+ * MC_NMGDISPINFOEX structure.
+ * @return None.
+ * @sa grid_large
+ */
+#define MC_GN_GETDISPINFOEXW      (MC_GN_FIRST + 35)
+
+/**
+ * @brief Extended variant of @ref MC_GN_GETDISPINFO (ANSI variant).
+ *
+ * @param[in] wParam (@c int) Id of the control sending the notification.
+ * @param[in,out] lParam (@ref MC_NMGDISPINFOEX*) Pointer to @ref
+ * MC_NMGDISPINFOEX structure.
+ * @return None.
+ * @sa grid_large
+ */
+#define MC_GN_GETDISPINFOEXA      (MC_GN_FIRST + 36)
+
+/**
+ * @brief Extended variant of @ref MC_GN_BEGINROWTRACK.
+ *
+ * @param[in] wParam (@c int) Id of the control sending the notification.
+ * @param[in] lParam (@ref MC_NMGCOLROWSIZECHANGEEX*) Pointer to
+ * @ref MC_NMGCOLROWSIZECHANGEEX structure.
+ * @return @c TRUE to prevent the row height change, @c FALSE to allow it.
+ * @sa grid_large
+ */
+#define MC_GN_BEGINROWTRACKEX     (MC_GN_FIRST + 39)
+
+/**
+ * @brief Extended variant of @ref MC_GN_ENDROWTRACK.
+ *
+ * @param[in] wParam (@c int) Id of the control sending the notification.
+ * @param[in] lParam (@ref MC_NMGCOLROWSIZECHANGEEX*) Pointer to
+ * @ref MC_NMGCOLROWSIZECHANGEEX structure.
+ * @return Application should return zero if it processes the notification.
+ * @sa grid_large
+ */
+#define MC_GN_ENDROWTRACKEX       (MC_GN_FIRST + 40)
+
+/**
+ * @brief Extended variant of @ref MC_GN_ROWHEIGHTCHANGING.
+ *
+ * @param[in] wParam (@c int) Id of the control sending the notification.
+ * @param[in] lParam (@ref MC_NMGCOLROWSIZECHANGEEX*) Pointer to
+ * @ref MC_NMGCOLROWSIZECHANGEEX structure.
+ * @return @c TRUE to prevent the row height change, @c FALSE to allow it.
+ * @sa grid_large
+ */
+#define MC_GN_ROWHEIGHTCHANGINGEX (MC_GN_FIRST + 43)
+
+/**
+ * @brief Extended variant of @ref MC_GN_ROWHEIGHTCHANGED.
+ *
+ * @param[in] wParam (@c int) Id of the control sending the notification.
+ * @param[in] lParam (@ref MC_NMGCOLROWSIZECHANGEEX*) Pointer to
+ * @ref MC_NMGCOLROWSIZECHANGEEX structure.
+ * @return Application should return zero if it processes the notification.
+ * @sa grid_large
+ */
+#define MC_GN_ROWHEIGHTCHANGEDEX  (MC_GN_FIRST + 44)
+
+/**
+ * @brief Extended variant of @ref MC_GN_FOCUSEDCELLCHANGING.
+ *
+ * @param[in] wParam (@c int) Id of the control sending the notification.
+ * @param[in] lParam (@ref MC_NMGFOCUSEDCELLCHANGEEX*) Pointer to @ref
+ * MC_NMGFOCUSEDCELLCHANGEEX structure.
+ * @return @c TRUE to prevent the focused cell change, @c FALSE to allow it.
+ * @sa grid_large
+ */
+#define MC_GN_FOCUSEDCELLCHANGINGEX (MC_GN_FIRST + 45)
+
+/**
+ * @brief Extended variant of @ref MC_GN_FOCUSEDCELLCHANGED.
+ *
+ * @param[in] wParam (@c int) Id of the control sending the notification.
+ * @param[in] lParam (@ref MC_NMGFOCUSEDCELLCHANGEEX*) Pointer to @ref
+ * MC_NMGFOCUSEDCELLCHANGEEX structure.
+ * @return Application should return zero if it processes the notification.
+ * @sa grid_large
+ */
+#define MC_GN_FOCUSEDCELLCHANGEDEX  (MC_GN_FIRST + 46)
+
+/**
+ * @brief Extended variant of @ref MC_GN_SELECTIONCHANGING.
+ *
+ * @param[in] wParam (@c int) Id of the control sending the notification.
+ * @param[in] lParam (@ref MC_NMGSELECTIONCHANGEEX*) Pointer to @ref
+ * MC_NMGSELECTIONCHANGEEX structure.
+ * @return @c TRUE to prevent the selection change, @c FALSE to allow it.
+ * @sa grid_large
+ */
+#define MC_GN_SELECTIONCHANGINGEX (MC_GN_FIRST + 47)
+
+/**
+ * @brief Extended variant of @ref MC_GN_SELECTIONCHANGED.
+ *
+ * @param[in] wParam (@c int) Id of the control sending the notification.
+ * @param[in] lParam (@ref MC_NMGSELECTIONCHANGEEX*) Pointer to @ref
+ * MC_NMGSELECTIONCHANGEEX structure.
+ * @return Application should return zero if it processes the notification.
+ * @sa grid_large
+ */
+#define MC_GN_SELECTIONCHANGEDEX  (MC_GN_FIRST + 48)
+
+/**
+ * @brief Extended variant of @ref MC_GN_BEGINLABELEDIT (Unicode variant).
+ *
+ * @param[in] wParam (@c int) Id of the control sending the notification.
+ * @param[in,out] lParam (@ref MC_NMGDISPINFOEX*) Pointer to @ref
+ * MC_NMGDISPINFOEX structure.
+ * @return @c TRUE to prevent the label editing, @c FALSE to allow it.
+ * @sa grid_large
+ */
+#define MC_GN_BEGINLABELEDITEXW   (MC_GN_FIRST + 49)
+
+/**
+ * @brief Extended variant of @ref MC_GN_BEGINLABELEDIT (ANSI variant).
+ *
+ * @param[in] wParam (@c int) Id of the control sending the notification.
+ * @param[in,out] lParam (@ref MC_NMGDISPINFOEX*) Pointer to @ref
+ * MC_NMGDISPINFOEX structure.
+ * @return @c TRUE to prevent the label editing, @c FALSE to allow it.
+ * @sa grid_large
+ */
+#define MC_GN_BEGINLABELEDITEXA   (MC_GN_FIRST + 50)
+
+/**
+ * @brief Extended variant of @ref MC_GN_ENDLABELEDIT (Unicode variant).
+ *
+ * @param[in] wParam (@c int) Id of the control sending the notification.
+ * @param[in,out] lParam (@ref MC_NMGDISPINFOEX*) Pointer to @ref
+ * MC_NMGDISPINFOEX structure.
+ * @return See @ref MC_GN_ENDLABELEDIT.
+ * @sa grid_large
+ */
+#define MC_GN_ENDLABELEDITEXW     (MC_GN_FIRST + 51)
+
+/**
+ * @brief Extended variant of @ref MC_GN_ENDLABELEDIT (ANSI variant).
+ *
+ * @param[in] wParam (@c int) Id of the control sending the notification.
+ * @param[in,out] lParam (@ref MC_NMGDISPINFOEX*) Pointer to @ref
+ * MC_NMGDISPINFOEX structure.
+ * @return See @ref MC_GN_ENDLABELEDIT.
+ * @sa grid_large
+ */
+#define MC_GN_ENDLABELEDITEXA     (MC_GN_FIRST + 52)
+
+
 /*@}*/
 
 
@@ -1285,10 +2016,18 @@ typedef struct MC_NMGSELECTIONCHANGE_tag {
 #define MC_WC_GRID              MCTRL_NAME_AW(MC_WC_GRID)
 /** Unicode-resolution alias. @sa MC_NMGDISPINFOW MC_NMGDISPINFOA */
 #define MC_NMGDISPINFO          MCTRL_NAME_AW(MC_NMGDISPINFO)
+/** Unicode-resolution alias. @sa MC_NMGDISPINFOEXW MC_NMGDISPINFOEXA */
+#define MC_NMGDISPINFOEX        MCTRL_NAME_AW(MC_NMGDISPINFOEX)
+/** Unicode-resolution alias. @sa MC_GDATAPROCW MC_GDATAPROCA */
+#define MC_GDATAPROC            MCTRL_NAME_AW(MC_GDATAPROC)
+/** Unicode-resolution alias. @sa MC_GDATAPROVIDERW MC_GDATAPROVIDERA */
+#define MC_GDATAPROVIDER        MCTRL_NAME_AW(MC_GDATAPROVIDER)
 /** Unicode-resolution alias. @sa MC_GM_SETCELLW MC_GM_SETCELLA */
 #define MC_GM_SETCELL           MCTRL_NAME_AW(MC_GM_SETCELL)
 /** Unicode-resolution alias. @sa MC_GM_GETCELLW MC_GM_GETCELLA */
 #define MC_GM_GETCELL           MCTRL_NAME_AW(MC_GM_GETCELL)
+/** Unicode-resolution alias. @sa MC_GM_SETDATAPROVIDERW MC_GM_SETDATAPROVIDERA */
+#define MC_GM_SETDATAPROVIDER   MCTRL_NAME_AW(MC_GM_SETDATAPROVIDER)
 /** Unicode-resolution alias. @sa MC_GN_SETDISPINFOW MC_GN_SETDISPINFOA */
 #define MC_GN_SETDISPINFO       MCTRL_NAME_AW(MC_GN_SETDISPINFO)
 /** Unicode-resolution alias. @sa MC_GN_GETDISPINFOW MC_GN_GETDISPINFOA */
@@ -1297,6 +2036,14 @@ typedef struct MC_NMGSELECTIONCHANGE_tag {
 #define MC_GN_BEGINLABELEDIT    MCTRL_NAME_AW(MC_GN_BEGINLABELEDIT)
 /** Unicode-resolution alias. @sa MC_GN_ENDLABELEDITW MC_GN_ENDLABELEDITA */
 #define MC_GN_ENDLABELEDIT      MCTRL_NAME_AW(MC_GN_ENDLABELEDIT)
+/** Unicode-resolution alias. @sa MC_GN_SETDISPINFOEXW MC_GN_SETDISPINFOEXA */
+#define MC_GN_SETDISPINFOEX     MCTRL_NAME_AW(MC_GN_SETDISPINFOEX)
+/** Unicode-resolution alias. @sa MC_GN_GETDISPINFOEXW MC_GN_GETDISPINFOEXA */
+#define MC_GN_GETDISPINFOEX     MCTRL_NAME_AW(MC_GN_GETDISPINFOEX)
+/** Unicode-resolution alias. @sa MC_GN_BEGINLABELEDITEXW MC_GN_BEGINLABELEDITEXA */
+#define MC_GN_BEGINLABELEDITEX  MCTRL_NAME_AW(MC_GN_BEGINLABELEDITEX)
+/** Unicode-resolution alias. @sa MC_GN_ENDLABELEDITEXW MC_GN_ENDLABELEDITEXA */
+#define MC_GN_ENDLABELEDITEX    MCTRL_NAME_AW(MC_GN_ENDLABELEDITEX)
 
 /*@}*/
 
@@ -53,6 +53,34 @@ extern "C" {
  * @ref MC_TABLE_HEADER has to be used as a column index or row index. I.e.
  * to address cell for 2nd column, use column index 1 (because indexes are
  * zero-based), and row index @ref MC_TABLE_HEADER.
+ *
+ *
+ * @section table_ex Tables with More Rows
+ *
+ * The functions taking @c WORD indexes can address only tables of up to
+ * 65535 columns and rows (and the index @c 0xffff is taken by
+ * @ref MC_TABLE_HEADER). Larger tables have to be created and manipulated
+ * with the extended functions (e.g. @ref mcTable_CreateEx,
+ * @ref mcTable_ResizeEx and @ref mcTable_SetCellEx), which take 32-bit
+ * indexes and address the headers with @ref MC_TABLE_HEADEREX instead.
+ *
+ * The other functions still work with such table, as long as the cells they
+ * refer to fit into the 16-bit indexes.
+ *
+ *
+ * @section table_coltype Column Types
+ *
+ * By default, every cell holds its own text (@ref MC_TCT_TEXT). For columns
+ * holding numbers or a limited set of repeating strings, the application
+ * may set a column type with @ref mcTable_SetColumnType. The table then
+ * stores the values of such column in a compact array (strings are stored
+ * only once per column), which saves a lot of memory and makes operations
+ * over the whole column (like sorting) much faster.
+ *
+ * The cells of a typed column are still set and retrieved as text via
+ * @ref mcTable_SetCell and @ref mcTable_GetCell: The table parses the text
+ * when setting it, and formats the value when retrieving it. Setting a text
+ * which cannot be converted to the column type fails.
  */
 
 
@@ -75,6 +103,15 @@ typedef void* MC_HTABLE;
  */
 #define MC_TABLE_HEADER              0xffff
 
+/**
+ * @brief ID of column/row headers for the extended functions.
+ *
+ * This corresponds to @ref MC_TABLE_HEADER for the functions taking 32-bit
+ * indexes (e.g. @ref mcTable_SetCellEx). It has the same value as
+ * @ref MC_GHEADEREX of the grid control.
+ */
+#define MC_TABLE_HEADEREX            ((DWORD) 0xffffffff)
+
 
 /**
  * @anchor MC_TCMF_xxxx
@@ -124,6 +161,71 @@ typedef void* MC_HTABLE;
 /*@}*/
 
 
+/**
+ * @anchor MC_TCT_xxxx
+ * @name Column Types
+ */
+/*@{*/
+
+/** @brief Each cell holds its own text (the default). */
+#define MC_TCT_TEXT                 0
+/** @brief The column holds 64-bit signed integers. */
+#define MC_TCT_INT64                1
+/** @brief The column holds double-precision floating point numbers. */
+#define MC_TCT_DOUBLE               2
+/** @brief The column holds strings. Each distinct string is stored only once. */
+#define MC_TCT_STRING               3
+/** @brief Text of all cells is provided by the application on demand
+ *  (as if each cell is set to @c MC_LPSTR_TEXTCALLBACK). */
+#define MC_TCT_CALLBACK             4
+
+/*@}*/
+
+
+/**
+ * @anchor MC_TF_xxxx
+ * @name Table Flags
+ */
+/*@{*/
+
+/** @brief Intern texts of the cells.
+ *
+ * All the texts set into the table are stored in a pool shared by all the
+ * cells of the table, and each distinct text is stored only once. This
+ * considerably reduces memory consumption of large tables with many repeated
+ * texts, at the cost of a hash lookup whenever a text is set.
+ *
+ * Note the columns of the @ref MC_TCT_STRING type always share their strings,
+ * regardless of this flag.
+ *
+ * @sa mcTable_GetPoolStats
+ */
+#define MC_TF_INTERNTEXT            0x00000001
+
+/*@}*/
+
+
+/**
+ * @brief Structure with statistics of the table's text pool.
+ *
+ * @sa mcTable_GetPoolStats
+ */
+typedef struct MC_TABLEPOOLSTATS_tag {
+    /** Count of distinct texts in the pool. */
+    DWORD dwStrings;
+    /** Count of texts set into the table. */
+    ULONGLONG ullLookups;
+    /** Count of texts out of @c ullLookups which were already in the pool.
+     *  The hit rate is then (@c ullHits / @c ullLookups). */
+    ULONGLONG ullHits;
+    /** Bytes occupied by the texts in the pool (not counting any overhead). */
+    ULONGLONG ullBytes;
+    /** Bytes which would be needed in addition if each cell had its own copy
+     *  of its text. */
+    ULONGLONG ullBytesSaved;
+} MC_TABLEPOOLSTATS;
+
+
 /**
  * @brief Structure describing a table cell (Unicode variant).
  *
@@ -180,11 +282,26 @@ typedef struct MC_TABLECELLA_tag {
  *
  * @param[in] wColumnCount Column count.
  * @param[in] wRowCount Row count.
- * @param dwReserved Reserved. Set to zero.
+ * @param[in] dwFlags Flags. See @ref MC_TF_xxxx. (Older applications
+ * passed zero here as the parameter used to be reserved.)
  * @return Handle of the new table or @c NULL on failure.
  */
 MC_HTABLE MCTRL_API mcTable_Create(WORD wColumnCount, WORD wRowCount,
-                                   DWORD dwReserved);
+                                   DWORD dwFlags);
+
+/**
+ * @brief Create new table (extended variant).
+ *
+ * Same as @ref mcTable_Create, but the table may have more than 65535
+ * columns or rows.
+ *
+ * @param[in] dwColumnCount Column count.
+ * @param[in] dwRowCount Row count.
+ * @param[in] dwFlags Flags. See @ref MC_TF_xxxx.
+ * @return Handle of the new table or @c NULL on failure.
+ */
+MC_HTABLE MCTRL_API mcTable_CreateEx(DWORD dwColumnCount, DWORD dwRowCount,
+                                     DWORD dwFlags);
 
 /**
  * @brief Increment reference counter of the table.
@@ -207,7 +324,8 @@ void MCTRL_API mcTable_Release(MC_HTABLE hTable);
  * @brief Retrieve count of table columns.
  *
  * @param[in] hTable The table.
- * @return The count.
+ * @return The count. (If the table has more than 65535 columns, @c 0xffff is
+ * returned. Use @ref mcTable_ColumnCountEx for such tables.)
  */
 WORD MCTRL_API mcTable_ColumnCount(MC_HTABLE hTable);
 
@@ -215,10 +333,27 @@ WORD MCTRL_API mcTable_ColumnCount(MC_HTABLE hTable);
  * @brief Retrieve count of table rows.
  *
  * @param[in] hTable The table.
- * @return The count.
+ * @return The count. (If the table has more than 65535 rows, @c 0xffff is
+ * returned. Use @ref mcTable_RowCountEx for such tables.)
  */
 WORD MCTRL_API mcTable_RowCount(MC_HTABLE hTable);
 
+/**
+ * @brief Retrieve count of table columns (extended variant).
+ *
+ * @param[in] hTable The table.
+ * @return The count.
+ */
+DWORD MCTRL_API mcTable_ColumnCountEx(MC_HTABLE hTable);
+
+/**
+ * @brief Retrieve count of table rows (extended variant).
+ *
+ * @param[in] hTable The table.
+ * @return The count.
+ */
+DWORD MCTRL_API mcTable_RowCountEx(MC_HTABLE hTable);
+
 /**
  * @brief Resize the table.
  *
@@ -234,6 +369,68 @@ WORD MCTRL_API mcTable_RowCount(MC_HTABLE hTable);
  */
 BOOL MCTRL_API mcTable_Resize(MC_HTABLE hTable, WORD wColumnCount, WORD wRowCount);
 
+/**
+ * @brief Resize the table (extended variant).
+ *
+ * @param[in] hTable The table.
+ * @param[in] dwColumnCount Column count.
+ * @param[in] dwRowCount Row count.
+ * @return @c TRUE on success, @c FALSE otherwise.
+ * @sa mcTable_Resize
+ */
+BOOL MCTRL_API mcTable_ResizeEx(MC_HTABLE hTable, DWORD dwColumnCount,
+                                DWORD dwRowCount);
+
+/**
+ * @brief Insert rows into the table.
+ *
+ * The new rows are inserted before the row @c wRow (or appended, if @c wRow
+ * is the current count of rows), and their cells are initialized the same
+ * way as by @ref mcTable_Resize. The rows below move down, keeping their
+ * data.
+ *
+ * @param[in] hTable The table.
+ * @param[in] wRow Index of the first new row.
+ * @param[in] wCount Count of the rows to insert.
+ * @return @c TRUE on success, @c FALSE otherwise.
+ */
+BOOL MCTRL_API mcTable_InsertRows(MC_HTABLE hTable, WORD wRow, WORD wCount);
+
+/**
+ * @brief Insert rows into the table (extended variant).
+ *
+ * @param[in] hTable The table.
+ * @param[in] dwRow Index of the first new row.
+ * @param[in] dwCount Count of the rows to insert.
+ * @return @c TRUE on success, @c FALSE otherwise.
+ * @sa mcTable_InsertRows
+ */
+BOOL MCTRL_API mcTable_InsertRowsEx(MC_HTABLE hTable, DWORD dwRow, DWORD dwCount);
+
+/**
+ * @brief Remove rows from the table.
+ *
+ * The values of the cells in the removed rows are destroyed. The rows below
+ * move up, keeping their data.
+ *
+ * @param[in] hTable The table.
+ * @param[in] wRow Index of the first row to remove.
+ * @param[in] wCount Count of the rows to remove.
+ * @return @c TRUE on success, @c FALSE otherwise.
+ */
+BOOL MCTRL_API mcTable_RemoveRows(MC_HTABLE hTable, WORD wRow, WORD wCount);
+
+/**
+ * @brief Remove rows from the table (extended variant).
+ *
+ * @param[in] hTable The table.
+ * @param[in] dwRow Index of the first row to remove.
+ * @param[in] dwCount Count of the rows to remove.
+ * @return @c TRUE on success, @c FALSE otherwise.
+ * @sa mcTable_RemoveRows
+ */
+BOOL MCTRL_API mcTable_RemoveRowsEx(MC_HTABLE hTable, DWORD dwRow, DWORD dwCount);
+
 /**
  * @brief Clear the table.
  *
@@ -303,6 +500,158 @@ BOOL MCTRL_API mcTable_GetCellW(MC_HTABLE hTable, WORD wCol, WORD wRow,
 BOOL MCTRL_API mcTable_GetCellA(MC_HTABLE hTable, WORD wCol, WORD wRow,
                                 MC_TABLECELLA* pCell);
 
+/**
+ * @brief Set contents of a cell (extended Unicode variant).
+ *
+ * @param[in] hTable The table.
+ * @param[in] dwCol Column index, or @ref MC_TABLE_HEADEREX.
+ * @param[in] dwRow Row index, or @ref MC_TABLE_HEADEREX.
+ * @param[in] pCell Specifies attributes of the cell to set.
+ * @return @c TRUE on success, @c FALSE otherwise.
+ */
+BOOL MCTRL_API mcTable_SetCellExW(MC_HTABLE hTable, DWORD dwCol, DWORD dwRow,
+                                  MC_TABLECELLW* pCell);
+
+/**
+ * @brief Set contents of a cell (extended ANSI variant).
+ *
+ * @param[in] hTable The table.
+ * @param[in] dwCol Column index, or @ref MC_TABLE_HEADEREX.
+ * @param[in] dwRow Row index, or @ref MC_TABLE_HEADEREX.
+ * @param[in] pCell Specifies attributes of the cell to set.
+ * @return @c TRUE on success, @c FALSE otherwise.
+ */
+BOOL MCTRL_API mcTable_SetCellExA(MC_HTABLE hTable, DWORD dwCol, DWORD dwRow,
+                                  MC_TABLECELLA* pCell);
+
+/**
+ * @brief Get contents of a cell (extended Unicode variant).
+ *
+ * @param[in] hTable The table.
+ * @param[in] dwCol Column index, or @ref MC_TABLE_HEADEREX.
+ * @param[in] dwRow Row index, or @ref MC_TABLE_HEADEREX.
+ * @param[out] pCell Specifies retrieved attributes of the cell.
+ * @return @c TRUE on success, @c FALSE otherwise.
+ */
+BOOL MCTRL_API mcTable_GetCellExW(MC_HTABLE hTable, DWORD dwCol, DWORD dwRow,
+                                  MC_TABLECELLW* pCell);
+
+/**
+ * @brief Get contents of a cell (extended ANSI variant).
+ *
+ * @param[in] hTable The table.
+ * @param[in] dwCol Column index, or @ref MC_TABLE_HEADEREX.
+ * @param[in] dwRow Row index, or @ref MC_TABLE_HEADEREX.
+ * @param[out] pCell Specifies retrieved attributes of the cell.
+ * @return @c TRUE on success, @c FALSE otherwise.
+ */
+BOOL MCTRL_API mcTable_GetCellExA(MC_HTABLE hTable, DWORD dwCol, DWORD dwRow,
+                                  MC_TABLECELLA* pCell);
+
+/**
+ * @brief Set contents of a rectangular block of cells (Unicode variant).
+ *
+ * This is much faster then setting the cells one by one with
+ * @ref mcTable_SetCellW, and the grid control (or any other view of the
+ * table) is refreshed only once.
+ *
+ * The array @c pCells has to consist of <tt>wColumnCount * wRowCount</tt>
+ * cells, ordered row by row. Each of them describes, with its own @c fMask,
+ * what to set in the corresponding cell. Header cells cannot be set with
+ * this function.
+ *
+ * If setting any of the cells fails, the function stops and returns
+ * @c FALSE. The cells preceding it in the array then keep their new
+ * contents.
+ *
+ * @param[in] hTable The table.
+ * @param[in] wCol Index of the left-most column of the block.
+ * @param[in] wRow Index of the top-most row of the block.
+ * @param[in] wColumnCount Count of columns in the block.
+ * @param[in] wRowCount Count of rows in the block.
+ * @param[in] pCells The cells.
+ * @return @c TRUE on success, @c FALSE otherwise.
+ */
+BOOL MCTRL_API mcTable_SetRegionW(MC_HTABLE hTable, WORD wCol, WORD wRow,
+                                  WORD wColumnCount, WORD wRowCount,
+                                  MC_TABLECELLW* pCells);
+
+/**
+ * @brief Set contents of a rectangular block of cells (ANSI variant).
+ *
+ * @param[in] hTable The table.
+ * @param[in] wCol Index of the left-most column of the block.
+ * @param[in] wRow Index of the top-most row of the block.
+ * @param[in] wColumnCount Count of columns in the block.
+ * @param[in] wRowCount Count of rows in the block.
+ * @param[in] pCells The cells.
+ * @return @c TRUE on success, @c FALSE otherwise.
+ * @sa mcTable_SetRegionW
+ */
+BOOL MCTRL_API mcTable_SetRegionA(MC_HTABLE hTable, WORD wCol, WORD wRow,
+                                  WORD wColumnCount, WORD wRowCount,
+                                  MC_TABLECELLA* pCells);
+
+/**
+ * @brief Start a batch of changes of the table.
+ *
+ * Until the matching @ref mcTable_EndUpdate is called, changes of the cells
+ * are not propagated to the grid control (or any other view of the table)
+ * immediately. Instead, all the changed cells are refreshed at once when
+ * the batch ends.
+ *
+ * The calls may be nested. The batch ends with the outer-most call of
+ * @ref mcTable_EndUpdate.
+ *
+ * @param[in] hTable The table.
+ */
+void MCTRL_API mcTable_BeginUpdate(MC_HTABLE hTable);
+
+/**
+ * @brief End a batch of changes of the table.
+ *
+ * @param[in] hTable The table.
+ * @sa mcTable_BeginUpdate
+ */
+void MCTRL_API mcTable_EndUpdate(MC_HTABLE hTable);
+
+/**
+ * @brief Set type of a column.
+ *
+ * Values of all cells in the column are converted to the new type. If any of
+ * them cannot be converted (e.g. a text which is not a number is to be
+ * converted to @ref MC_TCT_INT64), the function fails and the column is left
+ * intact. Converting to @ref MC_TCT_CALLBACK discards all the values; text
+ * of cells of a @ref MC_TCT_CALLBACK column cannot be set.
+ *
+ * Parameters and flags of the cells are preserved.
+ *
+ * @param[in] hTable The table.
+ * @param[in] wCol Column index.
+ * @param[in] dwType The type. See @ref MC_TCT_xxxx.
+ * @return @c TRUE on success, @c FALSE otherwise.
+ */
+BOOL MCTRL_API mcTable_SetColumnType(MC_HTABLE hTable, WORD wCol, DWORD dwType);
+
+/**
+ * @brief Get type of a column.
+ *
+ * @param[in] hTable The table.
+ * @param[in] wCol Column index.
+ * @return The type (see @ref MC_TCT_xxxx), or @c (DWORD)-1 on failure.
+ */
+DWORD MCTRL_API mcTable_GetColumnType(MC_HTABLE hTable, WORD wCol);
+
+/**
+ * @brief Retrieve statistics of the table's text pool.
+ *
+ * @param[in] hTable The table.
+ * @param[out] pStats The statistics.
+ * @return @c TRUE on success, @c FALSE otherwise (e.g. if the table has been
+ * created without @ref MC_TF_INTERNTEXT).
+ */
+BOOL MCTRL_API mcTable_GetPoolStats(MC_HTABLE hTable, MC_TABLEPOOLSTATS* pStats);
+
 /*@}*/
 
 
@@ -317,6 +666,12 @@ BOOL MCTRL_API mcTable_GetCellA(MC_HTABLE hTable, WORD wCol, WORD wRow,
 #define mcTable_SetCell          MCTRL_NAME_AW(mcTable_SetCell)
 /** Unicode-resolution alias. @sa mcTable_GetCellW mcTable_GetCellA */
 #define mcTable_GetCell          MCTRL_NAME_AW(mcTable_GetCell)
+/** Unicode-resolution alias. @sa mcTable_SetCellExW mcTable_SetCellExA */
+#define mcTable_SetCellEx        MCTRL_NAME_AW(mcTable_SetCellEx)
+/** Unicode-resolution alias. @sa mcTable_GetCellExW mcTable_GetCellExA */
+#define mcTable_GetCellEx        MCTRL_NAME_AW(mcTable_GetCellEx)
+/** Unicode-resolution alias. @sa mcTable_SetRegionW mcTable_SetRegionA */
+#define mcTable_SetRegion        MCTRL_NAME_AW(mcTable_SetRegion)
 
 /*@}*/
 
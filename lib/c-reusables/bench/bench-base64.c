@@ -0,0 +1,125 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2020 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#include "base64.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+
+/* Compares throughput of Base64 encoding and decoding with memcpy().
+ * The "scalar" rows disable the SIMD kernels (x86-64 only). */
+
+#define DATA_SIZE       (1024 * 1024)
+#define TOTAL_BYTES     ((double) 512 * 1024 * 1024)
+
+
+extern unsigned base64_test_cpu_mask;
+
+
+static double
+elapsed(clock_t t0)
+{
+    return (double)(clock() - t0) / CLOCKS_PER_SEC;
+}
+
+static void
+report(const char* name, clock_t t0)
+{
+    double secs = elapsed(t0);
+
+    printf("  %-16s %8.3f s  %10.1f MB/s\n", name, secs,
+            (secs > 0.0) ? TOTAL_BYTES / (1024.0 * 1024.0) / secs : 0.0);
+}
+
+int
+main(int argc, char** argv)
+{
+    static const BASE64_OPTIONS mime = { '+', '/', '=', 76 };
+    static const struct { unsigned mask; const char* name; } impls[] = {
+        { ~0u, "best" }, { 0x1, "ssse3" }, { 0x0, "scalar" }
+    };
+    unsigned char* data;
+    unsigned char* copy;
+    char* text;
+    int text_len;
+    clock_t t0;
+    size_t i, j, iters;
+
+    data = (unsigned char*) malloc(DATA_SIZE);
+    copy = (unsigned char*) malloc(DATA_SIZE + 32);
+    text = (char*) malloc(2 * DATA_SIZE);
+    if(data == NULL  ||  copy == NULL  ||  text == NULL) {
+        fprintf(stderr, "Out of memory.\n");
+        return 1;
+    }
+    for(i = 0; i < DATA_SIZE; i++)
+        data[i] = (unsigned char) (i * 2654435761U >> 24);
+
+    /* Byte counts are of the binary side in all cases. */
+    iters = (size_t) (TOTAL_BYTES / DATA_SIZE);
+
+    t0 = clock();
+    for(j = 0; j < iters; j++) {
+        memcpy(copy, data, DATA_SIZE);
+        data[j % DATA_SIZE] ^= copy[(j * 7) % DATA_SIZE];
+    }
+    report("memcpy", t0);
+
+    for(i = 0; i < sizeof(impls) / sizeof(impls[0]); i++) {
+        base64_test_cpu_mask = impls[i].mask;
+        printf("Implementation %s:\n", impls[i].name);
+
+        t0 = clock();
+        for(j = 0; j < iters; j++)
+            text_len = base64_encode(data, DATA_SIZE, text, 2 * DATA_SIZE, NULL);
+        report("encode", t0);
+
+        t0 = clock();
+        for(j = 0; j < iters; j++) {
+            if(base64_decode(text, text_len, copy, DATA_SIZE + 32, NULL) != DATA_SIZE)
+                fprintf(stderr, "Decoding failed.\n");
+        }
+        report("decode", t0);
+
+        t0 = clock();
+        for(j = 0; j < iters; j++)
+            text_len = base64_encode(data, DATA_SIZE, text, 2 * DATA_SIZE, &mime);
+        report("encode (MIME)", t0);
+
+        t0 = clock();
+        for(j = 0; j < iters; j++) {
+            if(base64_decode(text, text_len, copy, DATA_SIZE + 32, &mime) != DATA_SIZE)
+                fprintf(stderr, "Decoding failed.\n");
+        }
+        report("decode (MIME)", t0);
+    }
+
+    free(data);
+    free(copy);
+    free(text);
+    return 0;
+}
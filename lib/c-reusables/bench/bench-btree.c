@@ -0,0 +1,179 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2020 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "btree.h"
+#include "rbtree.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+
+/* Compares B+tree with red-black tree on a large set of integer keys. */
+
+#define KEY_COUNT       (10 * 1000 * 1000)
+
+
+typedef struct RECORD {
+    RBTREE_NODE the_node;
+    BTREE_KEY key;
+} RECORD;
+
+static int
+record_cmp(const RBTREE_NODE* node1, const RBTREE_NODE* node2)
+{
+    BTREE_KEY key1 = RBTREE_DATA(node1, RECORD, the_node)->key;
+    BTREE_KEY key2 = RBTREE_DATA(node2, RECORD, the_node)->key;
+
+    if(key1 < key2)
+        return -1;
+    if(key1 > key2)
+        return +1;
+    return 0;
+}
+
+/* Keys in the order of insertion, and in the order of lookups. Both are
+ * random permutations of 0 ... (KEY_COUNT-1). */
+static BTREE_KEY* insert_keys;
+static BTREE_KEY* lookup_keys;
+
+static unsigned
+rnd(unsigned* state)
+{
+    /* xorshift32 */
+    unsigned x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static void
+shuffle(BTREE_KEY* keys, unsigned seed)
+{
+    unsigned i, j;
+    BTREE_KEY tmp;
+
+    for(i = 0; i < KEY_COUNT; i++)
+        keys[i] = i;
+    for(i = KEY_COUNT - 1; i > 0; i--) {
+        j = rnd(&seed) % (i + 1);
+        tmp = keys[i];
+        keys[i] = keys[j];
+        keys[j] = tmp;
+    }
+}
+
+static double
+elapsed(clock_t t0)
+{
+    return (double)(clock() - t0) / CLOCKS_PER_SEC;
+}
+
+static void
+bench_btree(void)
+{
+    BTREE tree = BTREE_INITIALIZER;
+    BTREE_CURSOR cur;
+    void** p_data;
+    uintptr_t sum = 0;
+    clock_t t0;
+    unsigned i;
+
+    t0 = clock();
+    for(i = 0; i < KEY_COUNT; i++)
+        btree_insert(&tree, insert_keys[i], (void*) (uintptr_t) i);
+    printf("  btree insert:     %.3f s\n", elapsed(t0));
+
+    t0 = clock();
+    for(i = 0; i < KEY_COUNT; i++)
+        sum += (uintptr_t) *btree_lookup(&tree, lookup_keys[i]);
+    printf("  btree lookup:     %.3f s\n", elapsed(t0));
+
+    t0 = clock();
+    for(p_data = btree_head(&tree, &cur); p_data != NULL; p_data = btree_next(&cur))
+        sum += (uintptr_t) *p_data;
+    printf("  btree scan:       %.3f s\n", elapsed(t0));
+
+    t0 = clock();
+    btree_fini(&tree, NULL);
+    printf("  btree fini:       %.3f s   (checksum %lu)\n", elapsed(t0), (unsigned long) sum);
+}
+
+static void
+bench_rbtree(RECORD* records)
+{
+    RBTREE tree = RBTREE_INITIALIZER;
+    RBTREE_CURSOR cur;
+    RBTREE_NODE* node;
+    RECORD key;
+    uintptr_t sum = 0;
+    clock_t t0;
+    unsigned i;
+
+    t0 = clock();
+    for(i = 0; i < KEY_COUNT; i++) {
+        records[i].key = insert_keys[i];
+        rbtree_insert(&tree, &records[i].the_node, record_cmp);
+    }
+    printf("  rbtree insert:    %.3f s\n", elapsed(t0));
+
+    t0 = clock();
+    for(i = 0; i < KEY_COUNT; i++) {
+        key.key = lookup_keys[i];
+        node = rbtree_lookup(&tree, &key.the_node, record_cmp);
+        sum += (uintptr_t) (RBTREE_DATA(node, RECORD, the_node) - records);
+    }
+    printf("  rbtree lookup:    %.3f s\n", elapsed(t0));
+
+    t0 = clock();
+    for(node = rbtree_head(&tree, &cur); node != NULL; node = rbtree_next(&cur))
+        sum += (uintptr_t) (RBTREE_DATA(node, RECORD, the_node) - records);
+    printf("  rbtree scan:      %.3f s   (checksum %lu)\n", elapsed(t0), (unsigned long) sum);
+}
+
+int
+main(void)
+{
+    RECORD* records;
+
+    records = (RECORD*) malloc(KEY_COUNT * sizeof(RECORD));
+    insert_keys = (BTREE_KEY*) malloc(KEY_COUNT * sizeof(BTREE_KEY));
+    lookup_keys = (BTREE_KEY*) malloc(KEY_COUNT * sizeof(BTREE_KEY));
+    if(records == NULL  ||  insert_keys == NULL  ||  lookup_keys == NULL)
+        return 1;
+    shuffle(insert_keys, 0x12345678);
+    shuffle(lookup_keys, 0x87654321);
+
+    printf("%d keys inserted, looked up (in random orders) and scanned:\n", KEY_COUNT);
+    bench_btree();
+    bench_rbtree(records);
+
+    free(lookup_keys);
+    free(insert_keys);
+    free(records);
+    return 0;
+}
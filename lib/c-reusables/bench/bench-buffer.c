@@ -0,0 +1,168 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2020 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "buffer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+
+#define RECORD_COUNT    (10 * 1000 * 1000)
+#define RECORD_SIZE     16
+
+
+static double
+elapsed(clock_t t0)
+{
+    return (double)(clock() - t0) / CLOCKS_PER_SEC;
+}
+
+/* Appending records with buffer_reserve() + writing into the spare space. */
+static void
+bench_reserve(void)
+{
+    BUFFER buf = BUFFER_INITIALIZER;
+    static const char record[RECORD_SIZE] = "0123456789abcdef";
+    clock_t t0;
+    int i;
+
+    t0 = clock();
+    for(i = 0; i < RECORD_COUNT; i++) {
+        if(buffer_reserve(&buf, RECORD_SIZE) != 0)
+            break;
+        memcpy(buffer_data_at(&buf, buf.size), record, RECORD_SIZE);
+        buf.size += RECORD_SIZE;
+    }
+    printf("  buffer_reserve() + write:       %.3f s\n", elapsed(t0));
+    buffer_fini(&buf);
+}
+
+/* Appending records with buffer_append(). */
+static void
+bench_append(void)
+{
+    BUFFER buf = BUFFER_INITIALIZER;
+    static const char record[RECORD_SIZE] = "0123456789abcdef";
+    clock_t t0;
+    int i;
+
+    t0 = clock();
+    for(i = 0; i < RECORD_COUNT; i++) {
+        if(buffer_append(&buf, record, RECORD_SIZE) != 0)
+            break;
+    }
+    printf("  buffer_append():                %.3f s\n", elapsed(t0));
+    buffer_fini(&buf);
+}
+
+/* Formatting records via a temporary string. */
+static void
+bench_snprintf_append(void)
+{
+    BUFFER buf = BUFFER_INITIALIZER;
+    char tmp[64];
+    clock_t t0;
+    int i, n;
+
+    t0 = clock();
+    for(i = 0; i < RECORD_COUNT; i++) {
+        n = snprintf(tmp, sizeof(tmp), "%d;%x\n", i, i);
+        if(buffer_append(&buf, tmp, n) != 0)
+            break;
+    }
+    printf("  snprintf() + buffer_append():   %.3f s\n", elapsed(t0));
+    buffer_fini(&buf);
+}
+
+/* Formatting records directly into the buffer. */
+static void
+bench_append_fmt(void)
+{
+    BUFFER buf = BUFFER_INITIALIZER;
+    clock_t t0;
+    int i;
+
+    t0 = clock();
+    for(i = 0; i < RECORD_COUNT; i++) {
+        if(buffer_append_fmt(&buf, "%d;%x\n", i, i) != 0)
+            break;
+    }
+    printf("  buffer_append_fmt():            %.3f s\n", elapsed(t0));
+    buffer_fini(&buf);
+}
+
+/* Many short-lived small buffers. */
+static void
+bench_short_lived(void)
+{
+    static const char record[RECORD_SIZE] = "0123456789abcdef";
+    unsigned long sum = 0;
+    clock_t t0;
+    int i;
+
+    t0 = clock();
+    for(i = 0; i < RECORD_COUNT; i++) {
+        BUFFER buf = BUFFER_INITIALIZER;
+
+        buffer_append(&buf, record, RECORD_SIZE);
+        buffer_append(&buf, record, RECORD_SIZE);
+        buffer_append(&buf, record, RECORD_SIZE);
+        sum += buffer_uint8_at(&buf, i % buffer_size(&buf));
+        buffer_fini(&buf);
+    }
+    printf("  BUFFER:                         %.3f s\n", elapsed(t0));
+
+    t0 = clock();
+    for(i = 0; i < RECORD_COUNT; i++) {
+        BUFFER_SBO(64) sbo;
+
+        BUFFER_SBO_INIT(&sbo);
+        buffer_append(&sbo.buf, record, RECORD_SIZE);
+        buffer_append(&sbo.buf, record, RECORD_SIZE);
+        buffer_append(&sbo.buf, record, RECORD_SIZE);
+        sum += buffer_uint8_at(&sbo.buf, i % buffer_size(&sbo.buf));
+        buffer_fini(&sbo.buf);
+    }
+    printf("  BUFFER_SBO(64):                 %.3f s   (checksum %lu)\n", elapsed(t0), sum);
+}
+
+int
+main(void)
+{
+    printf("Appending %d records of %d bytes:\n", RECORD_COUNT, RECORD_SIZE);
+    bench_reserve();
+    bench_append();
+
+    printf("Appending %d formatted records:\n", RECORD_COUNT);
+    bench_snprintf_append();
+    bench_append_fmt();
+
+    printf("%d short-lived buffers of 3 records each:\n", RECORD_COUNT);
+    bench_short_lived();
+
+    return 0;
+}
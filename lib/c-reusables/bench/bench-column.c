@@ -0,0 +1,183 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2020 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "column.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+
+/* Compares a typed column with the traditional row-major layout where every
+ * cell holds its own heap-allocated text (plus some user data and flags),
+ * i.e. what a table model storing only strings has to do for numeric data.
+ */
+
+typedef struct CELL {
+    char* text;
+    intptr_t lp;
+    uint32_t flags;
+} CELL;
+
+static double
+elapsed(clock_t t0)
+{
+    return (double)(clock() - t0) / CLOCKS_PER_SEC;
+}
+
+static unsigned
+rnd(unsigned* state)
+{
+    *state = *state * 1103515245U + 12345U;
+    return (*state >> 8);
+}
+
+static const CELL* cmp_cells;
+
+static int
+cmp_cell_rows(const void* a, const void* b)
+{
+    long long va = strtoll(cmp_cells[*(const size_t*) a].text, NULL, 10);
+    long long vb = strtoll(cmp_cells[*(const size_t*) b].text, NULL, 10);
+
+    if(va != vb)
+        return (va < vb) ? -1 : +1;
+    return (*(const size_t*) a < *(const size_t*) b) ? -1 : +1;
+}
+
+static void
+run(size_t n)
+{
+    static const char* hosts[] = { "alpha", "beta", "gamma", "delta", "epsilon",
+                                   "zeta", "eta", "theta", "iota", "kappa" };
+    CELL* cells;
+    COLUMN col;
+    COLUMN str_col;
+    size_t* rows;
+    size_t i, min_row;
+    long long v, min_v;
+    char buf[32];
+    unsigned seed = 42;
+    clock_t t0;
+
+    cells = (CELL*) malloc(n * sizeof(CELL));
+    rows = (size_t*) malloc(n * sizeof(size_t));
+    column_init(&col, COLUMN_INT64);
+    column_init(&str_col, COLUMN_STRING);
+    if(cells == NULL  ||  rows == NULL  ||  column_insert(&col, 0, n) != 0  ||
+       column_insert(&str_col, 0, n) != 0) {
+        fprintf(stderr, "Out of memory.\n");
+        exit(1);
+    }
+
+    t0 = clock();
+    for(i = 0; i < n; i++) {
+        sprintf(buf, "%d", (int) (rnd(&seed) % 1000000));
+        cells[i].text = strdup(buf);
+        cells[i].lp = 0;
+        cells[i].flags = 0;
+    }
+    printf("  cells fill:             %8.3f s\n", elapsed(t0));
+
+    seed = 42;
+    t0 = clock();
+    for(i = 0; i < n; i++)
+        column_set_int64(&col, i, (int64_t) (rnd(&seed) % 1000000));
+    printf("  column fill:            %8.3f s\n", elapsed(t0));
+
+    t0 = clock();
+    min_row = 0;
+    min_v = strtoll(cells[0].text, NULL, 10);
+    for(i = 1; i < n; i++) {
+        v = strtoll(cells[i].text, NULL, 10);
+        if(v < min_v) {
+            min_v = v;
+            min_row = i;
+        }
+    }
+    printf("  cells min:              %8.3f s\n", elapsed(t0));
+
+    t0 = clock();
+    column_min(&col, NULL, &i);
+    printf("  column min:             %8.3f s\n", elapsed(t0));
+    if(i != min_row)
+        printf("  MISMATCH!\n");
+
+    for(i = 0; i < n; i++)
+        rows[i] = i;
+    cmp_cells = cells;
+    t0 = clock();
+    qsort(rows, n, sizeof(size_t), cmp_cell_rows);
+    printf("  cells sort (qsort):     %8.3f s\n", elapsed(t0));
+
+    for(i = 0; i < n; i++)
+        rows[i] = i;
+    t0 = clock();
+    column_sort(&col, rows, n, 0, NULL);
+    printf("  column sort (radix):    %8.3f s\n", elapsed(t0));
+
+    /* Strings with a few distinct values, e.g. a host name column. */
+    t0 = clock();
+    for(i = 0; i < n; i++) {
+        const char* h = hosts[rnd(&seed) % 10];
+        column_set_string(&str_col, i, h, strlen(h));
+    }
+    printf("  string column fill:     %8.3f s (%u distinct)\n",
+            elapsed(t0), (unsigned) column_string_count(&str_col));
+
+    for(i = 0; i < n; i++)
+        rows[i] = i;
+    t0 = clock();
+    column_sort(&str_col, rows, n, 0, NULL);
+    printf("  string column sort:     %8.3f s\n", elapsed(t0));
+
+    printf("  memory: cells ~%u MB (+ %u MB of heap strings), column %u MB\n",
+            (unsigned) (n * sizeof(CELL) >> 20),
+            (unsigned) (n * 32 >> 20),     /* typical malloc() chunk */
+            (unsigned) (n * (sizeof(int64_t) + 1) >> 20));
+
+    for(i = 0; i < n; i++)
+        free(cells[i].text);
+    free(cells);
+    free(rows);
+    column_fini(&col);
+    column_fini(&str_col);
+}
+
+int
+main(void)
+{
+    static const size_t counts[] = { 1000, 65535, 1000000 };
+    size_t i;
+
+    for(i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+        printf("%u rows:\n", (unsigned) counts[i]);
+        run(counts[i]);
+    }
+
+    return 0;
+}
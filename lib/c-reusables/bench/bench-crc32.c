@@ -0,0 +1,135 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2020 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "crc32.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+
+/* Throughput of the CRC-32 implementations on a large buffer. */
+
+#define DATA_SIZE       (64 * 1024 * 1024)
+#define ROUNDS          8
+
+
+/* Built with CRE_TEST. */
+uint32_t crc32_update_sw(uint32_t crc, const void* data, size_t n);
+int crc32_has_hw(void);
+
+
+static double
+elapsed(clock_t t0)
+{
+    return (double)(clock() - t0) / CLOCKS_PER_SEC;
+}
+
+static void
+report(const char* name, clock_t t0, uint32_t crc)
+{
+    double secs = elapsed(t0);
+    double mb = (double) DATA_SIZE * ROUNDS / (1024.0 * 1024.0);
+
+    printf("  %-28s %8.3f s  %10.1f MB/s  (crc %08x)\n", name, secs,
+            (secs > 0.0) ? mb / secs : 0.0, (unsigned) crc);
+}
+
+/* The classic one-byte-per-iteration loop, for the comparison. */
+static uint32_t
+crc32_bytewise(const uint8_t* data, size_t n)
+{
+    static uint32_t table[256];
+    uint32_t crcreg = 0xffffffffU;
+    size_t i;
+
+    if(table[1] == 0) {
+        uint32_t c;
+        int k;
+
+        for(i = 0; i < 256; i++) {
+            c = (uint32_t) i;
+            for(k = 0; k < 8; k++)
+                c = (c & 1) ? ((c >> 1) ^ 0xedb88320U) : (c >> 1);
+            table[i] = c;
+        }
+    }
+
+    for(i = 0; i < n; i++)
+        crcreg = (crcreg >> 8) ^ table[(crcreg ^ data[i]) & 0xffU];
+
+    return crcreg ^ 0xffffffffU;
+}
+
+int
+main(int argc, char** argv)
+{
+    uint8_t* data;
+    uint32_t crc = 0;
+    clock_t t0;
+    size_t i;
+    int r;
+
+    data = (uint8_t*) malloc(DATA_SIZE);
+    if(data == NULL) {
+        fprintf(stderr, "Out of memory.\n");
+        return 1;
+    }
+    for(i = 0; i < DATA_SIZE; i++)
+        data[i] = (uint8_t) (i * 2654435761U >> 24);
+
+    printf("CRC-32 of %d MB, %d rounds (hardware acceleration: %s):\n",
+            DATA_SIZE / (1024 * 1024), ROUNDS, crc32_has_hw() ? "yes" : "no");
+
+    t0 = clock();
+    for(r = 0; r < ROUNDS; r++)
+        crc = crc32_bytewise(data, DATA_SIZE);
+    report("byte-at-a-time table:", t0, crc);
+
+    t0 = clock();
+    for(r = 0; r < ROUNDS; r++)
+        crc = crc32_update_sw(0, data, DATA_SIZE);
+    report("slicing-by-16:", t0, crc);
+
+    t0 = clock();
+    for(r = 0; r < ROUNDS; r++)
+        crc = crc32(data, DATA_SIZE);
+    report("crc32():", t0, crc);
+
+    /* Checksumming in 1 MB chunks and merging the results as parallel
+     * workers would do. */
+    t0 = clock();
+    for(r = 0; r < ROUNDS; r++) {
+        size_t chunk = 1024 * 1024;
+
+        crc = 0;
+        for(i = 0; i < DATA_SIZE; i += chunk)
+            crc = crc32_combine(crc, crc32(data + i, chunk), chunk);
+    }
+    report("crc32() + crc32_combine():", t0, crc);
+
+    free(data);
+    return 0;
+}
@@ -0,0 +1,138 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2020 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#include "fenwick.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+
+/* Compares the Fenwick tree with a linear scan over a plain array of sizes,
+ * i.e. what a grid control has to do for mapping a column/row index to its
+ * pixel offset and back when every column/row may have a different size. */
+
+#define LOOKUPS         200000
+
+
+static double
+elapsed(clock_t t0)
+{
+    return (double)(clock() - t0) / CLOCKS_PER_SEC;
+}
+
+static unsigned
+rnd(unsigned* state)
+{
+    *state = *state * 1103515245U + 12345U;
+    return (*state >> 8);
+}
+
+static void
+run(size_t n)
+{
+    FENWICK fw;
+    int64_t* sizes;
+    int64_t* p;
+    int64_t total, sum, pos, check_linear = 0, check_fenwick = 0;
+    size_t i, j, k, lookups;
+    unsigned seed = 42;
+    clock_t t0;
+
+    sizes = (int64_t*) malloc(n * sizeof(int64_t));
+    fenwick_init(&fw);
+    p = fenwick_build_begin(&fw, n);
+    if(sizes == NULL  ||  p == NULL) {
+        fprintf(stderr, "Out of memory.\n");
+        exit(1);
+    }
+
+    t0 = clock();
+    for(i = 0; i < n; i++)
+        sizes[i] = p[i] = 16 + rnd(&seed) % 32;
+    fenwick_build_end(&fw);
+    printf("  build:                %8.3f s\n", elapsed(t0));
+    total = fenwick_total(&fw);
+
+    /* The linear scan is way too slow for the big arrays; do fewer lookups
+     * and scale the result. */
+    lookups = LOOKUPS / (n / 1024 + 1);
+    if(lookups < 10)
+        lookups = 10;
+
+    t0 = clock();
+    for(k = 0; k < lookups; k++) {
+        pos = (int64_t) (rnd(&seed) % (unsigned) total);
+        for(j = 0, sum = 0; j < n  &&  sum + sizes[j] <= pos; j++)
+            sum += sizes[j];
+        check_linear += (int64_t) j;
+    }
+    printf("  linear x -> index:    %8.3f s / %u lookups\n",
+            elapsed(t0) * LOOKUPS / lookups, (unsigned) LOOKUPS);
+
+    t0 = clock();
+    for(k = 0; k < LOOKUPS; k++) {
+        pos = (int64_t) (rnd(&seed) % (unsigned) total);
+        check_fenwick += (int64_t) fenwick_find(&fw, pos);
+    }
+    printf("  fenwick x -> index:   %8.3f s / %u lookups\n",
+            elapsed(t0), (unsigned) LOOKUPS);
+
+    t0 = clock();
+    for(k = 0; k < LOOKUPS; k++) {
+        i = rnd(&seed) % n;
+        check_fenwick += fenwick_prefix_sum(&fw, i);
+    }
+    printf("  fenwick index -> x:   %8.3f s / %u lookups\n",
+            elapsed(t0), (unsigned) LOOKUPS);
+
+    t0 = clock();
+    for(k = 0; k < LOOKUPS; k++) {
+        i = rnd(&seed) % n;
+        fenwick_set(&fw, i, 16 + rnd(&seed) % 32);
+    }
+    printf("  fenwick resize item:  %8.3f s / %u updates\n",
+            elapsed(t0), (unsigned) LOOKUPS);
+
+    /* Prevent the compiler from optimizing the loops away. */
+    if(check_linear == 1  &&  check_fenwick == 1)
+        printf("\n");
+
+    fenwick_fini(&fw);
+    free(sizes);
+}
+
+int
+main(int argc, char** argv)
+{
+    static const size_t counts[] = { 1000, 65535, 1000000, 10000000 };
+    size_t i;
+
+    for(i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+        printf("%u items:\n", (unsigned) counts[i]);
+        run(counts[i]);
+    }
+
+    return 0;
+}
@@ -0,0 +1,106 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2020 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "fnv1a.h"
+#include "xxh3.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+
+/* Compares throughput of the hash functions for various input sizes. */
+
+#define DATA_SIZE       (1024 * 1024)
+#define TOTAL_BYTES     ((double) 256 * 1024 * 1024)
+
+
+static double
+elapsed(clock_t t0)
+{
+    return (double)(clock() - t0) / CLOCKS_PER_SEC;
+}
+
+static void
+report(const char* name, size_t size, clock_t t0, uint64_t sink)
+{
+    double secs = elapsed(t0);
+
+    printf("  %-10s %8u B:  %8.3f s  %10.1f MB/s  (%016llx)\n", name, (unsigned) size,
+            secs, (secs > 0.0) ? TOTAL_BYTES / (1024.0 * 1024.0) / secs : 0.0,
+            (unsigned long long) sink);
+}
+
+int
+main(int argc, char** argv)
+{
+    static const size_t sizes[] = { 8, 16, 32, 64, 256, 1024, 64 * 1024, DATA_SIZE };
+    uint8_t* data;
+    uint64_t sink;
+    clock_t t0;
+    size_t i, j, k, iters;
+
+    data = (uint8_t*) malloc(DATA_SIZE);
+    if(data == NULL) {
+        fprintf(stderr, "Out of memory.\n");
+        return 1;
+    }
+    for(i = 0; i < DATA_SIZE; i++)
+        data[i] = (uint8_t) (i * 2654435761U >> 24);
+
+    for(i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        size_t size = sizes[i];
+
+        /* Hash TOTAL_BYTES in total. For small sizes, walk over the buffer
+         * so each key is different. Feed the previous result into the next
+         * call so the compiler can not hoist the work out of the loop. */
+        iters = (size_t) (TOTAL_BYTES / size);
+
+        printf("Input size %u B:\n", (unsigned) size);
+
+        t0 = clock();
+        sink = FNV1A_BASE_64;
+        for(j = 0, k = 0; j < iters; j++) {
+            sink = fnv1a_64(sink, data + k, size);
+            k += size;
+            if(k + size > DATA_SIZE)
+                k = 0;
+        }
+        report("fnv1a_64", size, t0, sink);
+
+        t0 = clock();
+        sink = 0;
+        for(j = 0, k = 0; j < iters; j++) {
+            sink = xxh3_64(sink, data + k, size);
+            k += size;
+            if(k + size > DATA_SIZE)
+                k = 0;
+        }
+        report("xxh3_64", size, t0, sink);
+    }
+
+    free(data);
+    return 0;
+}
@@ -0,0 +1,98 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2020 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#include "hex.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+
+/* Compares throughput of hex_encode() and hex_decode() with and without the
+ * SIMD kernels. */
+
+#define DATA_SIZE       (1024 * 1024)
+#define TOTAL_BYTES     ((double) 512 * 1024 * 1024)
+
+
+extern int hex_test_disable_simd;
+
+
+static double
+elapsed(clock_t t0)
+{
+    return (double)(clock() - t0) / CLOCKS_PER_SEC;
+}
+
+static void
+report(const char* name, clock_t t0)
+{
+    double secs = elapsed(t0);
+
+    printf("  %-10s %8.3f s  %10.1f MB/s\n", name, secs,
+            (secs > 0.0) ? TOTAL_BYTES / (1024.0 * 1024.0) / secs : 0.0);
+}
+
+int
+main(int argc, char** argv)
+{
+    unsigned char* data;
+    char* text;
+    size_t i, j, iters;
+    clock_t t0;
+    int simd;
+
+    data = (unsigned char*) malloc(DATA_SIZE);
+    text = (char*) malloc(2 * DATA_SIZE + 1);
+    if(data == NULL  ||  text == NULL) {
+        fprintf(stderr, "Out of memory.\n");
+        return 1;
+    }
+    for(i = 0; i < DATA_SIZE; i++)
+        data[i] = (unsigned char) (i * 2654435761U >> 24);
+
+    /* Byte counts are of the binary side. */
+    iters = (size_t) (TOTAL_BYTES / DATA_SIZE);
+
+    for(simd = 1; simd >= 0; simd--) {
+        hex_test_disable_simd = !simd;
+        printf("%s:\n", simd ? "SIMD" : "Plain C");
+
+        t0 = clock();
+        for(j = 0; j < iters; j++)
+            hex_encode(data, DATA_SIZE, text, 2 * DATA_SIZE + 1, (int) (j & 1));
+        report("encode", t0);
+
+        t0 = clock();
+        for(j = 0; j < iters; j++) {
+            if(hex_decode(text, 2 * DATA_SIZE, data, DATA_SIZE) != DATA_SIZE)
+                fprintf(stderr, "Decoding failed.\n");
+        }
+        report("decode", t0);
+    }
+
+    free(data);
+    free(text);
+    return 0;
+}
@@ -0,0 +1,129 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2020 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "intern.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+
+/* Compares a private heap copy of each string with the intern pool, for
+ * data where a limited set of values repeats many times (e.g. a status
+ * column of a log). */
+
+static double
+elapsed(clock_t t0)
+{
+    return (double)(clock() - t0) / CLOCKS_PER_SEC;
+}
+
+static unsigned
+rnd(unsigned* state)
+{
+    *state = *state * 1103515245U + 12345U;
+    return (*state >> 8);
+}
+
+static void
+run(size_t n, unsigned distinct)
+{
+    const char** copies;
+    const char** pooled;
+    INTERN pool;
+    INTERN_STATS stats;
+    char buf[64];
+    size_t i, len, bytes = 0, eq_copies = 0, eq_pooled = 0;
+    unsigned seed;
+    clock_t t0;
+
+    copies = (const char**) malloc(n * sizeof(const char*));
+    pooled = (const char**) malloc(n * sizeof(const char*));
+    if(copies == NULL  ||  pooled == NULL) {
+        fprintf(stderr, "Out of memory.\n");
+        exit(1);
+    }
+    intern_init(&pool);
+
+    seed = 42;
+    t0 = clock();
+    for(i = 0; i < n; i++) {
+        len = sprintf(buf, "host-%u.example.com", rnd(&seed) % distinct);
+        copies[i] = strdup(buf);
+        bytes += len + 1;
+    }
+    printf("  strdup():               %8.3f s\n", elapsed(t0));
+
+    seed = 42;
+    t0 = clock();
+    for(i = 0; i < n; i++) {
+        len = sprintf(buf, "host-%u.example.com", rnd(&seed) % distinct);
+        pooled[i] = (const char*) intern_acquire(&pool, buf, len);
+    }
+    printf("  intern_acquire():       %8.3f s\n", elapsed(t0));
+
+    t0 = clock();
+    for(i = 1; i < n; i++)
+        eq_copies += (strcmp(copies[i-1], copies[i]) == 0);
+    printf("  compare (strcmp):       %8.3f s\n", elapsed(t0));
+
+    t0 = clock();
+    for(i = 1; i < n; i++)
+        eq_pooled += (pooled[i-1] == pooled[i]);
+    printf("  compare (pointers):     %8.3f s\n", elapsed(t0));
+    if(eq_copies != eq_pooled)
+        printf("  MISMATCH!\n");
+
+    intern_stats(&pool, &stats);
+    printf("  copies: %u KB, pool: %u KB, saved %u KB, hit rate %.1f %%\n",
+            (unsigned) (bytes >> 10), (unsigned) (stats.bytes >> 10),
+            (unsigned) (stats.bytes_saved >> 10),
+            100.0 * (double) stats.hits / (double) stats.lookups);
+
+    t0 = clock();
+    for(i = 0; i < n; i++)
+        free((void*) copies[i]);
+    printf("  free():                 %8.3f s\n", elapsed(t0));
+
+    t0 = clock();
+    for(i = 0; i < n; i++)
+        intern_release(&pool, pooled[i]);
+    printf("  intern_release():       %8.3f s\n", elapsed(t0));
+
+    intern_fini(&pool);
+    free(copies);
+    free(pooled);
+}
+
+int
+main(int argc, char** argv)
+{
+    printf("1000000 strings, 50 distinct:\n");
+    run(1000000, 50);
+    printf("1000000 strings, 100000 distinct:\n");
+    run(1000000, 100000);
+    return 0;
+}
@@ -0,0 +1,119 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2020 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "mempool.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+
+/* Simulates churn of tree nodes: Keeps a working set of live nodes and
+ * repeatedly frees a random one of them and allocates a new one. */
+
+#define NODE_SIZE       48
+#define LIVE_COUNT      (256 * 1024)
+#define CHURN_COUNT     (16 * 1024 * 1024)
+
+
+static unsigned
+rnd(unsigned* state)
+{
+    /* xorshift32 */
+    unsigned x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static double
+bench_malloc(void** live)
+{
+    unsigned state = 0x12345678;
+    clock_t t0;
+    int i;
+
+    t0 = clock();
+    for(i = 0; i < LIVE_COUNT; i++) {
+        live[i] = malloc(NODE_SIZE);
+        memset(live[i], 0, NODE_SIZE);
+    }
+    for(i = 0; i < CHURN_COUNT; i++) {
+        unsigned k = rnd(&state) % LIVE_COUNT;
+        free(live[k]);
+        live[k] = malloc(NODE_SIZE);
+        memset(live[k], 0, NODE_SIZE);
+    }
+    for(i = 0; i < LIVE_COUNT; i++)
+        free(live[i]);
+
+    return (double)(clock() - t0) / CLOCKS_PER_SEC;
+}
+
+static double
+bench_mempool(void** live)
+{
+    unsigned state = 0x12345678;
+    MEMPOOL pool;
+    clock_t t0;
+    int i;
+
+    t0 = clock();
+    mempool_init(&pool, 0);
+    for(i = 0; i < LIVE_COUNT; i++) {
+        live[i] = mempool_alloc(&pool, NODE_SIZE);
+        memset(live[i], 0, NODE_SIZE);
+    }
+    for(i = 0; i < CHURN_COUNT; i++) {
+        unsigned k = rnd(&state) % LIVE_COUNT;
+        mempool_free(&pool, live[k], NODE_SIZE);
+        live[k] = mempool_alloc(&pool, NODE_SIZE);
+        memset(live[k], 0, NODE_SIZE);
+    }
+    mempool_fini(&pool);
+
+    return (double)(clock() - t0) / CLOCKS_PER_SEC;
+}
+
+int
+main(void)
+{
+    void** live;
+
+    live = (void**) malloc(LIVE_COUNT * sizeof(void*));
+    if(live == NULL)
+        return 1;
+
+    printf("Node churn (%d live nodes of %d bytes, %d free+alloc pairs):\n",
+           LIVE_COUNT, NODE_SIZE, CHURN_COUNT);
+    printf("  malloc()/free():          %.3f s\n", bench_malloc(live));
+    printf("  mempool_alloc()/free():   %.3f s\n", bench_mempool(live));
+
+    free(live);
+    return 0;
+}
@@ -0,0 +1,180 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2020 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "msort.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+
+/* Sorting rows of a big table by a text column: qsort() versus msort() and
+ * msort_parallel(), and keeping the order up to date after a single cell
+ * change by re-inserting the row versus re-sorting everything.
+ *
+ * The parallel sort spreads the work among threads, so we measure the wall
+ * clock time here, not the CPU time.
+ */
+
+static double
+now(void)
+{
+    struct timespec ts;
+
+    timespec_get(&ts, TIME_UTC);
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
+
+static unsigned
+rnd(unsigned* state)
+{
+    *state = *state * 1103515245U + 12345U;
+    return (*state >> 8);
+}
+
+static char** cmp_texts;
+
+static int
+cmp_rows(size_t a, size_t b, void* ctx)
+{
+    char** texts = (char**) ctx;
+
+    if(texts[a] == texts[b])
+        return 0;
+    return strcmp(texts[a], texts[b]);
+}
+
+static int
+cmp_rows_qsort(const void* a, const void* b)
+{
+    size_t ra = *(const size_t*) a;
+    size_t rb = *(const size_t*) b;
+    int cmp;
+
+    /* qsort() is not stable, so break the ties by the row index. */
+    cmp = strcmp(cmp_texts[ra], cmp_texts[rb]);
+    if(cmp != 0)
+        return cmp;
+    return (ra < rb) ? -1 : +1;
+}
+
+static void
+reset(size_t* rows, size_t n)
+{
+    size_t i;
+
+    for(i = 0; i < n; i++)
+        rows[i] = i;
+}
+
+static void
+run(size_t n, unsigned distinct)
+{
+    char** texts;
+    size_t* rows;
+    size_t i, pos;
+    char buf[32];
+    unsigned seed = 42;
+    double t0;
+
+    texts = (char**) malloc(n * sizeof(char*));
+    rows = (size_t*) malloc(n * sizeof(size_t));
+    if(texts == NULL  ||  rows == NULL) {
+        fprintf(stderr, "Out of memory.\n");
+        exit(1);
+    }
+    for(i = 0; i < n; i++) {
+        sprintf(buf, "item #%u", rnd(&seed) % distinct);
+        texts[i] = strdup(buf);
+    }
+
+    reset(rows, n);
+    cmp_texts = texts;
+    t0 = now();
+    qsort(rows, n, sizeof(size_t), cmp_rows_qsort);
+    printf("  qsort:                  %8.3f s\n", now() - t0);
+
+    reset(rows, n);
+    t0 = now();
+    msort(rows, n, cmp_rows, texts);
+    printf("  msort:                  %8.3f s\n", now() - t0);
+
+    reset(rows, n);
+    t0 = now();
+    msort_parallel(rows, n, cmp_rows, texts, 0);
+    printf("  msort_parallel:         %8.3f s\n", now() - t0);
+
+    t0 = now();
+    msort(rows, n, cmp_rows, texts);
+    printf("  msort (sorted input):   %8.3f s\n", now() - t0);
+
+    /* Change some cells and keep the order up to date. */
+    t0 = now();
+    for(i = 0; i < 100; i++) {
+        size_t row = rows[rnd(&seed) % n];
+
+        for(pos = 0; rows[pos] != row; pos++);
+        memmove(rows + pos, rows + pos + 1, (n - pos - 1) * sizeof(size_t));
+        free(texts[row]);
+        sprintf(buf, "item #%u", rnd(&seed) % distinct);
+        texts[row] = strdup(buf);
+        pos = msort_upper_bound(rows, n - 1, row, cmp_rows, texts);
+        memmove(rows + pos + 1, rows + pos, (n - pos - 1) * sizeof(size_t));
+        rows[pos] = row;
+    }
+    printf("  cell change (re-insert):%8.3f ms\n", (now() - t0) * 1000.0 / 100);
+
+    t0 = now();
+    for(i = 0; i < 10; i++) {
+        size_t row = rnd(&seed) % n;
+
+        free(texts[row]);
+        sprintf(buf, "item #%u", rnd(&seed) % distinct);
+        texts[row] = strdup(buf);
+        reset(rows, n);
+        msort(rows, n, cmp_rows, texts);
+    }
+    printf("  cell change (re-sort):  %8.3f ms\n", (now() - t0) * 1000.0 / 10);
+
+    for(i = 0; i < n; i++)
+        free(texts[i]);
+    free(texts);
+    free(rows);
+}
+
+int
+main(int argc, char** argv)
+{
+    static const size_t counts[] = { 65535, 1000000 };
+    size_t i;
+
+    for(i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+        printf("%u rows:\n", (unsigned) counts[i]);
+        run(counts[i], 50000);
+    }
+
+    return 0;
+}
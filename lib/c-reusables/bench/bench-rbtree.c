@@ -0,0 +1,119 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2020 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "rbtree.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+
+/* Compares ways of loading a large sorted sequence of records into a tree. */
+
+#define RECORD_COUNT    (4 * 1024 * 1024)
+
+
+typedef struct RECORD {
+    RBTREE_NODE the_node;
+    unsigned key;
+} RECORD;
+
+static int
+record_cmp(const RBTREE_NODE* node1, const RBTREE_NODE* node2)
+{
+    unsigned key1 = RBTREE_DATA(node1, RECORD, the_node)->key;
+    unsigned key2 = RBTREE_DATA(node2, RECORD, the_node)->key;
+
+    if(key1 < key2)
+        return -1;
+    if(key1 > key2)
+        return +1;
+    return 0;
+}
+
+static double
+bench_insert(RECORD* records)
+{
+    RBTREE tree = RBTREE_INITIALIZER;
+    clock_t t0;
+    int i;
+
+    t0 = clock();
+    for(i = 0; i < RECORD_COUNT; i++)
+        rbtree_insert(&tree, &records[i].the_node, record_cmp);
+    return (double)(clock() - t0) / CLOCKS_PER_SEC;
+}
+
+static double
+bench_insert_hint(RECORD* records)
+{
+    RBTREE tree = RBTREE_INITIALIZER;
+    RBTREE_CURSOR cur = RBTREE_CURSOR_INITIALIZER;
+    clock_t t0;
+    int i;
+
+    t0 = clock();
+    for(i = 0; i < RECORD_COUNT; i++)
+        rbtree_insert_hint(&tree, &records[i].the_node, record_cmp, &cur);
+    return (double)(clock() - t0) / CLOCKS_PER_SEC;
+}
+
+static double
+bench_build_from_sorted(RECORD* records, RBTREE_NODE** nodes)
+{
+    RBTREE tree = RBTREE_INITIALIZER;
+    clock_t t0;
+    int i;
+
+    t0 = clock();
+    for(i = 0; i < RECORD_COUNT; i++)
+        nodes[i] = &records[i].the_node;
+    rbtree_build_from_sorted(&tree, nodes, RECORD_COUNT);
+    return (double)(clock() - t0) / CLOCKS_PER_SEC;
+}
+
+int
+main(void)
+{
+    RECORD* records;
+    RBTREE_NODE** nodes;
+    int i;
+
+    records = (RECORD*) malloc(RECORD_COUNT * sizeof(RECORD));
+    nodes = (RBTREE_NODE**) malloc(RECORD_COUNT * sizeof(RBTREE_NODE*));
+    if(records == NULL  ||  nodes == NULL)
+        return 1;
+    for(i = 0; i < RECORD_COUNT; i++)
+        records[i].key = i;
+
+    printf("Sorted bulk load (%d records):\n", RECORD_COUNT);
+    printf("  rbtree_insert():              %.3f s\n", bench_insert(records));
+    printf("  rbtree_insert_hint():         %.3f s\n", bench_insert_hint(records));
+    printf("  rbtree_build_from_sorted():   %.3f s\n", bench_build_from_sorted(records, nodes));
+
+    free(nodes);
+    free(records);
+    return 0;
+}
@@ -0,0 +1,227 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2020 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#include "region.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+
+/* Exercises the region the way a grid control uses it for its selection,
+ * on a table with ten million rows. */
+
+#define COL_COUNT       20
+#define ROW_COUNT       10000000
+
+
+static double
+elapsed(clock_t t0)
+{
+    return (double)(clock() - t0) / CLOCKS_PER_SEC;
+}
+
+static unsigned
+rnd(unsigned* state)
+{
+    *state = *state * 1103515245U + 12345U;
+    return (*state >> 8);
+}
+
+/* How region_contains_xy() used to work: A linear scan of the rects. Kept
+ * here for comparison. */
+static int
+linear_contains_xy(const REGION* rgn, uint32_t x, uint32_t y)
+{
+    const REGION_RECT* vec;
+    uint32_t i, n;
+
+    n = region_rects(rgn, &vec);
+    for(i = 0; i < n; i++) {
+        if(vec[i].y1 <= y)
+            continue;
+        if(vec[i].y0 > y)
+            break;
+        if(vec[i].x1 <= x)
+            continue;
+        return (vec[i].x0 <= x);
+    }
+    return 0;
+}
+
+/* Test all cells of a "page" (as painting does), starting at a random row. */
+#define PAGE_ROWS       50
+#define PAGE_COUNT      200
+
+static unsigned
+paint(REGION* sel, int how, unsigned seed)
+{
+    REGION_CURSOR cur;
+    uint32_t x, y, y0;
+    unsigned i, hits = 0;
+
+    for(i = 0; i < PAGE_COUNT; i++) {
+        y0 = rnd(&seed) % (ROW_COUNT - PAGE_ROWS);
+        region_cursor_init(&cur, sel);
+        for(y = y0; y < y0 + PAGE_ROWS; y++) {
+            for(x = 0; x < COL_COUNT; x++) {
+                switch(how) {
+                    case 0:  hits += linear_contains_xy(sel, x, y); break;
+                    case 1:  hits += region_contains_xy(sel, x, y); break;
+                    default: hits += region_cursor_contains_xy(&cur, x, y); break;
+                }
+            }
+        }
+    }
+
+    return hits;
+}
+
+static void
+replace(REGION* rgn, REGION* tmp)
+{
+    region_fini(rgn);
+    *rgn = *tmp;
+}
+
+static void
+fail(void)
+{
+    fprintf(stderr, "Out of memory.\n");
+    exit(1);
+}
+
+int
+main(int argc, char** argv)
+{
+    REGION sel, rc_rgn, tmp;
+    REGION_RECT rc;
+    REGION_RECT* rects;
+    const REGION_RECT* vec;
+    unsigned seed = 42;
+    unsigned i, n, hits = 0;
+    clock_t t0;
+
+    /* Select all, then toggle scattered cells (Ctrl+click). */
+    region_rect_set(&rc, 0, 0, COL_COUNT, ROW_COUNT);
+    region_init_with_rect(&sel, &rc);
+    t0 = clock();
+    for(i = 0; i < 5000; i++) {
+        region_init_with_xy(&rc_rgn, rnd(&seed) % COL_COUNT, rnd(&seed) % ROW_COUNT);
+        if(region_xor(&tmp, &sel, &rc_rgn) != 0)
+            fail();
+        region_fini(&rc_rgn);
+        replace(&sel, &tmp);
+    }
+    n = region_rects(&sel, &vec);
+    printf("toggle 5000 cells:          %8.3f s  (%u rects)\n", elapsed(t0), n);
+
+    /* Hit test the resulting selection (as painting does for each cell). */
+    t0 = clock();
+    for(i = 0; i < 20000; i++) {
+        if(region_contains_xy(&sel, rnd(&seed) % COL_COUNT, rnd(&seed) % ROW_COUNT))
+            hits++;
+    }
+    printf("contains_xy() x 20000:      %8.3f s  (%u hits)\n", elapsed(t0), hits);
+
+    /* Paint pages of the selection. */
+    t0 = clock();
+    hits = paint(&sel, 0, seed);
+    printf("paint %d pages (linear):   %8.3f s  (%u hits)\n", PAGE_COUNT, elapsed(t0), hits);
+    t0 = clock();
+    hits = paint(&sel, 1, seed);
+    printf("paint %d pages (bsearch):  %8.3f s  (%u hits)\n", PAGE_COUNT, elapsed(t0), hits);
+    t0 = clock();
+    hits = paint(&sel, 2, seed);
+    printf("paint %d pages (cursor):   %8.3f s  (%u hits)\n", PAGE_COUNT, elapsed(t0), hits);
+    region_fini(&sel);
+
+    /* Shift+click row ranges top to bottom (each union adds a band below all
+     * the existing ones). */
+    region_init(&sel);
+    seed = 4242;
+    t0 = clock();
+    for(i = 0; i < 5000; i++) {
+        uint32_t y0 = i * (ROW_COUNT / 5000);
+        region_rect_set(&rc, 0, y0, COL_COUNT, y0 + 1 + rnd(&seed) % 1000);
+        region_init_with_rect(&rc_rgn, &rc);
+        if(region_union(&tmp, &sel, &rc_rgn) != 0)
+            fail();
+        region_fini(&rc_rgn);
+        replace(&sel, &tmp);
+    }
+    n = region_rects(&sel, &vec);
+    printf("union 5000 row ranges:      %8.3f s  (%u rects)\n", elapsed(t0), n);
+    region_fini(&sel);
+
+    /* The same, in place (appending bands below). */
+    region_init(&sel);
+    seed = 4242;
+    t0 = clock();
+    for(i = 0; i < 5000; i++) {
+        uint32_t y0 = i * (ROW_COUNT / 5000);
+        region_rect_set(&rc, 0, y0, COL_COUNT, y0 + 1 + rnd(&seed) % 1000);
+        if(region_union_rect(&sel, &rc) != 0)
+            fail();
+    }
+    n = region_rects(&sel, &vec);
+    printf("union 5000 (in place):      %8.3f s  (%u rects)\n", elapsed(t0), n);
+    region_fini(&sel);
+
+    /* The same, at once (and in a random order). */
+    rects = (REGION_RECT*) malloc(5000 * sizeof(REGION_RECT));
+    if(rects == NULL)
+        fail();
+    seed = 4242;
+    for(i = 0; i < 5000; i++) {
+        uint32_t y0 = i * (ROW_COUNT / 5000);
+        region_rect_set(&rects[i], 0, y0, COL_COUNT, y0 + 1 + rnd(&seed) % 1000);
+    }
+    for(i = 5000 - 1; i > 0; i--) {
+        unsigned j = rnd(&seed) % (i + 1);
+        rc = rects[i];
+        rects[i] = rects[j];
+        rects[j] = rc;
+    }
+    t0 = clock();
+    if(region_init_with_rects(&sel, rects, 5000) != 0)
+        fail();
+    n = region_rects(&sel, &vec);
+    printf("union 5000 (batch):         %8.3f s  (%u rects)\n", elapsed(t0), n);
+    free(rects);
+
+    /* Deselect a column in all of them. */
+    region_rect_set(&rc, 3, 0, 4, ROW_COUNT);
+    region_init_with_rect(&rc_rgn, &rc);
+    t0 = clock();
+    if(region_subtract(&tmp, &sel, &rc_rgn) != 0)
+        fail();
+    replace(&sel, &tmp);
+    region_fini(&rc_rgn);
+    n = region_rects(&sel, &vec);
+    printf("subtract a column:          %8.3f s  (%u rects)\n", elapsed(t0), n);
+    region_fini(&sel);
+
+    return 0;
+}
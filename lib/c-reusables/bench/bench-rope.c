@@ -0,0 +1,201 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2020 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "rope.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+
+/* Inserts and removes random rows of a table with about 1M cells, stored
+ * column by column, either in plain C arrays (each insertion moves the rest
+ * of every column) or in ropes of row chunks (each insertion touches only one
+ * chunk per column). */
+
+#define COL_COUNT       16
+#define ROW_COUNT       65536       /* 16 * 65536 == 1M cells */
+#define OP_COUNT        10000
+
+typedef struct CELL {
+    char* text;
+    intptr_t lp;
+    uint32_t flags;
+} CELL;
+
+static double
+elapsed(clock_t t0)
+{
+    return (double)(clock() - t0) / CLOCKS_PER_SEC;
+}
+
+static unsigned
+rnd(unsigned* state)
+{
+    *state = *state * 1103515245U + 12345U;
+    return (*state >> 8);
+}
+
+static void
+run_arrays(void)
+{
+    CELL* cols[COL_COUNT];
+    size_t n = ROW_COUNT;
+    size_t i, j, pos;
+    unsigned seed = 42;
+    uintptr_t sum = 0;
+    clock_t t0;
+
+    for(j = 0; j < COL_COUNT; j++) {
+        cols[j] = (CELL*) calloc(ROW_COUNT + OP_COUNT, sizeof(CELL));
+        if(cols[j] == NULL) {
+            fprintf(stderr, "Out of memory.\n");
+            exit(1);
+        }
+    }
+
+    t0 = clock();
+    for(i = 0; i < OP_COUNT; i++) {
+        pos = rnd(&seed) % (n + 1);
+        for(j = 0; j < COL_COUNT; j++) {
+            memmove(cols[j] + pos + 1, cols[j] + pos, (n - pos) * sizeof(CELL));
+            memset(cols[j] + pos, 0, sizeof(CELL));
+            cols[j][pos].lp = (intptr_t) i;
+        }
+        n++;
+    }
+    printf("  arrays insert:          %8.3f s\n", elapsed(t0));
+
+    t0 = clock();
+    for(i = 0; i < OP_COUNT; i++) {
+        pos = rnd(&seed) % n;
+        for(j = 0; j < COL_COUNT; j++)
+            memmove(cols[j] + pos, cols[j] + pos + 1, (n - pos - 1) * sizeof(CELL));
+        n--;
+    }
+    printf("  arrays remove:          %8.3f s\n", elapsed(t0));
+
+    t0 = clock();
+    for(i = 0; i < n; i++) {
+        for(j = 0; j < COL_COUNT; j++)
+            sum += (uintptr_t) cols[j][i].lp;
+    }
+    printf("  arrays scan:            %8.3f s  (%u)\n", elapsed(t0), (unsigned) sum);
+
+    for(j = 0; j < COL_COUNT; j++)
+        free(cols[j]);
+}
+
+static void
+run_ropes(size_t chunk_cap)
+{
+    ROPE cols[COL_COUNT];
+    size_t n = ROW_COUNT;
+    size_t i, j, pos, span;
+    unsigned seed = 42;
+    uintptr_t sum = 0;
+    clock_t t0;
+
+    for(j = 0; j < COL_COUNT; j++) {
+        rope_init(&cols[j], sizeof(CELL), chunk_cap);
+        if(rope_insert(&cols[j], 0, ROW_COUNT) != 0) {
+            fprintf(stderr, "Out of memory.\n");
+            exit(1);
+        }
+    }
+
+    t0 = clock();
+    for(i = 0; i < OP_COUNT; i++) {
+        pos = rnd(&seed) % (n + 1);
+        for(j = 0; j < COL_COUNT; j++) {
+            if(rope_insert(&cols[j], pos, 1) != 0) {
+                fprintf(stderr, "Out of memory.\n");
+                exit(1);
+            }
+            ((CELL*) rope_get(&cols[j], pos))->lp = (intptr_t) i;
+        }
+        n++;
+    }
+    printf("  ropes insert:           %8.3f s\n", elapsed(t0));
+
+    t0 = clock();
+    for(i = 0; i < OP_COUNT; i++) {
+        pos = rnd(&seed) % n;
+        for(j = 0; j < COL_COUNT; j++)
+            rope_remove(&cols[j], pos, 1);
+        n--;
+    }
+    printf("  ropes remove:           %8.3f s\n", elapsed(t0));
+
+    t0 = clock();
+    for(i = 0; i < n; i++) {
+        for(j = 0; j < COL_COUNT; j++)
+            sum += (uintptr_t) ((CELL*) rope_get(&cols[j], i))->lp;
+    }
+    printf("  ropes scan (get):       %8.3f s  (%u)\n", elapsed(t0), (unsigned) sum);
+
+    sum = 0;
+    t0 = clock();
+    for(j = 0; j < COL_COUNT; j++) {
+        for(i = 0; i < n; i += span) {
+            CELL* cells = (CELL*) rope_span(&cols[j], i, &span);
+            size_t k;
+
+            for(k = 0; k < span; k++)
+                sum += (uintptr_t) cells[k].lp;
+        }
+    }
+    printf("  ropes scan (span):      %8.3f s  (%u)\n", elapsed(t0), (unsigned) sum);
+
+    t0 = clock();
+    for(i = 0; i < OP_COUNT * 10; i++) {
+        pos = rnd(&seed) % n;
+        sum += (uintptr_t) ((CELL*) rope_get(&cols[i % COL_COUNT], pos))->lp;
+    }
+    printf("  ropes random get:       %8.3f s  (%u)\n", elapsed(t0), (unsigned) sum);
+
+    for(j = 0; j < COL_COUNT; j++)
+        rope_fini(&cols[j]);
+}
+
+int
+main(int argc, char** argv)
+{
+    static const size_t caps[] = { 64, 256, 1024 };
+    size_t i;
+
+    printf("%u x %u cells, %u random row insertions and removals:\n",
+           COL_COUNT, ROW_COUNT, OP_COUNT);
+    run_arrays();
+
+    for(i = 0; i < sizeof(caps) / sizeof(caps[0]); i++) {
+        printf("chunk_cap %u:\n", (unsigned) caps[i]);
+        run_ropes(caps[i]);
+    }
+
+    return 0;
+}
@@ -0,0 +1,335 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2020 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#include "column.h"
+#include "fenwick.h"
+#include "msort.h"
+#include "rope.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+
+/* Models what a grid control with a big table does with its data, layer by
+ * layer, with 32-bit row indexes:
+ *
+ *  - The table: Cells stored column by column in ropes of row chunks, with
+ *    the values of typed columns in contiguous COLUMNs.
+ *  - The sort view: A permutation of the rows sorted by two keys, the maps
+ *    between the table rows and the view rows, and moving a single row after
+ *    its value has changed.
+ *  - The geometry: Row heights in a Fenwick tree, mapping the scroll position
+ *    to the first visible row, and painting a page of rows through the view.
+ *
+ * (The selection is covered by bench-region.)
+ */
+
+#define COL_COUNT       2           /* One INT64 and one DOUBLE column. */
+#define CHUNK_ROWS      256
+#define ROW_HEIGHT      18
+#define PAGE_ROWS       50
+#define PAGE_COUNT      10000
+#define OP_COUNT        100
+
+typedef struct CELL {
+    char* text;
+    intptr_t lp;
+    uint32_t flags;
+} CELL;
+
+typedef struct TABLE {
+    size_t row_count;
+    ROPE rows;                  /* Row headers. */
+    ROPE cells[COL_COUNT];
+    COLUMN data[COL_COUNT];
+} TABLE;
+
+typedef struct VIEW {
+    TABLE* table;
+    size_t* order;              /* All table rows in the sort order. */
+    uint32_t* positions;        /* Table row -> position in order[]. */
+    uint32_t* rows;             /* View row -> table row. */
+    uint32_t* view_rows;        /* Table row -> view row. */
+} VIEW;
+
+
+static double
+elapsed(clock_t t0)
+{
+    return (double)(clock() - t0) / CLOCKS_PER_SEC;
+}
+
+static unsigned
+rnd(unsigned* state)
+{
+    *state = *state * 1103515245U + 12345U;
+    return (*state >> 8);
+}
+
+static void
+oom(void)
+{
+    fprintf(stderr, "Out of memory.\n");
+    exit(1);
+}
+
+static void
+table_insert(TABLE* table, size_t pos, size_t n)
+{
+    int j;
+
+    if(rope_insert(&table->rows, pos, n) != 0)
+        oom();
+    for(j = 0; j < COL_COUNT; j++) {
+        if(rope_insert(&table->cells[j], pos, n) != 0  ||
+           column_insert(&table->data[j], pos, n) != 0)
+            oom();
+    }
+    table->row_count += n;
+}
+
+static void
+table_remove(TABLE* table, size_t pos, size_t n)
+{
+    int j;
+
+    rope_remove(&table->rows, pos, n);
+    for(j = 0; j < COL_COUNT; j++) {
+        rope_remove(&table->cells[j], pos, n);
+        column_remove(&table->data[j], pos, n);
+    }
+    table->row_count -= n;
+}
+
+/* The sort keys: The INT64 column (with many duplicates) ascending, then the
+ * DOUBLE column descending. */
+static int
+view_cmp(size_t row1, size_t row2, void* ctx)
+{
+    TABLE* table = (TABLE*) ctx;
+    int64_t i1 = column_get_int64(&table->data[0], row1);
+    int64_t i2 = column_get_int64(&table->data[0], row2);
+    uint64_t d1, d2;
+
+    if(i1 != i2)
+        return (i1 < i2) ? -1 : +1;
+
+    d1 = column_double_key(column_get_double(&table->data[1], row1));
+    d2 = column_double_key(column_get_double(&table->data[1], row2));
+    if(d1 != d2)
+        return (d1 > d2) ? -1 : +1;
+
+    return (row1 < row2) ? -1 : (row1 > row2 ? +1 : 0);
+}
+
+static void
+view_reindex(VIEW* view)
+{
+    size_t i, n = view->table->row_count;
+
+    for(i = 0; i < n; i++) {
+        uint32_t row = (uint32_t) view->order[i];
+        view->positions[row] = (uint32_t) i;
+        view->view_rows[row] = (uint32_t) i;
+        view->rows[i] = row;
+    }
+}
+
+static void
+view_sort(VIEW* view)
+{
+    TABLE* table = view->table;
+    size_t i, n = table->row_count;
+
+    for(i = 0; i < n; i++)
+        view->order[i] = i;
+    if(column_sort(&table->data[1], view->order, n, COLUMN_SORT_DESC, NULL) != 0  ||
+       column_sort(&table->data[0], view->order, n, 0, NULL) != 0)
+        oom();
+    view_reindex(view);
+}
+
+/* The value of the row has changed: Move it to its new place in order[], and
+ * renumber only the rows it has passed over. */
+static void
+view_move_row(VIEW* view, uint32_t row)
+{
+    TABLE* table = view->table;
+    size_t n = table->row_count;
+    size_t old_pos = view->positions[row];
+    size_t new_pos, pos, pos0, pos1;
+
+    if(old_pos > 0  &&  view_cmp(row, view->order[old_pos-1], table) < 0) {
+        new_pos = msort_upper_bound(view->order, old_pos, row, view_cmp, table);
+        memmove(view->order + new_pos + 1, view->order + new_pos,
+                (old_pos - new_pos) * sizeof(size_t));
+        pos0 = new_pos;
+        pos1 = old_pos + 1;
+    } else if(old_pos + 1 < n  &&  view_cmp(row, view->order[old_pos+1], table) > 0) {
+        new_pos = old_pos + msort_upper_bound(view->order + old_pos + 1,
+                    n - old_pos - 1, row, view_cmp, table);
+        memmove(view->order + old_pos, view->order + old_pos + 1,
+                (new_pos - old_pos) * sizeof(size_t));
+        pos0 = old_pos;
+        pos1 = new_pos + 1;
+    } else {
+        return;
+    }
+    view->order[new_pos] = row;
+
+    for(pos = pos0; pos < pos1; pos++) {
+        uint32_t r = (uint32_t) view->order[pos];
+        view->positions[r] = (uint32_t) pos;
+        view->view_rows[r] = (uint32_t) pos;
+        view->rows[pos] = r;
+    }
+}
+
+static void
+run(size_t n)
+{
+    TABLE table;
+    VIEW view;
+    FENWICK fw;
+    int64_t* heights;
+    size_t i, k;
+    int j;
+    unsigned seed = 42;
+    uintptr_t check = 0;
+    clock_t t0;
+
+    /* The table. */
+    t0 = clock();
+    table.row_count = 0;
+    rope_init(&table.rows, sizeof(CELL), CHUNK_ROWS);
+    column_init(&table.data[0], COLUMN_INT64);
+    column_init(&table.data[1], COLUMN_DOUBLE);
+    for(j = 0; j < COL_COUNT; j++)
+        rope_init(&table.cells[j], sizeof(CELL), CHUNK_ROWS);
+    table_insert(&table, 0, n);
+    for(i = 0; i < n; i++) {
+        column_set_int64(&table.data[0], i, rnd(&seed) % 1000);
+        column_set_double(&table.data[1], i, (double) rnd(&seed) / 1024.0);
+    }
+    printf("  table build:            %8.3f s\n", elapsed(t0));
+
+    t0 = clock();
+    for(k = 0; k < OP_COUNT; k++) {
+        i = rnd(&seed) % (table.row_count + 1);
+        table_insert(&table, i, 1);
+        column_set_int64(&table.data[0], i, rnd(&seed) % 1000);
+        column_set_double(&table.data[1], i, (double) rnd(&seed) / 1024.0);
+    }
+    for(k = 0; k < OP_COUNT; k++)
+        table_remove(&table, rnd(&seed) % table.row_count, 1);
+    printf("  table insert/remove:    %8.3f s / %u rows\n", elapsed(t0), (unsigned) (2 * OP_COUNT));
+
+    /* The sort view. */
+    view.table = &table;
+    view.order = (size_t*) malloc(n * sizeof(size_t));
+    view.positions = (uint32_t*) malloc(n * sizeof(uint32_t));
+    view.rows = (uint32_t*) malloc(n * sizeof(uint32_t));
+    view.view_rows = (uint32_t*) malloc(n * sizeof(uint32_t));
+    if(view.order == NULL  ||  view.positions == NULL  ||  view.rows == NULL  ||
+       view.view_rows == NULL)
+        oom();
+
+    t0 = clock();
+    view_sort(&view);
+    printf("  view sort (2 keys):     %8.3f s\n", elapsed(t0));
+
+    t0 = clock();
+    for(k = 0; k < OP_COUNT; k++) {
+        uint32_t row = rnd(&seed) % n;
+        column_set_int64(&table.data[0], row, rnd(&seed) % 1000);
+        view_move_row(&view, row);
+    }
+    printf("  view move row:          %8.3f s / %u rows\n", elapsed(t0), (unsigned) OP_COUNT);
+
+    /* The geometry. */
+    t0 = clock();
+    fenwick_init(&fw);
+    heights = fenwick_build_begin(&fw, n);
+    if(heights == NULL)
+        oom();
+    for(i = 0; i < n; i++)
+        heights[i] = ROW_HEIGHT;
+    fenwick_build_end(&fw);
+    printf("  geometry build:         %8.3f s\n", elapsed(t0));
+
+    t0 = clock();
+    for(k = 0; k < OP_COUNT; k++)
+        fenwick_set(&fw, rnd(&seed) % n, ROW_HEIGHT + rnd(&seed) % ROW_HEIGHT);
+    printf("  geometry resize row:    %8.3f s / %u rows\n", elapsed(t0), (unsigned) OP_COUNT);
+
+    /* Paint random pages: Find the first visible row from the scroll
+     * position, and fetch the cells of the page through the view. */
+    t0 = clock();
+    for(k = 0; k < PAGE_COUNT; k++) {
+        int64_t y = (int64_t) (rnd(&seed) % (unsigned) (fenwick_total(&fw) - PAGE_ROWS * 2 * ROW_HEIGHT));
+        size_t row0 = fenwick_find(&fw, y);
+
+        for(i = row0; i < row0 + PAGE_ROWS  &&  i < n; i++) {
+            uint32_t row = view.rows[i];
+
+            check += (uintptr_t) ((CELL*) rope_get(&table.rows, row))->lp;
+            for(j = 0; j < COL_COUNT; j++)
+                check += (uintptr_t) ((CELL*) rope_get(&table.cells[j], row))->flags;
+            check += (uintptr_t) column_get_int64(&table.data[0], row);
+        }
+    }
+    printf("  paint page:             %8.3f s / %u pages\n", elapsed(t0), (unsigned) PAGE_COUNT);
+
+    /* Prevent the compiler from optimizing the loops away. */
+    if(check == 1)
+        printf("\n");
+
+    fenwick_fini(&fw);
+    free(view.order);
+    free(view.positions);
+    free(view.rows);
+    free(view.view_rows);
+    rope_fini(&table.rows);
+    for(j = 0; j < COL_COUNT; j++) {
+        rope_fini(&table.cells[j]);
+        column_fini(&table.data[j]);
+    }
+}
+
+int
+main(void)
+{
+    static const size_t counts[] = { 65535, 1000000, 10000000 };
+    size_t i;
+
+    for(i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+        printf("%u rows:\n", (unsigned) counts[i]);
+        run(counts[i]);
+    }
+
+    return 0;
+}
@@ -0,0 +1,755 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2020 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "btree.h"
+
+#include <string.h>
+
+#if defined __AVX2__
+    #include <immintrin.h>
+    #define BTREE_SIMD_AVX2     1
+#elif defined __SSE4_2__
+    #include <nmmintrin.h>
+    #define BTREE_SIMD_SSE42    1
+#elif defined __aarch64__  ||  defined _M_ARM64
+    #include <arm_neon.h>
+    #define BTREE_SIMD_NEON     1
+#endif
+
+
+/* Max. count of keys in a node. The key array spans exactly four 64-byte
+ * cache lines and it is always searched as a whole, with no data dependent
+ * branching. Unused slots are padded with KEY_PAD so they never compare lower
+ * then any searched key. */
+#define MAX_KEYS        32
+#define KEY_PAD         INT64_MAX
+
+/* Min. count of keys in a non-root node. */
+#define MIN_KEYS        (MAX_KEYS / 2 - 1)
+
+
+typedef struct LEAF {
+    BTREE_KEY keys[MAX_KEYS];
+    unsigned n;
+    void* data[MAX_KEYS];
+    struct LEAF* prev;
+    struct LEAF* next;
+} LEAF;
+
+/* Inner node: Subtree children[i] holds keys lower then keys[i], and subtree
+ * children[i+1] holds keys equal or greater then keys[i].
+ *
+ * Note both the node types start with the same members, so we may access
+ * keys and n of any node as if it were INNER. */
+typedef struct INNER {
+    BTREE_KEY keys[MAX_KEYS];
+    unsigned n;
+    void* children[MAX_KEYS + 1];
+} INNER;
+
+
+/*************************
+ ***   Key searching   ***
+ *************************/
+
+/* Count of (all) key slots lower then the key. */
+static unsigned
+btree_count_lower(const BTREE_KEY* keys, BTREE_KEY key)
+{
+#if defined BTREE_SIMD_AVX2
+    __m256i k = _mm256_set1_epi64x(key);
+    __m256i acc = _mm256_setzero_si256();
+    __m128i sum;
+    int i;
+
+    for(i = 0; i < MAX_KEYS; i += 4) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(keys + i));
+        acc = _mm256_sub_epi64(acc, _mm256_cmpgt_epi64(k, v));
+    }
+    sum = _mm_add_epi64(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    return (unsigned) (_mm_cvtsi128_si64(sum) + _mm_extract_epi64(sum, 1));
+#elif defined BTREE_SIMD_SSE42
+    __m128i k = _mm_set1_epi64x(key);
+    __m128i acc = _mm_setzero_si128();
+    int i;
+
+    for(i = 0; i < MAX_KEYS; i += 2) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(keys + i));
+        acc = _mm_sub_epi64(acc, _mm_cmpgt_epi64(k, v));
+    }
+    return (unsigned) (_mm_cvtsi128_si64(acc) + _mm_extract_epi64(acc, 1));
+#elif defined BTREE_SIMD_NEON
+    int64x2_t k = vdupq_n_s64(key);
+    uint64x2_t acc = vdupq_n_u64(0);
+    int i;
+
+    for(i = 0; i < MAX_KEYS; i += 2)
+        acc = vsubq_u64(acc, vcltq_s64(vld1q_s64(keys + i), k));
+    return (unsigned) vaddvq_u64(acc);
+#else
+    unsigned n = 0;
+    int i;
+
+    for(i = 0; i < MAX_KEYS; i++)
+        n += (keys[i] < key);
+    return n;
+#endif
+}
+
+/* Position of the key in the leaf: Count of the keys lower then the key. */
+static unsigned
+btree_leaf_pos(const LEAF* leaf, BTREE_KEY key)
+{
+    return btree_count_lower(leaf->keys, key);
+}
+
+/* Index of the child which may contain the key: Count of the keys equal or
+ * lower then the key. */
+static unsigned
+btree_child_pos(const INNER* inner, BTREE_KEY key)
+{
+    /* Only KEY_PAD is greater then KEY_PAD - 1, and the padding must not be
+     * counted so we may use the same function as for leaves. */
+    if(key == KEY_PAD)
+        return inner->n;
+    return btree_count_lower(inner->keys, key + 1);
+}
+
+
+/************************************
+ ***   Node allocation & shifting ***
+ ************************************/
+
+static LEAF*
+btree_alloc_leaf(void)
+{
+    LEAF* leaf;
+    int i;
+
+    leaf = (LEAF*) malloc(sizeof(LEAF));
+    if(leaf == NULL)
+        return NULL;
+
+    for(i = 0; i < MAX_KEYS; i++)
+        leaf->keys[i] = KEY_PAD;
+    leaf->n = 0;
+    leaf->prev = NULL;
+    leaf->next = NULL;
+    return leaf;
+}
+
+static INNER*
+btree_alloc_inner(void)
+{
+    INNER* inner;
+    int i;
+
+    inner = (INNER*) malloc(sizeof(INNER));
+    if(inner == NULL)
+        return NULL;
+
+    for(i = 0; i < MAX_KEYS; i++)
+        inner->keys[i] = KEY_PAD;
+    inner->n = 0;
+    return inner;
+}
+
+static void
+btree_leaf_insert_at(LEAF* leaf, unsigned pos, BTREE_KEY key, void* data)
+{
+    memmove(leaf->keys + pos + 1, leaf->keys + pos, (leaf->n - pos) * sizeof(BTREE_KEY));
+    memmove(leaf->data + pos + 1, leaf->data + pos, (leaf->n - pos) * sizeof(void*));
+    leaf->keys[pos] = key;
+    leaf->data[pos] = data;
+    leaf->n++;
+}
+
+static void
+btree_leaf_remove_at(LEAF* leaf, unsigned pos)
+{
+    leaf->n--;
+    memmove(leaf->keys + pos, leaf->keys + pos + 1, (leaf->n - pos) * sizeof(BTREE_KEY));
+    memmove(leaf->data + pos, leaf->data + pos + 1, (leaf->n - pos) * sizeof(void*));
+    leaf->keys[leaf->n] = KEY_PAD;
+}
+
+/* Insert the key at the position, and the child right after it. */
+static void
+btree_inner_insert_at(INNER* inner, unsigned pos, BTREE_KEY key, void* child)
+{
+    memmove(inner->keys + pos + 1, inner->keys + pos, (inner->n - pos) * sizeof(BTREE_KEY));
+    memmove(inner->children + pos + 2, inner->children + pos + 1, (inner->n - pos) * sizeof(void*));
+    inner->keys[pos] = key;
+    inner->children[pos + 1] = child;
+    inner->n++;
+}
+
+/* Remove the key at the position, and the child right after it. */
+static void
+btree_inner_remove_at(INNER* inner, unsigned pos)
+{
+    inner->n--;
+    memmove(inner->keys + pos, inner->keys + pos + 1, (inner->n - pos) * sizeof(BTREE_KEY));
+    memmove(inner->children + pos + 1, inner->children + pos + 2, (inner->n - pos) * sizeof(void*));
+    inner->keys[inner->n] = KEY_PAD;
+}
+
+
+/*******************
+ ***   Cleanup   ***
+ *******************/
+
+static void
+btree_fini_recurse(void* node, unsigned level)
+{
+    INNER* inner = (INNER*) node;
+    unsigned i;
+
+    if(level > 1) {
+        for(i = 0; i <= inner->n; i++)
+            btree_fini_recurse(inner->children[i], level - 1);
+    }
+    free(node);
+}
+
+void
+btree_fini(BTREE* tree, BTREE_DTOR_FUNC dtor_func)
+{
+    BTREE_CURSOR cur;
+    void** p_data;
+
+    if(dtor_func != NULL) {
+        for(p_data = btree_head(tree, &cur); p_data != NULL; p_data = btree_next(&cur))
+            dtor_func(btree_current_key(&cur), *p_data);
+    }
+
+    if(tree->root != NULL)
+        btree_fini_recurse(tree->root, tree->height);
+
+    btree_init(tree);
+}
+
+
+/*********************
+ ***   Insertion   ***
+ *********************/
+
+/* Split the full child of the inner node at the given index into two. */
+static int
+btree_split_child(INNER* inner, unsigned index, int child_is_leaf)
+{
+    unsigned i;
+
+    if(child_is_leaf) {
+        LEAF* left = (LEAF*) inner->children[index];
+        LEAF* right;
+
+        right = btree_alloc_leaf();
+        if(right == NULL)
+            return -1;
+
+        right->n = MAX_KEYS / 2;
+        memcpy(right->keys, left->keys + MAX_KEYS / 2, right->n * sizeof(BTREE_KEY));
+        memcpy(right->data, left->data + MAX_KEYS / 2, right->n * sizeof(void*));
+        left->n = MAX_KEYS / 2;
+        for(i = left->n; i < MAX_KEYS; i++)
+            left->keys[i] = KEY_PAD;
+
+        right->prev = left;
+        right->next = left->next;
+        if(left->next != NULL)
+            left->next->prev = right;
+        left->next = right;
+
+        btree_inner_insert_at(inner, index, right->keys[0], right);
+    } else {
+        INNER* left = (INNER*) inner->children[index];
+        INNER* right;
+        BTREE_KEY separator;
+
+        right = btree_alloc_inner();
+        if(right == NULL)
+            return -1;
+
+        /* The middle key moves up into the parent. */
+        separator = left->keys[MAX_KEYS / 2];
+        right->n = MAX_KEYS - MAX_KEYS / 2 - 1;
+        memcpy(right->keys, left->keys + MAX_KEYS / 2 + 1, right->n * sizeof(BTREE_KEY));
+        memcpy(right->children, left->children + MAX_KEYS / 2 + 1, (right->n + 1) * sizeof(void*));
+        left->n = MAX_KEYS / 2;
+        for(i = left->n; i < MAX_KEYS; i++)
+            left->keys[i] = KEY_PAD;
+
+        btree_inner_insert_at(inner, index, separator, right);
+    }
+
+    return 0;
+}
+
+int
+btree_insert(BTREE* tree, BTREE_KEY key, void* data)
+{
+    void* node;
+    unsigned level;
+    unsigned pos;
+    LEAF* leaf;
+
+    if(tree->root == NULL) {
+        tree->root = btree_alloc_leaf();
+        if(tree->root == NULL)
+            return -1;
+        tree->height = 1;
+    }
+
+    /* We split any full node on our way down, so there is always a room for
+     * the key moving up from a split child. This starts with the root. */
+    if(((INNER*) tree->root)->n == MAX_KEYS) {
+        INNER* root;
+
+        root = btree_alloc_inner();
+        if(root == NULL)
+            return -1;
+        root->children[0] = tree->root;
+        if(btree_split_child(root, 0, (tree->height == 1)) != 0) {
+            free(root);
+            return -1;
+        }
+        tree->root = root;
+        tree->height++;
+    }
+
+    node = tree->root;
+    for(level = tree->height; level > 1; level--) {
+        INNER* inner = (INNER*) node;
+
+        pos = btree_child_pos(inner, key);
+        if(((INNER*) inner->children[pos])->n == MAX_KEYS) {
+            if(btree_split_child(inner, pos, (level == 2)) != 0)
+                return -1;
+            if(key >= inner->keys[pos])
+                pos++;
+        }
+        node = inner->children[pos];
+    }
+
+    leaf = (LEAF*) node;
+    pos = btree_leaf_pos(leaf, key);
+    if(pos < leaf->n  &&  leaf->keys[pos] == key)
+        return -1;
+
+    btree_leaf_insert_at(leaf, pos, key, data);
+    tree->size++;
+    return 0;
+}
+
+
+/*******************
+ ***   Removal   ***
+ *******************/
+
+/* Make sure the child of the inner node at the given index has more then
+ * the minimal count of keys, by borrowing a key from a sibling or by merging
+ * with it. Returns new index of the child (which changes when merged with its
+ * left sibling). */
+static unsigned
+btree_fix_child(INNER* inner, unsigned index, int child_is_leaf)
+{
+    if(child_is_leaf) {
+        LEAF* child = (LEAF*) inner->children[index];
+        LEAF* left = (index > 0) ? (LEAF*) inner->children[index - 1] : NULL;
+        LEAF* right = (index < inner->n) ? (LEAF*) inner->children[index + 1] : NULL;
+
+        if(left != NULL  &&  left->n > MIN_KEYS) {
+            btree_leaf_insert_at(child, 0, left->keys[left->n - 1], left->data[left->n - 1]);
+            btree_leaf_remove_at(left, left->n - 1);
+            inner->keys[index - 1] = child->keys[0];
+            return index;
+        }
+
+        if(right != NULL  &&  right->n > MIN_KEYS) {
+            btree_leaf_insert_at(child, child->n, right->keys[0], right->data[0]);
+            btree_leaf_remove_at(right, 0);
+            inner->keys[index] = right->keys[0];
+            return index;
+        }
+
+        /* Merge the two neighbors. */
+        if(left != NULL) {
+            right = child;
+            child = left;
+            index--;
+        }
+        memcpy(child->keys + child->n, right->keys, right->n * sizeof(BTREE_KEY));
+        memcpy(child->data + child->n, right->data, right->n * sizeof(void*));
+        child->n += right->n;
+        child->next = right->next;
+        if(right->next != NULL)
+            right->next->prev = child;
+        free(right);
+        btree_inner_remove_at(inner, index);
+    } else {
+        INNER* child = (INNER*) inner->children[index];
+        INNER* left = (index > 0) ? (INNER*) inner->children[index - 1] : NULL;
+        INNER* right = (index < inner->n) ? (INNER*) inner->children[index + 1] : NULL;
+
+        /* Borrowing rotates the key through the parent. */
+        if(left != NULL  &&  left->n > MIN_KEYS) {
+            memmove(child->keys + 1, child->keys, child->n * sizeof(BTREE_KEY));
+            memmove(child->children + 1, child->children, (child->n + 1) * sizeof(void*));
+            child->keys[0] = inner->keys[index - 1];
+            child->children[0] = left->children[left->n];
+            child->n++;
+            inner->keys[index - 1] = left->keys[left->n - 1];
+            left->n--;
+            left->keys[left->n] = KEY_PAD;
+            return index;
+        }
+
+        if(right != NULL  &&  right->n > MIN_KEYS) {
+            child->keys[child->n] = inner->keys[index];
+            child->children[child->n + 1] = right->children[0];
+            child->n++;
+            inner->keys[index] = right->keys[0];
+            right->n--;
+            memmove(right->keys, right->keys + 1, right->n * sizeof(BTREE_KEY));
+            memmove(right->children, right->children + 1, (right->n + 1) * sizeof(void*));
+            right->keys[right->n] = KEY_PAD;
+            return index;
+        }
+
+        /* Merge the two neighbors, pulling the separator down. */
+        if(left != NULL) {
+            right = child;
+            child = left;
+            index--;
+        }
+        child->keys[child->n] = inner->keys[index];
+        memcpy(child->keys + child->n + 1, right->keys, right->n * sizeof(BTREE_KEY));
+        memcpy(child->children + child->n + 1, right->children, (right->n + 1) * sizeof(void*));
+        child->n += right->n + 1;
+        free(right);
+        btree_inner_remove_at(inner, index);
+    }
+
+    return index;
+}
+
+int
+btree_remove(BTREE* tree, BTREE_KEY key, void** p_data)
+{
+    void* node;
+    unsigned level;
+    unsigned pos;
+    LEAF* leaf;
+
+    if(tree->root == NULL)
+        return -1;
+
+    /* We make sure any node on our way down (except the root) has more then
+     * the minimal count of keys, so any removal, or merging of its children,
+     * cannot make it underflow. */
+    node = tree->root;
+    for(level = tree->height; level > 1; level--) {
+        INNER* inner = (INNER*) node;
+
+        pos = btree_child_pos(inner, key);
+        if(((INNER*) inner->children[pos])->n <= MIN_KEYS) {
+            pos = btree_fix_child(inner, pos, (level == 2));
+            node = inner->children[pos];
+
+            if(inner->n == 0) {
+                /* The root has lost its last key. Its only child becomes
+                 * the new root. */
+                tree->root = node;
+                tree->height--;
+                free(inner);
+            }
+        } else {
+            node = inner->children[pos];
+        }
+    }
+
+    leaf = (LEAF*) node;
+    pos = btree_leaf_pos(leaf, key);
+    if(pos >= leaf->n  ||  leaf->keys[pos] != key)
+        return -1;
+
+    if(p_data != NULL)
+        *p_data = leaf->data[pos];
+    btree_leaf_remove_at(leaf, pos);
+    tree->size--;
+
+    if(leaf->n == 0) {
+        /* Only the root leaf may become empty. */
+        free(leaf);
+        tree->root = NULL;
+        tree->height = 0;
+    }
+
+    return 0;
+}
+
+
+/******************
+ ***   Lookup   ***
+ ******************/
+
+static LEAF*
+btree_find_leaf(BTREE* tree, BTREE_KEY key)
+{
+    void* node = tree->root;
+    unsigned level;
+
+    if(node == NULL)
+        return NULL;
+
+    for(level = tree->height; level > 1; level--)
+        node = ((INNER*) node)->children[btree_child_pos((INNER*) node, key)];
+
+    return (LEAF*) node;
+}
+
+void**
+btree_lookup(BTREE* tree, BTREE_KEY key)
+{
+    LEAF* leaf;
+    unsigned pos;
+
+    leaf = btree_find_leaf(tree, key);
+    if(leaf == NULL)
+        return NULL;
+
+    pos = btree_leaf_pos(leaf, key);
+    if(pos >= leaf->n  ||  leaf->keys[pos] != key)
+        return NULL;
+
+    return &leaf->data[pos];
+}
+
+void**
+btree_lookup_ex(BTREE* tree, BTREE_KEY key, BTREE_CURSOR* cur)
+{
+    void** p_data;
+
+    p_data = btree_lower_bound(tree, key, cur);
+    if(p_data == NULL  ||  btree_current_key(cur) != key) {
+        cur->leaf = NULL;   /* No record with the key: Reset the cursor. */
+        return NULL;
+    }
+
+    return p_data;
+}
+
+void**
+btree_lower_bound(BTREE* tree, BTREE_KEY key, BTREE_CURSOR* cur)
+{
+    LEAF* leaf;
+    unsigned pos;
+
+    leaf = btree_find_leaf(tree, key);
+    if(leaf == NULL) {
+        cur->leaf = NULL;
+        return NULL;
+    }
+
+    /* If all keys in the leaf are lower, the record (if any) is the first
+     * one in the next leaf. */
+    pos = btree_leaf_pos(leaf, key);
+    if(pos >= leaf->n) {
+        leaf = leaf->next;
+        pos = 0;
+    }
+
+    cur->leaf = leaf;
+    cur->i = pos;
+    return (leaf != NULL) ? &leaf->data[pos] : NULL;
+}
+
+
+/*********************
+ ***   Iteration   ***
+ *********************/
+
+void**
+btree_current(BTREE_CURSOR* cur)
+{
+    return (cur->leaf != NULL) ? &((LEAF*) cur->leaf)->data[cur->i] : NULL;
+}
+
+BTREE_KEY
+btree_current_key(BTREE_CURSOR* cur)
+{
+    return ((LEAF*) cur->leaf)->keys[cur->i];
+}
+
+void**
+btree_head(BTREE* tree, BTREE_CURSOR* cur)
+{
+    void* node = tree->root;
+    unsigned level;
+
+    if(node != NULL) {
+        for(level = tree->height; level > 1; level--)
+            node = ((INNER*) node)->children[0];
+    }
+
+    cur->leaf = node;
+    cur->i = 0;
+    return btree_current(cur);
+}
+
+void**
+btree_tail(BTREE* tree, BTREE_CURSOR* cur)
+{
+    void* node = tree->root;
+    unsigned level;
+
+    if(node != NULL) {
+        for(level = tree->height; level > 1; level--)
+            node = ((INNER*) node)->children[((INNER*) node)->n];
+        cur->i = ((LEAF*) node)->n - 1;
+    }
+
+    cur->leaf = node;
+    return btree_current(cur);
+}
+
+void**
+btree_next(BTREE_CURSOR* cur)
+{
+    LEAF* leaf = (LEAF*) cur->leaf;
+
+    if(leaf == NULL)
+        return NULL;
+
+    if(cur->i + 1 < leaf->n) {
+        cur->i++;
+    } else {
+        /* Keep the cursor point to the last record even if we have reached
+         * the end. */
+        if(leaf->next == NULL)
+            return NULL;
+        cur->leaf = leaf->next;
+        cur->i = 0;
+    }
+
+    return btree_current(cur);
+}
+
+void**
+btree_prev(BTREE_CURSOR* cur)
+{
+    LEAF* leaf = (LEAF*) cur->leaf;
+
+    if(leaf == NULL)
+        return NULL;
+
+    if(cur->i > 0) {
+        cur->i--;
+    } else {
+        /* Keep the cursor point to the first record even if we have reached
+         * the beginning. */
+        if(leaf->prev == NULL)
+            return NULL;
+        cur->leaf = leaf->prev;
+        cur->i = leaf->prev->n - 1;
+    }
+
+    return btree_current(cur);
+}
+
+
+#ifdef CRE_TEST
+/* Verification of B+tree correctness. */
+
+/* Verifies the subtree holds only keys in the range <low, high) (ignoring the
+ * bounds which are NULL), and appends its leaves into the chain, so caller
+ * can verify the leaf links. Returns count of the keys, or -1 on an error. */
+static long
+btree_verify_recurse(void* node, unsigned level, int is_root,
+                     const BTREE_KEY* low, const BTREE_KEY* high, LEAF** p_last_leaf)
+{
+    const BTREE_KEY* keys = ((INNER*) node)->keys;
+    unsigned n = ((INNER*) node)->n;
+    long count = 0;
+    long sub;
+    unsigned i;
+
+    if(n > MAX_KEYS  ||  (!is_root && n < MIN_KEYS)  ||  n == 0)
+        return -1;
+
+    /* Keys must be sorted, within the range and padded. */
+    for(i = 0; i < n; i++) {
+        if(i > 0  &&  keys[i - 1] >= keys[i])
+            return -1;
+        if((low != NULL && keys[i] < *low)  ||  (high != NULL && keys[i] >= *high))
+            return -1;
+    }
+    for(i = n; i < MAX_KEYS; i++) {
+        if(keys[i] != KEY_PAD)
+            return -1;
+    }
+
+    if(level == 1) {
+        LEAF* leaf = (LEAF*) node;
+
+        if(leaf->prev != *p_last_leaf)
+            return -1;
+        if(*p_last_leaf != NULL  &&  (*p_last_leaf)->next != leaf)
+            return -1;
+        *p_last_leaf = leaf;
+        return n;
+    }
+
+    for(i = 0; i <= n; i++) {
+        sub = btree_verify_recurse(((INNER*) node)->children[i], level - 1, 0,
+                    (i > 0) ? &keys[i - 1] : low, (i < n) ? &keys[i] : high, p_last_leaf);
+        if(sub < 0)
+            return -1;
+        count += sub;
+    }
+    return count;
+}
+
+/* Returns 0 if ok, or -1 on an error. */
+int
+btree_verify(BTREE* tree)
+{
+    LEAF* last_leaf = NULL;
+    long count;
+
+    if(tree->root == NULL)
+        return (tree->height == 0  &&  tree->size == 0) ? 0 : -1;
+
+    count = btree_verify_recurse(tree->root, tree->height, 1, NULL, NULL, &last_leaf);
+    if(count < 0  ||  (size_t) count != tree->size)
+        return -1;
+    if(last_leaf->next != NULL)
+        return -1;
+
+    return 0;
+}
+
+#endif  /* #ifdef CRE_TEST */
@@ -0,0 +1,220 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2020 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef CRE_BTREE_H
+#define CRE_BTREE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdlib.h>
+
+
+#if defined __cplusplus
+    #define BTREE_INLINE__      inline
+#elif defined __STDC_VERSION__ && __STDC_VERSION__ >= 199901L
+    #define BTREE_INLINE__      static inline
+#elif defined __GNUC__
+    #define BTREE_INLINE__      static __inline__
+#elif defined _MSC_VER
+    #define BTREE_INLINE__      static __inline
+#else
+    #define BTREE_INLINE__      static
+#endif
+
+
+/* This header implements B+tree, mapping integer keys to pointers to any
+ * application data.
+ *
+ * See e.g. https://en.wikipedia.org/wiki/B%2B_tree if you are unfamiliar with
+ * the concept of B+tree.
+ *
+ * Unlike the RBTREE (see rbtree.h), the B+tree is not intrusive: It manages
+ * its nodes on its own, and every node holds many keys packed in an array.
+ * For large trees, this makes it much friendlier to CPU caches: The RBTREE
+ * has to touch a new (cold) node on each level of its (relatively deep) tree,
+ * while the B+tree touches only a few nodes, and all the keys of each one of
+ * them are searched by a handful of SIMD instructions (if the compiler is
+ * allowed to use AVX2 or SSE 4.2 on x86, or when targeting 64-bit ARM).
+ *
+ * All the data live in the leaf nodes, which are linked together. So walking
+ * over the tree, or over some range of the keys, is just a sequential scan
+ * over the leaves.
+ *
+ * The API mirrors the API of the RBTREE where it makes sense. The main
+ * differences are:
+ *
+ * - The keys are integers (BTREE_KEY) and they are ordered naturally. There
+ *   is no comparator function.
+ *
+ * - The data are passed as opaque pointers. The functions retrieving them
+ *   return a pointer to the slot in the tree where the data pointer lives, so
+ *   caller may also change it (but not the key). NULL is returned when the
+ *   requested key is not present.
+ *
+ * - As the tree allocates memory, inserting may fail also due to an
+ *   out-of-memory condition; and the tree has to be cleaned up with
+ *   btree_fini().
+ */
+
+
+/* Type of the key. */
+typedef int64_t BTREE_KEY;
+
+
+/* Tree structure. Treat as opaque.
+ */
+typedef struct BTREE {
+    void* root;
+    unsigned height;        /* 0 for empty tree, 1 if the root is a leaf, ... */
+    size_t size;            /* count of the keys */
+} BTREE;
+
+
+/* Destructor function type, called for every record by btree_fini().
+ */
+typedef void (*BTREE_DTOR_FUNC)(BTREE_KEY, void*);
+
+
+/* The tree has to be initialized before it is used by any other function.
+ */
+BTREE_INLINE__ void btree_init(BTREE* tree)
+        { tree->root = NULL; tree->height = 0; tree->size = 0; }
+
+#define BTREE_INITIALIZER       { NULL, 0, 0 }
+
+
+/* Release all the memory held by the tree. If dtor_func is not NULL, it is
+ * called for every record in the tree, in the order of the keys.
+ *
+ * After the call, the tree is empty and it may be used again.
+ */
+void btree_fini(BTREE* tree, BTREE_DTOR_FUNC dtor_func);
+
+
+/* Check whether the tree is empty. Returns non-zero if empty, zero otherwise.
+ */
+BTREE_INLINE__ int btree_is_empty(const BTREE* tree)
+        { return (tree->root == NULL); }
+
+/* Get count of the records in the tree.
+ */
+BTREE_INLINE__ size_t btree_size(const BTREE* tree)
+        { return tree->size; }
+
+
+/* Insert a new record into the tree.
+ *
+ * Returns 0 on success or -1 on failure (which may happen if an equal key is
+ * already present in the tree or if a memory allocation fails).
+ */
+int btree_insert(BTREE* tree, BTREE_KEY key, void* data);
+
+/* Remove the record with the key.
+ *
+ * Returns 0 on success, or -1 if no such key is present in the tree. If
+ * p_data is not NULL, the data pointer of the removed record is stored there.
+ */
+int btree_remove(BTREE* tree, BTREE_KEY key, void** p_data);
+
+/* Find a record with the key.
+ *
+ * Returns pointer to the data pointer of the record, or NULL if there is no
+ * such key in the tree.
+ */
+void** btree_lookup(BTREE* tree, BTREE_KEY key);
+
+
+/* Walking over the records in the tree. When reaching end of the iteration,
+ * the functions return NULL.
+ *
+ * Walking over all the records can be implemented as follows:
+ *
+ * ```
+ * static void walk_over_my_tree(BTREE* tree)
+ * {
+ *     BTREE_CURSOR cur;
+ *     void** p_data;
+ *
+ *     for(p_data = btree_head(tree, &cur);
+ *         p_data != NULL;
+ *         p_data = btree_next(&cur))
+ *     {
+ *         ... btree_current_key(&cur) ... *p_data ...
+ *     }
+ * }
+ * ```
+ *
+ * Similarly, starting the walk with btree_lower_bound() allows to walk over
+ * any range of the keys.
+ *
+ * Any cursor becomes invalid and must not be used anymore when any records
+ * are added into the tree or removed from it.
+ */
+typedef struct BTREE_CURSOR {
+    void* leaf;
+    unsigned i;
+} BTREE_CURSOR;
+
+/* Initializer for a cursor pointing to nowhere. */
+#define BTREE_CURSOR_INITIALIZER        { NULL, 0 }
+
+
+/* This is similar to btree_lookup() but it also initializes the cursor to the
+ * corresponding position, so caller may navigate from the record to other
+ * ones via the btree_prev() and/or btree_next().
+ */
+void** btree_lookup_ex(BTREE* tree, BTREE_KEY key, BTREE_CURSOR* cur);
+
+/* Find the first record with the key equal to or greater than the key, and
+ * initialize the cursor to it. Returns NULL (and the cursor points to nowhere)
+ * if there is no such record.
+ */
+void** btree_lower_bound(BTREE* tree, BTREE_KEY key, BTREE_CURSOR* cur);
+
+/* Get the record corresponding to the current position of the cursor; or
+ * NULL. The key of the record is returned by btree_current_key() (which must
+ * be called only if the cursor points to some record).
+ */
+void** btree_current(BTREE_CURSOR* cur);
+BTREE_KEY btree_current_key(BTREE_CURSOR* cur);
+
+/* The functions btree_head() and btree_tail() retrieve the first or last
+ * record in the tree, the functions btree_next() and btree_prev() move to
+ * the next or the previous record.
+ */
+void** btree_head(BTREE* tree, BTREE_CURSOR* cur);
+void** btree_tail(BTREE* tree, BTREE_CURSOR* cur);
+void** btree_next(BTREE_CURSOR* cur);
+void** btree_prev(BTREE_CURSOR* cur);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* CRE_BTREE_H */
@@ -25,15 +25,39 @@
 
 #include "buffer.h"
 
+#include <stdarg.h>
+#include <stdio.h>
+
+
+#ifndef va_copy
+    /* Older MSVC. */
+    #define va_copy(dst, src)       ((dst) = (src))
+#endif
+
 
 int
 buffer_realloc(BUFFER* buf, size_t alloc)
 {
     void* tmp;
 
-    tmp = realloc(buf->data, alloc);
-    if(tmp == NULL  &&  alloc > 0)
-        return -1;
+    if(buf->is_inline) {
+        /* Never shrink the inline storage; we could not grow it back. */
+        if(alloc <= buf->alloc) {
+            if(buf->size > alloc)
+                buf->size = alloc;
+            return 0;
+        }
+
+        tmp = malloc(alloc);
+        if(tmp == NULL)
+            return -1;
+        memcpy(tmp, buf->data, buf->size);
+        buf->is_inline = 0;
+    } else {
+        tmp = realloc(buf->data, alloc);
+        if(tmp == NULL  &&  alloc > 0)
+            return -1;
+    }
 
     buf->data = tmp;
     buf->alloc = alloc;
@@ -42,11 +66,24 @@ buffer_realloc(BUFFER* buf, size_t alloc)
     return 0;
 }
 
+/* Grow the buffer so it can hold at least the given total size. */
+static int
+buffer_grow(BUFFER* buf, size_t needed_alloc)
+{
+    size_t alloc;
+
+    alloc = buf->alloc + buf->alloc / 2;
+    if(alloc < needed_alloc  ||  alloc < buf->alloc /* overflow */)
+        alloc = needed_alloc;
+
+    return buffer_realloc(buf, alloc);
+}
+
 int
 buffer_reserve(BUFFER* buf, size_t extra_alloc)
 {
     if(buf->size + extra_alloc > buf->alloc)
-        return buffer_realloc(buf, buf->size + extra_alloc);
+        return buffer_grow(buf, buf->size + extra_alloc);
     else
         return 0;
 }
@@ -55,7 +92,7 @@ void
 buffer_shrink(BUFFER* buf)
 {
     /* Avoid realloc() if the potential memory gain is negligible. */
-    if(buf->alloc / 11 > buf->size / 10)
+    if(!buf->is_inline  &&  buf->alloc / 11 > buf->size / 10)
         buffer_realloc(buf, buf->size);
 }
 
@@ -63,7 +100,7 @@ void*
 buffer_insert_raw(BUFFER* buf, size_t pos, size_t n)
 {
     if(buf->size + n > buf->alloc) {
-        if(buffer_realloc(buf, buf->size + n + buf->size / 2) != 0)
+        if(buffer_grow(buf, buf->size + n) != 0)
             return NULL;
     }
 
@@ -91,10 +128,62 @@ void
 buffer_remove(BUFFER* buf, size_t pos, size_t n)
 {
     if(pos + n < buf->size) {
-        memmove((uint8_t*)buf->data + pos, (uint8_t*)buf->data + pos + n, n);
+        memmove((uint8_t*)buf->data + pos, (uint8_t*)buf->data + pos + n,
+                buf->size - pos - n);
         buf->size -= n;
     } else {
         buf->size = pos;
     }
 }
 
+int
+buffer_append_fmt(BUFFER* buf, const char* fmt, ...)
+{
+    va_list args;
+    va_list args_copy;
+    size_t spare;
+    int n;
+
+    va_start(args, fmt);
+
+    /* Try to format directly into the spare capacity. If it is not large
+     * enough, we get (on C99-conforming implementations) the needed size so
+     * the 2nd attempt must succeed. (Some older C runtimes only return -1, in
+     * which case we just keep growing.) */
+    while(1) {
+        spare = buf->alloc - buf->size;
+
+        va_copy(args_copy, args);
+        n = vsnprintf((spare > 0) ? (char*)buf->data + buf->size : NULL,
+                      spare, fmt, args_copy);
+        va_end(args_copy);
+
+        if(n >= 0  &&  (size_t) n < spare)
+            break;
+
+        if(buffer_reserve(buf, (n >= 0) ? (size_t) n + 1 : spare + 64) != 0) {
+            va_end(args);
+            return -1;
+        }
+    }
+
+    va_end(args);
+    buf->size += n;
+    return 0;
+}
+
+void*
+buffer_acquire(BUFFER* buf)
+{
+    void* data = buf->data;
+
+    if(buf->is_inline) {
+        data = malloc(buf->size);
+        if(data == NULL)
+            return NULL;
+        memcpy(data, buf->data, buf->size);
+    }
+
+    buffer_init(buf);
+    return data;
+}
@@ -52,22 +52,53 @@ typedef struct BUFFER {
     void* data;
     size_t size;
     size_t alloc;
+    int is_inline;      /* data points to the inline storage of BUFFER_SBO(N) */
 } BUFFER;
 
 
 /* Static initializer. */
-#define BUFFER_INITIALIZER          { NULL, 0, 0 }
+#define BUFFER_INITIALIZER          { NULL, 0, 0, 0 }
 
 /* Initialize/deinitialize buffer structure. */
 BUFFER_INLINE__ void buffer_init(BUFFER* buf)
-        { buf->data = NULL; buf->size = 0; buf->alloc = 0; }
+        { buf->data = NULL; buf->size = 0; buf->alloc = 0; buf->is_inline = 0; }
 BUFFER_INLINE__ void buffer_fini(BUFFER* buf)
-        { free(buf->data); }
+        { if(!buf->is_inline) free(buf->data); }
+
+
+/* Buffer with a small inline storage ("small buffer optimization").
+ *
+ * As long as the contents fits into the N bytes of the inline storage, no heap
+ * memory is used at all. When it grows larger, it is transparently moved to
+ * the heap. Use the member buf with all the buffer functions:
+ *
+ * ```
+ * BUFFER_SBO(64) sbo;
+ *
+ * BUFFER_SBO_INIT(&sbo);
+ * buffer_append(&sbo.buf, "hello", 5);
+ * ...
+ * buffer_fini(&sbo.buf);
+ * ```
+ *
+ * Note that unlike the plain BUFFER, the structure must not be copied (or
+ * moved) in the memory while the buffer lives in the inline storage. To move
+ * the contents out, use buffer_acquire().
+ */
+#define BUFFER_SBO(N)               struct { BUFFER buf; uint8_t storage[N]; }
+
+#define BUFFER_SBO_INIT(sbo)        buffer_init_inline(&(sbo)->buf, (sbo)->storage, sizeof((sbo)->storage))
+
+BUFFER_INLINE__ void buffer_init_inline(BUFFER* buf, void* storage, size_t size)
+        { buf->data = storage; buf->size = 0; buf->alloc = size; buf->is_inline = 1; }
+
 
 /* Change capacity of the buffer. If lower then current size, the data contents
  * beyond the new buffer capacity is lost. */
 int buffer_realloc(BUFFER* buf, size_t alloc);
-/* Reserve new space for extra_alloc bytes at the end of the buffer. */
+/* Reserve new space for at least extra_alloc bytes at the end of the buffer.
+ * When the buffer has to grow, it grows geometrically so that any sequence of
+ * buffer_reserve() and appending data runs in amortized linear time. */
 int buffer_reserve(BUFFER* buf, size_t extra_alloc);
 /* Remove the empty space from the buffer. */
 void buffer_shrink(BUFFER* buf);
@@ -111,9 +142,23 @@ void buffer_remove(BUFFER* buf, size_t pos, size_t n);
 BUFFER_INLINE__ void buffer_clear(BUFFER* buf)
         { buffer_remove(buf, 0, buf->size); }
 
-/* Take over the raw buffer. */
-BUFFER_INLINE__ void* buffer_acquire(BUFFER* buf)
-        { void* data = buf->data; buffer_init(buf); return data; }
+/* Append data formatted as by printf(). The data are formatted directly into
+ * the spare capacity of the buffer. A terminating zero is written after the
+ * data but it is not counted into the buffer size (so the buffer contents can
+ * be used as a string, and appending more data overwrites it). */
+int buffer_append_fmt(BUFFER* buf, const char* fmt, ...)
+#ifdef __GNUC__
+    __attribute__((format(printf, 2, 3)))
+#endif
+    ;
+
+/* Take over the raw buffer. Caller is responsible to free() it. The buffer is
+ * reset into an empty state.
+ *
+ * If the buffer lives in an inline storage (see BUFFER_SBO), the data are
+ * copied into a newly allocated memory (and NULL is returned if the allocation
+ * fails). */
+void* buffer_acquire(BUFFER* buf);
 
 
 /* Sometimes, it is very useful to use the buffer as a general-purpose stack.
@@ -0,0 +1,530 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2020 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "cellcache.h"
+#include "list.h"
+
+#include <string.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <pthread.h>
+#endif
+
+
+#ifdef _WIN32
+    typedef SRWLOCK                 CELLCACHE_MUTEX;
+    typedef CONDITION_VARIABLE      CELLCACHE_COND;
+    typedef HANDLE                  CELLCACHE_THREAD;
+
+    #define mutex_init(m)           InitializeSRWLock(m)
+    #define mutex_fini(m)           do { } while(0)
+    #define mutex_lock(m)           AcquireSRWLockExclusive(m)
+    #define mutex_unlock(m)         ReleaseSRWLockExclusive(m)
+    #define cond_init(c)            InitializeConditionVariable(c)
+    #define cond_fini(c)            do { } while(0)
+    #define cond_wait(c, m)         SleepConditionVariableSRW((c), (m), INFINITE, 0)
+    #define cond_broadcast(c)       WakeAllConditionVariable(c)
+#else
+    typedef pthread_mutex_t         CELLCACHE_MUTEX;
+    typedef pthread_cond_t          CELLCACHE_COND;
+    typedef pthread_t               CELLCACHE_THREAD;
+
+    #define mutex_init(m)           pthread_mutex_init((m), NULL)
+    #define mutex_fini(m)           pthread_mutex_destroy(m)
+    #define mutex_lock(m)           pthread_mutex_lock(m)
+    #define mutex_unlock(m)         pthread_mutex_unlock(m)
+    #define cond_init(c)            pthread_cond_init((c), NULL)
+    #define cond_fini(c)            pthread_cond_destroy(c)
+    #define cond_wait(c, m)         pthread_cond_wait((c), (m))
+    #define cond_broadcast(c)       pthread_cond_broadcast(c)
+#endif
+
+
+typedef struct CELLCACHE_ENTRY {
+    struct CELLCACHE_ENTRY* next;   /* Next in the hash chain. */
+    LIST_NODE lru;
+    uint32_t x;
+    uint32_t y;
+    size_t size;
+    /* The data follow. */
+} CELLCACHE_ENTRY;
+
+#define ENTRY_DATA(e)       ((unsigned char*) ((e) + 1))
+
+struct CELLCACHE {
+    CELLCACHE_MUTEX mutex;
+
+    /* The cache itself. */
+    CELLCACHE_ENTRY** buckets;
+    size_t n_buckets;           /* Power of 2. */
+    size_t count;
+    size_t capacity;
+    LIST lru;                   /* From the most recently used. */
+
+    CELLCACHE_FETCH_FUNC fetch;
+    CELLCACHE_NOTIFY_FUNC notify;
+    void* ctx;
+
+    /* The worker thread and its current request. */
+    CELLCACHE_THREAD thread;
+    CELLCACHE_COND work_cond;   /* Signaled on a new request (or quit). */
+    CELLCACHE_COND idle_cond;   /* Signaled when the worker goes idle. */
+    CELLCACHE_RECT* rects;
+    unsigned n_rects;
+    unsigned alloc_rects;
+    unsigned cur_rect;
+    uint32_t cur_x;
+    uint32_t cur_y;
+    size_t processed;           /* Cells of the request processed so far. */
+    unsigned req_id;            /* Incremented on each cellcache_request(). */
+    unsigned row_fetched : 1;   /* Fetched anything in the current row? */
+    unsigned has_work : 1;
+    unsigned idle : 1;
+    unsigned quit : 1;
+
+    /* The cell being fetched right now. */
+    unsigned fetching : 1;
+    unsigned fetch_stale : 1;   /* Invalidated meanwhile. */
+    uint32_t fetch_x;
+    uint32_t fetch_y;
+
+    CELLCACHE_STATS stats;
+};
+
+
+/*************
+ *** Cache ***
+ *************/
+
+static size_t
+cellcache_hash(const CELLCACHE* cache, uint32_t x, uint32_t y)
+{
+    uint32_t h = (x * 0x9e3779b1U) ^ (y * 0x85ebca77U);
+
+    h ^= h >> 15;
+    return h & (cache->n_buckets - 1);
+}
+
+/* Find the link pointing to the entry (x, y), or the end of its chain. */
+static CELLCACHE_ENTRY**
+cellcache_lookup(CELLCACHE* cache, uint32_t x, uint32_t y)
+{
+    CELLCACHE_ENTRY** link = &cache->buckets[cellcache_hash(cache, x, y)];
+
+    while(*link != NULL  &&  ((*link)->x != x  ||  (*link)->y != y))
+        link = &(*link)->next;
+    return link;
+}
+
+static void
+cellcache_unlink(CELLCACHE* cache, CELLCACHE_ENTRY** link)
+{
+    CELLCACHE_ENTRY* e = *link;
+
+    *link = e->next;
+    list_remove(&cache->lru, &e->lru);
+    free(e);
+    cache->count--;
+}
+
+static void
+cellcache_evict(CELLCACHE* cache)
+{
+    CELLCACHE_ENTRY* e = LIST_DATA(list_tail(&cache->lru), CELLCACHE_ENTRY, lru);
+
+    cellcache_unlink(cache, cellcache_lookup(cache, e->x, e->y));
+    cache->stats.evictions++;
+}
+
+static void
+cellcache_touch(CELLCACHE* cache, CELLCACHE_ENTRY* e)
+{
+    list_remove(&cache->lru, &e->lru);
+    list_prepend(&cache->lru, &e->lru);
+}
+
+int
+cellcache_put(CELLCACHE* cache, uint32_t x, uint32_t y, const void* data, size_t size)
+{
+    CELLCACHE_ENTRY* e;
+    CELLCACHE_ENTRY** link;
+
+    e = (CELLCACHE_ENTRY*) malloc(sizeof(CELLCACHE_ENTRY) + size);
+    if(e == NULL)
+        return -1;
+    e->x = x;
+    e->y = y;
+    e->size = size;
+    if(size > 0)
+        memcpy(ENTRY_DATA(e), data, size);
+
+    mutex_lock(&cache->mutex);
+
+    if(cache->fetching  &&  cache->fetch_stale  &&
+       x == cache->fetch_x  &&  y == cache->fetch_y)
+    {
+        /* Fetched before cellcache_invalidate() so the data may be outdated. */
+        mutex_unlock(&cache->mutex);
+        free(e);
+        return 0;
+    }
+
+    link = cellcache_lookup(cache, x, y);
+    if(*link != NULL)
+        cellcache_unlink(cache, link);
+    else if(cache->count >= cache->capacity)
+        cellcache_evict(cache);
+
+    /* (The eviction may have changed the chain.) */
+    link = &cache->buckets[cellcache_hash(cache, x, y)];
+    e->next = *link;
+    *link = e;
+    list_prepend(&cache->lru, &e->lru);
+    cache->count++;
+
+    mutex_unlock(&cache->mutex);
+    return 0;
+}
+
+int
+cellcache_get(CELLCACHE* cache, uint32_t x, uint32_t y,
+              void* buf, size_t buf_size, size_t* p_size)
+{
+    CELLCACHE_ENTRY* e;
+    int ret = -1;
+
+    mutex_lock(&cache->mutex);
+    e = *cellcache_lookup(cache, x, y);
+    if(e != NULL) {
+        memcpy(buf, ENTRY_DATA(e), (e->size < buf_size ? e->size : buf_size));
+        *p_size = e->size;
+        cellcache_touch(cache, e);
+        cache->stats.hits++;
+        ret = 0;
+    } else {
+        cache->stats.misses++;
+    }
+    mutex_unlock(&cache->mutex);
+
+    return ret;
+}
+
+void
+cellcache_invalidate(CELLCACHE* cache, const CELLCACHE_RECT* rect)
+{
+    CELLCACHE_ENTRY** link;
+    size_t i;
+
+#define IN_RECT(x, y)                                                       \
+        (rect == NULL  ||  (rect->x0 <= (x)  &&  (x) < rect->x1  &&         \
+                            rect->y0 <= (y)  &&  (y) < rect->y1))
+
+    mutex_lock(&cache->mutex);
+
+    for(i = 0; i < cache->n_buckets; i++) {
+        link = &cache->buckets[i];
+        while(*link != NULL) {
+            if(IN_RECT((*link)->x, (*link)->y))
+                cellcache_unlink(cache, link);
+            else
+                link = &(*link)->next;
+        }
+    }
+
+    if(cache->fetching  &&  IN_RECT(cache->fetch_x, cache->fetch_y))
+        cache->fetch_stale = 1;
+
+    mutex_unlock(&cache->mutex);
+
+#undef IN_RECT
+}
+
+void
+cellcache_stats(CELLCACHE* cache, CELLCACHE_STATS* stats)
+{
+    mutex_lock(&cache->mutex);
+    memcpy(stats, &cache->stats, sizeof(CELLCACHE_STATS));
+    stats->count = cache->count;
+    mutex_unlock(&cache->mutex);
+}
+
+
+/*********************
+ *** Worker thread ***
+ *********************/
+
+/* Called with the mutex locked; returns with it locked (but it unlocks it
+ * meanwhile). */
+static void
+cellcache_notify_row(CELLCACHE* cache, uint32_t x1)
+{
+    CELLCACHE_RECT done;
+    unsigned i = cache->cur_rect;
+
+    cache->row_fetched = 0;
+    if(cache->notify == NULL)
+        return;
+
+    done.x0 = cache->rects[i].x0;
+    done.y0 = cache->cur_y;
+    done.x1 = x1;
+    done.y1 = cache->cur_y + 1;
+
+    mutex_unlock(&cache->mutex);
+    cache->notify(cache, i, &done, cache->ctx);
+    mutex_lock(&cache->mutex);
+}
+
+static void
+cellcache_work(CELLCACHE* cache)
+{
+    const CELLCACHE_RECT* r;
+    CELLCACHE_ENTRY* e;
+    uint32_t x, y;
+    unsigned req_id;
+
+    mutex_lock(&cache->mutex);
+
+    while(1) {
+        while(!cache->quit  &&  !cache->has_work) {
+            cache->idle = 1;
+            cond_broadcast(&cache->idle_cond);
+            cond_wait(&cache->work_cond, &cache->mutex);
+        }
+        if(cache->quit)
+            break;
+
+        if(cache->cur_rect >= cache->n_rects  ||  cache->processed >= cache->capacity) {
+            if(cache->row_fetched  &&  cache->cur_rect < cache->n_rects)
+                cellcache_notify_row(cache, cache->cur_x);
+            else
+                cache->has_work = 0;
+            continue;
+        }
+
+        r = &cache->rects[cache->cur_rect];
+        if(cache->cur_y >= r->y1  ||  r->x0 >= r->x1) {
+            /* Go to the next rectangle. */
+            cache->cur_rect++;
+            if(cache->cur_rect < cache->n_rects) {
+                cache->cur_x = cache->rects[cache->cur_rect].x0;
+                cache->cur_y = cache->rects[cache->cur_rect].y0;
+            }
+            continue;
+        }
+
+        if(cache->cur_x >= r->x1) {
+            /* Go to the next row. */
+            if(cache->row_fetched) {
+                cellcache_notify_row(cache, r->x1);
+                /* There may be a new request now. Then just start it. */
+                continue;
+            }
+            cache->cur_x = r->x0;
+            cache->cur_y++;
+            continue;
+        }
+
+        x = cache->cur_x++;
+        y = cache->cur_y;
+        cache->processed++;
+
+        e = *cellcache_lookup(cache, x, y);
+        if(e != NULL) {
+            cellcache_touch(cache, e);
+            continue;
+        }
+
+        cache->fetching = 1;
+        cache->fetch_stale = 0;
+        cache->fetch_x = x;
+        cache->fetch_y = y;
+        req_id = cache->req_id;
+        cache->stats.fetches++;
+
+        mutex_unlock(&cache->mutex);
+        cache->fetch(cache, x, y, cache->ctx);
+        mutex_lock(&cache->mutex);
+
+        cache->fetching = 0;
+        if(cache->req_id == req_id)
+            cache->row_fetched = 1;
+    }
+
+    mutex_unlock(&cache->mutex);
+}
+
+#ifdef _WIN32
+static DWORD WINAPI
+cellcache_thread_proc(void* arg)
+{
+    cellcache_work((CELLCACHE*) arg);
+    return 0;
+}
+#else
+static void*
+cellcache_thread_proc(void* arg)
+{
+    cellcache_work((CELLCACHE*) arg);
+    return NULL;
+}
+#endif
+
+int
+cellcache_request(CELLCACHE* cache, const CELLCACHE_RECT* rects, unsigned n)
+{
+    if(cache->fetch == NULL)
+        return -1;
+
+    mutex_lock(&cache->mutex);
+
+    if(n > cache->alloc_rects) {
+        CELLCACHE_RECT* tmp;
+
+        tmp = (CELLCACHE_RECT*) realloc(cache->rects, n * sizeof(CELLCACHE_RECT));
+        if(tmp == NULL) {
+            mutex_unlock(&cache->mutex);
+            return -1;
+        }
+        cache->rects = tmp;
+        cache->alloc_rects = n;
+    }
+
+    if(n > 0)
+        memcpy(cache->rects, rects, n * sizeof(CELLCACHE_RECT));
+    cache->n_rects = n;
+    cache->cur_rect = 0;
+    cache->cur_x = (n > 0 ? rects[0].x0 : 0);
+    cache->cur_y = (n > 0 ? rects[0].y0 : 0);
+    cache->processed = 0;
+    cache->req_id++;
+    cache->row_fetched = 0;
+    cache->has_work = (n > 0);
+    if(cache->has_work) {
+        cache->idle = 0;
+        cond_broadcast(&cache->work_cond);
+    }
+
+    mutex_unlock(&cache->mutex);
+    return 0;
+}
+
+void
+cellcache_wait(CELLCACHE* cache)
+{
+    if(cache->fetch == NULL)
+        return;
+
+    mutex_lock(&cache->mutex);
+    while(!cache->idle)
+        cond_wait(&cache->idle_cond, &cache->mutex);
+    mutex_unlock(&cache->mutex);
+}
+
+
+/****************************
+ *** Creation/Destruction ***
+ ****************************/
+
+CELLCACHE*
+cellcache_create(size_t capacity, CELLCACHE_FETCH_FUNC fetch,
+                 CELLCACHE_NOTIFY_FUNC notify, void* ctx)
+{
+    CELLCACHE* cache;
+
+    if(capacity == 0)
+        capacity = 1;
+
+    cache = (CELLCACHE*) malloc(sizeof(CELLCACHE));
+    if(cache == NULL)
+        return NULL;
+    memset(cache, 0, sizeof(CELLCACHE));
+
+    /* Keep the load factor at most 1. */
+    cache->n_buckets = 16;
+    while(cache->n_buckets < capacity)
+        cache->n_buckets *= 2;
+    cache->buckets = (CELLCACHE_ENTRY**) calloc(cache->n_buckets, sizeof(CELLCACHE_ENTRY*));
+    if(cache->buckets == NULL) {
+        free(cache);
+        return NULL;
+    }
+
+    cache->capacity = capacity;
+    list_init(&cache->lru);
+    cache->fetch = fetch;
+    cache->notify = notify;
+    cache->ctx = ctx;
+    cache->idle = 1;
+    mutex_init(&cache->mutex);
+
+    if(fetch != NULL) {
+        cond_init(&cache->work_cond);
+        cond_init(&cache->idle_cond);
+#ifdef _WIN32
+        cache->thread = CreateThread(NULL, 0, cellcache_thread_proc, cache, 0, NULL);
+        if(cache->thread == NULL) {
+#else
+        if(pthread_create(&cache->thread, NULL, cellcache_thread_proc, cache) != 0) {
+#endif
+            cond_fini(&cache->work_cond);
+            cond_fini(&cache->idle_cond);
+            mutex_fini(&cache->mutex);
+            free(cache->buckets);
+            free(cache);
+            return NULL;
+        }
+    }
+
+    return cache;
+}
+
+void
+cellcache_destroy(CELLCACHE* cache)
+{
+    if(cache->fetch != NULL) {
+        mutex_lock(&cache->mutex);
+        cache->quit = 1;
+        cond_broadcast(&cache->work_cond);
+        mutex_unlock(&cache->mutex);
+
+#ifdef _WIN32
+        WaitForSingleObject(cache->thread, INFINITE);
+        CloseHandle(cache->thread);
+#else
+        pthread_join(cache->thread, NULL);
+#endif
+        cond_fini(&cache->work_cond);
+        cond_fini(&cache->idle_cond);
+    }
+
+    cellcache_invalidate(cache, NULL);
+    mutex_fini(&cache->mutex);
+    free(cache->buckets);
+    free(cache->rects);
+    free(cache);
+}
@@ -0,0 +1,139 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2020 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef CRE_CELLCACHE_H
+#define CRE_CELLCACHE_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/* Cache of cells of a 2D grid (e.g. of a table view with data living in some
+ * slow backing store), keyed by (x, y) and with LRU eviction.
+ *
+ * The cache may also be filled ahead of time from a worker thread. The
+ * application describes what it is going to need (typically the visible part
+ * of the view and some area around it) with cellcache_request(), and the
+ * worker thread then calls the fetch callback for each of the cells which are
+ * not cached yet. The view never waits for the data: It just looks into the
+ * cache with cellcache_get() and gets notified when more data have arrived.
+ *
+ * The data of each cell are an arbitrary byte sequence, copied into the
+ * cache. All functions are thread-safe.
+ */
+typedef struct CELLCACHE CELLCACHE;
+
+/* Rectangle of cells [x0, x1) x [y0, y1). */
+typedef struct CELLCACHE_RECT {
+    uint32_t x0;
+    uint32_t y0;
+    uint32_t x1;
+    uint32_t y1;
+} CELLCACHE_RECT;
+
+/* Called on the worker thread to get the cell (x, y). It may block as long
+ * as needed (the cache is not locked meanwhile). It should store the data with
+ * cellcache_put() before it returns.
+ *
+ * It returns 0 on success. If it returns -1, the cell is skipped (until it is
+ * requested again by a new cellcache_request()). */
+typedef int (*CELLCACHE_FETCH_FUNC)(CELLCACHE* /*cache*/, uint32_t /*x*/, uint32_t /*y*/,
+                                    void* /*ctx*/);
+
+/* Called on the worker thread when it has fetched some of the requested cells
+ * (a row of the i-th requested rectangle, at most), so the view may update. */
+typedef void (*CELLCACHE_NOTIFY_FUNC)(CELLCACHE* /*cache*/, unsigned /*i*/,
+                                      const CELLCACHE_RECT* /*done*/, void* /*ctx*/);
+
+/* Create the cache for up to capacity cells.
+ *
+ * If fetch is not NULL, a worker thread is started and the cache can be
+ * filled with cellcache_request(). Otherwise it is just a passive LRU cache
+ * and notify is ignored.
+ *
+ * Returns NULL on a failure (of memory allocation or of the thread creation).
+ */
+CELLCACHE* cellcache_create(size_t capacity, CELLCACHE_FETCH_FUNC fetch,
+                            CELLCACHE_NOTIFY_FUNC notify, void* ctx);
+
+/* Destroy the cache. It waits until the worker thread finishes its current
+ * fetch (if any). It must not be called from the callbacks. */
+void cellcache_destroy(CELLCACHE* cache);
+
+/* Store the data of the cell (x, y), replacing any data it had. If the cache
+ * is full, the least recently used cell is evicted.
+ * Returns 0 on success, -1 on an allocation failure. */
+int cellcache_put(CELLCACHE* cache, uint32_t x, uint32_t y, const void* data, size_t size);
+
+/* Look up the cell (x, y). On a hit, it copies up to buf_size bytes of its
+ * data into buf, stores the full size of the data into *p_size, marks the cell
+ * as the most recently used one and returns 0. Returns -1 on a miss. */
+int cellcache_get(CELLCACHE* cache, uint32_t x, uint32_t y,
+                  void* buf, size_t buf_size, size_t* p_size);
+
+/* Drop all the cells in the rectangle (or all the cells if rect is NULL), e.g.
+ * because their data have changed. If the worker is just fetching one of
+ * them, the data it stores are discarded. */
+void cellcache_invalidate(CELLCACHE* cache, const CELLCACHE_RECT* rect);
+
+/* Ask the worker thread to fetch all not yet cached cells in the rectangles,
+ * in the given order (and in the row-major order in each of them). It replaces
+ * any request still pending, so the latest call wins (which is what we want
+ * when e.g. the user scrolls faster than the data can be fetched).
+ *
+ * The worker processes at most capacity cells (including those already
+ * cached), so the rectangles should be ordered from the most important one.
+ * The cells of the request are marked as the most recently used ones, so they
+ * do not evict each other.
+ *
+ * Returns 0 on success, -1 on an allocation failure or if the cache has no
+ * fetch callback. */
+int cellcache_request(CELLCACHE* cache, const CELLCACHE_RECT* rects, unsigned n);
+
+/* Wait until the worker thread has processed the current request (mainly for
+ * testing). */
+void cellcache_wait(CELLCACHE* cache);
+
+/* Statistics (mainly for testing and tuning). */
+typedef struct CELLCACHE_STATS {
+    size_t count;           /* Count of cached cells. */
+    uint64_t hits;          /* cellcache_get() hits. */
+    uint64_t misses;        /* cellcache_get() misses. */
+    uint64_t evictions;
+    uint64_t fetches;       /* Calls of the fetch callback. */
+} CELLCACHE_STATS;
+
+void cellcache_stats(CELLCACHE* cache, CELLCACHE_STATS* stats);
+
+
+#ifdef __cplusplus
+}  /* extern "C" { */
+#endif
+
+#endif  /* CRE_CELLCACHE_H */
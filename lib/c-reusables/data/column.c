@@ -0,0 +1,673 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2020 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "column.h"
+#include "intern.h"
+
+#include <string.h>
+
+
+#define MIN(a,b)    ((a) < (b) ? (a) : (b))
+#define MAX(a,b)    ((a) > (b) ? (a) : (b))
+
+
+/*************************
+ *** String dictionary ***
+ *************************/
+
+/* The strings themselves live in an INTERN pool, which also does the lookups.
+ * On top of it, the dictionary assigns each distinct string a small integer ID
+ * (remembered as the auxiliary value of the pooled string), so that the rows
+ * may hold just 32-bit IDs and the IDs may index a plain array. */
+struct COLUMN_DICT {
+    INTERN pool;
+    const void** strs;      /* strs[id] is the pooled string, or NULL if the
+                             * ID is unused. strs[0] is unused (ID 0 means
+                             * NULL). */
+    uint32_t* free_ids;     /* Stack of unused IDs below n_slots. */
+    uint32_t n_free;
+    uint32_t n_slots;
+    uint32_t alloc_slots;
+};
+
+static COLUMN_DICT*
+column_dict_create(void)
+{
+    COLUMN_DICT* dict;
+
+    dict = (COLUMN_DICT*) malloc(sizeof(COLUMN_DICT));
+    if(dict == NULL)
+        return NULL;
+    intern_init(&dict->pool);
+    dict->strs = NULL;
+    dict->free_ids = NULL;
+    dict->n_free = 0;
+    dict->n_slots = 1;      /* Skip ID 0. */
+    dict->alloc_slots = 0;
+    return dict;
+}
+
+static void
+column_dict_destroy(COLUMN_DICT* dict)
+{
+    intern_fini(&dict->pool);
+    free(dict->strs);
+    free(dict->free_ids);
+    free(dict);
+}
+
+/* Get ID of the string (adding it into the dictionary if needed) and
+ * increment its reference counter. Returns 0 on an allocation failure. */
+static uint32_t
+column_dict_acquire(COLUMN_DICT* dict, const void* str, size_t len)
+{
+    const void* pooled;
+    uint32_t id;
+
+    if(len > UINT32_MAX)
+        return 0;
+
+    pooled = intern_acquire(&dict->pool, str, len);
+    if(pooled == NULL)
+        return 0;
+
+    id = intern_aux(pooled);
+    if(id != 0)
+        return id;
+
+    /* New string: Assign it an ID. */
+    if(dict->n_free > 0) {
+        id = dict->free_ids[--dict->n_free];
+    } else {
+        if(dict->n_slots >= dict->alloc_slots) {
+            uint32_t alloc_slots;
+            const void** strs;
+            uint32_t* free_ids;
+
+            if(dict->alloc_slots >= UINT32_MAX / 2)
+                goto err;
+            alloc_slots = (dict->alloc_slots > 0) ? 2 * dict->alloc_slots : 16;
+            strs = (const void**) realloc((void*) dict->strs, alloc_slots * sizeof(const void*));
+            if(strs == NULL)
+                goto err;
+            dict->strs = strs;
+            /* Grow the stack of the free IDs now too, so that releasing
+             * a string never needs to allocate. */
+            free_ids = (uint32_t*) realloc(dict->free_ids, alloc_slots * sizeof(uint32_t));
+            if(free_ids == NULL)
+                goto err;
+            dict->free_ids = free_ids;
+            dict->alloc_slots = alloc_slots;
+        }
+        id = dict->n_slots++;
+    }
+
+    dict->strs[id] = pooled;
+    intern_set_aux(pooled, id);
+    return id;
+
+err:
+    intern_release(&dict->pool, pooled);
+    return 0;
+}
+
+static void
+column_dict_release(COLUMN_DICT* dict, uint32_t id)
+{
+    const void* pooled = dict->strs[id];
+
+    if(intern_refs(pooled) == 1) {
+        dict->strs[id] = NULL;
+        dict->free_ids[dict->n_free++] = id;
+    }
+    intern_release(&dict->pool, pooled);
+}
+
+static int
+column_default_cmp(const void* str1, size_t len1, const void* str2, size_t len2)
+{
+    int cmp;
+
+    cmp = memcmp(str1, str2, MIN(len1, len2));
+    if(cmp != 0)
+        return cmp;
+    return (len1 < len2) ? -1 : (len1 > len2) ? +1 : 0;
+}
+
+static int
+column_dict_cmp(const COLUMN_DICT* dict, uint32_t id1, uint32_t id2, COLUMN_CMP_FUNC cmp)
+{
+    const void* s1 = dict->strs[id1];
+    const void* s2 = dict->strs[id2];
+
+    return cmp(s1, intern_length(s1), s2, intern_length(s2));
+}
+
+/* Compute rank of each string in the dictionary: ranks[id] is the position of the
+ * string in the sorted list of all distinct strings (equal strings as per the
+ * comparator get equal ranks). Returns NULL on an allocation failure. */
+static uint32_t*
+column_dict_ranks(const COLUMN_DICT* dict, COLUMN_CMP_FUNC cmp)
+{
+    uint32_t* ranks;
+    uint32_t* ids;
+    uint32_t* tmp;
+    uint32_t* src;
+    uint32_t* dst;
+    uint32_t* swap;
+    uint32_t id, n, i, j, k, width, mid, end, rank;
+
+    ranks = (uint32_t*) malloc(MAX(dict->n_slots, 1) * sizeof(uint32_t));
+    ids = (uint32_t*) malloc(2 * MAX(intern_size(&dict->pool), 1) * sizeof(uint32_t));
+    if(ranks == NULL  ||  ids == NULL) {
+        free(ranks);
+        free(ids);
+        return NULL;
+    }
+    tmp = ids + intern_size(&dict->pool);
+
+    n = 0;
+    for(id = 1; id < dict->n_slots; id++) {
+        if(dict->strs[id] != NULL)
+            ids[n++] = id;
+    }
+
+    /* Bottom-up merge sort. (Unlike qsort(), it allows passing the dictionary and
+     * the comparator without any global state.) */
+    src = ids;
+    dst = tmp;
+    for(width = 1; width < n; width *= 2) {
+        for(i = 0; i < n; i += 2 * width) {
+            mid = MIN(i + width, n);
+            end = MIN(i + 2 * width, n);
+            j = i;
+            k = mid;
+            id = i;
+            while(j < mid  &&  k < end) {
+                if(column_dict_cmp(dict, src[k], src[j], cmp) < 0)
+                    dst[id++] = src[k++];
+                else
+                    dst[id++] = src[j++];
+            }
+            while(j < mid)
+                dst[id++] = src[j++];
+            while(k < end)
+                dst[id++] = src[k++];
+        }
+        swap = src;
+        src = dst;
+        dst = swap;
+    }
+
+    rank = 0;
+    for(i = 0; i < n; i++) {
+        if(i > 0  &&  column_dict_cmp(dict, src[i-1], src[i], cmp) != 0)
+            rank++;
+        ranks[src[i]] = rank;
+    }
+
+    free(ids);
+    return ranks;
+}
+
+
+/**************
+ *** COLUMN ***
+ **************/
+
+static size_t
+column_value_size(COLUMN_TYPE type)
+{
+    switch(type) {
+        case COLUMN_INT64:      return sizeof(int64_t);
+        case COLUMN_DOUBLE:     return sizeof(double);
+        case COLUMN_STRING:     return sizeof(uint32_t);
+    }
+    return 0;
+}
+
+void
+column_init(COLUMN* col, COLUMN_TYPE type)
+{
+    col->type = type;
+    col->n = 0;
+    col->alloc = 0;
+    col->v.ptr = NULL;
+    col->valid = NULL;
+    col->dict = NULL;
+}
+
+void
+column_fini(COLUMN* col)
+{
+    free(col->v.ptr);
+    free(col->valid);
+    if(col->dict != NULL)
+        column_dict_destroy(col->dict);
+}
+
+int
+column_reserve(COLUMN* col, size_t n)
+{
+    size_t value_size = column_value_size(col->type);
+    size_t alloc;
+    void* ptr;
+
+    if(n <= col->alloc)
+        return 0;
+
+    alloc = (col->alloc > 0) ? col->alloc : 16;
+    while(alloc < n)
+        alloc *= 2;
+
+    ptr = realloc(col->v.ptr, alloc * value_size);
+    if(ptr == NULL)
+        return -1;
+    col->v.ptr = ptr;
+
+    if(col->type != COLUMN_STRING) {
+        uint8_t* valid;
+
+        valid = (uint8_t*) realloc(col->valid, alloc);
+        if(valid == NULL) {
+            /* The value array is just bigger then needed. Keep col->alloc
+             * as it was so that the next call tries again. */
+            return -1;
+        }
+        col->valid = valid;
+    }
+
+    col->alloc = alloc;
+    return 0;
+}
+
+int
+column_insert(COLUMN* col, size_t pos, size_t n)
+{
+    size_t value_size = column_value_size(col->type);
+    uint8_t* data;
+
+    if(n == 0)
+        return 0;
+    if(column_reserve(col, col->n + n) != 0)
+        return -1;
+
+    data = (uint8_t*) col->v.ptr;
+    memmove(data + (pos + n) * value_size, data + pos * value_size,
+            (col->n - pos) * value_size);
+    memset(data + pos * value_size, 0, n * value_size);
+
+    if(col->valid != NULL) {
+        memmove(col->valid + pos + n, col->valid + pos, col->n - pos);
+        memset(col->valid + pos, 0, n);
+    }
+
+    col->n += n;
+    return 0;
+}
+
+void
+column_remove(COLUMN* col, size_t pos, size_t n)
+{
+    size_t value_size = column_value_size(col->type);
+    uint8_t* data = (uint8_t*) col->v.ptr;
+
+    if(n == 0)
+        return;
+    column_clear(col, pos, n);
+
+    memmove(data + pos * value_size, data + (pos + n) * value_size,
+            (col->n - pos - n) * value_size);
+    if(col->valid != NULL)
+        memmove(col->valid + pos, col->valid + pos + n, col->n - pos - n);
+
+    col->n -= n;
+}
+
+void
+column_clear(COLUMN* col, size_t pos, size_t n)
+{
+    size_t i;
+
+    if(col->type == COLUMN_STRING) {
+        for(i = pos; i < pos + n; i++) {
+            if(col->v.str[i] != 0) {
+                column_dict_release(col->dict, col->v.str[i]);
+                col->v.str[i] = 0;
+            }
+        }
+    } else if(n > 0) {
+        memset((uint8_t*) col->v.ptr + pos * column_value_size(col->type), 0,
+               n * column_value_size(col->type));
+        memset(col->valid + pos, 0, n);
+    }
+}
+
+int
+column_is_null(const COLUMN* col, size_t row)
+{
+    if(col->type == COLUMN_STRING)
+        return (col->v.str[row] == 0);
+    else
+        return (col->valid[row] == 0);
+}
+
+void
+column_set_null(COLUMN* col, size_t row)
+{
+    column_clear(col, row, 1);
+}
+
+void
+column_set_int64(COLUMN* col, size_t row, int64_t value)
+{
+    col->v.i64[row] = value;
+    col->valid[row] = 1;
+}
+
+int64_t
+column_get_int64(const COLUMN* col, size_t row)
+{
+    return col->v.i64[row];
+}
+
+void
+column_set_double(COLUMN* col, size_t row, double value)
+{
+    col->v.f64[row] = value;
+    col->valid[row] = 1;
+}
+
+double
+column_get_double(const COLUMN* col, size_t row)
+{
+    return col->v.f64[row];
+}
+
+int
+column_set_string(COLUMN* col, size_t row, const void* str, size_t len)
+{
+    uint32_t id;
+
+    if(str == NULL) {
+        column_set_null(col, row);
+        return 0;
+    }
+
+    if(col->dict == NULL) {
+        col->dict = column_dict_create();
+        if(col->dict == NULL)
+            return -1;
+    }
+
+    /* Acquire the new string before releasing the old one: If they are equal,
+     * this avoids freeing and reallocating it. */
+    id = column_dict_acquire(col->dict, str, len);
+    if(id == 0)
+        return -1;
+
+    if(col->v.str[row] != 0)
+        column_dict_release(col->dict, col->v.str[row]);
+    col->v.str[row] = id;
+    return 0;
+}
+
+const void*
+column_get_string(const COLUMN* col, size_t row, size_t* p_len)
+{
+    uint32_t id = col->v.str[row];
+
+    if(id == 0) {
+        if(p_len != NULL)
+            *p_len = 0;
+        return NULL;
+    }
+
+    if(p_len != NULL)
+        *p_len = intern_length(col->dict->strs[id]);
+    return col->dict->strs[id];
+}
+
+size_t
+column_string_count(const COLUMN* col)
+{
+    return (col->dict != NULL) ? intern_size(&col->dict->pool) : 0;
+}
+
+static int
+column_minmax(const COLUMN* col, COLUMN_CMP_FUNC cmp, int sign, size_t* p_row)
+{
+    size_t i, best = SIZE_MAX;
+
+    switch(col->type) {
+        case COLUMN_INT64:
+        {
+            const int64_t* v = col->v.i64;
+            for(i = 0; i < col->n; i++) {
+                if(col->valid[i]  &&  (best == SIZE_MAX  ||
+                        (sign < 0 ? v[i] < v[best] : v[i] > v[best])))
+                    best = i;
+            }
+            break;
+        }
+
+        case COLUMN_DOUBLE:
+        {
+            /* Compare the sort keys, so that NaNs and the signed zeros are
+             * ordered as by column_sort() regardless of the row order. */
+            const double* v = col->v.f64;
+            uint64_t key, best_key = 0;
+            for(i = 0; i < col->n; i++) {
+                if(!col->valid[i])
+                    continue;
+                key = column_double_key(v[i]);
+                if(best == SIZE_MAX  ||  (sign < 0 ? key < best_key : key > best_key)) {
+                    best = i;
+                    best_key = key;
+                }
+            }
+            break;
+        }
+
+        case COLUMN_STRING:
+        {
+            const COLUMN_DICT* dict = col->dict;
+            uint32_t id, best_id = 0;
+
+            if(dict == NULL)
+                break;
+            if(cmp == NULL)
+                cmp = column_default_cmp;
+
+            /* Find the best string in the dictionary. */
+            for(id = 1; id < dict->n_slots; id++) {
+                if(dict->strs[id] != NULL  &&  (best_id == 0  ||
+                        sign * column_dict_cmp(dict, id, best_id, cmp) > 0))
+                    best_id = id;
+            }
+            if(best_id == 0)
+                break;
+
+            /* Find the first row holding it (or a string equal to it as per
+             * the comparator). */
+            for(i = 0; i < col->n; i++) {
+                id = col->v.str[i];
+                if(id == best_id  ||  (id != 0  &&
+                        column_dict_cmp(dict, id, best_id, cmp) == 0)) {
+                    best = i;
+                    break;
+                }
+            }
+            break;
+        }
+    }
+
+    if(best == SIZE_MAX)
+        return -1;
+
+    *p_row = best;
+    return 0;
+}
+
+int
+column_min(const COLUMN* col, COLUMN_CMP_FUNC cmp, size_t* p_row)
+{
+    return column_minmax(col, cmp, -1, p_row);
+}
+
+int
+column_max(const COLUMN* col, COLUMN_CMP_FUNC cmp, size_t* p_row)
+{
+    return column_minmax(col, cmp, +1, p_row);
+}
+
+
+/***************
+ *** Sorting ***
+ ***************/
+
+typedef struct COLUMN_SORT_ITEM {
+    uint64_t key;
+    size_t row;
+} COLUMN_SORT_ITEM;
+
+uint64_t
+column_double_key(double d)
+{
+    uint64_t u;
+
+    memcpy(&u, &d, sizeof(uint64_t));
+    if(u & 0x8000000000000000ULL)
+        return ~u;
+    else
+        return u | 0x8000000000000000ULL;
+}
+
+/* Stable LSD radix sort of the items by their keys, byte by byte. Passes
+ * where all the keys have the same byte are skipped. Returns pointer to
+ * whichever of the two buffers holds the result. */
+static COLUMN_SORT_ITEM*
+column_radix_sort(COLUMN_SORT_ITEM* items, COLUMN_SORT_ITEM* tmp, size_t n)
+{
+    size_t counts[256];
+    COLUMN_SORT_ITEM* swap;
+    size_t i, sum, c;
+    unsigned shift, b;
+
+    for(shift = 0; shift < 64; shift += 8) {
+        memset(counts, 0, sizeof(counts));
+        for(i = 0; i < n; i++)
+            counts[(items[i].key >> shift) & 0xff]++;
+
+        if(counts[(items[0].key >> shift) & 0xff] == n)
+            continue;
+
+        sum = 0;
+        for(b = 0; b < 256; b++) {
+            c = counts[b];
+            counts[b] = sum;
+            sum += c;
+        }
+
+        for(i = 0; i < n; i++)
+            tmp[counts[(items[i].key >> shift) & 0xff]++] = items[i];
+
+        swap = items;
+        items = tmp;
+        tmp = swap;
+    }
+
+    return items;
+}
+
+int
+column_sort(const COLUMN* col, size_t* rows, size_t n, unsigned flags,
+            COLUMN_CMP_FUNC cmp)
+{
+    COLUMN_SORT_ITEM* buffer;
+    COLUMN_SORT_ITEM* items;
+    uint32_t* ranks = NULL;
+    size_t i, row, n_items = 0, n_nulls = 0;
+    uint64_t key;
+
+    if(n < 2)
+        return 0;
+
+    buffer = (COLUMN_SORT_ITEM*) malloc(2 * n * sizeof(COLUMN_SORT_ITEM));
+    if(buffer == NULL)
+        return -1;
+
+    if(col->type == COLUMN_STRING  &&  col->dict != NULL) {
+        ranks = column_dict_ranks(col->dict, (cmp != NULL) ? cmp : column_default_cmp);
+        if(ranks == NULL) {
+            free(buffer);
+            return -1;
+        }
+    }
+
+    /* Compute the keys. The NULL rows are put aside into the upper half of
+     * the buffer (which is later used as a temporary buffer for the radix
+     * sort) as they need no sorting. */
+    for(i = 0; i < n; i++) {
+        row = rows[i];
+        if(column_is_null(col, row)) {
+            buffer[n + n_nulls++].row = row;
+            continue;
+        }
+
+        switch(col->type) {
+            case COLUMN_INT64:  key = (uint64_t) col->v.i64[row] ^ 0x8000000000000000ULL; break;
+            case COLUMN_DOUBLE: key = column_double_key(col->v.f64[row]); break;
+            case COLUMN_STRING: key = ranks[col->v.str[row]]; break;
+            default:            key = 0; break;
+        }
+        if(flags & COLUMN_SORT_DESC)
+            key = ~key;
+
+        buffer[n_items].key = key;
+        buffer[n_items].row = row;
+        n_items++;
+    }
+
+    /* Write the NULL rows to their place in the output. */
+    if(flags & COLUMN_SORT_NULLSFIRST) {
+        for(i = 0; i < n_nulls; i++)
+            rows[i] = buffer[n + i].row;
+    } else {
+        for(i = 0; i < n_nulls; i++)
+            rows[n_items + i] = buffer[n + i].row;
+    }
+
+    if(n_items > 0) {
+        items = column_radix_sort(buffer, buffer + n, n_items);
+        row = (flags & COLUMN_SORT_NULLSFIRST) ? n_nulls : 0;
+        for(i = 0; i < n_items; i++)
+            rows[row + i] = items[i].row;
+    }
+
+    free(ranks);
+    free(buffer);
+    return 0;
+}
@@ -0,0 +1,186 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2020 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef CRE_COLUMN_H
+#define CRE_COLUMN_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#if defined __cplusplus
+    #define COLUMN_INLINE__     inline
+#elif defined __STDC_VERSION__ && __STDC_VERSION__ >= 199901L
+    #define COLUMN_INLINE__     static inline
+#elif defined __GNUC__
+    #define COLUMN_INLINE__     static __inline__
+#elif defined _MSC_VER
+    #define COLUMN_INLINE__     static __inline
+#else
+    #define COLUMN_INLINE__     static
+#endif
+
+
+/* Typed column of a table (column-oriented storage).
+ *
+ * All values of the column are of the same type and they are stored in a
+ * single contiguous C array, so operations over the whole column (sorting,
+ * searching for a minimum or maximum) just scan the array.
+ *
+ * Any value may be also NULL (missing). New rows are always NULL.
+ *
+ * Strings are dictionary-encoded: Each column has its own string dictionary
+ * (built on the intern pool from data/intern.h) where each distinct string
+ * is stored only once, and the rows hold just 32-bit IDs
+ * of the strings. Equal strings (as per memcmp()) thus always have equal IDs.
+ * ID 0 is reserved for NULL. The strings are arbitrary byte sequences, so
+ * the application may store e.g. wide-char strings, including their
+ * terminators.
+ *
+ * Rows are indexed from zero.
+ */
+typedef enum COLUMN_TYPE {
+    COLUMN_INT64 = 0,
+    COLUMN_DOUBLE,
+    COLUMN_STRING
+} COLUMN_TYPE;
+
+typedef struct COLUMN_DICT COLUMN_DICT;
+
+typedef struct COLUMN {
+    COLUMN_TYPE type;
+    size_t n;
+    size_t alloc;
+    union {
+        void* ptr;
+        int64_t* i64;       /* COLUMN_INT64 */
+        double* f64;        /* COLUMN_DOUBLE */
+        uint32_t* str;      /* COLUMN_STRING (IDs into the dictionary) */
+    } v;
+    uint8_t* valid;         /* Non-zero for non-NULL values (numeric types). */
+    COLUMN_DICT* dict;      /* COLUMN_STRING only; allocated lazily. */
+} COLUMN;
+
+
+/* Initialize/deinitialize the column. Initially, the column has no rows. */
+void column_init(COLUMN* col, COLUMN_TYPE type);
+void column_fini(COLUMN* col);
+
+/* Get type of the column and count of its rows. */
+COLUMN_INLINE__ COLUMN_TYPE column_type(const COLUMN* col) { return col->type; }
+COLUMN_INLINE__ size_t column_count(const COLUMN* col) { return col->n; }
+
+/* Make sure the column can hold n rows without any reallocation. Returns 0 on
+ * success, -1 on an allocation failure. */
+int column_reserve(COLUMN* col, size_t n);
+
+/* Insert n NULL rows at position pos, or remove n rows starting at pos.
+ * column_insert() fails (returning -1) only if it has to grow the storage and
+ * the allocation fails; after a successful column_reserve() it cannot fail.
+ */
+int column_insert(COLUMN* col, size_t pos, size_t n);
+void column_remove(COLUMN* col, size_t pos, size_t n);
+
+/* Set n rows starting at pos to NULL. */
+void column_clear(COLUMN* col, size_t pos, size_t n);
+
+/* Check whether the value in the given row is NULL, or set it to NULL. */
+int column_is_null(const COLUMN* col, size_t row);
+void column_set_null(COLUMN* col, size_t row);
+
+/* Set or get the value of the given row. The getters return 0 (or NULL) for
+ * NULL values. column_set_string() returns 0 on success, -1 on an allocation
+ * failure (the old value is then preserved). Setting the string to NULL is
+ * the same as column_set_null().
+ *
+ * The pointer returned by column_get_string() remains valid as long as the
+ * column contains the string in any of its rows.
+ */
+void column_set_int64(COLUMN* col, size_t row, int64_t value);
+int64_t column_get_int64(const COLUMN* col, size_t row);
+void column_set_double(COLUMN* col, size_t row, double value);
+double column_get_double(const COLUMN* col, size_t row);
+int column_set_string(COLUMN* col, size_t row, const void* str, size_t len);
+const void* column_get_string(const COLUMN* col, size_t row, size_t* p_len);
+
+/* Get count of distinct strings in the string dictionary (i.e. count of
+ * distinct non-NULL values in a COLUMN_STRING column). */
+size_t column_string_count(const COLUMN* col);
+
+/* Comparator for the strings. NULL (for any of the functions below) means
+ * binary comparison (memcmp() with shorter strings first). */
+typedef int (*COLUMN_CMP_FUNC)(const void* /*str1*/, size_t /*len1*/,
+                               const void* /*str2*/, size_t /*len2*/);
+
+/* Find the (first) row with the minimal or maximal non-NULL value.
+ * Returns 0 on success, or -1 if there is no non-NULL value in the column.
+ *
+ * For strings, it examines only the string dictionary and not all the rows,
+ * until the row holding the found string is searched for. Doubles are
+ * compared as by column_double_key().
+ */
+int column_min(const COLUMN* col, COLUMN_CMP_FUNC cmp, size_t* p_row);
+int column_max(const COLUMN* col, COLUMN_CMP_FUNC cmp, size_t* p_row);
+
+/* Sort the given vector of row indexes by the values in the column.
+ *
+ * The sort is stable: Rows with equal values keep their mutual order as they
+ * had in the input vector. Hence sorting by multiple keys can be done by
+ * sorting successively by each key, from the least significant one.
+ *
+ * The vector may contain any subset of rows (e.g. only rows matching some
+ * filter). NULL values are sorted after all other values, unless the flag
+ * COLUMN_SORT_NULLSFIRST is used.
+ *
+ * The values are mapped to unsigned 64-bit keys and sorted with a radix sort
+ * in O(n) time. (Strings are first ranked in their dictionary, which takes
+ * O(k log k) time for k distinct strings.)
+ *
+ * Returns 0 on success, -1 on an allocation failure (then the vector is left
+ * intact).
+ */
+#define COLUMN_SORT_DESC            0x0001
+#define COLUMN_SORT_NULLSFIRST      0x0002
+
+int column_sort(const COLUMN* col, size_t* rows, size_t n, unsigned flags,
+                COLUMN_CMP_FUNC cmp);
+
+/* Get the key which column_sort() sorts the double by. Comparing the keys
+ * gives a total order of all doubles: -0.0 goes before +0.0, and NaNs go
+ * beyond the infinities (at the end with the sign bit clear, at the start
+ * with it set). Use it when comparing values which have to be ordered
+ * consistently with column_sort(). */
+uint64_t column_double_key(double d);
+
+
+#ifdef __cplusplus
+}  /* extern "C" { */
+#endif
+
+#endif  /* CRE_COLUMN_H */
@@ -0,0 +1,197 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2020 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "fenwick.h"
+
+#include <string.h>
+
+
+/* Lowest set bit of i. */
+#define LOWBIT(i)       ((i) & (~(i) + 1))
+
+
+void
+fenwick_init(FENWICK* fw)
+{
+    fw->tree = NULL;
+    fw->n = 0;
+    fw->alloc = 0;
+}
+
+void
+fenwick_fini(FENWICK* fw)
+{
+    free(fw->tree);
+}
+
+static int
+fenwick_reserve(FENWICK* fw, size_t n)
+{
+    int64_t* tree;
+    size_t alloc;
+
+    if(n + 1 <= fw->alloc)
+        return 0;
+
+    alloc = (fw->alloc > 0) ? fw->alloc : 8;
+    while(alloc < n + 1)
+        alloc *= 2;
+
+    tree = (int64_t*) realloc(fw->tree, alloc * sizeof(int64_t));
+    if(tree == NULL)
+        return -1;
+
+    fw->tree = tree;
+    fw->alloc = alloc;
+    return 0;
+}
+
+int
+fenwick_resize(FENWICK* fw, size_t n)
+{
+    size_t j, k;
+
+    if(fenwick_reserve(fw, n) != 0)
+        return -1;
+
+    /* Appended (zero) elements: tree[j] covers the elements (j - LOWBIT(j), j],
+     * which is a union of the nodes j-1, j-2, j-4, ... (all smaller than
+     * LOWBIT(j)). */
+    for(j = fw->n + 1; j <= n; j++) {
+        fw->tree[j] = 0;
+        for(k = 1; k < LOWBIT(j); k <<= 1)
+            fw->tree[j] += fw->tree[j - k];
+    }
+
+    /* (Shrinking needs nothing: The remaining nodes do not depend on the
+     * removed ones.) */
+    fw->n = n;
+    return 0;
+}
+
+int64_t*
+fenwick_build_begin(FENWICK* fw, size_t n)
+{
+    if(fenwick_reserve(fw, n) != 0)
+        return NULL;
+
+    fw->n = n;
+    return fw->tree + 1;
+}
+
+void
+fenwick_build_end(FENWICK* fw)
+{
+    int64_t* tree = fw->tree;
+    size_t n = fw->n;
+    size_t i, j;
+
+    /* Propagate each node into its parent. */
+    for(i = 1; i <= n; i++) {
+        j = i + LOWBIT(i);
+        if(j <= n)
+            tree[j] += tree[i];
+    }
+}
+
+void
+fenwick_add(FENWICK* fw, size_t i, int64_t delta)
+{
+    size_t j;
+
+    for(j = i + 1; j <= fw->n; j += LOWBIT(j))
+        fw->tree[j] += delta;
+}
+
+int64_t
+fenwick_get(const FENWICK* fw, size_t i)
+{
+    size_t j = i + 1;
+    size_t stop = j - LOWBIT(j);
+    int64_t value = fw->tree[j];
+
+    /* tree[j] is sum of (stop, j]. Subtract the nodes covering (stop, j-1]. */
+    for(j = j - 1; j > stop; j -= LOWBIT(j))
+        value -= fw->tree[j];
+    return value;
+}
+
+void
+fenwick_set(FENWICK* fw, size_t i, int64_t value)
+{
+    fenwick_add(fw, i, value - fenwick_get(fw, i));
+}
+
+int64_t
+fenwick_prefix_sum(const FENWICK* fw, size_t i)
+{
+    int64_t sum = 0;
+
+    for(; i > 0; i -= LOWBIT(i))
+        sum += fw->tree[i];
+    return sum;
+}
+
+int64_t
+fenwick_range_sum(const FENWICK* fw, size_t i0, size_t i1)
+{
+    int64_t sum = 0;
+
+    /* Walk both indexes down until they meet, so the nodes common to both
+     * prefixes are not visited at all. */
+    while(i0 != i1) {
+        if(i1 > i0) {
+            sum += fw->tree[i1];
+            i1 -= LOWBIT(i1);
+        } else {
+            sum -= fw->tree[i0];
+            i0 -= LOWBIT(i0);
+        }
+    }
+    return sum;
+}
+
+size_t
+fenwick_find(const FENWICK* fw, int64_t pos)
+{
+    size_t i = 0;
+    size_t step = 1;
+
+    if(pos < 0)
+        return 0;
+
+    while(step <= fw->n / 2)
+        step <<= 1;
+
+    /* Descend from the root: Take each node which does not overshoot. */
+    for(; step > 0; step >>= 1) {
+        if(i + step <= fw->n  &&  fw->tree[i + step] <= pos) {
+            i += step;
+            pos -= fw->tree[i];
+        }
+    }
+
+    return i;
+}
@@ -0,0 +1,124 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2020 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef CRE_FENWICK_H
+#define CRE_FENWICK_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#if defined __cplusplus
+    #define FENWICK_INLINE__    inline
+#elif defined __STDC_VERSION__ && __STDC_VERSION__ >= 199901L
+    #define FENWICK_INLINE__    static inline
+#elif defined __GNUC__
+    #define FENWICK_INLINE__    static __inline__
+#elif defined _MSC_VER
+    #define FENWICK_INLINE__    static __inline
+#else
+    #define FENWICK_INLINE__    static
+#endif
+
+
+/* Fenwick tree (binary indexed tree) over an array of n integer values.
+ *
+ * It allows to compute a sum of any prefix of the array and to change any
+ * element in O(log n) time. With non-negative values (e.g. widths of columns
+ * laid side by side), it also finds the element covering any given position
+ * in O(log n) time (see fenwick_find()).
+ *
+ * Elements are indexed from zero. The prefix sum fenwick_prefix_sum(fw, i) is
+ * the sum of elements [0, i), so fenwick_prefix_sum(fw, 0) is always zero.
+ */
+typedef struct FENWICK {
+    int64_t* tree;      /* tree[1 ... n]; tree[0] is unused */
+    size_t n;
+    size_t alloc;
+} FENWICK;
+
+
+/* Static initializer. */
+#define FENWICK_INITIALIZER         { NULL, 0, 0 }
+
+/* Initialize/deinitialize the structure. Initially, the array is empty. */
+void fenwick_init(FENWICK* fw);
+void fenwick_fini(FENWICK* fw);
+
+/* Get count of the elements. */
+FENWICK_INLINE__ size_t fenwick_count(const FENWICK* fw) { return fw->n; }
+
+/* Change count of the elements. New elements (if any) are zero; the values of
+ * old elements are preserved. Growing by k elements costs O(k log n).
+ * Returns 0 on success, -1 on an allocation failure.
+ */
+int fenwick_resize(FENWICK* fw, size_t n);
+
+/* Bulk (re)initialization of all the elements in O(n) time.
+ *
+ * fenwick_build_begin() sets count of the elements and returns a pointer to an
+ * array of n values the caller has to fill. Then the caller must call
+ * fenwick_build_end() before using any other function.
+ *
+ * fenwick_build_begin() returns NULL on an allocation failure (the tree is
+ * then left unchanged).
+ */
+int64_t* fenwick_build_begin(FENWICK* fw, size_t n);
+void fenwick_build_end(FENWICK* fw);
+
+/* Add delta to the element i, or set it to value. */
+void fenwick_add(FENWICK* fw, size_t i, int64_t delta);
+void fenwick_set(FENWICK* fw, size_t i, int64_t value);
+
+/* Get value of the element i. */
+int64_t fenwick_get(const FENWICK* fw, size_t i);
+
+/* Get sum of the elements [0, i), [i0, i1), or of all elements. */
+int64_t fenwick_prefix_sum(const FENWICK* fw, size_t i);
+int64_t fenwick_range_sum(const FENWICK* fw, size_t i0, size_t i1);
+FENWICK_INLINE__ int64_t fenwick_total(const FENWICK* fw)
+        { return fenwick_prefix_sum(fw, fw->n); }
+
+/* Find the largest i (0 <= i <= n) such that fenwick_prefix_sum(fw, i) <= pos.
+ *
+ * If the elements are sizes of consecutive intervals, this is the index of the
+ * interval containing the position pos. (Empty intervals are skipped, so the
+ * first non-empty interval containing the position is found.) The function
+ * returns n if pos is beyond the total sum, or 0 if pos is negative.
+ *
+ * The result is well defined only if no element is negative.
+ */
+size_t fenwick_find(const FENWICK* fw, int64_t pos);
+
+
+#ifdef __cplusplus
+}  /* extern "C" { */
+#endif
+
+#endif  /* CRE_FENWICK_H */
@@ -0,0 +1,228 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2020 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "intern.h"
+#include "../hash/fnv1a.h"
+
+#include <string.h>
+
+
+#if defined offsetof
+    #define OFFSETOF(type, member)      offsetof(type, member)
+#elif defined __GNUC__ && __GNUC__ >= 4
+    #define OFFSETOF(type, member)      __builtin_offsetof(type, member)
+#else
+    #define OFFSETOF(type, member)      ((size_t) &((type*)0)->member)
+#endif
+
+
+struct INTERN_ENTRY {
+    INTERN_ENTRY* next;
+    size_t len;
+    uint32_t hash;
+    uint32_t refs;
+    uint32_t aux;
+    uint8_t payload[1];     /* Actually (len + 1) bytes. */
+};
+
+#define INTERN_ENTRY_FROM_PAYLOAD(ptr)                                      \
+        ((INTERN_ENTRY*) ((uint8_t*)(ptr) - OFFSETOF(INTERN_ENTRY, payload)))
+
+#define INTERN_INIT_BUCKET_COUNT    64
+
+
+void
+intern_init(INTERN* pool)
+{
+    memset(pool, 0, sizeof(INTERN));
+}
+
+void
+intern_fini(INTERN* pool)
+{
+    INTERN_ENTRY* entry;
+    INTERN_ENTRY* next;
+    size_t i;
+
+    for(i = 0; i < pool->bucket_count; i++) {
+        entry = pool->buckets[i];
+        while(entry != NULL) {
+            next = entry->next;
+            free(entry);
+            entry = next;
+        }
+    }
+
+    free(pool->buckets);
+}
+
+static int
+intern_rehash(INTERN* pool, size_t bucket_count)
+{
+    INTERN_ENTRY** buckets;
+    INTERN_ENTRY* entry;
+    INTERN_ENTRY* next;
+    size_t i;
+
+    buckets = (INTERN_ENTRY**) malloc(bucket_count * sizeof(INTERN_ENTRY*));
+    if(buckets == NULL)
+        return -1;
+    memset(buckets, 0, bucket_count * sizeof(INTERN_ENTRY*));
+
+    for(i = 0; i < pool->bucket_count; i++) {
+        entry = pool->buckets[i];
+        while(entry != NULL) {
+            next = entry->next;
+            entry->next = buckets[entry->hash & (bucket_count - 1)];
+            buckets[entry->hash & (bucket_count - 1)] = entry;
+            entry = next;
+        }
+    }
+
+    free(pool->buckets);
+    pool->buckets = buckets;
+    pool->bucket_count = bucket_count;
+    return 0;
+}
+
+const void*
+intern_acquire(INTERN* pool, const void* str, size_t len)
+{
+    uint32_t hash;
+    INTERN_ENTRY* entry;
+    INTERN_ENTRY** bucket;
+
+    hash = fnv1a_32(FNV1A_BASE_32, str, len);
+    pool->lookups++;
+
+    if(pool->bucket_count > 0) {
+        entry = pool->buckets[hash & (pool->bucket_count - 1)];
+        while(entry != NULL) {
+            if(entry->hash == hash  &&  entry->len == len  &&
+               memcmp(entry->payload, str, len) == 0)
+            {
+                entry->refs++;
+                pool->hits++;
+                pool->bytes_saved += len;
+                return entry->payload;
+            }
+            entry = entry->next;
+        }
+    }
+
+    if(pool->size >= pool->bucket_count) {
+        if(intern_rehash(pool, (pool->bucket_count > 0)
+                    ? 2 * pool->bucket_count : INTERN_INIT_BUCKET_COUNT) != 0)
+        {
+            /* With existing buckets we may just live with longer chains. */
+            if(pool->bucket_count == 0)
+                return NULL;
+        }
+    }
+
+    entry = (INTERN_ENTRY*) malloc(OFFSETOF(INTERN_ENTRY, payload) + len + 1);
+    if(entry == NULL)
+        return NULL;
+
+    memcpy(entry->payload, str, len);
+    entry->payload[len] = 0;
+    entry->len = len;
+    entry->hash = hash;
+    entry->refs = 1;
+    entry->aux = 0;
+
+    bucket = &pool->buckets[hash & (pool->bucket_count - 1)];
+    entry->next = *bucket;
+    *bucket = entry;
+    pool->size++;
+    pool->bytes += len;
+
+    return entry->payload;
+}
+
+void
+intern_addref(INTERN* pool, const void* pooled)
+{
+    INTERN_ENTRY* entry = INTERN_ENTRY_FROM_PAYLOAD(pooled);
+
+    entry->refs++;
+    pool->bytes_saved += entry->len;
+}
+
+void
+intern_release(INTERN* pool, const void* pooled)
+{
+    INTERN_ENTRY* entry = INTERN_ENTRY_FROM_PAYLOAD(pooled);
+    INTERN_ENTRY** link;
+
+    entry->refs--;
+    if(entry->refs > 0) {
+        pool->bytes_saved -= entry->len;
+        return;
+    }
+
+    link = &pool->buckets[entry->hash & (pool->bucket_count - 1)];
+    while(*link != entry)
+        link = &(*link)->next;
+    *link = entry->next;
+
+    pool->size--;
+    pool->bytes -= entry->len;
+    free(entry);
+}
+
+size_t
+intern_length(const void* pooled)
+{
+    return INTERN_ENTRY_FROM_PAYLOAD(pooled)->len;
+}
+
+uint32_t
+intern_refs(const void* pooled)
+{
+    return INTERN_ENTRY_FROM_PAYLOAD(pooled)->refs;
+}
+
+uint32_t
+intern_aux(const void* pooled)
+{
+    return INTERN_ENTRY_FROM_PAYLOAD(pooled)->aux;
+}
+
+void
+intern_set_aux(const void* pooled, uint32_t aux)
+{
+    INTERN_ENTRY_FROM_PAYLOAD(pooled)->aux = aux;
+}
+
+void
+intern_stats(const INTERN* pool, INTERN_STATS* stats)
+{
+    stats->strings = pool->size;
+    stats->lookups = pool->lookups;
+    stats->hits = pool->hits;
+    stats->bytes = pool->bytes;
+    stats->bytes_saved = pool->bytes_saved;
+}
@@ -0,0 +1,134 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2020 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef CRE_INTERN_H
+#define CRE_INTERN_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#if defined __cplusplus
+    #define INTERN_INLINE__     inline
+#elif defined __STDC_VERSION__ && __STDC_VERSION__ >= 199901L
+    #define INTERN_INLINE__     static inline
+#elif defined __GNUC__
+    #define INTERN_INLINE__     static __inline__
+#elif defined _MSC_VER
+    #define INTERN_INLINE__     static __inline
+#else
+    #define INTERN_INLINE__     static
+#endif
+
+
+/* String intern pool.
+ *
+ * The pool stores each distinct string only once, no matter how many times
+ * it has been put into it. Callers hold references to the pooled copies;
+ * a copy is freed when its last reference is released. As a consequence,
+ * two strings obtained from the same pool are equal if and only if their
+ * pointers are equal.
+ *
+ * The strings are arbitrary byte sequences (so the application may store
+ * e.g. wide-char strings, including their terminators), looked up in a hash
+ * table (hashed with 32-bit FNV-1a from hash/fnv1a.h). The pool is not
+ * thread-safe.
+ */
+typedef struct INTERN_ENTRY INTERN_ENTRY;
+
+typedef struct INTERN {
+    INTERN_ENTRY** buckets;
+    size_t bucket_count;    /* Zero or power of 2. */
+    size_t size;            /* Count of distinct strings. */
+    uint64_t lookups;
+    uint64_t hits;
+    size_t bytes;           /* Bytes stored in the pool. */
+    size_t bytes_saved;     /* Bytes not stored thanks to the sharing. */
+} INTERN;
+
+/* Statistics. Hit rate can be computed as (hits / lookups). */
+typedef struct INTERN_STATS {
+    size_t strings;         /* Count of distinct strings in the pool. */
+    uint64_t lookups;       /* Count of all intern_acquire() calls. */
+    uint64_t hits;          /* ... out of them satisfied with a pooled string. */
+    size_t bytes;           /* Bytes of the pooled strings (not counting any
+                             * overhead). */
+    size_t bytes_saved;     /* Bytes which would be needed in addition if
+                             * each reference had its own copy. */
+} INTERN_STATS;
+
+
+/* Static initializer. */
+#define INTERN_INITIALIZER      { NULL, 0, 0, 0, 0, 0, 0 }
+
+/* Initialize/deinitialize the pool. When it is deinitialized, all strings are
+ * freed, no matter whether there are still any references to them. */
+void intern_init(INTERN* pool);
+void intern_fini(INTERN* pool);
+
+/* Get the pooled copy of the string (adding it into the pool if not yet
+ * there) and acquire a reference to it. Returns NULL on an allocation
+ * failure.
+ *
+ * The pooled copy is always followed by an extra zero byte (not counted in
+ * len), so if the string is a C string, the copy is one too.
+ */
+const void* intern_acquire(INTERN* pool, const void* str, size_t len);
+
+/* Acquire another reference to the pooled string. */
+void intern_addref(INTERN* pool, const void* pooled);
+
+/* Release the reference to the pooled string. */
+void intern_release(INTERN* pool, const void* pooled);
+
+/* Get length of the pooled string. */
+size_t intern_length(const void* pooled);
+
+/* Get count of references to the pooled string. */
+uint32_t intern_refs(const void* pooled);
+
+/* Get/set an auxiliary value attached to the pooled string. It is zero when
+ * the string enters the pool and the pool itself never uses it; it allows
+ * the application to associate e.g. an ID with each distinct string without
+ * a hash table of its own. */
+uint32_t intern_aux(const void* pooled);
+void intern_set_aux(const void* pooled, uint32_t aux);
+
+/* Get count of the distinct strings in the pool. */
+INTERN_INLINE__ size_t intern_size(const INTERN* pool) { return pool->size; }
+
+/* Retrieve the statistics. */
+void intern_stats(const INTERN* pool, INTERN_STATS* stats);
+
+
+#ifdef __cplusplus
+}  /* extern "C" { */
+#endif
+
+#endif  /* CRE_INTERN_H */
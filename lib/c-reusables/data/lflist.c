@@ -0,0 +1,269 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2020 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "lflist.h"
+
+
+/* The atomic operations we need. We use the compiler built-ins (which follow
+ * the C11 memory model) rather than <stdatomic.h>, so that this compiles also
+ * with MSVC and the header stays usable from C++. */
+#if defined __GNUC__
+    #define LOAD_RELAXED(ptr)           __atomic_load_n((ptr), __ATOMIC_RELAXED)
+    #define LOAD_ACQUIRE(ptr)           __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+    #define LOAD_ACQUIRE_U64(ptr)       __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+    #define STORE_RELAXED(ptr, val)     __atomic_store_n((ptr), (val), __ATOMIC_RELAXED)
+    #define STORE_RELEASE(ptr, val)     __atomic_store_n((ptr), (val), __ATOMIC_RELEASE)
+    #define EXCHANGE(ptr, val)          __atomic_exchange_n((ptr), (val), __ATOMIC_ACQ_REL)
+
+    /* On failure, *p_expected is updated to the current value. */
+    #define CAS_U64(ptr, p_expected, val)                                   \
+                __atomic_compare_exchange_n((ptr), (p_expected), (val), 1,  \
+                            __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#elif defined _MSC_VER
+    #include <windows.h>
+    #include <intrin.h>
+    #if defined _M_ARM  ||  defined _M_ARM64
+        #define BARRIER__()             __dmb(0xb /* ISH */)
+    #else
+        /* On x86, ordinary loads and stores have the acquire and release
+         * semantics. We only need to prevent compiler reordering. */
+        #define BARRIER__()             _ReadWriteBarrier()
+    #endif
+
+    static void*
+    lflist_load_acquire(void* volatile* ptr)
+    {
+        void* val = *ptr;
+        BARRIER__();
+        return val;
+    }
+
+    static void
+    lflist_store_release(void* volatile* ptr, void* val)
+    {
+        BARRIER__();
+        *ptr = val;
+    }
+
+    static uint64_t
+    lflist_load_acquire_u64(volatile uint64_t* ptr)
+    {
+    #ifdef _WIN64
+        uint64_t val = *ptr;
+        BARRIER__();
+        return val;
+    #else
+        /* Plain 64-bit loads are not atomic on 32-bit targets. */
+        return (uint64_t) InterlockedCompareExchange64((volatile LONG64*) ptr, 0, 0);
+    #endif
+    }
+
+    static int
+    lflist_cas_u64(volatile uint64_t* ptr, uint64_t* p_expected, uint64_t val)
+    {
+        uint64_t prev = (uint64_t) InterlockedCompareExchange64(
+                    (volatile LONG64*) ptr, (LONG64) val, (LONG64) *p_expected);
+
+        if(prev == *p_expected)
+            return 1;
+        *p_expected = prev;
+        return 0;
+    }
+
+    #define LOAD_RELAXED(ptr)           (*(ptr))
+    #define LOAD_ACQUIRE(ptr)           lflist_load_acquire((void* volatile*) (ptr))
+    #define LOAD_ACQUIRE_U64(ptr)       lflist_load_acquire_u64(ptr)
+    #define STORE_RELAXED(ptr, val)     (*(ptr) = (val))
+    #define STORE_RELEASE(ptr, val)     lflist_store_release((void* volatile*) (ptr), (val))
+    #define EXCHANGE(ptr, val)          InterlockedExchangePointer((void* volatile*) (ptr), (val))
+    #define CAS_U64(ptr, p_expected, val)   lflist_cas_u64((ptr), (p_expected), (val))
+#else
+    #error Unsupported compiler.
+#endif
+
+
+/***************************
+ ***   Lock-free stack   ***
+ ***************************/
+
+/* Tagged pointer: See the comment in lflist.h. */
+#if UINTPTR_MAX > 0xffffffffu
+    #define LFSTACK_TAG_SHIFT       48
+#else
+    #define LFSTACK_TAG_SHIFT       32
+#endif
+#define LFSTACK_PTR_MASK            ((((uint64_t) 1) << LFSTACK_TAG_SHIFT) - 1)
+
+static LFSTACK_NODE*
+lfstack_untag(uint64_t tagged)
+{
+    return (LFSTACK_NODE*) (uintptr_t) (tagged & LFSTACK_PTR_MASK);
+}
+
+/* Make a new head value with the given node, and the tag of the old head
+ * value incremented. */
+static uint64_t
+lfstack_retag(uint64_t old_tagged, LFSTACK_NODE* node)
+{
+    uint64_t tag = (old_tagged >> LFSTACK_TAG_SHIFT) + 1;
+
+    return (tag << LFSTACK_TAG_SHIFT) | ((uint64_t) (uintptr_t) node & LFSTACK_PTR_MASK);
+}
+
+void
+lfstack_init(LFSTACK* stack)
+{
+    stack->head = 0;
+}
+
+int
+lfstack_is_empty(const LFSTACK* stack)
+{
+    return (lfstack_untag(LOAD_ACQUIRE_U64((volatile uint64_t*) &stack->head)) == NULL);
+}
+
+void
+lfstack_push(LFSTACK* stack, LFSTACK_NODE* node)
+{
+    uint64_t old = LOAD_ACQUIRE_U64(&stack->head);
+
+    /* The release semantics of the successful CAS publishes node->n as well
+     * as whatever the caller has written into the payload. */
+    do {
+        STORE_RELAXED(&node->n, lfstack_untag(old));
+    } while(!CAS_U64(&stack->head, &old, lfstack_retag(old, node)));
+}
+
+LFSTACK_NODE*
+lfstack_pop(LFSTACK* stack)
+{
+    uint64_t old = LOAD_ACQUIRE_U64(&stack->head);
+    LFSTACK_NODE* top;
+    LFSTACK_NODE* next;
+
+    /* If the top node gets popped and pushed back by other threads between
+     * our reading of top->n and the CAS, the tag makes the CAS fail. */
+    do {
+        top = lfstack_untag(old);
+        if(top == NULL)
+            return NULL;
+        next = LOAD_RELAXED(&top->n);
+    } while(!CAS_U64(&stack->head, &old, lfstack_retag(old, next)));
+
+    return top;
+}
+
+LFSTACK_NODE*
+lfstack_pop_all(LFSTACK* stack)
+{
+    uint64_t old = LOAD_ACQUIRE_U64(&stack->head);
+
+    do {
+        if(lfstack_untag(old) == NULL)
+            return NULL;
+    } while(!CAS_U64(&stack->head, &old, lfstack_retag(old, NULL)));
+
+    return lfstack_untag(old);
+}
+
+LFSTACK_NODE*
+lfstack_next(const LFSTACK_NODE* node)
+{
+    return node->n;
+}
+
+
+/**********************
+ ***   MPSC queue   ***
+ **********************/
+
+void
+mpscq_init(MPSCQ* queue)
+{
+    queue->stub.n = NULL;
+    queue->head = &queue->stub;
+    queue->tail = &queue->stub;
+}
+
+int
+mpscq_is_empty(const MPSCQ* queue)
+{
+    /* If a producer has already swapped the tail (even if it has not linked
+     * the node yet), the queue is not empty anymore. */
+    return (queue->head == &queue->stub  &&
+            LOAD_ACQUIRE(&queue->tail) == &queue->stub);
+}
+
+void
+mpscq_push(MPSCQ* queue, MPSCQ_NODE* node)
+{
+    MPSCQ_NODE* prev;
+
+    STORE_RELAXED(&node->n, NULL);
+    prev = (MPSCQ_NODE*) EXCHANGE(&queue->tail, node);
+
+    /* Between the exchange and this store, the consumer cannot get past
+     * prev. This is the only place where a preempted producer can make the
+     * consumer wait. */
+    STORE_RELEASE(&prev->n, node);
+}
+
+MPSCQ_NODE*
+mpscq_pop(MPSCQ* queue)
+{
+    MPSCQ_NODE* head = queue->head;
+    MPSCQ_NODE* next = (MPSCQ_NODE*) LOAD_ACQUIRE(&head->n);
+
+    /* Skip the stub. */
+    if(head == &queue->stub) {
+        if(next == NULL)
+            return NULL;
+        queue->head = next;
+        head = next;
+        next = (MPSCQ_NODE*) LOAD_ACQUIRE(&next->n);
+    }
+
+    if(next != NULL) {
+        queue->head = next;
+        return head;
+    }
+
+    /* The head is the last node we can see. If it is not the tail, some
+     * producer is in the middle of mpscq_push(). */
+    if(head != (MPSCQ_NODE*) LOAD_ACQUIRE(&queue->tail))
+        return NULL;
+
+    /* Re-insert the stub, so that the last node can be detached without
+     * leaving the queue without any node. */
+    mpscq_push(queue, &queue->stub);
+    next = (MPSCQ_NODE*) LOAD_ACQUIRE(&head->n);
+    if(next != NULL) {
+        queue->head = next;
+        return head;
+    }
+
+    /* Another producer has got in front of the stub and not linked yet. */
+    return NULL;
+}
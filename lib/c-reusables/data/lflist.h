@@ -0,0 +1,204 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2020 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef CRE_LFLIST_H
+#define CRE_LFLIST_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#if defined offsetof
+    #define LFLIST_OFFSETOF__(type, member)     offsetof(type, member)
+#elif defined __GNUC__ && __GNUC__ >= 4
+    #define LFLIST_OFFSETOF__(type, member)     __builtin_offsetof(type, member)
+#else
+    #define LFLIST_OFFSETOF__(type, member)     ((size_t) &((type*)0)->member)
+#endif
+
+
+/* This header implements lock-free counterparts of some lists from list.h:
+ *
+ *  - Treiber stack (LFSTACK): Any thread may push and pop.
+ *  - Multi-producer/single-consumer queue (MPSCQ): Any thread may push, but
+ *    only one thread (at a time) may pop.
+ *
+ * Like in list.h, the lists are intrusive: Embed the node structure
+ * (LFSTACK_NODE or MPSCQ_NODE) into your structure and use the macro
+ * LFSTACK_DATA or MPSCQ_DATA to get back to it.
+ *
+ * No function ever blocks or allocates any memory, so the lists are handy
+ * e.g. for handing work items between threads without any mutex.
+ *
+ * Memory reclamation: The lists do not solve the memory reclamation problem.
+ * A thread popping from LFSTACK may still read the "next" link of a node which
+ * has just been popped by another thread. Therefore the memory of the nodes
+ * must stay valid as long as the stack is in use (e.g. allocate them from a
+ * pool and recycle them, but do not free them). MPSCQ has no such limitation:
+ * A popped node may be freed right away.
+ */
+
+
+/************************************************
+ *** LFSTACK (lock-free stack, Treiber stack) ***
+ ************************************************/
+
+/* To protect against the ABA problem, the stack head is a tagged pointer: The
+ * pointer to the top node and a counter, which is incremented on every change
+ * of the head, packed in a single 64-bit word so we can update both with a
+ * single compare-and-swap.
+ *
+ * On 64-bit platforms this assumes the pointers have at most 48 significant
+ * bits (which holds for user-space pointers on all current x86-64 and ARM64
+ * systems) and the remaining 16 bits are used for the counter.
+ */
+
+/* Stack node structure. Treat as opaque.
+ */
+typedef struct LFSTACK_NODE {
+    struct LFSTACK_NODE* volatile n;    /* next */
+} LFSTACK_NODE;
+
+
+/* Stack structure. Treat as opaque.
+ */
+typedef struct LFSTACK {
+    volatile uint64_t head;             /* tagged pointer to the top node */
+} LFSTACK;
+
+
+/* Macro for getting pointer to the structure holding the node.
+ */
+#define LFSTACK_DATA(node_ptr, type, member)  \
+                ((type*)((char*)(node_ptr) - LFLIST_OFFSETOF__(type, member)))
+
+
+/* The stack has to be initialized before it is used by any other function.
+ * (This itself is not thread-safe.)
+ */
+void lfstack_init(LFSTACK* stack);
+
+/* Check whether the stack is empty. Note that in a multi-threaded program the
+ * result may be outdated as soon as the function returns.
+ */
+int lfstack_is_empty(const LFSTACK* stack);
+
+/* Push the node on the top of the stack.
+ */
+void lfstack_push(LFSTACK* stack, LFSTACK_NODE* node);
+
+/* Pop the node from the top of the stack. Returns NULL if the stack is empty.
+ */
+LFSTACK_NODE* lfstack_pop(LFSTACK* stack);
+
+/* Detach all nodes at once. Returns the former top node (or NULL if the stack
+ * is empty). The nodes can then be walked with lfstack_next() until NULL is
+ * reached. They are in the LIFO order.
+ */
+LFSTACK_NODE* lfstack_pop_all(LFSTACK* stack);
+
+/* Get the next node in a chain returned by lfstack_pop_all().
+ */
+LFSTACK_NODE* lfstack_next(const LFSTACK_NODE* node);
+
+
+/****************************************************
+ *** MPSCQ (multi-producer/single-consumer queue) ***
+ ****************************************************/
+
+/* This is the intrusive variant of the Michael-Scott queue as described by
+ * Dmitry Vyukov: Producers never loop, they just exchange the queue tail with
+ * the new node and then link the previous tail to it. The queue uses an
+ * embedded stub node so it is never empty internally.
+ *
+ * A consequence is that mpscq_pop() may return NULL even though the queue is
+ * not empty, if a producer has been preempted between the two steps of
+ * mpscq_push(). The consumer then has to retry later; it gets the node as
+ * soon as the producer continues.
+ */
+
+#define LFLIST_CACHELINE_SIZE__     64
+
+/* Queue node structure. Treat as opaque.
+ */
+typedef struct MPSCQ_NODE {
+    struct MPSCQ_NODE* volatile n;      /* next */
+} MPSCQ_NODE;
+
+
+/* Queue structure. Treat as opaque.
+ *
+ * The member written by producers and those owned by the consumer live in
+ * separate cache lines.
+ */
+typedef struct MPSCQ {
+    /* Shared by all producers: The most recently pushed node. */
+    MPSCQ_NODE* volatile tail;
+    uint8_t pad0[LFLIST_CACHELINE_SIZE__ - sizeof(MPSCQ_NODE*)];
+
+    /* Owned by the consumer: The oldest node (possibly the stub). */
+    MPSCQ_NODE* head;
+    MPSCQ_NODE stub;
+    uint8_t pad1[LFLIST_CACHELINE_SIZE__ - 2 * sizeof(MPSCQ_NODE*)];
+} MPSCQ;
+
+
+/* Macro for getting pointer to the structure holding the node.
+ */
+#define MPSCQ_DATA(node_ptr, type, member)  \
+                ((type*)((char*)(node_ptr) - LFLIST_OFFSETOF__(type, member)))
+
+
+/* The queue has to be initialized before it is used by any other function.
+ * (This itself is not thread-safe.)
+ *
+ * Note the queue structure must not be moved in memory after the
+ * initialization, as it holds a pointer to its own member.
+ */
+void mpscq_init(MPSCQ* queue);
+
+/* Check whether the queue is empty. May be called only by the consumer.
+ */
+int mpscq_is_empty(const MPSCQ* queue);
+
+/* Append the node at the end of the queue. May be called by any thread.
+ */
+void mpscq_push(MPSCQ* queue, MPSCQ_NODE* node);
+
+/* Remove the node from the front of the queue. May be called only by the
+ * consumer. Returns NULL if the queue is empty (or see above).
+ */
+MPSCQ_NODE* mpscq_pop(MPSCQ* queue);
+
+
+#ifdef __cplusplus
+}  /* extern "C" { */
+#endif
+
+#endif  /* CRE_LFLIST_H */
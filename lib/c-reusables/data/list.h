@@ -135,6 +135,9 @@ extern "C" {
  *
  * Notes:
  *  (1): The caller has to additionally provide pointer to the _previous_ node.
+ *
+ * None of these lists is thread-safe. See lflist.h for lock-free variants of
+ * a stack and a queue.
  */
 
 
@@ -0,0 +1,357 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2020 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "msort.h"
+
+#include <string.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <pthread.h>
+    #include <unistd.h>
+#endif
+
+
+#ifndef MIN
+    #define MIN(a,b)    ((a) < (b) ? (a) : (b))
+#endif
+
+
+/* Runs shorter than this are sorted with an insertion sort. */
+#define MSORT_RUN               16
+
+/* Do not bother with threads for parts smaller than this. */
+#define MSORT_PARALLEL_MIN      4096
+
+#define MSORT_MAX_THREADS       64
+
+
+static void
+msort_insertion(size_t* vec, size_t n, MSORT_CMP_FUNC cmp, void* ctx)
+{
+    size_t i, j, x;
+
+    for(i = 1; i < n; i++) {
+        x = vec[i];
+        j = i;
+        while(j > 0  &&  cmp(x, vec[j-1], ctx) < 0) {
+            vec[j] = vec[j-1];
+            j--;
+        }
+        vec[j] = x;
+    }
+}
+
+/* Merge the sorted runs src[0 ... n1-1] and src[n1 ... n-1] into dst. */
+static void
+msort_merge(const size_t* src, size_t n1, size_t n, size_t* dst,
+            MSORT_CMP_FUNC cmp, void* ctx)
+{
+    size_t i = 0;
+    size_t j = n1;
+    size_t k = 0;
+
+    /* Fast path: The runs are already in order. */
+    if(n1 == 0  ||  n1 == n  ||  cmp(src[n1-1], src[n1], ctx) <= 0) {
+        memcpy(dst, src, n * sizeof(size_t));
+        return;
+    }
+
+    while(i < n1  &&  j < n) {
+        /* Take from the right run only if strictly less (stability). */
+        if(cmp(src[j], src[i], ctx) < 0)
+            dst[k++] = src[j++];
+        else
+            dst[k++] = src[i++];
+    }
+
+    if(i < n1)
+        memcpy(dst + k, src + i, (n1 - i) * sizeof(size_t));
+    else
+        memcpy(dst + k, src + j, (n - j) * sizeof(size_t));
+}
+
+/* Bottom-up merge sort of vec, using tmp (of the same size) as a scratch
+ * buffer. The result always ends in vec. */
+static void
+msort_sort(size_t* vec, size_t* tmp, size_t n, MSORT_CMP_FUNC cmp, void* ctx)
+{
+    size_t* src = vec;
+    size_t* dst = tmp;
+    size_t* swap;
+    size_t i, width;
+
+    for(i = 0; i < n; i += MSORT_RUN)
+        msort_insertion(vec + i, MIN(MSORT_RUN, n - i), cmp, ctx);
+
+    for(width = MSORT_RUN; width < n; width *= 2) {
+        for(i = 0; i < n; i += 2 * width) {
+            msort_merge(src + i, MIN(width, n - i), MIN(2 * width, n - i),
+                        dst + i, cmp, ctx);
+        }
+        swap = src;
+        src = dst;
+        dst = swap;
+    }
+
+    if(src != vec)
+        memcpy(vec, src, n * sizeof(size_t));
+}
+
+int
+msort(size_t* vec, size_t n, MSORT_CMP_FUNC cmp, void* ctx)
+{
+    size_t* tmp;
+
+    if(n <= MSORT_RUN) {
+        msort_insertion(vec, n, cmp, ctx);
+        return 0;
+    }
+
+    tmp = (size_t*) malloc(n * sizeof(size_t));
+    if(tmp == NULL)
+        return -1;
+
+    msort_sort(vec, tmp, n, cmp, ctx);
+    free(tmp);
+    return 0;
+}
+
+
+/*********************
+ *** Parallel sort ***
+ *********************/
+
+typedef struct MSORT_TASK {
+    size_t* src;
+    size_t* dst;
+    size_t n1;          /* Merge: Size of the left run. */
+    size_t n;
+    int merge;          /* Merge the two runs of src into dst, or sort src
+                         * (using dst as the scratch buffer)? */
+    MSORT_CMP_FUNC cmp;
+    void* ctx;
+} MSORT_TASK;
+
+static void
+msort_task_run(MSORT_TASK* task)
+{
+    if(task->merge)
+        msort_merge(task->src, task->n1, task->n, task->dst, task->cmp, task->ctx);
+    else
+        msort_sort(task->src, task->dst, task->n, task->cmp, task->ctx);
+}
+
+#ifdef _WIN32
+static DWORD WINAPI
+msort_thread_proc(void* param)
+{
+    msort_task_run((MSORT_TASK*) param);
+    return 0;
+}
+#else
+static void*
+msort_thread_proc(void* param)
+{
+    msort_task_run((MSORT_TASK*) param);
+    return NULL;
+}
+#endif
+
+static unsigned
+msort_cpu_count(void)
+{
+#ifdef _WIN32
+    SYSTEM_INFO si;
+
+    GetSystemInfo(&si);
+    return si.dwNumberOfProcessors;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return (n > 0 ? (unsigned) n : 1);
+#endif
+}
+
+/* Run the (independent) tasks. The calling thread runs the first one, the
+ * others go to the worker threads. If a thread cannot be started, we simply
+ * run its task ourselves. */
+static void
+msort_run_tasks(MSORT_TASK* tasks, unsigned n)
+{
+#ifdef _WIN32
+    HANDLE threads[MSORT_MAX_THREADS];
+#else
+    pthread_t threads[MSORT_MAX_THREADS];
+#endif
+    int started[MSORT_MAX_THREADS];
+    unsigned i;
+
+    for(i = 1; i < n; i++) {
+#ifdef _WIN32
+        threads[i] = CreateThread(NULL, 0, msort_thread_proc, &tasks[i], 0, NULL);
+        started[i] = (threads[i] != NULL);
+#else
+        started[i] = (pthread_create(&threads[i], NULL, msort_thread_proc, &tasks[i]) == 0);
+#endif
+        if(!started[i])
+            msort_task_run(&tasks[i]);
+    }
+
+    if(n > 0)
+        msort_task_run(&tasks[0]);
+
+    for(i = 1; i < n; i++) {
+        if(!started[i])
+            continue;
+#ifdef _WIN32
+        WaitForSingleObject(threads[i], INFINITE);
+        CloseHandle(threads[i]);
+#else
+        pthread_join(threads[i], NULL);
+#endif
+    }
+}
+
+int
+msort_parallel(size_t* vec, size_t n, MSORT_CMP_FUNC cmp, void* ctx,
+               unsigned thread_count)
+{
+    MSORT_TASK tasks[MSORT_MAX_THREADS];
+    size_t bounds[MSORT_MAX_THREADS + 1];
+    size_t* tmp;
+    size_t* src;
+    size_t* dst;
+    size_t* swap;
+    unsigned i, n_parts, n_tasks;
+
+    if(thread_count == 0)
+        thread_count = msort_cpu_count();
+    if(thread_count > MSORT_MAX_THREADS)
+        thread_count = MSORT_MAX_THREADS;
+    if(thread_count > n / MSORT_PARALLEL_MIN)
+        thread_count = (unsigned) (n / MSORT_PARALLEL_MIN);
+    if(thread_count <= 1)
+        return msort(vec, n, cmp, ctx);
+
+    tmp = (size_t*) malloc(n * sizeof(size_t));
+    if(tmp == NULL)
+        return -1;
+
+    /* Split the vector into the parts and sort each of them in its thread. */
+    n_parts = thread_count;
+    for(i = 0; i <= n_parts; i++)
+        bounds[i] = (n / n_parts) * i + MIN(i, n % n_parts);
+    for(i = 0; i < n_parts; i++) {
+        tasks[i].src = vec + bounds[i];
+        tasks[i].dst = tmp + bounds[i];
+        tasks[i].n1 = 0;
+        tasks[i].n = bounds[i+1] - bounds[i];
+        tasks[i].merge = 0;
+        tasks[i].cmp = cmp;
+        tasks[i].ctx = ctx;
+    }
+    msort_run_tasks(tasks, n_parts);
+
+    /* Merge the neighboring parts pair-wise until a single one remains. */
+    src = vec;
+    dst = tmp;
+    while(n_parts > 1) {
+        n_tasks = 0;
+        for(i = 0; i + 1 < n_parts; i += 2) {
+            tasks[n_tasks].src = src + bounds[i];
+            tasks[n_tasks].dst = dst + bounds[i];
+            tasks[n_tasks].n1 = bounds[i+1] - bounds[i];
+            tasks[n_tasks].n = bounds[i+2] - bounds[i];
+            tasks[n_tasks].merge = 1;
+            tasks[n_tasks].cmp = cmp;
+            tasks[n_tasks].ctx = ctx;
+            n_tasks++;
+        }
+        if(i < n_parts) {
+            /* The odd part out has no pair on this level. */
+            memcpy(dst + bounds[i], src + bounds[i],
+                   (bounds[i+1] - bounds[i]) * sizeof(size_t));
+        }
+        msort_run_tasks(tasks, n_tasks);
+
+        for(i = 0; 2 * i < n_parts; i++)
+            bounds[i] = bounds[2 * i];
+        bounds[i] = n;
+        n_parts = i;
+
+        swap = src;
+        src = dst;
+        dst = swap;
+    }
+
+    if(src != vec)
+        memcpy(vec, src, n * sizeof(size_t));
+    free(tmp);
+    return 0;
+}
+
+
+/*********************
+ *** Binary search ***
+ *********************/
+
+size_t
+msort_lower_bound(const size_t* vec, size_t n, size_t index,
+                  MSORT_CMP_FUNC cmp, void* ctx)
+{
+    size_t lo = 0;
+    size_t hi = n;
+    size_t mid;
+
+    while(lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if(cmp(vec[mid], index, ctx) < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return lo;
+}
+
+size_t
+msort_upper_bound(const size_t* vec, size_t n, size_t index,
+                  MSORT_CMP_FUNC cmp, void* ctx)
+{
+    size_t lo = 0;
+    size_t hi = n;
+    size_t mid;
+
+    while(lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if(cmp(index, vec[mid], ctx) < 0)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+
+    return lo;
+}
@@ -0,0 +1,77 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2020 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef CRE_MSORT_H
+#define CRE_MSORT_H
+
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/* Stable merge sort of index vectors.
+ *
+ * The vector holds indexes (e.g. row numbers) into some data the application
+ * owns, and the comparator compares the data the indexes refer to. Unlike
+ * qsort(), the comparator gets a context pointer, so no global state is
+ * needed, and the sort is stable: Equal elements keep their mutual order.
+ *
+ * The sort is adaptive: Already ordered parts of the vector are detected and
+ * only copied instead of being merged.
+ */
+
+typedef int (*MSORT_CMP_FUNC)(size_t /*a*/, size_t /*b*/, void* /*ctx*/);
+
+
+/* Sort the vector. Returns 0 on success, -1 on an allocation failure (then
+ * the vector is left intact). */
+int msort(size_t* vec, size_t n, MSORT_CMP_FUNC cmp, void* ctx);
+
+/* Same as msort(), but (for large vectors) the work is split among up to
+ * thread_count worker threads. Zero means the count of CPUs in the system.
+ *
+ * The comparator is then called concurrently from multiple threads, so it
+ * must not modify any shared state. The result is the same as of msort().
+ */
+int msort_parallel(size_t* vec, size_t n, MSORT_CMP_FUNC cmp, void* ctx,
+                   unsigned thread_count);
+
+/* Binary search in the sorted vector: Get the position of the first element
+ * which is not less (lower bound), or which is greater (upper bound) than
+ * the given index. Inserting the index at the upper bound keeps the vector
+ * sorted as well as stable. */
+size_t msort_lower_bound(const size_t* vec, size_t n, size_t index,
+                         MSORT_CMP_FUNC cmp, void* ctx);
+size_t msort_upper_bound(const size_t* vec, size_t n, size_t index,
+                         MSORT_CMP_FUNC cmp, void* ctx);
+
+
+#ifdef __cplusplus
+}  /* extern "C" { */
+#endif
+
+#endif  /* CRE_MSORT_H */
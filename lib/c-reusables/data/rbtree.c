@@ -44,6 +44,11 @@
 #define SET_LEFT(node, ptr)     do { (node)->lc = (RBTREE_NODE*)((uintptr_t)(ptr) | COLOR(node)); } while(0)
 #define SET_RIGHT(node, ptr)    do { (node)->r = (ptr); } while(0)
 
+#define IS_SIZED(tree)          ((tree)->flags & RBTREE_FLAG_SIZED)
+#define SIZE_REF(node)          (((RBTREE_SIZED_NODE*)(node))->size)
+#define SIZE(node)              ((node) != NULL ? SIZE_REF(node) : 0)
+#define UPDATE_SIZE(node)       do { SIZE_REF(node) = SIZE(LEFT(node)) + SIZE(RIGHT(node)) + 1; } while(0)
+
 
 typedef RBTREE_CURSOR RBTREE_PATH;
 
@@ -59,6 +64,11 @@ rbtree_rotate_left(RBTREE* tree, RBTREE_NODE* parent, RBTREE_NODE* node)
     SET_RIGHT(node, LEFT(tmp));
     SET_LEFT(tmp, node);
 
+    if(IS_SIZED(tree)) {
+        SIZE_REF(tmp) = SIZE_REF(node);
+        UPDATE_SIZE(node);
+    }
+
     if(parent != NULL) {
         if(node == LEFT(parent))
             SET_LEFT(parent, tmp);
@@ -78,6 +88,11 @@ rbtree_rotate_right(RBTREE* tree, RBTREE_NODE* parent, RBTREE_NODE* node)
     SET_LEFT(node, RIGHT(tmp));
     SET_RIGHT(tmp, node);
 
+    if(IS_SIZED(tree)) {
+        SIZE_REF(tmp) = SIZE_REF(node);
+        UPDATE_SIZE(node);
+    }
+
     if(parent != NULL) {
         if(node == RIGHT(parent))
             SET_RIGHT(parent, tmp);
@@ -171,6 +186,12 @@ rbtree_lookup_path(RBTREE_NODE* node, const RBTREE_NODE* key,
     return cmp;
 }
 
+/* Re-balances the tree after inserting a new node at the end of the path.
+ *
+ * The path is kept up to date through any rotations, so when we are done, it
+ * still leads from the (possibly new) root down to the inserted node. This
+ * allows caller to use it as a cursor pointing to the new node.
+ */
 static void
 rbtree_insert_fixup(RBTREE* tree, RBTREE_PATH* path)
 {
@@ -179,6 +200,9 @@ rbtree_insert_fixup(RBTREE* tree, RBTREE_PATH* path)
     RBTREE_NODE* grandparent;
     RBTREE_NODE* grandgrandparent;
     RBTREE_NODE* uncle;
+    RBTREE_NODE* below;
+    unsigned k = path->n;   /* The node being fixed is path->stack[k-1]. */
+    unsigned i;
 
     /* A newly inserted node usually (except the root) starts as a red one,
      * i.e. it could introduce "a double red" problem in the tree, where both
@@ -186,8 +210,8 @@ rbtree_insert_fixup(RBTREE* tree, RBTREE_PATH* path)
      * rules. */
 
     while(1) {
-        node = path->stack[path->n - 1];
-        parent = (path->n > 1) ? path->stack[path->n - 2] : NULL;
+        node = path->stack[k - 1];
+        parent = (k > 1) ? path->stack[k - 2] : NULL;
 
         /* No parent: the node is a root and root should alway be black. */
         if(parent == NULL) {
@@ -203,33 +227,61 @@ rbtree_insert_fixup(RBTREE* tree, RBTREE_PATH* path)
 
         /* If we reach here, there is the double-red problem.
          * Note grandparent has to exist and be black (implied from red parent). */
-        grandparent = path->stack[path->n - 3];
+        grandparent = path->stack[k - 3];
         uncle = (parent == LEFT(grandparent)) ? RIGHT(grandparent) : LEFT(grandparent);
         if(uncle == NULL || IS_BLACK(uncle)) {
             /* Black uncle. */
-            grandgrandparent = (path->n > 3) ? path->stack[path->n - 4] : NULL;
-            if(LEFT(grandparent) != NULL  &&   node == RIGHT(LEFT(grandparent))) {
+            grandgrandparent = (k > 3) ? path->stack[k - 4] : NULL;
+            below = (k < path->n) ? path->stack[k] : NULL;
+
+            if(parent == LEFT(grandparent)  &&  node == RIGHT(parent)) {
+                /* The node's left subtree goes below the parent (as its right
+                 * child), its right subtree below the grandparent (as its left
+                 * child). Remember where the rest of the path goes. */
+                below = (below == NULL) ? NULL : (below == LEFT(node) ? parent : grandparent);
                 rbtree_rotate_left(tree, grandparent, parent);
-                parent = node;
-                node = LEFT(node);
-            } else if(RIGHT(grandparent) != NULL  &&  node == LEFT(RIGHT(grandparent))) {
-                rbtree_rotate_right(tree, grandparent, parent);
-                parent = node;
-                node = RIGHT(node);
-            }
-            if(node == LEFT(parent))
                 rbtree_rotate_right(tree, grandgrandparent, grandparent);
-            else
+                MAKE_BLACK(node);
+                MAKE_RED(grandparent);
+                path->stack[k - 3] = node;
+            } else if(parent == RIGHT(grandparent)  &&  node == LEFT(parent)) {
+                /* Mirrored case of the above. */
+                below = (below == NULL) ? NULL : (below == LEFT(node) ? grandparent : parent);
+                rbtree_rotate_right(tree, grandparent, parent);
                 rbtree_rotate_left(tree, grandgrandparent, grandparent);
+                MAKE_BLACK(node);
+                MAKE_RED(grandparent);
+                path->stack[k - 3] = node;
+            } else {
+                if(node == LEFT(parent))
+                    rbtree_rotate_right(tree, grandgrandparent, grandparent);
+                else
+                    rbtree_rotate_left(tree, grandgrandparent, grandparent);
+
+                /* Note that now, after the rotation, the parent lives where
+                 * the grand-parent was originally in the tree hierarchy, and
+                 * the grandparent instead became child of it.
+                 *
+                 * We switch their colors and hence make sure the parent (upper
+                 * in the hierarchy) is now black, fixing the double-red
+                 * problem. */
+                MAKE_BLACK(parent);
+                MAKE_RED(grandparent);
+                path->stack[k - 3] = parent;
+                below = node;
+            }
 
-            /* Note that now, after the rotations, the parent points to where
-             * the grand-parent was originally in the tree hierarchy, and
-             * the grandparent instead became child of it.
-             *
-             * We switch their colors and hence make sure the parent (upper in
-             * the hierarchy) is now black, fixing the double-red problem. */
-            MAKE_BLACK(parent);
-            MAKE_RED(grandparent);
+            /* Fix the rest of the path: The three nodes (grandparent, parent,
+             * node) have been replaced with two (or just one if the node was
+             * at the end of the path and it became the subtree root). */
+            if(below == NULL) {
+                path->n = k - 2;
+            } else {
+                path->stack[k - 2] = below;
+                for(i = k; i < path->n; i++)
+                    path->stack[i - 1] = path->stack[i];
+                path->n--;
+            }
             break;
         }
 
@@ -241,46 +293,131 @@ rbtree_insert_fixup(RBTREE* tree, RBTREE_PATH* path)
 
         /* But it means we could just move the double-red issue two levels
          * up, so we have to continue there. */
-        path->n -= 2;
+        k -= 2;
     }
 }
 
-int
-rbtree_insert(RBTREE* tree, RBTREE_NODE* node, RBTREE_CMP_FUNC cmp_func)
+/* Connects the node as a new leaf below the last node of the path (or as the
+ * root if the path is empty) and re-balances the tree. The path is updated to
+ * lead to the inserted node. */
+static void
+rbtree_insert_at(RBTREE* tree, RBTREE_NODE* node, RBTREE_PATH* path, int as_left)
 {
-    RBTREE_PATH path;
-    int cmp;
-
-    path.n = 0;
-
-    /* Lookup the place where we should live. */
-    cmp = rbtree_lookup_path(tree->root, node, cmp_func, &path);
-    if(path.n > 0  &&  cmp == 0) {
-        /* An equal node already present. */
-        return -1;
-    }
+    unsigned i;
 
     SET_LEFT(node, NULL);
     SET_RIGHT(node, NULL);
     MAKE_RED(node);
 
-    /* Insert the node as child of a leaf node. */
-    if(path.n > 0) {
-        if(cmp < 0)
-            SET_LEFT(path.stack[path.n - 1], node);
+    if(IS_SIZED(tree)) {
+        SIZE_REF(node) = 1;
+        for(i = 0; i < path->n; i++)
+            SIZE_REF(path->stack[i])++;
+    }
+
+    if(path->n > 0) {
+        if(as_left)
+            SET_LEFT(path->stack[path->n - 1], node);
         else
-            SET_RIGHT(path.stack[path.n - 1], node);
+            SET_RIGHT(path->stack[path->n - 1], node);
     } else {
         tree->root = node;
     }
-    path.stack[path.n++] = node;
+    path->stack[path->n++] = node;
 
     /* Preserve RB-tree properties. */
-    rbtree_insert_fixup(tree, &path);
+    rbtree_insert_fixup(tree, path);
+}
 
+/* Insert the node. The path is set to lead to the inserted node or, if an
+ * equal node is already present, to that node. */
+static int
+rbtree_insert_path(RBTREE* tree, RBTREE_NODE* node,
+                   RBTREE_CMP_FUNC cmp_func, RBTREE_PATH* path)
+{
+    int cmp;
+
+    path->n = 0;
+
+    /* Lookup the place where we should live. */
+    cmp = rbtree_lookup_path(tree->root, node, cmp_func, path);
+    if(path->n > 0  &&  cmp == 0) {
+        /* An equal node already present. */
+        return -1;
+    }
+
+    /* Insert the node as child of a leaf node. */
+    rbtree_insert_at(tree, node, path, (cmp < 0));
     return 0;
 }
 
+int
+rbtree_insert(RBTREE* tree, RBTREE_NODE* node, RBTREE_CMP_FUNC cmp_func)
+{
+    RBTREE_PATH path;
+    return rbtree_insert_path(tree, node, cmp_func, &path);
+}
+
+int
+rbtree_insert_hint(RBTREE* tree, RBTREE_NODE* node,
+                   RBTREE_CMP_FUNC cmp_func, RBTREE_CURSOR* cur)
+{
+    RBTREE_NODE* hint;
+    unsigned i;
+    int cmp;
+
+    hint = rbtree_current(cur);
+    if(hint == NULL)
+        return rbtree_insert_path(tree, node, cmp_func, cur);
+
+    cmp = cmp_func(node, hint);
+    if(cmp == 0)
+        return -1;  /* The cursor already points to the equal node. */
+
+    if(cmp > 0) {
+        if(RIGHT(hint) != NULL) {
+            /* The node has to go between the hint and the leftmost node of
+             * its right subtree, i.e. as a left child of the latter. */
+            rbtree_leftmost_path(RIGHT(hint), cur);
+            if(cmp_func(node, cur->stack[cur->n - 1]) < 0) {
+                rbtree_insert_at(tree, node, cur, 1);
+                return 0;
+            }
+        } else {
+            /* The successor of the hint (if any) is the nearest ancestor
+             * whose left subtree we are in. */
+            i = cur->n - 1;
+            while(i > 0  &&  cur->stack[i] == RIGHT(cur->stack[i - 1]))
+                i--;
+            if(i == 0  ||  cmp_func(node, cur->stack[i - 1]) < 0) {
+                rbtree_insert_at(tree, node, cur, 0);
+                return 0;
+            }
+        }
+    } else {
+        /* Mirrored logic of the above. */
+        if(LEFT(hint) != NULL) {
+            rbtree_rightmost_path(LEFT(hint), cur);
+            if(cmp_func(node, cur->stack[cur->n - 1]) > 0) {
+                rbtree_insert_at(tree, node, cur, 0);
+                return 0;
+            }
+        } else {
+            i = cur->n - 1;
+            while(i > 0  &&  cur->stack[i] == LEFT(cur->stack[i - 1]))
+                i--;
+            if(i == 0  ||  cmp_func(node, cur->stack[i - 1]) > 0) {
+                rbtree_insert_at(tree, node, cur, 1);
+                return 0;
+            }
+        }
+    }
+
+    /* The hint is not adjacent to the position the node belongs to. Fall back
+     * to the normal insertion. */
+    return rbtree_insert_path(tree, node, cmp_func, cur);
+}
+
 static void
 rbtree_remove_fixup(RBTREE* tree, RBTREE_PATH* path)
 {
@@ -439,6 +576,14 @@ rbtree_remove(RBTREE* tree, const RBTREE_NODE* key, RBTREE_CMP_FUNC cmp_func)
                 TOGGLE_COLOR(successor);
                 TOGGLE_COLOR(node);
             }
+
+            /* The subtree sizes belong to the positions in the tree so they
+             * have to be swapped too. */
+            if(IS_SIZED(tree)) {
+                size_t tmp_size = SIZE_REF(successor);
+                SIZE_REF(successor) = SIZE_REF(node);
+                SIZE_REF(node) = tmp_size;
+            }
         }
     }
 
@@ -456,6 +601,12 @@ rbtree_remove(RBTREE* tree, const RBTREE_NODE* key, RBTREE_CMP_FUNC cmp_func)
     }
     path.stack[path.n - 1] = single_child;
 
+    if(IS_SIZED(tree)) {
+        unsigned i;
+        for(i = 0; i < path.n - 1; i++)
+            SIZE_REF(path.stack[i])--;
+    }
+
     /* Re-balancing may be needed if we have removed a black node. */
     if(IS_BLACK(node))
         rbtree_remove_fixup(tree, &path);
@@ -570,12 +721,286 @@ rbtree_prev(RBTREE_CURSOR* cur)
 }
 
 
+/* Disassembles the tree into a sorted list of its nodes, chained via the
+ * right pointers (the left ones are all reset to NULL). This is the "tree to
+ * vine" step of the Day-Stout-Warren algorithm: It needs no extra memory and
+ * it runs in O(n).
+ *
+ * Returns count of the nodes.
+ */
+static size_t
+rbtree_to_list(RBTREE_NODE* root, RBTREE_NODE** p_list)
+{
+    RBTREE_NODE** p_tail = p_list;
+    RBTREE_NODE* rest = root;
+    RBTREE_NODE* tmp;
+    size_t n = 0;
+
+    while(rest != NULL) {
+        if(LEFT(rest) == NULL) {
+            *p_tail = rest;
+            p_tail = &rest->r;
+            rest = RIGHT(rest);
+            n++;
+        } else {
+            /* Rotate right to pull the left subtree into the vine. */
+            tmp = LEFT(rest);
+            SET_LEFT(rest, RIGHT(tmp));
+            SET_RIGHT(tmp, rest);
+            rest = tmp;
+        }
+    }
+
+    *p_tail = NULL;
+    return n;
+}
+
+/* Compute depth of the red nodes in a tree built by rbtree_build_recurse().
+ *
+ * Such tree has all its leaves at two neighboring levels at most. If we make
+ * red all the nodes at the lowest level (and only them), all root<-->leaf
+ * paths have the same black height. If the lowest level is complete, all the
+ * nodes remain black (and we return a depth no node can have). */
+static unsigned
+rbtree_red_depth(size_t n)
+{
+    size_t full = 1;    /* Node count of a complete tree of the given depth. */
+    unsigned depth = 0;
+
+    while(full <= (n - 1) / 2) {
+        full = 2 * full + 1;
+        depth++;
+    }
+
+    return (n == full) ? (unsigned) -1 : depth + 1;
+}
+
+/* Build a balanced subtree of the first n nodes of the sorted list, consuming
+ * them from the list. Both subtrees of any node differ in their node count by
+ * one at most. */
+static RBTREE_NODE*
+rbtree_build_recurse(RBTREE_NODE** p_list, size_t n, unsigned depth,
+                     unsigned red_depth, int sized)
+{
+    RBTREE_NODE* left;
+    RBTREE_NODE* node;
+
+    if(n == 0)
+        return NULL;
+
+    left = rbtree_build_recurse(p_list, n / 2, depth + 1, red_depth, sized);
+
+    node = *p_list;
+    *p_list = RIGHT(node);
+
+    node->lc = left;    /* Also makes the node black. */
+    SET_RIGHT(node, rbtree_build_recurse(p_list, n - n / 2 - 1, depth + 1, red_depth, sized));
+    if(depth == red_depth)
+        MAKE_RED(node);
+    if(sized)
+        SIZE_REF(node) = n;
+
+    return node;
+}
+
+static void
+rbtree_build_from_list(RBTREE* tree, RBTREE_NODE* list, size_t n)
+{
+    tree->root = (n > 0) ? rbtree_build_recurse(&list, n, 0,
+                                rbtree_red_depth(n), IS_SIZED(tree)) : NULL;
+}
+
+void
+rbtree_build_from_sorted(RBTREE* tree, RBTREE_NODE** nodes, size_t n)
+{
+    size_t i;
+
+    for(i = 1; i < n; i++)
+        SET_RIGHT(nodes[i - 1], nodes[i]);
+
+    rbtree_build_from_list(tree, (n > 0) ? nodes[0] : NULL, n);
+}
+
+int
+rbtree_merge(RBTREE* tree, RBTREE* other, RBTREE_CMP_FUNC cmp_func)
+{
+    RBTREE_NODE* a;
+    RBTREE_NODE* b;
+    RBTREE_NODE* merged = NULL;
+    RBTREE_NODE** p_merged_tail = &merged;
+    RBTREE_NODE* dups = NULL;
+    RBTREE_NODE** p_dups_tail = &dups;
+    size_t n_merged;
+    size_t n_dups = 0;
+    int cmp;
+
+    if(other->root == NULL)
+        return 0;
+
+    n_merged = rbtree_to_list(tree->root, &a);
+    n_merged += rbtree_to_list(other->root, &b);
+
+    while(a != NULL  &&  b != NULL) {
+        cmp = cmp_func(a, b);
+        if(cmp <= 0) {
+            *p_merged_tail = a;
+            p_merged_tail = &a->r;
+            a = RIGHT(a);
+        }
+        if(cmp >= 0) {
+            if(cmp == 0) {
+                /* Equal node already present: Keep it in the other tree. */
+                *p_dups_tail = b;
+                p_dups_tail = &b->r;
+                n_merged--;
+                n_dups++;
+            } else {
+                *p_merged_tail = b;
+                p_merged_tail = &b->r;
+            }
+            b = RIGHT(b);
+        }
+    }
+    *p_merged_tail = (a != NULL) ? a : b;
+    *p_dups_tail = NULL;
+
+    rbtree_build_from_list(tree, merged, n_merged);
+    rbtree_build_from_list(other, dups, n_dups);
+
+    return (n_dups == 0) ? 0 : -1;
+}
+
+void
+rbtree_split(RBTREE* tree, const RBTREE_NODE* key,
+             RBTREE_CMP_FUNC cmp_func, RBTREE* right)
+{
+    RBTREE_NODE* node = tree->root;
+    RBTREE_NODE* first_right = NULL;
+    RBTREE_NODE* list;
+    RBTREE_NODE** p_link;
+    size_t n, n_left;
+
+    /* Find the first node not lower then the key. That's the only place where
+     * we need to call the comparator. */
+    while(node != NULL) {
+        if(cmp_func(key, node) <= 0) {
+            first_right = node;
+            node = LEFT(node);
+        } else {
+            node = RIGHT(node);
+        }
+    }
+
+    n = rbtree_to_list(tree->root, &list);
+
+    n_left = 0;
+    p_link = &list;
+    while(*p_link != first_right) {
+        p_link = &(*p_link)->r;
+        n_left++;
+    }
+    *p_link = NULL;
+
+    rbtree_build_from_list(tree, list, n_left);
+    rbtree_build_from_list(right, first_right, n - n_left);
+}
+
+
+RBTREE_NODE*
+rbtree_select(RBTREE* tree, size_t k)
+{
+    RBTREE_NODE* node = tree->root;
+    size_t left_size;
+
+    while(node != NULL) {
+        left_size = SIZE(LEFT(node));
+
+        if(k < left_size) {
+            node = LEFT(node);
+        } else if(k > left_size) {
+            k -= left_size + 1;
+            node = RIGHT(node);
+        } else {
+            break;
+        }
+    }
+
+    return node;
+}
+
+RBTREE_NODE*
+rbtree_select_ex(RBTREE* tree, size_t k, RBTREE_CURSOR* cur)
+{
+    RBTREE_NODE* node = tree->root;
+    size_t left_size;
+
+    cur->n = 0;
+    while(node != NULL) {
+        cur->stack[cur->n++] = node;
+        left_size = SIZE(LEFT(node));
+
+        if(k < left_size) {
+            node = LEFT(node);
+        } else if(k > left_size) {
+            k -= left_size + 1;
+            node = RIGHT(node);
+        } else {
+            return node;
+        }
+    }
+
+    cur->n = 0; /* Out of range: Reset the cursor. */
+    return NULL;
+}
+
+size_t
+rbtree_rank(RBTREE* tree, const RBTREE_NODE* key, RBTREE_CMP_FUNC cmp_func)
+{
+    RBTREE_NODE* node = tree->root;
+    size_t rank = 0;
+    int cmp;
+
+    while(node != NULL) {
+        cmp = cmp_func(key, node);
+
+        if(cmp < 0) {
+            node = LEFT(node);
+        } else if(cmp > 0) {
+            rank += SIZE(LEFT(node)) + 1;
+            node = RIGHT(node);
+        } else {
+            rank += SIZE(LEFT(node));
+            break;
+        }
+    }
+
+    return rank;
+}
+
+size_t
+rbtree_current_rank(RBTREE_CURSOR* cur)
+{
+    size_t rank;
+    unsigned i;
+
+    rank = SIZE(LEFT(cur->stack[cur->n - 1]));
+
+    /* Add all the nodes on the left side of the path. */
+    for(i = cur->n - 1; i > 0; i--) {
+        if(cur->stack[i] == RIGHT(cur->stack[i - 1]))
+            rank += SIZE(LEFT(cur->stack[i - 1])) + 1;
+    }
+
+    return rank;
+}
+
+
 #ifdef CRE_TEST
 /* Verification of RB-tree correctness. */
 
 /* Returns black height of the tree, or -1 on an error. */
 static int
-rbtree_verify_recurse(RBTREE_NODE* node)
+rbtree_verify_recurse(RBTREE_NODE* node, int sized)
 {
     RBTREE_NODE* children[2];
     RBTREE_NODE* child;
@@ -598,7 +1023,7 @@ rbtree_verify_recurse(RBTREE_NODE* node)
             return -1;
 
         /* Verify the child subtree. */
-        child_height[i] = rbtree_verify_recurse(child);
+        child_height[i] = rbtree_verify_recurse(child, sized);
         if(child_height[i] < 0)
             return -1;
     }
@@ -607,6 +1032,10 @@ rbtree_verify_recurse(RBTREE_NODE* node)
     if(child_height[0] != child_height[1])
         return -1;
 
+    /* Sized tree must have the subtree sizes right. */
+    if(sized  &&  SIZE_REF(node) != SIZE(children[0]) + SIZE(children[1]) + 1)
+        return -1;
+
     return child_height[0] + (IS_BLACK(node) ? 1 : 0);
 }
 
@@ -618,7 +1047,7 @@ rbtree_verify(RBTREE* tree)
     if(tree->root != NULL  &&  IS_RED(tree->root))
         return -1;
 
-    return (rbtree_verify_recurse(tree->root) >= 0) ? 0 : -1;
+    return (rbtree_verify_recurse(tree->root, IS_SIZED(tree)) >= 0) ? 0 : -1;
 }
 
 #endif  /* #ifdef CRE_TEST */
@@ -111,10 +111,25 @@ typedef struct RBTREE_NODE {
 } RBTREE_NODE;
 
 
+/* Node structure for trees maintaining the subtree sizes (see below the
+ * section "Order statistics"). Treat as opaque.
+ *
+ * Nodes of such trees have to be embedded as this structure instead of the
+ * plain RBTREE_NODE, but all the functions still take a pointer to the
+ * RBTREE_NODE, i.e. to the member RBTREE_SIZED_NODE::base. (As the member is
+ * the first one in the structure, RBTREE_DATA() works with either of them.)
+ */
+typedef struct RBTREE_SIZED_NODE {
+    RBTREE_NODE base;
+    size_t size;            /* count of nodes in the subtree */
+} RBTREE_SIZED_NODE;
+
+
 /* Tree structure. Treat as opaque.
  */
 typedef struct RBTREE {
     RBTREE_NODE* root;
+    unsigned flags;
 } RBTREE;
 
 
@@ -147,9 +162,9 @@ typedef int (*RBTREE_CMP_FUNC)(const RBTREE_NODE*, const RBTREE_NODE*);
 /* The tree has to be initialized before it is used by any other function.
  */
 RBTREE_INLINE__ void rbtree_init(RBTREE* tree)
-        { tree->root = NULL; }
+        { tree->root = NULL; tree->flags = 0; }
 
-#define RBTREE_INITIALIZER      { NULL }
+#define RBTREE_INITIALIZER      { NULL, 0 }
 
 
 /* Cleaning a (non-empty) tree can be a more complex operation. Usually, caller
@@ -281,6 +296,109 @@ RBTREE_NODE* rbtree_next(RBTREE_CURSOR* cur);
 RBTREE_NODE* rbtree_prev(RBTREE_CURSOR* cur);
 
 
+/* Insert a new node into the tree, using the cursor as a hint where the node
+ * belongs.
+ *
+ * If the node belongs right before or right after the node the cursor points
+ * to, the node is attached directly without descending from the root. This
+ * costs only one or two comparator calls. Otherwise (or if the cursor points
+ * to nowhere) it behaves as rbtree_insert().
+ *
+ * On success, the cursor is updated to point to the inserted node, so it can
+ * directly serve as a hint for the next insertion. This makes e.g. inserting
+ * a sorted sequence (with the cursor initialized by rbtree_tail()) much
+ * cheaper than repeated rbtree_insert().
+ *
+ * Returns 0 on success or -1 on failure (if an equal node is already present
+ * in the tree). In the latter case, the cursor points to the equal node.
+ */
+int rbtree_insert_hint(RBTREE* tree, RBTREE_NODE* node,
+                       RBTREE_CMP_FUNC cmp_func, RBTREE_CURSOR* cur);
+
+
+/* Bulk operations.
+ *
+ * These functions rebuild the whole tree(s) into a perfectly balanced shape
+ * in O(n) time. Like all the other functions, they do not allocate any
+ * memory. When a lot of nodes is to be added or removed at once, they are
+ * much faster then calling rbtree_insert() or rbtree_remove() for each one
+ * of them.
+ *
+ * Any cursors into the involved trees become invalid.
+ */
+
+/* Build the tree from the nodes in the array. Any previous contents of the
+ * tree is lost (so the tree should usually be empty).
+ *
+ * The nodes have to be already sorted in the strictly increasing order (as
+ * defined by the comparator function which is to be used with the tree).
+ * This is not verified; if the condition is not met, the behavior is
+ * undefined.
+ */
+void rbtree_build_from_sorted(RBTREE* tree, RBTREE_NODE** nodes, size_t n);
+
+/* Move all nodes from the tree other into the tree.
+ *
+ * If some node of the other tree is equal to a node already present in the
+ * tree, it stays in the other tree.
+ *
+ * Returns 0 if all the nodes have been moved (so the other tree is empty),
+ * or -1 if some of them had to be left in the other tree.
+ */
+int rbtree_merge(RBTREE* tree, RBTREE* other, RBTREE_CMP_FUNC cmp_func);
+
+/* Split the tree: All nodes equal to or greater than the key are moved into
+ * the tree right. Any previous contents of the tree right is lost (so it
+ * should usually be empty).
+ */
+void rbtree_split(RBTREE* tree, const RBTREE_NODE* key,
+                  RBTREE_CMP_FUNC cmp_func, RBTREE* right);
+
+
+/* Order statistics.
+ *
+ * A tree initialized with rbtree_init_sized() (or RBTREE_SIZED_INITIALIZER)
+ * additionally maintains count of nodes in every subtree. All its nodes have
+ * to be RBTREE_SIZED_NODE. This costs one more member in every node and
+ * some small overhead in all the operations modifying the tree but, in
+ * exchange, it allows to get the n-th node or the position of a node in
+ * O(log n) time. (For example, a virtualized view over a sorted data can
+ * directly scroll to its k-th row without iterating over all the rows before
+ * it.)
+ *
+ * The functions below may be used only with such trees. rbtree_merge() may
+ * only be used with two trees of the same kind.
+ */
+#define RBTREE_FLAG_SIZED       0x0001
+
+RBTREE_INLINE__ void rbtree_init_sized(RBTREE* tree)
+        { tree->root = NULL; tree->flags = RBTREE_FLAG_SIZED; }
+
+#define RBTREE_SIZED_INITIALIZER    { NULL, RBTREE_FLAG_SIZED }
+
+/* Get count of all nodes in the tree.
+ */
+RBTREE_INLINE__ size_t rbtree_size(const RBTREE* tree)
+        { return (tree->root != NULL) ? ((RBTREE_SIZED_NODE*) tree->root)->size : 0; }
+
+/* Get the k-th node (zero-based) in the tree order, or NULL if k is out of
+ * range. The _ex() variant also initializes the cursor to the node (or resets
+ * it if there is no such node).
+ */
+RBTREE_NODE* rbtree_select(RBTREE* tree, size_t k);
+RBTREE_NODE* rbtree_select_ex(RBTREE* tree, size_t k, RBTREE_CURSOR* cur);
+
+/* Get count of nodes lower then the key. If a node equal to the key is in the
+ * tree, this is its zero-based position in the tree order.
+ */
+size_t rbtree_rank(RBTREE* tree, const RBTREE_NODE* key, RBTREE_CMP_FUNC cmp_func);
+
+/* Get the zero-based position of the node the cursor points to. No comparator
+ * calls are needed. The cursor must point to some node.
+ */
+size_t rbtree_current_rank(RBTREE_CURSOR* cur);
+
+
 #ifdef __cplusplus
 }
 #endif
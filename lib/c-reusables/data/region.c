@@ -0,0 +1,1264 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2020 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "region.h"
+
+#include <assert.h>
+#include <string.h>
+
+
+#define MIN(a,b)        ((a) < (b) ? (a) : (b))
+#define MAX(a,b)        ((a) > (b) ? (a) : (b))
+#define MAX3(a,b,c)     MAX(MAX((a), (b)), (c))
+
+
+/****************************************************************
+ ***  Combining of REGION_RECT vectors into complex region  ***
+ *****************************************************************/
+
+/* Whole this section is about construction of a new complex region.
+ *
+ * The complex regions are regions which cannot be easily described by
+ * a single rect. To work with them in some effective way, we place the
+ * following limitations to their representations:
+ *
+ * (1) We manage an "extents" rect for the region, stored within
+ *     REGION_COMPLEX::vec[0].
+ * (2) The region consists of a set of rects (all other members of the array
+ *     REGION_COMPLEX::vec), which are organized as follows:
+ *   (2.1) The rects of the region do not overlap each other.
+ *   (2.2) The rects are stored in an  array, ordered primarily by their y0.
+ *   (2.3) Rects with the same y0 share also the same y1. (When adding a
+ *         rectangle, it may be split to smaller ones which do follow this
+ *         rule, or rects already within the region may need to be split.)
+ *   (2.4) Within a subset ("band") of rects sharing y0 (and y1), the rects
+ *         are ordered by their x0.
+ *   (2.5) Rects in a band do not overlap each other. (They even do not touch
+ *         each other, or they would be coalesced as per rule 2.6.)
+ *   (2.6) Minimal set of such rects is used, i.e. when possible, the touching
+ *         rects in a band or even whole bands are coalesced together to form
+ *         larger rects and bands respectively.
+ */
+
+
+/* Try to coalesce two bands into one. Note that this is called only after
+ * the cur_band is the last band in the complex region being constructed.
+ */
+static uint32_t
+region_coalesce_bands(REGION_COMPLEX* c, uint32_t prev_band, uint32_t cur_band)
+{
+    REGION_RECT* prev_vec;
+    REGION_RECT* cur_vec;
+    uint32_t i, n;
+    uint32_t y1;
+
+    assert(cur_band > prev_band);
+    n = cur_band - prev_band;
+
+    /* Only bands of the same size can be coalesced. */
+    if(n != c->n - cur_band)
+        return cur_band;
+
+    prev_vec = c->vec + prev_band;
+    cur_vec = c->vec + cur_band;
+
+    /* Only bands touching each other vertically can be coalesced. */
+    if(prev_vec[0].y1 != cur_vec[0].y0)
+        return cur_band;
+
+    /* Only bands with the same horizontal layout can be coalesced. */
+    for(i = 0; i < n; i++) {
+        if(prev_vec[i].x0 != cur_vec[i].x0  ||  prev_vec[i].x1 != cur_vec[i].x1)
+            return cur_band;
+    }
+
+    /* Do the coalesce. */
+    y1 = cur_vec[0].y1;
+    for(i = 0; i < n; i++)
+        prev_vec[i].y1 = y1;
+
+    /* Strip the coalesced band away. */
+    c->n -= n;
+    return prev_band;
+}
+
+
+/* Callback prototypes for region_combine() below.
+ */
+typedef int (*region_overlap_func)(REGION_COMPLEX* /*c*/,
+                const REGION_RECT* /*vec1*/, const REGION_RECT* /*vec1_end*/,
+                const REGION_RECT* /*vec2*/, const REGION_RECT* /*vec2_end*/,
+                uint32_t /*y0*/, uint32_t /*y1*/);
+
+typedef int (*region_nonoverlap_func)(REGION_COMPLEX* /*c*/,
+                const REGION_RECT* /*vec*/, const REGION_RECT* /*vec_end*/,
+                uint32_t /*y0*/, uint32_t /*y1*/);
+
+/* This function is the heart of the combining of two sets of rects together
+ * when constructing a new complex region from them.
+ *
+ * Notes:
+ *  -- On input, 'c' is assumed to be completely uninitialized.
+ *  -- The function computes and fills its contents (on success), but with
+ *     exception of extents (c->vec[0]) as caller usually can do so
+ *     in a more effective way.
+ *  -- Both input rect vectors, 'vec1' and 'vec2', have to follow constrains
+ *     for complex regions about their organization and ordering.
+ */
+static int
+region_combine(REGION_COMPLEX* c,
+               const REGION_RECT* vec1, uint32_t n1,
+               const REGION_RECT* vec2, uint32_t n2,
+               region_overlap_func func_overlap,
+               region_nonoverlap_func func_nonoverlap1,
+               region_nonoverlap_func func_nonoverlap2)
+{
+    const REGION_RECT* rc1 = vec1;
+    const REGION_RECT* rc1_end = vec1 + n1;
+    const REGION_RECT* rc1_band_end;
+    const REGION_RECT* rc2 = vec2;
+    const REGION_RECT* rc2_end = vec2 + n2;
+    const REGION_RECT* rc2_band_end;
+    uint32_t y0, y1;     /* top and bottom of intersection */
+    uint32_t prev_band;  /* last complete band */
+    uint32_t cur_band;   /* current band (for coalescing into prev_band) */
+    int err;
+
+    assert(n1 > 0  &&  n2 > 0);
+
+    c->n = 1; /* Reserve space for extents */
+    c->alloc = MAX3(8, 2 * n1, 2 * n2);
+    c->vec = (REGION_RECT*) malloc(c->alloc * sizeof(REGION_RECT));
+    if(c->vec == NULL) {
+        return -1;
+    }
+
+    y1 = 0;
+    prev_band = c->n;
+
+    rc1_band_end = rc1;
+    rc2_band_end = rc2;
+
+    do {
+        cur_band = c->n;
+        y0 = MAX(y1, MIN(rc1->y0, rc2->y0));
+
+        /* We need to know ends of current bands (i.e. of the sequences of
+         * rects with same y0 and y1). */
+        if(rc1_band_end == rc1) {
+            while(rc1_band_end != rc1_end  &&  rc1_band_end->y0 == rc1->y0)
+                rc1_band_end++;
+        }
+        if(rc2_band_end == rc2) {
+            while(rc2_band_end != rc2_end  &&  rc2_band_end->y0 == rc2->y0)
+                rc2_band_end++;
+        }
+
+        /* Handle a band which does not intersect with the other vector. */
+        if(rc2->y0 > y0) {
+            y1 = MIN(rc1->y1, rc2->y0);
+            if(func_nonoverlap1 != NULL) {
+                err = func_nonoverlap1(c, rc1, rc1_band_end, y0, y1);
+                if(err != 0)
+                    goto err_callback;
+            }
+            if(y1 == rc1->y1)
+                rc1 = rc1_band_end;
+            if(c->n != cur_band  &&  cur_band > prev_band)
+                prev_band = region_coalesce_bands(c, prev_band, cur_band);
+            continue;
+        }
+        if(rc1->y0 > y0) {
+            y1 = MIN(rc2->y1, rc1->y0);
+            if(func_nonoverlap2 != NULL) {
+                err = func_nonoverlap2(c, rc2, rc2_band_end, y0, y1);
+                if(err != 0)
+                    goto err_callback;
+            }
+            if(y1 == rc2->y1)
+                rc2 = rc2_band_end;
+            if(c->n != cur_band  &&  cur_band > prev_band)
+                prev_band = region_coalesce_bands(c, prev_band, cur_band);
+            continue;
+        }
+
+        /* Handle bands from both vectors which intersect each other. */
+        y1 = MIN(rc1->y1, rc2->y1);
+        cur_band = c->n;
+        if(func_overlap != NULL) {
+            err = func_overlap(c, rc1, rc1_band_end, rc2, rc2_band_end, y0, y1);
+            if(err != 0)
+                goto err_callback;
+        }
+
+        /* If we added a new band, we may need to coalesce it with the previous
+         * band. */
+        if(c->n != cur_band  &&  cur_band > prev_band)
+            prev_band = region_coalesce_bands(c, prev_band, cur_band);
+
+        /* Do a new band(s) if we are done with it. */
+        if(y1 == rc1->y1)
+            rc1 = rc1_band_end;
+        if(y1 == rc2->y1)
+            rc2 = rc2_band_end;
+        y0 = y1;
+    } while(rc1 != rc1_end  &&  rc2 != rc2_end);
+
+    /* All what can be left are non-overlapping bands in one of the two
+     * rect vectors. Note only 1st band of this remainder may need the
+     * coalescing. */
+    cur_band = c->n;
+    if(rc1 != rc1_end  &&  func_nonoverlap1 != NULL) {
+        int coalesce = 1;
+        do {
+            y0 = MAX(y1, rc1->y0);
+            y1 = rc1->y1;
+
+            while(rc1_band_end != rc1_end  &&  rc1_band_end->y0 == rc1->y0)
+                rc1_band_end++;
+
+            err = func_nonoverlap1(c, rc1, rc1_band_end, y0, rc1->y1);
+            if(err != 0)
+                goto err_callback;
+
+            if(coalesce) {
+                if(c->n != cur_band  &&  cur_band > prev_band)
+                    prev_band = region_coalesce_bands(c, prev_band, cur_band);
+                coalesce = 0;
+            }
+
+            rc1 = rc1_band_end;
+        } while(rc1 != rc1_end);
+    } else if(rc2 != rc2_end  &&  func_nonoverlap2 != NULL) {
+        int coalesce = 1;
+        do {
+            y0 = MAX(y1, rc2->y0);
+            y1 = rc2->y1;
+
+            while(rc2_band_end != rc2_end  &&  rc2_band_end->y0 == rc2->y0)
+                rc2_band_end++;
+
+            err = func_nonoverlap2(c, rc2, rc2_band_end, y0, rc2->y1);
+            if(err != 0)
+                goto err_callback;
+
+            if(coalesce) {
+                if(c->n != cur_band  &&  cur_band > prev_band)
+                    prev_band = region_coalesce_bands(c, prev_band, cur_band);
+                coalesce = 0;
+            }
+
+            rc2 = rc2_band_end;
+        } while(rc2 != rc2_end);
+    }
+
+    /* Realloc if our allocation strategy was too generous. */
+    if(c->alloc > 8  &&  c->n < c->alloc / 2) {
+        REGION_RECT* vec;
+        uint32_t alloc = (c->n + 7) & ~0x7;
+
+        vec = (REGION_RECT*) realloc(c->vec, alloc * sizeof(REGION_RECT));
+        if(vec != NULL) {
+            c->alloc = alloc;
+            c->vec = vec;
+        }
+    }
+
+    return 0;
+
+err_callback:
+    if(c->vec != NULL)
+        free(c->vec);
+    return -1;
+}
+
+
+/* Helper for the callbacks below.
+ */
+static int
+region_append_rect(REGION_COMPLEX* c,
+                   uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1)
+{
+    if(c->n >= c->alloc) {
+        REGION_RECT* vec;
+        uint32_t alloc = c->alloc * 2;
+
+        vec = (REGION_RECT*) realloc(c->vec, alloc * sizeof(REGION_RECT));
+        if(vec == NULL)
+            return -1;
+
+        c->alloc = alloc;
+        c->vec = vec;
+    }
+
+    region_rect_set(c->vec + c->n, x0, y0, x1, y1);
+    c->n++;
+    return 0;
+}
+
+/* Helper macros for callbacks below.
+ */
+#define APPEND(x0_, x1_)                                                      \
+    do {                                                                      \
+        if(region_append_rect(c, (x0_), y0, (x1_), y1) != 0)                 \
+            goto err_append_rect;                                             \
+    } while(0)
+
+#define MERGE(x0_, x1_)                                                       \
+    do {                                                                      \
+        if(c->n > 1  &&                                                       \
+           c->vec[c->n - 1].y0 == y0  &&                                      \
+           (x0_) <= c->vec[c->n - 1].x1)                                      \
+        {                                                                     \
+            if((x1_) > c->vec[c->n - 1].x1)                                   \
+                c->vec[c->n - 1].x1 = (x1_);                                  \
+        } else {                                                              \
+            APPEND((x0_), (x1_));                                             \
+        }                                                                     \
+    } while(0)
+
+
+/* Combine callback for uniting two bands.
+ */
+static int
+region_combine_union_overlapped_bands(REGION_COMPLEX* c,
+                const REGION_RECT* vec1, const REGION_RECT* vec1_end,
+                const REGION_RECT* vec2, const REGION_RECT* vec2_end,
+                uint32_t y0, uint32_t y1)
+{
+    const REGION_RECT* rc1 = vec1;
+    const REGION_RECT* rc2 = vec2;
+    const REGION_RECT* rc;
+
+    /* Walk both bands ordered by x0 and merge each rect into the previous
+     * one if they overlap or touch. */
+    while(rc1 != vec1_end  ||  rc2 != vec2_end) {
+        if(rc2 == vec2_end  ||  (rc1 != vec1_end  &&  rc1->x0 <= rc2->x0))
+            rc = rc1++;
+        else
+            rc = rc2++;
+        MERGE(rc->x0, rc->x1);
+    }
+
+    return 0;
+
+err_append_rect:
+    return -1;
+}
+
+/* Combine callback for subtracting two bands.
+ */
+static int
+region_combine_subtract_overlapped_bands(REGION_COMPLEX* c,
+                const REGION_RECT* vec1, const REGION_RECT* vec1_end,
+                const REGION_RECT* vec2, const REGION_RECT* vec2_end,
+                uint32_t y0, uint32_t y1)
+{
+    const REGION_RECT* rc1 = vec1;
+    const REGION_RECT* rc2 = vec2;
+    uint32_t x0 = rc1->x0;
+
+    while(rc1 != vec1_end  &&  rc2 != vec2_end) {
+        if(rc2->x1 <= x0) {
+            /* Subtrahend completely precedes the minuend. */
+            rc2++;
+        } else if(rc1->x1 <= rc2->x0) {
+            /* Minuend completely precedes the subtrahend. */
+            APPEND(x0, rc1->x1);
+            rc1++;
+            if(rc1 != vec1_end)
+                x0 = rc1->x0;
+        } else if(x0 < rc2->x0) {
+            /* Minuend partially precedes the subtrahend. */
+            APPEND(x0, rc2->x0);
+            x0 = rc2->x0;
+        } else if(rc1->x1 <= rc2->x1) {
+            /* Minuend completely covered by the subtrahend. */
+            rc1++;
+            if(rc1 != vec1_end)
+                x0 = rc1->x0;
+        } else {
+            /* Minuend partially covered by the subtrahend. */
+            x0 = rc2->x1;
+            rc2++;
+        }
+    }
+
+    /* Finish the tail of the minuend vector. */
+    while(rc1 != vec1_end) {
+        APPEND(x0, rc1->x1);
+        rc1++;
+        if(rc1 != vec1_end)
+            x0 = rc1->x0;
+    }
+
+    return 0;
+
+err_append_rect:
+    return -1;
+}
+
+/* Combine callback for xor'ing two bands.
+ */
+static int
+region_combine_xor_overlapped_bands(REGION_COMPLEX* c,
+                const REGION_RECT* vec1, const REGION_RECT* vec1_end,
+                const REGION_RECT* vec2, const REGION_RECT* vec2_end,
+                uint32_t y0, uint32_t y1)
+{
+    const REGION_RECT* rc1 = vec1;
+    const REGION_RECT* rc2 = vec2;
+    uint32_t x0 = 0;
+
+    while(rc1 != vec1_end  &&  rc2 != vec2_end) {
+        x0 = MAX(x0, MIN(rc1->x0, rc2->x0));
+
+        if(rc2->x0 > x0) {
+            if(rc2->x0 >= rc1->x1) {
+                MERGE(x0, rc1->x1);
+                x0 = rc1->x1;
+                rc1++;
+            } else {
+                MERGE(x0, rc2->x0);
+                x0 = rc2->x0;
+            }
+        } else if(rc1->x0 > x0) {
+            if(rc1->x0 >= rc2->x1) {
+                MERGE(x0, rc2->x1);
+                x0 = rc2->x1;
+                rc2++;
+            } else {
+                MERGE(x0, rc1->x0);
+                x0 = rc1->x0;
+            }
+        } else {
+            if(rc1->x1 < rc2->x1) {
+                x0 = rc1->x1;
+                rc1++;
+            } else if(rc2->x1 < rc1->x1) {
+                x0 = rc2->x1;
+                rc2++;
+            } else {
+                x0 = rc1->x1;
+                rc1++;
+                rc2++;
+            }
+        }
+    }
+
+    /* Finish the tail of the remaining vector. */
+    if(rc1 != vec1_end) {
+        x0 = MAX(x0, rc1->x0);
+        MERGE(x0, rc1->x1);
+        rc1++;
+        while(rc1 != vec1_end) {
+            APPEND(rc1->x0, rc1->x1);
+            rc1++;
+        }
+    } else if(rc2 != vec2_end) {
+        x0 = MAX(x0, rc2->x0);
+        MERGE(x0, rc2->x1);
+        rc2++;
+        while(rc2 != vec2_end) {
+            APPEND(rc2->x0, rc2->x1);
+            rc2++;
+        }
+    }
+
+    return 0;
+
+err_append_rect:
+    return -1;
+}
+
+/* Combine callback for adding a whole (non-overlapped) band.
+ */
+static int
+region_combine_add_band(REGION_COMPLEX* c,
+                const REGION_RECT* vec, const REGION_RECT* vec_end,
+                uint32_t y0, uint32_t y1)
+{
+    const REGION_RECT* rc;
+
+    for(rc = vec; rc != vec_end; rc++)
+        APPEND(rc->x0, rc->x1);
+    return 0;
+
+err_append_rect:
+    return -1;
+}
+
+/* Wrapper of region_combine() to create a union from two rect sets.
+ */
+static int
+region_do_union(REGION_COMPLEX* c,
+                const REGION_RECT* vec1, uint32_t n1, const REGION_RECT* extents1,
+                const REGION_RECT* vec2, uint32_t n2, const REGION_RECT* extents2)
+{
+    int err;
+
+    err = region_combine(c, vec1, n1, vec2, n2,
+                         region_combine_union_overlapped_bands,
+                         region_combine_add_band,
+                         region_combine_add_band);
+    if(err != 0)
+        return -1;
+
+    /* Set new extents. */
+    c->vec[0].y0 = c->vec[1].y0;
+    c->vec[0].y1 = c->vec[c->n - 1].y1;
+    c->vec[0].x0 = MIN(extents1->x0, extents2->x0);
+    c->vec[0].x1 = MAX(extents1->x1, extents2->x1);
+
+    return 0;
+}
+
+/* Wrapper of region_combine() to create a subtraction from two rect sets.
+ */
+static int
+region_do_subtract(REGION_COMPLEX* c,
+                   const REGION_RECT* vec1, uint32_t n1, const REGION_RECT* extents1,
+                   const REGION_RECT* vec2, uint32_t n2, const REGION_RECT* extents2)
+{
+    int err;
+    uint32_t i;
+
+    err = region_combine(c, vec1, n1, vec2, n2,
+                         region_combine_subtract_overlapped_bands,
+                         region_combine_add_band,
+                         NULL);
+    if(err != 0)
+        return -1;
+
+    if(c->n < 2)
+        return 0;
+
+    /* Set new extents. Vertical extents are trivial. */
+    c->vec[0].y0 = c->vec[1].y0;
+    c->vec[0].y1 = c->vec[c->n - 1].y1;
+
+    if(extents1->x0 < extents2->x0  &&  extents2->x1 < extents1->x1) {
+        /* If the subtrahend does not touch the leftmost and rightmost parts
+         * of the minuend as the minuend, then result horizontal extents
+         * are not changed. */
+        c->vec[0].x0 = extents1->x0;
+        c->vec[0].x1 = extents1->x1;
+    } else {
+        /* Otherwise we have to inspect all rects within the resulted region. */
+        c->vec[0].x0 = c->vec[1].x0;
+        c->vec[0].x1 = c->vec[1].x1;
+        for(i = 2; i < c->n; i++) {
+            if(c->vec[i].x0 < c->vec[0].x0)
+                c->vec[0].x0 = c->vec[i].x0;
+
+            if(c->vec[i].x1 > c->vec[0].x1)
+                c->vec[0].x1 = c->vec[i].x1;
+        }
+    }
+
+    return 0;
+}
+
+/* Wrapper of region_combine() to create a xor from two rect sets.
+ */
+static int
+region_do_xor(REGION_COMPLEX* c,
+              const REGION_RECT* vec1, uint32_t n1, const REGION_RECT* extents1,
+              const REGION_RECT* vec2, uint32_t n2, const REGION_RECT* extents2)
+{
+    int err;
+
+    err = region_combine(c, vec1, n1, vec2, n2,
+                         region_combine_xor_overlapped_bands,
+                         region_combine_add_band,
+                         region_combine_add_band);
+    if(err != 0)
+        return -1;
+
+    /* Set new extents. */
+    c->vec[0].y0 = c->vec[1].y0;
+    c->vec[0].y1 = c->vec[c->n - 1].y1;
+    c->vec[0].x0 = MIN(extents1->x0, extents2->x0);
+    c->vec[0].x1 = MAX(extents1->x1, extents2->x1);
+
+    return 0;
+}
+
+
+/*********************************************
+ ***  Construction from many rectangles  ***
+ *********************************************/
+
+/* Instead of uniting the rects one by one (where each union walks all the
+ * bands constructed so far), we sort the top and bottom edges of all the
+ * rects once and sweep over them top to bottom. The sweep keeps the rects
+ * crossing the current band, ordered by x0, so each band is just a merge of
+ * their horizontal intervals.
+ */
+
+typedef struct REGION_EDGE {
+    uint32_t y;
+    uint32_t i;         /* Index of the rect. */
+    int is_top;
+} REGION_EDGE;
+
+static int
+region_edge_cmp(const void* a, const void* b)
+{
+    const REGION_EDGE* e1 = (const REGION_EDGE*) a;
+    const REGION_EDGE* e2 = (const REGION_EDGE*) b;
+
+    if(e1->y != e2->y)
+        return (e1->y < e2->y ? -1 : +1);
+    return 0;
+}
+
+/* Find position of the rect (or the position where to insert it) in the
+ * vector of active rects, which is ordered by x0 (and then by the index). */
+static uint32_t
+region_active_pos(const REGION_RECT* rects, const uint32_t* active, uint32_t n,
+                  uint32_t i)
+{
+    uint32_t lo = 0;
+    uint32_t hi = n;
+    uint32_t mid;
+
+    while(lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if(rects[active[mid]].x0 < rects[i].x0  ||
+           (rects[active[mid]].x0 == rects[i].x0  &&  active[mid] < i))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return lo;
+}
+
+static int
+region_sweep(REGION_COMPLEX* c, const REGION_RECT* rects, uint32_t n)
+{
+    REGION_EDGE* edges;
+    uint32_t* active;
+    uint32_t n_active = 0;
+    uint32_t k, pos;
+    uint32_t y0, y1, x0, x1;
+    uint32_t prev_band, cur_band;
+
+    edges = (REGION_EDGE*) malloc(2 * n * sizeof(REGION_EDGE));
+    active = (uint32_t*) malloc(n * sizeof(uint32_t));
+    c->n = 1; /* Reserve space for extents */
+    c->alloc = MAX(8, 2 * n);
+    c->vec = (REGION_RECT*) malloc(c->alloc * sizeof(REGION_RECT));
+    if(edges == NULL  ||  active == NULL  ||  c->vec == NULL)
+        goto err;
+
+    for(k = 0; k < n; k++) {
+        edges[2*k].y = rects[k].y0;
+        edges[2*k].i = k;
+        edges[2*k].is_top = 1;
+        edges[2*k+1].y = rects[k].y1;
+        edges[2*k+1].i = k;
+        edges[2*k+1].is_top = 0;
+    }
+    qsort(edges, 2 * n, sizeof(REGION_EDGE), region_edge_cmp);
+
+    prev_band = c->n;
+    k = 0;
+    while(k < 2 * n) {
+        /* Update the active rects with all the edges on the line y0. */
+        y0 = edges[k].y;
+        while(k < 2 * n  &&  edges[k].y == y0) {
+            pos = region_active_pos(rects, active, n_active, edges[k].i);
+            if(edges[k].is_top) {
+                memmove(active + pos + 1, active + pos, (n_active - pos) * sizeof(uint32_t));
+                active[pos] = edges[k].i;
+                n_active++;
+            } else {
+                memmove(active + pos, active + pos + 1, (n_active - pos - 1) * sizeof(uint32_t));
+                n_active--;
+            }
+            k++;
+        }
+
+        if(n_active == 0)
+            continue;
+
+        /* Emit the band [y0, y1), merging overlapping or touching rects. */
+        y1 = edges[k].y;    /* There is always a bottom edge left. */
+        cur_band = c->n;
+        x0 = rects[active[0]].x0;
+        x1 = rects[active[0]].x1;
+        for(pos = 1; pos < n_active; pos++) {
+            if(rects[active[pos]].x0 <= x1) {
+                x1 = MAX(x1, rects[active[pos]].x1);
+            } else {
+                if(region_append_rect(c, x0, y0, x1, y1) != 0)
+                    goto err;
+                x0 = rects[active[pos]].x0;
+                x1 = rects[active[pos]].x1;
+            }
+        }
+        if(region_append_rect(c, x0, y0, x1, y1) != 0)
+            goto err;
+
+        if(cur_band > prev_band)
+            prev_band = region_coalesce_bands(c, prev_band, cur_band);
+    }
+
+    free(edges);
+    free(active);
+    return 0;
+
+err:
+    free(edges);
+    free(active);
+    free(c->vec);
+    return -1;
+}
+
+
+/*****************
+ ***  Lookups  ***
+ *****************/
+
+/* Binary search for the first rect in vec[lo, hi) which does not precede the
+ * cell (x, y) in the row-major order. That is the only rect which may contain
+ * the cell.
+ *
+ * This works because the bands do not overlap vertically and the rects in a
+ * band do not overlap horizontally, so both y1 (over the whole vector) and x1
+ * (over a band) grow together with the position in the vector.
+ */
+static uint32_t
+region_lookup(const REGION_RECT* vec, uint32_t lo, uint32_t hi, uint32_t x, uint32_t y)
+{
+    uint32_t mid;
+
+    while(lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if(vec[mid].y1 <= y  ||  (vec[mid].y0 <= y  &&  vec[mid].x1 <= x))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return lo;
+}
+
+
+/**************************
+ ***  Global functions  ***
+ **************************/
+
+const REGION_RECT*
+region_extents(const REGION* rgn)
+{
+    if(rgn->n == 0)
+        return NULL;
+    else if(rgn->n == 1)
+        return &rgn->s.rc;
+    else
+        return &rgn->c.vec[0];
+}
+
+uint32_t
+region_rects(const REGION* rgn, const REGION_RECT** p_vec)
+{
+    switch(rgn->n) {
+        case 0:     *p_vec = NULL;              return 0;
+        case 1:     *p_vec = &rgn->s.rc;        return 1;
+        default:    *p_vec = &rgn->c.vec[1];    return rgn->n - 1;
+    }
+}
+
+int
+region_equals(const REGION* rgn1, const REGION* rgn2)
+{
+    const REGION_RECT* extents1;
+    const REGION_RECT* vec1;
+    uint32_t n1;
+    const REGION_RECT* extents2;
+    const REGION_RECT* vec2;
+    uint32_t n2;
+
+    switch(rgn1->n) {
+        case 0:     extents1 = NULL;            vec1 = NULL;            n1 = 0;           break;
+        case 1:     extents1 = &rgn1->s.rc;     vec1 = &rgn1->s.rc;     n1 = 1;           break;
+        default:    extents1 = &rgn1->c.vec[0]; vec1 = &rgn1->c.vec[1]; n1 = rgn1->n - 1; break;
+    }
+
+    switch(rgn2->n) {
+        case 0:     extents2 = NULL;            vec2 = NULL;            n2 = 0;           break;
+        case 1:     extents2 = &rgn2->s.rc;     vec2 = &rgn2->s.rc;     n2 = 1;           break;
+        default:    extents2 = &rgn2->c.vec[0]; vec2 = &rgn2->c.vec[1]; n2 = rgn2->n - 1; break;
+    }
+
+    if(n1 != n2)
+        return 0;
+
+    if(n1 == 0)
+        return 1;
+
+    if(n1 >= 2  &&  !region_rect_equals_rect(extents1, extents2))
+        return 0;
+
+    return (memcmp(vec1, vec2, n1 * sizeof(REGION_RECT)) == 0);
+}
+
+int
+region_contains_rect(const REGION* rgn, const REGION_RECT* rect)
+{
+    const REGION_RECT* vec;
+    uint32_t i;
+    uint32_t y;
+
+    /* Empty region */
+    if(rgn->n == 0)
+        return 0;
+
+    /* Simple region */
+    if(rgn->n == 1)
+        return region_rect_contains_rect(&rgn->s.rc, rect);
+
+    /* complex region */
+    if(!region_rect_contains_rect(&rgn->c.vec[0], rect))
+        return 0;
+
+    /* Each band the rect spans over has to have a single rect covering whole
+     * [x0, x1), and the bands have to follow each other without gaps. */
+    vec = rgn->c.vec;
+    y = rect->y0;
+    i = 1;
+    while(1) {
+        i = region_lookup(vec, i, rgn->n, rect->x0, y);
+        if(i >= rgn->n  ||  vec[i].y0 > y  ||
+           vec[i].x0 > rect->x0  ||  vec[i].x1 < rect->x1)
+            return 0;
+
+        y = vec[i].y1;
+        if(y >= rect->y1)
+            return 1;
+        i++;
+    }
+}
+
+static void
+region_cursor_seek(REGION_CURSOR* cur, uint32_t y)
+{
+    const REGION_RECT* vec = cur->rgn->c.vec;
+    uint32_t n = cur->n;
+    uint32_t i;
+
+    i = region_lookup(vec, 1, n, 0, y);
+    if(i >= n  ||  vec[i].y0 > y) {
+        /* The row is in a gap between the bands (or above or below all of
+         * them). Remember the gap, so other cells of it are quick too. */
+        cur->y0 = (i > 1 ? vec[i-1].y1 : 0);
+        cur->y1 = (i < n ? vec[i].y0 : UINT32_MAX);
+        cur->begin = i;
+        cur->end = i;
+    } else {
+        cur->y0 = vec[i].y0;
+        cur->y1 = vec[i].y1;
+        cur->begin = i;
+        cur->end = region_lookup(vec, i, n, UINT32_MAX, y);
+    }
+    cur->pos = i;
+}
+
+int
+region_cursor_contains_xy(REGION_CURSOR* cur, uint32_t x, uint32_t y)
+{
+    const REGION* rgn = cur->rgn;
+    const REGION_RECT* vec;
+    uint32_t i;
+
+    if(rgn->n <= 1) {
+        return (rgn->n == 1  &&  rgn->s.rc.x0 <= x  &&  x < rgn->s.rc.x1  &&
+                rgn->s.rc.y0 <= y  &&  y < rgn->s.rc.y1);
+    }
+
+    /* Be defensive if the app forgot to re-initialize the cursor. */
+    if(cur->n != rgn->n)
+        region_cursor_init(cur, rgn);
+
+    if(y < cur->y0  ||  y >= cur->y1)
+        region_cursor_seek(cur, y);
+    if(cur->begin == cur->end)
+        return 0;
+
+    /* Try the last found rect and its right neighbor first. */
+    vec = rgn->c.vec;
+    i = cur->pos;
+    if(x < vec[i].x0) {
+        if(i == cur->begin  ||  x >= vec[i-1].x1)
+            return 0;
+    } else if(x < vec[i].x1) {
+        return 1;
+    } else if(i+1 >= cur->end  ||  x < vec[i+1].x0) {
+        return 0;
+    } else if(x < vec[i+1].x1) {
+        cur->pos = i+1;
+        return 1;
+    }
+
+    i = region_lookup(vec, cur->begin, cur->end, x, y);
+    if(i >= cur->end) {
+        cur->pos = cur->end - 1;
+        return 0;
+    }
+    cur->pos = i;
+    return (vec[i].x0 <= x);
+}
+
+int
+region_copy(REGION* rgnR, const REGION* rgn1)
+{
+    memcpy(rgnR, rgn1, sizeof(REGION));
+
+    if(rgn1->n >= 2) {
+        rgnR->c.vec = (REGION_RECT*) malloc(rgn1->c.n * sizeof(REGION_RECT));
+        if(rgnR->c.vec == NULL)
+            return -1;
+
+        memcpy(rgnR->c.vec, rgn1->c.vec, rgn1->c.n * sizeof(REGION_RECT));
+    }
+
+    return 0;
+}
+
+int
+region_union(REGION* rgnR, const REGION* rgn1, const REGION* rgn2)
+{
+    const REGION_RECT* extents1;
+    const REGION_RECT* vec1;
+    uint32_t n1;
+    const REGION_RECT* extents2;
+    const REGION_RECT* vec2;
+    uint32_t n2;
+    int err;
+
+    switch(rgn1->n) {
+        case 0:     extents1 = NULL;            vec1 = NULL;            n1 = 0;           break;
+        case 1:     extents1 = &rgn1->s.rc;     vec1 = &rgn1->s.rc;     n1 = 1;           break;
+        default:    extents1 = &rgn1->c.vec[0]; vec1 = &rgn1->c.vec[1]; n1 = rgn1->n - 1; break;
+    }
+    switch(rgn2->n) {
+        case 0:     extents2 = NULL;            vec2 = NULL;            n2 = 0;           break;
+        case 1:     extents2 = &rgn2->s.rc;     vec2 = &rgn2->s.rc;     n2 = 1;           break;
+        default:    extents2 = &rgn2->c.vec[0]; vec2 = &rgn2->c.vec[1]; n2 = rgn2->n - 1; break;
+    }
+
+    /* Simple cases */
+    if(n1 == 0)
+        return region_copy(rgnR, rgn2);
+
+    if(n2 == 0)
+        return region_copy(rgnR, rgn1);
+
+    if(n1 == 1  &&  region_rect_contains_rect(extents1, extents2))
+        return region_copy(rgnR, rgn1);
+
+    if(n2 == 1  &&  region_rect_contains_rect(extents2, extents1))
+        return region_copy(rgnR, rgn2);
+
+    if(n1 == 1  &&  n2 == 1) {
+        if(extents1->x0 == extents2->x0  &&  extents1->x1 == extents2->x1  &&
+           extents1->y1 >= extents2->y0  &&  extents1->y0 <= extents2->y1)
+        {
+            rgnR->s.n = 1;
+            rgnR->s.rc.x0 = extents1->x0;
+            rgnR->s.rc.y0 = MIN(extents1->y0, extents2->y0);
+            rgnR->s.rc.x1 = extents1->x1;
+            rgnR->s.rc.y1 = MAX(extents1->y1, extents2->y1);
+            return 0;
+        }
+
+        if(extents1->y0 == extents2->y0  &&  extents1->y1 == extents2->y1  &&
+           extents1->x1 >= extents2->x0  &&  extents1->x0 <= extents2->x1)
+        {
+            rgnR->s.n = 1;
+            rgnR->s.rc.x0 = MIN(extents1->x0, extents2->x0);
+            rgnR->s.rc.y0 = extents1->y0;
+            rgnR->s.rc.x1 = MAX(extents1->x1, extents2->x1);
+            rgnR->s.rc.y1 = extents1->y1;
+            return 0;
+        }
+    }
+
+    /* General case */
+    err = region_do_union(&rgnR->c, vec1, n1, extents1, vec2, n2, extents2);
+    if(err != 0)
+        return -1;
+
+    return 0;
+}
+
+int
+region_subtract(REGION* rgnR, const REGION* rgn1, const REGION* rgn2)
+{
+    const REGION_RECT* extents1;
+    const REGION_RECT* vec1;
+    uint32_t n1;
+    const REGION_RECT* extents2;
+    const REGION_RECT* vec2;
+    uint32_t n2;
+    int err;
+
+    switch(rgn1->n) {
+        case 0:     extents1 = NULL;            vec1 = NULL;            n1 = 0;           break;
+        case 1:     extents1 = &rgn1->s.rc;     vec1 = &rgn1->s.rc;     n1 = 1;           break;
+        default:    extents1 = &rgn1->c.vec[0]; vec1 = &rgn1->c.vec[1]; n1 = rgn1->n - 1; break;
+    }
+    switch(rgn2->n) {
+        case 0:     extents2 = NULL;            vec2 = NULL;            n2 = 0;           break;
+        case 1:     extents2 = &rgn2->s.rc;     vec2 = &rgn2->s.rc;     n2 = 1;           break;
+        default:    extents2 = &rgn2->c.vec[0]; vec2 = &rgn2->c.vec[1]; n2 = rgn2->n - 1; break;
+    }
+
+    /* Simple cases */
+    if(n1 == 0  ||  n2 == 0)
+        return region_copy(rgnR, rgn1);
+
+    if(!region_rect_overlaps_rect(extents1, extents2))
+        return region_copy(rgnR, rgn1);
+
+    if(n1 == 1  &&  n2 == 1  &&  region_rect_contains_rect(extents2, extents1)) {
+        rgnR->n = 0;
+        return 0;
+    }
+
+    /* General case */
+    err = region_do_subtract(&rgnR->c, vec1, n1, extents1, vec2, n2, extents2);
+    if(err != 0)
+        return -1;
+
+    if(rgnR->c.n == 1) {
+        /* Nothing but extents? The subtraction ate out whole minuend. */
+        free(rgnR->c.vec);
+        rgnR->n = 0;
+    }
+
+    return 0;
+}
+
+int
+region_xor(REGION* rgnR, const REGION* rgn1, const REGION* rgn2)
+{
+    const REGION_RECT* extents1;
+    const REGION_RECT* vec1;
+    uint32_t n1;
+    const REGION_RECT* extents2;
+    const REGION_RECT* vec2;
+    uint32_t n2;
+    int err;
+
+    switch(rgn1->n) {
+        case 0:     extents1 = NULL;            vec1 = NULL;            n1 = 0;           break;
+        case 1:     extents1 = &rgn1->s.rc;     vec1 = &rgn1->s.rc;     n1 = 1;           break;
+        default:    extents1 = &rgn1->c.vec[0]; vec1 = &rgn1->c.vec[1]; n1 = rgn1->n - 1; break;
+    }
+    switch(rgn2->n) {
+        case 0:     extents2 = NULL;            vec2 = NULL;            n2 = 0;           break;
+        case 1:     extents2 = &rgn2->s.rc;     vec2 = &rgn2->s.rc;     n2 = 1;           break;
+        default:    extents2 = &rgn2->c.vec[0]; vec2 = &rgn2->c.vec[1]; n2 = rgn2->n - 1; break;
+    }
+
+    /* Simple cases */
+    if(n1 == 0)
+        return region_copy(rgnR, rgn2);
+
+    if(n2 == 0)
+        return region_copy(rgnR, rgn1);
+
+    if(region_equals(rgn1, rgn2)) {
+        rgnR->n = 0;
+        return 0;
+    }
+
+    /* General case */
+    err = region_do_xor(&rgnR->c, vec1, n1, extents1, vec2, n2, extents2);
+    if(err != 0)
+        return -1;
+
+    return 0;
+}
+
+int
+region_init_with_rects(REGION* rgn, const REGION_RECT* rects, uint32_t n)
+{
+    REGION_RECT* vec = NULL;
+    REGION_RECT extents;
+    uint32_t i, m;
+
+    /* Skip empty rects. (Copy the rest only when there are any.) */
+    for(i = 0, m = 0; i < n; i++) {
+        if(rects[i].x0 >= rects[i].x1  ||  rects[i].y0 >= rects[i].y1) {
+            if(vec == NULL) {
+                vec = (REGION_RECT*) malloc(n * sizeof(REGION_RECT));
+                if(vec == NULL)
+                    return -1;
+                memcpy(vec, rects, i * sizeof(REGION_RECT));
+            }
+            continue;
+        }
+        if(vec != NULL)
+            vec[m] = rects[i];
+        m++;
+    }
+    if(vec != NULL)
+        rects = vec;
+
+    /* Simple cases */
+    if(m <= 1) {
+        if(m == 0)
+            region_init(rgn);
+        else
+            region_init_with_rect(rgn, &rects[0]);
+        free(vec);
+        return 0;
+    }
+
+    /* General case */
+    if(region_sweep(&rgn->c, rects, m) != 0) {
+        free(vec);
+        return -1;
+    }
+
+    extents = rects[0];
+    for(i = 1; i < m; i++) {
+        extents.x0 = MIN(extents.x0, rects[i].x0);
+        extents.x1 = MAX(extents.x1, rects[i].x1);
+    }
+    extents.y0 = rgn->c.vec[1].y0;
+    extents.y1 = rgn->c.vec[rgn->c.n - 1].y1;
+    rgn->c.vec[0] = extents;
+    free(vec);
+
+    if(rgn->c.n == 2) {
+        /* All the rects have coalesced into a single one. */
+        free(rgn->c.vec);
+        region_init_with_rect(rgn, &extents);
+    }
+
+    return 0;
+}
+
+
+/* Append the rect below all the bands of the complex region, in place. */
+static int
+region_append_band(REGION* rgn, const REGION_RECT* rect)
+{
+    REGION_COMPLEX* c = &rgn->c;
+    uint32_t last_band;
+
+    last_band = c->n - 1;
+    while(last_band > 1  &&  c->vec[last_band - 1].y0 == c->vec[c->n - 1].y0)
+        last_band--;
+
+    if(region_append_rect(c, rect->x0, rect->y0, rect->x1, rect->y1) != 0)
+        return -1;
+    region_coalesce_bands(c, last_band, c->n - 1);
+
+    c->vec[0].x0 = MIN(c->vec[0].x0, rect->x0);
+    c->vec[0].x1 = MAX(c->vec[0].x1, rect->x1);
+    c->vec[0].y1 = rect->y1;
+    return 0;
+}
+
+/* Apply the operation to the region and the rect (as to a simple region),
+ * and replace the region with the result. */
+static int
+region_apply_rect(REGION* rgn, const REGION_RECT* rect,
+                  int (*op)(REGION*, const REGION*, const REGION*))
+{
+    REGION rc_rgn;
+    REGION tmp;
+
+    region_init_with_rect(&rc_rgn, rect);
+    if(op(&tmp, rgn, &rc_rgn) != 0)
+        return -1;
+
+    region_fini(rgn);
+    memcpy(rgn, &tmp, sizeof(REGION));
+    return 0;
+}
+
+int
+region_union_rect(REGION* rgn, const REGION_RECT* rect)
+{
+    const REGION_RECT* extents = region_extents(rgn);
+
+    if(rect->x0 >= rect->x1  ||  rect->y0 >= rect->y1)
+        return 0;
+
+    if(extents == NULL  ||  region_rect_contains_rect(rect, extents)) {
+        region_clear(rgn);
+        region_init_with_rect(rgn, rect);
+        return 0;
+    }
+
+    if(region_contains_rect(rgn, rect))
+        return 0;
+
+    /* Fast path: A band below all the others (e.g. when selecting rows top
+     * to bottom). */
+    if(rgn->n >= 2  &&  rect->y0 >= extents->y1)
+        return region_append_band(rgn, rect);
+
+    return region_apply_rect(rgn, rect, region_union);
+}
+
+int
+region_subtract_rect(REGION* rgn, const REGION_RECT* rect)
+{
+    const REGION_RECT* extents = region_extents(rgn);
+
+    if(extents == NULL  ||  !region_rect_overlaps_rect(extents, rect))
+        return 0;
+
+    if(region_rect_contains_rect(rect, extents)) {
+        region_clear(rgn);
+        return 0;
+    }
+
+    return region_apply_rect(rgn, rect, region_subtract);
+}
+
+int
+region_xor_rect(REGION* rgn, const REGION_RECT* rect)
+{
+    const REGION_RECT* extents = region_extents(rgn);
+
+    if(rect->x0 >= rect->x1  ||  rect->y0 >= rect->y1)
+        return 0;
+
+    /* Xor of disjoint sets is their union. */
+    if(extents == NULL  ||  !region_rect_overlaps_rect(extents, rect))
+        return region_union_rect(rgn, rect);
+
+    return region_apply_rect(rgn, rect, region_xor);
+}
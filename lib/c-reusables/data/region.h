@@ -0,0 +1,208 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2020 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef CRE_REGION_H
+#define CRE_REGION_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#if defined __cplusplus
+    #define REGION_INLINE__     inline
+#elif defined __STDC_VERSION__ && __STDC_VERSION__ >= 199901L
+    #define REGION_INLINE__     static inline
+#elif defined __GNUC__
+    #define REGION_INLINE__     static __inline__
+#elif defined _MSC_VER
+    #define REGION_INLINE__     static __inline
+#else
+    #define REGION_INLINE__     static
+#endif
+
+
+/* Region is a set of cells of a 2D grid with 32-bit coordinates, e.g. a set
+ * of selected cells in a table. It is represented as a minimal set of
+ * non-overlapping rectangles organized into horizontal bands (similar to
+ * regions of windowing systems), so even huge but regular selections (e.g.
+ * all rows or a few whole columns of a table with millions of rows) are cheap
+ * to store and manipulate.
+ *
+ * All rectangles are half-open: They include x0 and y0 but not x1 and y1.
+ */
+typedef struct REGION_RECT {
+    uint32_t x0;
+    uint32_t y0;
+    uint32_t x1;
+    uint32_t y1;
+} REGION_RECT;
+
+typedef struct REGION_SIMPLE {
+    uint32_t n;
+    REGION_RECT rc;
+} REGION_SIMPLE;
+
+typedef struct REGION_COMPLEX {
+    uint32_t n;
+    uint32_t alloc;
+    REGION_RECT* vec;       /* vec[0] is special: It holds extents. */
+} REGION_COMPLEX;
+
+typedef union REGION {
+    uint32_t n;             /* Region is empty when n == 0 */
+    REGION_SIMPLE s;        /* Used when n == 1 */
+    REGION_COMPLEX c;       /* Used when n >= 2 */
+} REGION;
+
+/* Note that one-rect region can be expressed in two ways:
+ * (1) simple region (n == 1).
+ * (2) complex region with extents and one rect, i.e. two same rects (n == 2).
+ */
+
+
+/* Helpers for the rectangles. */
+REGION_INLINE__ int
+region_rect_equals_rect(const REGION_RECT* a, const REGION_RECT* b)
+{
+    return (a->x0 == b->x0  &&  a->y0 == b->y0  &&
+            a->x1 == b->x1  &&  a->y1 == b->y1);
+}
+
+REGION_INLINE__ int
+region_rect_contains_rect(const REGION_RECT* a, const REGION_RECT* b)
+{
+    return (a->x0 <= b->x0  &&  b->x1 <= a->x1  &&
+            a->y0 <= b->y0  &&  b->y1 <= a->y1);
+}
+
+REGION_INLINE__ int
+region_rect_overlaps_rect(const REGION_RECT* a, const REGION_RECT* b)
+{
+    return (a->x1 > b->x0  &&  a->x0 < b->x1  &&
+            a->y1 > b->y0  &&  a->y0 < b->y1);
+}
+
+REGION_INLINE__ void
+region_rect_set(REGION_RECT* a, uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1)
+{
+    a->x0 = x0;  a->y0 = y0;
+    a->x1 = x1;  a->y1 = y1;
+}
+
+
+/* Initialize the region as empty, or as a single rectangle or cell. */
+REGION_INLINE__ void region_init(REGION* rgn)
+        { rgn->n = 0; }
+REGION_INLINE__ void region_init_with_rect(REGION* rgn, const REGION_RECT* rect)
+        { rgn->s.n = 1; rgn->s.rc = *rect; }
+REGION_INLINE__ void region_init_with_xy(REGION* rgn, uint32_t x, uint32_t y)
+        { rgn->s.n = 1; region_rect_set(&rgn->s.rc, x, y, x+1, y+1); }
+
+/* Release any resources held by the region. region_clear() then makes the
+ * region empty. */
+REGION_INLINE__ void region_fini(REGION* rgn)
+        { if(rgn->n > 1) free(rgn->c.vec); }
+REGION_INLINE__ void region_clear(REGION* rgn)
+        { if(rgn->n > 1) free(rgn->c.vec); rgn->n = 0; }
+
+REGION_INLINE__ int region_is_empty(const REGION* rgn)
+        { return (rgn->n == 0); }
+
+/* Get the bounding rectangle of the region, or NULL if the region is empty. */
+const REGION_RECT* region_extents(const REGION* rgn);
+
+/* Get the rectangles forming the region, ordered by y0, then by x0.
+ * Returns their count, or zero for an empty region. */
+uint32_t region_rects(const REGION* rgn, const REGION_RECT** p_vec);
+
+/* Test whether two regions cover the same cells. */
+int region_equals(const REGION* rgn1, const REGION* rgn2);
+
+/* Test whether the region covers whole rectangle or a cell. */
+int region_contains_rect(const REGION* rgn, const REGION_RECT* rect);
+REGION_INLINE__ int region_contains_xy(const REGION* rgn, uint32_t x, uint32_t y)
+        { REGION_RECT r = { x, y, x+1, y+1 }; return region_contains_rect(rgn, &r); }
+
+/* Cursor for many region_contains_xy()-like tests done in the row-major order
+ * (e.g. when painting a grid cell by cell). It remembers the band of the last
+ * tested row and the last found rect in it, so moving to the next cell in the
+ * row is O(1) and moving to another row is O(log n).
+ *
+ * Re-initialize the cursor whenever the region changes.
+ */
+typedef struct REGION_CURSOR {
+    const REGION* rgn;
+    uint32_t n;
+    uint32_t y0;        /* Rows of the cached band (or of a gap between bands). */
+    uint32_t y1;
+    uint32_t begin;     /* Rects of the cached band. */
+    uint32_t end;
+    uint32_t pos;       /* The last found rect. */
+} REGION_CURSOR;
+
+REGION_INLINE__ void region_cursor_init(REGION_CURSOR* cur, const REGION* rgn)
+        { cur->rgn = rgn; cur->n = rgn->n; cur->y0 = 1; cur->y1 = 0; }
+
+int region_cursor_contains_xy(REGION_CURSOR* cur, uint32_t x, uint32_t y);
+
+/* Initialize rgnR as a copy of rgn1, or as a set operation of rgn1 and rgn2.
+ * rgnR must not be initialized on input; on success it has to be released
+ * with region_fini() eventually. All functions return 0 on success, or -1 on
+ * an allocation failure (rgnR is then left uninitialized).
+ */
+int region_copy(REGION* rgnR, const REGION* rgn1);
+int region_union(REGION* rgnR, const REGION* rgn1, const REGION* rgn2);
+int region_subtract(REGION* rgnR, const REGION* rgn1, const REGION* rgn2);
+int region_xor(REGION* rgnR, const REGION* rgn1, const REGION* rgn2);
+
+/* Initialize the region as a union of n rectangles (in any order, possibly
+ * overlapping, empty ones are ignored). This is much faster than uniting them
+ * one by one: The rects are sorted once and swept top to bottom once.
+ * Returns 0 on success, or -1 on an allocation failure (rgn is then left
+ * uninitialized).
+ */
+int region_init_with_rects(REGION* rgn, const REGION_RECT* rects, uint32_t n);
+
+/* In-place variants of the set operations with a rectangle: They replace the
+ * region with the result. They avoid any allocation when the region does not
+ * change (e.g. uniting a rect already covered by the region), and a rect
+ * united (or xor'ed) below all the existing bands is appended to the vector
+ * in place (reusing its capacity). Returns 0 on success, or -1 on an
+ * allocation failure (rgn is then left unchanged).
+ */
+int region_union_rect(REGION* rgn, const REGION_RECT* rect);
+int region_subtract_rect(REGION* rgn, const REGION_RECT* rect);
+int region_xor_rect(REGION* rgn, const REGION_RECT* rect);
+
+
+#ifdef __cplusplus
+}  /* extern "C" { */
+#endif
+
+#endif  /* CRE_REGION_H */
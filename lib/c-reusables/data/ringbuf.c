@@ -0,0 +1,437 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2020 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "ringbuf.h"
+
+#include <string.h>
+
+
+#define MIN_CAPACITY    16
+
+#define SLOT(rb, pos)   ((uint8_t*) (rb)->data + ((pos) & (rb)->mask) * (rb)->elem_size)
+
+
+/***********************
+ ***   Ring buffer   ***
+ ***********************/
+
+static size_t
+ringbuf_round_capacity(size_t n)
+{
+    size_t capacity = MIN_CAPACITY;
+
+    while(capacity < n)
+        capacity *= 2;
+    return capacity;
+}
+
+int
+ringbuf_reserve(RINGBUF* rb, size_t n)
+{
+    size_t count = ringbuf_count(rb);
+    size_t capacity;
+    size_t start, n1;
+    void* data;
+
+    if(count + n <= rb->capacity)
+        return 0;
+
+    capacity = ringbuf_round_capacity(count + n);
+    if(capacity < 2 * rb->capacity)
+        capacity = 2 * rb->capacity;
+
+    data = malloc(capacity * rb->elem_size);
+    if(data == NULL)
+        return -1;
+
+    /* Copy the contents (which may wrap around) to the beginning of the new
+     * memory block. */
+    if(count > 0) {
+        start = rb->head & (rb->capacity - 1);
+        n1 = rb->capacity - start;
+        if(n1 > count)
+            n1 = count;
+        memcpy(data, (uint8_t*) rb->data + start * rb->elem_size, n1 * rb->elem_size);
+        memcpy((uint8_t*) data + n1 * rb->elem_size, rb->data, (count - n1) * rb->elem_size);
+    }
+
+    free(rb->data);
+    rb->data = data;
+    rb->capacity = capacity;
+    rb->head = 0;
+    rb->tail = count;
+    return 0;
+}
+
+void*
+ringbuf_push_back_raw(RINGBUF* rb)
+{
+    if(ringbuf_reserve(rb, 1) != 0)
+        return NULL;
+
+    rb->tail++;
+    return ringbuf_at(rb, ringbuf_count(rb) - 1);
+}
+
+void*
+ringbuf_push_front_raw(RINGBUF* rb)
+{
+    if(ringbuf_reserve(rb, 1) != 0)
+        return NULL;
+
+    rb->head--;
+    return ringbuf_at(rb, 0);
+}
+
+int
+ringbuf_push_back(RINGBUF* rb, const void* elem)
+{
+    void* ptr;
+
+    ptr = ringbuf_push_back_raw(rb);
+    if(ptr == NULL)
+        return -1;
+
+    memcpy(ptr, elem, rb->elem_size);
+    return 0;
+}
+
+int
+ringbuf_push_front(RINGBUF* rb, const void* elem)
+{
+    void* ptr;
+
+    ptr = ringbuf_push_front_raw(rb);
+    if(ptr == NULL)
+        return -1;
+
+    memcpy(ptr, elem, rb->elem_size);
+    return 0;
+}
+
+int
+ringbuf_pop_front(RINGBUF* rb, void* elem)
+{
+    if(ringbuf_is_empty(rb))
+        return -1;
+
+    if(elem != NULL)
+        memcpy(elem, ringbuf_at(rb, 0), rb->elem_size);
+    rb->head++;
+    return 0;
+}
+
+int
+ringbuf_pop_back(RINGBUF* rb, void* elem)
+{
+    if(ringbuf_is_empty(rb))
+        return -1;
+
+    if(elem != NULL)
+        memcpy(elem, ringbuf_at(rb, ringbuf_count(rb) - 1), rb->elem_size);
+    rb->tail--;
+    return 0;
+}
+
+int
+ringbuf_push_back_n(RINGBUF* rb, const void* elems, size_t n)
+{
+    size_t n1;
+    void* span;
+
+    if(ringbuf_reserve(rb, n) != 0)
+        return -1;
+
+    /* At most two chunks: Up to the end of the memory block, and then from
+     * its beginning. */
+    while(n > 0) {
+        n1 = ringbuf_write_span(rb, &span);
+        if(n1 > n)
+            n1 = n;
+        memcpy(span, elems, n1 * rb->elem_size);
+        ringbuf_commit(rb, n1);
+        elems = (const uint8_t*) elems + n1 * rb->elem_size;
+        n -= n1;
+    }
+
+    return 0;
+}
+
+size_t
+ringbuf_pop_front_n(RINGBUF* rb, void* elems, size_t n)
+{
+    size_t n1;
+    size_t n_popped = 0;
+    void* span;
+
+    while(n > 0  &&  !ringbuf_is_empty(rb)) {
+        n1 = ringbuf_read_span(rb, &span);
+        if(n1 > n)
+            n1 = n;
+        memcpy(elems, span, n1 * rb->elem_size);
+        ringbuf_consume(rb, n1);
+        elems = (uint8_t*) elems + n1 * rb->elem_size;
+        n -= n1;
+        n_popped += n1;
+    }
+
+    return n_popped;
+}
+
+size_t
+ringbuf_read_span(RINGBUF* rb, void** p_span)
+{
+    size_t count = ringbuf_count(rb);
+    size_t start;
+    size_t n;
+
+    if(count == 0) {
+        *p_span = NULL;
+        return 0;
+    }
+
+    start = rb->head & (rb->capacity - 1);
+    n = rb->capacity - start;
+    *p_span = (uint8_t*) rb->data + start * rb->elem_size;
+    return (n < count) ? n : count;
+}
+
+size_t
+ringbuf_write_span(RINGBUF* rb, void** p_span)
+{
+    size_t free_count = rb->capacity - ringbuf_count(rb);
+    size_t start;
+    size_t n;
+
+    if(free_count == 0) {
+        *p_span = NULL;
+        return 0;
+    }
+
+    start = rb->tail & (rb->capacity - 1);
+    n = rb->capacity - start;
+    *p_span = (uint8_t*) rb->data + start * rb->elem_size;
+    return (n < free_count) ? n : free_count;
+}
+
+
+/****************************
+ ***   SPSC ring buffer   ***
+ ****************************/
+
+/* The producer publishes new elements by a release-store to tail, which the
+ * consumer reads with an acquire-load (and vice versa for head). This makes
+ * sure the element data are visible before the counter which covers them. */
+#if defined __GNUC__
+    #define LOAD_ACQUIRE(ptr)           __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+    #define STORE_RELEASE(ptr, val)     __atomic_store_n((ptr), (val), __ATOMIC_RELEASE)
+#elif defined _MSC_VER
+    #include <intrin.h>
+    #if defined _M_ARM  ||  defined _M_ARM64
+        #define BARRIER__()             __dmb(0xb /* ISH */)
+    #else
+        /* On x86, ordinary loads and stores have the acquire and release
+         * semantics. We only need to prevent compiler reordering. */
+        #define BARRIER__()             _ReadWriteBarrier()
+    #endif
+
+    static size_t
+    ringbuf_load_acquire(volatile size_t* ptr)
+    {
+        size_t val = *ptr;
+        BARRIER__();
+        return val;
+    }
+
+    static void
+    ringbuf_store_release(volatile size_t* ptr, size_t val)
+    {
+        BARRIER__();
+        *ptr = val;
+    }
+
+    #define LOAD_ACQUIRE(ptr)           ringbuf_load_acquire(ptr)
+    #define STORE_RELEASE(ptr, val)     ringbuf_store_release((ptr), (val))
+#else
+    #error Unsupported compiler.
+#endif
+
+
+int
+ringbuf_spsc_init(RINGBUF_SPSC* rb, size_t elem_size, size_t capacity)
+{
+    memset(rb, 0, sizeof(RINGBUF_SPSC));
+
+    capacity = ringbuf_round_capacity(capacity);
+    rb->data = malloc(capacity * elem_size);
+    if(rb->data == NULL)
+        return -1;
+
+    rb->elem_size = elem_size;
+    rb->mask = capacity - 1;
+    return 0;
+}
+
+void
+ringbuf_spsc_fini(RINGBUF_SPSC* rb)
+{
+    free(rb->data);
+}
+
+/* Count of free slots as seen by the producer. Refreshes the cached head
+ * only if needed, to avoid touching the consumer's cache line. */
+static size_t
+ringbuf_spsc_free_count(RINGBUF_SPSC* rb, size_t tail, size_t needed)
+{
+    size_t free_count = rb->mask + 1 - (tail - rb->cached_head);
+
+    if(free_count < needed) {
+        rb->cached_head = LOAD_ACQUIRE(&rb->head);
+        free_count = rb->mask + 1 - (tail - rb->cached_head);
+    }
+    return free_count;
+}
+
+/* Count of available elements as seen by the consumer. */
+static size_t
+ringbuf_spsc_avail_count(RINGBUF_SPSC* rb, size_t head, size_t needed)
+{
+    size_t avail_count = rb->cached_tail - head;
+
+    if(avail_count < needed) {
+        rb->cached_tail = LOAD_ACQUIRE(&rb->tail);
+        avail_count = rb->cached_tail - head;
+    }
+    return avail_count;
+}
+
+int
+ringbuf_spsc_push(RINGBUF_SPSC* rb, const void* elem)
+{
+    size_t tail = rb->tail;
+
+    if(ringbuf_spsc_free_count(rb, tail, 1) == 0)
+        return -1;
+
+    memcpy(SLOT(rb, tail), elem, rb->elem_size);
+    STORE_RELEASE(&rb->tail, tail + 1);
+    return 0;
+}
+
+size_t
+ringbuf_spsc_write_span(RINGBUF_SPSC* rb, void** p_span)
+{
+    size_t tail = rb->tail;
+    size_t to_end = rb->mask + 1 - (tail & rb->mask);
+    size_t n;
+
+    n = ringbuf_spsc_free_count(rb, tail, to_end);
+    *p_span = SLOT(rb, tail);
+    return (n < to_end) ? n : to_end;
+}
+
+void
+ringbuf_spsc_commit(RINGBUF_SPSC* rb, size_t n)
+{
+    STORE_RELEASE(&rb->tail, rb->tail + n);
+}
+
+size_t
+ringbuf_spsc_push_n(RINGBUF_SPSC* rb, const void* elems, size_t n)
+{
+    size_t n_pushed = 0;
+    size_t n1;
+    void* span;
+
+    while(n > 0) {
+        n1 = ringbuf_spsc_write_span(rb, &span);
+        if(n1 == 0)
+            break;
+        if(n1 > n)
+            n1 = n;
+        memcpy(span, elems, n1 * rb->elem_size);
+        ringbuf_spsc_commit(rb, n1);
+        elems = (const uint8_t*) elems + n1 * rb->elem_size;
+        n -= n1;
+        n_pushed += n1;
+    }
+
+    return n_pushed;
+}
+
+int
+ringbuf_spsc_pop(RINGBUF_SPSC* rb, void* elem)
+{
+    size_t head = rb->head;
+
+    if(ringbuf_spsc_avail_count(rb, head, 1) == 0)
+        return -1;
+
+    if(elem != NULL)
+        memcpy(elem, SLOT(rb, head), rb->elem_size);
+    STORE_RELEASE(&rb->head, head + 1);
+    return 0;
+}
+
+size_t
+ringbuf_spsc_read_span(RINGBUF_SPSC* rb, void** p_span)
+{
+    size_t head = rb->head;
+    size_t to_end = rb->mask + 1 - (head & rb->mask);
+    size_t n;
+
+    n = ringbuf_spsc_avail_count(rb, head, to_end);
+    *p_span = SLOT(rb, head);
+    return (n < to_end) ? n : to_end;
+}
+
+void
+ringbuf_spsc_consume(RINGBUF_SPSC* rb, size_t n)
+{
+    STORE_RELEASE(&rb->head, rb->head + n);
+}
+
+size_t
+ringbuf_spsc_pop_n(RINGBUF_SPSC* rb, void* elems, size_t n)
+{
+    size_t n_popped = 0;
+    size_t n1;
+    void* span;
+
+    while(n > 0) {
+        n1 = ringbuf_spsc_read_span(rb, &span);
+        if(n1 == 0)
+            break;
+        if(n1 > n)
+            n1 = n;
+        memcpy(elems, span, n1 * rb->elem_size);
+        ringbuf_spsc_consume(rb, n1);
+        elems = (uint8_t*) elems + n1 * rb->elem_size;
+        n -= n1;
+        n_popped += n1;
+    }
+
+    return n_popped;
+}
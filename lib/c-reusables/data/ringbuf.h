@@ -0,0 +1,197 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2020 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef CRE_RINGBUF_H
+#define CRE_RINGBUF_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#if defined __cplusplus
+    #define RINGBUF_INLINE__    inline
+#elif defined __STDC_VERSION__ && __STDC_VERSION__ >= 199901L
+    #define RINGBUF_INLINE__    static inline
+#elif defined __GNUC__
+    #define RINGBUF_INLINE__    static __inline__
+#elif defined _MSC_VER
+    #define RINGBUF_INLINE__    static __inline
+#else
+    #define RINGBUF_INLINE__    static
+#endif
+
+
+/* Ring buffer (double-ended queue) of fixed-size elements.
+ *
+ * Unlike the STACK or ARRAY (see buffer.h), elements can be added and removed
+ * at both ends in O(1) without moving any other elements.
+ *
+ * The capacity is always a power of two, so wrapping the positions around is
+ * just a bit mask. head and tail are free-running counters; the elements live
+ * at positions head ... (tail-1), modulo the capacity.
+ */
+typedef struct RINGBUF {
+    void* data;
+    size_t elem_size;
+    size_t capacity;
+    size_t head;
+    size_t tail;
+} RINGBUF;
+
+
+/* Static initializer. */
+#define RINGBUF_INITIALIZER(elem_size)      { NULL, (elem_size), 0, 0, 0 }
+
+/* Initialize/deinitialize the ring buffer. */
+RINGBUF_INLINE__ void ringbuf_init(RINGBUF* rb, size_t elem_size)
+        { rb->data = NULL; rb->elem_size = elem_size; rb->capacity = 0; rb->head = 0; rb->tail = 0; }
+RINGBUF_INLINE__ void ringbuf_fini(RINGBUF* rb)
+        { free(rb->data); }
+
+/* Make sure there is a room for at least n more elements. */
+int ringbuf_reserve(RINGBUF* rb, size_t n);
+
+RINGBUF_INLINE__ size_t ringbuf_count(const RINGBUF* rb)
+        { return rb->tail - rb->head; }
+RINGBUF_INLINE__ int ringbuf_is_empty(const RINGBUF* rb)
+        { return (rb->tail == rb->head); }
+
+/* Get pointer to the index-th element (0 is the front one). */
+RINGBUF_INLINE__ void* ringbuf_at(RINGBUF* rb, size_t index)
+        { return (uint8_t*) rb->data + ((rb->head + index) & (rb->capacity - 1)) * rb->elem_size; }
+RINGBUF_INLINE__ void* ringbuf_front(RINGBUF* rb)
+        { return ringbuf_is_empty(rb) ? NULL : ringbuf_at(rb, 0); }
+RINGBUF_INLINE__ void* ringbuf_back(RINGBUF* rb)
+        { return ringbuf_is_empty(rb) ? NULL : ringbuf_at(rb, ringbuf_count(rb) - 1); }
+
+/* Add an element at the back or at the front. The _raw() variants return
+ * pointer to the (uninitialized) new element, or NULL on a failure. The other
+ * ones copy the element from the given address and return 0 on success or -1
+ * on a failure. */
+void* ringbuf_push_back_raw(RINGBUF* rb);
+void* ringbuf_push_front_raw(RINGBUF* rb);
+int ringbuf_push_back(RINGBUF* rb, const void* elem);
+int ringbuf_push_front(RINGBUF* rb, const void* elem);
+
+/* Remove an element from the front or from the back. If elem is not NULL,
+ * the removed element is copied there. Returns 0 on success or -1 if the ring
+ * buffer is empty. */
+int ringbuf_pop_front(RINGBUF* rb, void* elem);
+int ringbuf_pop_back(RINGBUF* rb, void* elem);
+
+/* Bulk operations: Add n elements at the back (returns 0 on success or -1 on
+ * a failure), or remove up to n elements from the front (returns count of
+ * the removed elements). */
+int ringbuf_push_back_n(RINGBUF* rb, const void* elems, size_t n);
+size_t ringbuf_pop_front_n(RINGBUF* rb, void* elems, size_t n);
+
+RINGBUF_INLINE__ void ringbuf_clear(RINGBUF* rb)
+        { rb->head = rb->tail; }
+
+
+/* Zero-copy access to the contents.
+ *
+ * ringbuf_read_span() retrieves the longest contiguous run of elements at the
+ * front of the ring buffer (which may be shorter then ringbuf_count() if the
+ * contents wraps around). Once caller has processed (some of) them, he calls
+ * ringbuf_consume() to remove them.
+ *
+ * Similarly, ringbuf_write_span() retrieves the longest contiguous run of the
+ * free space behind the back element. After caller has written (some) elements
+ * there, he calls ringbuf_commit() to add them into the ring buffer. (Call
+ * ringbuf_reserve() beforehand to make sure there is some free space.)
+ *
+ * Both functions return count of the elements in the span and store pointer
+ * to its beginning into *p_span.
+ */
+size_t ringbuf_read_span(RINGBUF* rb, void** p_span);
+size_t ringbuf_write_span(RINGBUF* rb, void** p_span);
+RINGBUF_INLINE__ void ringbuf_consume(RINGBUF* rb, size_t n)
+        { rb->head += n; }
+RINGBUF_INLINE__ void ringbuf_commit(RINGBUF* rb, size_t n)
+        { rb->tail += n; }
+
+
+/* Lock-free single-producer/single-consumer variant.
+ *
+ * It has a fixed capacity (it never grows) and it only supports pushing at
+ * the back and popping from the front. Exactly one thread may act as the
+ * producer (calling ringbuf_spsc_push*() and ringbuf_spsc_write_span() +
+ * ringbuf_spsc_commit()), and exactly one thread may act as the consumer
+ * (calling ringbuf_spsc_pop*() and ringbuf_spsc_read_span() +
+ * ringbuf_spsc_consume()). No locking is needed as long as this holds.
+ *
+ * The members written by the producer and by the consumer live in separate
+ * cache lines, so the two threads do not contend for them.
+ */
+#define RINGBUF_CACHELINE_SIZE__    64
+
+typedef struct RINGBUF_SPSC {
+    /* Read-only after initialization. */
+    void* data;
+    size_t elem_size;
+    size_t mask;
+    uint8_t pad0[RINGBUF_CACHELINE_SIZE__ - 3 * sizeof(size_t)];
+
+    /* Owned by the producer. (cached_head is the last seen value of head.) */
+    volatile size_t tail;
+    size_t cached_head;
+    uint8_t pad1[RINGBUF_CACHELINE_SIZE__ - 2 * sizeof(size_t)];
+
+    /* Owned by the consumer. (cached_tail is the last seen value of tail.) */
+    volatile size_t head;
+    size_t cached_tail;
+    uint8_t pad2[RINGBUF_CACHELINE_SIZE__ - 2 * sizeof(size_t)];
+} RINGBUF_SPSC;
+
+/* Initialize the ring buffer, with the capacity rounded up to a power of two.
+ * Returns 0 on success, -1 on a failure. */
+int ringbuf_spsc_init(RINGBUF_SPSC* rb, size_t elem_size, size_t capacity);
+void ringbuf_spsc_fini(RINGBUF_SPSC* rb);
+
+/* Producer side. ringbuf_spsc_push() returns 0 on success, -1 if the ring
+ * buffer is full. ringbuf_spsc_push_n() returns count of elements pushed. */
+int ringbuf_spsc_push(RINGBUF_SPSC* rb, const void* elem);
+size_t ringbuf_spsc_push_n(RINGBUF_SPSC* rb, const void* elems, size_t n);
+size_t ringbuf_spsc_write_span(RINGBUF_SPSC* rb, void** p_span);
+void ringbuf_spsc_commit(RINGBUF_SPSC* rb, size_t n);
+
+/* Consumer side. ringbuf_spsc_pop() returns 0 on success, -1 if the ring
+ * buffer is empty. ringbuf_spsc_pop_n() returns count of elements popped. */
+int ringbuf_spsc_pop(RINGBUF_SPSC* rb, void* elem);
+size_t ringbuf_spsc_pop_n(RINGBUF_SPSC* rb, void* elems, size_t n);
+size_t ringbuf_spsc_read_span(RINGBUF_SPSC* rb, void** p_span);
+void ringbuf_spsc_consume(RINGBUF_SPSC* rb, size_t n);
+
+
+#ifdef __cplusplus
+}  /* extern "C" { */
+#endif
+
+#endif  /* CRE_RINGBUF_H */
@@ -0,0 +1,402 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2020 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "rope.h"
+
+#include <string.h>
+
+
+#define MIN(a,b)    ((a) < (b) ? (a) : (b))
+#define MAX(a,b)    ((a) > (b) ? (a) : (b))
+
+
+#define ROPE_CHUNK_LEN(rope, c)     ((rope)->starts[(c)+1] - (rope)->starts[(c)])
+#define ROPE_ELEM(rope, chunk, i)   ((chunk) + (i) * (rope)->elem_size)
+
+
+void
+rope_init(ROPE* rope, size_t elem_size, size_t chunk_cap)
+{
+    rope->elem_size = elem_size;
+    rope->chunk_cap = (chunk_cap > 0 ? chunk_cap : ROPE_DEFAULT_CHUNK_CAP);
+    rope->n = 0;
+    rope->chunk_count = 0;
+    rope->chunk_alloc = 0;
+    rope->chunks = NULL;
+    rope->starts = NULL;
+    rope->cursor = 0;
+}
+
+void
+rope_fini(ROPE* rope)
+{
+    size_t c;
+
+    for(c = 0; c < rope->chunk_count; c++)
+        free(rope->chunks[c]);
+    free(rope->chunks);
+    free(rope->starts);
+}
+
+size_t
+rope_locate_(const ROPE* rope, size_t i)
+{
+    size_t lo = 0;
+    size_t hi = rope->chunk_count;
+
+    /* Find the last chunk with starts[c] <= i. */
+    while(hi - lo > 1) {
+        size_t mid = (lo + hi) / 2;
+        if(rope->starts[mid] <= i)
+            lo = mid;
+        else
+            hi = mid;
+    }
+
+    return lo;
+}
+
+void*
+rope_span(ROPE* rope, size_t i, size_t* p_n)
+{
+    unsigned char* elem = (unsigned char*) rope_get(rope, i);
+
+    *p_n = rope->starts[rope->cursor + 1] - i;
+    return elem;
+}
+
+/* Update the chunk starts after chunk c has changed its length. */
+static void
+rope_update_starts(ROPE* rope, size_t c, size_t len)
+{
+    size_t delta_plus = 0;
+    size_t delta_minus = 0;
+    size_t old_len = ROPE_CHUNK_LEN(rope, c);
+
+    if(len > old_len)
+        delta_plus = len - old_len;
+    else
+        delta_minus = old_len - len;
+
+    for(c = c + 1; c <= rope->chunk_count; c++)
+        rope->starts[c] = rope->starts[c] + delta_plus - delta_minus;
+}
+
+/* Make room for n more chunks in the index. */
+static int
+rope_reserve_chunks(ROPE* rope, size_t n)
+{
+    unsigned char** chunks;
+    size_t* starts;
+    size_t alloc;
+
+    if(rope->chunk_count + n <= rope->chunk_alloc)
+        return 0;
+
+    alloc = MAX(rope->chunk_count + n, 2 * rope->chunk_alloc);
+    alloc = MAX(alloc, 8);
+
+    chunks = (unsigned char**) realloc(rope->chunks, alloc * sizeof(unsigned char*));
+    if(chunks == NULL)
+        return -1;
+    rope->chunks = chunks;
+
+    starts = (size_t*) realloc(rope->starts, (alloc + 1) * sizeof(size_t));
+    if(starts == NULL)
+        return -1;
+    if(rope->chunk_alloc == 0)
+        starts[0] = 0;
+    rope->starts = starts;
+
+    rope->chunk_alloc = alloc;
+    return 0;
+}
+
+/* Copy the part [d0, d1) of the virtual sequence (head | n zeros | tail),
+ * where the head and the tail are the elements of chunk src before and after
+ * the position off, into the dst. The tail is handled first so that it works
+ * also when dst is src itself. */
+static void
+rope_fill(ROPE* rope, unsigned char* dst, const unsigned char* src,
+          size_t off, size_t n, size_t d0, size_t d1)
+{
+    size_t p0, p1;
+
+    /* Tail: sequence positions [off+n, ...) come from src[off, ...). */
+    p0 = MAX(d0, off + n);
+    if(p0 < d1) {
+        memmove(ROPE_ELEM(rope, dst, p0 - d0), ROPE_ELEM(rope, src, p0 - n),
+                (d1 - p0) * rope->elem_size);
+    }
+
+    /* Inserted zeros: [off, off+n). */
+    p0 = MAX(d0, off);
+    p1 = MIN(d1, off + n);
+    if(p0 < p1)
+        memset(ROPE_ELEM(rope, dst, p0 - d0), 0, (p1 - p0) * rope->elem_size);
+
+    /* Head: [0, off) comes from src[0, off). */
+    p1 = MIN(d1, off);
+    if(d0 < p1 && dst != src)
+        memcpy(dst, ROPE_ELEM(rope, src, d0), (p1 - d0) * rope->elem_size);
+}
+
+int
+rope_insert(ROPE* rope, size_t pos, size_t n)
+{
+    size_t c, off, len, total, m, j;
+    size_t d0, d1;
+    unsigned char* src;
+
+    if(n == 0)
+        return 0;
+
+    if(rope->chunk_count == 0) {
+        /* Empty rope: Everything goes into new chunks. */
+        c = 0;
+        off = 0;
+        len = 0;
+        src = NULL;
+    } else {
+        c = (pos < rope->n ? rope_locate_(rope, pos) : rope->chunk_count - 1);
+        off = pos - rope->starts[c];
+
+        /* When inserting at a chunk boundary, prefer the end of the previous
+         * chunk if it has room. (This includes appending at the end.) */
+        if(off == 0  &&  c > 0  &&  ROPE_CHUNK_LEN(rope, c-1) + n <= rope->chunk_cap) {
+            c--;
+            off = ROPE_CHUNK_LEN(rope, c);
+        }
+
+        len = ROPE_CHUNK_LEN(rope, c);
+        src = rope->chunks[c];
+
+        /* Fast path: It fits into the chunk. */
+        if(len + n <= rope->chunk_cap) {
+            memmove(ROPE_ELEM(rope, src, off + n), ROPE_ELEM(rope, src, off),
+                    (len - off) * rope->elem_size);
+            memset(ROPE_ELEM(rope, src, off), 0, n * rope->elem_size);
+            rope_update_starts(rope, c, len + n);
+            rope->n += n;
+            rope->cursor = c;
+            return 0;
+        }
+    }
+
+    /* Slow path: Distribute the (head | n zeros | tail) sequence into m
+     * chunks, the first of them being the old chunk c (if any). */
+    total = len + n;
+    m = (total + rope->chunk_cap - 1) / rope->chunk_cap;
+
+    if(rope_reserve_chunks(rope, (src != NULL ? m - 1 : m)) != 0)
+        return -1;
+
+    {
+        unsigned char* new_chunks[64];
+        unsigned char** tmp = new_chunks;
+        size_t n_new = (src != NULL ? m - 1 : m);
+
+        /* m may be large only when inserting many elements at once. */
+        if(n_new > sizeof(new_chunks) / sizeof(new_chunks[0])) {
+            tmp = (unsigned char**) malloc(n_new * sizeof(unsigned char*));
+            if(tmp == NULL)
+                return -1;
+        }
+
+        for(j = 0; j < n_new; j++) {
+            tmp[j] = (unsigned char*) malloc(rope->chunk_cap * rope->elem_size);
+            if(tmp[j] == NULL) {
+                while(j > 0)
+                    free(tmp[--j]);
+                if(tmp != new_chunks)
+                    free(tmp);
+                return -1;
+            }
+        }
+
+        /* Nothing can fail from now on. */
+
+        /* Make room in the index for the new chunks after the chunk c. */
+        if(src != NULL) {
+            memmove(rope->chunks + c + m, rope->chunks + c + 1,
+                    (rope->chunk_count - c - 1) * sizeof(unsigned char*));
+            memmove(rope->starts + c + m, rope->starts + c + 1,
+                    (rope->chunk_count - c) * sizeof(size_t));
+            for(j = 0; j < n_new; j++)
+                rope->chunks[c + 1 + j] = tmp[j];
+        } else {
+            for(j = 0; j < n_new; j++)
+                rope->chunks[j] = tmp[j];
+            rope->starts[0] = 0;
+            rope->starts[n_new] = 0;
+        }
+        rope->chunk_count += n_new;
+
+        /* Fill the chunks from the last one so that the old chunk (the first
+         * one) is overwritten only when nothing else needs its contents.
+         *
+         * When appending at the end of the chunk (no tail), keep the chunks
+         * full. Otherwise balance them, so that there is room for more
+         * insertions in all of them. */
+        d1 = total;
+        for(j = m; j > 0; j--) {
+            size_t size;
+
+            if(len == off)
+                size = (j == m ? total - (m-1) * rope->chunk_cap : rope->chunk_cap);
+            else
+                size = total / m + (j-1 < total % m ? 1 : 0);
+            d0 = d1 - size;
+            rope_fill(rope, rope->chunks[c + j - 1], src, off, n, d0, d1);
+            rope->starts[c + j - 1] = rope->starts[c] + d0;
+            d1 = d0;
+        }
+
+        for(j = c + m; j <= rope->chunk_count; j++)
+            rope->starts[j] += n;
+
+        if(tmp != new_chunks)
+            free(tmp);
+    }
+
+    rope->n += n;
+    rope->cursor = c;
+    return 0;
+}
+
+/* Remove chunk c (which has already been freed or moved away) together with
+ * its start from the index. */
+static void
+rope_drop_chunk(ROPE* rope, size_t c)
+{
+    memmove(rope->chunks + c, rope->chunks + c + 1,
+            (rope->chunk_count - c - 1) * sizeof(unsigned char*));
+    memmove(rope->starts + c, rope->starts + c + 1,
+            (rope->chunk_count - c) * sizeof(size_t));
+    rope->chunk_count--;
+}
+
+/* Merge chunks c and c+1 if they are small enough. (We leave some slack so
+ * that alternating insertions and removals around the same place do not keep
+ * splitting and merging the same chunks.) */
+static void
+rope_merge(ROPE* rope, size_t c)
+{
+    size_t len0, len1;
+
+    if(c + 1 >= rope->chunk_count)
+        return;
+
+    len0 = ROPE_CHUNK_LEN(rope, c);
+    len1 = ROPE_CHUNK_LEN(rope, c+1);
+    if(len0 + len1 > rope->chunk_cap - rope->chunk_cap / 4)
+        return;
+
+    memcpy(ROPE_ELEM(rope, rope->chunks[c], len0), rope->chunks[c+1],
+           len1 * rope->elem_size);
+    free(rope->chunks[c+1]);
+    rope_drop_chunk(rope, c+1);
+}
+
+void
+rope_remove(ROPE* rope, size_t pos, size_t n)
+{
+    size_t c, e, s, off, len, tail, k, j;
+    size_t end = pos + n;
+
+    if(n == 0)
+        return;
+
+    c = rope_locate_(rope, pos);
+    s = rope->starts[c];
+    off = pos - s;
+    len = ROPE_CHUNK_LEN(rope, c);
+
+    if(off + n <= len) {
+        /* Everything is in the single chunk. */
+        if(n == len) {
+            free(rope->chunks[c]);
+            rope_drop_chunk(rope, c);
+        } else {
+            unsigned char* chunk = rope->chunks[c];
+            memmove(ROPE_ELEM(rope, chunk, off), ROPE_ELEM(rope, chunk, off + n),
+                    (len - off - n) * rope->elem_size);
+            rope_update_starts(rope, c, len - n);
+        }
+        rope->n -= n;
+        /* If the chunk has been dropped, the following ones have moved down
+         * in the index and their starts still need to be updated. */
+        if(n == len) {
+            for(j = c; j <= rope->chunk_count; j++)
+                rope->starts[j] -= n;
+        }
+    } else {
+        /* The range spans chunks c ... e. Chunk c keeps its head [0, off),
+         * chunk e keeps its tail, chunks in between go away. */
+        e = rope_locate_(rope, end - 1);
+        tail = rope->starts[e+1] - end;
+
+        k = c;
+        if(off > 0)
+            k++;
+        else
+            free(rope->chunks[c]);
+        for(j = c + 1; j < e; j++)
+            free(rope->chunks[j]);
+        if(tail > 0) {
+            unsigned char* chunk = rope->chunks[e];
+            memmove(chunk, ROPE_ELEM(rope, chunk, end - rope->starts[e]),
+                    tail * rope->elem_size);
+            rope->chunks[k] = chunk;
+            rope->starts[k] = s + off;
+            k++;
+        } else {
+            free(rope->chunks[e]);
+        }
+        for(j = e + 1; j < rope->chunk_count; j++) {
+            rope->chunks[k] = rope->chunks[j];
+            rope->starts[k] = rope->starts[j] - n;
+            k++;
+        }
+        rope->n -= n;
+        rope->starts[k] = rope->n;
+        rope->chunk_count = k;
+    }
+
+    /* Merge the chunks around the removed range, if they became too small. */
+    if(c < rope->chunk_count)
+        rope_merge(rope, c);
+    if(c > 0)
+        rope_merge(rope, c - 1);
+
+    rope->cursor = 0;
+    if(rope->chunk_count == 0) {
+        free(rope->chunks);
+        free(rope->starts);
+        rope->chunks = NULL;
+        rope->starts = NULL;
+        rope->chunk_alloc = 0;
+    }
+}
@@ -0,0 +1,130 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2020 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef CRE_ROPE_H
+#define CRE_ROPE_H
+
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#if defined __cplusplus
+    #define ROPE_INLINE__       inline
+#elif defined __STDC_VERSION__ && __STDC_VERSION__ >= 199901L
+    #define ROPE_INLINE__       static inline
+#elif defined __GNUC__
+    #define ROPE_INLINE__       static __inline__
+#elif defined _MSC_VER
+    #define ROPE_INLINE__       static __inline
+#else
+    #define ROPE_INLINE__       static
+#endif
+
+
+/* Chunked array (a flat "rope") of fixed-size elements.
+ *
+ * The elements are stored in a sequence of chunks, each holding at most
+ * chunk_cap elements. Inserting or removing elements in the middle of the
+ * array moves only elements of the affected chunk (or splits it into more
+ * chunks), plus it updates the small index of the chunk starts. So it costs
+ * O(chunk_cap + n / chunk_cap) instead of O(n) with a plain C array.
+ *
+ * Random access locates the chunk with a binary search over the index. The
+ * chunk found last is remembered, so sequential access (as well as repeated
+ * access to the same area) is O(1).
+ *
+ * Elements are indexed from zero. Pointers to them are valid only until the
+ * next insertion or removal.
+ */
+typedef struct ROPE {
+    size_t elem_size;
+    size_t chunk_cap;       /* Max. count of elements in a chunk. */
+    size_t n;               /* Count of all elements. */
+    size_t chunk_count;
+    size_t chunk_alloc;
+    unsigned char** chunks;
+    size_t* starts;         /* Index of the first element of each chunk; */
+                            /* starts[chunk_count] == n. */
+    size_t cursor;          /* Chunk found by the last lookup. */
+} ROPE;
+
+#define ROPE_DEFAULT_CHUNK_CAP      256
+
+
+/* Initialize/deinitialize the rope. Initially, it has no elements. If
+ * chunk_cap is zero, ROPE_DEFAULT_CHUNK_CAP is used. */
+void rope_init(ROPE* rope, size_t elem_size, size_t chunk_cap);
+void rope_fini(ROPE* rope);
+
+ROPE_INLINE__ size_t rope_count(const ROPE* rope) { return rope->n; }
+
+/* Insert n zero-filled elements at position pos, or remove n elements starting
+ * at pos. rope_insert() returns 0 on success, or -1 on an allocation failure
+ * (then the rope is left intact). rope_remove() never fails (it never
+ * allocates). */
+int rope_insert(ROPE* rope, size_t pos, size_t n);
+void rope_remove(ROPE* rope, size_t pos, size_t n);
+
+/* Find the chunk holding the element i (i < rope_count()). */
+size_t rope_locate_(const ROPE* rope, size_t i);
+
+/* Get pointer to the element i (i < rope_count()).
+ *
+ * rope_get() remembers the chunk in the rope, so it must not be used by more
+ * threads concurrently. rope_get_const() does not modify the rope, so it may
+ * be used by any count of readers at the same time. */
+ROPE_INLINE__ void*
+rope_get(ROPE* rope, size_t i)
+{
+    size_t c = rope->cursor;
+
+    if(i < rope->starts[c]  ||  i >= rope->starts[c+1]) {
+        c = rope_locate_(rope, i);
+        rope->cursor = c;
+    }
+    return rope->chunks[c] + (i - rope->starts[c]) * rope->elem_size;
+}
+
+ROPE_INLINE__ const void*
+rope_get_const(const ROPE* rope, size_t i)
+{
+    size_t c = rope_locate_(rope, i);
+    return rope->chunks[c] + (i - rope->starts[c]) * rope->elem_size;
+}
+
+/* Get pointer to the element i (i < rope_count()) and count of the elements
+ * stored contiguously with it (i.e. the element i and those following it in
+ * the same chunk). Useful to iterate over a range chunk by chunk. */
+void* rope_span(ROPE* rope, size_t i, size_t* p_n);
+
+
+#ifdef __cplusplus
+}  /* extern "C" { */
+#endif
+
+#endif  /* CRE_ROPE_H */
@@ -24,6 +24,7 @@
  */
 
 #include "value.h"
+#include "../hash/fnv1a.h"
 
 #include <malloc.h>
 #include <string.h>
@@ -34,6 +35,8 @@
 #define HAS_REDCOLOR    0x10    /* only for VALUE_STRING (when used as RBTREE::key) */
 #define HAS_ORDERLIST   0x10    /* only for VALUE_DICT */
 #define HAS_CUSTOMCMP   0x20    /* only for VALUE_DICT */
+#define HAS_INTERN      0x40    /* only for VALUE_DICT */
+#define IS_INTERNED     0x40    /* only for VALUE_STRING (when used as RBTREE::key) */
 #define IS_MALLOCED     0x80
 
 
@@ -44,6 +47,14 @@ struct ARRAY_tag {
     size_t alloc;
 };
 
+/* Payload of VALUE_xxx_VECTOR. */
+typedef struct VECTOR_tag VECTOR;
+struct VECTOR_tag {
+    void* buf;
+    size_t size;    /* Count of elements (not bytes). */
+    size_t alloc;
+};
+
 typedef struct RBTREE_tag RBTREE;
 struct RBTREE_tag {
     /* We store color by using the flag HAS_REDCOLOR of the key. */
@@ -69,10 +80,32 @@ struct DICT_tag {
     size_t size;
 
     /* These are present only when flags VALUE_DICT_MAINTAINORDER or
-     * custom_cmp_func is used. */
+     * custom_cmp_func is used, or when the dictionary has an intern table
+     * attached. */
     RBTREE* order_head;
     RBTREE* order_tail;
     int (*cmp_func)(const char*, size_t, const char*, size_t);
+    VALUE_INTERN* intern;
+};
+
+/* Interned key string. Keys of all dictionaries sharing the same VALUE_INTERN
+ * point to the payload of a single such entry. */
+typedef struct INTERN_ENTRY_tag INTERN_ENTRY;
+struct INTERN_ENTRY_tag {
+    INTERN_ENTRY* next;
+    uint32_t hash;
+    uint32_t refs;
+
+    /* Same layout as payload of VALUE_STRING: Length (as a variable-length
+     * number), the string bytes and the terminating zero byte. */
+    uint8_t payload[1];
+};
+
+struct VALUE_INTERN_tag {
+    INTERN_ENTRY** buckets;
+    size_t bucket_count;    /* Zero or power of 2. */
+    size_t size;
+    unsigned refs;
 };
 
 
@@ -143,10 +176,13 @@ value_payload_ex(VALUE* v, size_t align)
     if(v == NULL)
         return NULL;
 
-    if(!(v->data[0] & IS_MALLOCED))
-        return (void*)(v->data + align);
-    else
+    /* Interned string is never malloced on its own but it still refers
+     * to the payload living outside of the VALUE. */
+    if((v->data[0] & IS_MALLOCED)  ||
+       (value_type(v) == VALUE_STRING  &&  (v->data[0] & IS_INTERNED)))
         return *(void**)(v->data + sizeof(void*));
+    else
+        return (void*)(v->data + align);
 }
 
 static uint8_t*
@@ -232,51 +268,113 @@ value_is_new(const VALUE* v)
 }
 
 
-static VALUE*
-value_path_ex(VALUE* root, const char* path, int allow_build)
+/* Path segment types. */
+#define SEGMENT_END         0
+#define SEGMENT_KEY         1
+#define SEGMENT_INDEX       2   /* index from the beginning of the array */
+#define SEGMENT_RINDEX      3   /* index from the end of the array ("[-1]" etc.) */
+#define SEGMENT_APPEND      4   /* empty brackets "[]" */
+
+typedef struct PATH_SEGMENT_tag PATH_SEGMENT;
+struct PATH_SEGMENT_tag {
+    int type;
+    const char* key;
+    size_t key_len;
+    size_t index;
+    uint32_t hash;      /* value_intern_hash() of the key. */
+    int has_hash;
+};
+
+struct VALUE_PATH_tag {
+    size_t n_segments;
+    PATH_SEGMENT segments[1];
+    /* Followed by copies of all keys. */
+};
+
+static uint32_t value_intern_hash(const char* str, size_t len);
+static VALUE* value_dict_get_ex(const VALUE* v, const char* key, size_t key_len,
+                                const uint32_t* p_hash);
+static VALUE* value_dict_get_or_add_ex(VALUE* v, const char* key, size_t key_len,
+                                       const uint32_t* p_hash);
+
+/* Parses the next segment of the path. Returns pointer behind the parsed
+ * segment, or NULL if the path is malformed. */
+static const char*
+value_path_parse_segment(const char* path, PATH_SEGMENT* seg)
 {
     const char* token_beg = path;
     const char* token_end;
-    VALUE* v = root;
 
-    while(1) {
-        while(*token_beg == '/')
-            token_beg++;
+    while(*token_beg == '/')
+        token_beg++;
 
-        token_end = token_beg;
-        if(*token_end == '\0')
-            return v;
-        if(*token_end == '[')
-            token_end++;
-        while(*token_end != '\0'  &&  *token_end != '/'  &&  *token_end != '[')
-            token_end++;
+    token_end = token_beg;
+    if(*token_end == '\0') {
+        seg->type = SEGMENT_END;
+        return token_end;
+    }
+    if(*token_end == '[')
+        token_end++;
+    while(*token_end != '\0'  &&  *token_end != '/'  &&  *token_end != '[')
+        token_end++;
+
+    if(token_end - token_beg >= 2  &&  token_beg[0] == '['  &&  token_end[-1] == ']') {
+        int sign;
+        size_t index = 0;
 
-        if(token_end - token_beg >= 2  &&  token_beg[0] == '['  &&  token_end[-1] == ']') {
-            int sign;
-            size_t index = 0;
+        token_beg++;
 
+        if(token_beg[0] == '-'  ||  token_beg[0] == '+') {
+            sign = (token_beg[0] == '+') ? +1 : -1;
             token_beg++;
+        } else {
+            sign = (token_end-1 - token_beg > 0) ? +1 : 0;
+        }
 
-            if(token_beg[0] == '-'  ||  token_beg[0] == '+') {
-                sign = (token_beg[0] == '+') ? +1 : -1;
-                token_beg++;
-            } else {
-                sign = (token_end-1 - token_beg > 0) ? +1 : 0;
-            }
+        while('0' <= *token_beg  &&  *token_beg <= '9') {
+            index = index * 10 + (*token_beg - '0');
+            token_beg++;
+        }
+        if(*token_beg != ']')
+            return NULL;
 
-            while('0' <= *token_beg  &&  *token_beg <= '9') {
-                index = index * 10 + (*token_beg - '0');
-                token_beg++;
-            }
-            if(*token_beg != ']')
-                return NULL;
+        if(sign > 0)
+            seg->type = SEGMENT_INDEX;
+        else if(sign < 0)
+            seg->type = SEGMENT_RINDEX;
+        else
+            seg->type = SEGMENT_APPEND;
+        seg->index = index;
+    } else {
+        seg->type = SEGMENT_KEY;
+        seg->key = token_beg;
+        seg->key_len = token_end - token_beg;
+        seg->has_hash = 0;
+    }
+
+    return token_end;
+}
+
+/* Resolves single segment of the path. (*p_intern) tracks the intern table
+ * of the nearest ancestor dictionary, so that dictionaries created when
+ * building the path can inherit it. */
+static VALUE*
+value_path_step(VALUE* v, const PATH_SEGMENT* seg, int allow_build, VALUE_INTERN** p_intern)
+{
+    const uint32_t* p_hash;
+    size_t index;
 
+    switch(seg->type) {
+        case SEGMENT_INDEX:
+        case SEGMENT_RINDEX:
+        case SEGMENT_APPEND:
             if(allow_build  &&  value_is_new(v)) {
                 if(value_init_array(v) != 0)
                     return NULL;
             }
 
-            if(sign < 0) {
+            index = seg->index;
+            if(seg->type == SEGMENT_RINDEX) {
                 size_t size = value_array_size(v);
                 if(0 < index  &&  index <= size)
                     index = size - index;
@@ -284,29 +382,54 @@ value_path_ex(VALUE* root, const char* path, int allow_build)
                     return NULL;
             }
 
-            if(sign == 0  &&  !allow_build)
-                return NULL;
+            if(seg->type == SEGMENT_APPEND) {
+                if(!allow_build)
+                    return NULL;
+                return value_array_append(v);
+            }
 
-            if(allow_build  &&  sign == 0)
-                v = value_array_append(v);
-            else
-                v = value_array_get(v, index);
-        } else if(token_end - token_beg > 0) {
+            return value_array_get(v, index);
+
+        case SEGMENT_KEY:
+            p_hash = (seg->has_hash ? &seg->hash : NULL);
             if(allow_build) {
                 if(value_is_new(v)) {
                     if(value_init_dict(v) != 0)
                         return NULL;
+                    /* Newly built dictionaries inherit the intern table
+                     * from their ancestors. */
+                    if(*p_intern != NULL  &&  value_dict_set_intern(v, *p_intern) != 0)
+                        return NULL;
                 }
-                v = value_dict_get_or_add_(v, token_beg, token_end - token_beg);
+                if(value_dict_intern(v) != NULL)
+                    *p_intern = value_dict_intern(v);
+                return value_dict_get_or_add_ex(v, seg->key, seg->key_len, p_hash);
             } else {
-                v = value_dict_get_(v, token_beg, token_end - token_beg);
+                return value_dict_get_ex(v, seg->key, seg->key_len, p_hash);
             }
-        }
 
-        if(v == NULL)
+        default:
+            return v;
+    }
+}
+
+static VALUE*
+value_path_ex(VALUE* root, const char* path, int allow_build)
+{
+    PATH_SEGMENT seg;
+    VALUE* v = root;
+    VALUE_INTERN* intern = NULL;
+
+    while(1) {
+        path = value_path_parse_segment(path, &seg);
+        if(path == NULL)
             return NULL;
+        if(seg.type == SEGMENT_END)
+            return v;
 
-        token_beg = token_end;
+        v = value_path_step(v, &seg, allow_build, &intern);
+        if(v == NULL)
+            return NULL;
     }
 }
 
@@ -322,6 +445,166 @@ value_build_path(VALUE* root, const char* path)
     return value_path_ex(root, path, 1);
 }
 
+VALUE_PATH*
+value_path_compile(const char* path)
+{
+    PATH_SEGMENT seg;
+    const char* p;
+    size_t n_segments = 0;
+    size_t keys_size = 0;
+    VALUE_PATH* compiled;
+    char* key_buf;
+    size_t i;
+
+    if(path == NULL)
+        return NULL;
+
+    /* Pass 1: Validate the path and measure it. */
+    p = path;
+    while(1) {
+        p = value_path_parse_segment(p, &seg);
+        if(p == NULL)
+            return NULL;
+        if(seg.type == SEGMENT_END)
+            break;
+        if(seg.type == SEGMENT_KEY)
+            keys_size += seg.key_len;
+        n_segments++;
+    }
+
+    compiled = (VALUE_PATH*) malloc(OFFSETOF(VALUE_PATH, segments) +
+                (n_segments + 1) * sizeof(PATH_SEGMENT) + keys_size);
+    if(compiled == NULL)
+        return NULL;
+    compiled->n_segments = n_segments;
+    key_buf = (char*) &compiled->segments[n_segments + 1];
+
+    /* Pass 2: Store the segments (with copies of the keys). */
+    p = path;
+    for(i = 0; i < n_segments; i++) {
+        p = value_path_parse_segment(p, &seg);
+        if(seg.type == SEGMENT_KEY) {
+            memcpy(key_buf, seg.key, seg.key_len);
+            seg.key = key_buf;
+            seg.hash = value_intern_hash(seg.key, seg.key_len);
+            seg.has_hash = 1;
+            key_buf += seg.key_len;
+        }
+        compiled->segments[i] = seg;
+    }
+    compiled->segments[n_segments].type = SEGMENT_END;
+
+    return compiled;
+}
+
+void
+value_path_free(VALUE_PATH* path)
+{
+    free(path);
+}
+
+static VALUE*
+value_path_exec_ex(VALUE* root, const VALUE_PATH* path, int allow_build)
+{
+    VALUE* v = root;
+    VALUE_INTERN* intern = NULL;
+    size_t i;
+
+    if(path == NULL)
+        return NULL;
+
+    for(i = 0; i < path->n_segments; i++) {
+        v = value_path_step(v, &path->segments[i], allow_build, &intern);
+        if(v == NULL)
+            return NULL;
+    }
+
+    return v;
+}
+
+VALUE*
+value_path_exec(VALUE* root, const VALUE_PATH* path)
+{
+    return value_path_exec_ex(root, path, 0);
+}
+
+VALUE*
+value_build_path_exec(VALUE* root, const VALUE_PATH* path)
+{
+    return value_path_exec_ex(root, path, 1);
+}
+
+static int
+value_path_segment_equal(const PATH_SEGMENT* seg1, const PATH_SEGMENT* seg2)
+{
+    if(seg1->type != seg2->type)
+        return 0;
+
+    if(seg1->type == SEGMENT_KEY) {
+        return (seg1->hash == seg2->hash  &&  seg1->key_len == seg2->key_len  &&
+                memcmp(seg1->key, seg2->key, seg1->key_len) == 0);
+    }
+
+    return (seg1->index == seg2->index);
+}
+
+/* How many leading values resolved by the previous path in the batch we
+ * remember. */
+#define PATH_BATCH_CACHE_DEPTH      32
+
+size_t
+value_path_exec_batch(VALUE* root, const VALUE_PATH* const* paths, size_t n_paths,
+                      VALUE** results)
+{
+    /* cache[k] is the value reached by the previous path after its first
+     * k segments. (cache[0] is the root.) */
+    VALUE* cache[PATH_BATCH_CACHE_DEPTH + 1];
+    size_t cache_len = 0;
+    const VALUE_PATH* prev = NULL;
+    size_t n_resolved = 0;
+    size_t i, k;
+
+    cache[0] = root;
+
+    for(i = 0; i < n_paths; i++) {
+        const VALUE_PATH* path = paths[i];
+        VALUE_INTERN* intern = NULL;
+        VALUE* v;
+
+        if(path == NULL) {
+            results[i] = NULL;
+            continue;
+        }
+
+        /* Find how much of the previous path we may reuse. */
+        k = 0;
+        if(prev != NULL) {
+            while(k < cache_len  &&  k < path->n_segments  &&
+                  value_path_segment_equal(&prev->segments[k], &path->segments[k]))
+                k++;
+        }
+
+        v = cache[k];
+        while(k < path->n_segments) {
+            v = value_path_step(v, &path->segments[k], 0, &intern);
+            if(v == NULL)
+                break;
+            k++;
+            if(k <= PATH_BATCH_CACHE_DEPTH)
+                cache[k] = v;
+        }
+
+        results[i] = v;
+        if(v != NULL)
+            n_resolved++;
+
+        prev = path;
+        cache_len = (k < PATH_BATCH_CACHE_DEPTH) ? k : PATH_BATCH_CACHE_DEPTH;
+    }
+
+    return n_resolved;
+}
+
 
 /********************
  *** Initializers ***
@@ -406,30 +689,29 @@ value_init_double(VALUE* v, double d)
     return value_init_simple(v, VALUE_DOUBLE, &d, sizeof(double));
 }
 
-int
-value_init_string_(VALUE* v, const char* str, size_t len)
+/* Size of the string payload: the length (encoded as a variable-length
+ * number), the string itself and the zero terminator. */
+static size_t
+value_string_payload_size(size_t len)
 {
-    uint8_t* payload;
-    size_t tmplen;
-    size_t off;
-
-    if(v == NULL)
-        return -1;
+    size_t tmplen = len;
+    size_t off = 0;
 
-    tmplen = len;
-    off = 0;
     while(tmplen >= 128) {
         off++;
         tmplen = tmplen >> 7;
     }
     off++;
 
-    payload = value_init(v, VALUE_STRING, off + len + 1);
-    if(payload == NULL)
-        return -1;
+    return off + len + 1;
+}
+
+static void
+value_string_encode(uint8_t* payload, const char* str, size_t len)
+{
+    size_t tmplen = len;
+    size_t off = 0;
 
-    tmplen = len;
-    off = 0;
     while(tmplen >= 128) {
         payload[off++] = 0x80 | (tmplen & 0x7f);
         tmplen = tmplen >> 7;
@@ -438,6 +720,21 @@ value_init_string_(VALUE* v, const char* str, size_t len)
 
     memcpy(payload + off, str, len);
     payload[off + len] = '\0';
+}
+
+int
+value_init_string_(VALUE* v, const char* str, size_t len)
+{
+    uint8_t* payload;
+
+    if(v == NULL)
+        return -1;
+
+    payload = value_init(v, VALUE_STRING, value_string_payload_size(len));
+    if(payload == NULL)
+        return -1;
+
+    value_string_encode(payload, str, len);
     return 0;
 }
 
@@ -463,6 +760,89 @@ value_init_array(VALUE* v)
     return 0;
 }
 
+int
+value_init_array_move(VALUE* v, VALUE* value_buf, size_t size)
+{
+    ARRAY* a;
+
+    if(value_init_array(v) != 0)
+        return -1;
+
+    a = (ARRAY*) value_payload_ex(v, sizeof(void*));
+    a->value_buf = value_buf;
+    a->size = size;
+    a->alloc = size;
+    return 0;
+}
+
+static size_t
+value_vector_elem_size_of(VALUE_TYPE type)
+{
+    switch(type) {
+        case VALUE_INT32_VECTOR:    return sizeof(int32_t);
+        case VALUE_INT64_VECTOR:    return sizeof(int64_t);
+        case VALUE_FLOAT_VECTOR:    return sizeof(float);
+        case VALUE_DOUBLE_VECTOR:   return sizeof(double);
+        default:                    return 0;
+    }
+}
+
+static int
+value_init_vector(VALUE* v, VALUE_TYPE type, const void* data, size_t size)
+{
+    size_t elem_size = value_vector_elem_size_of(type);
+    VECTOR* vec;
+
+    if(v == NULL  ||  elem_size == 0)
+        return -1;
+
+    vec = (VECTOR*) value_init_ex(v, type, sizeof(VECTOR), sizeof(void*));
+    if(vec == NULL)
+        return -1;
+    memset(vec, 0, sizeof(VECTOR));
+
+    if(size > 0) {
+        vec->buf = malloc(size * elem_size);
+        if(vec->buf == NULL) {
+            value_fini(v);
+            return -1;
+        }
+
+        if(data != NULL)
+            memcpy(vec->buf, data, size * elem_size);
+        else
+            memset(vec->buf, 0, size * elem_size);
+        vec->size = size;
+        vec->alloc = size;
+    }
+
+    return 0;
+}
+
+int
+value_init_int32_vector(VALUE* v, const int32_t* data, size_t size)
+{
+    return value_init_vector(v, VALUE_INT32_VECTOR, data, size);
+}
+
+int
+value_init_int64_vector(VALUE* v, const int64_t* data, size_t size)
+{
+    return value_init_vector(v, VALUE_INT64_VECTOR, data, size);
+}
+
+int
+value_init_float_vector(VALUE* v, const float* data, size_t size)
+{
+    return value_init_vector(v, VALUE_FLOAT_VECTOR, data, size);
+}
+
+int
+value_init_double_vector(VALUE* v, const double* data, size_t size)
+{
+    return value_init_vector(v, VALUE_DOUBLE_VECTOR, data, size);
+}
+
 int
 value_init_dict(VALUE* v)
 {
@@ -510,8 +890,13 @@ value_fini(VALUE* v)
     if(value_type(v) == VALUE_ARRAY)
         value_array_clean(v);
 
-    if(value_type(v) == VALUE_DICT)
+    if(value_vector_elem_size_of(value_type(v)) > 0)
+        free(((VECTOR*) value_payload_ex(v, sizeof(void*)))->buf);
+
+    if(value_type(v) == VALUE_DICT) {
         value_dict_clean(v);
+        value_intern_release(value_dict_intern(v));
+    }
 
     if(v->data[0] & 0x80)
         free(value_payload(v));
@@ -677,180 +1062,688 @@ value_double(const VALUE* v)
     }
 }
 
-const char*
-value_string(const VALUE* v)
+static const char*
+value_string_decode(const uint8_t* payload, size_t* p_len)
+{
+    size_t off = 0;
+    size_t len = 0;
+    unsigned shift = 0;
+
+    while(payload[off] & 0x80) {
+        len |= (size_t)(payload[off] & 0x7f) << shift;
+        shift += 7;
+        off++;
+    }
+    len |= (size_t) payload[off] << shift;
+    off++;
+
+    if(p_len != NULL)
+        *p_len = len;
+    return (const char*) payload + off;
+}
+
+const char*
+value_string(const VALUE* v)
+{
+    if(value_type(v) != VALUE_STRING)
+        return NULL;
+
+    return value_string_decode(value_payload((VALUE*) v), NULL);
+}
+
+size_t
+value_string_length(const VALUE* v)
+{
+    size_t len;
+
+    if(value_type(v) != VALUE_STRING)
+        return 0;
+
+    value_string_decode(value_payload((VALUE*) v), &len);
+    return len;
+}
+
+
+/*******************
+ *** VALUE_ARRAY ***
+ *******************/
+
+static ARRAY*
+value_array_payload(VALUE* v)
+{
+    if(value_type(v) != VALUE_ARRAY)
+        return NULL;
+
+    return (ARRAY*) value_payload_ex(v, sizeof(void*));
+}
+
+/* Finalize the value only if it may hold some resources. This makes removing
+ * of large ranges of scalar values (numbers, short strings) cheap.
+ *
+ * Note we cannot decide just by IS_MALLOCED: Where the pointers are small
+ * enough (e.g. on 32-bit platforms), ARRAY, DICT and VECTOR payloads fit into
+ * the VALUE itself, yet they own memory on the heap. */
+#define VALUE_FINI_FAST(v)                                                  \
+        do {                                                                \
+            if(value_type(v) > VALUE_STRING  ||                             \
+               ((v)->data[0] & IS_MALLOCED)  ||                             \
+               (value_type(v) == VALUE_STRING  &&                           \
+                ((v)->data[0] & IS_INTERNED)))                              \
+                value_fini(v);                                              \
+        } while(0)
+
+static int
+value_array_realloc(ARRAY* a, size_t alloc)
+{
+    VALUE* value_buf;
+
+    value_buf = (VALUE*) realloc(a->value_buf, alloc * sizeof(VALUE));
+    if(value_buf == NULL)
+        return -1;
+
+    a->value_buf = value_buf;
+    a->alloc = alloc;
+    return 0;
+}
+
+VALUE*
+value_array_get(const VALUE* v, size_t index)
+{
+    ARRAY* a = value_array_payload((VALUE*) v);
+
+    if(a != NULL  &&  index < a->size)
+        return &a->value_buf[index];
+    else
+        return NULL;
+}
+
+VALUE*
+value_array_get_all(const VALUE* v)
+{
+    ARRAY* a = value_array_payload((VALUE*) v);
+
+    if(a != NULL)
+        return a->value_buf;
+    else
+        return NULL;
+}
+
+size_t
+value_array_size(const VALUE* v)
+{
+    ARRAY* a = value_array_payload((VALUE*) v);
+
+    if(a != NULL)
+        return a->size;
+    else
+        return 0;
+}
+
+/* Make sure there is a room for n more items. */
+static int
+value_array_grow(ARRAY* a, size_t n)
+{
+    size_t alloc;
+
+    if(a->size + n <= a->alloc)
+        return 0;
+
+    /* Grow geometrically to keep appending amortized O(1) even when
+     * appending items in small batches. */
+    alloc = (a->alloc > 0) ? a->alloc + (a->alloc+1) / 2 : 1;
+    if(alloc < a->size + n)
+        alloc = a->size + n;
+
+    return value_array_realloc(a, alloc);
+}
+
+int
+value_array_reserve(VALUE* v, size_t n)
+{
+    ARRAY* a = value_array_payload(v);
+
+    if(a == NULL)
+        return -1;
+
+    if(a->size + n > a->alloc)
+        return value_array_realloc(a, a->size + n);
+    return 0;
+}
+
+void
+value_array_shrink(VALUE* v)
+{
+    ARRAY* a = value_array_payload(v);
+
+    if(a == NULL  ||  a->size == a->alloc)
+        return;
+
+    if(a->size > 0) {
+        value_array_realloc(a, a->size);
+    } else {
+        free(a->value_buf);
+        a->value_buf = NULL;
+        a->alloc = 0;
+    }
+}
+
+VALUE*
+value_array_append(VALUE* v)
+{
+    return value_array_insert_n(v, value_array_size(v), 1);
+}
+
+VALUE*
+value_array_append_n(VALUE* v, size_t n)
+{
+    return value_array_insert_n(v, value_array_size(v), n);
+}
+
+VALUE*
+value_array_insert(VALUE* v, size_t index)
+{
+    return value_array_insert_n(v, index, 1);
+}
+
+VALUE*
+value_array_insert_n(VALUE* v, size_t index, size_t n)
+{
+    ARRAY* a = value_array_payload(v);
+    size_t i;
+
+    if(a == NULL  ||  index > a->size  ||  n == 0)
+        return NULL;
+
+    if(value_array_grow(a, n) != 0)
+        return NULL;
+
+    if(index < a->size) {
+        memmove(a->value_buf + index + n, a->value_buf + index,
+                (a->size - index) * sizeof(VALUE));
+    }
+    for(i = index; i < index + n; i++)
+        value_init_new(&a->value_buf[i]);
+    a->size += n;
+    return &a->value_buf[index];
+}
+
+int
+value_array_append_move(VALUE* v, VALUE* values, size_t n)
+{
+    ARRAY* a = value_array_payload(v);
+
+    if(a == NULL)
+        return -1;
+
+    if(value_array_grow(a, n) != 0)
+        return -1;
+
+    memcpy(a->value_buf + a->size, values, n * sizeof(VALUE));
+    a->size += n;
+    return 0;
+}
+
+int
+value_array_remove(VALUE* v, size_t index)
+{
+    return value_array_remove_range(v, index, 1);
+}
+
+int
+value_array_remove_range(VALUE* v, size_t index, size_t count)
+{
+    ARRAY* a = value_array_payload(v);
+    size_t i;
+
+    if(a == NULL  ||  index + count > a->size)
+        return -1;
+
+    for(i = index; i < index + count; i++)
+        VALUE_FINI_FAST(&a->value_buf[i]);
+
+    if(index + count < a->size) {
+        memmove(a->value_buf + index, a->value_buf + index + count,
+                (a->size - (index + count)) * sizeof(VALUE));
+    }
+    a->size -= count;
+
+    if(3 * a->size < a->alloc)
+        value_array_realloc(a, a->alloc / 2);
+
+    return 0;
+}
+
+void
+value_array_clean(VALUE* v)
+{
+    ARRAY* a = value_array_payload(v);
+    size_t i;
+
+    if(a == NULL)
+        return;
+
+    for(i = 0; i < a->size; i++)
+        VALUE_FINI_FAST(&a->value_buf[i]);
+
+    free(a->value_buf);
+    memset(a, 0, sizeof(ARRAY));
+}
+
+
+/***********************
+ *** Numeric vectors ***
+ ***********************/
+
+static VECTOR*
+value_vector_payload(VALUE* v)
+{
+    if(value_vector_elem_size_of(value_type(v)) == 0)
+        return NULL;
+
+    return (VECTOR*) value_payload_ex(v, sizeof(void*));
+}
+
+static int
+value_vector_realloc(VECTOR* vec, size_t elem_size, size_t alloc)
+{
+    void* buf;
+
+    buf = realloc(vec->buf, alloc * elem_size);
+    if(buf == NULL  &&  alloc > 0)
+        return -1;
+
+    vec->buf = buf;
+    vec->alloc = alloc;
+    return 0;
+}
+
+VALUE_TYPE
+value_vector_elem_type(const VALUE* v)
+{
+    switch(value_type(v)) {
+        case VALUE_INT32_VECTOR:    return VALUE_INT32;
+        case VALUE_INT64_VECTOR:    return VALUE_INT64;
+        case VALUE_FLOAT_VECTOR:    return VALUE_FLOAT;
+        case VALUE_DOUBLE_VECTOR:   return VALUE_DOUBLE;
+        default:                    return VALUE_NULL;
+    }
+}
+
+size_t
+value_vector_size(const VALUE* v)
+{
+    VECTOR* vec = value_vector_payload((VALUE*) v);
+
+    if(vec != NULL)
+        return vec->size;
+    else
+        return 0;
+}
+
+void*
+value_vector_data(const VALUE* v)
+{
+    VECTOR* vec = value_vector_payload((VALUE*) v);
+
+    if(vec != NULL)
+        return vec->buf;
+    else
+        return NULL;
+}
+
+int32_t*
+value_int32_vector(const VALUE* v)
+{
+    if(value_type(v) != VALUE_INT32_VECTOR)
+        return NULL;
+    return (int32_t*) value_vector_data(v);
+}
+
+int64_t*
+value_int64_vector(const VALUE* v)
+{
+    if(value_type(v) != VALUE_INT64_VECTOR)
+        return NULL;
+    return (int64_t*) value_vector_data(v);
+}
+
+float*
+value_float_vector(const VALUE* v)
 {
-    uint8_t* payload;
-    size_t off = 0;
+    if(value_type(v) != VALUE_FLOAT_VECTOR)
+        return NULL;
+    return (float*) value_vector_data(v);
+}
 
-    if(value_type(v) != VALUE_STRING)
+double*
+value_double_vector(const VALUE* v)
+{
+    if(value_type(v) != VALUE_DOUBLE_VECTOR)
         return NULL;
+    return (double*) value_vector_data(v);
+}
 
-    payload = value_payload((VALUE*) v);
-    while(payload[off] & 0x80)
-        off++;
-    off++;
+int
+value_vector_reserve(VALUE* v, size_t n)
+{
+    VECTOR* vec = value_vector_payload(v);
+
+    if(vec == NULL)
+        return -1;
 
-    return (char*) payload + off;
+    if(vec->size + n > vec->alloc) {
+        return value_vector_realloc(vec,
+                value_vector_elem_size_of(value_type(v)), vec->size + n);
+    }
+    return 0;
 }
 
-size_t
-value_string_length(const VALUE* v)
+int
+value_vector_resize(VALUE* v, size_t size)
 {
-    uint8_t* payload;
-    size_t off = 0;
-    size_t len = 0;
-    unsigned shift = 0;
+    VECTOR* vec = value_vector_payload(v);
+    size_t elem_size = value_vector_elem_size_of(value_type(v));
 
-    if(value_type(v) != VALUE_STRING)
-        return 0;
+    if(vec == NULL)
+        return -1;
 
-    payload = value_payload((VALUE*) v);
-    while(payload[off] & 0x80) {
-        len |= (payload[off] & 0x7f) << shift;
-        shift += 7;
-        off++;
+    if(size > vec->alloc) {
+        if(value_vector_realloc(vec, elem_size, size) != 0)
+            return -1;
     }
-    len |= payload[off] << shift;
 
-    return len;
+    if(size > vec->size)
+        memset((uint8_t*) vec->buf + vec->size * elem_size, 0, (size - vec->size) * elem_size);
+    vec->size = size;
+    return 0;
 }
 
+int
+value_vector_append(VALUE* v, const void* data, size_t n)
+{
+    VECTOR* vec = value_vector_payload(v);
+    size_t elem_size = value_vector_elem_size_of(value_type(v));
 
-/*******************
- *** VALUE_ARRAY ***
- *******************/
+    if(vec == NULL)
+        return -1;
 
-static ARRAY*
-value_array_payload(VALUE* v)
+    if(vec->size + n > vec->alloc) {
+        size_t alloc = vec->alloc + (vec->alloc+1) / 2;
+
+        if(alloc < vec->size + n)
+            alloc = vec->size + n;
+        if(value_vector_realloc(vec, elem_size, alloc) != 0)
+            return -1;
+    }
+
+    memcpy((uint8_t*) vec->buf + vec->size * elem_size, data, n * elem_size);
+    vec->size += n;
+    return 0;
+}
+
+int
+value_vector_remove_range(VALUE* v, size_t index, size_t count)
 {
-    if(value_type(v) != VALUE_ARRAY)
-        return NULL;
+    VECTOR* vec = value_vector_payload(v);
+    size_t elem_size = value_vector_elem_size_of(value_type(v));
 
-    return (ARRAY*) value_payload_ex(v, sizeof(void*));
+    if(vec == NULL  ||  index + count > vec->size)
+        return -1;
+
+    if(index + count < vec->size) {
+        memmove((uint8_t*) vec->buf + index * elem_size,
+                (uint8_t*) vec->buf + (index + count) * elem_size,
+                (vec->size - (index + count)) * elem_size);
+    }
+    vec->size -= count;
+    return 0;
 }
 
-static int
-value_array_realloc(ARRAY* a, size_t alloc)
+int
+value_vector_to_array(VALUE* v)
 {
+    VECTOR* vec = value_vector_payload(v);
+    VALUE_TYPE type = value_type(v);
     VALUE* value_buf;
+    VALUE tmp;
+    size_t i;
 
-    value_buf = (VALUE*) realloc(a->value_buf, alloc * sizeof(VALUE));
+    if(vec == NULL)
+        return -1;
+
+    value_buf = (VALUE*) malloc((vec->size > 0 ? vec->size : 1) * sizeof(VALUE));
     if(value_buf == NULL)
         return -1;
 
-    a->value_buf = value_buf;
-    a->alloc = alloc;
+    for(i = 0; i < vec->size; i++) {
+        switch(type) {
+            case VALUE_INT32_VECTOR:    value_init_int32(&value_buf[i], ((int32_t*) vec->buf)[i]); break;
+            case VALUE_INT64_VECTOR:    value_init_int64(&value_buf[i], ((int64_t*) vec->buf)[i]); break;
+            case VALUE_FLOAT_VECTOR:    value_init_float(&value_buf[i], ((float*) vec->buf)[i]); break;
+            case VALUE_DOUBLE_VECTOR:   value_init_double(&value_buf[i], ((double*) vec->buf)[i]); break;
+            default:                    break;
+        }
+    }
+
+    if(value_init_array_move(&tmp, value_buf, vec->size) != 0) {
+        free(value_buf);
+        return -1;
+    }
+
+    value_fini(v);
+    memcpy(v, &tmp, sizeof(VALUE));
     return 0;
 }
 
-VALUE*
-value_array_get(const VALUE* v, size_t index)
+int
+value_array_to_vector(VALUE* v, VALUE_TYPE vector_type)
 {
-    ARRAY* a = value_array_payload((VALUE*) v);
+    VALUE tmp;
+    VECTOR* vec;
+    VALUE* items;
+    size_t size;
+    size_t i;
 
-    if(a != NULL  &&  index < a->size)
-        return &a->value_buf[index];
-    else
-        return NULL;
+    if(value_type(v) != VALUE_ARRAY)
+        return -1;
+
+    if(value_init_vector(&tmp, vector_type, NULL, value_array_size(v)) != 0)
+        return -1;
+    vec = value_vector_payload(&tmp);
+    items = value_array_get_all(v);
+    size = value_array_size(v);
+
+    for(i = 0; i < size; i++) {
+        if(!value_is_compatible(&items[i], value_vector_elem_type(&tmp))) {
+            value_fini(&tmp);
+            return -1;
+        }
+
+        switch(vector_type) {
+            case VALUE_INT32_VECTOR:    ((int32_t*) vec->buf)[i] = value_int32(&items[i]); break;
+            case VALUE_INT64_VECTOR:    ((int64_t*) vec->buf)[i] = value_int64(&items[i]); break;
+            case VALUE_FLOAT_VECTOR:    ((float*) vec->buf)[i] = value_float(&items[i]); break;
+            case VALUE_DOUBLE_VECTOR:   ((double*) vec->buf)[i] = value_double(&items[i]); break;
+            default:                    break;
+        }
+    }
+
+    value_fini(v);
+    memcpy(v, &tmp, sizeof(VALUE));
+    return 0;
 }
 
-VALUE*
-value_array_get_all(const VALUE* v)
+
+/*********************
+ *** Key interning ***
+ *********************/
+
+#define INTERN_ENTRY_FROM_PAYLOAD(ptr)                                      \
+        ((INTERN_ENTRY*) ((uint8_t*)(ptr) - OFFSETOF(INTERN_ENTRY, payload)))
+
+#define INTERN_INIT_BUCKET_COUNT    64
+
+static uint32_t
+value_intern_hash(const char* str, size_t len)
 {
-    ARRAY* a = value_array_payload((VALUE*) v);
+    return fnv1a_32(FNV1A_BASE_32, str, len);
+}
 
-    if(a != NULL)
-        return a->value_buf;
-    else
+VALUE_INTERN*
+value_intern_create(void)
+{
+    VALUE_INTERN* intern;
+
+    intern = (VALUE_INTERN*) malloc(sizeof(VALUE_INTERN));
+    if(intern == NULL)
         return NULL;
+
+    memset(intern, 0, sizeof(VALUE_INTERN));
+    intern->refs = 1;
+    return intern;
 }
 
-size_t
-value_array_size(const VALUE* v)
+static void
+value_intern_ref(VALUE_INTERN* intern)
 {
-    ARRAY* a = value_array_payload((VALUE*) v);
+    intern->refs++;
+}
 
-    if(a != NULL)
-        return a->size;
-    else
-        return 0;
+void
+value_intern_release(VALUE_INTERN* intern)
+{
+    if(intern == NULL)
+        return;
+
+    intern->refs--;
+    if(intern->refs > 0)
+        return;
+
+    /* All dictionaries using the table are gone so there are no entries
+     * anymore. */
+    free(intern->buckets);
+    free(intern);
 }
 
-VALUE*
-value_array_append(VALUE* v)
+size_t
+value_intern_size(const VALUE_INTERN* intern)
 {
-    return value_array_insert(v, value_array_size(v));
+    if(intern == NULL)
+        return 0;
+
+    return intern->size;
 }
 
-VALUE*
-value_array_insert(VALUE* v, size_t index)
+static INTERN_ENTRY*
+value_intern_lookup(const VALUE_INTERN* intern, const char* str, size_t len, uint32_t hash)
 {
-    ARRAY* a = value_array_payload(v);
+    INTERN_ENTRY* entry;
+    const char* entry_str;
+    size_t entry_len;
 
-    if(a == NULL  ||  index > a->size)
+    if(intern->bucket_count == 0)
         return NULL;
 
-    if(a->size >= a->alloc) {
-        if(value_array_realloc(a, (a->alloc > 0)
-                    ? a->alloc + (a->alloc+1) / 2
-                    : 1) != 0)
-            return NULL;
-    }
-
-    if(index < a->size) {
-        memmove(a->value_buf + index + 1, a->value_buf + index,
-                (a->size - index) * sizeof(VALUE));
+    entry = intern->buckets[hash & (intern->bucket_count - 1)];
+    while(entry != NULL) {
+        if(entry->hash == hash) {
+            entry_str = value_string_decode(entry->payload, &entry_len);
+            if(entry_len == len  &&  memcmp(entry_str, str, len) == 0)
+                return entry;
+        }
+        entry = entry->next;
     }
-    value_init_new(&a->value_buf[index]);
-    a->size++;
-    return &a->value_buf[index];
-}
 
-int
-value_array_remove(VALUE* v, size_t index)
-{
-    return value_array_remove_range(v, index, 1);
+    return NULL;
 }
 
-int
-value_array_remove_range(VALUE* v, size_t index, size_t count)
+static int
+value_intern_rehash(VALUE_INTERN* intern, size_t bucket_count)
 {
-    ARRAY* a = value_array_payload(v);
+    INTERN_ENTRY** buckets;
+    INTERN_ENTRY* entry;
+    INTERN_ENTRY* next;
     size_t i;
 
-    if(a == NULL  ||  index + count > a->size)
+    buckets = (INTERN_ENTRY**) malloc(bucket_count * sizeof(INTERN_ENTRY*));
+    if(buckets == NULL)
         return -1;
+    memset(buckets, 0, bucket_count * sizeof(INTERN_ENTRY*));
+
+    for(i = 0; i < intern->bucket_count; i++) {
+        entry = intern->buckets[i];
+        while(entry != NULL) {
+            next = entry->next;
+            entry->next = buckets[entry->hash & (bucket_count - 1)];
+            buckets[entry->hash & (bucket_count - 1)] = entry;
+            entry = next;
+        }
+    }
 
-    for(i = index; i < index + count; i++)
-        value_fini(&a->value_buf[i]);
+    free(intern->buckets);
+    intern->buckets = buckets;
+    intern->bucket_count = bucket_count;
+    return 0;
+}
 
-    if(index + count < a->size) {
-        memmove(a->value_buf + index, a->value_buf + index + count,
-                (a->size - (index + count)) * sizeof(VALUE));
+/* Get the entry for the given string (creating it if needed) and increment
+ * its reference counter. */
+static INTERN_ENTRY*
+value_intern_acquire_entry(VALUE_INTERN* intern, const char* str, size_t len, uint32_t hash)
+{
+    INTERN_ENTRY* entry;
+    INTERN_ENTRY** bucket;
+
+    entry = value_intern_lookup(intern, str, len, hash);
+    if(entry != NULL) {
+        entry->refs++;
+        return entry;
     }
-    a->size -= count;
 
-    if(3 * a->size < a->alloc)
-        value_array_realloc(a, a->alloc / 2);
+    if(intern->size >= intern->bucket_count) {
+        if(value_intern_rehash(intern, (intern->bucket_count > 0)
+                    ? 2 * intern->bucket_count
+                    : INTERN_INIT_BUCKET_COUNT) != 0)
+        {
+            /* With existing buckets we may just live with longer chains. */
+            if(intern->bucket_count == 0)
+                return NULL;
+        }
+    }
 
-    return 0;
+    entry = (INTERN_ENTRY*) malloc(OFFSETOF(INTERN_ENTRY, payload) +
+                                   value_string_payload_size(len));
+    if(entry == NULL)
+        return NULL;
+
+    value_string_encode(entry->payload, str, len);
+    entry->hash = hash;
+    entry->refs = 1;
+
+    bucket = &intern->buckets[hash & (intern->bucket_count - 1)];
+    entry->next = *bucket;
+    *bucket = entry;
+    intern->size++;
+
+    return entry;
 }
 
-void
-value_array_clean(VALUE* v)
+static void
+value_intern_release_entry(VALUE_INTERN* intern, INTERN_ENTRY* entry)
 {
-    ARRAY* a = value_array_payload(v);
-    size_t i;
+    INTERN_ENTRY** link;
 
-    if(a == NULL)
+    entry->refs--;
+    if(entry->refs > 0)
         return;
 
-    for(i = 0; i < a->size; i++)
-        value_fini(&a->value_buf[i]);
+    link = &intern->buckets[entry->hash & (intern->bucket_count - 1)];
+    while(*link != entry)
+        link = &(*link)->next;
+    *link = entry->next;
 
-    free(a->value_buf);
-    memset(a, 0, sizeof(ARRAY));
+    intern->size--;
+    free(entry);
 }
 
 
@@ -873,6 +1766,38 @@ value_dict_payload(VALUE* v)
     return (DICT*) value_payload_ex(v, sizeof(void*));
 }
 
+static VALUE_INTERN*
+value_dict_intern_table(const VALUE* v, const DICT* d)
+{
+    return (v->data[0] & HAS_INTERN) ? d->intern : NULL;
+}
+
+/* If the dictionary uses an intern table, look up the key in it. Note that
+ * (unless a custom comparator is used) a key which is not interned cannot be
+ * present in the dictionary.
+ *
+ * Returns the interned payload of the key, or NULL. */
+static const uint8_t*
+value_dict_lookup_interned(const DICT* d, const char* key, size_t key_len, uint32_t hash)
+{
+    INTERN_ENTRY* entry;
+
+    entry = value_intern_lookup(d->intern, key, key_len, hash);
+    return (entry != NULL) ? entry->payload : NULL;
+}
+
+static void
+value_dict_fini_key(DICT* d, RBTREE* node)
+{
+    if(node->key.data[0] & IS_INTERNED) {
+        value_intern_release_entry(d->intern,
+                INTERN_ENTRY_FROM_PAYLOAD(value_payload(&node->key)));
+        node->key.data[0] = VALUE_NULL;
+    } else {
+        value_fini(&node->key);
+    }
+}
+
 static int
 value_dict_default_cmp(const char* key1, size_t len1, const char* key2, size_t len2)
 {
@@ -930,6 +1855,57 @@ value_dict_flags(const VALUE* v)
     return flags;
 }
 
+int
+value_dict_set_intern(VALUE* v, VALUE_INTERN* intern)
+{
+    DICT* d = value_dict_payload(v);
+
+    if(d == NULL  ||  d->size > 0)
+        return -1;
+
+    if(!(v->data[0] & (HAS_ORDERLIST | HAS_CUSTOMCMP | HAS_INTERN))) {
+        /* We need the full DICT structure to store the pointer. The small
+         * one may live inside the VALUE (if pointers are small enough), so
+         * we cannot just realloc() it. */
+        DICT* full;
+
+        full = (DICT*) malloc(sizeof(DICT));
+        if(full == NULL)
+            return -1;
+        memcpy(full, d, OFFSETOF(DICT, order_head));
+        memset(&full->order_head, 0, sizeof(DICT) - OFFSETOF(DICT, order_head));
+        if(v->data[0] & IS_MALLOCED)
+            free(d);
+        d = full;
+        *((void**) &v->data[sizeof(void*)]) = d;
+        v->data[0] |= IS_MALLOCED;
+    }
+
+    if(intern != NULL)
+        value_intern_ref(intern);
+    if(v->data[0] & HAS_INTERN)
+        value_intern_release(d->intern);
+
+    d->intern = intern;
+    if(intern != NULL)
+        v->data[0] |= HAS_INTERN;
+    else
+        v->data[0] &= ~HAS_INTERN;
+
+    return 0;
+}
+
+VALUE_INTERN*
+value_dict_intern(const VALUE* v)
+{
+    DICT* d = value_dict_payload((VALUE*) v);
+
+    if(d == NULL)
+        return NULL;
+
+    return value_dict_intern_table(v, d);
+}
+
 size_t
 value_dict_size(const VALUE* v)
 {
@@ -983,14 +1959,27 @@ value_dict_keys_ordered(const VALUE* v, const VALUE** buffer, size_t buffer_size
     return n;
 }
 
-VALUE*
-value_dict_get_(const VALUE* v, const char* key, size_t key_len)
+/* If p_hash is not NULL, it provides precomputed value_intern_hash() of the
+ * key. */
+static VALUE*
+value_dict_get_ex(const VALUE* v, const char* key, size_t key_len, const uint32_t* p_hash)
 {
     DICT* d = value_dict_payload((VALUE*) v);
     RBTREE* node = (d != NULL) ? d->root : NULL;
+    const uint8_t* interned = NULL;
     int cmp;
 
+    if(d != NULL  &&  value_dict_intern_table(v, d) != NULL) {
+        interned = value_dict_lookup_interned(d, key, key_len,
+                (p_hash != NULL) ? *p_hash : value_intern_hash(key, key_len));
+        if(interned == NULL  &&  !(v->data[0] & HAS_CUSTOMCMP))
+            return NULL;
+    }
+
     while(node != NULL) {
+        if(interned != NULL  &&  value_payload(&node->key) == interned)
+            return &node->value;
+
         cmp = value_dict_cmp(v, d, key, key_len, value_string(&node->key), value_string_length(&node->key));
 
         if(cmp < 0)
@@ -1004,6 +1993,12 @@ value_dict_get_(const VALUE* v, const char* key, size_t key_len)
     return NULL;
 }
 
+VALUE*
+value_dict_get_(const VALUE* v, const char* key, size_t key_len)
+{
+    return value_dict_get_ex(v, key, key_len, NULL);
+}
+
 VALUE*
 value_dict_get(const VALUE* v, const char* key)
 {
@@ -1128,19 +2123,31 @@ value_dict_add(VALUE* v, const char* key)
     return value_dict_add_(v, key, strlen(key));
 }
 
-VALUE*
-value_dict_get_or_add_(VALUE* v, const char* key, size_t key_len)
+/* If p_hash is not NULL, it provides precomputed value_intern_hash() of the
+ * key. */
+static VALUE*
+value_dict_get_or_add_ex(VALUE* v, const char* key, size_t key_len, const uint32_t* p_hash)
 {
     DICT* d = value_dict_payload((VALUE*) v);
     RBTREE* node = (d != NULL) ? d->root : NULL;
     RBTREE* path[RBTREE_MAX_HEIGHT];
     int path_len = 0;
+    const uint8_t* interned = NULL;
+    uint32_t hash = 0;
     int cmp;
 
     if(d == NULL)
         return NULL;
 
+    if(value_dict_intern_table(v, d) != NULL) {
+        hash = (p_hash != NULL) ? *p_hash : value_intern_hash(key, key_len);
+        interned = value_dict_lookup_interned(d, key, key_len, hash);
+    }
+
     while(node != NULL) {
+        if(interned != NULL  &&  value_payload(&node->key) == interned)
+            return &node->value;
+
         cmp = value_dict_cmp(v, d, key, key_len,
                 value_string(&node->key), value_string_length(&node->key));
 
@@ -1159,7 +2166,17 @@ value_dict_get_or_add_(VALUE* v, const char* key, size_t key_len)
                 sizeof(RBTREE) : OFFSETOF(RBTREE, order_prev));
     if(node == NULL)
         return NULL;
-    if(value_init_string_(&node->key, key, key_len) != 0) {
+    if(value_dict_intern_table(v, d) != NULL) {
+        INTERN_ENTRY* entry;
+
+        entry = value_intern_acquire_entry(d->intern, key, key_len, hash);
+        if(entry == NULL) {
+            free(node);
+            return NULL;
+        }
+        node->key.data[0] = ((uint8_t) VALUE_STRING) | IS_INTERNED;
+        *((void**) &node->key.data[sizeof(void*)]) = entry->payload;
+    } else if(value_init_string_(&node->key, key, key_len) != 0) {
         free(node);
         return NULL;
     }
@@ -1199,6 +2216,12 @@ value_dict_get_or_add_(VALUE* v, const char* key, size_t key_len)
     return &node->value;
 }
 
+VALUE*
+value_dict_get_or_add_(VALUE* v, const char* key, size_t key_len)
+{
+    return value_dict_get_or_add_ex(v, key, key_len, NULL);
+}
+
 VALUE*
 value_dict_get_or_add(VALUE* v, const char* key)
 {
@@ -1296,10 +2319,23 @@ value_dict_remove_(VALUE* v, const char* key, size_t key_len)
     RBTREE* single_child;
     RBTREE* path[RBTREE_MAX_HEIGHT];
     int path_len = 0;
+    const uint8_t* interned = NULL;
     int cmp;
 
+    if(d != NULL  &&  value_dict_intern_table(v, d) != NULL) {
+        interned = value_dict_lookup_interned(d, key, key_len,
+                value_intern_hash(key, key_len));
+        if(interned == NULL  &&  !(v->data[0] & HAS_CUSTOMCMP))
+            return -1;
+    }
+
     /* Find the node to remove. */
     while(node != NULL) {
+        if(interned != NULL  &&  value_payload(&node->key) == interned) {
+            path[path_len++] = node;
+            break;
+        }
+
         cmp = value_dict_cmp(v, d, key, key_len,
                 value_string(&node->key), value_string_length(&node->key));
 
@@ -1407,7 +2443,7 @@ value_dict_remove_(VALUE* v, const char* key, size_t key_len)
         else
             d->order_tail = node->order_prev;
     }
-    value_fini(&node->key);
+    value_dict_fini_key(d, node);
     value_fini(&node->value);
     free(node);
     d->size--;
@@ -1485,7 +2521,7 @@ value_dict_clean(VALUE* v)
         node = stack[--stack_size];
         right = node->right;
 
-        value_fini(&node->key);
+        value_dict_fini_key(d, node);
         value_fini(&node->value);
         free(node);
 
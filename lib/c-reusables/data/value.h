@@ -59,7 +59,11 @@ typedef enum VALUE_TYPE {
     VALUE_DOUBLE,
     VALUE_STRING,
     VALUE_ARRAY,
-    VALUE_DICT
+    VALUE_DICT,
+    VALUE_INT32_VECTOR,
+    VALUE_INT64_VECTOR,
+    VALUE_FLOAT_VECTOR,
+    VALUE_DOUBLE_VECTOR
 } VALUE_TYPE;
 
 
@@ -168,6 +172,41 @@ VALUE* value_path(VALUE* root, const char* path);
  */
 VALUE* value_build_path(VALUE* root, const char* path);
 
+/* Compiled path.
+ *
+ * When the same path is resolved many times (e.g. against many records of
+ * the same structure), the application may compile it once with
+ * value_path_compile() and then resolve it with value_path_exec() or
+ * value_build_path_exec(). These behave the same way as value_path() and
+ * value_build_path() respectively, but they do not parse the path string
+ * and they do not allocate any memory (unless building new values).
+ *
+ * value_path_compile() copies everything it needs from the path string, so
+ * the caller does not need to keep the string alive. It returns NULL if the
+ * path is malformed (i.e. it could never be resolved) or on an out-of-memory
+ * situation. Release the compiled path with value_path_free() when no longer
+ * needed.
+ */
+typedef struct VALUE_PATH_tag VALUE_PATH;
+
+VALUE_PATH* value_path_compile(const char* path);
+void value_path_free(VALUE_PATH* path);
+
+VALUE* value_path_exec(VALUE* root, const VALUE_PATH* path);
+VALUE* value_build_path_exec(VALUE* root, const VALUE_PATH* path);
+
+/* Resolve many compiled paths at once. The value for paths[i] is stored into
+ * results[i] (NULL if the path does not exist, same as value_path_exec()).
+ *
+ * When consecutive paths in the array share a common prefix (e.g. "foo/bar/a"
+ * and "foo/bar/b"), the prefix is walked only once. Hence it is a good idea to
+ * sort the paths so that paths with common prefixes are adjacent.
+ *
+ * Returns count of paths successfully resolved.
+ */
+size_t value_path_exec_batch(VALUE* root, const VALUE_PATH* const* paths,
+                             size_t n_paths, VALUE** results);
+
 
 /******************
  *** VALUE_NULL ***
@@ -284,6 +323,16 @@ size_t value_string_length(const VALUE* v);
  */
 int value_init_array(VALUE* v);
 
+/* Initialize the value as an array, taking over the ownership of the given
+ * C array of size values. The C array has to be allocated with malloc(); the
+ * values in it have to be already initialized. (On success, the array frees
+ * it when no longer needed. On failure, the ownership stays with the caller.)
+ *
+ * This is the fastest way how to populate a large array when the application
+ * can build it by itself.
+ */
+int value_init_array_move(VALUE* v, VALUE* value_buf, size_t size);
+
 /* Get count of items in the array.
  */
 size_t value_array_size(const VALUE* v);
@@ -301,6 +350,28 @@ VALUE* value_array_get_all(const VALUE* v);
 VALUE* value_array_append(VALUE* v);
 VALUE* value_array_insert(VALUE* v, size_t index);
 
+/* Append/insert n new items at once. Returns pointer to the first of them;
+ * the others follow it contiguously in memory.
+ */
+VALUE* value_array_append_n(VALUE* v, size_t n);
+VALUE* value_array_insert_n(VALUE* v, size_t index, size_t n);
+
+/* Append n already initialized values from the C array. The values are moved
+ * (i.e. the array takes over all the resources they hold): The caller must not
+ * call value_fini() for them anymore, but it remains responsible for releasing
+ * the C array itself.
+ */
+int value_array_append_move(VALUE* v, VALUE* values, size_t n);
+
+/* Make sure n more items can be added without reallocation of the internal
+ * buffer.
+ */
+int value_array_reserve(VALUE* v, size_t n);
+
+/* Release any unused capacity of the internal buffer.
+ */
+void value_array_shrink(VALUE* v);
+
 /* Remove an item (or range of items).
  */
 int value_array_remove(VALUE* v, size_t index);
@@ -311,6 +382,82 @@ int value_array_remove_range(VALUE* v, size_t index, size_t count);
 void value_array_clean(VALUE* v);
 
 
+/***********************
+ *** Numeric vectors ***
+ ***********************/
+
+/* Vectors are packed arrays of numbers of the same type. Unlike VALUE_ARRAY,
+ * which needs whole VALUE for each item, the numbers are stored directly in
+ * a contiguous C array. Hence they consume much less memory, and application
+ * may process them efficiently (e.g. with SIMD instructions).
+ *
+ * Note the items of a vector are not VALUEs. Therefore value_path() cannot be
+ * used to reach them.
+ */
+
+/* Initialize the value as a vector of the given size, and fill it with a copy
+ * of the data. If data is NULL, the vector is filled with zeros.
+ */
+int value_init_int32_vector(VALUE* v, const int32_t* data, size_t size);
+int value_init_int64_vector(VALUE* v, const int64_t* data, size_t size);
+int value_init_float_vector(VALUE* v, const float* data, size_t size);
+int value_init_double_vector(VALUE* v, const double* data, size_t size);
+
+/* Get type of the vector items, i.e. one of VALUE_INT32, VALUE_INT64,
+ * VALUE_FLOAT or VALUE_DOUBLE. (VALUE_NULL is returned if the value is not
+ * a vector.)
+ */
+VALUE_TYPE value_vector_elem_type(const VALUE* v);
+
+/* Get count of items in the vector.
+ */
+size_t value_vector_size(const VALUE* v);
+
+/* Get pointer to the internal C array of the vector items. The typed variants
+ * return NULL if the vector is not of the respective type.
+ *
+ * The application may modify the items directly through the pointer.
+ * (But the pointer is invalidated by any operation changing size of the
+ * vector.)
+ */
+void* value_vector_data(const VALUE* v);
+int32_t* value_int32_vector(const VALUE* v);
+int64_t* value_int64_vector(const VALUE* v);
+float* value_float_vector(const VALUE* v);
+double* value_double_vector(const VALUE* v);
+
+/* Make sure n more items can be added without reallocation.
+ */
+int value_vector_reserve(VALUE* v, size_t n);
+
+/* Change count of items. New items (if any) are set to zero.
+ */
+int value_vector_resize(VALUE* v, size_t size);
+
+/* Append n items. The data has to point to a C array of the vector's item
+ * type.
+ */
+int value_vector_append(VALUE* v, const void* data, size_t n);
+
+/* Remove a range of items.
+ */
+int value_vector_remove_range(VALUE* v, size_t index, size_t count);
+
+/* Convert the vector, in place, into VALUE_ARRAY of the numeric values
+ * of the respective type.
+ */
+int value_vector_to_array(VALUE* v);
+
+/* Convert the array, in place, into the vector of the given type
+ * (VALUE_INT32_VECTOR etc.).
+ *
+ * This fails (and the array is left intact) if any of the array items is
+ * not a numeric value compatible (in the sense of value_is_compatible())
+ * with the vector's item type.
+ */
+int value_array_to_vector(VALUE* v, VALUE_TYPE vector_type);
+
+
 /******************
  *** VALUE_DICT ***
  ******************/
@@ -408,6 +555,52 @@ int value_dict_walk_sorted(const VALUE* v,
  */
 void value_dict_clean(VALUE* v);
 
+/* Key interning.
+ *
+ * Application may create an intern table and attach it to dictionaries. All
+ * dictionaries sharing the same table store each distinct key only once: e.g.
+ * for an array of thousands of JSON-like records (with the same set of keys),
+ * every key string is allocated once instead of once per record.
+ *
+ * Keys of dictionaries using the table are compared by a pointer when looking
+ * for an exact match, and a lookup of a key which is not present in the
+ * intern table at all fails without walking the tree.
+ *
+ * The intern table is reference-counted. value_intern_create() returns a new
+ * table holding one reference (owned by the caller) and every dictionary using
+ * the table holds another one. Hence the caller may call
+ * value_intern_release() as soon as it has attached the table to all
+ * dictionaries it is interested in.
+ *
+ * The table can be attached only to an empty dictionary.
+ *
+ * value_build_path() attaches the table of the nearest ancestor dictionary to
+ * all the dictionaries it creates. Therefore attaching the table to the root
+ * dictionary is enough when the hierarchy is populated that way.
+ *
+ * Note the intern table is not thread-safe. All the dictionaries sharing it
+ * must be accessed from a single thread (or the application has to serialize
+ * the access to them).
+ */
+typedef struct VALUE_INTERN_tag VALUE_INTERN;
+
+VALUE_INTERN* value_intern_create(void);
+void value_intern_release(VALUE_INTERN* intern);
+
+/* Get count of distinct strings currently interned in the table.
+ */
+size_t value_intern_size(const VALUE_INTERN* intern);
+
+/* Attach the intern table to the dictionary (or detach it if intern is NULL).
+ *
+ * Fails if the dictionary is not empty.
+ */
+int value_dict_set_intern(VALUE* v, VALUE_INTERN* intern);
+
+/* Get the intern table attached to the dictionary (or NULL if none).
+ */
+VALUE_INTERN* value_dict_intern(const VALUE* v);
+
 
 #ifdef __cplusplus
 }
@@ -30,30 +30,639 @@
 #include <string.h>
 
 
-static const BASE64_OPTIONS base64_def_options = { '+', '/', '=' };
+/* SIMD kernels. BASE64_X86 gets defined if we know how to compile the SSSE3
+ * and AVX2 code (whether the CPU supports it is checked at run time).
+ * BASE64_NEON is for ARM64, where NEON is always available. */
+#if defined(__x86_64__) || defined(_M_X64)
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #include <intrin.h>
+        #include <immintrin.h>
+        #define BASE64_X86              1
+        #define BASE64_TARGET_SSSE3
+        #define BASE64_TARGET_AVX2
+    #elif defined(__clang__) || (defined(__GNUC__) && \
+                (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)))
+        #include <cpuid.h>
+        #include <immintrin.h>
+        #define BASE64_X86              1
+        #define BASE64_TARGET_SSSE3     __attribute__((target("ssse3")))
+        #define BASE64_TARGET_AVX2      __attribute__((target("avx2")))
+    #endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #include <arm_neon.h>
+    #define BASE64_NEON                 1
+#endif
+
+
+#ifdef CRE_TEST
+/* Allows tests to disable some SIMD kernels:
+ * bit 0 = SSSE3, bit 1 = AVX2 (i.e. the BASE64_CPU_xxx flags below). */
+unsigned base64_test_cpu_mask = ~0u;
+#endif
+
+static const BASE64_OPTIONS base64_def_options = { '+', '/', '=', 0 };
 
 static const char base64_table_core[62] =
             "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789";
 
 
+/* Everything the kernels need to know about the dialect. */
+typedef struct BASE64_CTX {
+    const BASE64_OPTIONS* options;
+    char enc_table[64];
+    uint8_t dec_table[256];     /* 0xff for invalid characters. */
+    int simd_decode_ok;         /* ch62 and ch63 are usable by SIMD decoders. */
+} BASE64_CTX;
+
+static int
+base64_is_alnum(char ch)
+{
+    return (('A' <= ch && ch <= 'Z') || ('a' <= ch && ch <= 'z') ||
+            ('0' <= ch && ch <= '9'));
+}
+
+static void
+base64_ctx_init(BASE64_CTX* ctx, const BASE64_OPTIONS* options, int for_decode)
+{
+    int i;
+
+    ctx->options = options;
+
+    memcpy(ctx->enc_table, base64_table_core, 62);
+    ctx->enc_table[62] = options->ch62;
+    ctx->enc_table[63] = options->ch63;
+
+    if(for_decode) {
+        memset(ctx->dec_table, 0xff, 256);
+        for(i = 0; i < 62; i++)
+            ctx->dec_table[(uint8_t) base64_table_core[i]] = i;
+        ctx->dec_table[(uint8_t) options->ch62] = 62;
+        ctx->dec_table[(uint8_t) options->ch63] = 63;
+
+        /* The SIMD decoders classify characters by ranges, so they cannot
+         * handle a dialect which (re)uses alphanumeric or non-ASCII chars. */
+        ctx->simd_decode_ok = ((uint8_t) options->ch62 < 0x80  &&
+                               (uint8_t) options->ch63 < 0x80  &&
+                               options->ch62 != options->ch63  &&
+                               !base64_is_alnum(options->ch62)  &&
+                               !base64_is_alnum(options->ch63));
+    }
+}
+
+
+/*******************************
+ ***   Scalar block coding   ***
+ *******************************/
+
+/* Encode n bytes (n must be divisible by 3). */
+static void
+base64_encode_scalar(const BASE64_CTX* ctx, const uint8_t* in, unsigned n, char* out)
+{
+    const char* table = ctx->enc_table;
+    unsigned v;
+
+    while(n >= 3) {
+        v = ((unsigned) in[0] << 16) | ((unsigned) in[1] << 8) | in[2];
+
+        out[0] = table[(v >> 18) & 0x3f];
+        out[1] = table[(v >> 12) & 0x3f];
+        out[2] = table[(v >>  6) & 0x3f];
+        out[3] = table[(v      ) & 0x3f];
+
+        in += 3;
+        out += 4;
+        n -= 3;
+    }
+}
+
+/* Decode whole quads of characters until an invalid one is met. Returns
+ * count of consumed characters (divisible by 4). */
+static unsigned
+base64_decode_scalar(const BASE64_CTX* ctx, const char* in, unsigned n, uint8_t* out)
+{
+    const uint8_t* table = ctx->dec_table;
+    unsigned off = 0;
+    unsigned v0, v1, v2, v3;
+
+    while(off + 4 <= n) {
+        v0 = table[(uint8_t) in[off+0]];
+        v1 = table[(uint8_t) in[off+1]];
+        v2 = table[(uint8_t) in[off+2]];
+        v3 = table[(uint8_t) in[off+3]];
+        if((v0 | v1 | v2 | v3) & 0x80)
+            break;
+
+        out[0] = (uint8_t) ((v0 << 2) | (v1 >> 4));
+        out[1] = (uint8_t) ((v1 << 4) | (v2 >> 2));
+        out[2] = (uint8_t) ((v2 << 6) | v3);
+
+        off += 4;
+        out += 3;
+    }
+
+    return off;
+}
+
+
+/******************************
+ ***   x86 SSSE3 and AVX2   ***
+ ******************************/
+
+#ifdef BASE64_X86
+
+/* Encoding follows the approach of Wojciech Muła
+ * (http://0x80.pl/articles/index.html#base64-algorithm-new):
+ *
+ *  1. Shuffle 12 input bytes so each 32-bit lane holds 3 bytes.
+ *  2. Use multiplications to move the four 6-bit fields into four bytes.
+ *  3. Translate the 6-bit values into characters by adding an offset picked
+ *     with PSHUFB from a 16-entry table by the range the value falls in.
+ *
+ * Decoding classifies the characters with range comparisons (so that any
+ * ch62 and ch63 can be supported), and packs the 6-bit values back with
+ * multiply-add instructions.
+ */
+
+BASE64_TARGET_SSSE3 static __m128i
+base64_ssse3_enc_reshuffle(__m128i in)
+{
+    __m128i t0, t1, t2, t3;
+
+    in = _mm_shuffle_epi8(in, _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+    t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+    t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+    t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+    t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+    return _mm_or_si128(t1, t3);
+}
+
+BASE64_TARGET_SSSE3 static __m128i
+base64_ssse3_enc_translate(__m128i idx, __m128i lut)
+{
+    /* 0 for 26..51 ('a'-'z'), 1..10 for 52..61 ('0'-'9'), 11 for 62,
+     * 12 for 63, and 13 for 0..25 ('A'-'Z'). */
+    __m128i sel = _mm_subs_epu8(idx, _mm_set1_epi8(51));
+    __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), idx);
+
+    sel = _mm_or_si128(sel, _mm_and_si128(less, _mm_set1_epi8(13)));
+    return _mm_add_epi8(idx, _mm_shuffle_epi8(lut, sel));
+}
+
+static __m128i
+base64_x86_enc_lut(const BASE64_CTX* ctx)
+{
+    char ch62_off = (char) (ctx->enc_table[62] - 62);
+    char ch63_off = (char) (ctx->enc_table[63] - 63);
+
+    return _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                         '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                         '0' - 52, ch62_off, ch63_off, 'A', 0, 0);
+}
+
+BASE64_TARGET_SSSE3 static unsigned
+base64_encode_ssse3(const BASE64_CTX* ctx, const uint8_t* in, unsigned n, char* out)
+{
+    __m128i lut = base64_x86_enc_lut(ctx);
+    unsigned off = 0;
+
+    /* Each iteration consumes 12 bytes, but loads 16. */
+    while(off + 16 <= n) {
+        __m128i v = _mm_loadu_si128((const __m128i*) (in + off));
+
+        v = base64_ssse3_enc_translate(base64_ssse3_enc_reshuffle(v), lut);
+        _mm_storeu_si128((__m128i*) out, v);
+
+        off += 12;
+        out += 16;
+    }
+
+    return off;
+}
+
+BASE64_TARGET_AVX2 static unsigned
+base64_encode_avx2(const BASE64_CTX* ctx, const uint8_t* in, unsigned n, char* out)
+{
+    __m128i lut128 = base64_x86_enc_lut(ctx);
+    __m256i lut = _mm256_broadcastsi128_si256(lut128);
+    __m256i shuf = _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+                                    1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+    unsigned off = 0;
+
+    /* Each iteration consumes 24 bytes, but loads 28. */
+    while(off + 28 <= n) {
+        __m256i v, t0, t1, t2, t3, sel, less;
+
+        v = _mm256_inserti128_si256(_mm256_castsi128_si256(
+                    _mm_loadu_si128((const __m128i*) (in + off))),
+                    _mm_loadu_si128((const __m128i*) (in + off + 12)), 1);
+
+        v = _mm256_shuffle_epi8(v, shuf);
+        t0 = _mm256_and_si256(v, _mm256_set1_epi32(0x0fc0fc00));
+        t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+        t2 = _mm256_and_si256(v, _mm256_set1_epi32(0x003f03f0));
+        t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+        v = _mm256_or_si256(t1, t3);
+
+        sel = _mm256_subs_epu8(v, _mm256_set1_epi8(51));
+        less = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), v);
+        sel = _mm256_or_si256(sel, _mm256_and_si256(less, _mm256_set1_epi8(13)));
+        v = _mm256_add_epi8(v, _mm256_shuffle_epi8(lut, sel));
+
+        _mm256_storeu_si256((__m256i*) out, v);
+
+        off += 24;
+        out += 32;
+    }
+
+    return off;
+}
+
+BASE64_TARGET_SSSE3 static unsigned
+base64_decode_ssse3(const BASE64_CTX* ctx, const char* in, unsigned n,
+                    uint8_t* out, unsigned out_avail)
+{
+    const __m128i ch62 = _mm_set1_epi8(ctx->options->ch62);
+    const __m128i ch63 = _mm_set1_epi8(ctx->options->ch63);
+    const __m128i pack = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    unsigned off = 0;
+
+    /* Each iteration writes 16 bytes, of which 12 are valid. */
+    while(off + 16 <= n  &&  out_avail >= 16) {
+        __m128i c = _mm_loadu_si128((const __m128i*) (in + off));
+        __m128i m_upper, m_lower, m_digit, m_62, m_63, v;
+
+        /* Signed comparisons: Non-ASCII bytes are negative so they fall out
+         * of all the ranges. */
+        m_upper = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('A' - 1)),
+                                _mm_cmplt_epi8(c, _mm_set1_epi8('Z' + 1)));
+        m_lower = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('a' - 1)),
+                                _mm_cmplt_epi8(c, _mm_set1_epi8('z' + 1)));
+        m_digit = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('0' - 1)),
+                                _mm_cmplt_epi8(c, _mm_set1_epi8('9' + 1)));
+        m_62 = _mm_cmpeq_epi8(c, ch62);
+        m_63 = _mm_cmpeq_epi8(c, ch63);
+
+        if(_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(m_upper, m_lower),
+                    _mm_or_si128(m_digit, _mm_or_si128(m_62, m_63)))) != 0xffff)
+            break;
+
+        v = _mm_and_si128(m_upper, _mm_sub_epi8(c, _mm_set1_epi8('A')));
+        v = _mm_or_si128(v, _mm_and_si128(m_lower, _mm_sub_epi8(c, _mm_set1_epi8('a' - 26))));
+        v = _mm_or_si128(v, _mm_and_si128(m_digit, _mm_sub_epi8(c, _mm_set1_epi8('0' - 52))));
+        v = _mm_or_si128(v, _mm_and_si128(m_62, _mm_set1_epi8(62)));
+        v = _mm_or_si128(v, _mm_and_si128(m_63, _mm_set1_epi8(63)));
+
+        /* Pack the 6-bit values: [00aaaaaa 00bbbbbb 00cccccc 00dddddd] ->
+         * 24-bit integer in each 32-bit lane -> 12 bytes. */
+        v = _mm_maddubs_epi16(v, _mm_set1_epi32(0x01400140));
+        v = _mm_madd_epi16(v, _mm_set1_epi32(0x00011000));
+        v = _mm_shuffle_epi8(v, pack);
+        _mm_storeu_si128((__m128i*) out, v);
+
+        off += 16;
+        out += 12;
+        out_avail -= 12;
+    }
+
+    return off;
+}
+
+BASE64_TARGET_AVX2 static unsigned
+base64_decode_avx2(const BASE64_CTX* ctx, const char* in, unsigned n,
+                   uint8_t* out, unsigned out_avail)
+{
+    const __m256i ch62 = _mm256_set1_epi8(ctx->options->ch62);
+    const __m256i ch63 = _mm256_set1_epi8(ctx->options->ch63);
+    const __m256i pack = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                                          2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    const __m256i perm = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7);
+    unsigned off = 0;
+
+    /* Each iteration writes 32 bytes, of which 24 are valid. */
+    while(off + 32 <= n  &&  out_avail >= 32) {
+        __m256i c = _mm256_loadu_si256((const __m256i*) (in + off));
+        __m256i m_upper, m_lower, m_digit, m_62, m_63, v;
+
+        m_upper = _mm256_andnot_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8('Z')),
+                                      _mm256_cmpgt_epi8(c, _mm256_set1_epi8('A' - 1)));
+        m_lower = _mm256_andnot_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8('z')),
+                                      _mm256_cmpgt_epi8(c, _mm256_set1_epi8('a' - 1)));
+        m_digit = _mm256_andnot_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8('9')),
+                                      _mm256_cmpgt_epi8(c, _mm256_set1_epi8('0' - 1)));
+        m_62 = _mm256_cmpeq_epi8(c, ch62);
+        m_63 = _mm256_cmpeq_epi8(c, ch63);
+
+        if(_mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(m_upper, m_lower),
+                    _mm256_or_si256(m_digit, _mm256_or_si256(m_62, m_63)))) != -1)
+            break;
+
+        v = _mm256_and_si256(m_upper, _mm256_sub_epi8(c, _mm256_set1_epi8('A')));
+        v = _mm256_or_si256(v, _mm256_and_si256(m_lower, _mm256_sub_epi8(c, _mm256_set1_epi8('a' - 26))));
+        v = _mm256_or_si256(v, _mm256_and_si256(m_digit, _mm256_sub_epi8(c, _mm256_set1_epi8('0' - 52))));
+        v = _mm256_or_si256(v, _mm256_and_si256(m_62, _mm256_set1_epi8(62)));
+        v = _mm256_or_si256(v, _mm256_and_si256(m_63, _mm256_set1_epi8(63)));
+
+        v = _mm256_maddubs_epi16(v, _mm256_set1_epi32(0x01400140));
+        v = _mm256_madd_epi16(v, _mm256_set1_epi32(0x00011000));
+        v = _mm256_shuffle_epi8(v, pack);
+        v = _mm256_permutevar8x32_epi32(v, perm);
+        _mm256_storeu_si256((__m256i*) out, v);
+
+        off += 32;
+        out += 24;
+        out_avail -= 24;
+    }
+
+    return off;
+}
+
+#define BASE64_CPU_SSSE3    0x1
+#define BASE64_CPU_AVX2     0x2
+
+static unsigned
+base64_x86_detect(void)
+{
+    unsigned features = 0;
+    unsigned ecx1, ebx7;
+    int os_avx = 0;
+
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+
+    __cpuid(info, 0);
+    if(info[0] < 7)
+        return 0;
+    __cpuid(info, 1);
+    ecx1 = (unsigned) info[2];
+    __cpuidex(info, 7, 0);
+    ebx7 = (unsigned) info[1];
+    if((ecx1 & (1u << 27))  &&  (ecx1 & (1u << 28)))
+        os_avx = ((_xgetbv(0) & 0x6) == 0x6);
+#else
+    unsigned eax, ebx, ecx, edx;
+
+    if(__get_cpuid_max(0, NULL) < 7)
+        return 0;
+    __cpuid(1, eax, ebx, ecx, edx);
+    ecx1 = ecx;
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+    ebx7 = ebx;
+    if((ecx1 & (1u << 27))  &&  (ecx1 & (1u << 28))) {
+        /* OSXSAVE and AVX: Check the OS preserves the YMM registers. */
+        unsigned xcr0_lo, xcr0_hi;
+        __asm__ ("xgetbv" : "=a" (xcr0_lo), "=d" (xcr0_hi) : "c" (0));
+        os_avx = ((xcr0_lo & 0x6) == 0x6);
+    }
+#endif
+
+    if(ecx1 & (1u << 9))
+        features |= BASE64_CPU_SSSE3;
+    if(os_avx  &&  (ebx7 & (1u << 5)))
+        features |= BASE64_CPU_AVX2;
+    return features;
+}
+
+static unsigned
+base64_x86_cpu_features(void)
+{
+    /* Racy but harmless: All threads compute the same value. */
+    static int features = -1;
+
+    if(features < 0)
+        features = (int) base64_x86_detect();
+#ifdef CRE_TEST
+    return (unsigned) features & base64_test_cpu_mask;
+#else
+    return (unsigned) features;
+#endif
+}
+
+#endif  /* #ifdef BASE64_X86 */
+
+
+/****************
+ ***   NEON   ***
+ ****************/
+
+#ifdef BASE64_NEON
+
+static unsigned
+base64_encode_neon(const BASE64_CTX* ctx, const uint8_t* in, unsigned n, char* out)
+{
+    const uint8_t* table = (const uint8_t*) ctx->enc_table;
+    const uint8x16_t mask = vdupq_n_u8(0x3f);
+    uint8x16x4_t lut;
+    unsigned off = 0;
+
+    lut.val[0] = vld1q_u8(table);
+    lut.val[1] = vld1q_u8(table + 16);
+    lut.val[2] = vld1q_u8(table + 32);
+    lut.val[3] = vld1q_u8(table + 48);
+
+    /* De-interleaving loads and interleaving stores do all the shuffling. */
+    while(off + 48 <= n) {
+        uint8x16x3_t src = vld3q_u8(in + off);
+        uint8x16x4_t dst;
+
+        dst.val[0] = vshrq_n_u8(src.val[0], 2);
+        dst.val[1] = vandq_u8(vorrq_u8(vshrq_n_u8(src.val[1], 4), vshlq_n_u8(src.val[0], 4)), mask);
+        dst.val[2] = vandq_u8(vorrq_u8(vshrq_n_u8(src.val[2], 6), vshlq_n_u8(src.val[1], 2)), mask);
+        dst.val[3] = vandq_u8(src.val[2], mask);
+
+        dst.val[0] = vqtbl4q_u8(lut, dst.val[0]);
+        dst.val[1] = vqtbl4q_u8(lut, dst.val[1]);
+        dst.val[2] = vqtbl4q_u8(lut, dst.val[2]);
+        dst.val[3] = vqtbl4q_u8(lut, dst.val[3]);
+
+        vst4q_u8((uint8_t*) out, dst);
+
+        off += 48;
+        out += 64;
+    }
+
+    return off;
+}
+
+static unsigned
+base64_decode_neon(const BASE64_CTX* ctx, const char* in, unsigned n,
+                   uint8_t* out, unsigned out_avail)
+{
+    const uint8_t* table = ctx->dec_table;
+    const uint8x16_t c64 = vdupq_n_u8(64);
+    const uint8x16_t c128 = vdupq_n_u8(128);
+    uint8x16x4_t lut_lo, lut_hi;
+    unsigned off = 0;
+    int i;
+
+    /* Table for characters 0 ... 127 in two halves. (This works for any
+     * ASCII ch62 and ch63 as the table is the generic one.) */
+    for(i = 0; i < 4; i++) {
+        lut_lo.val[i] = vld1q_u8(table + 16 * i);
+        lut_hi.val[i] = vld1q_u8(table + 64 + 16 * i);
+    }
+
+    while(off + 64 <= n  &&  out_avail >= 48) {
+        uint8x16x4_t src = vld4q_u8((const uint8_t*) in + off);
+        uint8x16x3_t dst;
+        uint8x16_t v[4];
+        uint8x16_t bad;
+
+        for(i = 0; i < 4; i++) {
+            v[i] = vqtbl4q_u8(lut_lo, src.val[i]);
+            v[i] = vqtbx4q_u8(v[i], lut_hi, vsubq_u8(src.val[i], c64));
+            /* Non-ASCII bytes: Both lookups are out of range. */
+            v[i] = vorrq_u8(v[i], vcgeq_u8(src.val[i], c128));
+        }
+
+        bad = vorrq_u8(vorrq_u8(v[0], v[1]), vorrq_u8(v[2], v[3]));
+        if(vmaxvq_u8(bad) > 63)
+            break;
+
+        dst.val[0] = vorrq_u8(vshlq_n_u8(v[0], 2), vshrq_n_u8(v[1], 4));
+        dst.val[1] = vorrq_u8(vshlq_n_u8(v[1], 4), vshrq_n_u8(v[2], 2));
+        dst.val[2] = vorrq_u8(vshlq_n_u8(v[2], 6), v[3]);
+        vst3q_u8(out, dst);
+
+        off += 64;
+        out += 48;
+        out_avail -= 48;
+    }
+
+    return off;
+}
+
+#endif  /* #ifdef BASE64_NEON */
+
+
+/**************************
+ ***   Block dispatch   ***
+ **************************/
+
+/* Encode n bytes (divisible by 3) into n / 3 * 4 characters. */
+static void
+base64_encode_block(const BASE64_CTX* ctx, const uint8_t* in, unsigned n, char* out)
+{
+    unsigned off = 0;
+
+#if defined BASE64_X86
+    unsigned cpu = base64_x86_cpu_features();
+
+    if(cpu & BASE64_CPU_AVX2)
+        off = base64_encode_avx2(ctx, in, n, out);
+    else if(cpu & BASE64_CPU_SSSE3)
+        off = base64_encode_ssse3(ctx, in, n, out);
+#elif defined BASE64_NEON
+    off = base64_encode_neon(ctx, in, n, out);
+#endif
+
+    base64_encode_scalar(ctx, in + off, n - off, out + off / 3 * 4);
+}
+
+/* Decode whole quads of characters until an invalid one (or padding) is met,
+ * or until the output space runs out. Returns count of consumed characters
+ * (divisible by 4). */
+static unsigned
+base64_decode_block(const BASE64_CTX* ctx, const char* in, unsigned n,
+                    uint8_t* out, unsigned out_avail)
+{
+    unsigned off = 0;
+
+    if(n / 4 * 3 > out_avail)
+        n = out_avail / 3 * 4;
+
+#if defined BASE64_X86
+    if(ctx->simd_decode_ok) {
+        unsigned cpu = base64_x86_cpu_features();
+
+        if(cpu & BASE64_CPU_AVX2)
+            off = base64_decode_avx2(ctx, in, n, out, out_avail);
+        else if(cpu & BASE64_CPU_SSSE3)
+            off = base64_decode_ssse3(ctx, in, n, out, out_avail);
+    }
+#elif defined BASE64_NEON
+    off = base64_decode_neon(ctx, in, n, out, out_avail);
+#endif
+
+    return off + base64_decode_scalar(ctx, in + off, n - off, out + off / 4 * 3);
+}
+
+
+/*************************
+ ***   Line wrapping   ***
+ *************************/
+
+/* Count line breaks needed when n more characters are appended to a line
+ * already holding line_pos characters. (A break is only emitted in front of
+ * a character, so there is never a trailing one.) */
+static unsigned
+base64_count_breaks(unsigned line_pos, unsigned n, unsigned line_width)
+{
+    unsigned first;
+
+    if(line_width == 0  ||  n == 0)
+        return 0;
+
+    /* Count multiples of line_width in [max(line_pos, 1), line_pos + n - 1]. */
+    first = (line_pos > 0) ? line_pos : 1;
+    return (line_pos + n - 1) / line_width - (first - 1) / line_width;
+}
+
+/* Insert line breaks in place into the n characters in buf (the buffer must
+ * be large enough for them). Returns the new length and updates *p_line_pos. */
+static unsigned
+base64_wrap(char* buf, unsigned n, unsigned* p_line_pos, unsigned line_width)
+{
+    unsigned breaks;
+    unsigned src_end, dst_end;
+    unsigned seg_len;
+    unsigned i;
+
+    if(line_width == 0  ||  n == 0)
+        return n;
+
+    breaks = base64_count_breaks(*p_line_pos, n, line_width);
+    *p_line_pos = (*p_line_pos + n - 1) % line_width + 1;
+
+    /* Move the lines from the end so nothing gets overwritten. The last
+     * (possibly incomplete) line is as long as the new line_pos. */
+    src_end = n;
+    dst_end = n + 2 * breaks;
+    seg_len = *p_line_pos;
+    for(i = 0; i < breaks; i++) {
+        src_end -= seg_len;
+        dst_end -= seg_len;
+        memmove(buf + dst_end, buf + src_end, seg_len);
+        buf[--dst_end] = '\n';
+        buf[--dst_end] = '\r';
+        seg_len = line_width;
+    }
+
+    return n + 2 * breaks;
+}
+
+
+/************************
+ ***   One-shot API   ***
+ ************************/
+
 int
 base64_encode(const void* in_buf, unsigned in_size,
               char* out_buf, unsigned out_size,
               const BASE64_OPTIONS* options)
 {
-    char table[64];
+    BASE64_CTX ctx;
     const uint8_t* in = (const uint8_t*) in_buf;
     char* out = out_buf;
     unsigned out_size_needed;
-    unsigned in_off = 0;
-    unsigned out_off = 0;
+    unsigned in_off;
+    unsigned out_off;
+    unsigned line_pos = 0;
     unsigned v;
 
     if(options == NULL)
         options = &base64_def_options;
 
-    /* Every three bytes are encoded into 4 characters of output.
-     * Finally add +1 for zero terminator. */
+    /* Every three bytes are encoded into 4 characters of output. */
     out_size_needed = ((in_size + 2) / 3) * 4;
 
     /* With padding disabled, we may need little less. */
@@ -65,6 +674,9 @@ base64_encode(const void* in_buf, unsigned in_size,
         }
     }
 
+    /* Line breaks. */
+    out_size_needed += 2 * base64_count_breaks(0, out_size_needed, options->line_width);
+
     if(out_buf == NULL) {
         /* Recommend caller +1 for zero terminator. */
         return out_size_needed + 1;
@@ -74,31 +686,21 @@ base64_encode(const void* in_buf, unsigned in_size,
     if(out_size < out_size_needed)
         return -ENOBUFS;
 
-    /* Build table. */
-    memcpy(table, base64_table_core, 62);
-    table[62] = options->ch62;
-    table[63] = options->ch63;
-
-    /* Main loop. We process triples of input bytes at once to avoid branches
-     * inside the loop and handle indivisible tail below specially. */
-    while(in_off + 3 <= in_size) {
-        v  = ((unsigned) in[in_off++]) << 16;
-        v |= ((unsigned) in[in_off++]) <<  8;
-        v |= ((unsigned) in[in_off++]);
+    base64_ctx_init(&ctx, options, 0);
 
-        out[out_off++] = table[(uint8_t)(v >> 18) & 0x3f];
-        out[out_off++] = table[(uint8_t)(v >> 12) & 0x3f];
-        out[out_off++] = table[(uint8_t)(v >>  6) & 0x3f];
-        out[out_off++] = table[(uint8_t)(v      ) & 0x3f];
-    }
+    /* Main part. We process triples of input bytes at once and handle the
+     * indivisible tail below specially. */
+    in_off = in_size / 3 * 3;
+    base64_encode_block(&ctx, in, in_off, out);
+    out_off = in_off / 3 * 4;
 
     /* Process a tail of one or two remaining input bytes.
      * Note one-byte tail corresponds to two characters in output,
      * and two-byte tail to three characters of output. */
     if(in_off + 1 == in_size) {                     /* One-byte tail. */
         v = ((unsigned) in[in_off++]) << 16;
-        out[out_off++] = table[(uint8_t)(v >> 18) & 0x3f];
-        out[out_off++] = table[(uint8_t)(v >> 12) & 0x3f];
+        out[out_off++] = ctx.enc_table[(v >> 18) & 0x3f];
+        out[out_off++] = ctx.enc_table[(v >> 12) & 0x3f];
 
         /* Add two padding chars. */
         if(options->pad) {
@@ -108,15 +710,17 @@ base64_encode(const void* in_buf, unsigned in_size,
     } else if(in_off + 2 == in_size) {              /* Two-byte tail. */
         v = ((unsigned) in[in_off++]) << 16;
         v |= ((unsigned) in[in_off++]) << 8;
-        out[out_off++] = table[(uint8_t)(v >> 18) & 0x3f];
-        out[out_off++] = table[(uint8_t)(v >> 12) & 0x3f];
-        out[out_off++] = table[(uint8_t)(v >>  6) & 0x3f];
+        out[out_off++] = ctx.enc_table[(v >> 18) & 0x3f];
+        out[out_off++] = ctx.enc_table[(v >> 12) & 0x3f];
+        out[out_off++] = ctx.enc_table[(v >>  6) & 0x3f];
 
         /* Add one padding char. */
         if(options->pad)
             out[out_off++] = options->pad;
     }
 
+    out_off = base64_wrap(out, out_off, &line_pos, options->line_width);
+
     /* Add terminator. */
     if(out_off < out_size)
         out[out_off] = '\0';
@@ -129,8 +733,7 @@ base64_decode(const char* in_buf, unsigned in_size,
               void* out_buf, unsigned out_size,
               const BASE64_OPTIONS* options)
 {
-    uint8_t table[256];
-    int i;
+    BASE64_CTX ctx;
     const char* in = in_buf;
     uint8_t* out = (uint8_t*) out_buf;
     unsigned out_size_needed;
@@ -141,6 +744,22 @@ base64_decode(const char* in_buf, unsigned in_size,
     if(options == NULL)
         options = &base64_def_options;
 
+    /* Multi-line input: Let the streaming decoder deal with line breaks. */
+    if(options->line_width != 0) {
+        BASE64_DECODER dec;
+        int n, ret;
+
+        base64_decoder_init(&dec, options);
+        n = base64_decoder_update(&dec, in_buf, in_size, out_buf, out_size);
+        if(n < 0)
+            return n;
+        ret = base64_decoder_finish(&dec, (out_buf != NULL) ? out + n : NULL,
+                                    (out_buf != NULL) ? out_size - n : 0);
+        if(ret < 0)
+            return ret;
+        return n + ret;
+    }
+
     /* Ignore any padding. */
     if(options->pad != '\0'  &&  in_size > 0  &&  in_size % 4 == 0) {
         /* Valid Base64 can have up to two characters of padding. */
@@ -150,18 +769,7 @@ base64_decode(const char* in_buf, unsigned in_size,
             in_size--;
     }
 
-    /* Build table. */
-    memset(table, 0xff, 256);
-    for(i = 0; i < 62; i++)
-        table[(int) base64_table_core[i]] = i;
-    table[(int) options->ch62] = 62;
-    table[(int) options->ch63] = 63;
-
-    /* Validate the input. */
-    for(in_off = 0; in_off < in_size; in_off++) {
-        if(table[(int) in[in_off]] == 0xff)
-            return -EINVAL;
-    }
+    base64_ctx_init(&ctx, options, 1);
 
     /* Every four characters are decoded into 3 bytes of output.
      * Note that on the end only certain values may appear from encoding
@@ -175,49 +783,362 @@ base64_decode(const char* in_buf, unsigned in_size,
             break;
 
         case 2:
-            if(table[(int) in[in_size-1]] & 0x4f)
+            if(ctx.dec_table[(uint8_t) in[in_size-1]] & 0x4f)
                 return -EINVAL;
             out_size_needed += 1;
             break;
 
         case 3:
-            if(table[(int) in[in_size-1]] & 0xc3)
+            if(ctx.dec_table[(uint8_t) in[in_size-1]] & 0xc3)
                 return -EINVAL;
             out_size_needed += 2;
             break;
     }
 
-    if(out_buf == NULL)
+    if(out_buf == NULL) {
+        /* Validate the input. */
+        for(in_off = 0; in_off < in_size; in_off++) {
+            if(ctx.dec_table[(uint8_t) in[in_off]] == 0xff)
+                return -EINVAL;
+        }
         return out_size_needed;
+    }
 
     /* Check we have enough space in the output. */
     if(out_size < out_size_needed)
         return -ENOBUFS;
 
-    /* Main loop. */
-    in_off = 0;
-    while(in_off + 4 <= in_size) {
-        v  = (unsigned)table[(int) in[in_off++]] << 18;
-        v |= (unsigned)table[(int) in[in_off++]] << 12;
-        v |= (unsigned)table[(int) in[in_off++]] << 6;
-        v |= (unsigned)table[(int) in[in_off++]];
-
-        out[out_off++] = (v >> 16) & 0xff;
-        out[out_off++] = (v >>  8) & 0xff;
-        out[out_off++] = (v      ) & 0xff;
-    }
+    /* Main part. It stops on the first invalid character. */
+    in_off = base64_decode_block(&ctx, in, in_size / 4 * 4, out, out_size);
+    if(in_off < in_size / 4 * 4)
+        return -EINVAL;
+    out_off = in_off / 4 * 3;
 
     if(in_off + 2 == in_size) {
-        v  = (unsigned)table[(int) in[in_off++]] << 18;
-        v |= (unsigned)table[(int) in[in_off++]] << 12;
+        if((ctx.dec_table[(uint8_t) in[in_off]] | ctx.dec_table[(uint8_t) in[in_off+1]]) & 0x80)
+            return -EINVAL;
+        v  = (unsigned)ctx.dec_table[(uint8_t) in[in_off++]] << 18;
+        v |= (unsigned)ctx.dec_table[(uint8_t) in[in_off++]] << 12;
         out[out_off++] = (v >> 16) & 0xff;
     } else if(in_off + 3 == in_size) {
-        v  = (unsigned)table[(int) in[in_off++]] << 18;
-        v |= (unsigned)table[(int) in[in_off++]] << 12;
-        v |= (unsigned)table[(int) in[in_off++]] << 6;
+        if((ctx.dec_table[(uint8_t) in[in_off]] | ctx.dec_table[(uint8_t) in[in_off+1]] |
+            ctx.dec_table[(uint8_t) in[in_off+2]]) & 0x80)
+            return -EINVAL;
+        v  = (unsigned)ctx.dec_table[(uint8_t) in[in_off++]] << 18;
+        v |= (unsigned)ctx.dec_table[(uint8_t) in[in_off++]] << 12;
+        v |= (unsigned)ctx.dec_table[(uint8_t) in[in_off++]] << 6;
         out[out_off++] = (v >> 16) & 0xff;
         out[out_off++] = (v >>  8) & 0xff;
     }
 
     return out_off;
 }
+
+
+/*************************
+ ***   Streaming API   ***
+ *************************/
+
+void
+base64_encoder_init(BASE64_ENCODER* enc, const BASE64_OPTIONS* options)
+{
+    if(options == NULL)
+        options = &base64_def_options;
+
+    memcpy(&enc->options, options, sizeof(BASE64_OPTIONS));
+    enc->tail_len = 0;
+    enc->line_pos = 0;
+}
+
+int
+base64_encoder_update(BASE64_ENCODER* enc, const void* in_buf, unsigned in_size,
+                      char* out_buf, unsigned out_size)
+{
+    BASE64_CTX ctx;
+    const uint8_t* in = (const uint8_t*) in_buf;
+    unsigned total = enc->tail_len + in_size;
+    unsigned n_chars = total / 3 * 4;
+    unsigned out_size_needed;
+    unsigned in_off = 0;
+    unsigned out_off = 0;
+    unsigned n;
+
+    out_size_needed = n_chars + 2 * base64_count_breaks(enc->line_pos,
+                                        n_chars, enc->options.line_width);
+    if(out_buf == NULL)
+        return out_size_needed;
+    if(out_size < out_size_needed)
+        return -ENOBUFS;
+
+    if(total < 3) {
+        /* Not enough for a complete triple: Just remember the bytes. */
+        memcpy(enc->tail + enc->tail_len, in, in_size);
+        enc->tail_len = total;
+        return 0;
+    }
+
+    base64_ctx_init(&ctx, &enc->options, 0);
+
+    /* Complete the triple started in a previous call. */
+    if(enc->tail_len > 0) {
+        uint8_t triple[3];
+
+        in_off = 3 - enc->tail_len;
+        memcpy(triple, enc->tail, enc->tail_len);
+        memcpy(triple + enc->tail_len, in, in_off);
+        base64_encode_scalar(&ctx, triple, 3, out_buf);
+        out_off = 4;
+    }
+
+    n = (in_size - in_off) / 3 * 3;
+    base64_encode_block(&ctx, in + in_off, n, out_buf + out_off);
+    in_off += n;
+    out_off += n / 3 * 4;
+
+    enc->tail_len = in_size - in_off;
+    memcpy(enc->tail, in + in_off, enc->tail_len);
+
+    return base64_wrap(out_buf, out_off, &enc->line_pos, enc->options.line_width);
+}
+
+int
+base64_encoder_finish(BASE64_ENCODER* enc, char* out_buf, unsigned out_size)
+{
+    unsigned n_chars;
+    unsigned out_size_needed;
+    int ret;
+
+    switch(enc->tail_len) {
+        case 1:     n_chars = (enc->options.pad ? 4 : 2); break;
+        case 2:     n_chars = (enc->options.pad ? 4 : 3); break;
+        default:    n_chars = 0; break;
+    }
+
+    out_size_needed = n_chars + 2 * base64_count_breaks(enc->line_pos,
+                                        n_chars, enc->options.line_width);
+    if(out_buf == NULL)
+        return out_size_needed;
+    if(out_size < out_size_needed)
+        return -ENOBUFS;
+
+    /* Reuse the one-shot encoder for the tail (it handles the padding). */
+    if(n_chars > 0) {
+        BASE64_OPTIONS options;
+        char tmp[8];
+
+        memcpy(&options, &enc->options, sizeof(BASE64_OPTIONS));
+        options.line_width = 0;
+        base64_encode(enc->tail, enc->tail_len, tmp, sizeof(tmp), &options);
+        memcpy(out_buf, tmp, n_chars);
+    }
+
+    ret = base64_wrap(out_buf, n_chars, &enc->line_pos, enc->options.line_width);
+
+    /* Reset, so the encoder is ready for a new stream. */
+    enc->tail_len = 0;
+    enc->line_pos = 0;
+    return ret;
+}
+
+
+void
+base64_decoder_init(BASE64_DECODER* dec, const BASE64_OPTIONS* options)
+{
+    if(options == NULL)
+        options = &base64_def_options;
+
+    memcpy(&dec->options, options, sizeof(BASE64_OPTIONS));
+    dec->quad_len = 0;
+    dec->pad_len = 0;
+}
+
+/* Count occurrences of ch in buf. (memchr() is fast as the chars we look for
+ * are sparse.) */
+static unsigned
+base64_count_char(const char* buf, unsigned n, char ch)
+{
+    const char* end = buf + n;
+    unsigned count = 0;
+
+    while(buf < end) {
+        buf = (const char*) memchr(buf, ch, end - buf);
+        if(buf == NULL)
+            break;
+        buf++;
+        count++;
+    }
+
+    return count;
+}
+
+/* Feed one character into the decoder state machine. Returns count of bytes
+ * produced into out (which may be NULL for a dry run), or -EINVAL.
+ *
+ * The state is (quad_len, pad_len): quad_len counts characters of the current
+ * quad (including padding ones), pad_len counts the padding characters seen.
+ * pad_len != 0 and quad_len == 0 means the padded end has been reached. */
+static int
+base64_decoder_feed(BASE64_DECODER* dec, const BASE64_CTX* ctx, char ch, uint8_t* out)
+{
+    unsigned v;
+
+    if(dec->options.line_width != 0  &&  (ch == '\r' || ch == '\n'))
+        return 0;
+
+    if(dec->options.pad != '\0'  &&  ch == dec->options.pad) {
+        /* Padding can only fill up the last one or two chars of a quad. */
+        if(dec->quad_len < 2)
+            return -EINVAL;
+
+        dec->quad_len++;
+        dec->pad_len++;
+        if(dec->quad_len < 4)
+            return 0;
+
+        /* Unused bits of the last data char must be zero. */
+        dec->quad_len = 0;
+        if(dec->pad_len == 2) {
+            if(dec->quad[1] & 0x0f)
+                return -EINVAL;
+            if(out != NULL)
+                out[0] = (uint8_t) ((dec->quad[0] << 2) | (dec->quad[1] >> 4));
+            return 1;
+        } else {
+            if(dec->quad[2] & 0x03)
+                return -EINVAL;
+            if(out != NULL) {
+                out[0] = (uint8_t) ((dec->quad[0] << 2) | (dec->quad[1] >> 4));
+                out[1] = (uint8_t) ((dec->quad[1] << 4) | (dec->quad[2] >> 2));
+            }
+            return 2;
+        }
+    }
+
+    /* No data may follow the padding. */
+    v = ctx->dec_table[(uint8_t) ch];
+    if(v == 0xff  ||  dec->pad_len != 0)
+        return -EINVAL;
+
+    dec->quad[dec->quad_len++] = (unsigned char) v;
+    if(dec->quad_len < 4)
+        return 0;
+
+    dec->quad_len = 0;
+    if(out != NULL) {
+        out[0] = (uint8_t) ((dec->quad[0] << 2) | (dec->quad[1] >> 4));
+        out[1] = (uint8_t) ((dec->quad[1] << 4) | (dec->quad[2] >> 2));
+        out[2] = (uint8_t) ((dec->quad[2] << 6) | dec->quad[3]);
+    }
+    return 3;
+}
+
+int
+base64_decoder_update(BASE64_DECODER* dec, const char* in_buf, unsigned in_size,
+                      void* out_buf, unsigned out_size)
+{
+    BASE64_CTX ctx;
+    uint8_t* out = (uint8_t*) out_buf;
+    unsigned in_off = 0;
+    unsigned out_off = 0;
+    unsigned n_data = in_size;
+    int n;
+
+    base64_ctx_init(&ctx, &dec->options, 1);
+
+    /* Count the characters which may produce some output. */
+    if(dec->options.line_width != 0) {
+        n_data -= base64_count_char(in_buf, in_size, '\r');
+        n_data -= base64_count_char(in_buf, in_size, '\n');
+    }
+
+    /* Unless the output buffer is large enough for the worst case, we have
+     * to find out the exact size by a dry run to not consume anything in the
+     * case of -ENOBUFS. */
+    if(out_buf == NULL  ||  out_size < (dec->quad_len + n_data) / 4 * 3) {
+        BASE64_DECODER tmp;
+        unsigned out_size_needed = 0;
+
+        memcpy(&tmp, dec, sizeof(BASE64_DECODER));
+        for(in_off = 0; in_off < in_size; in_off++) {
+            n = base64_decoder_feed(&tmp, &ctx, in_buf[in_off], NULL);
+            if(n < 0)
+                return n;
+            out_size_needed += n;
+        }
+
+        if(out_buf == NULL)
+            return out_size_needed;
+        if(out_size < out_size_needed)
+            return -ENOBUFS;
+        in_off = 0;
+    }
+
+    while(in_off < in_size) {
+        /* On a quad boundary, let the block decoder eat as much as it can.
+         * It stops on anything special (line break, padding, bad char). */
+        if(dec->quad_len == 0  &&  dec->pad_len == 0) {
+            unsigned len = base64_decode_block(&ctx, in_buf + in_off,
+                        in_size - in_off, out + out_off, out_size - out_off);
+            in_off += len;
+            out_off += len / 4 * 3;
+            if(in_off >= in_size)
+                break;
+        }
+
+        n = base64_decoder_feed(dec, &ctx, in_buf[in_off], out + out_off);
+        if(n < 0)
+            return n;
+        in_off++;
+        out_off += n;
+    }
+
+    return out_off;
+}
+
+int
+base64_decoder_finish(BASE64_DECODER* dec, void* out_buf, unsigned out_size)
+{
+    uint8_t* out = (uint8_t*) out_buf;
+    int ret;
+
+    /* Unpadded input is accepted as well, as base64_decode() does. But an
+     * incomplete padding means truncated input. */
+    if(dec->quad_len > 0  &&  dec->pad_len > 0)
+        return -EINVAL;
+
+    switch(dec->quad_len) {
+        case 0:
+            ret = 0;
+            break;
+
+        case 1:
+            return -EINVAL;
+
+        case 2:
+            if(dec->quad[1] & 0x0f)
+                return -EINVAL;
+            ret = 1;
+            break;
+
+        default:
+            if(dec->quad[2] & 0x03)
+                return -EINVAL;
+            ret = 2;
+            break;
+    }
+
+    if(out_buf == NULL)
+        return ret;
+    if(out_size < (unsigned) ret)
+        return -ENOBUFS;
+
+    if(ret >= 1)
+        out[0] = (uint8_t) ((dec->quad[0] << 2) | (dec->quad[1] >> 4));
+    if(ret >= 2)
+        out[1] = (uint8_t) ((dec->quad[1] << 4) | (dec->quad[2] >> 2));
+
+    /* Reset, so the decoder is ready for a new stream. */
+    dec->quad_len = 0;
+    dec->pad_len = 0;
+    return ret;
+}
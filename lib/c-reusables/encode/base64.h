@@ -35,12 +35,20 @@ typedef struct BASE64_OPTIONS {
     char ch62;              /* Default: '+' */
     char ch63;              /* Default: '/' */
     char pad;               /* Default: '='  (use '\0' for no padding) */
-#if 0
-    /* Not yet implemented. */
     unsigned line_width;    /* Default: 0 (no line wrapping) */
-#endif
 } BASE64_OPTIONS;
 
+/* Line wrapping:
+ *
+ * If BASE64_OPTIONS::line_width is not zero, the encoder breaks the output
+ * into lines of (at most) that many characters. Lines are separated with
+ * "\r\n" (as required by MIME; use line_width 76 for it). There is no line
+ * break after the last line.
+ *
+ * When decoding, non-zero line_width makes the decoder skip any line breaks
+ * ('\r' and '\n') in the input, regardless of their positions.
+ */
+
 
 /* Encode a block of bytes into Base64 encoding.
  *
@@ -49,8 +57,6 @@ typedef struct BASE64_OPTIONS {
  * (See https://en.wikipedia.org/wiki/Base64#Variants_summary_table for summary
  * of wide-spread variants.)
  *
- * Note that multi-line output is not supported for now.
- *
  * If there is enough space in the output buffer, the output is zero-terminated.
  *
  * If out_buf is NULL, the function returns ideal size of output buffer
@@ -86,6 +92,63 @@ int base64_decode(const char* in_buf, unsigned in_size,
                       const BASE64_OPTIONS* options);
 
 
+/* Streaming encoder.
+ *
+ * Allows to encode data which come in arbitrary chunks (e.g. when reading a
+ * file). Concatenation of everything produced by base64_encoder_update()
+ * and base64_encoder_finish() is the same as what base64_encode() would
+ * produce for the concatenated input (except the zero terminator, which the
+ * streaming encoder never writes).
+ *
+ * Both functions return count of characters written to the output buffer,
+ * or -ENOBUFS if out_size is too small. If out_buf is NULL, they return the
+ * size of output buffer needed for the given input.
+ * Note the encoder may hold up to two bytes of the input until more data are
+ * passed in or until base64_encoder_finish() is called.
+ *
+ * The structure members are private.
+ */
+typedef struct BASE64_ENCODER {
+    BASE64_OPTIONS options;
+    unsigned char tail[2];
+    unsigned tail_len;
+    unsigned line_pos;
+} BASE64_ENCODER;
+
+void base64_encoder_init(BASE64_ENCODER* enc, const BASE64_OPTIONS* options);
+int base64_encoder_update(BASE64_ENCODER* enc, const void* in_buf, unsigned in_size,
+                      char* out_buf, unsigned out_size);
+int base64_encoder_finish(BASE64_ENCODER* enc, char* out_buf, unsigned out_size);
+
+
+/* Streaming decoder.
+ *
+ * Counterpart of BASE64_ENCODER. The input may be split into chunks at any
+ * position. base64_decoder_finish() validates the end of the input (it
+ * fails if the input has been truncated in a way which cannot be a valid
+ * Base64) and returns count of bytes written (0 or more).
+ *
+ * base64_decoder_update() returns count of bytes written to the output
+ * buffer, -EINVAL on invalid input, or -ENOBUFS if out_size is smaller than
+ * the size returned for out_buf == NULL (the decoder then does not consume
+ * anything). After an error, the decoder must not be used anymore unless
+ * reinitialized.
+ *
+ * The structure members are private.
+ */
+typedef struct BASE64_DECODER {
+    BASE64_OPTIONS options;
+    unsigned char quad[4];
+    unsigned quad_len;
+    unsigned pad_len;
+} BASE64_DECODER;
+
+void base64_decoder_init(BASE64_DECODER* dec, const BASE64_OPTIONS* options);
+int base64_decoder_update(BASE64_DECODER* dec, const char* in_buf, unsigned in_size,
+                      void* out_buf, unsigned out_size);
+int base64_decoder_finish(BASE64_DECODER* dec, void* out_buf, unsigned out_size);
+
+
 #ifdef __cplusplus
 }  /* extern "C" { */
 #endif
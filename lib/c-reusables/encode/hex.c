@@ -26,14 +26,193 @@
 #include "hex.h"
 
 
+/* SIMD kernels: SSE2 is always available on x86-64, NEON on ARM64. So no
+ * run-time detection is needed. */
+#if defined(__x86_64__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define HEX_SSE2        1
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #include <arm_neon.h>
+    #define HEX_NEON        1
+#endif
+
+
+#ifdef CRE_TEST
+/* Allows tests to compare the SIMD kernels with the plain C code. */
+int hex_test_disable_simd = 0;
+#endif
+
+
+static const char hex_lower_xdigits[16] = "0123456789abcdef";
+static const char hex_upper_xdigits[16] = "0123456789ABCDEF";
+
+
+/* Value of a hexadecimal digit, or 0xff for anything else. */
+static const unsigned char hex_xdigit_value[256] = {
+#define XX  0xff
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+     0,  1,  2,  3,  4,  5,  6,  7,  8,  9, XX, XX, XX, XX, XX, XX,
+    XX, 10, 11, 12, 13, 14, 15, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, 10, 11, 12, 13, 14, 15, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX,
+    XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX
+#undef XX
+};
+
+
+/* Both kernels process as many whole blocks as they can and return count of
+ * consumed input bytes (or digits). The caller handles the rest. The decoding
+ * kernels stop before any block with an invalid digit so the caller detects
+ * the error. */
+
+#if defined HEX_SSE2
+
+static unsigned
+hex_encode_simd(const unsigned char* in, unsigned n, char* out, int lowercase)
+{
+    const __m128i mask = _mm_set1_epi8(0x0f);
+    const __m128i nine = _mm_set1_epi8(9);
+    const __m128i zero = _mm_set1_epi8('0');
+    const __m128i alpha = _mm_set1_epi8(lowercase ? 'a' - '0' - 10 : 'A' - '0' - 10);
+    unsigned off = 0;
+
+    while(off + 16 <= n) {
+        __m128i v = _mm_loadu_si128((const __m128i*) (in + off));
+        __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), mask);
+        __m128i lo = _mm_and_si128(v, mask);
+
+        /* Nibble -> digit: Add '0', and some more for 'a' ... 'f'. */
+        hi = _mm_add_epi8(_mm_add_epi8(hi, zero), _mm_and_si128(_mm_cmpgt_epi8(hi, nine), alpha));
+        lo = _mm_add_epi8(_mm_add_epi8(lo, zero), _mm_and_si128(_mm_cmpgt_epi8(lo, nine), alpha));
+
+        _mm_storeu_si128((__m128i*) (out + 2 * off), _mm_unpacklo_epi8(hi, lo));
+        _mm_storeu_si128((__m128i*) (out + 2 * off + 16), _mm_unpackhi_epi8(hi, lo));
+        off += 16;
+    }
+
+    return off;
+}
+
+/* Converts 16 digits to their values. Sets *p_valid to 0 if any is not a
+ * hexadecimal digit. */
+static __m128i
+hex_decode_simd_values(__m128i c, int* p_valid)
+{
+    __m128i lc = _mm_or_si128(c, _mm_set1_epi8(0x20));
+    __m128i is_digit, is_alpha;
+
+    /* Signed comparisons: Non-ASCII is negative so it never passes. */
+    is_digit = _mm_andnot_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('9')),
+                                _mm_cmpgt_epi8(c, _mm_set1_epi8('0' - 1)));
+    is_alpha = _mm_andnot_si128(_mm_cmpgt_epi8(lc, _mm_set1_epi8('f')),
+                                _mm_cmpgt_epi8(lc, _mm_set1_epi8('a' - 1)));
+    if(_mm_movemask_epi8(_mm_or_si128(is_digit, is_alpha)) != 0xffff)
+        *p_valid = 0;
+
+    return _mm_or_si128(
+            _mm_and_si128(is_digit, _mm_sub_epi8(c, _mm_set1_epi8('0'))),
+            _mm_and_si128(is_alpha, _mm_sub_epi8(lc, _mm_set1_epi8('a' - 10))));
+}
+
+static unsigned
+hex_decode_simd(const char* in, unsigned n, unsigned char* out)
+{
+    const __m128i mask = _mm_set1_epi16(0x00f0);
+    unsigned off = 0;
+
+    while(off + 32 <= n) {
+        int valid = 1;
+        __m128i v0 = hex_decode_simd_values(_mm_loadu_si128((const __m128i*) (in + off)), &valid);
+        __m128i v1 = hex_decode_simd_values(_mm_loadu_si128((const __m128i*) (in + off + 16)), &valid);
+
+        if(!valid)
+            break;
+
+        /* Each 16-bit lane holds (lo << 8) | hi; make it (hi << 4) | lo. */
+        v0 = _mm_or_si128(_mm_and_si128(_mm_slli_epi16(v0, 4), mask), _mm_srli_epi16(v0, 8));
+        v1 = _mm_or_si128(_mm_and_si128(_mm_slli_epi16(v1, 4), mask), _mm_srli_epi16(v1, 8));
+        _mm_storeu_si128((__m128i*) (out + off / 2), _mm_packus_epi16(v0, v1));
+        off += 32;
+    }
+
+    return off;
+}
+
+#elif defined HEX_NEON
+
+static unsigned
+hex_encode_simd(const unsigned char* in, unsigned n, char* out, int lowercase)
+{
+    const uint8x16_t table = vld1q_u8((const uint8_t*)
+                (lowercase ? hex_lower_xdigits : hex_upper_xdigits));
+    const uint8x16_t mask = vdupq_n_u8(0x0f);
+    unsigned off = 0;
+
+    while(off + 16 <= n) {
+        uint8x16_t v = vld1q_u8(in + off);
+        uint8x16x2_t digits;
+
+        digits.val[0] = vqtbl1q_u8(table, vshrq_n_u8(v, 4));
+        digits.val[1] = vqtbl1q_u8(table, vandq_u8(v, mask));
+        vst2q_u8((uint8_t*) out + 2 * off, digits);
+        off += 16;
+    }
+
+    return off;
+}
+
+static uint8x16_t
+hex_decode_simd_values(uint8x16_t c, uint8x16_t* p_valid)
+{
+    uint8x16_t d = vsubq_u8(c, vdupq_n_u8('0'));
+    uint8x16_t a = vsubq_u8(vorrq_u8(c, vdupq_n_u8(0x20)), vdupq_n_u8('a'));
+    uint8x16_t is_digit = vcltq_u8(d, vdupq_n_u8(10));
+    uint8x16_t is_alpha = vcltq_u8(a, vdupq_n_u8(6));
+
+    *p_valid = vandq_u8(*p_valid, vorrq_u8(is_digit, is_alpha));
+    return vbslq_u8(is_digit, d, vaddq_u8(a, vdupq_n_u8(10)));
+}
+
+static unsigned
+hex_decode_simd(const char* in, unsigned n, unsigned char* out)
+{
+    unsigned off = 0;
+
+    while(off + 32 <= n) {
+        /* De-interleaving load splits the high and low digits. */
+        uint8x16x2_t c = vld2q_u8((const uint8_t*) in + off);
+        uint8x16_t valid = vdupq_n_u8(0xff);
+        uint8x16_t hi = hex_decode_simd_values(c.val[0], &valid);
+        uint8x16_t lo = hex_decode_simd_values(c.val[1], &valid);
+
+        if(vminvq_u8(valid) == 0)
+            break;
+
+        vst1q_u8(out + off / 2, vorrq_u8(vshlq_n_u8(hi, 4), lo));
+        off += 32;
+    }
+
+    return off;
+}
+
+#endif
+
+
 int
 hex_encode(const void* in_buf, unsigned in_size,
            char* out_buf, unsigned out_size, int lowercase)
 {
-    static const char lower_xdigits[16] = "0123456789abcdef";
-    static const char upper_xdigits[16] = "0123456789ABCDEF";
-
-    const char* xdigits = (lowercase ? lower_xdigits : upper_xdigits);
+    const char* xdigits = (lowercase ? hex_lower_xdigits : hex_upper_xdigits);
     const unsigned char* in;
     const unsigned char* in_end;
     char* out;
@@ -50,6 +229,17 @@ hex_encode(const void* in_buf, unsigned in_size,
     out = out_buf;
     out_end = out + out_size;
 
+#if defined HEX_SSE2 || defined HEX_NEON
+  #ifdef CRE_TEST
+    if(!hex_test_disable_simd)
+  #endif
+    {
+        unsigned n = hex_encode_simd(in, in_size, out, lowercase);
+        in += n;
+        out += 2 * n;
+    }
+#endif
+
     while(in < in_end  &&  out + 1 < out_end) {
         *out++ = xdigits[(*in & 0xf0) >> 4];
         *out++ = xdigits[(*in & 0x0f)];
@@ -63,14 +253,37 @@ hex_encode(const void* in_buf, unsigned in_size,
     return out - out_buf;
 }
 
+/* Decodes pairs of digits. Returns count of consumed digits (i.e. even
+ * number), which is smaller than in_size only on a parsing error. */
+static unsigned
+hex_decode_block(const char* in_buf, unsigned in_size, unsigned char* out)
+{
+    unsigned off = 0;
+    unsigned hi, lo;
+
+#if defined HEX_SSE2 || defined HEX_NEON
+  #ifdef CRE_TEST
+    if(!hex_test_disable_simd)
+  #endif
+        off = hex_decode_simd(in_buf, in_size, out);
+#endif
+
+    while(off + 2 <= in_size) {
+        hi = hex_xdigit_value[(unsigned char) in_buf[off]];
+        lo = hex_xdigit_value[(unsigned char) in_buf[off + 1]];
+        if((hi | lo) & 0xf0)
+            break;
+
+        out[off / 2] = (unsigned char) ((hi << 4) | lo);
+        off += 2;
+    }
+
+    return off;
+}
+
 int
 hex_decode(const char* in_buf, unsigned in_size, void* out_buf, unsigned out_size)
 {
-    const char* in = in_buf;
-    const char* in_end = in + in_size;
-    unsigned char* out = (unsigned char*) out_buf;
-    unsigned char* out_end = out + out_size;
-
     if(out_buf == NULL)
         return in_size / 2;
 
@@ -79,34 +292,117 @@ hex_decode(const char* in_buf, unsigned in_size, void* out_buf, unsigned out_siz
     if(out_size < in_size / 2)
         return -1;
 
-    in = in_buf;
-    in_end = in + in_size;
-    out = (unsigned char*) out_buf;
-    out_end = out + out_size;
+    if(hex_decode_block(in_buf, in_size, (unsigned char*) out_buf) != in_size)
+        return -1;
+
+    return in_size / 2;
+}
+
+
+void
+hex_decoder_init(HEX_DECODER* dec)
+{
+    dec->pending = 0;
+    dec->has_pending = 0;
+}
+
+int
+hex_decoder_update(HEX_DECODER* dec, const char* in_buf, unsigned in_size,
+                   void* out_buf, unsigned out_size)
+{
+    unsigned char* out = (unsigned char*) out_buf;
+    unsigned in_off = 0;
+    unsigned out_off = 0;
+    unsigned v;
+
+    if(out_size < (dec->has_pending + in_size) / 2)
+        return -1;
 
-    while(in < in_end  &&  out < out_end) {
-        if('0' <= *in  &&  *in <= '9')
-            *out = (*in - '0') << 4;
-        else if('a' <= *in  &&  *in <= 'z')
-            *out = (*in - 'a' + 10) << 4;
-        else if('A' <= *in  &&  *in <= 'Z')
-            *out = (*in - 'A' + 10) << 4;
-        else
+    /* Complete the byte started in the previous chunk. */
+    if(dec->has_pending  &&  in_size > 0) {
+        v = hex_xdigit_value[(unsigned char) in_buf[0]];
+        if(v & 0xf0)
             return -1;
-        in++;
+        out[out_off++] = (unsigned char) ((dec->pending << 4) | v);
+        dec->has_pending = 0;
+        in_off++;
+    }
+
+    /* Main part. */
+    v = hex_decode_block(in_buf + in_off, (in_size - in_off) & ~1u, out + out_off);
+    if(v != ((in_size - in_off) & ~1u))
+        return -1;
+    in_off += v;
+    out_off += v / 2;
 
-        if('0' <= *in  &&  *in <= '9')
-            *out |= (*in - '0');
-        else if('a' <= *in  &&  *in <= 'z')
-            *out |= (*in - 'a' + 10);
-        else if('A' <= *in  &&  *in <= 'Z')
-            *out |= (*in - 'A' + 10);
-        else
+    /* Remember an unpaired digit. */
+    if(in_off < in_size) {
+        v = hex_xdigit_value[(unsigned char) in_buf[in_off]];
+        if(v & 0xf0)
             return -1;
-        in++;
+        dec->pending = (unsigned char) v;
+        dec->has_pending = 1;
+    }
+
+    return out_off;
+}
+
+int
+hex_decoder_finish(HEX_DECODER* dec)
+{
+    int ret = (dec->has_pending ? -1 : 0);
+
+    hex_decoder_init(dec);
+    return ret;
+}
+
 
-        out++;
+int
+hex_dump_line(const void* in_buf, unsigned in_size, size_t offset,
+              char* out_buf, unsigned out_size)
+{
+    const unsigned char* in = (const unsigned char*) in_buf;
+    unsigned off_digits;
+    unsigned len;
+    unsigned i;
+    char* out;
+
+    if(in_size > HEX_DUMP_PER_LINE)
+        return -1;
+
+    /* Offset, hexadecimal column (3 chars per byte + 2 extra spaces in the
+     * middle and at the end), ASCII column between '|', and the terminator. */
+    off_digits = ((unsigned long long) offset > 0xffffffffULL) ? 16 : 8;
+    len = off_digits + 2 + (3 * HEX_DUMP_PER_LINE + 2) + (in_size + 2);
+    if(out_size < len + 1)
+        return -1;
+
+    out = out_buf;
+
+    for(i = off_digits; i > 0; i--)
+        *out++ = hex_lower_xdigits[((unsigned long long) offset >> (4 * (i-1))) & 0xf];
+    *out++ = ' ';
+    *out++ = ' ';
+
+    for(i = 0; i < HEX_DUMP_PER_LINE; i++) {
+        if(i < in_size) {
+            *out++ = hex_lower_xdigits[in[i] >> 4];
+            *out++ = hex_lower_xdigits[in[i] & 0xf];
+        } else {
+            *out++ = ' ';
+            *out++ = ' ';
+        }
+        *out++ = ' ';
+        if(i == HEX_DUMP_PER_LINE / 2 - 1)
+            *out++ = ' ';
     }
+    *out++ = ' ';
+
+    *out++ = '|';
+    for(i = 0; i < in_size; i++)
+        *out++ = (0x20 <= in[i]  &&  in[i] < 0x7f) ? (char) in[i] : '.';
+    *out++ = '|';
+    *out = '\0';
 
-    return out - (const unsigned char*) out_buf;
+    return out - out_buf;
 }
@@ -60,6 +60,56 @@ int hex_decode(const char* in_buf, unsigned in_size,
                    void* out_buf, unsigned out_size);
 
 
+/* Streaming decoder.
+ *
+ * Decodes hexadecimal notation which comes in chunks of arbitrary size (the
+ * chunks do not need to contain even count of digits).
+ *
+ * hex_decoder_update() returns the number of written bytes, or -1 in case of
+ * error (parsing error or too small output buffer; (in_size + 1) / 2 bytes
+ * is always enough). hex_decoder_finish() returns -1 if there is a pending unpaired
+ * digit, zero otherwise. It also resets the decoder for a new stream.
+ *
+ * (There is no streaming encoder, as hex_encode() does not need any state:
+ * Just call it for each chunk.)
+ *
+ * The structure members are private.
+ */
+typedef struct HEX_DECODER {
+    unsigned char pending;
+    unsigned has_pending;
+} HEX_DECODER;
+
+void hex_decoder_init(HEX_DECODER* dec);
+int hex_decoder_update(HEX_DECODER* dec, const char* in_buf, unsigned in_size,
+                   void* out_buf, unsigned out_size);
+int hex_decoder_finish(HEX_DECODER* dec);
+
+
+/* Formats one line of a classic hex dump: Offset, up to HEX_DUMP_PER_LINE
+ * bytes as hexadecimal numbers, and the same bytes as ASCII characters
+ * (with '.' for non-printable ones):
+ *
+ * "00000010  30 31 32 33 34 35 36 37  38 39 0a 0b              |0123456789..|"
+ *
+ * The hexadecimal column is padded with spaces for short (i.e. last) lines so
+ * the ASCII column is always aligned. The offset has 8 digits (16 if it does
+ * not fit).
+ *
+ * in_size must not be larger than HEX_DUMP_PER_LINE. If out_size is at least
+ * HEX_DUMP_LINE_SIZE, the output always fits. The output is zero-terminated
+ * and does not contain any line break.
+ *
+ * Returns length of the line (not counting the zero terminator), or -1 if the
+ * output buffer is too small.
+ */
+#define HEX_DUMP_PER_LINE       16
+#define HEX_DUMP_LINE_SIZE      96
+
+int hex_dump_line(const void* in_buf, unsigned in_size, size_t offset,
+                   char* out_buf, unsigned out_size);
+
+
 #ifdef __cplusplus
 }  /* extern "C" { */
 #endif
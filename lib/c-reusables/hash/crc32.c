@@ -25,31 +25,93 @@
 
 #include "crc32.h"
 
+#include <string.h>
+
+
+/* Hardware acceleration. CRC32_HW_X86 and CRC32_HW_ARM64 get defined if we
+ * know how to compile the respective code. Whether the CPU actually supports
+ * the instructions is checked at run time (unless the compiler already
+ * targets such CPU). */
+#if defined(__x86_64__) || defined(_M_X64)
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #include <intrin.h>
+        #include <emmintrin.h>
+        #include <wmmintrin.h>
+        #define CRC32_HW_X86            1
+        #define CRC32_TARGET_X86
+    #elif defined(__clang__) || (defined(__GNUC__) && \
+                (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)))
+        #include <cpuid.h>
+        #include <emmintrin.h>
+        #include <wmmintrin.h>
+        #define CRC32_HW_X86            1
+        #define CRC32_TARGET_X86        __attribute__((target("sse2,pclmul")))
+    #endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #if defined(__ARM_FEATURE_CRC32)
+        #include <arm_acle.h>
+        #define CRC32_HW_ARM64          1
+        #define CRC32_HW_ARM64_ALWAYS   1
+        #define CRC32_TARGET_ARM64
+    #elif defined(_MSC_VER) && !defined(__clang__)
+        #include <windows.h>
+        #include <intrin.h>
+        #define CRC32_HW_ARM64          1
+        #define CRC32_TARGET_ARM64
+    #elif defined(__linux__) && defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 6
+        #include <arm_acle.h>
+        #include <sys/auxv.h>
+        #ifndef HWCAP_CRC32
+            #define HWCAP_CRC32         (1 << 7)
+        #endif
+        #define CRC32_HW_ARM64          1
+        #define CRC32_TARGET_ARM64      __attribute__((target("+crc")))
+    #endif
+#endif
+
 
 #if 0
-/* Program used for pre-computing the table below. */
+/* Program used for pre-computing the tables below. */
 
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
 
 #define CRC32_POLY      0xedb88320U
+#define CRC32_SLICES    16
+
+static uint32_t
+crc32_multmodp(uint32_t a, uint32_t b)
+{
+    uint32_t m = (uint32_t) 1 << 31;
+    uint32_t p = 0;
+
+    while(m != 0) {
+        if(a & m)
+            p ^= b;
+        m >>= 1;
+        b = (b & 1) ? ((b >> 1) ^ CRC32_POLY) : (b >> 1);
+    }
+    return p;
+}
 
 static void
-crc32_dump_table(const uint32_t* table)
+crc32_dump_table(const uint32_t* table, int n, int is_last)
 {
     int i;
 
-    printf("\n");
-    for(i = 0; i < 256; i += 8) {
-        printf("0x%08xU, 0x%08xU, 0x%08xU, 0x%08xU, 0x%08xU, 0x%08xU, 0x%08xU, 0x%08xU,\n",
+    printf("  {\n");
+    for(i = 0; i < n; i += 8) {
+        printf("    0x%08xU, 0x%08xU, 0x%08xU, 0x%08xU, 0x%08xU, 0x%08xU, 0x%08xU, 0x%08xU%s\n",
                 table[i + 0], table[i + 1], table[i + 2], table[i + 3],
-                table[i + 4], table[i + 5], table[i + 6], table[i + 7]);
+                table[i + 4], table[i + 5], table[i + 6], table[i + 7],
+                (i + 8 < n) ? "," : "");
     }
+    printf("  }%s\n", (is_last ? "" : ","));
 }
 
 static void
-crc32_build_table(uint32_t* table)
+crc32_build_table(uint32_t table[CRC32_SLICES][256])
 {
     uint32_t c;
     int n, k;
@@ -63,23 +125,54 @@ crc32_build_table(uint32_t* table)
                 c = c >> 1;
         }
 
-        table[n] = c;
+        table[0][n] = c;
+    }
+
+    /* table[k][n] is CRC of byte n followed by k zero bytes. */
+    for(k = 1; k < CRC32_SLICES; k++) {
+        for(n = 0; n < 256; n++) {
+            c = table[k-1][n];
+            table[k][n] = (c >> 8) ^ table[0][c & 0xffU];
+        }
+    }
+}
+
+static void
+crc32_build_x2n_table(uint32_t* table)
+{
+    /* table[k] is x^(2^k) modulo the polynomial (in the reflected bit order,
+     * i.e. 0x80000000U is x^0). */
+    uint32_t p = (uint32_t) 1 << 30;
+    int k;
+
+    for(k = 0; k < 32; k++) {
+        table[k] = p;
+        p = crc32_multmodp(p, p);
     }
 }
 
 int
 main(int argc, char** argv)
 {
-    uint32_t table[256];
+    uint32_t table[CRC32_SLICES][256];
+    uint32_t x2n_table[32];
+    int k;
 
     crc32_build_table(table);
-    crc32_dump_table(table);
+    printf("\n");
+    for(k = 0; k < CRC32_SLICES; k++)
+        crc32_dump_table(table[k], 256, (k == CRC32_SLICES-1));
+
+    crc32_build_x2n_table(x2n_table);
+    printf("\n");
+    crc32_dump_table(x2n_table, 32, 1);
 
     return 0;
 }
 #endif
 
-static uint32_t crc32_table[256] = {
+static const uint32_t crc32_table[16][256] = {
+  {
     0x00000000U, 0x77073096U, 0xee0e612cU, 0x990951baU, 0x076dc419U, 0x706af48fU, 0xe963a535U, 0x9e6495a3U,
     0x0edb8832U, 0x79dcb8a4U, 0xe0d5e91eU, 0x97d2d988U, 0x09b64c2bU, 0x7eb17cbdU, 0xe7b82d07U, 0x90bf1d91U,
     0x1db71064U, 0x6ab020f2U, 0xf3b97148U, 0x84be41deU, 0x1adad47dU, 0x6ddde4ebU, 0xf4d4b551U, 0x83d385c7U,
@@ -112,20 +205,890 @@ static uint32_t crc32_table[256] = {
     0xaed16a4aU, 0xd9d65adcU, 0x40df0b66U, 0x37d83bf0U, 0xa9bcae53U, 0xdebb9ec5U, 0x47b2cf7fU, 0x30b5ffe9U,
     0xbdbdf21cU, 0xcabac28aU, 0x53b39330U, 0x24b4a3a6U, 0xbad03605U, 0xcdd70693U, 0x54de5729U, 0x23d967bfU,
     0xb3667a2eU, 0xc4614ab8U, 0x5d681b02U, 0x2a6f2b94U, 0xb40bbe37U, 0xc30c8ea1U, 0x5a05df1bU, 0x2d02ef8dU
+  },
+  {
+    0x00000000U, 0x191b3141U, 0x32366282U, 0x2b2d53c3U, 0x646cc504U, 0x7d77f445U, 0x565aa786U, 0x4f4196c7U,
+    0xc8d98a08U, 0xd1c2bb49U, 0xfaefe88aU, 0xe3f4d9cbU, 0xacb54f0cU, 0xb5ae7e4dU, 0x9e832d8eU, 0x87981ccfU,
+    0x4ac21251U, 0x53d92310U, 0x78f470d3U, 0x61ef4192U, 0x2eaed755U, 0x37b5e614U, 0x1c98b5d7U, 0x05838496U,
+    0x821b9859U, 0x9b00a918U, 0xb02dfadbU, 0xa936cb9aU, 0xe6775d5dU, 0xff6c6c1cU, 0xd4413fdfU, 0xcd5a0e9eU,
+    0x958424a2U, 0x8c9f15e3U, 0xa7b24620U, 0xbea97761U, 0xf1e8e1a6U, 0xe8f3d0e7U, 0xc3de8324U, 0xdac5b265U,
+    0x5d5daeaaU, 0x44469febU, 0x6f6bcc28U, 0x7670fd69U, 0x39316baeU, 0x202a5aefU, 0x0b07092cU, 0x121c386dU,
+    0xdf4636f3U, 0xc65d07b2U, 0xed705471U, 0xf46b6530U, 0xbb2af3f7U, 0xa231c2b6U, 0x891c9175U, 0x9007a034U,
+    0x179fbcfbU, 0x0e848dbaU, 0x25a9de79U, 0x3cb2ef38U, 0x73f379ffU, 0x6ae848beU, 0x41c51b7dU, 0x58de2a3cU,
+    0xf0794f05U, 0xe9627e44U, 0xc24f2d87U, 0xdb541cc6U, 0x94158a01U, 0x8d0ebb40U, 0xa623e883U, 0xbf38d9c2U,
+    0x38a0c50dU, 0x21bbf44cU, 0x0a96a78fU, 0x138d96ceU, 0x5ccc0009U, 0x45d73148U, 0x6efa628bU, 0x77e153caU,
+    0xbabb5d54U, 0xa3a06c15U, 0x888d3fd6U, 0x91960e97U, 0xded79850U, 0xc7cca911U, 0xece1fad2U, 0xf5facb93U,
+    0x7262d75cU, 0x6b79e61dU, 0x4054b5deU, 0x594f849fU, 0x160e1258U, 0x0f152319U, 0x243870daU, 0x3d23419bU,
+    0x65fd6ba7U, 0x7ce65ae6U, 0x57cb0925U, 0x4ed03864U, 0x0191aea3U, 0x188a9fe2U, 0x33a7cc21U, 0x2abcfd60U,
+    0xad24e1afU, 0xb43fd0eeU, 0x9f12832dU, 0x8609b26cU, 0xc94824abU, 0xd05315eaU, 0xfb7e4629U, 0xe2657768U,
+    0x2f3f79f6U, 0x362448b7U, 0x1d091b74U, 0x04122a35U, 0x4b53bcf2U, 0x52488db3U, 0x7965de70U, 0x607eef31U,
+    0xe7e6f3feU, 0xfefdc2bfU, 0xd5d0917cU, 0xcccba03dU, 0x838a36faU, 0x9a9107bbU, 0xb1bc5478U, 0xa8a76539U,
+    0x3b83984bU, 0x2298a90aU, 0x09b5fac9U, 0x10aecb88U, 0x5fef5d4fU, 0x46f46c0eU, 0x6dd93fcdU, 0x74c20e8cU,
+    0xf35a1243U, 0xea412302U, 0xc16c70c1U, 0xd8774180U, 0x9736d747U, 0x8e2de606U, 0xa500b5c5U, 0xbc1b8484U,
+    0x71418a1aU, 0x685abb5bU, 0x4377e898U, 0x5a6cd9d9U, 0x152d4f1eU, 0x0c367e5fU, 0x271b2d9cU, 0x3e001cddU,
+    0xb9980012U, 0xa0833153U, 0x8bae6290U, 0x92b553d1U, 0xddf4c516U, 0xc4eff457U, 0xefc2a794U, 0xf6d996d5U,
+    0xae07bce9U, 0xb71c8da8U, 0x9c31de6bU, 0x852aef2aU, 0xca6b79edU, 0xd37048acU, 0xf85d1b6fU, 0xe1462a2eU,
+    0x66de36e1U, 0x7fc507a0U, 0x54e85463U, 0x4df36522U, 0x02b2f3e5U, 0x1ba9c2a4U, 0x30849167U, 0x299fa026U,
+    0xe4c5aeb8U, 0xfdde9ff9U, 0xd6f3cc3aU, 0xcfe8fd7bU, 0x80a96bbcU, 0x99b25afdU, 0xb29f093eU, 0xab84387fU,
+    0x2c1c24b0U, 0x350715f1U, 0x1e2a4632U, 0x07317773U, 0x4870e1b4U, 0x516bd0f5U, 0x7a468336U, 0x635db277U,
+    0xcbfad74eU, 0xd2e1e60fU, 0xf9ccb5ccU, 0xe0d7848dU, 0xaf96124aU, 0xb68d230bU, 0x9da070c8U, 0x84bb4189U,
+    0x03235d46U, 0x1a386c07U, 0x31153fc4U, 0x280e0e85U, 0x674f9842U, 0x7e54a903U, 0x5579fac0U, 0x4c62cb81U,
+    0x8138c51fU, 0x9823f45eU, 0xb30ea79dU, 0xaa1596dcU, 0xe554001bU, 0xfc4f315aU, 0xd7626299U, 0xce7953d8U,
+    0x49e14f17U, 0x50fa7e56U, 0x7bd72d95U, 0x62cc1cd4U, 0x2d8d8a13U, 0x3496bb52U, 0x1fbbe891U, 0x06a0d9d0U,
+    0x5e7ef3ecU, 0x4765c2adU, 0x6c48916eU, 0x7553a02fU, 0x3a1236e8U, 0x230907a9U, 0x0824546aU, 0x113f652bU,
+    0x96a779e4U, 0x8fbc48a5U, 0xa4911b66U, 0xbd8a2a27U, 0xf2cbbce0U, 0xebd08da1U, 0xc0fdde62U, 0xd9e6ef23U,
+    0x14bce1bdU, 0x0da7d0fcU, 0x268a833fU, 0x3f91b27eU, 0x70d024b9U, 0x69cb15f8U, 0x42e6463bU, 0x5bfd777aU,
+    0xdc656bb5U, 0xc57e5af4U, 0xee530937U, 0xf7483876U, 0xb809aeb1U, 0xa1129ff0U, 0x8a3fcc33U, 0x9324fd72U
+  },
+  {
+    0x00000000U, 0x01c26a37U, 0x0384d46eU, 0x0246be59U, 0x0709a8dcU, 0x06cbc2ebU, 0x048d7cb2U, 0x054f1685U,
+    0x0e1351b8U, 0x0fd13b8fU, 0x0d9785d6U, 0x0c55efe1U, 0x091af964U, 0x08d89353U, 0x0a9e2d0aU, 0x0b5c473dU,
+    0x1c26a370U, 0x1de4c947U, 0x1fa2771eU, 0x1e601d29U, 0x1b2f0bacU, 0x1aed619bU, 0x18abdfc2U, 0x1969b5f5U,
+    0x1235f2c8U, 0x13f798ffU, 0x11b126a6U, 0x10734c91U, 0x153c5a14U, 0x14fe3023U, 0x16b88e7aU, 0x177ae44dU,
+    0x384d46e0U, 0x398f2cd7U, 0x3bc9928eU, 0x3a0bf8b9U, 0x3f44ee3cU, 0x3e86840bU, 0x3cc03a52U, 0x3d025065U,
+    0x365e1758U, 0x379c7d6fU, 0x35dac336U, 0x3418a901U, 0x3157bf84U, 0x3095d5b3U, 0x32d36beaU, 0x331101ddU,
+    0x246be590U, 0x25a98fa7U, 0x27ef31feU, 0x262d5bc9U, 0x23624d4cU, 0x22a0277bU, 0x20e69922U, 0x2124f315U,
+    0x2a78b428U, 0x2bbade1fU, 0x29fc6046U, 0x283e0a71U, 0x2d711cf4U, 0x2cb376c3U, 0x2ef5c89aU, 0x2f37a2adU,
+    0x709a8dc0U, 0x7158e7f7U, 0x731e59aeU, 0x72dc3399U, 0x7793251cU, 0x76514f2bU, 0x7417f172U, 0x75d59b45U,
+    0x7e89dc78U, 0x7f4bb64fU, 0x7d0d0816U, 0x7ccf6221U, 0x798074a4U, 0x78421e93U, 0x7a04a0caU, 0x7bc6cafdU,
+    0x6cbc2eb0U, 0x6d7e4487U, 0x6f38fadeU, 0x6efa90e9U, 0x6bb5866cU, 0x6a77ec5bU, 0x68315202U, 0x69f33835U,
+    0x62af7f08U, 0x636d153fU, 0x612bab66U, 0x60e9c151U, 0x65a6d7d4U, 0x6464bde3U, 0x662203baU, 0x67e0698dU,
+    0x48d7cb20U, 0x4915a117U, 0x4b531f4eU, 0x4a917579U, 0x4fde63fcU, 0x4e1c09cbU, 0x4c5ab792U, 0x4d98dda5U,
+    0x46c49a98U, 0x4706f0afU, 0x45404ef6U, 0x448224c1U, 0x41cd3244U, 0x400f5873U, 0x4249e62aU, 0x438b8c1dU,
+    0x54f16850U, 0x55330267U, 0x5775bc3eU, 0x56b7d609U, 0x53f8c08cU, 0x523aaabbU, 0x507c14e2U, 0x51be7ed5U,
+    0x5ae239e8U, 0x5b2053dfU, 0x5966ed86U, 0x58a487b1U, 0x5deb9134U, 0x5c29fb03U, 0x5e6f455aU, 0x5fad2f6dU,
+    0xe1351b80U, 0xe0f771b7U, 0xe2b1cfeeU, 0xe373a5d9U, 0xe63cb35cU, 0xe7fed96bU, 0xe5b86732U, 0xe47a0d05U,
+    0xef264a38U, 0xeee4200fU, 0xeca29e56U, 0xed60f461U, 0xe82fe2e4U, 0xe9ed88d3U, 0xebab368aU, 0xea695cbdU,
+    0xfd13b8f0U, 0xfcd1d2c7U, 0xfe976c9eU, 0xff5506a9U, 0xfa1a102cU, 0xfbd87a1bU, 0xf99ec442U, 0xf85cae75U,
+    0xf300e948U, 0xf2c2837fU, 0xf0843d26U, 0xf1465711U, 0xf4094194U, 0xf5cb2ba3U, 0xf78d95faU, 0xf64fffcdU,
+    0xd9785d60U, 0xd8ba3757U, 0xdafc890eU, 0xdb3ee339U, 0xde71f5bcU, 0xdfb39f8bU, 0xddf521d2U, 0xdc374be5U,
+    0xd76b0cd8U, 0xd6a966efU, 0xd4efd8b6U, 0xd52db281U, 0xd062a404U, 0xd1a0ce33U, 0xd3e6706aU, 0xd2241a5dU,
+    0xc55efe10U, 0xc49c9427U, 0xc6da2a7eU, 0xc7184049U, 0xc25756ccU, 0xc3953cfbU, 0xc1d382a2U, 0xc011e895U,
+    0xcb4dafa8U, 0xca8fc59fU, 0xc8c97bc6U, 0xc90b11f1U, 0xcc440774U, 0xcd866d43U, 0xcfc0d31aU, 0xce02b92dU,
+    0x91af9640U, 0x906dfc77U, 0x922b422eU, 0x93e92819U, 0x96a63e9cU, 0x976454abU, 0x9522eaf2U, 0x94e080c5U,
+    0x9fbcc7f8U, 0x9e7eadcfU, 0x9c381396U, 0x9dfa79a1U, 0x98b56f24U, 0x99770513U, 0x9b31bb4aU, 0x9af3d17dU,
+    0x8d893530U, 0x8c4b5f07U, 0x8e0de15eU, 0x8fcf8b69U, 0x8a809decU, 0x8b42f7dbU, 0x89044982U, 0x88c623b5U,
+    0x839a6488U, 0x82580ebfU, 0x801eb0e6U, 0x81dcdad1U, 0x8493cc54U, 0x8551a663U, 0x8717183aU, 0x86d5720dU,
+    0xa9e2d0a0U, 0xa820ba97U, 0xaa6604ceU, 0xaba46ef9U, 0xaeeb787cU, 0xaf29124bU, 0xad6fac12U, 0xacadc625U,
+    0xa7f18118U, 0xa633eb2fU, 0xa4755576U, 0xa5b73f41U, 0xa0f829c4U, 0xa13a43f3U, 0xa37cfdaaU, 0xa2be979dU,
+    0xb5c473d0U, 0xb40619e7U, 0xb640a7beU, 0xb782cd89U, 0xb2cddb0cU, 0xb30fb13bU, 0xb1490f62U, 0xb08b6555U,
+    0xbbd72268U, 0xba15485fU, 0xb853f606U, 0xb9919c31U, 0xbcde8ab4U, 0xbd1ce083U, 0xbf5a5edaU, 0xbe9834edU
+  },
+  {
+    0x00000000U, 0xb8bc6765U, 0xaa09c88bU, 0x12b5afeeU, 0x8f629757U, 0x37def032U, 0x256b5fdcU, 0x9dd738b9U,
+    0xc5b428efU, 0x7d084f8aU, 0x6fbde064U, 0xd7018701U, 0x4ad6bfb8U, 0xf26ad8ddU, 0xe0df7733U, 0x58631056U,
+    0x5019579fU, 0xe8a530faU, 0xfa109f14U, 0x42acf871U, 0xdf7bc0c8U, 0x67c7a7adU, 0x75720843U, 0xcdce6f26U,
+    0x95ad7f70U, 0x2d111815U, 0x3fa4b7fbU, 0x8718d09eU, 0x1acfe827U, 0xa2738f42U, 0xb0c620acU, 0x087a47c9U,
+    0xa032af3eU, 0x188ec85bU, 0x0a3b67b5U, 0xb28700d0U, 0x2f503869U, 0x97ec5f0cU, 0x8559f0e2U, 0x3de59787U,
+    0x658687d1U, 0xdd3ae0b4U, 0xcf8f4f5aU, 0x7733283fU, 0xeae41086U, 0x525877e3U, 0x40edd80dU, 0xf851bf68U,
+    0xf02bf8a1U, 0x48979fc4U, 0x5a22302aU, 0xe29e574fU, 0x7f496ff6U, 0xc7f50893U, 0xd540a77dU, 0x6dfcc018U,
+    0x359fd04eU, 0x8d23b72bU, 0x9f9618c5U, 0x272a7fa0U, 0xbafd4719U, 0x0241207cU, 0x10f48f92U, 0xa848e8f7U,
+    0x9b14583dU, 0x23a83f58U, 0x311d90b6U, 0x89a1f7d3U, 0x1476cf6aU, 0xaccaa80fU, 0xbe7f07e1U, 0x06c36084U,
+    0x5ea070d2U, 0xe61c17b7U, 0xf4a9b859U, 0x4c15df3cU, 0xd1c2e785U, 0x697e80e0U, 0x7bcb2f0eU, 0xc377486bU,
+    0xcb0d0fa2U, 0x73b168c7U, 0x6104c729U, 0xd9b8a04cU, 0x446f98f5U, 0xfcd3ff90U, 0xee66507eU, 0x56da371bU,
+    0x0eb9274dU, 0xb6054028U, 0xa4b0efc6U, 0x1c0c88a3U, 0x81dbb01aU, 0x3967d77fU, 0x2bd27891U, 0x936e1ff4U,
+    0x3b26f703U, 0x839a9066U, 0x912f3f88U, 0x299358edU, 0xb4446054U, 0x0cf80731U, 0x1e4da8dfU, 0xa6f1cfbaU,
+    0xfe92dfecU, 0x462eb889U, 0x549b1767U, 0xec277002U, 0x71f048bbU, 0xc94c2fdeU, 0xdbf98030U, 0x6345e755U,
+    0x6b3fa09cU, 0xd383c7f9U, 0xc1366817U, 0x798a0f72U, 0xe45d37cbU, 0x5ce150aeU, 0x4e54ff40U, 0xf6e89825U,
+    0xae8b8873U, 0x1637ef16U, 0x048240f8U, 0xbc3e279dU, 0x21e91f24U, 0x99557841U, 0x8be0d7afU, 0x335cb0caU,
+    0xed59b63bU, 0x55e5d15eU, 0x47507eb0U, 0xffec19d5U, 0x623b216cU, 0xda874609U, 0xc832e9e7U, 0x708e8e82U,
+    0x28ed9ed4U, 0x9051f9b1U, 0x82e4565fU, 0x3a58313aU, 0xa78f0983U, 0x1f336ee6U, 0x0d86c108U, 0xb53aa66dU,
+    0xbd40e1a4U, 0x05fc86c1U, 0x1749292fU, 0xaff54e4aU, 0x322276f3U, 0x8a9e1196U, 0x982bbe78U, 0x2097d91dU,
+    0x78f4c94bU, 0xc048ae2eU, 0xd2fd01c0U, 0x6a4166a5U, 0xf7965e1cU, 0x4f2a3979U, 0x5d9f9697U, 0xe523f1f2U,
+    0x4d6b1905U, 0xf5d77e60U, 0xe762d18eU, 0x5fdeb6ebU, 0xc2098e52U, 0x7ab5e937U, 0x680046d9U, 0xd0bc21bcU,
+    0x88df31eaU, 0x3063568fU, 0x22d6f961U, 0x9a6a9e04U, 0x07bda6bdU, 0xbf01c1d8U, 0xadb46e36U, 0x15080953U,
+    0x1d724e9aU, 0xa5ce29ffU, 0xb77b8611U, 0x0fc7e174U, 0x9210d9cdU, 0x2aacbea8U, 0x38191146U, 0x80a57623U,
+    0xd8c66675U, 0x607a0110U, 0x72cfaefeU, 0xca73c99bU, 0x57a4f122U, 0xef189647U, 0xfdad39a9U, 0x45115eccU,
+    0x764dee06U, 0xcef18963U, 0xdc44268dU, 0x64f841e8U, 0xf92f7951U, 0x41931e34U, 0x5326b1daU, 0xeb9ad6bfU,
+    0xb3f9c6e9U, 0x0b45a18cU, 0x19f00e62U, 0xa14c6907U, 0x3c9b51beU, 0x842736dbU, 0x96929935U, 0x2e2efe50U,
+    0x2654b999U, 0x9ee8defcU, 0x8c5d7112U, 0x34e11677U, 0xa9362eceU, 0x118a49abU, 0x033fe645U, 0xbb838120U,
+    0xe3e09176U, 0x5b5cf613U, 0x49e959fdU, 0xf1553e98U, 0x6c820621U, 0xd43e6144U, 0xc68bceaaU, 0x7e37a9cfU,
+    0xd67f4138U, 0x6ec3265dU, 0x7c7689b3U, 0xc4caeed6U, 0x591dd66fU, 0xe1a1b10aU, 0xf3141ee4U, 0x4ba87981U,
+    0x13cb69d7U, 0xab770eb2U, 0xb9c2a15cU, 0x017ec639U, 0x9ca9fe80U, 0x241599e5U, 0x36a0360bU, 0x8e1c516eU,
+    0x866616a7U, 0x3eda71c2U, 0x2c6fde2cU, 0x94d3b949U, 0x090481f0U, 0xb1b8e695U, 0xa30d497bU, 0x1bb12e1eU,
+    0x43d23e48U, 0xfb6e592dU, 0xe9dbf6c3U, 0x516791a6U, 0xccb0a91fU, 0x740cce7aU, 0x66b96194U, 0xde0506f1U
+  },
+  {
+    0x00000000U, 0x3d6029b0U, 0x7ac05360U, 0x47a07ad0U, 0xf580a6c0U, 0xc8e08f70U, 0x8f40f5a0U, 0xb220dc10U,
+    0x30704bc1U, 0x0d106271U, 0x4ab018a1U, 0x77d03111U, 0xc5f0ed01U, 0xf890c4b1U, 0xbf30be61U, 0x825097d1U,
+    0x60e09782U, 0x5d80be32U, 0x1a20c4e2U, 0x2740ed52U, 0x95603142U, 0xa80018f2U, 0xefa06222U, 0xd2c04b92U,
+    0x5090dc43U, 0x6df0f5f3U, 0x2a508f23U, 0x1730a693U, 0xa5107a83U, 0x98705333U, 0xdfd029e3U, 0xe2b00053U,
+    0xc1c12f04U, 0xfca106b4U, 0xbb017c64U, 0x866155d4U, 0x344189c4U, 0x0921a074U, 0x4e81daa4U, 0x73e1f314U,
+    0xf1b164c5U, 0xccd14d75U, 0x8b7137a5U, 0xb6111e15U, 0x0431c205U, 0x3951ebb5U, 0x7ef19165U, 0x4391b8d5U,
+    0xa121b886U, 0x9c419136U, 0xdbe1ebe6U, 0xe681c256U, 0x54a11e46U, 0x69c137f6U, 0x2e614d26U, 0x13016496U,
+    0x9151f347U, 0xac31daf7U, 0xeb91a027U, 0xd6f18997U, 0x64d15587U, 0x59b17c37U, 0x1e1106e7U, 0x23712f57U,
+    0x58f35849U, 0x659371f9U, 0x22330b29U, 0x1f532299U, 0xad73fe89U, 0x9013d739U, 0xd7b3ade9U, 0xead38459U,
+    0x68831388U, 0x55e33a38U, 0x124340e8U, 0x2f236958U, 0x9d03b548U, 0xa0639cf8U, 0xe7c3e628U, 0xdaa3cf98U,
+    0x3813cfcbU, 0x0573e67bU, 0x42d39cabU, 0x7fb3b51bU, 0xcd93690bU, 0xf0f340bbU, 0xb7533a6bU, 0x8a3313dbU,
+    0x0863840aU, 0x3503adbaU, 0x72a3d76aU, 0x4fc3fedaU, 0xfde322caU, 0xc0830b7aU, 0x872371aaU, 0xba43581aU,
+    0x9932774dU, 0xa4525efdU, 0xe3f2242dU, 0xde920d9dU, 0x6cb2d18dU, 0x51d2f83dU, 0x167282edU, 0x2b12ab5dU,
+    0xa9423c8cU, 0x9422153cU, 0xd3826fecU, 0xeee2465cU, 0x5cc29a4cU, 0x61a2b3fcU, 0x2602c92cU, 0x1b62e09cU,
+    0xf9d2e0cfU, 0xc4b2c97fU, 0x8312b3afU, 0xbe729a1fU, 0x0c52460fU, 0x31326fbfU, 0x7692156fU, 0x4bf23cdfU,
+    0xc9a2ab0eU, 0xf4c282beU, 0xb362f86eU, 0x8e02d1deU, 0x3c220dceU, 0x0142247eU, 0x46e25eaeU, 0x7b82771eU,
+    0xb1e6b092U, 0x8c869922U, 0xcb26e3f2U, 0xf646ca42U, 0x44661652U, 0x79063fe2U, 0x3ea64532U, 0x03c66c82U,
+    0x8196fb53U, 0xbcf6d2e3U, 0xfb56a833U, 0xc6368183U, 0x74165d93U, 0x49767423U, 0x0ed60ef3U, 0x33b62743U,
+    0xd1062710U, 0xec660ea0U, 0xabc67470U, 0x96a65dc0U, 0x248681d0U, 0x19e6a860U, 0x5e46d2b0U, 0x6326fb00U,
+    0xe1766cd1U, 0xdc164561U, 0x9bb63fb1U, 0xa6d61601U, 0x14f6ca11U, 0x2996e3a1U, 0x6e369971U, 0x5356b0c1U,
+    0x70279f96U, 0x4d47b626U, 0x0ae7ccf6U, 0x3787e546U, 0x85a73956U, 0xb8c710e6U, 0xff676a36U, 0xc2074386U,
+    0x4057d457U, 0x7d37fde7U, 0x3a978737U, 0x07f7ae87U, 0xb5d77297U, 0x88b75b27U, 0xcf1721f7U, 0xf2770847U,
+    0x10c70814U, 0x2da721a4U, 0x6a075b74U, 0x576772c4U, 0xe547aed4U, 0xd8278764U, 0x9f87fdb4U, 0xa2e7d404U,
+    0x20b743d5U, 0x1dd76a65U, 0x5a7710b5U, 0x67173905U, 0xd537e515U, 0xe857cca5U, 0xaff7b675U, 0x92979fc5U,
+    0xe915e8dbU, 0xd475c16bU, 0x93d5bbbbU, 0xaeb5920bU, 0x1c954e1bU, 0x21f567abU, 0x66551d7bU, 0x5b3534cbU,
+    0xd965a31aU, 0xe4058aaaU, 0xa3a5f07aU, 0x9ec5d9caU, 0x2ce505daU, 0x11852c6aU, 0x562556baU, 0x6b457f0aU,
+    0x89f57f59U, 0xb49556e9U, 0xf3352c39U, 0xce550589U, 0x7c75d999U, 0x4115f029U, 0x06b58af9U, 0x3bd5a349U,
+    0xb9853498U, 0x84e51d28U, 0xc34567f8U, 0xfe254e48U, 0x4c059258U, 0x7165bbe8U, 0x36c5c138U, 0x0ba5e888U,
+    0x28d4c7dfU, 0x15b4ee6fU, 0x521494bfU, 0x6f74bd0fU, 0xdd54611fU, 0xe03448afU, 0xa794327fU, 0x9af41bcfU,
+    0x18a48c1eU, 0x25c4a5aeU, 0x6264df7eU, 0x5f04f6ceU, 0xed242adeU, 0xd044036eU, 0x97e479beU, 0xaa84500eU,
+    0x4834505dU, 0x755479edU, 0x32f4033dU, 0x0f942a8dU, 0xbdb4f69dU, 0x80d4df2dU, 0xc774a5fdU, 0xfa148c4dU,
+    0x78441b9cU, 0x4524322cU, 0x028448fcU, 0x3fe4614cU, 0x8dc4bd5cU, 0xb0a494ecU, 0xf704ee3cU, 0xca64c78cU
+  },
+  {
+    0x00000000U, 0xcb5cd3a5U, 0x4dc8a10bU, 0x869472aeU, 0x9b914216U, 0x50cd91b3U, 0xd659e31dU, 0x1d0530b8U,
+    0xec53826dU, 0x270f51c8U, 0xa19b2366U, 0x6ac7f0c3U, 0x77c2c07bU, 0xbc9e13deU, 0x3a0a6170U, 0xf156b2d5U,
+    0x03d6029bU, 0xc88ad13eU, 0x4e1ea390U, 0x85427035U, 0x9847408dU, 0x531b9328U, 0xd58fe186U, 0x1ed33223U,
+    0xef8580f6U, 0x24d95353U, 0xa24d21fdU, 0x6911f258U, 0x7414c2e0U, 0xbf481145U, 0x39dc63ebU, 0xf280b04eU,
+    0x07ac0536U, 0xccf0d693U, 0x4a64a43dU, 0x81387798U, 0x9c3d4720U, 0x57619485U, 0xd1f5e62bU, 0x1aa9358eU,
+    0xebff875bU, 0x20a354feU, 0xa6372650U, 0x6d6bf5f5U, 0x706ec54dU, 0xbb3216e8U, 0x3da66446U, 0xf6fab7e3U,
+    0x047a07adU, 0xcf26d408U, 0x49b2a6a6U, 0x82ee7503U, 0x9feb45bbU, 0x54b7961eU, 0xd223e4b0U, 0x197f3715U,
+    0xe82985c0U, 0x23755665U, 0xa5e124cbU, 0x6ebdf76eU, 0x73b8c7d6U, 0xb8e41473U, 0x3e7066ddU, 0xf52cb578U,
+    0x0f580a6cU, 0xc404d9c9U, 0x4290ab67U, 0x89cc78c2U, 0x94c9487aU, 0x5f959bdfU, 0xd901e971U, 0x125d3ad4U,
+    0xe30b8801U, 0x28575ba4U, 0xaec3290aU, 0x659ffaafU, 0x789aca17U, 0xb3c619b2U, 0x35526b1cU, 0xfe0eb8b9U,
+    0x0c8e08f7U, 0xc7d2db52U, 0x4146a9fcU, 0x8a1a7a59U, 0x971f4ae1U, 0x5c439944U, 0xdad7ebeaU, 0x118b384fU,
+    0xe0dd8a9aU, 0x2b81593fU, 0xad152b91U, 0x6649f834U, 0x7b4cc88cU, 0xb0101b29U, 0x36846987U, 0xfdd8ba22U,
+    0x08f40f5aU, 0xc3a8dcffU, 0x453cae51U, 0x8e607df4U, 0x93654d4cU, 0x58399ee9U, 0xdeadec47U, 0x15f13fe2U,
+    0xe4a78d37U, 0x2ffb5e92U, 0xa96f2c3cU, 0x6233ff99U, 0x7f36cf21U, 0xb46a1c84U, 0x32fe6e2aU, 0xf9a2bd8fU,
+    0x0b220dc1U, 0xc07ede64U, 0x46eaaccaU, 0x8db67f6fU, 0x90b34fd7U, 0x5bef9c72U, 0xdd7beedcU, 0x16273d79U,
+    0xe7718facU, 0x2c2d5c09U, 0xaab92ea7U, 0x61e5fd02U, 0x7ce0cdbaU, 0xb7bc1e1fU, 0x31286cb1U, 0xfa74bf14U,
+    0x1eb014d8U, 0xd5ecc77dU, 0x5378b5d3U, 0x98246676U, 0x852156ceU, 0x4e7d856bU, 0xc8e9f7c5U, 0x03b52460U,
+    0xf2e396b5U, 0x39bf4510U, 0xbf2b37beU, 0x7477e41bU, 0x6972d4a3U, 0xa22e0706U, 0x24ba75a8U, 0xefe6a60dU,
+    0x1d661643U, 0xd63ac5e6U, 0x50aeb748U, 0x9bf264edU, 0x86f75455U, 0x4dab87f0U, 0xcb3ff55eU, 0x006326fbU,
+    0xf135942eU, 0x3a69478bU, 0xbcfd3525U, 0x77a1e680U, 0x6aa4d638U, 0xa1f8059dU, 0x276c7733U, 0xec30a496U,
+    0x191c11eeU, 0xd240c24bU, 0x54d4b0e5U, 0x9f886340U, 0x828d53f8U, 0x49d1805dU, 0xcf45f2f3U, 0x04192156U,
+    0xf54f9383U, 0x3e134026U, 0xb8873288U, 0x73dbe12dU, 0x6eded195U, 0xa5820230U, 0x2316709eU, 0xe84aa33bU,
+    0x1aca1375U, 0xd196c0d0U, 0x5702b27eU, 0x9c5e61dbU, 0x815b5163U, 0x4a0782c6U, 0xcc93f068U, 0x07cf23cdU,
+    0xf6999118U, 0x3dc542bdU, 0xbb513013U, 0x700de3b6U, 0x6d08d30eU, 0xa65400abU, 0x20c07205U, 0xeb9ca1a0U,
+    0x11e81eb4U, 0xdab4cd11U, 0x5c20bfbfU, 0x977c6c1aU, 0x8a795ca2U, 0x41258f07U, 0xc7b1fda9U, 0x0ced2e0cU,
+    0xfdbb9cd9U, 0x36e74f7cU, 0xb0733dd2U, 0x7b2fee77U, 0x662adecfU, 0xad760d6aU, 0x2be27fc4U, 0xe0beac61U,
+    0x123e1c2fU, 0xd962cf8aU, 0x5ff6bd24U, 0x94aa6e81U, 0x89af5e39U, 0x42f38d9cU, 0xc467ff32U, 0x0f3b2c97U,
+    0xfe6d9e42U, 0x35314de7U, 0xb3a53f49U, 0x78f9ececU, 0x65fcdc54U, 0xaea00ff1U, 0x28347d5fU, 0xe368aefaU,
+    0x16441b82U, 0xdd18c827U, 0x5b8cba89U, 0x90d0692cU, 0x8dd55994U, 0x46898a31U, 0xc01df89fU, 0x0b412b3aU,
+    0xfa1799efU, 0x314b4a4aU, 0xb7df38e4U, 0x7c83eb41U, 0x6186dbf9U, 0xaada085cU, 0x2c4e7af2U, 0xe712a957U,
+    0x15921919U, 0xdececabcU, 0x585ab812U, 0x93066bb7U, 0x8e035b0fU, 0x455f88aaU, 0xc3cbfa04U, 0x089729a1U,
+    0xf9c19b74U, 0x329d48d1U, 0xb4093a7fU, 0x7f55e9daU, 0x6250d962U, 0xa90c0ac7U, 0x2f987869U, 0xe4c4abccU
+  },
+  {
+    0x00000000U, 0xa6770bb4U, 0x979f1129U, 0x31e81a9dU, 0xf44f2413U, 0x52382fa7U, 0x63d0353aU, 0xc5a73e8eU,
+    0x33ef4e67U, 0x959845d3U, 0xa4705f4eU, 0x020754faU, 0xc7a06a74U, 0x61d761c0U, 0x503f7b5dU, 0xf64870e9U,
+    0x67de9cceU, 0xc1a9977aU, 0xf0418de7U, 0x56368653U, 0x9391b8ddU, 0x35e6b369U, 0x040ea9f4U, 0xa279a240U,
+    0x5431d2a9U, 0xf246d91dU, 0xc3aec380U, 0x65d9c834U, 0xa07ef6baU, 0x0609fd0eU, 0x37e1e793U, 0x9196ec27U,
+    0xcfbd399cU, 0x69ca3228U, 0x582228b5U, 0xfe552301U, 0x3bf21d8fU, 0x9d85163bU, 0xac6d0ca6U, 0x0a1a0712U,
+    0xfc5277fbU, 0x5a257c4fU, 0x6bcd66d2U, 0xcdba6d66U, 0x081d53e8U, 0xae6a585cU, 0x9f8242c1U, 0x39f54975U,
+    0xa863a552U, 0x0e14aee6U, 0x3ffcb47bU, 0x998bbfcfU, 0x5c2c8141U, 0xfa5b8af5U, 0xcbb39068U, 0x6dc49bdcU,
+    0x9b8ceb35U, 0x3dfbe081U, 0x0c13fa1cU, 0xaa64f1a8U, 0x6fc3cf26U, 0xc9b4c492U, 0xf85cde0fU, 0x5e2bd5bbU,
+    0x440b7579U, 0xe27c7ecdU, 0xd3946450U, 0x75e36fe4U, 0xb044516aU, 0x16335adeU, 0x27db4043U, 0x81ac4bf7U,
+    0x77e43b1eU, 0xd19330aaU, 0xe07b2a37U, 0x460c2183U, 0x83ab1f0dU, 0x25dc14b9U, 0x14340e24U, 0xb2430590U,
+    0x23d5e9b7U, 0x85a2e203U, 0xb44af89eU, 0x123df32aU, 0xd79acda4U, 0x71edc610U, 0x4005dc8dU, 0xe672d739U,
+    0x103aa7d0U, 0xb64dac64U, 0x87a5b6f9U, 0x21d2bd4dU, 0xe47583c3U, 0x42028877U, 0x73ea92eaU, 0xd59d995eU,
+    0x8bb64ce5U, 0x2dc14751U, 0x1c295dccU, 0xba5e5678U, 0x7ff968f6U, 0xd98e6342U, 0xe86679dfU, 0x4e11726bU,
+    0xb8590282U, 0x1e2e0936U, 0x2fc613abU, 0x89b1181fU, 0x4c162691U, 0xea612d25U, 0xdb8937b8U, 0x7dfe3c0cU,
+    0xec68d02bU, 0x4a1fdb9fU, 0x7bf7c102U, 0xdd80cab6U, 0x1827f438U, 0xbe50ff8cU, 0x8fb8e511U, 0x29cfeea5U,
+    0xdf879e4cU, 0x79f095f8U, 0x48188f65U, 0xee6f84d1U, 0x2bc8ba5fU, 0x8dbfb1ebU, 0xbc57ab76U, 0x1a20a0c2U,
+    0x8816eaf2U, 0x2e61e146U, 0x1f89fbdbU, 0xb9fef06fU, 0x7c59cee1U, 0xda2ec555U, 0xebc6dfc8U, 0x4db1d47cU,
+    0xbbf9a495U, 0x1d8eaf21U, 0x2c66b5bcU, 0x8a11be08U, 0x4fb68086U, 0xe9c18b32U, 0xd82991afU, 0x7e5e9a1bU,
+    0xefc8763cU, 0x49bf7d88U, 0x78576715U, 0xde206ca1U, 0x1b87522fU, 0xbdf0599bU, 0x8c184306U, 0x2a6f48b2U,
+    0xdc27385bU, 0x7a5033efU, 0x4bb82972U, 0xedcf22c6U, 0x28681c48U, 0x8e1f17fcU, 0xbff70d61U, 0x198006d5U,
+    0x47abd36eU, 0xe1dcd8daU, 0xd034c247U, 0x7643c9f3U, 0xb3e4f77dU, 0x1593fcc9U, 0x247be654U, 0x820cede0U,
+    0x74449d09U, 0xd23396bdU, 0xe3db8c20U, 0x45ac8794U, 0x800bb91aU, 0x267cb2aeU, 0x1794a833U, 0xb1e3a387U,
+    0x20754fa0U, 0x86024414U, 0xb7ea5e89U, 0x119d553dU, 0xd43a6bb3U, 0x724d6007U, 0x43a57a9aU, 0xe5d2712eU,
+    0x139a01c7U, 0xb5ed0a73U, 0x840510eeU, 0x22721b5aU, 0xe7d525d4U, 0x41a22e60U, 0x704a34fdU, 0xd63d3f49U,
+    0xcc1d9f8bU, 0x6a6a943fU, 0x5b828ea2U, 0xfdf58516U, 0x3852bb98U, 0x9e25b02cU, 0xafcdaab1U, 0x09baa105U,
+    0xfff2d1ecU, 0x5985da58U, 0x686dc0c5U, 0xce1acb71U, 0x0bbdf5ffU, 0xadcafe4bU, 0x9c22e4d6U, 0x3a55ef62U,
+    0xabc30345U, 0x0db408f1U, 0x3c5c126cU, 0x9a2b19d8U, 0x5f8c2756U, 0xf9fb2ce2U, 0xc813367fU, 0x6e643dcbU,
+    0x982c4d22U, 0x3e5b4696U, 0x0fb35c0bU, 0xa9c457bfU, 0x6c636931U, 0xca146285U, 0xfbfc7818U, 0x5d8b73acU,
+    0x03a0a617U, 0xa5d7ada3U, 0x943fb73eU, 0x3248bc8aU, 0xf7ef8204U, 0x519889b0U, 0x6070932dU, 0xc6079899U,
+    0x304fe870U, 0x9638e3c4U, 0xa7d0f959U, 0x01a7f2edU, 0xc400cc63U, 0x6277c7d7U, 0x539fdd4aU, 0xf5e8d6feU,
+    0x647e3ad9U, 0xc209316dU, 0xf3e12bf0U, 0x55962044U, 0x90311ecaU, 0x3646157eU, 0x07ae0fe3U, 0xa1d90457U,
+    0x579174beU, 0xf1e67f0aU, 0xc00e6597U, 0x66796e23U, 0xa3de50adU, 0x05a95b19U, 0x34414184U, 0x92364a30U
+  },
+  {
+    0x00000000U, 0xccaa009eU, 0x4225077dU, 0x8e8f07e3U, 0x844a0efaU, 0x48e00e64U, 0xc66f0987U, 0x0ac50919U,
+    0xd3e51bb5U, 0x1f4f1b2bU, 0x91c01cc8U, 0x5d6a1c56U, 0x57af154fU, 0x9b0515d1U, 0x158a1232U, 0xd92012acU,
+    0x7cbb312bU, 0xb01131b5U, 0x3e9e3656U, 0xf23436c8U, 0xf8f13fd1U, 0x345b3f4fU, 0xbad438acU, 0x767e3832U,
+    0xaf5e2a9eU, 0x63f42a00U, 0xed7b2de3U, 0x21d12d7dU, 0x2b142464U, 0xe7be24faU, 0x69312319U, 0xa59b2387U,
+    0xf9766256U, 0x35dc62c8U, 0xbb53652bU, 0x77f965b5U, 0x7d3c6cacU, 0xb1966c32U, 0x3f196bd1U, 0xf3b36b4fU,
+    0x2a9379e3U, 0xe639797dU, 0x68b67e9eU, 0xa41c7e00U, 0xaed97719U, 0x62737787U, 0xecfc7064U, 0x205670faU,
+    0x85cd537dU, 0x496753e3U, 0xc7e85400U, 0x0b42549eU, 0x01875d87U, 0xcd2d5d19U, 0x43a25afaU, 0x8f085a64U,
+    0x562848c8U, 0x9a824856U, 0x140d4fb5U, 0xd8a74f2bU, 0xd2624632U, 0x1ec846acU, 0x9047414fU, 0x5ced41d1U,
+    0x299dc2edU, 0xe537c273U, 0x6bb8c590U, 0xa712c50eU, 0xadd7cc17U, 0x617dcc89U, 0xeff2cb6aU, 0x2358cbf4U,
+    0xfa78d958U, 0x36d2d9c6U, 0xb85dde25U, 0x74f7debbU, 0x7e32d7a2U, 0xb298d73cU, 0x3c17d0dfU, 0xf0bdd041U,
+    0x5526f3c6U, 0x998cf358U, 0x1703f4bbU, 0xdba9f425U, 0xd16cfd3cU, 0x1dc6fda2U, 0x9349fa41U, 0x5fe3fadfU,
+    0x86c3e873U, 0x4a69e8edU, 0xc4e6ef0eU, 0x084cef90U, 0x0289e689U, 0xce23e617U, 0x40ace1f4U, 0x8c06e16aU,
+    0xd0eba0bbU, 0x1c41a025U, 0x92cea7c6U, 0x5e64a758U, 0x54a1ae41U, 0x980baedfU, 0x1684a93cU, 0xda2ea9a2U,
+    0x030ebb0eU, 0xcfa4bb90U, 0x412bbc73U, 0x8d81bcedU, 0x8744b5f4U, 0x4beeb56aU, 0xc561b289U, 0x09cbb217U,
+    0xac509190U, 0x60fa910eU, 0xee7596edU, 0x22df9673U, 0x281a9f6aU, 0xe4b09ff4U, 0x6a3f9817U, 0xa6959889U,
+    0x7fb58a25U, 0xb31f8abbU, 0x3d908d58U, 0xf13a8dc6U, 0xfbff84dfU, 0x37558441U, 0xb9da83a2U, 0x7570833cU,
+    0x533b85daU, 0x9f918544U, 0x111e82a7U, 0xddb48239U, 0xd7718b20U, 0x1bdb8bbeU, 0x95548c5dU, 0x59fe8cc3U,
+    0x80de9e6fU, 0x4c749ef1U, 0xc2fb9912U, 0x0e51998cU, 0x04949095U, 0xc83e900bU, 0x46b197e8U, 0x8a1b9776U,
+    0x2f80b4f1U, 0xe32ab46fU, 0x6da5b38cU, 0xa10fb312U, 0xabcaba0bU, 0x6760ba95U, 0xe9efbd76U, 0x2545bde8U,
+    0xfc65af44U, 0x30cfafdaU, 0xbe40a839U, 0x72eaa8a7U, 0x782fa1beU, 0xb485a120U, 0x3a0aa6c3U, 0xf6a0a65dU,
+    0xaa4de78cU, 0x66e7e712U, 0xe868e0f1U, 0x24c2e06fU, 0x2e07e976U, 0xe2ade9e8U, 0x6c22ee0bU, 0xa088ee95U,
+    0x79a8fc39U, 0xb502fca7U, 0x3b8dfb44U, 0xf727fbdaU, 0xfde2f2c3U, 0x3148f25dU, 0xbfc7f5beU, 0x736df520U,
+    0xd6f6d6a7U, 0x1a5cd639U, 0x94d3d1daU, 0x5879d144U, 0x52bcd85dU, 0x9e16d8c3U, 0x1099df20U, 0xdc33dfbeU,
+    0x0513cd12U, 0xc9b9cd8cU, 0x4736ca6fU, 0x8b9ccaf1U, 0x8159c3e8U, 0x4df3c376U, 0xc37cc495U, 0x0fd6c40bU,
+    0x7aa64737U, 0xb60c47a9U, 0x3883404aU, 0xf42940d4U, 0xfeec49cdU, 0x32464953U, 0xbcc94eb0U, 0x70634e2eU,
+    0xa9435c82U, 0x65e95c1cU, 0xeb665bffU, 0x27cc5b61U, 0x2d095278U, 0xe1a352e6U, 0x6f2c5505U, 0xa386559bU,
+    0x061d761cU, 0xcab77682U, 0x44387161U, 0x889271ffU, 0x825778e6U, 0x4efd7878U, 0xc0727f9bU, 0x0cd87f05U,
+    0xd5f86da9U, 0x19526d37U, 0x97dd6ad4U, 0x5b776a4aU, 0x51b26353U, 0x9d1863cdU, 0x1397642eU, 0xdf3d64b0U,
+    0x83d02561U, 0x4f7a25ffU, 0xc1f5221cU, 0x0d5f2282U, 0x079a2b9bU, 0xcb302b05U, 0x45bf2ce6U, 0x89152c78U,
+    0x50353ed4U, 0x9c9f3e4aU, 0x121039a9U, 0xdeba3937U, 0xd47f302eU, 0x18d530b0U, 0x965a3753U, 0x5af037cdU,
+    0xff6b144aU, 0x33c114d4U, 0xbd4e1337U, 0x71e413a9U, 0x7b211ab0U, 0xb78b1a2eU, 0x39041dcdU, 0xf5ae1d53U,
+    0x2c8e0fffU, 0xe0240f61U, 0x6eab0882U, 0xa201081cU, 0xa8c40105U, 0x646e019bU, 0xeae10678U, 0x264b06e6U
+  },
+  {
+    0x00000000U, 0x177b1443U, 0x2ef62886U, 0x398d3cc5U, 0x5dec510cU, 0x4a97454fU, 0x731a798aU, 0x64616dc9U,
+    0xbbd8a218U, 0xaca3b65bU, 0x952e8a9eU, 0x82559eddU, 0xe634f314U, 0xf14fe757U, 0xc8c2db92U, 0xdfb9cfd1U,
+    0xacc04271U, 0xbbbb5632U, 0x82366af7U, 0x954d7eb4U, 0xf12c137dU, 0xe657073eU, 0xdfda3bfbU, 0xc8a12fb8U,
+    0x1718e069U, 0x0063f42aU, 0x39eec8efU, 0x2e95dcacU, 0x4af4b165U, 0x5d8fa526U, 0x640299e3U, 0x73798da0U,
+    0x82f182a3U, 0x958a96e0U, 0xac07aa25U, 0xbb7cbe66U, 0xdf1dd3afU, 0xc866c7ecU, 0xf1ebfb29U, 0xe690ef6aU,
+    0x392920bbU, 0x2e5234f8U, 0x17df083dU, 0x00a41c7eU, 0x64c571b7U, 0x73be65f4U, 0x4a335931U, 0x5d484d72U,
+    0x2e31c0d2U, 0x394ad491U, 0x00c7e854U, 0x17bcfc17U, 0x73dd91deU, 0x64a6859dU, 0x5d2bb958U, 0x4a50ad1bU,
+    0x95e962caU, 0x82927689U, 0xbb1f4a4cU, 0xac645e0fU, 0xc80533c6U, 0xdf7e2785U, 0xe6f31b40U, 0xf1880f03U,
+    0xde920307U, 0xc9e91744U, 0xf0642b81U, 0xe71f3fc2U, 0x837e520bU, 0x94054648U, 0xad887a8dU, 0xbaf36eceU,
+    0x654aa11fU, 0x7231b55cU, 0x4bbc8999U, 0x5cc79ddaU, 0x38a6f013U, 0x2fdde450U, 0x1650d895U, 0x012bccd6U,
+    0x72524176U, 0x65295535U, 0x5ca469f0U, 0x4bdf7db3U, 0x2fbe107aU, 0x38c50439U, 0x014838fcU, 0x16332cbfU,
+    0xc98ae36eU, 0xdef1f72dU, 0xe77ccbe8U, 0xf007dfabU, 0x9466b262U, 0x831da621U, 0xba909ae4U, 0xadeb8ea7U,
+    0x5c6381a4U, 0x4b1895e7U, 0x7295a922U, 0x65eebd61U, 0x018fd0a8U, 0x16f4c4ebU, 0x2f79f82eU, 0x3802ec6dU,
+    0xe7bb23bcU, 0xf0c037ffU, 0xc94d0b3aU, 0xde361f79U, 0xba5772b0U, 0xad2c66f3U, 0x94a15a36U, 0x83da4e75U,
+    0xf0a3c3d5U, 0xe7d8d796U, 0xde55eb53U, 0xc92eff10U, 0xad4f92d9U, 0xba34869aU, 0x83b9ba5fU, 0x94c2ae1cU,
+    0x4b7b61cdU, 0x5c00758eU, 0x658d494bU, 0x72f65d08U, 0x169730c1U, 0x01ec2482U, 0x38611847U, 0x2f1a0c04U,
+    0x6655004fU, 0x712e140cU, 0x48a328c9U, 0x5fd83c8aU, 0x3bb95143U, 0x2cc24500U, 0x154f79c5U, 0x02346d86U,
+    0xdd8da257U, 0xcaf6b614U, 0xf37b8ad1U, 0xe4009e92U, 0x8061f35bU, 0x971ae718U, 0xae97dbddU, 0xb9eccf9eU,
+    0xca95423eU, 0xddee567dU, 0xe4636ab8U, 0xf3187efbU, 0x97791332U, 0x80020771U, 0xb98f3bb4U, 0xaef42ff7U,
+    0x714de026U, 0x6636f465U, 0x5fbbc8a0U, 0x48c0dce3U, 0x2ca1b12aU, 0x3bdaa569U, 0x025799acU, 0x152c8defU,
+    0xe4a482ecU, 0xf3df96afU, 0xca52aa6aU, 0xdd29be29U, 0xb948d3e0U, 0xae33c7a3U, 0x97befb66U, 0x80c5ef25U,
+    0x5f7c20f4U, 0x480734b7U, 0x718a0872U, 0x66f11c31U, 0x029071f8U, 0x15eb65bbU, 0x2c66597eU, 0x3b1d4d3dU,
+    0x4864c09dU, 0x5f1fd4deU, 0x6692e81bU, 0x71e9fc58U, 0x15889191U, 0x02f385d2U, 0x3b7eb917U, 0x2c05ad54U,
+    0xf3bc6285U, 0xe4c776c6U, 0xdd4a4a03U, 0xca315e40U, 0xae503389U, 0xb92b27caU, 0x80a61b0fU, 0x97dd0f4cU,
+    0xb8c70348U, 0xafbc170bU, 0x96312bceU, 0x814a3f8dU, 0xe52b5244U, 0xf2504607U, 0xcbdd7ac2U, 0xdca66e81U,
+    0x031fa150U, 0x1464b513U, 0x2de989d6U, 0x3a929d95U, 0x5ef3f05cU, 0x4988e41fU, 0x7005d8daU, 0x677ecc99U,
+    0x14074139U, 0x037c557aU, 0x3af169bfU, 0x2d8a7dfcU, 0x49eb1035U, 0x5e900476U, 0x671d38b3U, 0x70662cf0U,
+    0xafdfe321U, 0xb8a4f762U, 0x8129cba7U, 0x9652dfe4U, 0xf233b22dU, 0xe548a66eU, 0xdcc59aabU, 0xcbbe8ee8U,
+    0x3a3681ebU, 0x2d4d95a8U, 0x14c0a96dU, 0x03bbbd2eU, 0x67dad0e7U, 0x70a1c4a4U, 0x492cf861U, 0x5e57ec22U,
+    0x81ee23f3U, 0x969537b0U, 0xaf180b75U, 0xb8631f36U, 0xdc0272ffU, 0xcb7966bcU, 0xf2f45a79U, 0xe58f4e3aU,
+    0x96f6c39aU, 0x818dd7d9U, 0xb800eb1cU, 0xaf7bff5fU, 0xcb1a9296U, 0xdc6186d5U, 0xe5ecba10U, 0xf297ae53U,
+    0x2d2e6182U, 0x3a5575c1U, 0x03d84904U, 0x14a35d47U, 0x70c2308eU, 0x67b924cdU, 0x5e341808U, 0x494f0c4bU
+  },
+  {
+    0x00000000U, 0xefc26b3eU, 0x04f5d03dU, 0xeb37bb03U, 0x09eba07aU, 0xe629cb44U, 0x0d1e7047U, 0xe2dc1b79U,
+    0x13d740f4U, 0xfc152bcaU, 0x172290c9U, 0xf8e0fbf7U, 0x1a3ce08eU, 0xf5fe8bb0U, 0x1ec930b3U, 0xf10b5b8dU,
+    0x27ae81e8U, 0xc86cead6U, 0x235b51d5U, 0xcc993aebU, 0x2e452192U, 0xc1874aacU, 0x2ab0f1afU, 0xc5729a91U,
+    0x3479c11cU, 0xdbbbaa22U, 0x308c1121U, 0xdf4e7a1fU, 0x3d926166U, 0xd2500a58U, 0x3967b15bU, 0xd6a5da65U,
+    0x4f5d03d0U, 0xa09f68eeU, 0x4ba8d3edU, 0xa46ab8d3U, 0x46b6a3aaU, 0xa974c894U, 0x42437397U, 0xad8118a9U,
+    0x5c8a4324U, 0xb348281aU, 0x587f9319U, 0xb7bdf827U, 0x5561e35eU, 0xbaa38860U, 0x51943363U, 0xbe56585dU,
+    0x68f38238U, 0x8731e906U, 0x6c065205U, 0x83c4393bU, 0x61182242U, 0x8eda497cU, 0x65edf27fU, 0x8a2f9941U,
+    0x7b24c2ccU, 0x94e6a9f2U, 0x7fd112f1U, 0x901379cfU, 0x72cf62b6U, 0x9d0d0988U, 0x763ab28bU, 0x99f8d9b5U,
+    0x9eba07a0U, 0x71786c9eU, 0x9a4fd79dU, 0x758dbca3U, 0x9751a7daU, 0x7893cce4U, 0x93a477e7U, 0x7c661cd9U,
+    0x8d6d4754U, 0x62af2c6aU, 0x89989769U, 0x665afc57U, 0x8486e72eU, 0x6b448c10U, 0x80733713U, 0x6fb15c2dU,
+    0xb9148648U, 0x56d6ed76U, 0xbde15675U, 0x52233d4bU, 0xb0ff2632U, 0x5f3d4d0cU, 0xb40af60fU, 0x5bc89d31U,
+    0xaac3c6bcU, 0x4501ad82U, 0xae361681U, 0x41f47dbfU, 0xa32866c6U, 0x4cea0df8U, 0xa7ddb6fbU, 0x481fddc5U,
+    0xd1e70470U, 0x3e256f4eU, 0xd512d44dU, 0x3ad0bf73U, 0xd80ca40aU, 0x37cecf34U, 0xdcf97437U, 0x333b1f09U,
+    0xc2304484U, 0x2df22fbaU, 0xc6c594b9U, 0x2907ff87U, 0xcbdbe4feU, 0x24198fc0U, 0xcf2e34c3U, 0x20ec5ffdU,
+    0xf6498598U, 0x198beea6U, 0xf2bc55a5U, 0x1d7e3e9bU, 0xffa225e2U, 0x10604edcU, 0xfb57f5dfU, 0x14959ee1U,
+    0xe59ec56cU, 0x0a5cae52U, 0xe16b1551U, 0x0ea97e6fU, 0xec756516U, 0x03b70e28U, 0xe880b52bU, 0x0742de15U,
+    0xe6050901U, 0x09c7623fU, 0xe2f0d93cU, 0x0d32b202U, 0xefeea97bU, 0x002cc245U, 0xeb1b7946U, 0x04d91278U,
+    0xf5d249f5U, 0x1a1022cbU, 0xf12799c8U, 0x1ee5f2f6U, 0xfc39e98fU, 0x13fb82b1U, 0xf8cc39b2U, 0x170e528cU,
+    0xc1ab88e9U, 0x2e69e3d7U, 0xc55e58d4U, 0x2a9c33eaU, 0xc8402893U, 0x278243adU, 0xccb5f8aeU, 0x23779390U,
+    0xd27cc81dU, 0x3dbea323U, 0xd6891820U, 0x394b731eU, 0xdb976867U, 0x34550359U, 0xdf62b85aU, 0x30a0d364U,
+    0xa9580ad1U, 0x469a61efU, 0xadaddaecU, 0x426fb1d2U, 0xa0b3aaabU, 0x4f71c195U, 0xa4467a96U, 0x4b8411a8U,
+    0xba8f4a25U, 0x554d211bU, 0xbe7a9a18U, 0x51b8f126U, 0xb364ea5fU, 0x5ca68161U, 0xb7913a62U, 0x5853515cU,
+    0x8ef68b39U, 0x6134e007U, 0x8a035b04U, 0x65c1303aU, 0x871d2b43U, 0x68df407dU, 0x83e8fb7eU, 0x6c2a9040U,
+    0x9d21cbcdU, 0x72e3a0f3U, 0x99d41bf0U, 0x761670ceU, 0x94ca6bb7U, 0x7b080089U, 0x903fbb8aU, 0x7ffdd0b4U,
+    0x78bf0ea1U, 0x977d659fU, 0x7c4ade9cU, 0x9388b5a2U, 0x7154aedbU, 0x9e96c5e5U, 0x75a17ee6U, 0x9a6315d8U,
+    0x6b684e55U, 0x84aa256bU, 0x6f9d9e68U, 0x805ff556U, 0x6283ee2fU, 0x8d418511U, 0x66763e12U, 0x89b4552cU,
+    0x5f118f49U, 0xb0d3e477U, 0x5be45f74U, 0xb426344aU, 0x56fa2f33U, 0xb938440dU, 0x520fff0eU, 0xbdcd9430U,
+    0x4cc6cfbdU, 0xa304a483U, 0x48331f80U, 0xa7f174beU, 0x452d6fc7U, 0xaaef04f9U, 0x41d8bffaU, 0xae1ad4c4U,
+    0x37e20d71U, 0xd820664fU, 0x3317dd4cU, 0xdcd5b672U, 0x3e09ad0bU, 0xd1cbc635U, 0x3afc7d36U, 0xd53e1608U,
+    0x24354d85U, 0xcbf726bbU, 0x20c09db8U, 0xcf02f686U, 0x2ddeedffU, 0xc21c86c1U, 0x292b3dc2U, 0xc6e956fcU,
+    0x104c8c99U, 0xff8ee7a7U, 0x14b95ca4U, 0xfb7b379aU, 0x19a72ce3U, 0xf66547ddU, 0x1d52fcdeU, 0xf29097e0U,
+    0x039bcc6dU, 0xec59a753U, 0x076e1c50U, 0xe8ac776eU, 0x0a706c17U, 0xe5b20729U, 0x0e85bc2aU, 0xe147d714U
+  },
+  {
+    0x00000000U, 0xc18edfc0U, 0x586cb9c1U, 0x99e26601U, 0xb0d97382U, 0x7157ac42U, 0xe8b5ca43U, 0x293b1583U,
+    0xbac3e145U, 0x7b4d3e85U, 0xe2af5884U, 0x23218744U, 0x0a1a92c7U, 0xcb944d07U, 0x52762b06U, 0x93f8f4c6U,
+    0xaef6c4cbU, 0x6f781b0bU, 0xf69a7d0aU, 0x3714a2caU, 0x1e2fb749U, 0xdfa16889U, 0x46430e88U, 0x87cdd148U,
+    0x1435258eU, 0xd5bbfa4eU, 0x4c599c4fU, 0x8dd7438fU, 0xa4ec560cU, 0x656289ccU, 0xfc80efcdU, 0x3d0e300dU,
+    0x869c8fd7U, 0x47125017U, 0xdef03616U, 0x1f7ee9d6U, 0x3645fc55U, 0xf7cb2395U, 0x6e294594U, 0xafa79a54U,
+    0x3c5f6e92U, 0xfdd1b152U, 0x6433d753U, 0xa5bd0893U, 0x8c861d10U, 0x4d08c2d0U, 0xd4eaa4d1U, 0x15647b11U,
+    0x286a4b1cU, 0xe9e494dcU, 0x7006f2ddU, 0xb1882d1dU, 0x98b3389eU, 0x593de75eU, 0xc0df815fU, 0x01515e9fU,
+    0x92a9aa59U, 0x53277599U, 0xcac51398U, 0x0b4bcc58U, 0x2270d9dbU, 0xe3fe061bU, 0x7a1c601aU, 0xbb92bfdaU,
+    0xd64819efU, 0x17c6c62fU, 0x8e24a02eU, 0x4faa7feeU, 0x66916a6dU, 0xa71fb5adU, 0x3efdd3acU, 0xff730c6cU,
+    0x6c8bf8aaU, 0xad05276aU, 0x34e7416bU, 0xf5699eabU, 0xdc528b28U, 0x1ddc54e8U, 0x843e32e9U, 0x45b0ed29U,
+    0x78bedd24U, 0xb93002e4U, 0x20d264e5U, 0xe15cbb25U, 0xc867aea6U, 0x09e97166U, 0x900b1767U, 0x5185c8a7U,
+    0xc27d3c61U, 0x03f3e3a1U, 0x9a1185a0U, 0x5b9f5a60U, 0x72a44fe3U, 0xb32a9023U, 0x2ac8f622U, 0xeb4629e2U,
+    0x50d49638U, 0x915a49f8U, 0x08b82ff9U, 0xc936f039U, 0xe00de5baU, 0x21833a7aU, 0xb8615c7bU, 0x79ef83bbU,
+    0xea17777dU, 0x2b99a8bdU, 0xb27bcebcU, 0x73f5117cU, 0x5ace04ffU, 0x9b40db3fU, 0x02a2bd3eU, 0xc32c62feU,
+    0xfe2252f3U, 0x3fac8d33U, 0xa64eeb32U, 0x67c034f2U, 0x4efb2171U, 0x8f75feb1U, 0x169798b0U, 0xd7194770U,
+    0x44e1b3b6U, 0x856f6c76U, 0x1c8d0a77U, 0xdd03d5b7U, 0xf438c034U, 0x35b61ff4U, 0xac5479f5U, 0x6ddaa635U,
+    0x77e1359fU, 0xb66fea5fU, 0x2f8d8c5eU, 0xee03539eU, 0xc738461dU, 0x06b699ddU, 0x9f54ffdcU, 0x5eda201cU,
+    0xcd22d4daU, 0x0cac0b1aU, 0x954e6d1bU, 0x54c0b2dbU, 0x7dfba758U, 0xbc757898U, 0x25971e99U, 0xe419c159U,
+    0xd917f154U, 0x18992e94U, 0x817b4895U, 0x40f59755U, 0x69ce82d6U, 0xa8405d16U, 0x31a23b17U, 0xf02ce4d7U,
+    0x63d41011U, 0xa25acfd1U, 0x3bb8a9d0U, 0xfa367610U, 0xd30d6393U, 0x1283bc53U, 0x8b61da52U, 0x4aef0592U,
+    0xf17dba48U, 0x30f36588U, 0xa9110389U, 0x689fdc49U, 0x41a4c9caU, 0x802a160aU, 0x19c8700bU, 0xd846afcbU,
+    0x4bbe5b0dU, 0x8a3084cdU, 0x13d2e2ccU, 0xd25c3d0cU, 0xfb67288fU, 0x3ae9f74fU, 0xa30b914eU, 0x62854e8eU,
+    0x5f8b7e83U, 0x9e05a143U, 0x07e7c742U, 0xc6691882U, 0xef520d01U, 0x2edcd2c1U, 0xb73eb4c0U, 0x76b06b00U,
+    0xe5489fc6U, 0x24c64006U, 0xbd242607U, 0x7caaf9c7U, 0x5591ec44U, 0x941f3384U, 0x0dfd5585U, 0xcc738a45U,
+    0xa1a92c70U, 0x6027f3b0U, 0xf9c595b1U, 0x384b4a71U, 0x11705ff2U, 0xd0fe8032U, 0x491ce633U, 0x889239f3U,
+    0x1b6acd35U, 0xdae412f5U, 0x430674f4U, 0x8288ab34U, 0xabb3beb7U, 0x6a3d6177U, 0xf3df0776U, 0x3251d8b6U,
+    0x0f5fe8bbU, 0xced1377bU, 0x5733517aU, 0x96bd8ebaU, 0xbf869b39U, 0x7e0844f9U, 0xe7ea22f8U, 0x2664fd38U,
+    0xb59c09feU, 0x7412d63eU, 0xedf0b03fU, 0x2c7e6fffU, 0x05457a7cU, 0xc4cba5bcU, 0x5d29c3bdU, 0x9ca71c7dU,
+    0x2735a3a7U, 0xe6bb7c67U, 0x7f591a66U, 0xbed7c5a6U, 0x97ecd025U, 0x56620fe5U, 0xcf8069e4U, 0x0e0eb624U,
+    0x9df642e2U, 0x5c789d22U, 0xc59afb23U, 0x041424e3U, 0x2d2f3160U, 0xeca1eea0U, 0x754388a1U, 0xb4cd5761U,
+    0x89c3676cU, 0x484db8acU, 0xd1afdeadU, 0x1021016dU, 0x391a14eeU, 0xf894cb2eU, 0x6176ad2fU, 0xa0f872efU,
+    0x33008629U, 0xf28e59e9U, 0x6b6c3fe8U, 0xaae2e028U, 0x83d9f5abU, 0x42572a6bU, 0xdbb54c6aU, 0x1a3b93aaU
+  },
+  {
+    0x00000000U, 0x9ba54c6fU, 0xec3b9e9fU, 0x779ed2f0U, 0x03063b7fU, 0x98a37710U, 0xef3da5e0U, 0x7498e98fU,
+    0x060c76feU, 0x9da93a91U, 0xea37e861U, 0x7192a40eU, 0x050a4d81U, 0x9eaf01eeU, 0xe931d31eU, 0x72949f71U,
+    0x0c18edfcU, 0x97bda193U, 0xe0237363U, 0x7b863f0cU, 0x0f1ed683U, 0x94bb9aecU, 0xe325481cU, 0x78800473U,
+    0x0a149b02U, 0x91b1d76dU, 0xe62f059dU, 0x7d8a49f2U, 0x0912a07dU, 0x92b7ec12U, 0xe5293ee2U, 0x7e8c728dU,
+    0x1831dbf8U, 0x83949797U, 0xf40a4567U, 0x6faf0908U, 0x1b37e087U, 0x8092ace8U, 0xf70c7e18U, 0x6ca93277U,
+    0x1e3dad06U, 0x8598e169U, 0xf2063399U, 0x69a37ff6U, 0x1d3b9679U, 0x869eda16U, 0xf10008e6U, 0x6aa54489U,
+    0x14293604U, 0x8f8c7a6bU, 0xf812a89bU, 0x63b7e4f4U, 0x172f0d7bU, 0x8c8a4114U, 0xfb1493e4U, 0x60b1df8bU,
+    0x122540faU, 0x89800c95U, 0xfe1ede65U, 0x65bb920aU, 0x11237b85U, 0x8a8637eaU, 0xfd18e51aU, 0x66bda975U,
+    0x3063b7f0U, 0xabc6fb9fU, 0xdc58296fU, 0x47fd6500U, 0x33658c8fU, 0xa8c0c0e0U, 0xdf5e1210U, 0x44fb5e7fU,
+    0x366fc10eU, 0xadca8d61U, 0xda545f91U, 0x41f113feU, 0x3569fa71U, 0xaeccb61eU, 0xd95264eeU, 0x42f72881U,
+    0x3c7b5a0cU, 0xa7de1663U, 0xd040c493U, 0x4be588fcU, 0x3f7d6173U, 0xa4d82d1cU, 0xd346ffecU, 0x48e3b383U,
+    0x3a772cf2U, 0xa1d2609dU, 0xd64cb26dU, 0x4de9fe02U, 0x3971178dU, 0xa2d45be2U, 0xd54a8912U, 0x4eefc57dU,
+    0x28526c08U, 0xb3f72067U, 0xc469f297U, 0x5fccbef8U, 0x2b545777U, 0xb0f11b18U, 0xc76fc9e8U, 0x5cca8587U,
+    0x2e5e1af6U, 0xb5fb5699U, 0xc2658469U, 0x59c0c806U, 0x2d582189U, 0xb6fd6de6U, 0xc163bf16U, 0x5ac6f379U,
+    0x244a81f4U, 0xbfefcd9bU, 0xc8711f6bU, 0x53d45304U, 0x274cba8bU, 0xbce9f6e4U, 0xcb772414U, 0x50d2687bU,
+    0x2246f70aU, 0xb9e3bb65U, 0xce7d6995U, 0x55d825faU, 0x2140cc75U, 0xbae5801aU, 0xcd7b52eaU, 0x56de1e85U,
+    0x60c76fe0U, 0xfb62238fU, 0x8cfcf17fU, 0x1759bd10U, 0x63c1549fU, 0xf86418f0U, 0x8ffaca00U, 0x145f866fU,
+    0x66cb191eU, 0xfd6e5571U, 0x8af08781U, 0x1155cbeeU, 0x65cd2261U, 0xfe686e0eU, 0x89f6bcfeU, 0x1253f091U,
+    0x6cdf821cU, 0xf77ace73U, 0x80e41c83U, 0x1b4150ecU, 0x6fd9b963U, 0xf47cf50cU, 0x83e227fcU, 0x18476b93U,
+    0x6ad3f4e2U, 0xf176b88dU, 0x86e86a7dU, 0x1d4d2612U, 0x69d5cf9dU, 0xf27083f2U, 0x85ee5102U, 0x1e4b1d6dU,
+    0x78f6b418U, 0xe353f877U, 0x94cd2a87U, 0x0f6866e8U, 0x7bf08f67U, 0xe055c308U, 0x97cb11f8U, 0x0c6e5d97U,
+    0x7efac2e6U, 0xe55f8e89U, 0x92c15c79U, 0x09641016U, 0x7dfcf999U, 0xe659b5f6U, 0x91c76706U, 0x0a622b69U,
+    0x74ee59e4U, 0xef4b158bU, 0x98d5c77bU, 0x03708b14U, 0x77e8629bU, 0xec4d2ef4U, 0x9bd3fc04U, 0x0076b06bU,
+    0x72e22f1aU, 0xe9476375U, 0x9ed9b185U, 0x057cfdeaU, 0x71e41465U, 0xea41580aU, 0x9ddf8afaU, 0x067ac695U,
+    0x50a4d810U, 0xcb01947fU, 0xbc9f468fU, 0x273a0ae0U, 0x53a2e36fU, 0xc807af00U, 0xbf997df0U, 0x243c319fU,
+    0x56a8aeeeU, 0xcd0de281U, 0xba933071U, 0x21367c1eU, 0x55ae9591U, 0xce0bd9feU, 0xb9950b0eU, 0x22304761U,
+    0x5cbc35ecU, 0xc7197983U, 0xb087ab73U, 0x2b22e71cU, 0x5fba0e93U, 0xc41f42fcU, 0xb381900cU, 0x2824dc63U,
+    0x5ab04312U, 0xc1150f7dU, 0xb68bdd8dU, 0x2d2e91e2U, 0x59b6786dU, 0xc2133402U, 0xb58de6f2U, 0x2e28aa9dU,
+    0x489503e8U, 0xd3304f87U, 0xa4ae9d77U, 0x3f0bd118U, 0x4b933897U, 0xd03674f8U, 0xa7a8a608U, 0x3c0dea67U,
+    0x4e997516U, 0xd53c3979U, 0xa2a2eb89U, 0x3907a7e6U, 0x4d9f4e69U, 0xd63a0206U, 0xa1a4d0f6U, 0x3a019c99U,
+    0x448dee14U, 0xdf28a27bU, 0xa8b6708bU, 0x33133ce4U, 0x478bd56bU, 0xdc2e9904U, 0xabb04bf4U, 0x3015079bU,
+    0x428198eaU, 0xd924d485U, 0xaeba0675U, 0x351f4a1aU, 0x4187a395U, 0xda22effaU, 0xadbc3d0aU, 0x36197165U
+  },
+  {
+    0x00000000U, 0xdd96d985U, 0x605cb54bU, 0xbdca6cceU, 0xc0b96a96U, 0x1d2fb313U, 0xa0e5dfddU, 0x7d730658U,
+    0x5a03d36dU, 0x87950ae8U, 0x3a5f6626U, 0xe7c9bfa3U, 0x9abab9fbU, 0x472c607eU, 0xfae60cb0U, 0x2770d535U,
+    0xb407a6daU, 0x69917f5fU, 0xd45b1391U, 0x09cdca14U, 0x74becc4cU, 0xa92815c9U, 0x14e27907U, 0xc974a082U,
+    0xee0475b7U, 0x3392ac32U, 0x8e58c0fcU, 0x53ce1979U, 0x2ebd1f21U, 0xf32bc6a4U, 0x4ee1aa6aU, 0x937773efU,
+    0xb37e4bf5U, 0x6ee89270U, 0xd322febeU, 0x0eb4273bU, 0x73c72163U, 0xae51f8e6U, 0x139b9428U, 0xce0d4dadU,
+    0xe97d9898U, 0x34eb411dU, 0x89212dd3U, 0x54b7f456U, 0x29c4f20eU, 0xf4522b8bU, 0x49984745U, 0x940e9ec0U,
+    0x0779ed2fU, 0xdaef34aaU, 0x67255864U, 0xbab381e1U, 0xc7c087b9U, 0x1a565e3cU, 0xa79c32f2U, 0x7a0aeb77U,
+    0x5d7a3e42U, 0x80ece7c7U, 0x3d268b09U, 0xe0b0528cU, 0x9dc354d4U, 0x40558d51U, 0xfd9fe19fU, 0x2009381aU,
+    0xbd8d91abU, 0x601b482eU, 0xddd124e0U, 0x0047fd65U, 0x7d34fb3dU, 0xa0a222b8U, 0x1d684e76U, 0xc0fe97f3U,
+    0xe78e42c6U, 0x3a189b43U, 0x87d2f78dU, 0x5a442e08U, 0x27372850U, 0xfaa1f1d5U, 0x476b9d1bU, 0x9afd449eU,
+    0x098a3771U, 0xd41ceef4U, 0x69d6823aU, 0xb4405bbfU, 0xc9335de7U, 0x14a58462U, 0xa96fe8acU, 0x74f93129U,
+    0x5389e41cU, 0x8e1f3d99U, 0x33d55157U, 0xee4388d2U, 0x93308e8aU, 0x4ea6570fU, 0xf36c3bc1U, 0x2efae244U,
+    0x0ef3da5eU, 0xd36503dbU, 0x6eaf6f15U, 0xb339b690U, 0xce4ab0c8U, 0x13dc694dU, 0xae160583U, 0x7380dc06U,
+    0x54f00933U, 0x8966d0b6U, 0x34acbc78U, 0xe93a65fdU, 0x944963a5U, 0x49dfba20U, 0xf415d6eeU, 0x29830f6bU,
+    0xbaf47c84U, 0x6762a501U, 0xdaa8c9cfU, 0x073e104aU, 0x7a4d1612U, 0xa7dbcf97U, 0x1a11a359U, 0xc7877adcU,
+    0xe0f7afe9U, 0x3d61766cU, 0x80ab1aa2U, 0x5d3dc327U, 0x204ec57fU, 0xfdd81cfaU, 0x40127034U, 0x9d84a9b1U,
+    0xa06a2517U, 0x7dfcfc92U, 0xc036905cU, 0x1da049d9U, 0x60d34f81U, 0xbd459604U, 0x008ffacaU, 0xdd19234fU,
+    0xfa69f67aU, 0x27ff2fffU, 0x9a354331U, 0x47a39ab4U, 0x3ad09cecU, 0xe7464569U, 0x5a8c29a7U, 0x871af022U,
+    0x146d83cdU, 0xc9fb5a48U, 0x74313686U, 0xa9a7ef03U, 0xd4d4e95bU, 0x094230deU, 0xb4885c10U, 0x691e8595U,
+    0x4e6e50a0U, 0x93f88925U, 0x2e32e5ebU, 0xf3a43c6eU, 0x8ed73a36U, 0x5341e3b3U, 0xee8b8f7dU, 0x331d56f8U,
+    0x13146ee2U, 0xce82b767U, 0x7348dba9U, 0xaede022cU, 0xd3ad0474U, 0x0e3bddf1U, 0xb3f1b13fU, 0x6e6768baU,
+    0x4917bd8fU, 0x9481640aU, 0x294b08c4U, 0xf4ddd141U, 0x89aed719U, 0x54380e9cU, 0xe9f26252U, 0x3464bbd7U,
+    0xa713c838U, 0x7a8511bdU, 0xc74f7d73U, 0x1ad9a4f6U, 0x67aaa2aeU, 0xba3c7b2bU, 0x07f617e5U, 0xda60ce60U,
+    0xfd101b55U, 0x2086c2d0U, 0x9d4cae1eU, 0x40da779bU, 0x3da971c3U, 0xe03fa846U, 0x5df5c488U, 0x80631d0dU,
+    0x1de7b4bcU, 0xc0716d39U, 0x7dbb01f7U, 0xa02dd872U, 0xdd5ede2aU, 0x00c807afU, 0xbd026b61U, 0x6094b2e4U,
+    0x47e467d1U, 0x9a72be54U, 0x27b8d29aU, 0xfa2e0b1fU, 0x875d0d47U, 0x5acbd4c2U, 0xe701b80cU, 0x3a976189U,
+    0xa9e01266U, 0x7476cbe3U, 0xc9bca72dU, 0x142a7ea8U, 0x695978f0U, 0xb4cfa175U, 0x0905cdbbU, 0xd493143eU,
+    0xf3e3c10bU, 0x2e75188eU, 0x93bf7440U, 0x4e29adc5U, 0x335aab9dU, 0xeecc7218U, 0x53061ed6U, 0x8e90c753U,
+    0xae99ff49U, 0x730f26ccU, 0xcec54a02U, 0x13539387U, 0x6e2095dfU, 0xb3b64c5aU, 0x0e7c2094U, 0xd3eaf911U,
+    0xf49a2c24U, 0x290cf5a1U, 0x94c6996fU, 0x495040eaU, 0x342346b2U, 0xe9b59f37U, 0x547ff3f9U, 0x89e92a7cU,
+    0x1a9e5993U, 0xc7088016U, 0x7ac2ecd8U, 0xa754355dU, 0xda273305U, 0x07b1ea80U, 0xba7b864eU, 0x67ed5fcbU,
+    0x409d8afeU, 0x9d0b537bU, 0x20c13fb5U, 0xfd57e630U, 0x8024e068U, 0x5db239edU, 0xe0785523U, 0x3dee8ca6U
+  },
+  {
+    0x00000000U, 0x9d0fe176U, 0xe16ec4adU, 0x7c6125dbU, 0x19ac8f1bU, 0x84a36e6dU, 0xf8c24bb6U, 0x65cdaac0U,
+    0x33591e36U, 0xae56ff40U, 0xd237da9bU, 0x4f383bedU, 0x2af5912dU, 0xb7fa705bU, 0xcb9b5580U, 0x5694b4f6U,
+    0x66b23c6cU, 0xfbbddd1aU, 0x87dcf8c1U, 0x1ad319b7U, 0x7f1eb377U, 0xe2115201U, 0x9e7077daU, 0x037f96acU,
+    0x55eb225aU, 0xc8e4c32cU, 0xb485e6f7U, 0x298a0781U, 0x4c47ad41U, 0xd1484c37U, 0xad2969ecU, 0x3026889aU,
+    0xcd6478d8U, 0x506b99aeU, 0x2c0abc75U, 0xb1055d03U, 0xd4c8f7c3U, 0x49c716b5U, 0x35a6336eU, 0xa8a9d218U,
+    0xfe3d66eeU, 0x63328798U, 0x1f53a243U, 0x825c4335U, 0xe791e9f5U, 0x7a9e0883U, 0x06ff2d58U, 0x9bf0cc2eU,
+    0xabd644b4U, 0x36d9a5c2U, 0x4ab88019U, 0xd7b7616fU, 0xb27acbafU, 0x2f752ad9U, 0x53140f02U, 0xce1bee74U,
+    0x988f5a82U, 0x0580bbf4U, 0x79e19e2fU, 0xe4ee7f59U, 0x8123d599U, 0x1c2c34efU, 0x604d1134U, 0xfd42f042U,
+    0x41b9f7f1U, 0xdcb61687U, 0xa0d7335cU, 0x3dd8d22aU, 0x581578eaU, 0xc51a999cU, 0xb97bbc47U, 0x24745d31U,
+    0x72e0e9c7U, 0xefef08b1U, 0x938e2d6aU, 0x0e81cc1cU, 0x6b4c66dcU, 0xf64387aaU, 0x8a22a271U, 0x172d4307U,
+    0x270bcb9dU, 0xba042aebU, 0xc6650f30U, 0x5b6aee46U, 0x3ea74486U, 0xa3a8a5f0U, 0xdfc9802bU, 0x42c6615dU,
+    0x1452d5abU, 0x895d34ddU, 0xf53c1106U, 0x6833f070U, 0x0dfe5ab0U, 0x90f1bbc6U, 0xec909e1dU, 0x719f7f6bU,
+    0x8cdd8f29U, 0x11d26e5fU, 0x6db34b84U, 0xf0bcaaf2U, 0x95710032U, 0x087ee144U, 0x741fc49fU, 0xe91025e9U,
+    0xbf84911fU, 0x228b7069U, 0x5eea55b2U, 0xc3e5b4c4U, 0xa6281e04U, 0x3b27ff72U, 0x4746daa9U, 0xda493bdfU,
+    0xea6fb345U, 0x77605233U, 0x0b0177e8U, 0x960e969eU, 0xf3c33c5eU, 0x6eccdd28U, 0x12adf8f3U, 0x8fa21985U,
+    0xd936ad73U, 0x44394c05U, 0x385869deU, 0xa55788a8U, 0xc09a2268U, 0x5d95c31eU, 0x21f4e6c5U, 0xbcfb07b3U,
+    0x8373efe2U, 0x1e7c0e94U, 0x621d2b4fU, 0xff12ca39U, 0x9adf60f9U, 0x07d0818fU, 0x7bb1a454U, 0xe6be4522U,
+    0xb02af1d4U, 0x2d2510a2U, 0x51443579U, 0xcc4bd40fU, 0xa9867ecfU, 0x34899fb9U, 0x48e8ba62U, 0xd5e75b14U,
+    0xe5c1d38eU, 0x78ce32f8U, 0x04af1723U, 0x99a0f655U, 0xfc6d5c95U, 0x6162bde3U, 0x1d039838U, 0x800c794eU,
+    0xd698cdb8U, 0x4b972cceU, 0x37f60915U, 0xaaf9e863U, 0xcf3442a3U, 0x523ba3d5U, 0x2e5a860eU, 0xb3556778U,
+    0x4e17973aU, 0xd318764cU, 0xaf795397U, 0x3276b2e1U, 0x57bb1821U, 0xcab4f957U, 0xb6d5dc8cU, 0x2bda3dfaU,
+    0x7d4e890cU, 0xe041687aU, 0x9c204da1U, 0x012facd7U, 0x64e20617U, 0xf9ede761U, 0x858cc2baU, 0x188323ccU,
+    0x28a5ab56U, 0xb5aa4a20U, 0xc9cb6ffbU, 0x54c48e8dU, 0x3109244dU, 0xac06c53bU, 0xd067e0e0U, 0x4d680196U,
+    0x1bfcb560U, 0x86f35416U, 0xfa9271cdU, 0x679d90bbU, 0x02503a7bU, 0x9f5fdb0dU, 0xe33efed6U, 0x7e311fa0U,
+    0xc2ca1813U, 0x5fc5f965U, 0x23a4dcbeU, 0xbeab3dc8U, 0xdb669708U, 0x4669767eU, 0x3a0853a5U, 0xa707b2d3U,
+    0xf1930625U, 0x6c9ce753U, 0x10fdc288U, 0x8df223feU, 0xe83f893eU, 0x75306848U, 0x09514d93U, 0x945eace5U,
+    0xa478247fU, 0x3977c509U, 0x4516e0d2U, 0xd81901a4U, 0xbdd4ab64U, 0x20db4a12U, 0x5cba6fc9U, 0xc1b58ebfU,
+    0x97213a49U, 0x0a2edb3fU, 0x764ffee4U, 0xeb401f92U, 0x8e8db552U, 0x13825424U, 0x6fe371ffU, 0xf2ec9089U,
+    0x0fae60cbU, 0x92a181bdU, 0xeec0a466U, 0x73cf4510U, 0x1602efd0U, 0x8b0d0ea6U, 0xf76c2b7dU, 0x6a63ca0bU,
+    0x3cf77efdU, 0xa1f89f8bU, 0xdd99ba50U, 0x40965b26U, 0x255bf1e6U, 0xb8541090U, 0xc435354bU, 0x593ad43dU,
+    0x691c5ca7U, 0xf413bdd1U, 0x8872980aU, 0x157d797cU, 0x70b0d3bcU, 0xedbf32caU, 0x91de1711U, 0x0cd1f667U,
+    0x5a454291U, 0xc74aa3e7U, 0xbb2b863cU, 0x2624674aU, 0x43e9cd8aU, 0xdee62cfcU, 0xa2870927U, 0x3f88e851U
+  },
+  {
+    0x00000000U, 0xb9fbdbe8U, 0xa886b191U, 0x117d6a79U, 0x8a7c6563U, 0x3387be8bU, 0x22fad4f2U, 0x9b010f1aU,
+    0xcf89cc87U, 0x7672176fU, 0x670f7d16U, 0xdef4a6feU, 0x45f5a9e4U, 0xfc0e720cU, 0xed731875U, 0x5488c39dU,
+    0x44629f4fU, 0xfd9944a7U, 0xece42edeU, 0x551ff536U, 0xce1efa2cU, 0x77e521c4U, 0x66984bbdU, 0xdf639055U,
+    0x8beb53c8U, 0x32108820U, 0x236de259U, 0x9a9639b1U, 0x019736abU, 0xb86ced43U, 0xa911873aU, 0x10ea5cd2U,
+    0x88c53e9eU, 0x313ee576U, 0x20438f0fU, 0x99b854e7U, 0x02b95bfdU, 0xbb428015U, 0xaa3fea6cU, 0x13c43184U,
+    0x474cf219U, 0xfeb729f1U, 0xefca4388U, 0x56319860U, 0xcd30977aU, 0x74cb4c92U, 0x65b626ebU, 0xdc4dfd03U,
+    0xcca7a1d1U, 0x755c7a39U, 0x64211040U, 0xdddacba8U, 0x46dbc4b2U, 0xff201f5aU, 0xee5d7523U, 0x57a6aecbU,
+    0x032e6d56U, 0xbad5b6beU, 0xaba8dcc7U, 0x1253072fU, 0x89520835U, 0x30a9d3ddU, 0x21d4b9a4U, 0x982f624cU,
+    0xcafb7b7dU, 0x7300a095U, 0x627dcaecU, 0xdb861104U, 0x40871e1eU, 0xf97cc5f6U, 0xe801af8fU, 0x51fa7467U,
+    0x0572b7faU, 0xbc896c12U, 0xadf4066bU, 0x140fdd83U, 0x8f0ed299U, 0x36f50971U, 0x27886308U, 0x9e73b8e0U,
+    0x8e99e432U, 0x37623fdaU, 0x261f55a3U, 0x9fe48e4bU, 0x04e58151U, 0xbd1e5ab9U, 0xac6330c0U, 0x1598eb28U,
+    0x411028b5U, 0xf8ebf35dU, 0xe9969924U, 0x506d42ccU, 0xcb6c4dd6U, 0x7297963eU, 0x63eafc47U, 0xda1127afU,
+    0x423e45e3U, 0xfbc59e0bU, 0xeab8f472U, 0x53432f9aU, 0xc8422080U, 0x71b9fb68U, 0x60c49111U, 0xd93f4af9U,
+    0x8db78964U, 0x344c528cU, 0x253138f5U, 0x9ccae31dU, 0x07cbec07U, 0xbe3037efU, 0xaf4d5d96U, 0x16b6867eU,
+    0x065cdaacU, 0xbfa70144U, 0xaeda6b3dU, 0x1721b0d5U, 0x8c20bfcfU, 0x35db6427U, 0x24a60e5eU, 0x9d5dd5b6U,
+    0xc9d5162bU, 0x702ecdc3U, 0x6153a7baU, 0xd8a87c52U, 0x43a97348U, 0xfa52a8a0U, 0xeb2fc2d9U, 0x52d41931U,
+    0x4e87f0bbU, 0xf77c2b53U, 0xe601412aU, 0x5ffa9ac2U, 0xc4fb95d8U, 0x7d004e30U, 0x6c7d2449U, 0xd586ffa1U,
+    0x810e3c3cU, 0x38f5e7d4U, 0x29888dadU, 0x90735645U, 0x0b72595fU, 0xb28982b7U, 0xa3f4e8ceU, 0x1a0f3326U,
+    0x0ae56ff4U, 0xb31eb41cU, 0xa263de65U, 0x1b98058dU, 0x80990a97U, 0x3962d17fU, 0x281fbb06U, 0x91e460eeU,
+    0xc56ca373U, 0x7c97789bU, 0x6dea12e2U, 0xd411c90aU, 0x4f10c610U, 0xf6eb1df8U, 0xe7967781U, 0x5e6dac69U,
+    0xc642ce25U, 0x7fb915cdU, 0x6ec47fb4U, 0xd73fa45cU, 0x4c3eab46U, 0xf5c570aeU, 0xe4b81ad7U, 0x5d43c13fU,
+    0x09cb02a2U, 0xb030d94aU, 0xa14db333U, 0x18b668dbU, 0x83b767c1U, 0x3a4cbc29U, 0x2b31d650U, 0x92ca0db8U,
+    0x8220516aU, 0x3bdb8a82U, 0x2aa6e0fbU, 0x935d3b13U, 0x085c3409U, 0xb1a7efe1U, 0xa0da8598U, 0x19215e70U,
+    0x4da99dedU, 0xf4524605U, 0xe52f2c7cU, 0x5cd4f794U, 0xc7d5f88eU, 0x7e2e2366U, 0x6f53491fU, 0xd6a892f7U,
+    0x847c8bc6U, 0x3d87502eU, 0x2cfa3a57U, 0x9501e1bfU, 0x0e00eea5U, 0xb7fb354dU, 0xa6865f34U, 0x1f7d84dcU,
+    0x4bf54741U, 0xf20e9ca9U, 0xe373f6d0U, 0x5a882d38U, 0xc1892222U, 0x7872f9caU, 0x690f93b3U, 0xd0f4485bU,
+    0xc01e1489U, 0x79e5cf61U, 0x6898a518U, 0xd1637ef0U, 0x4a6271eaU, 0xf399aa02U, 0xe2e4c07bU, 0x5b1f1b93U,
+    0x0f97d80eU, 0xb66c03e6U, 0xa711699fU, 0x1eeab277U, 0x85ebbd6dU, 0x3c106685U, 0x2d6d0cfcU, 0x9496d714U,
+    0x0cb9b558U, 0xb5426eb0U, 0xa43f04c9U, 0x1dc4df21U, 0x86c5d03bU, 0x3f3e0bd3U, 0x2e4361aaU, 0x97b8ba42U,
+    0xc33079dfU, 0x7acba237U, 0x6bb6c84eU, 0xd24d13a6U, 0x494c1cbcU, 0xf0b7c754U, 0xe1caad2dU, 0x583176c5U,
+    0x48db2a17U, 0xf120f1ffU, 0xe05d9b86U, 0x59a6406eU, 0xc2a74f74U, 0x7b5c949cU, 0x6a21fee5U, 0xd3da250dU,
+    0x8752e690U, 0x3ea93d78U, 0x2fd45701U, 0x962f8ce9U, 0x0d2e83f3U, 0xb4d5581bU, 0xa5a83262U, 0x1c53e98aU
+  },
+  {
+    0x00000000U, 0xae689191U, 0x87a02563U, 0x29c8b4f2U, 0xd4314c87U, 0x7a59dd16U, 0x539169e4U, 0xfdf9f875U,
+    0x73139f4fU, 0xdd7b0edeU, 0xf4b3ba2cU, 0x5adb2bbdU, 0xa722d3c8U, 0x094a4259U, 0x2082f6abU, 0x8eea673aU,
+    0xe6273e9eU, 0x484faf0fU, 0x61871bfdU, 0xcfef8a6cU, 0x32167219U, 0x9c7ee388U, 0xb5b6577aU, 0x1bdec6ebU,
+    0x9534a1d1U, 0x3b5c3040U, 0x129484b2U, 0xbcfc1523U, 0x4105ed56U, 0xef6d7cc7U, 0xc6a5c835U, 0x68cd59a4U,
+    0x173f7b7dU, 0xb957eaecU, 0x909f5e1eU, 0x3ef7cf8fU, 0xc30e37faU, 0x6d66a66bU, 0x44ae1299U, 0xeac68308U,
+    0x642ce432U, 0xca4475a3U, 0xe38cc151U, 0x4de450c0U, 0xb01da8b5U, 0x1e753924U, 0x37bd8dd6U, 0x99d51c47U,
+    0xf11845e3U, 0x5f70d472U, 0x76b86080U, 0xd8d0f111U, 0x25290964U, 0x8b4198f5U, 0xa2892c07U, 0x0ce1bd96U,
+    0x820bdaacU, 0x2c634b3dU, 0x05abffcfU, 0xabc36e5eU, 0x563a962bU, 0xf85207baU, 0xd19ab348U, 0x7ff222d9U,
+    0x2e7ef6faU, 0x8016676bU, 0xa9ded399U, 0x07b64208U, 0xfa4fba7dU, 0x54272becU, 0x7def9f1eU, 0xd3870e8fU,
+    0x5d6d69b5U, 0xf305f824U, 0xdacd4cd6U, 0x74a5dd47U, 0x895c2532U, 0x2734b4a3U, 0x0efc0051U, 0xa09491c0U,
+    0xc859c864U, 0x663159f5U, 0x4ff9ed07U, 0xe1917c96U, 0x1c6884e3U, 0xb2001572U, 0x9bc8a180U, 0x35a03011U,
+    0xbb4a572bU, 0x1522c6baU, 0x3cea7248U, 0x9282e3d9U, 0x6f7b1bacU, 0xc1138a3dU, 0xe8db3ecfU, 0x46b3af5eU,
+    0x39418d87U, 0x97291c16U, 0xbee1a8e4U, 0x10893975U, 0xed70c100U, 0x43185091U, 0x6ad0e463U, 0xc4b875f2U,
+    0x4a5212c8U, 0xe43a8359U, 0xcdf237abU, 0x639aa63aU, 0x9e635e4fU, 0x300bcfdeU, 0x19c37b2cU, 0xb7abeabdU,
+    0xdf66b319U, 0x710e2288U, 0x58c6967aU, 0xf6ae07ebU, 0x0b57ff9eU, 0xa53f6e0fU, 0x8cf7dafdU, 0x229f4b6cU,
+    0xac752c56U, 0x021dbdc7U, 0x2bd50935U, 0x85bd98a4U, 0x784460d1U, 0xd62cf140U, 0xffe445b2U, 0x518cd423U,
+    0x5cfdedf4U, 0xf2957c65U, 0xdb5dc897U, 0x75355906U, 0x88cca173U, 0x26a430e2U, 0x0f6c8410U, 0xa1041581U,
+    0x2fee72bbU, 0x8186e32aU, 0xa84e57d8U, 0x0626c649U, 0xfbdf3e3cU, 0x55b7afadU, 0x7c7f1b5fU, 0xd2178aceU,
+    0xbadad36aU, 0x14b242fbU, 0x3d7af609U, 0x93126798U, 0x6eeb9fedU, 0xc0830e7cU, 0xe94bba8eU, 0x47232b1fU,
+    0xc9c94c25U, 0x67a1ddb4U, 0x4e696946U, 0xe001f8d7U, 0x1df800a2U, 0xb3909133U, 0x9a5825c1U, 0x3430b450U,
+    0x4bc29689U, 0xe5aa0718U, 0xcc62b3eaU, 0x620a227bU, 0x9ff3da0eU, 0x319b4b9fU, 0x1853ff6dU, 0xb63b6efcU,
+    0x38d109c6U, 0x96b99857U, 0xbf712ca5U, 0x1119bd34U, 0xece04541U, 0x4288d4d0U, 0x6b406022U, 0xc528f1b3U,
+    0xade5a817U, 0x038d3986U, 0x2a458d74U, 0x842d1ce5U, 0x79d4e490U, 0xd7bc7501U, 0xfe74c1f3U, 0x501c5062U,
+    0xdef63758U, 0x709ea6c9U, 0x5956123bU, 0xf73e83aaU, 0x0ac77bdfU, 0xa4afea4eU, 0x8d675ebcU, 0x230fcf2dU,
+    0x72831b0eU, 0xdceb8a9fU, 0xf5233e6dU, 0x5b4baffcU, 0xa6b25789U, 0x08dac618U, 0x211272eaU, 0x8f7ae37bU,
+    0x01908441U, 0xaff815d0U, 0x8630a122U, 0x285830b3U, 0xd5a1c8c6U, 0x7bc95957U, 0x5201eda5U, 0xfc697c34U,
+    0x94a42590U, 0x3accb401U, 0x130400f3U, 0xbd6c9162U, 0x40956917U, 0xeefdf886U, 0xc7354c74U, 0x695ddde5U,
+    0xe7b7badfU, 0x49df2b4eU, 0x60179fbcU, 0xce7f0e2dU, 0x3386f658U, 0x9dee67c9U, 0xb426d33bU, 0x1a4e42aaU,
+    0x65bc6073U, 0xcbd4f1e2U, 0xe21c4510U, 0x4c74d481U, 0xb18d2cf4U, 0x1fe5bd65U, 0x362d0997U, 0x98459806U,
+    0x16afff3cU, 0xb8c76eadU, 0x910fda5fU, 0x3f674bceU, 0xc29eb3bbU, 0x6cf6222aU, 0x453e96d8U, 0xeb560749U,
+    0x839b5eedU, 0x2df3cf7cU, 0x043b7b8eU, 0xaa53ea1fU, 0x57aa126aU, 0xf9c283fbU, 0xd00a3709U, 0x7e62a698U,
+    0xf088c1a2U, 0x5ee05033U, 0x7728e4c1U, 0xd9407550U, 0x24b98d25U, 0x8ad11cb4U, 0xa319a846U, 0x0d7139d7U
+  }
+};
+
+static const uint32_t crc32_x2n_table[32] = {
+    0x40000000U, 0x20000000U, 0x08000000U, 0x00800000U, 0x00008000U, 0xedb88320U, 0xb1e6b092U, 0xa06a2517U,
+    0xed627daeU, 0x88d14467U, 0xd7bbfe6aU, 0xec447f11U, 0x8e7ea170U, 0x6427800eU, 0x4d47bae0U, 0x09fe548fU,
+    0x83852d0fU, 0x30362f1aU, 0x7b5a9cc3U, 0x31fec169U, 0x9fec022aU, 0x6c8dedc4U, 0x15d6874dU, 0x5fde7a4eU,
+    0xbad90e37U, 0x2e4e5eefU, 0x4eaba214U, 0xa8a472c0U, 0x429a969eU, 0x148d302aU, 0xc40ba6d0U, 0xc4e22c3cU
 };
 
+#define CRC32_POLY      0xedb88320U
 #define CRC32_INITXOR   0xffffffffU
 #define CRC32_FINALXOR  0xffffffffU
 
+
+/* All the implementations below work with the raw CRC register, i.e. without
+ * the initial and final XOR. */
+typedef uint32_t (*CRC32_FUNC)(uint32_t crcreg, const uint8_t* bytes, size_t n);
+
+
+/*****************************
+ ***   Portable fallback   ***
+ *****************************/
+
+static uint32_t
+crc32_load32le(const uint8_t* bytes)
+{
+    return ((uint32_t) bytes[0]      ) | ((uint32_t) bytes[1] <<  8) |
+           ((uint32_t) bytes[2] << 16) | ((uint32_t) bytes[3] << 24);
+}
+
+/* Slicing-by-16: Process 16 bytes per iteration with 16 independent table
+ * lookups instead of a chain of 16 dependent ones. */
+static uint32_t
+crc32_sw(uint32_t crcreg, const uint8_t* bytes, size_t n)
+{
+    while(n >= 16) {
+        uint32_t w0 = crcreg ^ crc32_load32le(bytes);
+        uint32_t w1 = crc32_load32le(bytes + 4);
+        uint32_t w2 = crc32_load32le(bytes + 8);
+        uint32_t w3 = crc32_load32le(bytes + 12);
+
+        crcreg = crc32_table[15][ w0        & 0xffU] ^
+                 crc32_table[14][(w0 >>  8) & 0xffU] ^
+                 crc32_table[13][(w0 >> 16) & 0xffU] ^
+                 crc32_table[12][ w0 >> 24         ] ^
+                 crc32_table[11][ w1        & 0xffU] ^
+                 crc32_table[10][(w1 >>  8) & 0xffU] ^
+                 crc32_table[ 9][(w1 >> 16) & 0xffU] ^
+                 crc32_table[ 8][ w1 >> 24         ] ^
+                 crc32_table[ 7][ w2        & 0xffU] ^
+                 crc32_table[ 6][(w2 >>  8) & 0xffU] ^
+                 crc32_table[ 5][(w2 >> 16) & 0xffU] ^
+                 crc32_table[ 4][ w2 >> 24         ] ^
+                 crc32_table[ 3][ w3        & 0xffU] ^
+                 crc32_table[ 2][(w3 >>  8) & 0xffU] ^
+                 crc32_table[ 1][(w3 >> 16) & 0xffU] ^
+                 crc32_table[ 0][ w3 >> 24         ];
+
+        bytes += 16;
+        n -= 16;
+    }
+
+    while(n > 0) {
+        crcreg = (crcreg >> 8) ^ crc32_table[0][(crcreg ^ *bytes) & 0xffU];
+        bytes++;
+        n--;
+    }
+
+    return crcreg;
+}
+
+
+/***************************
+ ***   x86-64 PCLMULQDQ   ***
+ ***************************/
+
+#ifdef CRC32_HW_X86
+
+/* Folding with carry-less multiplication, as described in Intel's white paper
+ * "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction".
+ *
+ * The constants are (bit-reflected) x^(4*128+32) mod P, x^(4*128-32) mod P,
+ * x^(128+32) mod P, x^(128-32) mod P, x^64 mod P, and for the final Barrett
+ * reduction floor(x^64 / P) and P itself. */
+static const uint64_t crc32_k1k2[2] = { 0x0154442bd4U, 0x01c6e41596U };
+static const uint64_t crc32_k3k4[2] = { 0x01751997d0U, 0x00ccaa009eU };
+static const uint64_t crc32_k5k0[2] = { 0x0163cd6124U, 0x0000000000U };
+static const uint64_t crc32_poly[2] = { 0x01db710641U, 0x01f7011641U };
+
+#define CRC32_CLMUL_MIN_SIZE    64
+
+CRC32_TARGET_X86 static uint32_t
+crc32_clmul(uint32_t crcreg, const uint8_t* bytes, size_t n)
+{
+    __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8, y5, y6, y7, y8;
+
+    /* Too short for the folding setup to pay off. */
+    if(n < CRC32_CLMUL_MIN_SIZE)
+        return crc32_sw(crcreg, bytes, n);
+
+    /* Fold 64 bytes per iteration in four independent 128-bit lanes. */
+    x1 = _mm_loadu_si128((const __m128i*) (bytes + 0x00));
+    x2 = _mm_loadu_si128((const __m128i*) (bytes + 0x10));
+    x3 = _mm_loadu_si128((const __m128i*) (bytes + 0x20));
+    x4 = _mm_loadu_si128((const __m128i*) (bytes + 0x30));
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128((int) crcreg));
+    x0 = _mm_loadu_si128((const __m128i*) crc32_k1k2);
+    bytes += 64;
+    n -= 64;
+
+    while(n >= 64) {
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+        x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+        x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+
+        y5 = _mm_loadu_si128((const __m128i*) (bytes + 0x00));
+        y6 = _mm_loadu_si128((const __m128i*) (bytes + 0x10));
+        y7 = _mm_loadu_si128((const __m128i*) (bytes + 0x20));
+        y8 = _mm_loadu_si128((const __m128i*) (bytes + 0x30));
+
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), y5);
+        x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), y6);
+        x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), y7);
+        x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), y8);
+
+        bytes += 64;
+        n -= 64;
+    }
+
+    /* Fold the four lanes into one. */
+    x0 = _mm_loadu_si128((const __m128i*) crc32_k3k4);
+
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+    /* Fold any remaining whole 16-byte blocks. */
+    while(n >= 16) {
+        x2 = _mm_loadu_si128((const __m128i*) bytes);
+
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+        bytes += 16;
+        n -= 16;
+    }
+
+    /* Reduce 128 bits to 64 bits. */
+    x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+    x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+    x1 = _mm_srli_si128(x1, 8);
+    x1 = _mm_xor_si128(x1, x2);
+
+    x0 = _mm_loadl_epi64((const __m128i*) crc32_k5k0);
+
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, x3);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    /* Barrett reduction to 32 bits. */
+    x0 = _mm_loadu_si128((const __m128i*) crc32_poly);
+
+    x2 = _mm_and_si128(x1, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+    x2 = _mm_and_si128(x2, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    crcreg = (uint32_t) _mm_cvtsi128_si32(_mm_srli_si128(x1, 4));
+
+    /* The tail shorter than 16 bytes. */
+    return crc32_sw(crcreg, bytes, n);
+}
+
+static int
+crc32_hw_supported(void)
+{
+    /* CPUID.01H:ECX.PCLMULQDQ[bit 1] */
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+
+    __cpuid(info, 1);
+    return ((info[2] & (1 << 1)) != 0);
+#else
+    unsigned eax, ebx, ecx, edx;
+
+    if(!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return 0;
+    return ((ecx & (1 << 1)) != 0);
+#endif
+}
+
+#define crc32_hw        crc32_clmul
+
+#endif  /* #ifdef CRC32_HW_X86 */
+
+
+/**********************************
+ ***   ARM64 CRC32 instructions   ***
+ **********************************/
+
+#ifdef CRC32_HW_ARM64
+
+CRC32_TARGET_ARM64 static uint32_t
+crc32_armv8(uint32_t crcreg, const uint8_t* bytes, size_t n)
+{
+    uint64_t w;
+
+    while(n > 0  &&  ((uintptr_t) bytes & 7) != 0) {
+        crcreg = __crc32b(crcreg, *bytes);
+        bytes++;
+        n--;
+    }
+
+    while(n >= 32) {
+        memcpy(&w, bytes + 0, 8);   crcreg = __crc32d(crcreg, w);
+        memcpy(&w, bytes + 8, 8);   crcreg = __crc32d(crcreg, w);
+        memcpy(&w, bytes + 16, 8);  crcreg = __crc32d(crcreg, w);
+        memcpy(&w, bytes + 24, 8);  crcreg = __crc32d(crcreg, w);
+        bytes += 32;
+        n -= 32;
+    }
+
+    while(n >= 8) {
+        memcpy(&w, bytes, 8);
+        crcreg = __crc32d(crcreg, w);
+        bytes += 8;
+        n -= 8;
+    }
+
+    while(n > 0) {
+        crcreg = __crc32b(crcreg, *bytes);
+        bytes++;
+        n--;
+    }
+
+    return crcreg;
+}
+
+static int
+crc32_hw_supported(void)
+{
+#if defined CRC32_HW_ARM64_ALWAYS
+    return 1;
+#elif defined _MSC_VER
+    return IsProcessorFeaturePresent(PF_ARM_V8_CRC32_INSTRUCTIONS_AVAILABLE);
+#else
+    return ((getauxval(AT_HWCAP) & HWCAP_CRC32) != 0);
+#endif
+}
+
+#define crc32_hw        crc32_armv8
+
+#endif  /* #ifdef CRC32_HW_ARM64 */
+
+
+/**************************
+ ***   Implementation   ***
+ **************************/
+
+static uint32_t crc32_resolve(uint32_t crcreg, const uint8_t* bytes, size_t n);
+
+/* Resolved on the first use. If more threads race for it, they all store the
+ * same value. */
+static CRC32_FUNC crc32_func = crc32_resolve;
+
+static uint32_t
+crc32_resolve(uint32_t crcreg, const uint8_t* bytes, size_t n)
+{
+    CRC32_FUNC func = crc32_sw;
+
+#if defined CRC32_HW_X86 || defined CRC32_HW_ARM64
+    if(crc32_hw_supported())
+        func = crc32_hw;
+#endif
+
+    crc32_func = func;
+    return func(crcreg, bytes, n);
+}
+
+uint32_t
+crc32_update(uint32_t crc, const void* data, size_t n)
+{
+    uint32_t crcreg = crc ^ CRC32_FINALXOR;
+
+    crcreg = crc32_func(crcreg, (const uint8_t*) data, n);
+    return crcreg ^ CRC32_FINALXOR;
+}
+
 uint32_t
 crc32(const void* data, size_t n)
 {
-    const uint8_t* bytes = (const uint8_t*) data;
     uint32_t crcreg = CRC32_INITXOR;
-    int i;
-
-    for(i = 0; i < n; i++)
-        crcreg = (crcreg >> 8) ^ crc32_table[((crcreg ^ bytes[i]) & 0xffU)];
 
+    crcreg = crc32_func(crcreg, (const uint8_t*) data, n);
     return crcreg ^ CRC32_FINALXOR;
 }
+
+
+/* Multiply polynomials a and b modulo CRC32_POLY (in the reflected bit order,
+ * where 0x80000000U represents x^0). */
+static uint32_t
+crc32_multmodp(uint32_t a, uint32_t b)
+{
+    uint32_t m = (uint32_t) 1 << 31;
+    uint32_t p = 0;
+
+    while(m != 0) {
+        if(a & m) {
+            p ^= b;
+            if((a & (m - 1)) == 0)
+                break;
+        }
+        m >>= 1;
+        b = (b & 1) ? ((b >> 1) ^ CRC32_POLY) : (b >> 1);
+    }
+
+    return p;
+}
+
+uint32_t
+crc32_combine(uint32_t crc1, uint32_t crc2, uint64_t n2)
+{
+    /* Appending n2 bytes to the first message multiplies its (raw) CRC by
+     * x^(8*n2). The effect of the initial and final XOR cancels out because
+     * it is the same for both crc2 and the result. */
+    uint32_t p = (uint32_t) 1 << 31;   /* x^0 */
+    int k = 3;                          /* x^(2^3) == x^8 for one byte */
+
+    while(n2 != 0) {
+        if(n2 & 1)
+            p = crc32_multmodp(crc32_x2n_table[k & 31], p);
+        n2 >>= 1;
+        k++;
+    }
+
+    return crc32_multmodp(p, crc1) ^ crc2;
+}
+
+
+#ifdef CRE_TEST
+/* Allow the tests to compare the portable and the accelerated code. */
+
+uint32_t
+crc32_update_sw(uint32_t crc, const void* data, size_t n)
+{
+    return crc32_sw(crc ^ CRC32_FINALXOR, (const uint8_t*) data, n) ^ CRC32_FINALXOR;
+}
+
+int
+crc32_has_hw(void)
+{
+#if defined CRC32_HW_X86 || defined CRC32_HW_ARM64
+    return crc32_hw_supported();
+#else
+    return 0;
+#endif
+}
+
+#endif  /* #ifdef CRE_TEST */
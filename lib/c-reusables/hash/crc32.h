@@ -39,12 +39,31 @@ extern "C" {
  * Note there is no real CRC-32 standard. Some applications use different
  * flavors.
  *
- * This implementation is based on the appendix of this paper:
+ * This implementation computes the flavor used by zlib, gzip, PNG, Ethernet
+ * etc. (reflected polynomial 0xedb88320, initial and final XOR 0xffffffff).
+ * The table-driven code is based on the appendix of this paper:
  * http://stigge.org/martin/pub/SAR-PR-2006-05.pdf
+ *
+ * On x86-64 (with PCLMULQDQ) and ARM64 (with the CRC32 extension), a hardware
+ * accelerated implementation is selected at run time. Otherwise a portable
+ * slicing-by-16 implementation is used.
  */
+uint32_t crc32(const void* data, size_t n);
 
+/* Continue computing CRC-32 of a data stream. The argument crc is the CRC-32
+ * of all the preceding data (use 0 for the first chunk).
+ *
+ * crc32_update(crc32(a, na), b, nb) == crc32(concat(a, b), na + nb).
+ */
+uint32_t crc32_update(uint32_t crc, const void* data, size_t n);
 
-uint32_t crc32(const void* data, size_t n);
+/* Given crc1 == crc32(a, na) and crc2 == crc32(b, n2), compute CRC-32 of the
+ * concatenated data (a followed by b) without touching the data again.
+ *
+ * This allows checksumming chunks of a large buffer independently (e.g. in
+ * parallel threads) and merging the results. The cost is O(log n2).
+ */
+uint32_t crc32_combine(uint32_t crc1, uint32_t crc2, uint64_t n2);
 
 
 #ifdef __cplusplus
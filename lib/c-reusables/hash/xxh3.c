@@ -0,0 +1,626 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2020 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "xxh3.h"
+
+#include <string.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+    /* SSE2 is always available on x86-64. */
+    #include <emmintrin.h>
+    #define XXH3_SSE2           1
+#endif
+
+#if defined(_MSC_VER) && defined(_M_X64)
+    #include <intrin.h>
+#endif
+
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__)
+    #if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        #define XXH3_BIG_ENDIAN     1
+    #endif
+#endif
+
+
+#define XXH3_PRIME32_1          0x9e3779b1U
+#define XXH3_PRIME32_2          0x85ebca77U
+#define XXH3_PRIME32_3          0xc2b2ae3dU
+#define XXH3_PRIME64_1          0x9e3779b185ebca87U
+#define XXH3_PRIME64_2          0xc2b2ae3d27d4eb4fU
+#define XXH3_PRIME64_3          0x165667b19e3779f9U
+#define XXH3_PRIME64_4          0x85ebca77c2b2ae63U
+#define XXH3_PRIME64_5          0x27d4eb2f165667c5U
+#define XXH3_PRIME_MX1          0x165667919e3779f9U
+#define XXH3_PRIME_MX2          0x9fb21c651e98df25U
+
+/* Inputs up to this size are hashed without the accumulator loop. */
+#define XXH3_MIDSIZE_MAX        240
+#define XXH3_MIDSIZE_START      3
+#define XXH3_MIDSIZE_LAST       17
+#define XXH3_SECRET_SIZE_MIN    136
+
+/* Long inputs are processed in stripes of 64 bytes. Each stripe consumes 8
+ * more bytes of the secret, so after XXH3_BLOCK_STRIPES stripes (a block) the
+ * secret is exhausted, the accumulators are scrambled and the secret reused. */
+#define XXH3_STRIPE_LEN         64
+#define XXH3_SECRET_STEP        8
+#define XXH3_BLOCK_STRIPES      ((XXH3_SECRET_SIZE - XXH3_STRIPE_LEN) / XXH3_SECRET_STEP)
+#define XXH3_BLOCK_LEN          (XXH3_STRIPE_LEN * XXH3_BLOCK_STRIPES)
+#define XXH3_SECRET_LASTACC     7
+#define XXH3_SECRET_MERGEACCS   11
+
+/* The default secret (pseudo-random bytes, taken from the reference
+ * implementation where it comes from FARSH). */
+static const uint8_t xxh3_default_secret[XXH3_SECRET_SIZE] = {
+    0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+    0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+    0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+    0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+    0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+    0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+    0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+    0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+    0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+    0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+    0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+    0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e
+};
+
+
+/*************************
+ ***   Basic helpers   ***
+ *************************/
+
+static uint32_t
+xxh3_swap32(uint32_t x)
+{
+    return ((x << 24) & 0xff000000U) | ((x <<  8) & 0x00ff0000U) |
+           ((x >>  8) & 0x0000ff00U) | ((x >> 24) & 0x000000ffU);
+}
+
+static uint64_t
+xxh3_swap64(uint64_t x)
+{
+    return ((uint64_t) xxh3_swap32((uint32_t) x) << 32) | xxh3_swap32((uint32_t) (x >> 32));
+}
+
+static uint32_t
+xxh3_read32(const uint8_t* p)
+{
+    uint32_t v;
+
+    memcpy(&v, p, sizeof(v));
+#ifdef XXH3_BIG_ENDIAN
+    v = xxh3_swap32(v);
+#endif
+    return v;
+}
+
+static uint64_t
+xxh3_read64(const uint8_t* p)
+{
+    uint64_t v;
+
+    memcpy(&v, p, sizeof(v));
+#ifdef XXH3_BIG_ENDIAN
+    v = xxh3_swap64(v);
+#endif
+    return v;
+}
+
+static void
+xxh3_write64(uint8_t* p, uint64_t v)
+{
+#ifdef XXH3_BIG_ENDIAN
+    v = xxh3_swap64(v);
+#endif
+    memcpy(p, &v, sizeof(v));
+}
+
+static uint64_t
+xxh3_rotl64(uint64_t x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+/* Full 64x64 -> 128 bit multiplication, with the two halves of the product
+ * XOR-ed together. */
+static uint64_t
+xxh3_mul128_fold64(uint64_t a, uint64_t b)
+{
+#if defined(__SIZEOF_INT128__)
+    __extension__ unsigned __int128 p = (unsigned __int128) a * b;
+    return (uint64_t) p ^ (uint64_t) (p >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    uint64_t hi;
+    uint64_t lo = _umul128(a, b, &hi);
+    return lo ^ hi;
+#else
+    uint64_t lo_lo = (a & 0xffffffffU) * (b & 0xffffffffU);
+    uint64_t hi_lo = (a >> 32) * (b & 0xffffffffU);
+    uint64_t lo_hi = (a & 0xffffffffU) * (b >> 32);
+    uint64_t hi_hi = (a >> 32) * (b >> 32);
+    uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xffffffffU) + lo_hi;
+    uint64_t upper = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+    uint64_t lower = (cross << 32) | (lo_lo & 0xffffffffU);
+    return lower ^ upper;
+#endif
+}
+
+static uint64_t
+xxh64_avalanche(uint64_t h)
+{
+    h ^= h >> 33;
+    h *= XXH3_PRIME64_2;
+    h ^= h >> 29;
+    h *= XXH3_PRIME64_3;
+    h ^= h >> 32;
+    return h;
+}
+
+static uint64_t
+xxh3_avalanche(uint64_t h)
+{
+    h ^= h >> 37;
+    h *= XXH3_PRIME_MX1;
+    h ^= h >> 32;
+    return h;
+}
+
+static uint64_t
+xxh3_rrmxmx(uint64_t h, uint64_t len)
+{
+    h ^= xxh3_rotl64(h, 49) ^ xxh3_rotl64(h, 24);
+    h *= XXH3_PRIME_MX2;
+    h ^= (h >> 35) + len;
+    h *= XXH3_PRIME_MX2;
+    h ^= h >> 28;
+    return h;
+}
+
+
+/***********************************
+ ***   Short and medium inputs   ***
+ ***********************************/
+
+static uint64_t
+xxh3_len_1to3(const uint8_t* in, size_t n, const uint8_t* secret, uint64_t seed)
+{
+    uint32_t c1 = in[0];
+    uint32_t c2 = in[n >> 1];
+    uint32_t c3 = in[n - 1];
+    uint32_t combined = (c1 << 16) | (c2 << 24) | c3 | ((uint32_t) n << 8);
+    uint64_t bitflip = (xxh3_read32(secret) ^ xxh3_read32(secret + 4)) + seed;
+
+    return xxh64_avalanche((uint64_t) combined ^ bitflip);
+}
+
+static uint64_t
+xxh3_len_4to8(const uint8_t* in, size_t n, const uint8_t* secret, uint64_t seed)
+{
+    uint64_t in1, in2, bitflip;
+
+    seed ^= (uint64_t) xxh3_swap32((uint32_t) seed) << 32;
+    in1 = xxh3_read32(in);
+    in2 = xxh3_read32(in + n - 4);
+    bitflip = (xxh3_read64(secret + 8) ^ xxh3_read64(secret + 16)) - seed;
+
+    return xxh3_rrmxmx((in2 + (in1 << 32)) ^ bitflip, n);
+}
+
+static uint64_t
+xxh3_len_9to16(const uint8_t* in, size_t n, const uint8_t* secret, uint64_t seed)
+{
+    uint64_t bitflip1 = (xxh3_read64(secret + 24) ^ xxh3_read64(secret + 32)) + seed;
+    uint64_t bitflip2 = (xxh3_read64(secret + 40) ^ xxh3_read64(secret + 48)) - seed;
+    uint64_t lo = xxh3_read64(in) ^ bitflip1;
+    uint64_t hi = xxh3_read64(in + n - 8) ^ bitflip2;
+
+    return xxh3_avalanche(n + xxh3_swap64(lo) + hi + xxh3_mul128_fold64(lo, hi));
+}
+
+static uint64_t
+xxh3_mix16(const uint8_t* in, const uint8_t* secret, uint64_t seed)
+{
+    return xxh3_mul128_fold64(xxh3_read64(in) ^ (xxh3_read64(secret) + seed),
+                              xxh3_read64(in + 8) ^ (xxh3_read64(secret + 8) - seed));
+}
+
+static uint64_t
+xxh3_len_17to128(const uint8_t* in, size_t n, const uint8_t* secret, uint64_t seed)
+{
+    uint64_t acc = n * XXH3_PRIME64_1;
+
+    if(n > 32) {
+        if(n > 64) {
+            if(n > 96) {
+                acc += xxh3_mix16(in + 48, secret + 96, seed);
+                acc += xxh3_mix16(in + n - 64, secret + 112, seed);
+            }
+            acc += xxh3_mix16(in + 32, secret + 64, seed);
+            acc += xxh3_mix16(in + n - 48, secret + 80, seed);
+        }
+        acc += xxh3_mix16(in + 16, secret + 32, seed);
+        acc += xxh3_mix16(in + n - 32, secret + 48, seed);
+    }
+    acc += xxh3_mix16(in, secret, seed);
+    acc += xxh3_mix16(in + n - 16, secret + 16, seed);
+
+    return xxh3_avalanche(acc);
+}
+
+static uint64_t
+xxh3_len_129to240(const uint8_t* in, size_t n, const uint8_t* secret, uint64_t seed)
+{
+    uint64_t acc = n * XXH3_PRIME64_1;
+    uint64_t acc_end;
+    size_t rounds = n / 16;
+    size_t i;
+
+    for(i = 0; i < 8; i++)
+        acc += xxh3_mix16(in + 16 * i, secret + 16 * i, seed);
+    acc = xxh3_avalanche(acc);
+
+    acc_end = xxh3_mix16(in + n - 16, secret + XXH3_SECRET_SIZE_MIN - XXH3_MIDSIZE_LAST, seed);
+    for(i = 8; i < rounds; i++)
+        acc_end += xxh3_mix16(in + 16 * i, secret + 16 * (i - 8) + XXH3_MIDSIZE_START, seed);
+
+    return xxh3_avalanche(acc + acc_end);
+}
+
+static uint64_t
+xxh3_short(uint64_t seed, const uint8_t* in, size_t n)
+{
+    const uint8_t* secret = xxh3_default_secret;
+
+    if(n > 128)
+        return xxh3_len_129to240(in, n, secret, seed);
+    if(n > 16)
+        return xxh3_len_17to128(in, n, secret, seed);
+    if(n > 8)
+        return xxh3_len_9to16(in, n, secret, seed);
+    if(n >= 4)
+        return xxh3_len_4to8(in, n, secret, seed);
+    if(n > 0)
+        return xxh3_len_1to3(in, n, secret, seed);
+    return xxh64_avalanche(seed ^ (xxh3_read64(secret + 56) ^ xxh3_read64(secret + 64)));
+}
+
+
+/***********************
+ ***   Long inputs   ***
+ ***********************/
+
+static void
+xxh3_init_acc(uint64_t* acc)
+{
+    acc[0] = XXH3_PRIME32_3;
+    acc[1] = XXH3_PRIME64_1;
+    acc[2] = XXH3_PRIME64_2;
+    acc[3] = XXH3_PRIME64_3;
+    acc[4] = XXH3_PRIME64_4;
+    acc[5] = XXH3_PRIME32_2;
+    acc[6] = XXH3_PRIME64_5;
+    acc[7] = XXH3_PRIME32_1;
+}
+
+/* Derive the secret for the long inputs from the seed. */
+static void
+xxh3_init_secret(uint8_t* secret, uint64_t seed)
+{
+    int i;
+
+    for(i = 0; i < XXH3_SECRET_SIZE / 16; i++) {
+        uint64_t lo = xxh3_read64(xxh3_default_secret + 16 * i) + seed;
+        uint64_t hi = xxh3_read64(xxh3_default_secret + 16 * i + 8) - seed;
+
+        xxh3_write64(secret + 16 * i, lo);
+        xxh3_write64(secret + 16 * i + 8, hi);
+    }
+}
+
+/* Accumulate n_stripes consecutive stripes. For the i-th stripe, the secret
+ * is shifted by i * XXH3_SECRET_STEP bytes. */
+#ifdef XXH3_SSE2
+static void
+xxh3_accumulate(uint64_t* acc, const uint8_t* in, const uint8_t* secret, size_t n_stripes)
+{
+    __m128i a[4];
+    size_t s;
+    int i;
+
+    for(i = 0; i < 4; i++)
+        a[i] = _mm_loadu_si128((const __m128i*) (acc + 2 * i));
+
+    for(s = 0; s < n_stripes; s++) {
+        const uint8_t* stripe_in = in + s * XXH3_STRIPE_LEN;
+        const uint8_t* stripe_secret = secret + s * XXH3_SECRET_STEP;
+
+        for(i = 0; i < 4; i++) {
+            __m128i data = _mm_loadu_si128((const __m128i*) (stripe_in + 16 * i));
+            __m128i key = _mm_loadu_si128((const __m128i*) (stripe_secret + 16 * i));
+            __m128i data_key = _mm_xor_si128(data, key);
+            /* Low 32 bits times high 32 bits of each 64-bit lane. */
+            __m128i data_key_hi = _mm_shuffle_epi32(data_key, _MM_SHUFFLE(0, 3, 0, 1));
+            __m128i product = _mm_mul_epu32(data_key, data_key_hi);
+            /* Add the data with the two 64-bit lanes swapped. */
+            __m128i data_swap = _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+
+            a[i] = _mm_add_epi64(a[i], _mm_add_epi64(product, data_swap));
+        }
+    }
+
+    for(i = 0; i < 4; i++)
+        _mm_storeu_si128((__m128i*) (acc + 2 * i), a[i]);
+}
+
+static void
+xxh3_scramble(uint64_t* acc, const uint8_t* secret)
+{
+    const __m128i prime = _mm_set1_epi32((int) XXH3_PRIME32_1);
+    int i;
+
+    for(i = 0; i < 4; i++) {
+        __m128i a = _mm_loadu_si128((const __m128i*) (acc + 2 * i));
+        __m128i key = _mm_loadu_si128((const __m128i*) (secret + 16 * i));
+        __m128i data_key, data_key_hi, product_lo, product_hi;
+
+        a = _mm_xor_si128(a, _mm_srli_epi64(a, 47));
+        data_key = _mm_xor_si128(a, key);
+        data_key_hi = _mm_shuffle_epi32(data_key, _MM_SHUFFLE(0, 3, 0, 1));
+        product_lo = _mm_mul_epu32(data_key, prime);
+        product_hi = _mm_mul_epu32(data_key_hi, prime);
+        a = _mm_add_epi64(product_lo, _mm_slli_epi64(product_hi, 32));
+
+        _mm_storeu_si128((__m128i*) (acc + 2 * i), a);
+    }
+}
+#else
+static void
+xxh3_accumulate(uint64_t* acc, const uint8_t* in, const uint8_t* secret, size_t n_stripes)
+{
+    size_t s;
+    int i;
+
+    for(s = 0; s < n_stripes; s++) {
+        const uint8_t* stripe_in = in + s * XXH3_STRIPE_LEN;
+        const uint8_t* stripe_secret = secret + s * XXH3_SECRET_STEP;
+
+        for(i = 0; i < 8; i++) {
+            uint64_t data = xxh3_read64(stripe_in + 8 * i);
+            uint64_t data_key = data ^ xxh3_read64(stripe_secret + 8 * i);
+
+            acc[i ^ 1] += data;
+            acc[i] += (data_key & 0xffffffffU) * (data_key >> 32);
+        }
+    }
+}
+
+static void
+xxh3_scramble(uint64_t* acc, const uint8_t* secret)
+{
+    int i;
+
+    for(i = 0; i < 8; i++) {
+        uint64_t a = acc[i];
+
+        a ^= a >> 47;
+        a ^= xxh3_read64(secret + 8 * i);
+        a *= XXH3_PRIME32_1;
+        acc[i] = a;
+    }
+}
+#endif
+
+static uint64_t
+xxh3_merge_accs(const uint64_t* acc, const uint8_t* secret, uint64_t start)
+{
+    uint64_t h = start;
+    int i;
+
+    for(i = 0; i < 4; i++) {
+        h += xxh3_mul128_fold64(acc[2 * i] ^ xxh3_read64(secret + 16 * i),
+                                acc[2 * i + 1] ^ xxh3_read64(secret + 16 * i + 8));
+    }
+
+    return xxh3_avalanche(h);
+}
+
+static uint64_t
+xxh3_long(const uint8_t* in, size_t n, const uint8_t* secret)
+{
+    uint64_t acc[8];
+    size_t n_blocks = (n - 1) / XXH3_BLOCK_LEN;
+    size_t n_stripes;
+    size_t b;
+
+    xxh3_init_acc(acc);
+
+    for(b = 0; b < n_blocks; b++) {
+        xxh3_accumulate(acc, in + b * XXH3_BLOCK_LEN, secret, XXH3_BLOCK_STRIPES);
+        xxh3_scramble(acc, secret + XXH3_SECRET_SIZE - XXH3_STRIPE_LEN);
+    }
+
+    /* The last partial block, and the last stripe (which always ends at the
+     * end of the data; it may overlap with the preceding stripe). */
+    n_stripes = ((n - 1) - XXH3_BLOCK_LEN * n_blocks) / XXH3_STRIPE_LEN;
+    xxh3_accumulate(acc, in + n_blocks * XXH3_BLOCK_LEN, secret, n_stripes);
+    xxh3_accumulate(acc, in + n - XXH3_STRIPE_LEN,
+            secret + XXH3_SECRET_SIZE - XXH3_STRIPE_LEN - XXH3_SECRET_LASTACC, 1);
+
+    return xxh3_merge_accs(acc, secret + XXH3_SECRET_MERGEACCS, (uint64_t) n * XXH3_PRIME64_1);
+}
+
+uint64_t
+xxh3_64(uint64_t seed, const void* data, size_t n)
+{
+    const uint8_t* in = (const uint8_t*) data;
+    uint8_t secret[XXH3_SECRET_SIZE];
+
+    if(n <= XXH3_MIDSIZE_MAX)
+        return xxh3_short(seed, in, n);
+
+    if(seed == 0)
+        return xxh3_long(in, n, xxh3_default_secret);
+
+    xxh3_init_secret(secret, seed);
+    return xxh3_long(in, n, secret);
+}
+
+
+/*************************
+ ***   Streaming API   ***
+ *************************/
+
+/* Accumulate n_stripes stripes, continuing in the current block (of which
+ * *p_stripes_so_far stripes are already done). Returns the end of the
+ * consumed data. */
+static const uint8_t*
+xxh3_consume_stripes(uint64_t* acc, size_t* p_stripes_so_far,
+                     const uint8_t* in, size_t n_stripes, const uint8_t* secret)
+{
+    size_t so_far = *p_stripes_so_far;
+
+    if(n_stripes >= XXH3_BLOCK_STRIPES - so_far) {
+        size_t n = XXH3_BLOCK_STRIPES - so_far;
+
+        /* Finish the current block, and then any whole blocks. */
+        do {
+            xxh3_accumulate(acc, in, secret + so_far * XXH3_SECRET_STEP, n);
+            xxh3_scramble(acc, secret + XXH3_SECRET_SIZE - XXH3_STRIPE_LEN);
+            in += n * XXH3_STRIPE_LEN;
+            n_stripes -= n;
+            n = XXH3_BLOCK_STRIPES;
+            so_far = 0;
+        } while(n_stripes >= XXH3_BLOCK_STRIPES);
+    }
+
+    if(n_stripes > 0) {
+        xxh3_accumulate(acc, in, secret + so_far * XXH3_SECRET_STEP, n_stripes);
+        in += n_stripes * XXH3_STRIPE_LEN;
+        so_far += n_stripes;
+    }
+
+    *p_stripes_so_far = so_far;
+    return in;
+}
+
+void
+xxh3_init(XXH3_STATE* state, uint64_t seed)
+{
+    xxh3_init_acc(state->acc);
+    state->total_len = 0;
+    state->seed = seed;
+    state->stripes_so_far = 0;
+    state->buffered = 0;
+
+    if(seed == 0)
+        memcpy(state->secret, xxh3_default_secret, XXH3_SECRET_SIZE);
+    else
+        xxh3_init_secret(state->secret, seed);
+}
+
+void
+xxh3_update(XXH3_STATE* state, const void* data, size_t n)
+{
+    const uint8_t* in = (const uint8_t*) data;
+    const uint8_t* end = in + n;
+
+    if(n == 0)
+        return;
+
+    state->total_len += n;
+
+    /* Small input: Just accumulate it in the buffer. */
+    if(n <= XXH3_BUFFER_SIZE - state->buffered) {
+        memcpy(state->buffer + state->buffered, in, n);
+        state->buffered += n;
+        return;
+    }
+
+    /* Fill and consume the buffer. */
+    if(state->buffered > 0) {
+        size_t fill = XXH3_BUFFER_SIZE - state->buffered;
+
+        memcpy(state->buffer + state->buffered, in, fill);
+        in += fill;
+        xxh3_consume_stripes(state->acc, &state->stripes_so_far, state->buffer,
+                XXH3_BUFFER_SIZE / XXH3_STRIPE_LEN, state->secret);
+        state->buffered = 0;
+    }
+
+    /* Consume the stripes directly from the input. But always keep at least
+     * one byte for the buffer, because the last stripe is special and we do
+     * not know yet whether more data follow. */
+    if((size_t)(end - in) > XXH3_BUFFER_SIZE) {
+        size_t n_stripes = (size_t)(end - 1 - in) / XXH3_STRIPE_LEN;
+
+        in = xxh3_consume_stripes(state->acc, &state->stripes_so_far, in,
+                n_stripes, state->secret);
+
+        /* xxh3_final() may need the preceding bytes to form the last stripe. */
+        memcpy(state->buffer + XXH3_BUFFER_SIZE - XXH3_STRIPE_LEN,
+                in - XXH3_STRIPE_LEN, XXH3_STRIPE_LEN);
+    }
+
+    memcpy(state->buffer, in, (size_t)(end - in));
+    state->buffered = (size_t)(end - in);
+}
+
+uint64_t
+xxh3_final(const XXH3_STATE* state)
+{
+    uint64_t acc[8];
+    uint8_t last_stripe_buf[XXH3_STRIPE_LEN];
+    const uint8_t* last_stripe;
+
+    if(state->total_len <= XXH3_MIDSIZE_MAX)
+        return xxh3_short(state->seed, state->buffer, (size_t) state->total_len);
+
+    /* Work on a copy so the state may be updated further. */
+    memcpy(acc, state->acc, sizeof(acc));
+
+    if(state->buffered >= XXH3_STRIPE_LEN) {
+        size_t so_far = state->stripes_so_far;
+
+        xxh3_consume_stripes(acc, &so_far, state->buffer,
+                (state->buffered - 1) / XXH3_STRIPE_LEN, state->secret);
+        last_stripe = state->buffer + state->buffered - XXH3_STRIPE_LEN;
+    } else {
+        /* Glue the last stripe from the tail of the already consumed data
+         * (kept at the end of the buffer) and the buffered data. */
+        size_t catchup = XXH3_STRIPE_LEN - state->buffered;
+
+        memcpy(last_stripe_buf, state->buffer + XXH3_BUFFER_SIZE - catchup, catchup);
+        memcpy(last_stripe_buf + catchup, state->buffer, state->buffered);
+        last_stripe = last_stripe_buf;
+    }
+
+    xxh3_accumulate(acc, last_stripe,
+            state->secret + XXH3_SECRET_SIZE - XXH3_STRIPE_LEN - XXH3_SECRET_LASTACC, 1);
+
+    return xxh3_merge_accs(acc, state->secret + XXH3_SECRET_MERGEACCS,
+            state->total_len * XXH3_PRIME64_1);
+}
@@ -0,0 +1,84 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2020 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef CRE_XXH3_H
+#define CRE_XXH3_H
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/* XXH3 hash, 64-bit variant.
+ * (https://github.com/Cyan4973/xxHash)
+ *
+ * Unlike FNV-1a, XXH3 consumes the input 8 bytes at a time (64 bytes at a
+ * time for long inputs), and it passes the SMHasher quality test suite.
+ * The output is bit-compatible with XXH3_64bits_withSeed() of the reference
+ * implementation, so hashes may be exchanged with other software.
+ *
+ * The seed parameter allows to get independent hash functions (e.g. to
+ * randomize hash tables). Use 0 if you do not care.
+ */
+
+uint64_t xxh3_64(uint64_t seed, const void* data, size_t n);
+
+
+/* Streaming (incremental) API.
+ *
+ * xxh3_init() + any sequence of xxh3_update() + xxh3_final() yields the
+ * same result as xxh3_64() called on the concatenated data. xxh3_final()
+ * does not modify the state, so more data may be appended afterwards.
+ *
+ * The structure members are private. The structure is relatively large
+ * (about 0.5 KB), so consider that when placing it on a stack.
+ */
+
+#define XXH3_SECRET_SIZE        192
+#define XXH3_BUFFER_SIZE        256
+
+typedef struct XXH3_STATE {
+    uint64_t acc[8];
+    uint64_t total_len;
+    uint64_t seed;
+    size_t stripes_so_far;
+    size_t buffered;
+    uint8_t secret[XXH3_SECRET_SIZE];
+    uint8_t buffer[XXH3_BUFFER_SIZE];
+} XXH3_STATE;
+
+void xxh3_init(XXH3_STATE* state, uint64_t seed);
+void xxh3_update(XXH3_STATE* state, const void* data, size_t n);
+uint64_t xxh3_final(const XXH3_STATE* state);
+
+
+#ifdef __cplusplus
+}  /* extern "C" { */
+#endif
+
+#endif  /* CRE_XXH3_H */
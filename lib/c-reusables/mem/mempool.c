@@ -0,0 +1,136 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2020 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "mempool.h"
+
+#include <string.h>
+
+
+struct MEMPOOL_SLAB {
+    struct MEMPOOL_SLAB* next;
+};
+
+/* Size of the slab header, rounded up so that the slab payload is aligned
+ * to MEMPOOL_GRANULARITY (given malloc() gives us memory aligned at least
+ * as much). */
+#define SLAB_HEADER_SIZE                                                    \
+        ((sizeof(MEMPOOL_SLAB) + MEMPOOL_GRANULARITY - 1) / MEMPOOL_GRANULARITY * MEMPOOL_GRANULARITY)
+
+/* Free list is threaded through the freed pieces of memory themselves. */
+typedef struct MEMPOOL_FREE MEMPOOL_FREE;
+struct MEMPOOL_FREE {
+    MEMPOOL_FREE* next;
+};
+
+
+void
+mempool_init(MEMPOOL* pool, size_t slab_size)
+{
+    if(slab_size == 0)
+        slab_size = 16 * 1024;  /* Default slab size. */
+    if(slab_size < MEMPOOL_MAX_SIZE)
+        slab_size = MEMPOOL_MAX_SIZE;
+
+    pool->slabs = NULL;
+    pool->slab_size = slab_size;
+    memset(pool->classes, 0, sizeof(pool->classes));
+}
+
+void*
+mempool_alloc(MEMPOOL* pool, size_t size)
+{
+    MEMPOOL_CLASS* cls;
+    size_t class_size;
+    void* ptr;
+
+    if(size > MEMPOOL_MAX_SIZE)
+        return malloc(size);
+
+    class_size = (size > 0)
+            ? (size + MEMPOOL_GRANULARITY - 1) / MEMPOOL_GRANULARITY * MEMPOOL_GRANULARITY
+            : MEMPOOL_GRANULARITY;
+    cls = &pool->classes[class_size / MEMPOOL_GRANULARITY - 1];
+
+    /* Fast path: Reuse a previously freed piece of memory. */
+    if(cls->free_list != NULL) {
+        ptr = cls->free_list;
+        cls->free_list = ((MEMPOOL_FREE*) ptr)->next;
+        return ptr;
+    }
+
+    /* Not enough space in the current slab of the class? */
+    if(cls->bump == NULL  ||  cls->bump + class_size > cls->bump_end) {
+        MEMPOOL_SLAB* slab;
+
+        /* Each slab serves only single size class. The rest of the previous
+         * slab (if any) is too small for this class so it is lost. (It can
+         * be at most class_size - 1 bytes.) */
+        slab = (MEMPOOL_SLAB*) malloc(SLAB_HEADER_SIZE + pool->slab_size);
+        if(slab == NULL)
+            return NULL;
+
+        slab->next = pool->slabs;
+        pool->slabs = slab;
+        cls->bump = ((char*) slab) + SLAB_HEADER_SIZE;
+        cls->bump_end = cls->bump + pool->slab_size;
+    }
+
+    /* Carve the piece from the slab. */
+    ptr = cls->bump;
+    cls->bump += class_size;
+    return ptr;
+}
+
+void
+mempool_free(MEMPOOL* pool, void* ptr, size_t size)
+{
+    MEMPOOL_CLASS* cls;
+
+    if(ptr == NULL)
+        return;
+
+    if(size > MEMPOOL_MAX_SIZE) {
+        free(ptr);
+        return;
+    }
+
+    cls = &pool->classes[(size > 0) ? (size - 1) / MEMPOOL_GRANULARITY : 0];
+    ((MEMPOOL_FREE*) ptr)->next = (MEMPOOL_FREE*) cls->free_list;
+    cls->free_list = ptr;
+}
+
+void
+mempool_fini(MEMPOOL* pool)
+{
+    MEMPOOL_SLAB* slab = pool->slabs;
+
+    while(slab != NULL) {
+        pool->slabs = slab->next;
+        free(slab);
+        slab = pool->slabs;
+    }
+
+    memset(pool->classes, 0, sizeof(pool->classes));
+}
@@ -0,0 +1,118 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2020 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef CRE_MEMPOOL_H
+#define CRE_MEMPOOL_H
+
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/* Implementation of a size-class pool allocator.
+ *
+ * Unlike the chunk allocator (see memchunk.h), the pool allocator allows to
+ * free every allocation individually. Hence it is suitable for long-living
+ * objects which are often allocated and freed, like nodes of trees or lists.
+ *
+ * The requests are rounded up to multiples of MEMPOOL_GRANULARITY. For each
+ * such size class up to MEMPOOL_MAX_SIZE, the allocator keeps a list of freed
+ * pieces of memory which are then reused by future requests of the same class.
+ * When the list is empty, new pieces are taken from a larger block of memory
+ * (slab) `malloc`ed under the hood.
+ *
+ * There is no memory overhead per individual allocation. Therefore the caller
+ * has to tell mempool_free() size of the memory being freed (the same size
+ * which has been passed to mempool_alloc()). In practice this is not a big
+ * burden: the allocator is meant for objects of the known (e.g. node) size.
+ *
+ * Requests larger than MEMPOOL_MAX_SIZE are served directly by malloc().
+ *
+ * The memory obtained from the allocator is aligned to MEMPOOL_GRANULARITY.
+ *
+ * Note the allocator is not thread-safe. If multiple threads need it, each
+ * thread should use its own MEMPOOL (which then also serves as a per-thread
+ * cache). Memory allocated from one MEMPOOL must be freed back into the same
+ * MEMPOOL.
+ */
+
+
+#define MEMPOOL_GRANULARITY     16
+#define MEMPOOL_MAX_SIZE        256
+#define MEMPOOL_CLASS_COUNT     (MEMPOOL_MAX_SIZE / MEMPOOL_GRANULARITY)
+
+
+typedef struct MEMPOOL_SLAB MEMPOOL_SLAB;
+
+typedef struct MEMPOOL_CLASS {
+    void* free_list;
+    char* bump;
+    char* bump_end;
+} MEMPOOL_CLASS;
+
+
+/* The allocator structure. Treat as opaque. */
+typedef struct MEMPOOL {
+    MEMPOOL_SLAB* slabs;
+    size_t slab_size;
+    MEMPOOL_CLASS classes[MEMPOOL_CLASS_COUNT];
+} MEMPOOL;
+
+
+/* Initialize the pool allocator.
+ *
+ * The slab_size specifies the size of the larger blocks allocated under the
+ * hood. Using zero means a default block size (currently 16 kB). It is rounded
+ * up to fit at least one allocation of MEMPOOL_MAX_SIZE.
+ */
+void mempool_init(MEMPOOL* pool, size_t slab_size);
+
+/* Allocate memory from the pool allocator.
+ */
+void* mempool_alloc(MEMPOOL* pool, size_t size);
+
+/* Return the memory to the pool allocator so it may be reused by future
+ * mempool_alloc() calls. The size must be the same as used when allocating
+ * the memory.
+ *
+ * Note the memory is not returned to the system until mempool_fini() is
+ * called.
+ */
+void mempool_free(MEMPOOL* pool, void* ptr, size_t size);
+
+/* Free all the memory used by the given pool allocator (except the large
+ * allocations above MEMPOOL_MAX_SIZE which have not been freed by
+ * mempool_free()).
+ */
+void mempool_fini(MEMPOOL* pool);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* CRE_MEMPOOL_H */
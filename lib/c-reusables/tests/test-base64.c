@@ -23,6 +23,8 @@
  * IN THE SOFTWARE.
  */
 
+#include <errno.h>
+
 #include "acutest.h"
 #include "base64.h"
 
@@ -150,10 +152,314 @@ test_base64_decode_nopadding(void)
 }
 
 
+/* Test-only hook from base64.c. */
+extern unsigned base64_test_cpu_mask;
+
+/* Masks for base64_test_cpu_mask: everything, SSSE3 only, scalar only. */
+static const unsigned test_cpu_masks[] = { ~0u, 0x1, 0x0 };
+static const char* test_cpu_mask_names[] = { "best", "ssse3", "scalar" };
+
+static const BASE64_OPTIONS opts_url = { '-', '_', '\0', 0 };
+static const BASE64_OPTIONS opts_mime = { '+', '/', '=', 76 };
+
+
+static unsigned test_rand_state = 1;
+
+static unsigned
+test_rand(void)
+{
+    test_rand_state = test_rand_state * 1103515245 + 12345;
+    return (test_rand_state >> 16) & 0x7fff;
+}
+
+static void
+test_fill_random(unsigned char* buf, unsigned n)
+{
+    unsigned i;
+
+    for(i = 0; i < n; i++)
+        buf[i] = (unsigned char) test_rand();
+}
+
+/* Naive bit-by-bit reference encoder. */
+static unsigned
+test_ref_encode(const unsigned char* in, unsigned n, char* out,
+                const BASE64_OPTIONS* options)
+{
+    static const char core[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789";
+    char raw[3 * 8192];
+    unsigned n_raw = 0;
+    unsigned n_out = 0;
+    unsigned bit, i, v;
+
+    for(bit = 0; bit < n * 8; bit += 6) {
+        v = 0;
+        for(i = 0; i < 6; i++) {
+            v <<= 1;
+            if(bit + i < n * 8)
+                v |= (in[(bit + i) / 8] >> (7 - (bit + i) % 8)) & 1;
+        }
+        raw[n_raw++] = (v < 62) ? core[v] : (v == 62 ? options->ch62 : options->ch63);
+    }
+    while(options->pad != '\0'  &&  n_raw % 4 != 0)
+        raw[n_raw++] = options->pad;
+
+    for(i = 0; i < n_raw; i++) {
+        if(options->line_width != 0  &&  i > 0  &&  i % options->line_width == 0) {
+            out[n_out++] = '\r';
+            out[n_out++] = '\n';
+        }
+        out[n_out++] = raw[i];
+    }
+    return n_out;
+}
+
+static void
+test_base64_simd_(const BASE64_OPTIONS* options)
+{
+    static unsigned char in[4096 + 64];
+    static char ref[2 * 8192];
+    static char enc[2 * 8192 + 64];
+    static unsigned char dec[4096 + 64];
+    unsigned size, align, m;
+    unsigned n_ref;
+    int n;
+
+    test_fill_random(in, sizeof(in));
+
+    for(m = 0; m < sizeof(test_cpu_masks) / sizeof(test_cpu_masks[0]); m++) {
+        base64_test_cpu_mask = test_cpu_masks[m];
+
+        for(size = 0; size <= 4096; size += (size < 200 ? 1 : 97)) {
+            for(align = 0; align < 4; align++) {
+                n_ref = test_ref_encode(in + align, size, ref, options);
+
+                n = base64_encode(in + align, size, enc + align, sizeof(enc) - align, options);
+                if(!TEST_CHECK(n == (int) n_ref  &&  memcmp(enc + align, ref, n_ref) == 0)) {
+                    TEST_MSG("Implementation: %s", test_cpu_mask_names[m]);
+                    TEST_MSG("Size: %u, alignment: %u", size, align);
+                    goto out;
+                }
+
+                n = base64_decode(enc + align, n_ref, dec + align, size, options);
+                if(!TEST_CHECK(n == (int) size  &&  memcmp(dec + align, in + align, size) == 0)) {
+                    TEST_MSG("Implementation: %s", test_cpu_mask_names[m]);
+                    TEST_MSG("Size: %u, alignment: %u", size, align);
+                    goto out;
+                }
+            }
+        }
+    }
+
+out:
+    base64_test_cpu_mask = ~0u;
+}
+
+static void
+test_base64_simd(void)
+{
+    static const BASE64_OPTIONS opts_std = { '+', '/', '=', 0 };
+    test_base64_simd_(&opts_std);
+}
+
+static void
+test_base64_url(void)
+{
+    test_base64_simd_(&opts_url);
+}
+
+static void
+test_base64_line_wrap(void)
+{
+    unsigned char in[256];
+    char ref[512];
+    char enc[512];
+    unsigned char dec[256];
+    unsigned n_ref;
+    int n;
+
+    /* 57 bytes make exactly one full MIME line (no line break at all). */
+    memset(in, 0, sizeof(in));
+    n = base64_encode(in, 57, enc, sizeof(enc), &opts_mime);
+    TEST_CHECK(n == 76);
+    TEST_CHECK(memchr(enc, '\n', n) == NULL);
+    n = base64_encode(in, 58, enc, sizeof(enc), &opts_mime);
+    TEST_CHECK(n == 76 + 2 + 4);
+    TEST_CHECK(enc[76] == '\r'  &&  enc[77] == '\n');
+    TEST_CHECK(base64_encode(in, 58, NULL, 0, &opts_mime) == 76 + 2 + 4 + 1);
+
+    test_fill_random(in, sizeof(in));
+    for(n = 0; n <= (int) sizeof(in); n++) {
+        BASE64_OPTIONS opts = { '+', '/', '=', 4 + n % 80 };
+
+        n_ref = test_ref_encode(in, n, ref, &opts);
+        TEST_CHECK(base64_encode(in, n, NULL, 0, &opts) == (int) n_ref + 1);
+        TEST_CHECK(base64_encode(in, n, enc, sizeof(enc), &opts) == (int) n_ref);
+        if(!TEST_CHECK(memcmp(enc, ref, n_ref) == 0)) {
+            TEST_MSG("Size: %d, line width: %u", n, opts.line_width);
+            break;
+        }
+
+        TEST_CHECK(base64_decode(ref, n_ref, NULL, 0, &opts) == n);
+        if(!TEST_CHECK(base64_decode(ref, n_ref, dec, sizeof(dec), &opts) == n  &&
+                       memcmp(dec, in, n) == 0)) {
+            TEST_MSG("Size: %d, line width: %u", n, opts.line_width);
+            break;
+        }
+    }
+
+    /* Without line_width, line breaks are invalid. */
+    TEST_CHECK(base64_decode("Zm9v\r\nYmFy", 10, dec, sizeof(dec), NULL) == -EINVAL);
+    /* With it, they can be anywhere. */
+    TEST_CHECK(base64_decode("Zm\n9v\r\nYm\rFy", 12, dec, sizeof(dec), &opts_mime) == 6);
+    TEST_CHECK(memcmp(dec, "foobar", 6) == 0);
+}
+
+static void
+test_base64_invalid(void)
+{
+    static const char* invalid[] = {
+        "Z", "Zh==", "Zm9=", "Z===", "=Zm9", "Zm=v", "Zm9v=", "Zm9v!A==", "Zm9v\xc3\xa4",
+        NULL
+    };
+    unsigned char in[300];
+    char enc[512];
+    char tmp[512];
+    unsigned char dec[512];
+    int n, i, m;
+
+    for(i = 0; invalid[i] != NULL; i++) {
+        TEST_CHECK_(base64_decode(invalid[i], strlen(invalid[i]), NULL, 0, NULL) == -EINVAL,
+                    "decoding '%s' fails (size query)", invalid[i]);
+        TEST_CHECK_(base64_decode(invalid[i], strlen(invalid[i]), dec, sizeof(dec), NULL) == -EINVAL,
+                    "decoding '%s' fails", invalid[i]);
+        TEST_CHECK_(base64_decode(invalid[i], strlen(invalid[i]), dec, sizeof(dec), &opts_mime) == -EINVAL,
+                    "decoding '%s' fails (streaming)", invalid[i]);
+    }
+
+    /* Put a bad character at every position of a long input so the SIMD
+     * kernels hit it at every possible lane. */
+    test_fill_random(in, sizeof(in));
+    n = base64_encode(in, sizeof(in), enc, sizeof(enc), NULL);
+    for(m = 0; m < (int) (sizeof(test_cpu_masks) / sizeof(test_cpu_masks[0])); m++) {
+        base64_test_cpu_mask = test_cpu_masks[m];
+        for(i = 0; i < n; i++) {
+            static const char bad[] = { '!', '-', '_', '\x80', '\xff', '\0', ' ' };
+
+            memcpy(tmp, enc, n);
+            tmp[i] = bad[i % sizeof(bad)];
+            if(!TEST_CHECK(base64_decode(tmp, n, dec, sizeof(dec), NULL) == -EINVAL)) {
+                TEST_MSG("Implementation: %s", test_cpu_mask_names[m]);
+                TEST_MSG("Position: %d", i);
+                break;
+            }
+        }
+    }
+    base64_test_cpu_mask = ~0u;
+
+    /* Too small output buffer. */
+    TEST_CHECK(base64_decode("Zm9vYmFy", 8, dec, 5, NULL) == -ENOBUFS);
+    TEST_CHECK(base64_encode("foobar", 6, enc, 7, NULL) == -ENOBUFS);
+}
+
+static void
+test_base64_streaming_(const BASE64_OPTIONS* options)
+{
+    static unsigned char in[3000];
+    static char ref[8192];
+    static char enc[8192];
+    static unsigned char dec[3000];
+    BASE64_ENCODER encoder;
+    BASE64_DECODER decoder;
+    unsigned n_ref;
+    unsigned in_off, out_off, chunk;
+    int iter, n;
+
+    test_fill_random(in, sizeof(in));
+
+    for(iter = 0; iter < 50; iter++) {
+        unsigned size = (iter < 10) ? (unsigned) iter : test_rand() % sizeof(in);
+
+        n_ref = base64_encode(in, size, ref, sizeof(ref), options);
+
+        /* Encode in random chunks. */
+        base64_encoder_init(&encoder, options);
+        in_off = 0;
+        out_off = 0;
+        while(in_off < size) {
+            chunk = test_rand() % (iter % 2 ? 8 : 200);
+            if(chunk > size - in_off)
+                chunk = size - in_off;
+            n = base64_encoder_update(&encoder, in + in_off, chunk, NULL, 0);
+            TEST_CHECK(n >= 0);
+            if(n > 0)
+                TEST_CHECK(base64_encoder_update(&encoder, in + in_off, chunk, enc + out_off, n - 1) == -ENOBUFS);
+            TEST_CHECK(base64_encoder_update(&encoder, in + in_off, chunk, enc + out_off, n) == n);
+            in_off += chunk;
+            out_off += n;
+        }
+        n = base64_encoder_finish(&encoder, enc + out_off, sizeof(enc) - out_off);
+        TEST_CHECK(n >= 0);
+        out_off += n;
+        if(!TEST_CHECK(out_off == n_ref  &&  memcmp(enc, ref, n_ref) == 0)) {
+            TEST_MSG("Size: %u", size);
+            break;
+        }
+
+        /* Decode in random chunks. */
+        base64_decoder_init(&decoder, options);
+        in_off = 0;
+        out_off = 0;
+        while(in_off < n_ref) {
+            chunk = test_rand() % (iter % 2 ? 8 : 200);
+            if(chunk > n_ref - in_off)
+                chunk = n_ref - in_off;
+            n = base64_decoder_update(&decoder, ref + in_off, chunk, NULL, 0);
+            TEST_CHECK(n >= 0);
+            if(n > 0)
+                TEST_CHECK(base64_decoder_update(&decoder, ref + in_off, chunk, dec + out_off, n - 1) == -ENOBUFS);
+            TEST_CHECK(base64_decoder_update(&decoder, ref + in_off, chunk, dec + out_off, n) == n);
+            in_off += chunk;
+            out_off += n;
+        }
+        n = base64_decoder_finish(&decoder, dec + out_off, sizeof(dec) - out_off);
+        TEST_CHECK(n >= 0);
+        out_off += n;
+        if(!TEST_CHECK(out_off == size  &&  memcmp(dec, in, size) == 0)) {
+            TEST_MSG("Size: %u", size);
+            break;
+        }
+    }
+
+    /* Truncated input is detected by base64_decoder_finish(). */
+    base64_decoder_init(&decoder, options);
+    TEST_CHECK(base64_decoder_update(&decoder, "Zm9vY", 5, dec, sizeof(dec)) == 3);
+    TEST_CHECK(base64_decoder_finish(&decoder, dec, sizeof(dec)) == -EINVAL);
+}
+
+static void
+test_base64_streaming(void)
+{
+    test_base64_streaming_(NULL);
+}
+
+static void
+test_base64_streaming_mime(void)
+{
+    test_base64_streaming_(&opts_mime);
+}
+
+
 TEST_LIST = {
     { "base64-encode-standard",     test_base64_encode },
     { "base64-encode-no-padding",   test_base64_encode_nopadding },
     { "base64-decode-standard",     test_base64_decode },
     { "base64-decode-no-padding",   test_base64_decode_nopadding },
+    { "base64-simd",                test_base64_simd },
+    { "base64-url",                 test_base64_url },
+    { "base64-line-wrap",           test_base64_line_wrap },
+    { "base64-invalid",             test_base64_invalid },
+    { "base64-streaming",           test_base64_streaming },
+    { "base64-streaming-mime",      test_base64_streaming_mime },
     { 0 }
 };
@@ -0,0 +1,299 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2020 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "acutest.h"
+#include "btree.h"
+
+#include <stdlib.h>
+
+
+/* Provided by btree.c when built with -DCRE_TEST. */
+int btree_verify(BTREE* tree);
+
+
+#define N       20000
+
+/* Pseudo-random permutation of 0 ... (N-1). (7919 is a prime, N is not its
+ * multiple.) */
+#define PERM(i)     ((BTREE_KEY) (((i) * 7919) % N))
+
+#define DATA(key)   ((void*) (uintptr_t) ((key) + 1))
+
+
+static void
+test_empty(void)
+{
+    BTREE tree = BTREE_INITIALIZER;
+    BTREE_CURSOR cur;
+
+    TEST_CHECK(btree_verify(&tree) == 0);
+    TEST_CHECK(btree_is_empty(&tree));
+    TEST_CHECK(btree_lookup(&tree, 42) == NULL);
+    TEST_CHECK(btree_remove(&tree, 42, NULL) == -1);
+    TEST_CHECK(btree_head(&tree, &cur) == NULL);
+    TEST_CHECK(btree_tail(&tree, &cur) == NULL);
+    TEST_CHECK(btree_lower_bound(&tree, 42, &cur) == NULL);
+
+    TEST_CHECK(btree_insert(&tree, 42, DATA(42)) == 0);
+    TEST_CHECK(btree_verify(&tree) == 0);
+    TEST_CHECK(!btree_is_empty(&tree));
+    TEST_CHECK(btree_remove(&tree, 42, NULL) == 0);
+    TEST_CHECK(btree_verify(&tree) == 0);
+    TEST_CHECK(btree_is_empty(&tree));
+
+    btree_fini(&tree, NULL);
+}
+
+static void
+test_insert_lookup(void)
+{
+    BTREE tree = BTREE_INITIALIZER;
+    void** p_data;
+    int i;
+
+    for(i = 0; i < N; i++) {
+        TEST_CHECK(btree_insert(&tree, PERM(i), DATA(PERM(i))) == 0);
+        if(i % 1000 == 0)
+            TEST_CHECK(btree_verify(&tree) == 0);
+    }
+    TEST_CHECK(btree_verify(&tree) == 0);
+    TEST_CHECK(btree_size(&tree) == N);
+
+    /* Duplicate keys are refused. */
+    TEST_CHECK(btree_insert(&tree, 0, NULL) == -1);
+    TEST_CHECK(btree_insert(&tree, N - 1, NULL) == -1);
+    TEST_CHECK(btree_size(&tree) == N);
+
+    for(i = 0; i < N; i++) {
+        p_data = btree_lookup(&tree, i);
+        if(!TEST_CHECK(p_data != NULL))
+            break;
+        TEST_CHECK(*p_data == DATA(i));
+    }
+    TEST_CHECK(btree_lookup(&tree, -1) == NULL);
+    TEST_CHECK(btree_lookup(&tree, N) == NULL);
+
+    /* The data may be updated through the returned pointer. */
+    p_data = btree_lookup(&tree, 42);
+    *p_data = NULL;
+    TEST_CHECK(*btree_lookup(&tree, 42) == NULL);
+
+    btree_fini(&tree, NULL);
+    TEST_CHECK(btree_is_empty(&tree));
+}
+
+static void
+test_extreme_keys(void)
+{
+    BTREE tree = BTREE_INITIALIZER;
+    BTREE_CURSOR cur;
+    int i;
+
+    for(i = 0; i < 100; i++) {
+        TEST_CHECK(btree_insert(&tree, INT64_MIN + i, NULL) == 0);
+        TEST_CHECK(btree_insert(&tree, INT64_MAX - i, NULL) == 0);
+        TEST_CHECK(btree_insert(&tree, i - 50, NULL) == 0);
+    }
+    TEST_CHECK(btree_verify(&tree) == 0);
+
+    TEST_CHECK(btree_lookup(&tree, INT64_MIN) != NULL);
+    TEST_CHECK(btree_lookup(&tree, INT64_MAX) != NULL);
+    TEST_CHECK(btree_head(&tree, &cur) != NULL  &&  btree_current_key(&cur) == INT64_MIN);
+    TEST_CHECK(btree_tail(&tree, &cur) != NULL  &&  btree_current_key(&cur) == INT64_MAX);
+    TEST_CHECK(btree_lower_bound(&tree, INT64_MAX, &cur) != NULL);
+    TEST_CHECK(btree_current_key(&cur) == INT64_MAX);
+
+    TEST_CHECK(btree_remove(&tree, INT64_MAX, NULL) == 0);
+    TEST_CHECK(btree_remove(&tree, INT64_MIN, NULL) == 0);
+    TEST_CHECK(btree_verify(&tree) == 0);
+    TEST_CHECK(btree_lookup(&tree, INT64_MAX) == NULL);
+    TEST_CHECK(btree_lower_bound(&tree, INT64_MAX, &cur) == NULL);
+
+    btree_fini(&tree, NULL);
+}
+
+static void
+test_remove(void)
+{
+    BTREE tree = BTREE_INITIALIZER;
+    void* data;
+    int i;
+
+    for(i = 0; i < N; i++)
+        TEST_CHECK(btree_insert(&tree, i, DATA(i)) == 0);
+
+    /* Remove every other key in a pseudo-random order. */
+    for(i = 0; i < N; i++) {
+        if(PERM(i) % 2 == 0) {
+            data = NULL;
+            TEST_CHECK(btree_remove(&tree, PERM(i), &data) == 0);
+            TEST_CHECK(data == DATA(PERM(i)));
+        }
+        if(i % 1000 == 0)
+            TEST_CHECK(btree_verify(&tree) == 0);
+    }
+    TEST_CHECK(btree_verify(&tree) == 0);
+    TEST_CHECK(btree_size(&tree) == N / 2);
+
+    for(i = 0; i < N; i++) {
+        if(i % 2 == 0) {
+            TEST_CHECK(btree_lookup(&tree, i) == NULL);
+            TEST_CHECK(btree_remove(&tree, i, NULL) == -1);
+        } else {
+            TEST_CHECK(btree_lookup(&tree, i) != NULL);
+        }
+    }
+
+    /* Remove the rest. */
+    for(i = 0; i < N; i++) {
+        if(PERM(i) % 2 == 1)
+            TEST_CHECK(btree_remove(&tree, PERM(i), NULL) == 0);
+        if(i % 1000 == 0)
+            TEST_CHECK(btree_verify(&tree) == 0);
+    }
+    TEST_CHECK(btree_verify(&tree) == 0);
+    TEST_CHECK(btree_is_empty(&tree));
+
+    btree_fini(&tree, NULL);
+}
+
+static void
+test_walk(void)
+{
+    BTREE tree = BTREE_INITIALIZER;
+    BTREE_CURSOR cur;
+    void** p_data;
+    BTREE_KEY expected;
+
+    for(expected = 0; expected < N; expected++)
+        TEST_CHECK(btree_insert(&tree, PERM(expected), DATA(PERM(expected))) == 0);
+
+    /* Forward. */
+    expected = 0;
+    for(p_data = btree_head(&tree, &cur); p_data != NULL; p_data = btree_next(&cur)) {
+        if(!TEST_CHECK(btree_current_key(&cur) == expected))
+            break;
+        TEST_CHECK(*p_data == DATA(expected));
+        expected++;
+    }
+    TEST_CHECK(expected == N);
+    /* The cursor stays at the last record. */
+    TEST_CHECK(btree_current_key(&cur) == N - 1);
+    TEST_CHECK(btree_prev(&cur) != NULL  &&  btree_current_key(&cur) == N - 2);
+
+    /* Backward. */
+    expected = N - 1;
+    for(p_data = btree_tail(&tree, &cur); p_data != NULL; p_data = btree_prev(&cur)) {
+        if(!TEST_CHECK(btree_current_key(&cur) == expected))
+            break;
+        expected--;
+    }
+    TEST_CHECK(expected == -1);
+    TEST_CHECK(btree_current_key(&cur) == 0);
+
+    btree_fini(&tree, NULL);
+}
+
+static void
+test_range(void)
+{
+    BTREE tree = BTREE_INITIALIZER;
+    BTREE_CURSOR cur;
+    void** p_data;
+    BTREE_KEY key;
+    int i;
+
+    /* Only multiples of 10. */
+    for(i = 0; i < N; i++)
+        TEST_CHECK(btree_insert(&tree, 10 * PERM(i), NULL) == 0);
+
+    for(key = -5; key < 10 * N; key += 97) {
+        BTREE_KEY expected = (key <= 0) ? 0 : ((key + 9) / 10) * 10;
+
+        TEST_CASE_("lower bound of %d", (int) key);
+        p_data = btree_lower_bound(&tree, key, &cur);
+        if(!TEST_CHECK(p_data != NULL))
+            continue;
+
+        /* Walk over the range <key, key+100). */
+        for(i = 0; p_data != NULL && btree_current_key(&cur) < key + 100; i++) {
+            TEST_CHECK(btree_current_key(&cur) == expected);
+            expected += 10;
+            p_data = btree_next(&cur);
+        }
+        TEST_CHECK(i == 10  ||  expected == 10 * N);
+
+        /* Lookup with a cursor succeeds only for the present keys. */
+        TEST_CHECK((btree_lookup_ex(&tree, key, &cur) != NULL) == (key >= 0 && key % 10 == 0));
+    }
+    TEST_CHECK(btree_lower_bound(&tree, 10 * N, &cur) == NULL);
+
+    btree_fini(&tree, NULL);
+}
+
+static unsigned dtor_count;
+static BTREE_KEY dtor_last_key;
+
+static void
+dtor(BTREE_KEY key, void* data)
+{
+    TEST_CHECK(dtor_count == 0  ||  key > dtor_last_key);
+    TEST_CHECK(data == DATA(key));
+    dtor_last_key = key;
+    dtor_count++;
+}
+
+static void
+test_fini(void)
+{
+    BTREE tree = BTREE_INITIALIZER;
+    int i;
+
+    for(i = 0; i < N; i++)
+        TEST_CHECK(btree_insert(&tree, PERM(i), DATA(PERM(i))) == 0);
+
+    dtor_count = 0;
+    btree_fini(&tree, dtor);
+    TEST_CHECK(dtor_count == N);
+    TEST_CHECK(btree_verify(&tree) == 0);
+    TEST_CHECK(btree_is_empty(&tree));
+
+    /* The tree may be used again. */
+    TEST_CHECK(btree_insert(&tree, 1, DATA(1)) == 0);
+    btree_fini(&tree, NULL);
+}
+
+
+TEST_LIST = {
+    { "empty",              test_empty },
+    { "insert-and-lookup",  test_insert_lookup },
+    { "extreme-keys",       test_extreme_keys },
+    { "remove",             test_remove },
+    { "walk",               test_walk },
+    { "range",              test_range },
+    { "fini",               test_fini },
+    { NULL, NULL }
+};
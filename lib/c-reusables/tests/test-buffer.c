@@ -129,13 +129,132 @@ test_remove(void)
     buffer_fini(&buf);
 }
 
+static void
+test_remove_middle(void)
+{
+    BUFFER buf = BUFFER_INITIALIZER;
+
+    /* Removing a range shorter then the tail behind it must move whole the
+     * tail. */
+    buffer_append(&buf, "1234567890", 10);
+    buffer_remove(&buf, 1, 2);
+    TEST_CHECK(buf.size == 8);
+    TEST_CHECK(memcmp(buf.data, "14567890", buf.size) == 0);
+
+    buffer_fini(&buf);
+}
+
+static void
+test_reserve_growth(void)
+{
+    BUFFER buf = BUFFER_INITIALIZER;
+    size_t i;
+    unsigned realloc_count = 0;
+    size_t last_alloc = 0;
+
+    /* Repeated reserve + write must not reallocate on every step. */
+    for(i = 0; i < 10000; i++) {
+        TEST_CHECK(buffer_reserve(&buf, 7) == 0);
+        TEST_CHECK(buf.alloc >= buf.size + 7);
+        memcpy(buffer_data_at(&buf, buf.size), "abcdefg", 7);
+        buf.size += 7;
+
+        if(buf.alloc != last_alloc) {
+            realloc_count++;
+            last_alloc = buf.alloc;
+        }
+    }
+    TEST_CHECK_(realloc_count < 50, "realloc count: %u", realloc_count);
+    TEST_CHECK(memcmp(buffer_data_at(&buf, 7 * 9999), "abcdefg", 7) == 0);
+
+    buffer_fini(&buf);
+}
+
+static void
+test_append_fmt(void)
+{
+    BUFFER buf = BUFFER_INITIALIZER;
+    int i;
+
+    TEST_CHECK(buffer_append_fmt(&buf, "%s-%d", "foo", 42) == 0);
+    TEST_CHECK(buf.size == 6);
+    TEST_CHECK(strcmp((char*) buf.data, "foo-42") == 0);
+
+    TEST_CHECK(buffer_append_fmt(&buf, "%c", 'x') == 0);
+    TEST_CHECK(buf.size == 7);
+    TEST_CHECK(strcmp((char*) buf.data, "foo-42x") == 0);
+
+    /* Empty output. */
+    TEST_CHECK(buffer_append_fmt(&buf, "%s", "") == 0);
+    TEST_CHECK(buf.size == 7);
+
+    /* Longer output than any spare capacity. */
+    buffer_clear(&buf);
+    for(i = 0; i < 1000; i++)
+        TEST_CHECK(buffer_append_fmt(&buf, "%04d|", i) == 0);
+    TEST_CHECK(buf.size == 5000);
+    TEST_CHECK(memcmp(buffer_data_at(&buf, 5 * 123), "0123|", 5) == 0);
+    TEST_CHECK(((char*) buf.data)[buf.size] == '\0');
+
+    buffer_fini(&buf);
+}
+
+static void
+test_sbo(void)
+{
+    BUFFER_SBO(16) sbo;
+    void* data;
+    int i;
+
+    BUFFER_SBO_INIT(&sbo);
+    TEST_CHECK(buffer_is_empty(&sbo.buf));
+
+    /* Small contents stays in the inline storage. */
+    TEST_CHECK(buffer_append(&sbo.buf, "hello", 5) == 0);
+    TEST_CHECK(buffer_append_fmt(&sbo.buf, " %d", 42) == 0);
+    TEST_CHECK(buffer_data(&sbo.buf) == (void*) sbo.storage);
+    TEST_CHECK(memcmp(buffer_data(&sbo.buf), "hello 42", 8) == 0);
+    buffer_shrink(&sbo.buf);
+    TEST_CHECK(buffer_data(&sbo.buf) == (void*) sbo.storage);
+
+    /* Moving out of the inline storage makes a copy. */
+    data = buffer_acquire(&sbo.buf);
+    TEST_CHECK(data != NULL  &&  data != (void*) sbo.storage);
+    TEST_CHECK(memcmp(data, "hello 42", 8) == 0);
+    TEST_CHECK(buffer_is_empty(&sbo.buf));
+    free(data);
+
+    /* Growing beyond it moves the contents to the heap. */
+    BUFFER_SBO_INIT(&sbo);
+    for(i = 0; i < 100; i++)
+        TEST_CHECK(buffer_append(&sbo.buf, "0123456789", 10) == 0);
+    TEST_CHECK(buffer_data(&sbo.buf) != (void*) sbo.storage);
+    TEST_CHECK(buffer_size(&sbo.buf) == 1000);
+    TEST_CHECK(memcmp(buffer_data_at(&sbo.buf, 990), "0123456789", 10) == 0);
+    buffer_fini(&sbo.buf);
+
+    /* Inserting in the middle of the inline storage. */
+    BUFFER_SBO_INIT(&sbo);
+    TEST_CHECK(buffer_append(&sbo.buf, "1234567890", 10) == 0);
+    TEST_CHECK(buffer_insert(&sbo.buf, 3, "foo", 3) == 0);
+    TEST_CHECK(buffer_data(&sbo.buf) == (void*) sbo.storage);
+    TEST_CHECK(buffer_insert(&sbo.buf, 3, "barbaz", 6) == 0);
+    TEST_CHECK(buffer_data(&sbo.buf) != (void*) sbo.storage);
+    TEST_CHECK(memcmp(buffer_data(&sbo.buf), "123barbazfoo4567890", 19) == 0);
+    buffer_fini(&sbo.buf);
+}
+
 
 TEST_LIST = {
-    { "init",       test_init },
-    { "grow",       test_grow },
-    { "reserve",    test_reserve },
-    { "shrink",     test_shrink },
-    { "insert",     test_insert },
-    { "remove",     test_remove },
+    { "init",            test_init },
+    { "grow",            test_grow },
+    { "reserve",         test_reserve },
+    { "shrink",          test_shrink },
+    { "insert",          test_insert },
+    { "remove",          test_remove },
+    { "remove-middle",   test_remove_middle },
+    { "reserve-growth",  test_reserve_growth },
+    { "append-fmt",      test_append_fmt },
+    { "sbo",             test_sbo },
     { 0 }
 };
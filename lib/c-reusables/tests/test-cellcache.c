@@ -0,0 +1,272 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2020 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "acutest.h"
+#include "cellcache.h"
+
+#include <string.h>
+
+
+static int
+get_int(CELLCACHE* cache, uint32_t x, uint32_t y, int* p_value)
+{
+    size_t size;
+
+    if(cellcache_get(cache, x, y, p_value, sizeof(int), &size) != 0)
+        return -1;
+    return (size == sizeof(int) ? 0 : -1);
+}
+
+static int
+put_int(CELLCACHE* cache, uint32_t x, uint32_t y, int value)
+{
+    return cellcache_put(cache, x, y, &value, sizeof(int));
+}
+
+static void
+test_lru(void)
+{
+    CELLCACHE* cache;
+    CELLCACHE_STATS stats;
+    int v;
+
+    cache = cellcache_create(3, NULL, NULL, NULL);
+    TEST_CHECK(cache != NULL);
+
+    TEST_CHECK(put_int(cache, 0, 0, 100) == 0);
+    TEST_CHECK(put_int(cache, 1, 0, 101) == 0);
+    TEST_CHECK(put_int(cache, 2, 0, 102) == 0);
+
+    /* Touch (0,0), so (1,0) becomes the least recently used one. */
+    TEST_CHECK(get_int(cache, 0, 0, &v) == 0  &&  v == 100);
+    TEST_CHECK(put_int(cache, 3, 0, 103) == 0);
+    TEST_CHECK(get_int(cache, 1, 0, &v) != 0);
+    TEST_CHECK(get_int(cache, 0, 0, &v) == 0  &&  v == 100);
+    TEST_CHECK(get_int(cache, 2, 0, &v) == 0  &&  v == 102);
+    TEST_CHECK(get_int(cache, 3, 0, &v) == 0  &&  v == 103);
+
+    /* Replacing does not evict anything. */
+    TEST_CHECK(put_int(cache, 2, 0, 999) == 0);
+    TEST_CHECK(get_int(cache, 2, 0, &v) == 0  &&  v == 999);
+    TEST_CHECK(get_int(cache, 0, 0, &v) == 0);
+    TEST_CHECK(get_int(cache, 3, 0, &v) == 0);
+
+    cellcache_stats(cache, &stats);
+    TEST_CHECK(stats.count == 3);
+    TEST_CHECK(stats.evictions == 1);
+    TEST_CHECK(stats.misses == 1);
+
+    cellcache_destroy(cache);
+}
+
+static void
+test_data(void)
+{
+    CELLCACHE* cache;
+    char buf[4];
+    size_t size;
+
+    cache = cellcache_create(16, NULL, NULL, NULL);
+
+    /* Longer data than the buffer: Copied partially, full size reported. */
+    TEST_CHECK(cellcache_put(cache, 7, 8, "hello", 6) == 0);
+    TEST_CHECK(cellcache_get(cache, 7, 8, buf, sizeof(buf), &size) == 0);
+    TEST_CHECK(size == 6);
+    TEST_CHECK(memcmp(buf, "hell", 4) == 0);
+
+    /* Empty data. */
+    TEST_CHECK(cellcache_put(cache, 0, 0, NULL, 0) == 0);
+    TEST_CHECK(cellcache_get(cache, 0, 0, buf, sizeof(buf), &size) == 0);
+    TEST_CHECK(size == 0);
+
+    cellcache_destroy(cache);
+}
+
+static void
+test_invalidate(void)
+{
+    CELLCACHE* cache;
+    CELLCACHE_RECT rect = { 2, 2, 4, 4 };
+    CELLCACHE_STATS stats;
+    uint32_t x, y;
+    int v;
+
+    cache = cellcache_create(100, NULL, NULL, NULL);
+    for(y = 0; y < 6; y++) {
+        for(x = 0; x < 6; x++)
+            put_int(cache, x, y, (int) (x * 10 + y));
+    }
+
+    cellcache_invalidate(cache, &rect);
+    for(y = 0; y < 6; y++) {
+        for(x = 0; x < 6; x++) {
+            int in_rect = (2 <= x  &&  x < 4  &&  2 <= y  &&  y < 4);
+            TEST_CHECK((get_int(cache, x, y, &v) == 0) == !in_rect);
+        }
+    }
+
+    cellcache_invalidate(cache, NULL);
+    cellcache_stats(cache, &stats);
+    TEST_CHECK(stats.count == 0);
+
+    cellcache_destroy(cache);
+}
+
+
+/* Provider for the tests below: The value of (x, y) is x * 1000 + y. Cells
+ * with x == fail_x are not available. If invalidate_x matches, the cell is
+ * invalidated (as if the data changed) before the fetched data are stored. */
+typedef struct PROVIDER {
+    uint32_t fail_x;
+    uint32_t invalidate_x;
+    unsigned fetches;
+    unsigned notified_rows;
+    unsigned notified_cells;
+} PROVIDER;
+
+static int
+provider_fetch(CELLCACHE* cache, uint32_t x, uint32_t y, void* ctx)
+{
+    PROVIDER* p = (PROVIDER*) ctx;
+
+    p->fetches++;
+    if(x == p->fail_x)
+        return -1;
+    if(x == p->invalidate_x) {
+        CELLCACHE_RECT rect = { x, y, x + 1, y + 1 };
+        cellcache_invalidate(cache, &rect);
+    }
+    return put_int(cache, x, y, (int) (x * 1000 + y));
+}
+
+static void
+provider_notify(CELLCACHE* cache, unsigned i, const CELLCACHE_RECT* done, void* ctx)
+{
+    PROVIDER* p = (PROVIDER*) ctx;
+
+    p->notified_rows++;
+    p->notified_cells += (done->x1 - done->x0) * (done->y1 - done->y0);
+}
+
+static void
+test_request(void)
+{
+    PROVIDER p = { 0xffffffff, 0xffffffff, 0, 0, 0 };
+    CELLCACHE* cache;
+    CELLCACHE_RECT rects[2] = { { 0, 0, 4, 10 }, { 0, 10, 4, 15 } };
+    uint32_t x, y;
+    int v;
+    int ok = 1;
+
+    cache = cellcache_create(1000, provider_fetch, provider_notify, &p);
+    TEST_CHECK(cache != NULL);
+
+    TEST_CHECK(cellcache_request(cache, rects, 2) == 0);
+    cellcache_wait(cache);
+    for(y = 0; y < 15; y++) {
+        for(x = 0; x < 4; x++) {
+            if(get_int(cache, x, y, &v) != 0  ||  v != (int) (x * 1000 + y))
+                ok = 0;
+        }
+    }
+    TEST_CHECK(ok);
+    TEST_CHECK(p.fetches == 60);
+    TEST_CHECK(p.notified_rows == 15);
+    TEST_CHECK(p.notified_cells == 60);
+
+    /* Already cached cells are not fetched again. */
+    TEST_CHECK(cellcache_request(cache, rects, 2) == 0);
+    cellcache_wait(cache);
+    TEST_CHECK(p.fetches == 60);
+    TEST_CHECK(p.notified_rows == 15);
+
+    cellcache_destroy(cache);
+}
+
+static void
+test_request_capacity(void)
+{
+    PROVIDER p = { 0xffffffff, 0xffffffff, 0, 0, 0 };
+    CELLCACHE* cache;
+    CELLCACHE_RECT rect = { 0, 0, 10, 10 };
+    CELLCACHE_STATS stats;
+    int v;
+
+    /* The worker stops after capacity cells, so it does not evict what it
+     * has just fetched. */
+    cache = cellcache_create(25, provider_fetch, provider_notify, &p);
+    TEST_CHECK(cellcache_request(cache, &rect, 1) == 0);
+    cellcache_wait(cache);
+    cellcache_stats(cache, &stats);
+    TEST_CHECK(p.fetches == 25);
+    TEST_CHECK(stats.count == 25);
+    TEST_CHECK(stats.evictions == 0);
+    TEST_CHECK(get_int(cache, 0, 0, &v) == 0);
+    TEST_CHECK(get_int(cache, 4, 2, &v) == 0);
+    TEST_CHECK(get_int(cache, 5, 2, &v) != 0);
+    /* The partial last row has been notified too. */
+    TEST_CHECK(p.notified_cells == 25);
+
+    cellcache_destroy(cache);
+}
+
+static void
+test_request_failures(void)
+{
+    PROVIDER p = { 1, 2, 0, 0, 0 };
+    CELLCACHE* cache;
+    CELLCACHE_RECT rect = { 0, 0, 4, 3 };
+    uint32_t x, y;
+    int v;
+    int ok = 1;
+
+    cache = cellcache_create(100, provider_fetch, NULL, &p);
+    TEST_CHECK(cellcache_request(cache, &rect, 1) == 0);
+    cellcache_wait(cache);
+    for(y = 0; y < 3; y++) {
+        for(x = 0; x < 4; x++) {
+            /* x == 1 fails, and the data of x == 2 were invalidated while
+             * being fetched. */
+            int expected = (x != 1  &&  x != 2);
+            if((get_int(cache, x, y, &v) == 0) != expected)
+                ok = 0;
+        }
+    }
+    TEST_CHECK(ok);
+    TEST_CHECK(p.fetches == 12);
+
+    cellcache_destroy(cache);
+}
+
+
+TEST_LIST = {
+    { "lru",                test_lru },
+    { "data",               test_data },
+    { "invalidate",         test_invalidate },
+    { "request",            test_request },
+    { "request-capacity",   test_request_capacity },
+    { "request-failures",   test_request_failures },
+    { 0 }
+};
@@ -0,0 +1,438 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2020 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "acutest.h"
+#include "column.h"
+
+#include <math.h>
+#include <string.h>
+
+
+/* Simple deterministic PRNG so failures are reproducible. */
+static unsigned
+rnd(unsigned* state)
+{
+    *state = *state * 1103515245U + 12345U;
+    return (*state >> 16) & 0x7fff;
+}
+
+static int
+is_sorted_stable(const COLUMN* col, const size_t* rows, size_t n, unsigned flags)
+{
+    size_t i;
+    int null0, null1;
+    int cmp;
+
+    for(i = 1; i < n; i++) {
+        null0 = column_is_null(col, rows[i-1]);
+        null1 = column_is_null(col, rows[i]);
+        if(null0 || null1) {
+            if(null0 && null1)
+                cmp = 0;
+            else
+                cmp = (null0 ? +1 : -1) * ((flags & COLUMN_SORT_NULLSFIRST) ? -1 : +1);
+        } else {
+            switch(column_type(col)) {
+                case COLUMN_INT64:
+                {
+                    int64_t a = column_get_int64(col, rows[i-1]);
+                    int64_t b = column_get_int64(col, rows[i]);
+                    cmp = (a < b) ? -1 : (a > b) ? +1 : 0;
+                    break;
+                }
+                case COLUMN_DOUBLE:
+                {
+                    double a = column_get_double(col, rows[i-1]);
+                    double b = column_get_double(col, rows[i]);
+                    cmp = (a < b) ? -1 : (a > b) ? +1 : 0;
+                    break;
+                }
+                default:
+                {
+                    size_t la, lb;
+                    const char* a = column_get_string(col, rows[i-1], &la);
+                    const char* b = column_get_string(col, rows[i], &lb);
+                    cmp = memcmp(a, b, (la < lb ? la : lb));
+                    if(cmp == 0)
+                        cmp = (la < lb) ? -1 : (la > lb) ? +1 : 0;
+                    break;
+                }
+            }
+            if(flags & COLUMN_SORT_DESC)
+                cmp = -cmp;
+        }
+
+        if(cmp > 0)
+            return 0;
+        /* Stability: the input vector was 0, 1, 2, ... */
+        if(cmp == 0  &&  rows[i-1] > rows[i])
+            return 0;
+    }
+
+    return 1;
+}
+
+
+static void
+test_init(void)
+{
+    COLUMN col;
+
+    column_init(&col, COLUMN_INT64);
+    TEST_CHECK(column_type(&col) == COLUMN_INT64);
+    TEST_CHECK(column_count(&col) == 0);
+    column_fini(&col);
+}
+
+static void
+test_int64(void)
+{
+    COLUMN col;
+    size_t row;
+
+    column_init(&col, COLUMN_INT64);
+    TEST_CHECK(column_insert(&col, 0, 5) == 0);
+    TEST_CHECK(column_count(&col) == 5);
+    TEST_CHECK(column_is_null(&col, 3));
+    TEST_CHECK(column_min(&col, NULL, &row) == -1);
+
+    column_set_int64(&col, 1, -7);
+    column_set_int64(&col, 3, INT64_MAX);
+    column_set_int64(&col, 4, INT64_MIN);
+    TEST_CHECK(!column_is_null(&col, 1));
+    TEST_CHECK(column_get_int64(&col, 1) == -7);
+
+    TEST_CHECK(column_min(&col, NULL, &row) == 0);
+    TEST_CHECK(row == 4);
+    TEST_CHECK(column_max(&col, NULL, &row) == 0);
+    TEST_CHECK(row == 3);
+
+    /* Insert in the middle: [null -7 X X null MAX MIN] */
+    TEST_CHECK(column_insert(&col, 2, 2) == 0);
+    TEST_CHECK(column_count(&col) == 7);
+    TEST_CHECK(column_get_int64(&col, 1) == -7);
+    TEST_CHECK(column_is_null(&col, 2));
+    TEST_CHECK(column_is_null(&col, 3));
+    TEST_CHECK(column_get_int64(&col, 5) == INT64_MAX);
+
+    column_remove(&col, 0, 2);
+    TEST_CHECK(column_count(&col) == 5);
+    TEST_CHECK(column_get_int64(&col, 3) == INT64_MAX);
+    TEST_CHECK(column_get_int64(&col, 4) == INT64_MIN);
+
+    column_set_null(&col, 4);
+    TEST_CHECK(column_is_null(&col, 4));
+    TEST_CHECK(column_min(&col, NULL, &row) == 0);
+    TEST_CHECK(row == 3);
+
+    column_fini(&col);
+}
+
+static void
+test_string(void)
+{
+    COLUMN col;
+    size_t len, row;
+    const char* s;
+
+    column_init(&col, COLUMN_STRING);
+    TEST_CHECK(column_insert(&col, 0, 4) == 0);
+    TEST_CHECK(column_get_string(&col, 0, &len) == NULL);
+    TEST_CHECK(len == 0);
+
+    TEST_CHECK(column_set_string(&col, 0, "OK", 2) == 0);
+    TEST_CHECK(column_set_string(&col, 1, "FAILED", 6) == 0);
+    TEST_CHECK(column_set_string(&col, 2, "OK", 2) == 0);
+    TEST_CHECK(column_string_count(&col) == 2);
+
+    /* Equal strings share the storage. */
+    TEST_CHECK(column_get_string(&col, 0, NULL) == column_get_string(&col, 2, NULL));
+    s = column_get_string(&col, 1, &len);
+    TEST_CHECK(len == 6  &&  memcmp(s, "FAILED", 6) == 0);
+
+    /* Overwriting the only reference releases the string. */
+    TEST_CHECK(column_set_string(&col, 1, "OK", 2) == 0);
+    TEST_CHECK(column_string_count(&col) == 1);
+    TEST_CHECK(column_set_string(&col, 3, "", 0) == 0);
+    TEST_CHECK(!column_is_null(&col, 3));
+    TEST_CHECK(column_string_count(&col) == 2);
+
+    TEST_CHECK(column_min(&col, NULL, &row) == 0);
+    TEST_CHECK(row == 3);
+    TEST_CHECK(column_max(&col, NULL, &row) == 0);
+    TEST_CHECK(row == 0);
+
+    TEST_CHECK(column_set_string(&col, 3, NULL, 0) == 0);
+    TEST_CHECK(column_is_null(&col, 3));
+    column_remove(&col, 0, 2);
+    TEST_CHECK(column_string_count(&col) == 1);
+    column_clear(&col, 0, 2);
+    TEST_CHECK(column_string_count(&col) == 0);
+
+    column_fini(&col);
+}
+
+static void
+test_string_reuse(void)
+{
+    COLUMN col;
+    char buf[16];
+    unsigned seed = 99;
+    size_t i, k;
+
+    /* Many overwrites with a small set of values must not grow the dictionary. */
+    column_init(&col, COLUMN_STRING);
+    TEST_CHECK(column_insert(&col, 0, 100) == 0);
+    for(k = 0; k < 20000; k++) {
+        i = rnd(&seed) % 100;
+        sprintf(buf, "host-%u", rnd(&seed) % 10);
+        TEST_CHECK_(column_set_string(&col, i, buf, strlen(buf)) == 0, "set %u", (unsigned) k);
+    }
+    TEST_CHECK(column_string_count(&col) <= 10);
+    TEST_CHECK(col.dict != NULL);
+
+    for(i = 0; i < 100; i++)
+        column_set_null(&col, i);
+    TEST_CHECK(column_string_count(&col) == 0);
+    column_fini(&col);
+}
+
+static int
+casecmp(const void* s1, size_t len1, const void* s2, size_t len2)
+{
+    const char* a = (const char*) s1;
+    const char* b = (const char*) s2;
+    size_t i;
+    int ca, cb;
+
+    for(i = 0; i < len1  &&  i < len2; i++) {
+        ca = (a[i] >= 'A' && a[i] <= 'Z') ? a[i] - 'A' + 'a' : a[i];
+        cb = (b[i] >= 'A' && b[i] <= 'Z') ? b[i] - 'A' + 'a' : b[i];
+        if(ca != cb)
+            return ca - cb;
+    }
+    return (len1 < len2) ? -1 : (len1 > len2) ? +1 : 0;
+}
+
+static void
+test_sort_strings_custom_cmp(void)
+{
+    static const char* strs[] = { "b", "A", "B", "a", "c", "C" };
+    static const size_t expected[] = { 1, 3, 0, 2, 4, 5 };
+    COLUMN col;
+    size_t rows[6];
+    size_t i;
+
+    column_init(&col, COLUMN_STRING);
+    TEST_CHECK(column_insert(&col, 0, 6) == 0);
+    for(i = 0; i < 6; i++) {
+        TEST_CHECK(column_set_string(&col, i, strs[i], 1) == 0);
+        rows[i] = i;
+    }
+
+    /* Case-insensitively equal strings keep their order. */
+    TEST_CHECK(column_sort(&col, rows, 6, 0, casecmp) == 0);
+    for(i = 0; i < 6; i++) {
+        if(!TEST_CHECK(rows[i] == expected[i]))
+            TEST_MSG("position %u: got row %u", (unsigned) i, (unsigned) rows[i]);
+    }
+
+    column_fini(&col);
+}
+
+static void
+test_sort_random(void)
+{
+    static const COLUMN_TYPE types[] = { COLUMN_INT64, COLUMN_DOUBLE, COLUMN_STRING };
+    static const unsigned all_flags[] = { 0, COLUMN_SORT_DESC, COLUMN_SORT_NULLSFIRST,
+                                          COLUMN_SORT_DESC | COLUMN_SORT_NULLSFIRST };
+    COLUMN col;
+    size_t rows[1000];
+    char buf[16];
+    unsigned seed = 1234;
+    size_t t, f, i, n;
+    unsigned r;
+
+    for(t = 0; t < sizeof(types) / sizeof(types[0]); t++) {
+        for(f = 0; f < sizeof(all_flags) / sizeof(all_flags[0]); f++) {
+            n = 1 + rnd(&seed) % 1000;
+            column_init(&col, types[t]);
+            TEST_ASSERT(column_insert(&col, 0, n) == 0);
+
+            for(i = 0; i < n; i++) {
+                r = rnd(&seed);
+                if(r % 7 == 0)
+                    continue;   /* leave NULL */
+
+                switch(types[t]) {
+                    case COLUMN_INT64:
+                        /* Small range to get many duplicates; both signs. */
+                        column_set_int64(&col, i, (int64_t)(r % 50) - 25);
+                        if(r % 97 == 0)
+                            column_set_int64(&col, i, (r & 1) ? INT64_MAX : INT64_MIN);
+                        break;
+                    case COLUMN_DOUBLE:
+                        column_set_double(&col, i, ((double)(r % 200) - 100.0) / 8.0);
+                        break;
+                    case COLUMN_STRING:
+                        sprintf(buf, "%u", r % 60);
+                        TEST_CHECK(column_set_string(&col, i, buf, strlen(buf)) == 0);
+                        break;
+                }
+            }
+
+            for(i = 0; i < n; i++)
+                rows[i] = i;
+            TEST_CHECK(column_sort(&col, rows, n, all_flags[f], NULL) == 0);
+            if(!TEST_CHECK(is_sorted_stable(&col, rows, n, all_flags[f])))
+                TEST_MSG("type %u, flags %u, n %u", (unsigned) t, all_flags[f], (unsigned) n);
+
+            column_fini(&col);
+        }
+    }
+}
+
+static void
+test_sort_subset(void)
+{
+    COLUMN col;
+    size_t rows[] = { 9, 1, 7, 3, 5 };
+    size_t i;
+
+    column_init(&col, COLUMN_DOUBLE);
+    TEST_CHECK(column_insert(&col, 0, 10) == 0);
+    for(i = 0; i < 10; i++)
+        column_set_double(&col, i, -(double) i);
+
+    TEST_CHECK(column_sort(&col, rows, 5, 0, NULL) == 0);
+    TEST_CHECK(rows[0] == 9);
+    TEST_CHECK(rows[1] == 7);
+    TEST_CHECK(rows[2] == 5);
+    TEST_CHECK(rows[3] == 3);
+    TEST_CHECK(rows[4] == 1);
+
+    column_fini(&col);
+}
+
+static void
+test_sort_double_special(void)
+{
+    /* As given to the column, and as expected after the sort. */
+    static const int input[] = { 4, 0, 6, 2, 5, 1, 3 };
+    double values[7];
+    COLUMN col;
+    size_t rows[7];
+    size_t i;
+
+    values[0] = -NAN;
+    values[1] = -INFINITY;
+    values[2] = -1.0;
+    values[3] = -0.0;
+    values[4] = 0.0;
+    values[5] = INFINITY;
+    values[6] = NAN;
+
+    column_init(&col, COLUMN_DOUBLE);
+    TEST_CHECK(column_insert(&col, 0, 7) == 0);
+    for(i = 0; i < 7; i++) {
+        column_set_double(&col, i, values[input[i]]);
+        rows[i] = i;
+    }
+
+    TEST_CHECK(column_sort(&col, rows, 7, 0, NULL) == 0);
+    for(i = 0; i < 7; i++) {
+        TEST_CHECK_(input[rows[i]] == (int) i, "position %u", (unsigned) i);
+        if(i > 0) {
+            TEST_CHECK(column_double_key(column_get_double(&col, rows[i-1])) <
+                       column_double_key(column_get_double(&col, rows[i])));
+        }
+    }
+
+    column_fini(&col);
+}
+
+static void
+test_minmax_double_special(void)
+{
+    double values[4];
+    COLUMN col;
+    size_t row;
+    int order;
+    int i;
+
+    values[0] = 0.0;
+    values[1] = -0.0;
+    values[2] = NAN;
+    values[3] = 1.0;
+
+    /* The result must not depend on the row order. */
+    for(order = 0; order < 2; order++) {
+        column_init(&col, COLUMN_DOUBLE);
+        TEST_CHECK(column_insert(&col, 0, 5) == 0);
+        for(i = 0; i < 4; i++)
+            column_set_double(&col, (order == 0 ? i : 4 - i), values[i]);
+        /* The row (0 or 4) left is NULL. */
+
+        TEST_CHECK(column_min(&col, NULL, &row) == 0);
+        TEST_CHECK_(row == (size_t)(order == 0 ? 1 : 3), "order %d", order);
+        TEST_CHECK(signbit(column_get_double(&col, row)));
+        TEST_CHECK(column_max(&col, NULL, &row) == 0);
+        TEST_CHECK_(row == 2, "order %d", order);
+        TEST_CHECK(isnan(column_get_double(&col, row)));
+
+        /* Without the NaN, the maximum is the ordinary one. */
+        column_set_null(&col, 2);
+        TEST_CHECK(column_max(&col, NULL, &row) == 0);
+        TEST_CHECK(column_get_double(&col, row) == 1.0);
+
+        column_fini(&col);
+    }
+
+    /* NaN with the sign bit set goes before everything else. */
+    column_init(&col, COLUMN_DOUBLE);
+    TEST_CHECK(column_insert(&col, 0, 3) == 0);
+    column_set_double(&col, 0, -INFINITY);
+    column_set_double(&col, 1, -NAN);
+    column_set_double(&col, 2, -0.0);
+    TEST_CHECK(column_min(&col, NULL, &row) == 0);
+    TEST_CHECK(row == 1);
+    TEST_CHECK(column_max(&col, NULL, &row) == 0);
+    TEST_CHECK(row == 2);
+    column_fini(&col);
+}
+
+
+TEST_LIST = {
+    { "init",                   test_init },
+    { "int64",                  test_int64 },
+    { "string",                 test_string },
+    { "string-reuse",           test_string_reuse },
+    { "sort-strings-custom-cmp", test_sort_strings_custom_cmp },
+    { "sort-random",            test_sort_random },
+    { "sort-subset",            test_sort_subset },
+    { "sort-double-special",    test_sort_double_special },
+    { "minmax-double-special",  test_minmax_double_special },
+    { 0 }
+};
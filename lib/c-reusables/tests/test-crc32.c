@@ -27,6 +27,11 @@
 #include "crc32.h"
 
 
+/* Only in CRE_TEST builds. */
+uint32_t crc32_update_sw(uint32_t crc, const void* data, size_t n);
+int crc32_has_hw(void);
+
+
 typedef struct TEST_VECTOR {
     const char* str;
     size_t n;
@@ -41,6 +46,9 @@ typedef struct TEST_VECTOR {
  */
 static const TEST_VECTOR test_vectrors[] = {
     { TEST("123456789"), 0xcbf43926U },
+    { TEST(""), 0x00000000U },
+    { TEST("a"), 0xe8b7be43U },
+    { TEST("The quick brown fox jumps over the lazy dog"), 0x414fa339U },
     { 0 }
 };
 
@@ -64,8 +72,172 @@ test_crc32(void)
     }
 }
 
+/* Naive bit-by-bit reference implementation. */
+static uint32_t
+crc32_reference(const uint8_t* data, size_t n)
+{
+    uint32_t crcreg = 0xffffffffU;
+    size_t i;
+    int k;
+
+    for(i = 0; i < n; i++) {
+        crcreg ^= data[i];
+        for(k = 0; k < 8; k++)
+            crcreg = (crcreg & 1) ? ((crcreg >> 1) ^ 0xedb88320U) : (crcreg >> 1);
+    }
+
+    return crcreg ^ 0xffffffffU;
+}
+
+#define DATA_SIZE       (64 * 1024)
+
+static uint8_t*
+make_data(void)
+{
+    uint8_t* data;
+    uint32_t seed = 12345;
+    size_t i;
+
+    data = (uint8_t*) malloc(DATA_SIZE);
+    if(!TEST_CHECK(data != NULL))
+        return NULL;
+    for(i = 0; i < DATA_SIZE; i++) {
+        seed = seed * 1103515245U + 12345U;
+        data[i] = (uint8_t) (seed >> 16);
+    }
+    return data;
+}
+
+static void
+test_implementations(void)
+{
+    static const size_t sizes[] = { 1000, 1024, 4095, 4096, 4097, DATA_SIZE - 16 };
+    uint8_t* data;
+    size_t off, n, i;
+
+    data = make_data();
+    if(data == NULL)
+        return;
+
+    TEST_MSG("Hardware acceleration: %s", crc32_has_hw() ? "yes" : "no");
+
+    /* All the short sizes (around the thresholds of the respective code
+     * paths) with all alignments. */
+    for(off = 0; off < 16; off++) {
+        for(n = 0; n <= 300; n++) {
+            uint32_t expected = crc32_reference(data + off, n);
+
+            if(!TEST_CHECK_(crc32(data + off, n) == expected, "crc32() [off %u, n %u]", (unsigned) off, (unsigned) n))
+                break;
+            if(!TEST_CHECK_(crc32_update_sw(0, data + off, n) == expected, "crc32_update_sw() [off %u, n %u]", (unsigned) off, (unsigned) n))
+                break;
+        }
+    }
+
+    for(i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        uint32_t expected = crc32_reference(data + 3, sizes[i]);
+
+        TEST_CHECK_(crc32(data + 3, sizes[i]) == expected, "crc32() [n %u]", (unsigned) sizes[i]);
+        TEST_CHECK_(crc32_update_sw(0, data + 3, sizes[i]) == expected, "crc32_update_sw() [n %u]", (unsigned) sizes[i]);
+    }
+
+    free(data);
+}
+
+static void
+test_update(void)
+{
+    static const size_t splits[] = { 0, 1, 7, 63, 64, 65, 1000, 4096, DATA_SIZE };
+    uint8_t* data;
+    uint32_t expected, crc;
+    size_t i, pos, chunk;
+
+    data = make_data();
+    if(data == NULL)
+        return;
+
+    expected = crc32(data, DATA_SIZE);
+
+    for(i = 0; i < sizeof(splits) / sizeof(splits[0]); i++) {
+        crc = crc32_update(0, data, splits[i]);
+        crc = crc32_update(crc, data + splits[i], DATA_SIZE - splits[i]);
+        TEST_CHECK_(crc == expected, "split at %u", (unsigned) splits[i]);
+    }
+
+    /* Many small irregular chunks. */
+    crc = 0;
+    pos = 0;
+    chunk = 1;
+    while(pos < DATA_SIZE) {
+        if(chunk > DATA_SIZE - pos)
+            chunk = DATA_SIZE - pos;
+        crc = crc32_update(crc, data + pos, chunk);
+        pos += chunk;
+        chunk = (chunk * 7 + 3) % 301;
+    }
+    TEST_CHECK(crc == expected);
+
+    free(data);
+}
+
+static void
+test_combine(void)
+{
+    static const size_t splits[] = { 0, 1, 7, 63, 64, 65, 1000, 4096, DATA_SIZE };
+    uint8_t* data;
+    uint32_t expected, crc, crc1, crc2;
+    size_t i, n;
+
+    data = make_data();
+    if(data == NULL)
+        return;
+
+    expected = crc32(data, DATA_SIZE);
+
+    for(i = 0; i < sizeof(splits) / sizeof(splits[0]); i++) {
+        n = splits[i];
+        crc1 = crc32(data, n);
+        crc2 = crc32(data + n, DATA_SIZE - n);
+        crc = crc32_combine(crc1, crc2, DATA_SIZE - n);
+        TEST_CHECK_(crc == expected, "split at %u", (unsigned) n);
+    }
+
+    /* Merge 16 chunks as if computed by parallel workers. */
+    crc = 0;
+    for(i = 0; i < 16; i++) {
+        n = DATA_SIZE / 16;
+        crc = crc32_combine(crc, crc32(data + i * n, n), n);
+    }
+    TEST_CHECK(crc == expected);
+
+    /* Lengths not fitting into 32 bits. Build CRC-32 of 2^31 zero bytes by
+     * doubling, and check that appending it twice is the same as appending
+     * the 2^32 zero bytes at once. */
+    {
+        static const uint8_t zeros[4096] = { 0 };
+        uint64_t half = (uint64_t) 1 << 31;
+        uint64_t len;
+        uint32_t crc_half, crc_full;
+
+        crc_half = crc32(zeros, sizeof(zeros));
+        for(len = sizeof(zeros); len < half; len *= 2)
+            crc_half = crc32_combine(crc_half, crc_half, len);
+        crc_full = crc32_combine(crc_half, crc_half, half);
+
+        crc1 = crc32_combine(crc32_combine(expected, crc_half, half), crc_half, half);
+        crc2 = crc32_combine(expected, crc_full, 2 * half);
+        TEST_CHECK(crc1 == crc2);
+        TEST_CHECK(crc1 != expected);
+    }
+
+    free(data);
+}
+
 
 TEST_LIST = {
-    { "crc32",      test_crc32 },
+    { "crc32",                  test_crc32 },
+    { "crc32-implementations",  test_implementations },
+    { "crc32-update",           test_update },
+    { "crc32-combine",          test_combine },
     { 0 }
 };
@@ -0,0 +1,262 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2018 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "acutest.h"
+#include "fenwick.h"
+
+
+/* Simple deterministic PRNG so failures are reproducible. */
+static unsigned
+rnd(unsigned* state)
+{
+    *state = *state * 1103515245U + 12345U;
+    return (*state >> 16) & 0x7fff;
+}
+
+static int64_t
+naive_prefix_sum(const int64_t* vals, size_t i)
+{
+    int64_t sum = 0;
+    size_t j;
+
+    for(j = 0; j < i; j++)
+        sum += vals[j];
+    return sum;
+}
+
+static size_t
+naive_find(const int64_t* vals, size_t n, int64_t pos)
+{
+    size_t i;
+
+    if(pos < 0)
+        return 0;
+    for(i = n; i > 0; i--) {
+        if(naive_prefix_sum(vals, i) <= pos)
+            return i;
+    }
+    return 0;
+}
+
+static void
+check_all(const FENWICK* fw, const int64_t* vals, size_t n)
+{
+    size_t i;
+
+    TEST_CHECK(fenwick_count(fw) == n);
+    for(i = 0; i < n; i++) {
+        if(!TEST_CHECK(fenwick_get(fw, i) == vals[i]))
+            TEST_MSG("element %u", (unsigned) i);
+    }
+    for(i = 0; i <= n; i++) {
+        if(!TEST_CHECK(fenwick_prefix_sum(fw, i) == naive_prefix_sum(vals, i)))
+            TEST_MSG("prefix %u", (unsigned) i);
+    }
+}
+
+
+static void
+test_init(void)
+{
+    FENWICK fw = FENWICK_INITIALIZER;
+
+    TEST_CHECK(fenwick_count(&fw) == 0);
+    TEST_CHECK(fenwick_total(&fw) == 0);
+    TEST_CHECK(fenwick_find(&fw, 0) == 0);
+    TEST_CHECK(fenwick_find(&fw, 100) == 0);
+
+    fenwick_fini(&fw);
+}
+
+static void
+test_build(void)
+{
+    FENWICK fw;
+    int64_t vals[100];
+    int64_t* p;
+    size_t n, i;
+
+    fenwick_init(&fw);
+    for(n = 0; n <= 100; n += 7) {
+        p = fenwick_build_begin(&fw, n);
+        TEST_ASSERT(p != NULL  ||  n == 0);
+        for(i = 0; i < n; i++)
+            vals[i] = p[i] = (int64_t) (i * 3 + 1);
+        fenwick_build_end(&fw);
+        check_all(&fw, vals, n);
+    }
+    fenwick_fini(&fw);
+}
+
+static void
+test_resize(void)
+{
+    FENWICK fw;
+    int64_t vals[200];
+    size_t n, i;
+    unsigned seed = 1;
+
+    fenwick_init(&fw);
+
+    /* Grow one by one, set each new element. */
+    for(n = 1; n <= 100; n++) {
+        TEST_ASSERT(fenwick_resize(&fw, n) == 0);
+        TEST_CHECK(fenwick_get(&fw, n-1) == 0);
+        vals[n-1] = rnd(&seed) % 50;
+        fenwick_set(&fw, n-1, vals[n-1]);
+    }
+    check_all(&fw, vals, 100);
+
+    /* Shrink and grow again by a bulk: new elements must be zero. */
+    TEST_ASSERT(fenwick_resize(&fw, 37) == 0);
+    check_all(&fw, vals, 37);
+    TEST_ASSERT(fenwick_resize(&fw, 200) == 0);
+    for(i = 37; i < 200; i++)
+        vals[i] = 0;
+    check_all(&fw, vals, 200);
+
+    fenwick_fini(&fw);
+}
+
+static void
+test_random(void)
+{
+    FENWICK fw;
+    int64_t vals[500];
+    int64_t* p;
+    size_t i, i0, i1, k;
+    size_t n = 500;
+    unsigned seed = 12345;
+
+    fenwick_init(&fw);
+    p = fenwick_build_begin(&fw, n);
+    TEST_ASSERT(p != NULL);
+    for(i = 0; i < n; i++)
+        vals[i] = p[i] = rnd(&seed) % 100;
+    fenwick_build_end(&fw);
+
+    for(k = 0; k < 5000; k++) {
+        i = rnd(&seed) % n;
+        if(rnd(&seed) % 2) {
+            int64_t delta = (int64_t) (rnd(&seed) % 21) - 10;
+            vals[i] += delta;
+            fenwick_add(&fw, i, delta);
+        } else {
+            vals[i] = rnd(&seed) % 100;
+            fenwick_set(&fw, i, vals[i]);
+        }
+
+        i0 = rnd(&seed) % (n+1);
+        i1 = rnd(&seed) % (n+1);
+        if(i0 > i1) {
+            size_t tmp = i0;
+            i0 = i1;
+            i1 = tmp;
+        }
+        if(!TEST_CHECK(fenwick_range_sum(&fw, i0, i1) ==
+                    naive_prefix_sum(vals, i1) - naive_prefix_sum(vals, i0)))
+            TEST_MSG("range [%u, %u)", (unsigned) i0, (unsigned) i1);
+    }
+    check_all(&fw, vals, n);
+
+    fenwick_fini(&fw);
+}
+
+static void
+test_find(void)
+{
+    /* Sizes of intervals, including empty ones (like hidden grid columns). */
+    static const int64_t sizes[] = { 10, 0, 0, 5, 20, 0, 1, 0 };
+    const size_t n = sizeof(sizes) / sizeof(sizes[0]);
+    FENWICK fw;
+    int64_t* p;
+    int64_t pos;
+    size_t i;
+
+    fenwick_init(&fw);
+    p = fenwick_build_begin(&fw, n);
+    TEST_ASSERT(p != NULL);
+    for(i = 0; i < n; i++)
+        p[i] = sizes[i];
+    fenwick_build_end(&fw);
+
+    TEST_CHECK(fenwick_total(&fw) == 36);
+    TEST_CHECK(fenwick_find(&fw, -1) == 0);
+    TEST_CHECK(fenwick_find(&fw, 0) == 0);
+    TEST_CHECK(fenwick_find(&fw, 9) == 0);
+    TEST_CHECK(fenwick_find(&fw, 10) == 3);     /* empty 1 and 2 are skipped */
+    TEST_CHECK(fenwick_find(&fw, 14) == 3);
+    TEST_CHECK(fenwick_find(&fw, 15) == 4);
+    TEST_CHECK(fenwick_find(&fw, 34) == 4);
+    TEST_CHECK(fenwick_find(&fw, 35) == 6);
+    TEST_CHECK(fenwick_find(&fw, 36) == n);     /* beyond the end */
+    TEST_CHECK(fenwick_find(&fw, 1000) == n);
+
+    for(pos = -2; pos < 40; pos++) {
+        if(!TEST_CHECK(fenwick_find(&fw, pos) == naive_find(sizes, n, pos)))
+            TEST_MSG("pos %d", (int) pos);
+    }
+
+    fenwick_fini(&fw);
+}
+
+static void
+test_find_random(void)
+{
+    FENWICK fw;
+    int64_t vals[333];
+    int64_t* p;
+    int64_t total, pos;
+    size_t i, k;
+    size_t n = 333;
+    unsigned seed = 777;
+
+    fenwick_init(&fw);
+    p = fenwick_build_begin(&fw, n);
+    TEST_ASSERT(p != NULL);
+    for(i = 0; i < n; i++)
+        vals[i] = p[i] = (rnd(&seed) % 4 == 0) ? 0 : rnd(&seed) % 30;
+    fenwick_build_end(&fw);
+    total = fenwick_total(&fw);
+
+    for(k = 0; k < 2000; k++) {
+        pos = (int64_t) (rnd(&seed) % (total + 10)) - 5;
+        if(!TEST_CHECK(fenwick_find(&fw, pos) == naive_find(vals, n, pos)))
+            TEST_MSG("pos %d", (int) pos);
+    }
+
+    fenwick_fini(&fw);
+}
+
+
+TEST_LIST = {
+    { "init",            test_init },
+    { "build",           test_build },
+    { "resize",          test_resize },
+    { "random",          test_random },
+    { "find",            test_find },
+    { "find-random",     test_find_random },
+    { 0 }
+};
@@ -56,8 +56,160 @@ test_hex_decode(void)
     TEST_CHECK(memcmp(buffer, expect, sizeof(expect)) == 0);
 }
 
+/* Test-only hook from hex.c. */
+extern int hex_test_disable_simd;
+
+static unsigned test_rand_state = 1;
+
+static unsigned
+test_rand(void)
+{
+    test_rand_state = test_rand_state * 1103515245 + 12345;
+    return (test_rand_state >> 16) & 0x7fff;
+}
+
+static void
+test_hex_simd(void)
+{
+    static unsigned char blob[1024 + 16];
+    static char hex_simd[2 * sizeof(blob) + 1];
+    static char hex_plain[2 * sizeof(blob) + 1];
+    static unsigned char out[sizeof(blob)];
+    unsigned size, align, i;
+    int lowercase;
+
+    for(i = 0; i < sizeof(blob); i++)
+        blob[i] = (unsigned char) test_rand();
+
+    for(size = 0; size <= 1024; size += (size < 100 ? 1 : 61)) {
+        for(align = 0; align < 4; align++) {
+            for(lowercase = 0; lowercase <= 1; lowercase++) {
+                hex_test_disable_simd = 1;
+                TEST_CHECK(hex_encode(blob + align, size, hex_plain, sizeof(hex_plain), lowercase) == 2 * size);
+                hex_test_disable_simd = 0;
+                TEST_CHECK(hex_encode(blob + align, size, hex_simd + align, sizeof(hex_simd) - align, lowercase) == 2 * size);
+                if(!TEST_CHECK(memcmp(hex_simd + align, hex_plain, 2 * size) == 0)) {
+                    TEST_MSG("Size: %u, alignment: %u", size, align);
+                    return;
+                }
+
+                TEST_CHECK(hex_decode(hex_simd + align, 2 * size, out, size) == size);
+                if(!TEST_CHECK(memcmp(out, blob + align, size) == 0)) {
+                    TEST_MSG("Size: %u, alignment: %u", size, align);
+                    return;
+                }
+            }
+        }
+    }
+}
+
+static void
+test_hex_invalid(void)
+{
+    static const char bad[] = { 'g', 'G', 'z', ' ', '/', ':', '@', '`', '\0', '\x80', '\xb0' };
+    char hex[130];
+    char tmp[130];
+    unsigned char out[65];
+    int i, simd;
+
+    TEST_CHECK(hex_decode("abc", 3, out, sizeof(out)) == -1);
+    TEST_CHECK(hex_decode("abcd", 4, out, 1) == -1);
+
+    for(i = 0; i < 128; i++)
+        hex[i] = "0123456789abcdefABCDEF"[test_rand() % 22];
+
+    /* Put a bad character at every position so the SIMD code sees it in
+     * every lane. */
+    for(simd = 0; simd <= 1; simd++) {
+        hex_test_disable_simd = !simd;
+        TEST_CHECK(hex_decode(hex, 128, out, sizeof(out)) == 64);
+        for(i = 0; i < 128; i++) {
+            memcpy(tmp, hex, 128);
+            tmp[i] = bad[i % sizeof(bad)];
+            if(!TEST_CHECK(hex_decode(tmp, 128, out, sizeof(out)) == -1)) {
+                TEST_MSG("SIMD: %d, position: %d", simd, i);
+                break;
+            }
+        }
+    }
+    hex_test_disable_simd = 0;
+}
+
+static void
+test_hex_streaming(void)
+{
+    static const char hex[] = "000102030405060708090a0B0c0D0e0fFf"
+                              "00112233445566778899aabbccddeeff00112233445566778899aabbccddeeff";
+    unsigned char expect[sizeof(hex) / 2];
+    unsigned char out[sizeof(hex) / 2];
+    HEX_DECODER dec;
+    unsigned in_off, out_off, chunk;
+    int iter, n;
+
+    TEST_CHECK(hex_decode(hex, sizeof(hex) - 1, expect, sizeof(expect)) == (sizeof(hex) - 1) / 2);
+
+    for(iter = 0; iter < 100; iter++) {
+        hex_decoder_init(&dec);
+        in_off = 0;
+        out_off = 0;
+        while(in_off < sizeof(hex) - 1) {
+            chunk = test_rand() % 40;
+            if(chunk > sizeof(hex) - 1 - in_off)
+                chunk = sizeof(hex) - 1 - in_off;
+            n = hex_decoder_update(&dec, hex + in_off, chunk, out + out_off, sizeof(out) - out_off);
+            if(!TEST_CHECK(n >= 0))
+                return;
+            in_off += chunk;
+            out_off += n;
+        }
+        TEST_CHECK(hex_decoder_finish(&dec) == 0);
+        if(!TEST_CHECK(out_off == (sizeof(hex) - 1) / 2  &&  memcmp(out, expect, out_off) == 0))
+            return;
+    }
+
+    /* Unpaired digit at the end. */
+    hex_decoder_init(&dec);
+    TEST_CHECK(hex_decoder_update(&dec, "abc", 3, out, sizeof(out)) == 1);
+    TEST_CHECK(hex_decoder_finish(&dec) == -1);
+
+    /* Invalid digit split across chunks. */
+    hex_decoder_init(&dec);
+    TEST_CHECK(hex_decoder_update(&dec, "a", 1, out, sizeof(out)) == 0);
+    TEST_CHECK(hex_decoder_update(&dec, "x", 1, out, sizeof(out)) == -1);
+}
+
+static void
+test_hex_dump(void)
+{
+    char blob[] = "0123456789\x0a\x0b\x7f\x80 ~";
+    char line[HEX_DUMP_LINE_SIZE];
+
+    TEST_CHECK(hex_dump_line(blob, 16, 0x10, line, sizeof(line)) == 8 + 2 + 50 + 18);
+    TEST_CHECK(strcmp(line, "00000010  30 31 32 33 34 35 36 37  38 39 0a 0b 7f 80 20 7e  |0123456789.... ~|") == 0);
+    TEST_MSG("Produced: '%s'", line);
+
+    TEST_CHECK(hex_dump_line(blob, 12, 0x20, line, sizeof(line)) == 8 + 2 + 50 + 14);
+    TEST_CHECK(strcmp(line, "00000020  30 31 32 33 34 35 36 37  38 39 0a 0b              |0123456789..|") == 0);
+    TEST_MSG("Produced: '%s'", line);
+
+    TEST_CHECK(hex_dump_line(blob, 0, 0, line, sizeof(line)) == 8 + 2 + 50 + 2);
+
+    if(sizeof(size_t) > 4) {
+        TEST_CHECK(hex_dump_line(blob, 1, (size_t) 0x123456789ULL, line, sizeof(line)) == 16 + 2 + 50 + 3);
+        TEST_CHECK(strncmp(line, "0000000123456789  30 ", 21) == 0);
+    }
+
+    /* Too small buffer, too much data. */
+    TEST_CHECK(hex_dump_line(blob, 16, 0, line, 8 + 2 + 50 + 18) == -1);
+    TEST_CHECK(hex_dump_line(blob, 17, 0, line, sizeof(line)) == -1);
+}
+
 TEST_LIST = {
     { "hex-encode", test_hex_encode },
     { "hex-decode", test_hex_decode },
+    { "hex-simd", test_hex_simd },
+    { "hex-invalid", test_hex_invalid },
+    { "hex-streaming", test_hex_streaming },
+    { "hex-dump", test_hex_dump },
     { 0 }
 };
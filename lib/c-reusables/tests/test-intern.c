@@ -0,0 +1,177 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2020 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "acutest.h"
+#include "intern.h"
+
+#include <string.h>
+
+
+/* Simple deterministic PRNG so failures are reproducible. */
+static unsigned
+rnd(unsigned* state)
+{
+    *state = *state * 1103515245U + 12345U;
+    return (*state >> 16) & 0x7fff;
+}
+
+
+static void
+test_basic(void)
+{
+    INTERN pool = INTERN_INITIALIZER;
+    const char* a;
+    const char* b;
+    const char* c;
+    char buf[8];
+
+    a = (const char*) intern_acquire(&pool, "OK", 2);
+    TEST_CHECK(a != NULL);
+    TEST_CHECK(strcmp(a, "OK") == 0);     /* zero-terminated */
+    TEST_CHECK(intern_length(a) == 2);
+
+    strcpy(buf, "OK");
+    b = (const char*) intern_acquire(&pool, buf, 2);
+    TEST_CHECK(b == a);
+    TEST_CHECK(b != buf);
+
+    c = (const char*) intern_acquire(&pool, "FAILED", 6);
+    TEST_CHECK(c != a);
+    TEST_CHECK(intern_size(&pool) == 2);
+
+    intern_release(&pool, a);
+    TEST_CHECK(intern_size(&pool) == 2);
+    intern_release(&pool, b);
+    TEST_CHECK(intern_size(&pool) == 1);
+    intern_release(&pool, c);
+    TEST_CHECK(intern_size(&pool) == 0);
+
+    /* Empty and binary strings. */
+    a = (const char*) intern_acquire(&pool, "", 0);
+    TEST_CHECK(a != NULL  &&  a[0] == '\0');
+    b = (const char*) intern_acquire(&pool, "x\0y", 3);
+    c = (const char*) intern_acquire(&pool, "x\0z", 3);
+    TEST_CHECK(b != c);
+    TEST_CHECK(intern_length(b) == 3);
+
+    intern_fini(&pool);
+}
+
+static void
+test_stats(void)
+{
+    INTERN pool;
+    INTERN_STATS stats;
+    const void* p[4];
+
+    intern_init(&pool);
+    p[0] = intern_acquire(&pool, "hostname", 8);
+    p[1] = intern_acquire(&pool, "hostname", 8);
+    p[2] = intern_acquire(&pool, "hostname", 8);
+    p[3] = intern_acquire(&pool, "ms", 2);
+
+    intern_stats(&pool, &stats);
+    TEST_CHECK(stats.strings == 2);
+    TEST_CHECK(stats.lookups == 4);
+    TEST_CHECK(stats.hits == 2);
+    TEST_CHECK(stats.bytes == 10);
+    TEST_CHECK(stats.bytes_saved == 16);
+
+    intern_addref(&pool, p[3]);
+    intern_release(&pool, p[0]);
+    intern_stats(&pool, &stats);
+    TEST_CHECK(stats.bytes_saved == 10);
+
+    intern_release(&pool, p[1]);
+    intern_release(&pool, p[2]);
+    intern_stats(&pool, &stats);
+    TEST_CHECK(stats.strings == 1);
+    TEST_CHECK(stats.bytes == 2);
+    TEST_CHECK(stats.bytes_saved == 2);
+
+    intern_release(&pool, p[3]);
+    intern_release(&pool, p[3]);
+    intern_stats(&pool, &stats);
+    TEST_CHECK(stats.strings == 0);
+    TEST_CHECK(stats.bytes == 0);
+    TEST_CHECK(stats.bytes_saved == 0);
+
+    intern_fini(&pool);
+}
+
+static void
+test_random(void)
+{
+    INTERN pool;
+    const char* held[512];
+    char buf[32];
+    unsigned seed = 4321;
+    size_t i, k, n_held = 0;
+
+    intern_init(&pool);
+    memset(held, 0, sizeof(held));
+
+    for(k = 0; k < 50000; k++) {
+        i = rnd(&seed) % 512;
+        if(held[i] != NULL) {
+            intern_release(&pool, held[i]);
+            held[i] = NULL;
+            n_held--;
+        } else {
+            sprintf(buf, "value-%u", rnd(&seed) % 300);
+            held[i] = (const char*) intern_acquire(&pool, buf, strlen(buf));
+            TEST_ASSERT(held[i] != NULL);
+            if(!TEST_CHECK(strcmp(held[i], buf) == 0))
+                TEST_MSG("round %u", (unsigned) k);
+            n_held++;
+        }
+    }
+
+    /* Equal strings are equal pointers. */
+    for(i = 0; i < 512; i++) {
+        for(k = i + 1; k < 512; k++) {
+            if(held[i] != NULL  &&  held[k] != NULL)
+                TEST_CHECK((held[i] == held[k]) == (strcmp(held[i], held[k]) == 0));
+        }
+    }
+
+    TEST_CHECK(intern_size(&pool) <= 300);
+    TEST_CHECK(intern_size(&pool) <= n_held);
+    for(i = 0; i < 512; i++) {
+        if(held[i] != NULL)
+            intern_release(&pool, held[i]);
+    }
+    TEST_CHECK(intern_size(&pool) == 0);
+
+    intern_fini(&pool);
+}
+
+
+TEST_LIST = {
+    { "basic",      test_basic },
+    { "stats",      test_stats },
+    { "random",     test_random },
+    { 0 }
+};
@@ -0,0 +1,299 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2020 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#include "acutest.h"
+#include "lflist.h"
+
+#ifdef _WIN32
+    #include <windows.h>
+    #define yield()     SwitchToThread()
+#else
+    #include <pthread.h>
+    #include <sched.h>
+    #define yield()     sched_yield()
+#endif
+
+
+typedef struct ITEM {
+    int value;
+    int owner;
+    LFSTACK_NODE stack_node;
+    MPSCQ_NODE queue_node;
+} ITEM;
+
+
+static void
+test_stack_basic(void)
+{
+    LFSTACK stack;
+    ITEM items[10];
+    LFSTACK_NODE* node;
+    int i;
+
+    lfstack_init(&stack);
+    TEST_CHECK(lfstack_is_empty(&stack));
+    TEST_CHECK(lfstack_pop(&stack) == NULL);
+    TEST_CHECK(lfstack_pop_all(&stack) == NULL);
+
+    for(i = 0; i < 10; i++) {
+        items[i].value = i;
+        lfstack_push(&stack, &items[i].stack_node);
+    }
+    TEST_CHECK(!lfstack_is_empty(&stack));
+
+    /* LIFO order. */
+    for(i = 9; i >= 5; i--) {
+        node = lfstack_pop(&stack);
+        TEST_CHECK(node != NULL  &&  LFSTACK_DATA(node, ITEM, stack_node)->value == i);
+    }
+
+    /* Detach the rest at once. */
+    node = lfstack_pop_all(&stack);
+    TEST_CHECK(lfstack_is_empty(&stack));
+    for(i = 4; i >= 0; i--) {
+        TEST_CHECK(node != NULL  &&  LFSTACK_DATA(node, ITEM, stack_node)->value == i);
+        node = lfstack_next(node);
+    }
+    TEST_CHECK(node == NULL);
+}
+
+static void
+test_queue_basic(void)
+{
+    MPSCQ queue;
+    ITEM items[10];
+    MPSCQ_NODE* node;
+    int i, j;
+
+    mpscq_init(&queue);
+    TEST_CHECK(mpscq_is_empty(&queue));
+    TEST_CHECK(mpscq_pop(&queue) == NULL);
+
+    /* FIFO order, also when interleaving the pushes and pops (so the stub
+     * gets re-inserted many times). */
+    for(j = 1; j <= 10; j++) {
+        for(i = 0; i < j; i++) {
+            items[i].value = i;
+            mpscq_push(&queue, &items[i].queue_node);
+        }
+        TEST_CHECK(!mpscq_is_empty(&queue));
+        for(i = 0; i < j; i++) {
+            node = mpscq_pop(&queue);
+            TEST_CHECK(node != NULL  &&  MPSCQ_DATA(node, ITEM, queue_node)->value == i);
+        }
+        TEST_CHECK(mpscq_is_empty(&queue));
+        TEST_CHECK(mpscq_pop(&queue) == NULL);
+    }
+}
+
+
+/* Stress tests. They are most useful with ThreadSanitizer, which sees any
+ * missing synchronization through the plain (non-atomic) accesses to the
+ * payload. Note the machine may have a single core, so all the spinning loops
+ * yield. */
+
+#define STRESS_THREADS      4
+#define STRESS_ITEMS        16
+#define STRESS_ROUNDS       20000
+
+#ifdef _WIN32
+    typedef HANDLE THREAD;
+    #define THREAD_FUNC     DWORD WINAPI
+#else
+    typedef pthread_t THREAD;
+    #define THREAD_FUNC     void*
+#endif
+
+static int
+thread_start(THREAD* thread, THREAD_FUNC (*func)(void*), void* param)
+{
+#ifdef _WIN32
+    *thread = CreateThread(NULL, 0, func, param, 0, NULL);
+    return (*thread != NULL) ? 0 : -1;
+#else
+    return pthread_create(thread, NULL, func, param);
+#endif
+}
+
+static void
+thread_join(THREAD thread)
+{
+#ifdef _WIN32
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+#else
+    pthread_join(thread, NULL);
+#endif
+}
+
+
+typedef struct STRESS_CTX {
+    int id;
+    int errors;
+} STRESS_CTX;
+
+static LFSTACK stress_stack;
+static MPSCQ stress_queue;
+static ITEM stress_items[STRESS_THREADS * STRESS_ROUNDS];
+
+static THREAD_FUNC
+stack_stress_worker(void* param)
+{
+    STRESS_CTX* ctx = (STRESS_CTX*) param;
+    LFSTACK_NODE* node;
+    ITEM* item;
+    int i;
+
+    for(i = 0; i < STRESS_ROUNDS; i++) {
+        node = lfstack_pop(&stress_stack);
+        if(node == NULL) {
+            yield();
+            continue;
+        }
+
+        /* We own the item now. Nobody else may touch it until we push it
+         * back. */
+        item = LFSTACK_DATA(node, ITEM, stack_node);
+        if(item->owner != 0)
+            ctx->errors++;
+        item->owner = ctx->id;
+        item->value++;
+        if(i % 64 == 0)
+            yield();
+        if(item->owner != ctx->id)
+            ctx->errors++;
+        item->owner = 0;
+
+        lfstack_push(&stress_stack, node);
+    }
+
+    return 0;
+}
+
+static void
+test_stack_stress(void)
+{
+    THREAD threads[STRESS_THREADS];
+    STRESS_CTX ctx[STRESS_THREADS];
+    LFSTACK_NODE* node;
+    int i, n, sum;
+
+    lfstack_init(&stress_stack);
+    for(i = 0; i < STRESS_ITEMS; i++) {
+        stress_items[i].value = 0;
+        stress_items[i].owner = 0;
+        lfstack_push(&stress_stack, &stress_items[i].stack_node);
+    }
+
+    for(i = 0; i < STRESS_THREADS; i++) {
+        ctx[i].id = i + 1;
+        ctx[i].errors = 0;
+        TEST_ASSERT(thread_start(&threads[i], stack_stress_worker, &ctx[i]) == 0);
+    }
+    for(i = 0; i < STRESS_THREADS; i++) {
+        thread_join(threads[i]);
+        TEST_CHECK_(ctx[i].errors == 0, "thread %d has seen no shared item", i + 1);
+    }
+
+    /* All items are back and no update has been lost. */
+    n = 0;
+    sum = 0;
+    for(node = lfstack_pop_all(&stress_stack); node != NULL; node = lfstack_next(node)) {
+        n++;
+        sum += LFSTACK_DATA(node, ITEM, stack_node)->value;
+    }
+    TEST_CHECK(n == STRESS_ITEMS);
+    TEST_CHECK(sum <= STRESS_THREADS * STRESS_ROUNDS);
+    TEST_MSG("%d pops out of %d attempts", sum, STRESS_THREADS * STRESS_ROUNDS);
+}
+
+static THREAD_FUNC
+queue_stress_producer(void* param)
+{
+    STRESS_CTX* ctx = (STRESS_CTX*) param;
+    ITEM* items = &stress_items[(ctx->id - 1) * STRESS_ROUNDS];
+    int i;
+
+    for(i = 0; i < STRESS_ROUNDS; i++) {
+        items[i].owner = ctx->id;
+        items[i].value = i;
+        mpscq_push(&stress_queue, &items[i].queue_node);
+        if(i % 64 == 0)
+            yield();
+    }
+
+    return 0;
+}
+
+static void
+test_queue_stress(void)
+{
+    THREAD threads[STRESS_THREADS];
+    STRESS_CTX ctx[STRESS_THREADS];
+    int expected[STRESS_THREADS] = { 0 };
+    MPSCQ_NODE* node;
+    ITEM* item;
+    int i, n;
+    int ok = 1;
+
+    mpscq_init(&stress_queue);
+
+    for(i = 0; i < STRESS_THREADS; i++) {
+        ctx[i].id = i + 1;
+        ctx[i].errors = 0;
+        TEST_ASSERT(thread_start(&threads[i], queue_stress_producer, &ctx[i]) == 0);
+    }
+
+    /* Each producer's items must come in the order it has pushed them. */
+    for(n = 0; ok  &&  n < STRESS_THREADS * STRESS_ROUNDS; ) {
+        node = mpscq_pop(&stress_queue);
+        if(node == NULL) {
+            yield();
+            continue;
+        }
+
+        item = MPSCQ_DATA(node, ITEM, queue_node);
+        ok = (1 <= item->owner  &&  item->owner <= STRESS_THREADS  &&
+              item->value == expected[item->owner - 1]);
+        if(ok)
+            expected[item->owner - 1]++;
+        n++;
+    }
+    TEST_CHECK_(ok, "all items received in order (got %d)", n);
+
+    for(i = 0; i < STRESS_THREADS; i++)
+        thread_join(threads[i]);
+
+    TEST_CHECK(mpscq_pop(&stress_queue) == NULL);
+    TEST_CHECK(mpscq_is_empty(&stress_queue));
+}
+
+
+TEST_LIST = {
+    { "stack-basic",    test_stack_basic },
+    { "queue-basic",    test_queue_basic },
+    { "stack-stress",   test_stack_stress },
+    { "queue-stress",   test_queue_stress },
+    { NULL, NULL }
+};
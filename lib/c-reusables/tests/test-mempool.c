@@ -0,0 +1,130 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2020 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "acutest.h"
+#include "mempool.h"
+
+#include <stdint.h>
+#include <string.h>
+
+
+static void
+test_mempool_basic(void)
+{
+    MEMPOOL pool;
+    void* p1;
+    void* p2;
+    void* p3;
+
+    mempool_init(&pool, 0);
+
+    p1 = mempool_alloc(&pool, 24);
+    p2 = mempool_alloc(&pool, 24);
+    TEST_CHECK(p1 != NULL);
+    TEST_CHECK(p2 != NULL);
+    TEST_CHECK(p1 != p2);
+    memset(p1, 0xaa, 24);
+    memset(p2, 0xbb, 24);
+
+    /* Freed memory is reused by a request of the same size class. */
+    mempool_free(&pool, p1, 24);
+    p3 = mempool_alloc(&pool, 30);
+    TEST_CHECK(p3 == p1);
+
+    /* Zero-sized allocations still provide unique pointers. */
+    p1 = mempool_alloc(&pool, 0);
+    p3 = mempool_alloc(&pool, 0);
+    TEST_CHECK(p1 != NULL  &&  p3 != NULL  &&  p1 != p3);
+    mempool_free(&pool, p1, 0);
+    mempool_free(&pool, p3, 0);
+
+    mempool_free(&pool, NULL, 24);
+    mempool_fini(&pool);
+}
+
+static void
+test_mempool_alignment(void)
+{
+    MEMPOOL pool;
+    size_t size;
+    void* ptr;
+
+    mempool_init(&pool, 1000);
+    for(size = 1; size <= 2 * MEMPOOL_MAX_SIZE; size++) {
+        ptr = mempool_alloc(&pool, size);
+        TEST_CHECK(ptr != NULL);
+        TEST_CHECK_(((uintptr_t) ptr) % MEMPOOL_GRANULARITY == 0, "size %u", (unsigned) size);
+        memset(ptr, 0xcc, size);
+        mempool_free(&pool, ptr, size);
+    }
+    mempool_fini(&pool);
+}
+
+static void
+test_mempool_churn(void)
+{
+    const int N = 10000;
+
+    MEMPOOL pool;
+    unsigned char** ptrs;
+    int i, round;
+
+    ptrs = (unsigned char**) malloc(N * sizeof(unsigned char*));
+    mempool_init(&pool, 4096);
+
+    for(round = 0; round < 4; round++) {
+        for(i = 0; i < N; i++) {
+            size_t size = 1 + (i % (2 * MEMPOOL_MAX_SIZE));
+            ptrs[i] = (unsigned char*) mempool_alloc(&pool, size);
+            TEST_CHECK(ptrs[i] != NULL);
+            memset(ptrs[i], i & 0xff, size);
+        }
+
+        /* Free every other allocation. */
+        for(i = 0; i < N; i += 2) {
+            mempool_free(&pool, ptrs[i], 1 + (i % (2 * MEMPOOL_MAX_SIZE)));
+            ptrs[i] = NULL;
+        }
+
+        /* Survivors must be intact. */
+        for(i = 1; i < N; i += 2) {
+            size_t size = 1 + (i % (2 * MEMPOOL_MAX_SIZE));
+            TEST_CHECK(ptrs[i][0] == (i & 0xff));
+            TEST_CHECK(ptrs[i][size-1] == (i & 0xff));
+            mempool_free(&pool, ptrs[i], size);
+        }
+    }
+
+    mempool_fini(&pool);
+    free(ptrs);
+}
+
+
+TEST_LIST = {
+    { "mempool-basic",      test_mempool_basic },
+    { "mempool-alignment",  test_mempool_alignment },
+    { "mempool-churn",      test_mempool_churn },
+    { 0 }
+};
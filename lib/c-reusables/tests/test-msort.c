@@ -0,0 +1,190 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2020 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "acutest.h"
+#include "msort.h"
+
+#include <string.h>
+
+
+/* Simple deterministic PRNG so failures are reproducible. */
+static unsigned
+rnd(unsigned* state)
+{
+    *state = *state * 1103515245U + 12345U;
+    return (*state >> 16) & 0x7fff;
+}
+
+/* Compare the keys the indexes refer to. */
+static int
+cmp_keys(size_t a, size_t b, void* ctx)
+{
+    const unsigned* keys = (const unsigned*) ctx;
+
+    if(keys[a] != keys[b])
+        return (keys[a] < keys[b]) ? -1 : +1;
+    return 0;
+}
+
+/* Check vec[] is a permutation of 0 ... n-1, sorted by keys and stable (i.e.
+ * equal keys in the ascending order of the indexes). */
+static int
+is_sorted_stable(const size_t* vec, size_t n, const unsigned* keys)
+{
+    unsigned char* seen;
+    size_t i;
+    int ok = 1;
+
+    seen = (unsigned char*) calloc(n + 1, 1);
+    for(i = 0; i < n; i++) {
+        if(vec[i] >= n  ||  seen[vec[i]])
+            ok = 0;
+        else
+            seen[vec[i]] = 1;
+
+        if(i > 0) {
+            if(keys[vec[i-1]] > keys[vec[i]])
+                ok = 0;
+            if(keys[vec[i-1]] == keys[vec[i]]  &&  vec[i-1] > vec[i])
+                ok = 0;
+        }
+    }
+    free(seen);
+    return ok;
+}
+
+static void
+fill(size_t* vec, unsigned* keys, size_t n, unsigned key_range, unsigned* state)
+{
+    size_t i;
+
+    for(i = 0; i < n; i++) {
+        vec[i] = i;
+        keys[i] = rnd(state) % key_range;
+    }
+}
+
+
+static void
+test_basic(void)
+{
+    unsigned keys[] = { 3, 1, 2, 1, 0, 3, 2 };
+    size_t vec[] = { 0, 1, 2, 3, 4, 5, 6 };
+    size_t expected[] = { 4, 1, 3, 2, 6, 0, 5 };
+
+    TEST_CHECK(msort(vec, 7, cmp_keys, keys) == 0);
+    TEST_CHECK(memcmp(vec, expected, sizeof(expected)) == 0);
+
+    /* Empty and single-element vectors. */
+    TEST_CHECK(msort(vec, 0, cmp_keys, keys) == 0);
+    TEST_CHECK(msort(vec, 1, cmp_keys, keys) == 0);
+    TEST_CHECK(vec[0] == 4);
+}
+
+static void
+test_stable(void)
+{
+    static const size_t sizes[] = { 2, 15, 16, 17, 100, 1000, 12345 };
+    size_t* vec;
+    unsigned* keys;
+    unsigned state = 42;
+    size_t i;
+
+    for(i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        size_t n = sizes[i];
+
+        vec = (size_t*) malloc(n * sizeof(size_t));
+        keys = (unsigned*) malloc(n * sizeof(unsigned));
+
+        /* Few distinct keys, so there are many ties. */
+        fill(vec, keys, n, 7, &state);
+        TEST_CHECK(msort(vec, n, cmp_keys, keys) == 0);
+        TEST_CHECK_(is_sorted_stable(vec, n, keys), "n=%u", (unsigned) n);
+
+        /* Sorting an already sorted vector changes nothing. */
+        TEST_CHECK(msort(vec, n, cmp_keys, keys) == 0);
+        TEST_CHECK_(is_sorted_stable(vec, n, keys), "n=%u (again)", (unsigned) n);
+
+        free(vec);
+        free(keys);
+    }
+}
+
+static void
+test_parallel(void)
+{
+    static const unsigned thread_counts[] = { 0, 1, 2, 3, 7, 100 };
+    size_t n = 100000;
+    size_t* vec;
+    size_t* ref;
+    unsigned* keys;
+    unsigned state = 7;
+    size_t i;
+
+    vec = (size_t*) malloc(n * sizeof(size_t));
+    ref = (size_t*) malloc(n * sizeof(size_t));
+    keys = (unsigned*) malloc(n * sizeof(unsigned));
+
+    fill(ref, keys, n, 1000, &state);
+    TEST_CHECK(msort(ref, n, cmp_keys, keys) == 0);
+
+    for(i = 0; i < sizeof(thread_counts) / sizeof(thread_counts[0]); i++) {
+        size_t j;
+
+        for(j = 0; j < n; j++)
+            vec[j] = j;
+        TEST_CHECK(msort_parallel(vec, n, cmp_keys, keys, thread_counts[i]) == 0);
+        TEST_CHECK_(memcmp(vec, ref, n * sizeof(size_t)) == 0,
+                    "threads=%u", thread_counts[i]);
+    }
+
+    free(vec);
+    free(ref);
+    free(keys);
+}
+
+static void
+test_bounds(void)
+{
+    unsigned keys[] = { 10, 20, 20, 30, /* the probe: */ 20, 5, 35 };
+    size_t vec[] = { 0, 1, 2, 3 };
+
+    TEST_CHECK(msort_lower_bound(vec, 4, 4, cmp_keys, keys) == 1);
+    TEST_CHECK(msort_upper_bound(vec, 4, 4, cmp_keys, keys) == 3);
+    TEST_CHECK(msort_lower_bound(vec, 4, 5, cmp_keys, keys) == 0);
+    TEST_CHECK(msort_upper_bound(vec, 4, 5, cmp_keys, keys) == 0);
+    TEST_CHECK(msort_lower_bound(vec, 4, 6, cmp_keys, keys) == 4);
+    TEST_CHECK(msort_upper_bound(vec, 4, 6, cmp_keys, keys) == 4);
+    TEST_CHECK(msort_lower_bound(vec, 0, 4, cmp_keys, keys) == 0);
+}
+
+
+TEST_LIST = {
+    { "basic",      test_basic },
+    { "stable",     test_stable },
+    { "parallel",   test_parallel },
+    { "bounds",     test_bounds },
+    { 0 }
+};
@@ -91,6 +91,97 @@ clear_tree(RBTREE* tree)
     }
 }
 
+/* Checks the tree contains exactly the values from..(to-1) with the given
+ * step, in the increasing order. */
+static void
+check_tree_range(RBTREE* tree, int from, int to, int step)
+{
+    RBTREE_CURSOR cur;
+    RBTREE_NODE* node;
+    int x = from;
+
+    TEST_CHECK(rbtree_verify(tree) == 0);
+    for(node = rbtree_head(tree, &cur); node != NULL; node = rbtree_next(&cur)) {
+        if(!TEST_CHECK(RBTREE_DATA(node, VAL, the_node)->x == x))
+            break;
+        x += step;
+    }
+    TEST_CHECK_(x >= to, "all nodes present (%d of %d)", x, to);
+}
+
+/* Payload for trees with subtree sizes (RBTREE_FLAG_SIZED). */
+typedef struct SVAL {
+    RBTREE_SIZED_NODE the_node;
+    int x;
+} SVAL;
+
+static int
+sval_cmp(const RBTREE_NODE* node1, const RBTREE_NODE* node2)
+{
+    const SVAL* val1 = RBTREE_DATA(node1, SVAL, the_node);
+    const SVAL* val2 = RBTREE_DATA(node2, SVAL, the_node);
+
+    if(val1->x < val2->x)
+        return -1;
+    if(val1->x > val2->x)
+        return +1;
+    return 0;
+}
+
+static RBTREE_NODE*
+make_sval(int x)
+{
+    SVAL* v;
+
+    v = (SVAL*) malloc(sizeof(SVAL));
+    TEST_ASSERT(v != NULL);
+    v->x = x;
+
+    return &v->the_node.base;
+}
+
+static int
+sval_x(RBTREE_NODE* node)
+{
+    return RBTREE_DATA(node, SVAL, the_node)->x;
+}
+
+static void
+clear_sized_tree(RBTREE* tree)
+{
+    RBTREE_NODE* node;
+    while(1) {
+        node = rbtree_fini_step(tree);
+        if(node == NULL)
+            break;
+        free(RBTREE_DATA(node, SVAL, the_node));
+    }
+}
+
+/* Checks the order statistics of a sized tree against its in-order walk. */
+static void
+check_order_statistics(RBTREE* tree)
+{
+    RBTREE_CURSOR cur;
+    RBTREE_CURSOR cur2;
+    RBTREE_NODE* node;
+    size_t k = 0;
+
+    TEST_CHECK(rbtree_verify(tree) == 0);
+    for(node = rbtree_head(tree, &cur); node != NULL; node = rbtree_next(&cur)) {
+        TEST_CHECK(rbtree_select(tree, k) == node);
+        TEST_CHECK(rbtree_rank(tree, node, sval_cmp) == k);
+        TEST_CHECK(rbtree_current_rank(&cur) == k);
+        TEST_CHECK(rbtree_select_ex(tree, k, &cur2) == node);
+        TEST_CHECK(rbtree_current(&cur2) == node);
+        k++;
+    }
+    TEST_CHECK(rbtree_size(tree) == k);
+    TEST_CHECK(rbtree_select(tree, k) == NULL);
+    TEST_CHECK(rbtree_select_ex(tree, k, &cur2) == NULL);
+    TEST_CHECK(rbtree_current(&cur2) == NULL);
+}
+
 
 /*****************************
  ***   The test routines   ***
@@ -372,6 +463,242 @@ test_lookup_ex(void)
     clear_tree(&tree);
 }
 
+static void
+test_build_from_sorted(void)
+{
+    static const int sizes[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 15, 16, 17, 100, 1000, 4095, 4096 };
+    RBTREE tree = RBTREE_INITIALIZER;
+    RBTREE_NODE** nodes;
+    VAL key;
+    int n, i, j;
+
+    nodes = (RBTREE_NODE**) malloc(4096 * sizeof(RBTREE_NODE*));
+    TEST_ASSERT(nodes != NULL);
+
+    for(j = 0; j < (int)(sizeof(sizes) / sizeof(sizes[0])); j++) {
+        n = sizes[j];
+        TEST_CASE_("n = %d", n);
+
+        for(i = 0; i < n; i++)
+            nodes[i] = make_val(2 * i);
+        rbtree_build_from_sorted(&tree, nodes, n);
+        check_tree_range(&tree, 0, 2 * n, 2);
+
+        /* The tree has to be fully functional. */
+        for(i = 0; i < n; i++) {
+            key.x = 2 * i;
+            TEST_CHECK(rbtree_lookup(&tree, &key.the_node, val_cmp) == nodes[i]);
+        }
+        for(i = 0; i < n; i++)
+            TEST_CHECK(rbtree_insert(&tree, make_val(2 * i + 1), val_cmp) == 0);
+        check_tree_range(&tree, 0, 2 * n, 1);
+
+        clear_tree(&tree);
+    }
+
+    free(nodes);
+}
+
+static void
+test_insert_hint(void)
+{
+    RBTREE tree = RBTREE_INITIALIZER;
+    RBTREE_CURSOR cur;
+    RBTREE_NODE* node;
+    VAL key;
+    int i;
+
+    /* Ascending sequence, appending at the tail. */
+    rbtree_tail(&tree, &cur);
+    for(i = 0; i < 1000; i++) {
+        node = make_val(i);
+        TEST_CHECK(rbtree_insert_hint(&tree, node, val_cmp, &cur) == 0);
+        TEST_CHECK(rbtree_current(&cur) == node);
+    }
+    check_tree_range(&tree, 0, 1000, 1);
+    TEST_CHECK(rbtree_next(&cur) == NULL);
+    clear_tree(&tree);
+
+    /* Descending sequence, prepending at the head. */
+    rbtree_head(&tree, &cur);
+    for(i = 999; i >= 0; i--) {
+        node = make_val(i);
+        TEST_CHECK(rbtree_insert_hint(&tree, node, val_cmp, &cur) == 0);
+        TEST_CHECK(rbtree_current(&cur) == node);
+    }
+    check_tree_range(&tree, 0, 1000, 1);
+    TEST_CHECK(rbtree_prev(&cur) == NULL);
+
+    /* Fill the gaps: The cursor must stay valid for navigation. */
+    clear_tree(&tree);
+    for(i = 0; i < 1000; i += 2)
+        TEST_CHECK(rbtree_insert(&tree, make_val(i), val_cmp) == 0);
+    rbtree_head(&tree, &cur);
+    for(i = 1; i < 1000; i += 2) {
+        node = make_val(i);
+        TEST_CHECK(rbtree_insert_hint(&tree, node, val_cmp, &cur) == 0);
+        TEST_CHECK(rbtree_current(&cur) == node);
+        TEST_CHECK(RBTREE_DATA(rbtree_prev(&cur), VAL, the_node)->x == i - 1);
+        TEST_CHECK(rbtree_next(&cur) == node);
+        node = rbtree_next(&cur);
+        TEST_CHECK(node == NULL  ||  RBTREE_DATA(node, VAL, the_node)->x == i + 1);
+    }
+    check_tree_range(&tree, 0, 1000, 1);
+
+    /* Wrong hints must still work. */
+    key.x = 500;
+    rbtree_lookup_ex(&tree, &key.the_node, val_cmp, &cur);
+    node = make_val(-1);
+    TEST_CHECK(rbtree_insert_hint(&tree, node, val_cmp, &cur) == 0);
+    TEST_CHECK(rbtree_current(&cur) == node);
+    node = make_val(1000);
+    TEST_CHECK(rbtree_insert_hint(&tree, node, val_cmp, &cur) == 0);
+    TEST_CHECK(rbtree_current(&cur) == node);
+    check_tree_range(&tree, -1, 1001, 1);
+
+    /* Duplicates are refused and the cursor points to the existing node. */
+    key.x = 42;
+    node = make_val(42);
+    TEST_CHECK(rbtree_insert_hint(&tree, node, val_cmp, &cur) == -1);
+    TEST_CHECK(rbtree_current(&cur) == rbtree_lookup(&tree, &key.the_node, val_cmp));
+    TEST_CHECK(rbtree_insert_hint(&tree, node, val_cmp, &cur) == -1);
+    destroy_val(RBTREE_DATA(node, VAL, the_node));
+
+    clear_tree(&tree);
+}
+
+static void
+test_merge(void)
+{
+    RBTREE tree = RBTREE_INITIALIZER;
+    RBTREE other = RBTREE_INITIALIZER;
+    int i;
+
+    /* Merging into an empty tree or from an empty tree. */
+    for(i = 0; i < 100; i++)
+        TEST_CHECK(rbtree_insert(&other, make_val(i), val_cmp) == 0);
+    TEST_CHECK(rbtree_merge(&tree, &other, val_cmp) == 0);
+    TEST_CHECK(rbtree_is_empty(&other));
+    check_tree_range(&tree, 0, 100, 1);
+    TEST_CHECK(rbtree_merge(&tree, &other, val_cmp) == 0);
+    check_tree_range(&tree, 0, 100, 1);
+
+    /* Interleaved values. */
+    for(i = 100; i < 1000; i += 2)
+        TEST_CHECK(rbtree_insert(&tree, make_val(i), val_cmp) == 0);
+    for(i = 101; i < 1000; i += 2)
+        TEST_CHECK(rbtree_insert(&other, make_val(i), val_cmp) == 0);
+    TEST_CHECK(rbtree_merge(&tree, &other, val_cmp) == 0);
+    TEST_CHECK(rbtree_is_empty(&other));
+    check_tree_range(&tree, 0, 1000, 1);
+
+    /* Conflicting values stay in the other tree. */
+    for(i = 900; i < 1100; i++)
+        TEST_CHECK(rbtree_insert(&other, make_val(i), val_cmp) == 0);
+    TEST_CHECK(rbtree_merge(&tree, &other, val_cmp) == -1);
+    check_tree_range(&tree, 0, 1100, 1);
+    check_tree_range(&other, 900, 1000, 1);
+
+    clear_tree(&tree);
+    clear_tree(&other);
+}
+
+static void
+test_split(void)
+{
+    static const int splits[] = { -5, 0, 1, 333, 500, 998, 999, 1000, 5000 };
+    RBTREE tree = RBTREE_INITIALIZER;
+    RBTREE right = RBTREE_INITIALIZER;
+    VAL key;
+    int i, j, s;
+
+    for(j = 0; j < (int)(sizeof(splits) / sizeof(splits[0])); j++) {
+        s = splits[j];
+        TEST_CASE_("split at %d", s);
+
+        for(i = 0; i < 1000; i++)
+            TEST_CHECK(rbtree_insert(&tree, make_val(i), val_cmp) == 0);
+
+        key.x = s;
+        rbtree_split(&tree, &key.the_node, val_cmp, &right);
+        check_tree_range(&tree, 0, (s < 0) ? 0 : (s > 1000 ? 1000 : s), 1);
+        check_tree_range(&right, (s < 0) ? 0 : s, 1000, 1);
+
+        /* Merge back. */
+        TEST_CHECK(rbtree_merge(&tree, &right, val_cmp) == 0);
+        check_tree_range(&tree, 0, 1000, 1);
+
+        clear_tree(&tree);
+    }
+}
+
+static void
+test_order_statistics(void)
+{
+    RBTREE tree = RBTREE_SIZED_INITIALIZER;
+    RBTREE other;
+    RBTREE_CURSOR cur;
+    RBTREE_NODE* nodes[500];
+    RBTREE_NODE* node;
+    SVAL key;
+    int i;
+
+    TEST_CHECK(rbtree_size(&tree) == 0);
+    TEST_CHECK(rbtree_select(&tree, 0) == NULL);
+
+    /* Pseudo-random insertions. */
+    for(i = 0; i < 1000; i++)
+        TEST_CHECK(rbtree_insert(&tree, make_sval((i * 7919) % 1000), sval_cmp) == 0);
+    check_order_statistics(&tree);
+    TEST_CHECK(sval_x(rbtree_select(&tree, 123)) == 123);
+
+    /* Rank of keys not present in the tree. */
+    node = rbtree_remove(&tree, nodes[0] = make_sval(500), sval_cmp);
+    free(RBTREE_DATA(node, SVAL, the_node));
+    TEST_CHECK(rbtree_rank(&tree, nodes[0], sval_cmp) == 500);
+    key.x = 5000;
+    TEST_CHECK(rbtree_rank(&tree, &key.the_node.base, sval_cmp) == 999);
+    TEST_CHECK(rbtree_insert(&tree, nodes[0], sval_cmp) == 0);
+
+    /* Pseudo-random removals. */
+    for(i = 0; i < 1000; i += 3) {
+        key.x = (i * 7919) % 1000;
+        node = rbtree_remove(&tree, &key.the_node.base, sval_cmp);
+        TEST_CHECK(node != NULL);
+        free(RBTREE_DATA(node, SVAL, the_node));
+    }
+    check_order_statistics(&tree);
+
+    /* Hinted insertion. */
+    clear_sized_tree(&tree);
+    rbtree_tail(&tree, &cur);
+    for(i = 0; i < 1000; i++)
+        TEST_CHECK(rbtree_insert_hint(&tree, make_sval(i), sval_cmp, &cur) == 0);
+    check_order_statistics(&tree);
+    clear_sized_tree(&tree);
+
+    /* Bulk operations. */
+    for(i = 0; i < 500; i++)
+        nodes[i] = make_sval(2 * i);
+    rbtree_build_from_sorted(&tree, nodes, 500);
+    check_order_statistics(&tree);
+    rbtree_init_sized(&other);
+    for(i = 0; i < 500; i++)
+        TEST_CHECK(rbtree_insert(&other, make_sval(2 * i + 1), sval_cmp) == 0);
+    TEST_CHECK(rbtree_merge(&tree, &other, sval_cmp) == 0);
+    check_order_statistics(&tree);
+    TEST_CHECK(rbtree_size(&tree) == 1000);
+    key.x = 700;
+    rbtree_split(&tree, &key.the_node.base, sval_cmp, &other);
+    check_order_statistics(&tree);
+    check_order_statistics(&other);
+    TEST_CHECK(rbtree_size(&tree) == 700);
+    TEST_CHECK(sval_x(rbtree_select(&other, 0)) == 700);
+
+    clear_sized_tree(&tree);
+    clear_sized_tree(&other);
+}
+
 
 TEST_LIST = {
     { "empty",              test_empty },
@@ -381,5 +708,10 @@ TEST_LIST = {
     { "walk-forward",       test_walk_forward },
     { "walk-backward",      test_walk_backward },
     { "lookup-ex",          test_lookup_ex },
+    { "build-from-sorted",  test_build_from_sorted },
+    { "insert-hint",        test_insert_hint },
+    { "merge",              test_merge },
+    { "split",              test_split },
+    { "order-statistics",   test_order_statistics },
     { NULL, NULL }
 };
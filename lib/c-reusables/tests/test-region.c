@@ -0,0 +1,588 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2018 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "acutest.h"
+#include "region.h"
+
+#include <string.h>
+
+
+#define SIZEOF_ARRAY(a)     (sizeof(a) / sizeof((a)[0]))
+
+
+/* Build a region as a union of the given rectangles. */
+static void
+make_region(REGION* rgn, const REGION_RECT* vec, size_t n)
+{
+    REGION tmp;
+    REGION rc;
+    size_t i;
+
+    region_init(rgn);
+    for(i = 0; i < n; i++) {
+        region_init_with_rect(&rc, &vec[i]);
+        TEST_ASSERT(region_union(&tmp, rgn, &rc) == 0);
+        region_fini(&rc);
+        region_fini(rgn);
+        *rgn = tmp;
+    }
+}
+
+static void
+check_region(const REGION* rgn, const REGION_RECT* expected, size_t n)
+{
+    const REGION_RECT* vec;
+    uint32_t count;
+    size_t i;
+
+    count = region_rects(rgn, &vec);
+    if(!TEST_CHECK(count == n)) {
+        TEST_MSG("expected %u rects, got %u", (unsigned) n, (unsigned) count);
+        return;
+    }
+    for(i = 0; i < n; i++) {
+        if(!TEST_CHECK(region_rect_equals_rect(&vec[i], &expected[i]))) {
+            TEST_MSG("rect %u: expected {%u,%u,%u,%u}, got {%u,%u,%u,%u}",
+                    (unsigned) i,
+                    expected[i].x0, expected[i].y0, expected[i].x1, expected[i].y1,
+                    vec[i].x0, vec[i].y0, vec[i].x1, vec[i].y1);
+        }
+    }
+}
+
+#define CHECK_OP(op)                                                          \
+    do {                                                                      \
+        REGION r1, r2, rR;                                                    \
+        make_region(&r1, vec1, SIZEOF_ARRAY(vec1));                           \
+        make_region(&r2, vec2, SIZEOF_ARRAY(vec2));                           \
+        TEST_ASSERT(op(&rR, &r1, &r2) == 0);                                  \
+        check_region(&rR, vecR, nR);                                          \
+        region_fini(&r1);                                                     \
+        region_fini(&r2);                                                     \
+        region_fini(&rR);                                                     \
+    } while(0)
+
+
+static void
+test_basic(void)
+{
+    REGION_RECT rc = { 10, 20, 30, 40 };
+    REGION rgn;
+    REGION copy;
+
+    region_init(&rgn);
+    TEST_CHECK(region_is_empty(&rgn));
+    TEST_CHECK(region_extents(&rgn) == NULL);
+    TEST_CHECK(!region_contains_xy(&rgn, 0, 0));
+    region_fini(&rgn);
+
+    region_init_with_rect(&rgn, &rc);
+    TEST_CHECK(!region_is_empty(&rgn));
+    TEST_CHECK(region_rect_equals_rect(region_extents(&rgn), &rc));
+    TEST_CHECK(region_contains_xy(&rgn, 10, 20));
+    TEST_CHECK(region_contains_xy(&rgn, 29, 39));
+    TEST_CHECK(!region_contains_xy(&rgn, 30, 39));
+    TEST_CHECK(!region_contains_xy(&rgn, 29, 40));
+    TEST_CHECK(region_copy(&copy, &rgn) == 0);
+    TEST_CHECK(region_equals(&copy, &rgn));
+    region_fini(&copy);
+    region_clear(&rgn);
+    TEST_CHECK(region_is_empty(&rgn));
+    region_fini(&rgn);
+}
+
+static void
+test_union(void)
+{
+    {   /* Union with no overlap. */
+        const REGION_RECT vec1[] = { {10,10,20,20} };
+        const REGION_RECT vec2[] = { {10,30,20,40} };
+        const REGION_RECT vecR[] = { {10,10,20,20}, {10,30,20,40} };
+        const size_t nR = SIZEOF_ARRAY(vecR);
+        CHECK_OP(region_union);
+    }
+
+    {   /* Union with vertical overlap (split into multiple bands). */
+        const REGION_RECT vec1[] = { {10,10,20,20} };
+        const REGION_RECT vec2[] = { {30,15,40,25} };
+        const REGION_RECT vecR[] = { {10,10,20,15}, {10,15,20,20}, {30,15,40,20}, {30,20,40,25} };
+        const size_t nR = SIZEOF_ARRAY(vecR);
+        CHECK_OP(region_union);
+    }
+
+    {   /* Union with band coalescing. */
+        const REGION_RECT vec1[] = { {10,10,20,15}, {10,20,20,30} };
+        const REGION_RECT vec2[] = { {10,15,20,25} };
+        const REGION_RECT vecR[] = { {10,10,20,30} };
+        const size_t nR = SIZEOF_ARRAY(vecR);
+        CHECK_OP(region_union);
+    }
+
+    {   /* Union with overlap. */
+        const REGION_RECT vec1[] = { {10,10,20,20} };
+        const REGION_RECT vec2[] = { {15,15,25,25} };
+        const REGION_RECT vecR[] = { {10,10,20,15}, {10,15,25,20}, {15,20,25,25} };
+        const size_t nR = SIZEOF_ARRAY(vecR);
+        CHECK_OP(region_union);
+    }
+}
+
+static void
+test_subtract(void)
+{
+    {   /* Subtract with no overlap. */
+        const REGION_RECT vec1[] = { {10,10,20,20} };
+        const REGION_RECT vec2[] = { {10,30,20,40} };
+        const REGION_RECT vecR[] = { {10,10,20,20} };
+        const size_t nR = SIZEOF_ARRAY(vecR);
+        CHECK_OP(region_subtract);
+    }
+
+    {   /* Subtract with complete overlap. */
+        const REGION_RECT vec1[] = { {10,10,20,15}, {10,20,20,30} };
+        const REGION_RECT vec2[] = { {10,10,50,50} };
+        const REGION_RECT* vecR = NULL;
+        const size_t nR = 0;
+        CHECK_OP(region_subtract);
+    }
+
+    {   /* Subtract with partial overlap. */
+        const REGION_RECT vec1[] = { {10,10,25,20}, {10,25,20,30} };
+        const REGION_RECT vec2[] = { {15,15,50,50} };
+        const REGION_RECT vecR[] = { {10,10,25,15}, {10,15,15,20}, {10,25,15,30} };
+        const size_t nR = SIZEOF_ARRAY(vecR);
+        CHECK_OP(region_subtract);
+    }
+}
+
+static void
+test_xor(void)
+{
+    {   /* Xor with no overlap */
+        const REGION_RECT vec1[] = { {10,10,20,20} };
+        const REGION_RECT vec2[] = { {30,10,40,20} };
+        const REGION_RECT vecR[] = { {10,10,20,20}, {30,10,40,20} };
+        const size_t nR = SIZEOF_ARRAY(vecR);
+        CHECK_OP(region_xor);
+    }
+
+    {   /* Xor with full overlap. */
+        const REGION_RECT vec1[] = { {10,10,20,20} };
+        const REGION_RECT vec2[] = { {10,10,20,20} };
+        const REGION_RECT* vecR = NULL;
+        const size_t nR = 0;
+        CHECK_OP(region_xor);
+    }
+
+    {   /* Xor with overlap. */
+        const REGION_RECT vec1[] = { {10,10,20,20} };
+        const REGION_RECT vec2[] = { {15,15,25,25} };
+        const REGION_RECT vecR[] = { {10,10,20,15}, {10,15,15,20}, {20,15,25,20}, {15,20,25,25} };
+        const size_t nR = SIZEOF_ARRAY(vecR);
+        CHECK_OP(region_xor);
+    }
+
+    {   /* Xor where two rects of a band end at the same x, followed by more
+         * rects in the band. */
+        const REGION_RECT vec1[] = { {0,0,10,1}, {20,0,30,1} };
+        const REGION_RECT vec2[] = { {0,0,10,1}, {25,0,27,1} };
+        const REGION_RECT vecR[] = { {20,0,25,1}, {27,0,30,1} };
+        const size_t nR = SIZEOF_ARRAY(vecR);
+        CHECK_OP(region_xor);
+    }
+}
+
+static void
+test_big_coords(void)
+{
+    /* Whole columns of a table with ten million rows. */
+    static const REGION_RECT vec1[] = { {2,0,3,10000000}, {5,0,7,10000000} };
+    /* Few rows beyond the 16-bit range. */
+    static const REGION_RECT vec2[] = { {0,70000,10,70002} };
+    REGION r1, r2, rR;
+
+    make_region(&r1, vec1, SIZEOF_ARRAY(vec1));
+    make_region(&r2, vec2, SIZEOF_ARRAY(vec2));
+
+    TEST_CHECK(region_contains_xy(&r1, 6, 9999999));
+    TEST_CHECK(!region_contains_xy(&r1, 6, 10000000));
+    TEST_CHECK(!region_contains_xy(&r1, 4, 5000000));
+
+    TEST_ASSERT(region_union(&rR, &r1, &r2) == 0);
+    TEST_CHECK(region_contains_xy(&rR, 0, 70001));
+    TEST_CHECK(region_contains_xy(&rR, 5, 70002));
+    TEST_CHECK(!region_contains_xy(&rR, 0, 70002));
+    TEST_CHECK(region_extents(&rR)->y1 == 10000000);
+    region_fini(&rR);
+
+    TEST_ASSERT(region_subtract(&rR, &r1, &r2) == 0);
+    TEST_CHECK(!region_contains_xy(&rR, 2, 70000));
+    TEST_CHECK(region_contains_xy(&rR, 2, 69999));
+    TEST_CHECK(region_contains_xy(&rR, 2, 70002));
+    region_fini(&rR);
+
+    region_fini(&r1);
+    region_fini(&r2);
+}
+
+
+/* Randomized tests comparing the region against a plain bitmap. */
+
+#define W   24
+#define H   24
+
+static unsigned
+rnd(unsigned* state)
+{
+    *state = *state * 1103515245U + 12345U;
+    return (*state >> 16) & 0x7fff;
+}
+
+static void
+random_rect(REGION_RECT* rc, unsigned* seed)
+{
+    rc->x0 = rnd(seed) % W;
+    rc->y0 = rnd(seed) % H;
+    rc->x1 = rc->x0 + 1 + rnd(seed) % (W - rc->x0);
+    rc->y1 = rc->y0 + 1 + rnd(seed) % (H - rc->y0);
+}
+
+static void
+set_bitmap(char bitmap[H][W], const REGION_RECT* rc, int op)
+{
+    uint32_t x, y;
+
+    for(y = rc->y0; y < rc->y1; y++) {
+        for(x = rc->x0; x < rc->x1; x++) {
+            switch(op) {
+                case 0:  bitmap[y][x] = 1; break;
+                case 1:  bitmap[y][x] = 0; break;
+                default: bitmap[y][x] ^= 1; break;
+            }
+        }
+    }
+}
+
+static int
+check_against_bitmap(const REGION* rgn, char bitmap[H][W])
+{
+    const REGION_RECT* vec;
+    const REGION_RECT* ext;
+    REGION_CURSOR cur;
+    uint32_t i, n, x, y;
+
+    /* The cells. */
+    region_cursor_init(&cur, rgn);
+    for(y = 0; y < H; y++) {
+        for(x = 0; x < W; x++) {
+            if(!region_contains_xy(rgn, x, y) != !bitmap[y][x])
+                return 0;
+            if(!region_cursor_contains_xy(&cur, x, y) != !bitmap[y][x])
+                return 0;
+        }
+    }
+
+    /* The invariants of the representation. */
+    n = region_rects(rgn, &vec);
+    ext = region_extents(rgn);
+    for(i = 0; i < n; i++) {
+        if(vec[i].x0 >= vec[i].x1  ||  vec[i].y0 >= vec[i].y1)
+            return 0;
+        if(!region_rect_contains_rect(ext, &vec[i]))
+            return 0;
+        if(i > 0) {
+            if(vec[i].y0 == vec[i-1].y0) {
+                /* Same band: same height, ordered, not touching. */
+                if(vec[i].y1 != vec[i-1].y1  ||  vec[i].x0 <= vec[i-1].x1)
+                    return 0;
+            } else if(vec[i].y0 < vec[i-1].y1) {
+                return 0;
+            }
+        }
+    }
+
+    return 1;
+}
+
+static void
+test_random(void)
+{
+    static const char* op_names[] = { "union", "subtract", "xor" };
+    char bitmap[H][W];
+    REGION rgn, rc_rgn, tmp;
+    REGION_RECT rc;
+    unsigned seed = 2020;
+    int round, step, op, err;
+
+    for(round = 0; round < 200; round++) {
+        memset(bitmap, 0, sizeof(bitmap));
+        region_init(&rgn);
+
+        for(step = 0; step < 30; step++) {
+            random_rect(&rc, &seed);
+            op = rnd(&seed) % 3;
+
+            region_init_with_rect(&rc_rgn, &rc);
+            switch(op) {
+                case 0:  err = region_union(&tmp, &rgn, &rc_rgn); break;
+                case 1:  err = region_subtract(&tmp, &rgn, &rc_rgn); break;
+                default: err = region_xor(&tmp, &rgn, &rc_rgn); break;
+            }
+            TEST_ASSERT(err == 0);
+            region_fini(&rc_rgn);
+            region_fini(&rgn);
+            rgn = tmp;
+
+            set_bitmap(bitmap, &rc, op);
+            if(!TEST_CHECK(check_against_bitmap(&rgn, bitmap))) {
+                TEST_MSG("round %d, step %d: %s with {%u,%u,%u,%u}", round, step,
+                         op_names[op], rc.x0, rc.y0, rc.x1, rc.y1);
+                region_fini(&rgn);
+                return;
+            }
+        }
+
+        region_fini(&rgn);
+    }
+}
+
+static void
+test_random_complex(void)
+{
+    /* Same as above but the second operand is a complex region too. */
+    char bitmap1[H][W];
+    char bitmap2[H][W];
+    char bitmapR[H][W];
+    REGION r1, r2, rR, rc_rgn, tmp;
+    REGION_RECT rc;
+    unsigned seed = 77;
+    int round, i, x, y, op, err;
+
+    for(round = 0; round < 300; round++) {
+        memset(bitmap1, 0, sizeof(bitmap1));
+        memset(bitmap2, 0, sizeof(bitmap2));
+        region_init(&r1);
+        region_init(&r2);
+
+        for(i = 0; i < 8; i++) {
+            random_rect(&rc, &seed);
+            region_init_with_rect(&rc_rgn, &rc);
+            TEST_ASSERT(region_xor(&tmp, (i & 1) ? &r2 : &r1, &rc_rgn) == 0);
+            region_fini(&rc_rgn);
+            region_fini((i & 1) ? &r2 : &r1);
+            *((i & 1) ? &r2 : &r1) = tmp;
+            set_bitmap((i & 1) ? bitmap2 : bitmap1, &rc, 2);
+        }
+
+        for(op = 0; op < 3; op++) {
+            switch(op) {
+                case 0:  err = region_union(&rR, &r1, &r2); break;
+                case 1:  err = region_subtract(&rR, &r1, &r2); break;
+                default: err = region_xor(&rR, &r1, &r2); break;
+            }
+            TEST_ASSERT(err == 0);
+
+            for(y = 0; y < H; y++) {
+                for(x = 0; x < W; x++) {
+                    switch(op) {
+                        case 0:  bitmapR[y][x] = bitmap1[y][x] | bitmap2[y][x]; break;
+                        case 1:  bitmapR[y][x] = bitmap1[y][x] & !bitmap2[y][x]; break;
+                        default: bitmapR[y][x] = bitmap1[y][x] ^ bitmap2[y][x]; break;
+                    }
+                }
+            }
+
+            if(!TEST_CHECK(check_against_bitmap(&rR, bitmapR)))
+                TEST_MSG("round %d, op %d", round, op);
+            region_fini(&rR);
+        }
+
+        region_fini(&r1);
+        region_fini(&r2);
+    }
+}
+
+
+static void
+test_lookups(void)
+{
+    /* Containment tests of rects and of cells in a random order (i.e. not
+     * the row-major one the cursor is optimized for). */
+    char bitmap[H][W];
+    REGION rgn, rc_rgn, tmp;
+    REGION_CURSOR cur;
+    REGION_RECT rc;
+    unsigned seed = 31337;
+    uint32_t x, y;
+    int round, i, expected;
+
+    for(round = 0; round < 200; round++) {
+        memset(bitmap, 0, sizeof(bitmap));
+        region_init(&rgn);
+        for(i = 0; i < 10; i++) {
+            random_rect(&rc, &seed);
+            region_init_with_rect(&rc_rgn, &rc);
+            TEST_ASSERT(region_xor(&tmp, &rgn, &rc_rgn) == 0);
+            region_fini(&rc_rgn);
+            region_fini(&rgn);
+            rgn = tmp;
+            set_bitmap(bitmap, &rc, 2);
+        }
+
+        region_cursor_init(&cur, &rgn);
+        for(i = 0; i < 200; i++) {
+            x = rnd(&seed) % (W + 2);
+            y = rnd(&seed) % (H + 2);
+            expected = (x < W  &&  y < H  &&  bitmap[y][x]);
+            if(!TEST_CHECK(!region_cursor_contains_xy(&cur, x, y) == !expected))
+                TEST_MSG("round %d: cell [%u,%u]", round, x, y);
+        }
+
+        for(i = 0; i < 100; i++) {
+            random_rect(&rc, &seed);
+            expected = 1;
+            for(y = rc.y0; y < rc.y1; y++) {
+                for(x = rc.x0; x < rc.x1; x++) {
+                    if(!bitmap[y][x])
+                        expected = 0;
+                }
+            }
+            if(!TEST_CHECK(!region_contains_rect(&rgn, &rc) == !expected))
+                TEST_MSG("round %d: rect {%u,%u,%u,%u}", round, rc.x0, rc.y0, rc.x1, rc.y1);
+        }
+
+        region_fini(&rgn);
+    }
+}
+
+static void
+test_in_place(void)
+{
+    static const char* op_names[] = { "union", "subtract", "xor" };
+    char bitmap[H][W];
+    REGION rgn, ref, rc_rgn, tmp;
+    REGION_RECT rc;
+    unsigned seed = 4242;
+    int round, step, op, err;
+
+    for(round = 0; round < 200; round++) {
+        memset(bitmap, 0, sizeof(bitmap));
+        region_init(&rgn);
+        region_init(&ref);
+
+        for(step = 0; step < 30; step++) {
+            random_rect(&rc, &seed);
+            /* Make the fast path of appending a band below likely. */
+            if(step % 3 == 0  &&  region_extents(&rgn) != NULL  &&
+               region_extents(&rgn)->y1 < H) {
+                rc.y0 = region_extents(&rgn)->y1 + rnd(&seed) % 2;
+                if(rc.y0 >= H)
+                    rc.y0 = H - 1;
+                rc.y1 = rc.y0 + 1 + rnd(&seed) % (H - rc.y0);
+            }
+            op = rnd(&seed) % 3;
+
+            switch(op) {
+                case 0:  err = region_union_rect(&rgn, &rc); break;
+                case 1:  err = region_subtract_rect(&rgn, &rc); break;
+                default: err = region_xor_rect(&rgn, &rc); break;
+            }
+            TEST_ASSERT(err == 0);
+
+            /* Compare with the result of the ordinary operations. */
+            region_init_with_rect(&rc_rgn, &rc);
+            switch(op) {
+                case 0:  err = region_union(&tmp, &ref, &rc_rgn); break;
+                case 1:  err = region_subtract(&tmp, &ref, &rc_rgn); break;
+                default: err = region_xor(&tmp, &ref, &rc_rgn); break;
+            }
+            TEST_ASSERT(err == 0);
+            region_fini(&rc_rgn);
+            region_fini(&ref);
+            ref = tmp;
+
+            set_bitmap(bitmap, &rc, op);
+            if(!TEST_CHECK(check_against_bitmap(&rgn, bitmap)  &&
+                           region_equals(&rgn, &ref))) {
+                TEST_MSG("round %d, step %d: %s with {%u,%u,%u,%u}", round, step,
+                         op_names[op], rc.x0, rc.y0, rc.x1, rc.y1);
+                region_fini(&rgn);
+                region_fini(&ref);
+                return;
+            }
+        }
+
+        region_fini(&rgn);
+        region_fini(&ref);
+    }
+}
+
+static void
+test_batch(void)
+{
+    char bitmap[H][W];
+    REGION_RECT rects[40];
+    REGION_RECT nonempty[40];
+    REGION rgn, ref;
+    unsigned seed = 99;
+    int round, i, n, m;
+
+    for(round = 0; round < 300; round++) {
+        memset(bitmap, 0, sizeof(bitmap));
+        n = rnd(&seed) % SIZEOF_ARRAY(rects);
+        m = 0;
+        for(i = 0; i < n; i++) {
+            random_rect(&rects[i], &seed);
+            /* Some empty rects (which region_union() does not expect). */
+            if(rnd(&seed) % 8 == 0)
+                rects[i].x1 = rects[i].x0;
+            else
+                nonempty[m++] = rects[i];
+            set_bitmap(bitmap, &rects[i], 0);
+        }
+
+        TEST_ASSERT(region_init_with_rects(&rgn, rects, n) == 0);
+        make_region(&ref, nonempty, m);
+        if(!TEST_CHECK(check_against_bitmap(&rgn, bitmap)  &&  region_equals(&rgn, &ref)))
+            TEST_MSG("round %d (%d rects)", round, n);
+        region_fini(&rgn);
+        region_fini(&ref);
+    }
+}
+
+
+TEST_LIST = {
+    { "basic",           test_basic },
+    { "union",           test_union },
+    { "subtract",        test_subtract },
+    { "xor",             test_xor },
+    { "big-coords",      test_big_coords },
+    { "random",          test_random },
+    { "random-complex",  test_random_complex },
+    { "lookups",         test_lookups },
+    { "in-place",        test_in_place },
+    { "batch",           test_batch },
+    { 0 }
+};
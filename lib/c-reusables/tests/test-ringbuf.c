@@ -0,0 +1,337 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2020 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "acutest.h"
+#include "ringbuf.h"
+
+#ifdef _WIN32
+    #include <windows.h>
+    #define yield()     SwitchToThread()
+#else
+    #include <pthread.h>
+    #include <sched.h>
+    #define yield()     sched_yield()
+#endif
+
+
+static void
+test_push_pop(void)
+{
+    RINGBUF rb;
+    int i, x;
+
+    ringbuf_init(&rb, sizeof(int));
+    TEST_CHECK(ringbuf_is_empty(&rb));
+    TEST_CHECK(ringbuf_front(&rb) == NULL);
+    TEST_CHECK(ringbuf_back(&rb) == NULL);
+    TEST_CHECK(ringbuf_pop_front(&rb, &x) == -1);
+    TEST_CHECK(ringbuf_pop_back(&rb, &x) == -1);
+
+    /* Queue: push back, pop front. */
+    for(i = 0; i < 100; i++)
+        TEST_CHECK(ringbuf_push_back(&rb, &i) == 0);
+    TEST_CHECK(ringbuf_count(&rb) == 100);
+    TEST_CHECK(*(int*) ringbuf_front(&rb) == 0);
+    TEST_CHECK(*(int*) ringbuf_back(&rb) == 99);
+    for(i = 0; i < 100; i++) {
+        TEST_CHECK(*(int*) ringbuf_at(&rb, 0) == i);
+        TEST_CHECK(ringbuf_pop_front(&rb, &x) == 0);
+        TEST_CHECK(x == i);
+    }
+    TEST_CHECK(ringbuf_is_empty(&rb));
+
+    /* Stack at the front: push front, pop front. */
+    for(i = 0; i < 100; i++)
+        TEST_CHECK(ringbuf_push_front(&rb, &i) == 0);
+    for(i = 0; i < 100; i++)
+        TEST_CHECK(*(int*) ringbuf_at(&rb, i) == 99 - i);
+    for(i = 99; i >= 0; i--) {
+        TEST_CHECK(ringbuf_pop_front(&rb, &x) == 0);
+        TEST_CHECK(x == i);
+    }
+
+    /* Both ends. */
+    for(i = 0; i < 50; i++) {
+        TEST_CHECK(ringbuf_push_back(&rb, &i) == 0);
+        x = -i - 1;
+        TEST_CHECK(ringbuf_push_front(&rb, &x) == 0);
+    }
+    for(i = 0; i < 100; i++)
+        TEST_CHECK(*(int*) ringbuf_at(&rb, i) == i - 50);
+    TEST_CHECK(ringbuf_pop_back(&rb, &x) == 0  &&  x == 49);
+    TEST_CHECK(ringbuf_pop_front(&rb, NULL) == 0);
+    TEST_CHECK(*(int*) ringbuf_front(&rb) == -49);
+    TEST_CHECK(ringbuf_count(&rb) == 98);
+
+    ringbuf_clear(&rb);
+    TEST_CHECK(ringbuf_is_empty(&rb));
+
+    ringbuf_fini(&rb);
+}
+
+static void
+test_wrap_around(void)
+{
+    RINGBUF rb = RINGBUF_INITIALIZER(sizeof(int));
+    size_t capacity;
+    int i, x;
+    int next_in = 0, next_out = 0;
+
+    /* Keep the count below the capacity so the queue wraps around many times
+     * without growing. */
+    TEST_CHECK(ringbuf_reserve(&rb, 10) == 0);
+    capacity = rb.capacity;
+    for(i = 0; i < 1000; i++) {
+        TEST_CHECK(ringbuf_push_back(&rb, &next_in) == 0);
+        next_in++;
+        if(ringbuf_count(&rb) >= 10) {
+            TEST_CHECK(ringbuf_pop_front(&rb, &x) == 0);
+            TEST_CHECK(x == next_out);
+            next_out++;
+        }
+    }
+    TEST_CHECK(rb.capacity == capacity);
+
+    /* Growing a wrapped-around contents preserves the order. */
+    while(rb.capacity == capacity) {
+        TEST_CHECK(ringbuf_push_back(&rb, &next_in) == 0);
+        next_in++;
+    }
+    for(i = 0; next_out < next_in; i++) {
+        TEST_CHECK(ringbuf_pop_front(&rb, &x) == 0);
+        TEST_CHECK(x == next_out);
+        next_out++;
+    }
+    TEST_CHECK(ringbuf_is_empty(&rb));
+
+    ringbuf_fini(&rb);
+}
+
+static void
+test_spans(void)
+{
+    RINGBUF rb = RINGBUF_INITIALIZER(sizeof(int));
+    int in[40], out[40];
+    void* span;
+    size_t n, total;
+    int i;
+
+    for(i = 0; i < 40; i++)
+        in[i] = i;
+
+    /* Move the head into the middle of the memory block. */
+    TEST_CHECK(ringbuf_reserve(&rb, 16) == 0);
+    TEST_CHECK(rb.capacity == 16);
+    TEST_CHECK(ringbuf_push_back_n(&rb, in, 10) == 0);
+    TEST_CHECK(ringbuf_pop_front_n(&rb, out, 10) == 10);
+
+    /* Now the contents wraps around: The read span covers only its part. */
+    TEST_CHECK(ringbuf_push_back_n(&rb, in, 12) == 0);
+    TEST_CHECK(rb.capacity == 16);
+    n = ringbuf_read_span(&rb, &span);
+    TEST_CHECK(n == 6);
+    TEST_CHECK(memcmp(span, in, n * sizeof(int)) == 0);
+    ringbuf_consume(&rb, n);
+    n = ringbuf_read_span(&rb, &span);
+    TEST_CHECK(n == 6);
+    TEST_CHECK(memcmp(span, in + 6, n * sizeof(int)) == 0);
+    ringbuf_consume(&rb, n);
+    TEST_CHECK(ringbuf_read_span(&rb, &span) == 0);
+
+    /* Write spans. */
+    total = 0;
+    while(total < 16) {
+        n = ringbuf_write_span(&rb, &span);
+        TEST_CHECK(n > 0);
+        memcpy(span, in + total, n * sizeof(int));
+        ringbuf_commit(&rb, n);
+        total += n;
+    }
+    TEST_CHECK(ringbuf_write_span(&rb, &span) == 0);
+    TEST_CHECK(ringbuf_count(&rb) == 16);
+    TEST_CHECK(ringbuf_pop_front_n(&rb, out, 40) == 16);
+    TEST_CHECK(memcmp(out, in, 16 * sizeof(int)) == 0);
+
+    ringbuf_fini(&rb);
+}
+
+static void
+test_spsc_basic(void)
+{
+    RINGBUF_SPSC rb;
+    int in[100], out[100];
+    void* span;
+    size_t n;
+    int i, x;
+
+    for(i = 0; i < 100; i++)
+        in[i] = i;
+
+    TEST_CHECK(ringbuf_spsc_init(&rb, sizeof(int), 30) == 0);
+    TEST_CHECK(ringbuf_spsc_pop(&rb, &x) == -1);
+
+    /* The capacity is rounded up to 32. */
+    for(i = 0; i < 32; i++)
+        TEST_CHECK(ringbuf_spsc_push(&rb, &in[i]) == 0);
+    TEST_CHECK(ringbuf_spsc_push(&rb, &in[0]) == -1);
+    for(i = 0; i < 32; i++) {
+        TEST_CHECK(ringbuf_spsc_pop(&rb, &x) == 0);
+        TEST_CHECK(x == i);
+    }
+    TEST_CHECK(ringbuf_spsc_pop(&rb, &x) == -1);
+
+    /* Bulk operations, wrapping around. */
+    TEST_CHECK(ringbuf_spsc_push_n(&rb, in, 20) == 20);
+    TEST_CHECK(ringbuf_spsc_pop_n(&rb, out, 5) == 5);
+    TEST_CHECK(ringbuf_spsc_push_n(&rb, in + 20, 100) == 17);
+    TEST_CHECK(ringbuf_spsc_pop_n(&rb, out + 5, 100) == 32);
+    TEST_CHECK(memcmp(out, in, 37 * sizeof(int)) == 0);
+
+    /* Spans. */
+    n = ringbuf_spsc_write_span(&rb, &span);
+    TEST_CHECK(n > 0  &&  n < 32);     /* Up to the end of the memory block. */
+    memcpy(span, in, n * sizeof(int));
+    ringbuf_spsc_commit(&rb, n);
+    TEST_CHECK(ringbuf_spsc_read_span(&rb, &span) == n);
+    TEST_CHECK(memcmp(span, in, n * sizeof(int)) == 0);
+    ringbuf_spsc_consume(&rb, n);
+    TEST_CHECK(ringbuf_spsc_read_span(&rb, &span) == 0);
+
+    ringbuf_spsc_fini(&rb);
+}
+
+
+#define STRESS_COUNT    (4 * 1000 * 1000)
+
+static RINGBUF_SPSC stress_rb;
+
+#ifdef _WIN32
+static DWORD WINAPI
+#else
+static void*
+#endif
+stress_producer(void* param)
+{
+    unsigned buf[7];
+    unsigned next = 0;
+    unsigned i, n;
+
+    (void) param;
+
+    /* Alternate single pushes and bulk pushes. */
+    while(next < STRESS_COUNT) {
+        if(next % 3 == 0) {
+            n = (ringbuf_spsc_push(&stress_rb, &next) == 0) ? 1 : 0;
+        } else {
+            n = STRESS_COUNT - next;
+            if(n > 7)
+                n = 7;
+            for(i = 0; i < n; i++)
+                buf[i] = next + i;
+            n = (unsigned) ringbuf_spsc_push_n(&stress_rb, buf, n);
+        }
+
+        /* Full: Let the consumer run (the machine may have a single core). */
+        if(n == 0)
+            yield();
+        next += n;
+    }
+
+    return 0;
+}
+
+static void
+test_spsc_stress(void)
+{
+    unsigned expected = 0;
+    unsigned buf[5];
+    unsigned i, n;
+    void* span;
+    int ok = 1;
+#ifdef _WIN32
+    HANDLE thread;
+#else
+    pthread_t thread;
+#endif
+
+    TEST_ASSERT(ringbuf_spsc_init(&stress_rb, sizeof(unsigned), 64) == 0);
+
+#ifdef _WIN32
+    thread = CreateThread(NULL, 0, stress_producer, NULL, 0, NULL);
+    TEST_ASSERT(thread != NULL);
+#else
+    TEST_ASSERT(pthread_create(&thread, NULL, stress_producer, NULL) == 0);
+#endif
+
+    /* The consumer alternates single pops, bulk pops and spans. */
+    while(ok  &&  expected < STRESS_COUNT) {
+        switch(expected % 3) {
+            case 0:
+                n = (ringbuf_spsc_pop(&stress_rb, buf) == 0) ? 1 : 0;
+                if(n > 0)
+                    ok = (buf[0] == expected);
+                break;
+
+            case 1:
+                n = (unsigned) ringbuf_spsc_pop_n(&stress_rb, buf, 5);
+                for(i = 0; i < n; i++)
+                    ok = ok && (buf[i] == expected + i);
+                break;
+
+            default:
+                n = (unsigned) ringbuf_spsc_read_span(&stress_rb, &span);
+                for(i = 0; i < n; i++)
+                    ok = ok && (((unsigned*) span)[i] == expected + i);
+                ringbuf_spsc_consume(&stress_rb, n);
+                break;
+        }
+
+        /* Empty: Let the producer run. */
+        if(n == 0)
+            yield();
+        expected += n;
+    }
+    TEST_CHECK_(ok, "all elements received in order (up to %u)", expected);
+
+#ifdef _WIN32
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+#else
+    pthread_join(thread, NULL);
+#endif
+
+    TEST_CHECK(ringbuf_spsc_pop(&stress_rb, buf) == -1);
+    ringbuf_spsc_fini(&stress_rb);
+}
+
+
+TEST_LIST = {
+    { "push-pop",       test_push_pop },
+    { "wrap-around",    test_wrap_around },
+    { "spans",          test_spans },
+    { "spsc-basic",     test_spsc_basic },
+    { "spsc-stress",    test_spsc_stress },
+    { NULL, NULL }
+};
@@ -0,0 +1,205 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2020 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "acutest.h"
+#include "rope.h"
+
+#include <string.h>
+
+
+/* Simple deterministic PRNG so failures are reproducible. */
+static unsigned
+rnd(unsigned* state)
+{
+    *state = *state * 1103515245U + 12345U;
+    return (*state >> 16) & 0x7fff;
+}
+
+/* Check the internal invariants and compare the contents with the reference
+ * array. */
+static int
+rope_equals(ROPE* rope, const unsigned* ref, size_t n)
+{
+    size_t c, i;
+
+    if(rope_count(rope) != n)
+        return 0;
+
+    if(n == 0)
+        return (rope->chunk_count == 0);
+
+    if(rope->starts[0] != 0  ||  rope->starts[rope->chunk_count] != n)
+        return 0;
+    for(c = 0; c < rope->chunk_count; c++) {
+        size_t len = rope->starts[c+1] - rope->starts[c];
+        if(len == 0  ||  len > rope->chunk_cap)
+            return 0;
+    }
+
+    for(i = 0; i < n; i++) {
+        if(*(unsigned*) rope_get(rope, i) != ref[i])
+            return 0;
+        if(*(const unsigned*) rope_get_const(rope, i) != ref[i])
+            return 0;
+    }
+
+    return 1;
+}
+
+static void
+test_basic(void)
+{
+    ROPE rope;
+    unsigned ref[8] = { 0 };
+    size_t i;
+
+    rope_init(&rope, sizeof(unsigned), 4);
+    TEST_CHECK(rope_count(&rope) == 0);
+    TEST_CHECK(rope_equals(&rope, ref, 0));
+
+    TEST_CHECK(rope_insert(&rope, 0, 8) == 0);
+    TEST_CHECK(rope_equals(&rope, ref, 8));     /* New elements are zeroed. */
+
+    for(i = 0; i < 8; i++) {
+        *(unsigned*) rope_get(&rope, i) = (unsigned) i;
+        ref[i] = (unsigned) i;
+    }
+    TEST_CHECK(rope_equals(&rope, ref, 8));
+
+    rope_remove(&rope, 2, 3);
+    memmove(ref + 2, ref + 5, 3 * sizeof(unsigned));
+    TEST_CHECK(rope_equals(&rope, ref, 5));
+
+    rope_remove(&rope, 0, 5);
+    TEST_CHECK(rope_equals(&rope, ref, 0));
+
+    rope_fini(&rope);
+}
+
+static void
+test_random(void)
+{
+    static const size_t caps[] = { 1, 2, 3, 7, 16, 0 };
+    unsigned* ref;
+    size_t ci;
+
+    ref = (unsigned*) malloc(10000 * sizeof(unsigned));
+
+    for(ci = 0; ci < sizeof(caps) / sizeof(caps[0]); ci++) {
+        ROPE rope;
+        size_t n = 0;
+        unsigned seed = 1234;
+        unsigned val = 1;
+        int iter;
+        int ok = 1;
+
+        rope_init(&rope, sizeof(unsigned), caps[ci]);
+
+        for(iter = 0; iter < 2000 && ok; iter++) {
+            size_t pos = (n > 0 ? rnd(&seed) % (n + 1) : 0);
+            size_t cnt = 1 + rnd(&seed) % (rnd(&seed) % 8 == 0 ? 100 : 4);
+            size_t i;
+
+            if(rnd(&seed) % 3 != 0  &&  n + cnt <= 10000) {
+                TEST_CHECK(rope_insert(&rope, pos, cnt) == 0);
+                memmove(ref + pos + cnt, ref + pos, (n - pos) * sizeof(unsigned));
+                n += cnt;
+                for(i = pos; i < pos + cnt; i++) {
+                    ref[i] = val;
+                    *(unsigned*) rope_get(&rope, i) = val++;
+                }
+            } else if(pos < n) {
+                cnt = (cnt < n - pos ? cnt : n - pos);
+                rope_remove(&rope, pos, cnt);
+                memmove(ref + pos, ref + pos + cnt, (n - pos - cnt) * sizeof(unsigned));
+                n -= cnt;
+            }
+
+            ok = rope_equals(&rope, ref, n);
+        }
+
+        TEST_CHECK_(ok, "chunk_cap %u", (unsigned) caps[ci]);
+        rope_fini(&rope);
+    }
+
+    free(ref);
+}
+
+static void
+test_span(void)
+{
+    ROPE rope;
+    size_t i, n, total;
+    unsigned* elem;
+
+    rope_init(&rope, sizeof(unsigned), 10);
+    TEST_CHECK(rope_insert(&rope, 0, 95) == 0);
+    for(i = 0; i < 95; i++)
+        *(unsigned*) rope_get(&rope, i) = (unsigned) i;
+    TEST_CHECK(rope_insert(&rope, 42, 3) == 0);
+    rope_remove(&rope, 42, 3);
+
+    /* Walk everything chunk by chunk. */
+    total = 0;
+    for(i = 0; i < rope_count(&rope); i += n) {
+        elem = (unsigned*) rope_span(&rope, i, &n);
+        TEST_CHECK(n > 0);
+        TEST_CHECK(elem[0] == (unsigned) i);
+        TEST_CHECK(elem[n-1] == (unsigned) (i + n - 1));
+        total += n;
+    }
+    TEST_CHECK(total == 95);
+
+    rope_fini(&rope);
+}
+
+static void
+test_append(void)
+{
+    ROPE rope;
+    size_t i;
+
+    /* Appending one by one should keep the chunks full. */
+    rope_init(&rope, sizeof(unsigned), 16);
+    for(i = 0; i < 1000; i++)
+        TEST_CHECK(rope_insert(&rope, i, 1) == 0);
+    TEST_CHECK(rope.chunk_count == (1000 + 15) / 16);
+
+    /* Removing everything releases all the memory. */
+    rope_remove(&rope, 0, 1000);
+    TEST_CHECK(rope_count(&rope) == 0);
+    TEST_CHECK(rope.chunks == NULL);
+
+    rope_fini(&rope);
+}
+
+
+TEST_LIST = {
+    { "basic",      test_basic },
+    { "random",     test_random },
+    { "span",       test_span },
+    { "append",     test_append },
+    { 0 }
+};
@@ -742,6 +742,191 @@ test_array_remove(void)
     value_fini(&a);
 }
 
+static void
+test_array_bulk(void)
+{
+    const int N = 100000;
+
+    VALUE a;
+    VALUE* v;
+    VALUE* buf;
+    VALUE tmp[3];
+    int i;
+
+    /* Reserve + append_n. */
+    value_init_array(&a);
+    TEST_CHECK(value_array_reserve(&a, N) == 0);
+    v = value_array_append_n(&a, N);
+    TEST_CHECK(v != NULL);
+    TEST_CHECK(v == value_array_get_all(&a));
+    TEST_CHECK(value_is_new(&v[0]));
+    TEST_CHECK(value_is_new(&v[N-1]));
+    for(i = 0; i < N; i++)
+        value_init_int32(&v[i], i);
+    TEST_CHECK(value_array_size(&a) == N);
+
+    /* Insert_n in the middle. */
+    v = value_array_insert_n(&a, 1, 3);
+    TEST_CHECK(v == value_array_get(&a, 1));
+    for(i = 0; i < 3; i++) {
+        TEST_CHECK(value_is_new(&v[i]));
+        value_init_string(&v[i], "some string long enough to be malloc-ed");
+    }
+    TEST_CHECK(value_array_size(&a) == N + 3);
+    TEST_CHECK(value_int32(value_array_get(&a, 0)) == 0);
+    TEST_CHECK(value_int32(value_array_get(&a, 4)) == 1);
+    TEST_CHECK(value_array_insert_n(&a, N + 4, 1) == NULL);
+
+    /* Append_move. */
+    value_init_int32(&tmp[0], -1);
+    value_init_string(&tmp[1], "another string long enough to be malloc-ed");
+    value_init_dict(&tmp[2]);
+    value_init_bool(value_dict_get_or_add(&tmp[2], "foo"), 1);
+    TEST_CHECK(value_array_append_move(&a, tmp, 3) == 0);
+    TEST_CHECK(value_array_size(&a) == N + 6);
+    TEST_CHECK(value_int32(value_path(&a, "[-3]")) == -1);
+    TEST_CHECK(value_bool(value_path(&a, "[-1]/foo")) == 1);
+
+    value_array_remove_range(&a, 1, 3);
+    TEST_CHECK(value_array_size(&a) == N + 3);
+    TEST_CHECK(value_int32(value_array_get(&a, 1)) == 1);
+    value_array_shrink(&a);
+    TEST_CHECK(value_int32(value_array_get(&a, N-1)) == N-1);
+    value_fini(&a);
+
+    /* Init from a C array. */
+    buf = (VALUE*) malloc(N * sizeof(VALUE));
+    for(i = 0; i < N; i++)
+        value_init_int32(&buf[i], i);
+    TEST_CHECK(value_init_array_move(&a, buf, N) == 0);
+    TEST_CHECK(value_array_size(&a) == N);
+    TEST_CHECK(value_array_get_all(&a) == buf);
+    v = value_array_append(&a);
+    value_init_int32(v, N);
+    for(i = 0; i <= N; i++)
+        TEST_CHECK(value_int32(value_array_get(&a, i)) == i);
+    value_array_clean(&a);
+    value_array_shrink(&a);
+    TEST_CHECK(value_array_size(&a) == 0);
+    value_fini(&a);
+}
+
+static void
+test_array_remove_nested(void)
+{
+    static const int32_t i32[] = { 1, 2, 3 };
+    static const double dbl[] = { 0.5, 1.5 };
+
+    VALUE a;
+    VALUE* v;
+    int i;
+
+    /* Containers own memory on the heap even if their payload fits into the
+     * VALUE itself (as it does on 32-bit platforms). Removing or cleaning them
+     * must release it (ASAN/valgrind would complain otherwise). */
+    value_init_array(&a);
+    value_init_int32(value_array_append(&a), -1);
+    for(i = 0; i < 2; i++) {
+        v = value_array_append(&a);
+        value_init_array(v);
+        value_init_string(value_array_append(v), "some string long enough to be malloc-ed");
+        value_init_int32(value_array_append(v), i);
+
+        v = value_array_append(&a);
+        value_init_dict(v);
+        value_init_bool(value_dict_get_or_add(v, "foo"), 1);
+        value_init_array(value_dict_get_or_add(v, "bar"));
+
+        TEST_CHECK(value_init_int32_vector(value_array_append(&a), i32, 3) == 0);
+        TEST_CHECK(value_init_double_vector(value_array_append(&a), dbl, 2) == 0);
+        value_init_string(value_array_append(&a), "short");
+    }
+    value_init_int32(value_array_append(&a), -2);
+    TEST_CHECK(value_array_size(&a) == 12);
+
+    value_array_remove_range(&a, 1, 5);
+    TEST_CHECK(value_array_size(&a) == 7);
+    TEST_CHECK(value_int32(value_array_get(&a, 0)) == -1);
+    TEST_CHECK(value_type(value_array_get(&a, 1)) == VALUE_ARRAY);
+    TEST_CHECK(value_int32(value_path(&a, "[1]/[1]")) == 1);
+
+    value_array_clean(&a);
+    TEST_CHECK(value_array_size(&a) == 0);
+    value_fini(&a);
+}
+
+static void
+test_vector(void)
+{
+    static const int32_t i32[] = { 1, -2, 3, -4, 5 };
+    static const double dbl[] = { 0.5, 1.5 };
+
+    VALUE v;
+    VALUE* item;
+    int32_t* p32;
+    int i;
+
+    TEST_CHECK(value_init_int32_vector(NULL, i32, 5) != 0);
+    TEST_CHECK(value_vector_size(NULL) == 0);
+    TEST_CHECK(value_vector_data(NULL) == NULL);
+
+    TEST_CHECK(value_init_int32_vector(&v, i32, 5) == 0);
+    TEST_CHECK(value_type(&v) == VALUE_INT32_VECTOR);
+    TEST_CHECK(value_vector_elem_type(&v) == VALUE_INT32);
+    TEST_CHECK(value_vector_size(&v) == 5);
+    TEST_CHECK(value_double_vector(&v) == NULL);
+    p32 = value_int32_vector(&v);
+    TEST_CHECK(p32 != NULL  &&  memcmp(p32, i32, sizeof(i32)) == 0);
+    TEST_CHECK(value_vector_append(&v, i32, 5) == 0);
+    TEST_CHECK(value_vector_size(&v) == 10);
+    TEST_CHECK(value_int32_vector(&v)[9] == 5);
+    TEST_CHECK(value_vector_remove_range(&v, 0, 5) == 0);
+    TEST_CHECK(value_vector_remove_range(&v, 4, 2) != 0);
+    TEST_CHECK(memcmp(value_vector_data(&v), i32, sizeof(i32)) == 0);
+    TEST_CHECK(value_vector_resize(&v, 7) == 0);
+    TEST_CHECK(value_int32_vector(&v)[6] == 0);
+    TEST_CHECK(value_vector_resize(&v, 5) == 0);
+
+    /* Vector --> array --> vector. */
+    TEST_CHECK(value_vector_to_array(&v) == 0);
+    TEST_CHECK(value_type(&v) == VALUE_ARRAY);
+    TEST_CHECK(value_array_size(&v) == 5);
+    for(i = 0; i < 5; i++) {
+        TEST_CHECK(value_type(value_array_get(&v, i)) == VALUE_INT32);
+        TEST_CHECK(value_int32(value_array_get(&v, i)) == i32[i]);
+    }
+    TEST_CHECK(value_array_to_vector(&v, VALUE_DOUBLE_VECTOR) == 0);
+    TEST_CHECK(value_type(&v) == VALUE_DOUBLE_VECTOR);
+    for(i = 0; i < 5; i++)
+        TEST_CHECK(value_double_vector(&v)[i] == (double) i32[i]);
+    value_fini(&v);
+
+    /* Incompatible items. */
+    value_init_array(&v);
+    value_init_double(value_array_append(&v), 0.5);
+    TEST_CHECK(value_array_to_vector(&v, VALUE_INT32_VECTOR) != 0);
+    TEST_CHECK(value_array_to_vector(&v, VALUE_ARRAY) != 0);
+    value_init_string(value_array_append(&v), "foo");
+    TEST_CHECK(value_array_to_vector(&v, VALUE_DOUBLE_VECTOR) != 0);
+    TEST_CHECK(value_type(&v) == VALUE_ARRAY);
+    TEST_CHECK(value_array_size(&v) == 2);
+    value_fini(&v);
+
+    /* Vector nested in other containers. */
+    value_init_array(&v);
+    item = value_array_append(&v);
+    TEST_CHECK(value_init_double_vector(item, dbl, 2) == 0);
+    item = value_array_append(&v);
+    TEST_CHECK(value_init_float_vector(item, NULL, 1000) == 0);
+    TEST_CHECK(value_float_vector(item)[999] == 0.0f);
+    item = value_array_append(&v);
+    TEST_CHECK(value_init_int64_vector(item, NULL, 0) == 0);
+    TEST_CHECK(value_vector_size(item) == 0);
+    TEST_CHECK(value_vector_reserve(item, 100) == 0);
+    TEST_CHECK(value_double_vector(value_path(&v, "[0]"))[1] == 1.5);
+    value_fini(&v);
+}
+
 static void
 test_dict_basic(void)
 {
@@ -951,6 +1136,91 @@ test_dict_custom_cmp(void)
     value_fini(&d);
 }
 
+static void
+test_dict_intern(void)
+{
+    /* Key long enough to not inline the string inside the value structure. */
+    static const char longkey[] = "some rather long dictionary key";
+
+    VALUE_INTERN* intern;
+    VALUE root;
+    VALUE* a;
+    VALUE* b;
+    VALUE* v;
+    const VALUE* keys_a[8];
+    const VALUE* keys_b[8];
+    int i;
+
+    intern = value_intern_create();
+    TEST_CHECK(intern != NULL);
+    TEST_CHECK(value_intern_size(intern) == 0);
+
+    value_init_dict(&root);
+    TEST_CHECK(value_dict_set_intern(&root, intern) == 0);
+    TEST_CHECK(value_dict_intern(&root) == intern);
+    value_intern_release(intern);   /* The dictionary keeps its own reference. */
+
+    /* Dictionaries created by value_build_path() inherit the table. */
+    a = value_build_path(&root, "records/[]/id");
+    TEST_CHECK(a != NULL  &&  value_init_int32(a, 1) == 0);
+    b = value_build_path(&root, "records/[]/id");
+    TEST_CHECK(b != NULL  &&  value_init_int32(b, 2) == 0);
+    a = value_path(&root, "records/[0]");
+    b = value_path(&root, "records/[1]");
+    TEST_CHECK(value_dict_intern(a) == intern);
+    TEST_CHECK(value_dict_intern(b) == intern);
+
+    /* Cannot be attached to non-empty dictionary. */
+    TEST_CHECK(value_dict_set_intern(a, NULL) != 0);
+
+    value_init_string(value_dict_get_or_add(a, longkey), "a");
+    value_init_string(value_dict_get_or_add(b, longkey), "b");
+    value_init_string(value_dict_get_or_add(b, "only_b"), "b");
+    TEST_CHECK(value_intern_size(intern) == 4);   /* records, id, longkey, only_b */
+
+    /* Same keys share the string buffer. */
+    TEST_CHECK(value_dict_keys_sorted(a, keys_a, 8) == 2);
+    TEST_CHECK(value_dict_keys_sorted(b, keys_b, 8) == 3);
+    TEST_CHECK(value_string(keys_a[0]) == value_string(keys_b[0]));
+    TEST_CHECK(value_string(keys_a[1]) == value_string(keys_b[2]));
+    TEST_CHECK(strcmp(value_string(keys_a[1]), longkey) == 0);
+    TEST_CHECK(value_string_length(keys_a[1]) == strlen(longkey));
+
+    TEST_CHECK(strcmp(value_string(value_dict_get(a, longkey)), "a") == 0);
+    TEST_CHECK(strcmp(value_string(value_dict_get(b, longkey)), "b") == 0);
+    TEST_CHECK(value_dict_get(a, "only_b") == NULL);
+    TEST_CHECK(value_dict_get(a, "n/a") == NULL);
+    TEST_CHECK(value_dict_remove(a, "n/a") != 0);
+
+    /* Interned string lives as long as any dictionary uses it. */
+    TEST_CHECK(value_dict_remove(b, "only_b") == 0);
+    TEST_CHECK(value_intern_size(intern) == 3);
+    TEST_CHECK(value_dict_remove(a, longkey) == 0);
+    TEST_CHECK(value_intern_size(intern) == 3);
+    TEST_CHECK(value_dict_get(b, longkey) != NULL);
+    TEST_CHECK(value_dict_remove(b, longkey) == 0);
+    TEST_CHECK(value_intern_size(intern) == 2);
+
+    /* Many dictionaries, many keys. */
+    for(i = 0; i < 1000; i++) {
+        char key[32];
+        int j;
+
+        v = value_build_path(&root, "records/[]");
+        value_init_dict(v);
+        TEST_CHECK(value_dict_set_intern(v, intern) == 0);
+        for(j = 0; j < 100; j++) {
+            sprintf(key, "key%d", j);
+            value_init_int32(value_dict_get_or_add(v, key), j);
+        }
+        TEST_CHECK(value_dict_verify(v) == 0);
+    }
+    TEST_CHECK(value_intern_size(intern) == 2 + 100);
+    TEST_CHECK(value_int32(value_path(&root, "records/[-1]/key42")) == 42);
+
+    value_fini(&root);
+}
+
 static void
 test_path(void)
 {
@@ -1094,6 +1364,75 @@ test_build_path(void)
 }
 
 
+static void
+test_path_compiled(void)
+{
+    static const char* paths[] = {
+        "", "/", "foo", "/foo/", "foo/bar", "//foo///bar///", "/foo/bar/[0]",
+        "/foo/bar/[2]", "/foo/bar/[3]", "/foo/bar/[-1]", "/foo/bar/[-3]",
+        "/foo/bar/[-4]", "/foo/bar/[]", "/foo/bar/0", "/foo/bar[1]",
+        "/foo/bar[1]/baz", "/foo/bar[-1]/baz", "n/a", "foo/n/a", "[0]"
+    };
+    const int n_paths = sizeof(paths) / sizeof(paths[0]);
+
+    VALUE root;
+    VALUE* foo;
+    VALUE* bar;
+    VALUE* v;
+    VALUE_PATH* compiled[sizeof(paths) / sizeof(paths[0])];
+    VALUE* results[sizeof(paths) / sizeof(paths[0])];
+    VALUE_PATH* p;
+    size_t n_resolved = 0;
+    int i;
+
+    TEST_CHECK(value_init_dict(&root) == 0);
+    foo = value_dict_get_or_add(&root, "foo");
+    TEST_CHECK(value_init_dict(foo) == 0);
+    bar = value_dict_get_or_add(foo, "bar");
+    TEST_CHECK(value_init_array(bar) == 0);
+    TEST_CHECK(value_array_append(bar) != NULL);
+    TEST_CHECK(value_init_dict(value_array_append(bar)) == 0);
+    TEST_CHECK(value_array_append(bar) != NULL);
+    TEST_CHECK(value_dict_get_or_add(value_array_get(bar, 1), "baz") != NULL);
+
+    TEST_CHECK(value_path_compile(NULL) == NULL);
+    TEST_CHECK(value_path_compile("foo/[x]") == NULL);
+    TEST_CHECK(value_path_exec(&root, NULL) == NULL);
+
+    /* Compiled paths have to resolve the same as their textual forms. */
+    for(i = 0; i < n_paths; i++) {
+        compiled[i] = value_path_compile(paths[i]);
+        TEST_CHECK_(compiled[i] != NULL, "compile '%s'", paths[i]);
+        TEST_CHECK_(value_path_exec(&root, compiled[i]) == value_path(&root, paths[i]),
+                    "exec '%s'", paths[i]);
+        if(value_path(&root, paths[i]) != NULL)
+            n_resolved++;
+    }
+
+    /* Batch resolution. */
+    TEST_CHECK(value_path_exec_batch(&root, (const VALUE_PATH* const*) compiled,
+                                     n_paths, results) == n_resolved);
+    for(i = 0; i < n_paths; i++)
+        TEST_CHECK_(results[i] == value_path(&root, paths[i]), "batch '%s'", paths[i]);
+
+    for(i = 0; i < n_paths; i++)
+        value_path_free(compiled[i]);
+
+    /* Building the path. */
+    p = value_path_compile("records/[]/name");
+    for(i = 0; i < 10; i++) {
+        v = value_build_path_exec(&root, p);
+        TEST_CHECK(value_is_new(v));
+        value_init_int32(v, i);
+    }
+    value_path_free(p);
+    TEST_CHECK(value_array_size(value_path(&root, "records")) == 10);
+    TEST_CHECK(value_int32(value_path(&root, "records[-1]/name")) == 9);
+
+    value_fini(&root);
+}
+
+
 TEST_LIST = {
     { "null",               test_null },
     { "bool",               test_bool },
@@ -1108,13 +1447,18 @@ TEST_LIST = {
     { "array-append",       test_array_append },
     { "array-insert",       test_array_insert },
     { "array-remove",       test_array_remove },
+    { "array-bulk",         test_array_bulk },
+    { "array-remove-nested", test_array_remove_nested },
+    { "vector",             test_vector },
     { "dict-basic",         test_dict_basic },
     { "dict-big",           test_dict_big },
     { "dict-remove",        test_dict_remove },
     { "dict-walk-ordered",  test_dict_walk_ordered },
     { "dict-custom-cmp",    test_dict_custom_cmp },
+    { "dict-intern",        test_dict_intern },
     { "path",               test_path },
     { "build-path",         test_build_path },
+    { "path-compiled",      test_path_compiled },
     { 0 }
 };
 
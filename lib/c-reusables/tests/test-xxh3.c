@@ -0,0 +1,366 @@
+/*
+ * C Reusables
+ * <http://github.com/mity/c-reusables>
+ *
+ * Copyright (c) 2020 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "acutest.h"
+#include "xxh3.h"
+
+
+typedef struct TEST_VECTOR {
+    const char* str;
+    size_t n;
+    uint64_t xxh3;
+} TEST_VECTOR;
+
+typedef struct TEST_VECTOR_BUF {
+    size_t n;
+    uint64_t xxh3;          /* seed 0 */
+    uint64_t xxh3_seeded;   /* seed TEST_SEED */
+} TEST_VECTOR_BUF;
+
+
+#define LEN(x)      (sizeof(x)-1)
+#define TEST(x)     x, LEN(x)
+
+#define TEST_SEED   0x9e3779b185ebca8dU
+
+
+/* All the expected values below have been generated with the reference
+ * implementation (XXH3_64bits_withSeed() of xxHash 0.8.2). */
+
+static const TEST_VECTOR test_vectors[] = {
+    { TEST(""), 0x2d06800538d394c2U },
+    { TEST("a"), 0xe6c632b61e964e1fU },
+    { TEST("abc"), 0x78af5f94892f3950U },
+    { TEST("message digest"), 0x160d8e9329be94f9U },
+    { TEST("abcdefghijklmnopqrstuvwxyz"), 0x810f9ca067fbb90cU },
+    { TEST("The quick brown fox jumps over the lazy dog"), 0xce7d19a5418fb365U },
+    { 0 }
+};
+
+/* Prefixes of the pseudo-random buffer made by fill_buffer(). The lengths
+ * are chosen around the boundaries of the respective code paths. */
+static const TEST_VECTOR_BUF test_vectors_buf[] = {
+    {    0, 0x2d06800538d394c2U, 0xa8a6b918b2f0364aU },
+    {    1, 0x937c77989a8a94dfU, 0xd2309af224c4f6ceU },
+    {    2, 0x76f874f3cf19462cU, 0xac0cd757069d01f3U },
+    {    3, 0xb085ec0a6127cc24U, 0x125120b020d662f8U },
+    {    4, 0x00fe6a93599ca9d3U, 0x1e7e83db5daf0077U },
+    {    5, 0x0f6895e82b9b2796U, 0x348e779aff666d0eU },
+    {    8, 0xeac961c1520d887bU, 0x58ca8b8a9618393bU },
+    {    9, 0xae005b6ee477f3d9U, 0x5458be72c8655f00U },
+    {   15, 0xa1d38390244bcb97U, 0xd79282a76e9f4d89U },
+    {   16, 0x209ab5cca7cefbbaU, 0xb8565a25ee1acc5fU },
+    {   17, 0xd62dc04f4f52001aU, 0x15353d717dadae42U },
+    {   32, 0x4ef1b7fda44b8ad9U, 0x8224e4a1ac68c9b6U },
+    {   33, 0x0a1628d7810c95efU, 0xfd90f65d0a92f236U },
+    {   64, 0xeade99f70455fa42U, 0xa217c3e525665289U },
+    {   65, 0x950eda12d4558246U, 0x1c75506ad0289e7fU },
+    {   96, 0x2408e383bf71b457U, 0xb778942098f8d117U },
+    {   97, 0x65558d6cf19a151fU, 0xc036c315e5102a69U },
+    {  128, 0xb9623caae4c91e0fU, 0xc64e662823abbeceU },
+    {  129, 0x460c4159a9cde7dcU, 0xd887873470b33c95U },
+    {  160, 0xb9722092c4fb0becU, 0x0323720cc713e2f8U },
+    {  239, 0x15492345b59f5c8fU, 0x68c6d0f2f981e38cU },
+    {  240, 0xd88af41b708e65f1U, 0xf947e1ee4a7a6f27U },
+    {  241, 0xc9c191d2988def03U, 0x1a4753266d8bf0c5U },
+    {  255, 0x4de328d5fb17892dU, 0x7e48bad400b155fcU },
+    {  256, 0x5f51a8a7a3d6008dU, 0xe34e400a98fcaf38U },
+    {  257, 0x8f24d43c7d4acaaaU, 0xe16e0b6461ffbc01U },
+    { 1023, 0x4483980a9d8f6e38U, 0xd858d5308e4b0a3dU },
+    { 1024, 0x70cae9e7a04d3027U, 0x279b42fccdd288bdU },
+    { 1025, 0x95589abfc51e02d8U, 0x36d31355aedea84bU },
+    { 2048, 0xfbc01229eeeb45ccU, 0x73fa35ac8dafe0adU },
+    { 4096, 0x9708cd901bda18e1U, 0xcebeca82960b4c95U },
+};
+
+#define BUFFER_SIZE     (4096 + 64)
+
+static void
+fill_buffer(uint8_t* buffer, size_t n)
+{
+    uint32_t seed = 2654435761U;
+    size_t i;
+
+    for(i = 0; i < n; i++) {
+        seed = seed * 1103515245U + 12345U;
+        buffer[i] = (uint8_t) (seed >> 16);
+    }
+}
+
+
+static void
+test_vectors_str(void)
+{
+    int i;
+
+    for(i = 0; test_vectors[i].str != NULL; i++) {
+        const char* str = test_vectors[i].str;
+        size_t n = test_vectors[i].n;
+        uint64_t expected = test_vectors[i].xxh3;
+        uint64_t produced;
+
+        produced = xxh3_64(0, str, n);
+        if(!TEST_CHECK_(produced == expected, "vector '%.*s'", (int)n, str)) {
+            TEST_MSG("Expected: %016llx", (unsigned long long) expected);
+            TEST_MSG("Produced: %016llx", (unsigned long long) produced);
+        }
+    }
+}
+
+static void
+test_vectors_buffer(void)
+{
+    static uint8_t buffer[BUFFER_SIZE];
+    int i;
+
+    fill_buffer(buffer, sizeof(buffer));
+
+    for(i = 0; i < (int)(sizeof(test_vectors_buf) / sizeof(test_vectors_buf[0])); i++) {
+        size_t n = test_vectors_buf[i].n;
+        uint64_t produced;
+
+        produced = xxh3_64(0, buffer, n);
+        if(!TEST_CHECK_(produced == test_vectors_buf[i].xxh3, "length %u", (unsigned) n))
+            TEST_MSG("Produced: %016llx", (unsigned long long) produced);
+
+        produced = xxh3_64(TEST_SEED, buffer, n);
+        if(!TEST_CHECK_(produced == test_vectors_buf[i].xxh3_seeded, "length %u (seeded)", (unsigned) n))
+            TEST_MSG("Produced: %016llx", (unsigned long long) produced);
+
+        /* Unaligned input must give the same result. */
+        memmove(buffer + 3, buffer, n);
+        TEST_CHECK_(xxh3_64(0, buffer + 3, n) == test_vectors_buf[i].xxh3, "length %u (unaligned)", (unsigned) n);
+        fill_buffer(buffer, sizeof(buffer));
+    }
+}
+
+static void
+test_streaming(void)
+{
+    static uint8_t buffer[BUFFER_SIZE];
+    static const size_t steps[] = { 1, 7, 63, 64, 65, 255, 256, 257, 1000 };
+    XXH3_STATE state;
+    int i, j;
+
+    fill_buffer(buffer, sizeof(buffer));
+
+    for(i = 0; i < (int)(sizeof(test_vectors_buf) / sizeof(test_vectors_buf[0])); i++) {
+        size_t n = test_vectors_buf[i].n;
+
+        for(j = 0; j < (int)(sizeof(steps) / sizeof(steps[0])); j++) {
+            size_t pos = 0;
+            size_t step;
+
+            xxh3_init(&state, TEST_SEED);
+            while(pos < n) {
+                step = (steps[j] < n - pos) ? steps[j] : n - pos;
+                xxh3_update(&state, buffer + pos, step);
+                pos += step;
+
+                /* The digest does not consume the state. */
+                if(pos < n) {
+                    if(!TEST_CHECK_(xxh3_final(&state) == xxh3_64(TEST_SEED, buffer, pos),
+                                "intermediate digest [length %u, step %u, pos %u]",
+                                (unsigned) n, (unsigned) steps[j], (unsigned) pos))
+                        break;
+                }
+            }
+
+            TEST_CHECK_(xxh3_final(&state) == test_vectors_buf[i].xxh3_seeded,
+                        "length %u, step %u", (unsigned) n, (unsigned) steps[j]);
+        }
+    }
+
+    /* Empty updates are no-ops. */
+    xxh3_init(&state, 0);
+    xxh3_update(&state, NULL, 0);
+    TEST_CHECK(xxh3_final(&state) == test_vectors_buf[0].xxh3);
+}
+
+
+/* SMHasher-style quality checks.
+ *
+ * These are much smaller than the real SMHasher runs (to keep the test fast)
+ * but they reliably catch broken mixing: e.g. input bits not reaching some
+ * output bits, or structured keys mapping to few distinct values. */
+
+static uint64_t
+rand64(uint64_t* state)
+{
+    /* splitmix64 */
+    uint64_t z = (*state += 0x9e3779b97f4a7c15U);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9U;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebU;
+    return z ^ (z >> 31);
+}
+
+/* Avalanche: Flipping any single input bit should flip each output bit with
+ * probability 1/2. */
+static void
+test_avalanche(void)
+{
+    static const size_t lengths[] = { 3, 4, 8, 12, 16, 24, 100, 200, 300 };
+    #define AVALANCHE_KEYS      300
+    uint64_t rng = 1;
+    uint8_t key[300];
+    int i;
+
+    for(i = 0; i < (int)(sizeof(lengths) / sizeof(lengths[0])); i++) {
+        size_t n = lengths[i];
+        unsigned flips[64] = { 0 };
+        unsigned total = 0;
+        double worst = 0.0;
+        size_t bit;
+        int k, b;
+
+        for(k = 0; k < AVALANCHE_KEYS; k++) {
+            uint64_t h0;
+
+            for(b = 0; b < (int) n; b++)
+                key[b] = (uint8_t) rand64(&rng);
+            h0 = xxh3_64(0, key, n);
+
+            for(bit = 0; bit < n * 8; bit++) {
+                uint64_t diff;
+
+                key[bit / 8] ^= (uint8_t) (1U << (bit % 8));
+                diff = h0 ^ xxh3_64(0, key, n);
+                key[bit / 8] ^= (uint8_t) (1U << (bit % 8));
+
+                for(b = 0; b < 64; b++)
+                    flips[b] += (unsigned) ((diff >> b) & 1);
+                total++;
+            }
+        }
+
+        for(b = 0; b < 64; b++) {
+            double bias = (double) flips[b] / (double) total - 0.5;
+            if(bias < 0.0)
+                bias = -bias;
+            if(bias > worst)
+                worst = bias;
+        }
+
+        /* With thousands of samples per output bit, a good hash stays well
+         * under 2 % bias. */
+        if(!TEST_CHECK_(worst < 0.02, "avalanche bias for length %u", (unsigned) n))
+            TEST_MSG("Worst bias: %.4f", worst);
+    }
+}
+
+static int
+cmp_u64(const void* a, const void* b)
+{
+    uint64_t x = *(const uint64_t*) a;
+    uint64_t y = *(const uint64_t*) b;
+    return (x < y) ? -1 : (x > y) ? +1 : 0;
+}
+
+/* Count collisions of the lowest 'bits' bits among n hashes. */
+static unsigned
+count_collisions(uint64_t* hashes, size_t n, int bits)
+{
+    uint64_t mask = ((uint64_t) 1 << bits) - 1;
+    unsigned collisions = 0;
+    size_t i;
+
+    for(i = 0; i < n; i++)
+        hashes[i] &= mask;
+    qsort(hashes, n, sizeof(uint64_t), cmp_u64);
+    for(i = 1; i < n; i++) {
+        if(hashes[i] == hashes[i-1])
+            collisions++;
+    }
+    return collisions;
+}
+
+/* Sparse and sequential keys (the typical weak spot of simple hashes): The
+ * number of collisions in the low 32 bits should match the birthday bound. */
+static void
+test_collisions(void)
+{
+    #define COLL_KEYS       (256 * 1024)
+    uint64_t* hashes;
+    uint8_t key[32];
+    double expected;
+    unsigned coll;
+    size_t i;
+
+    hashes = (uint64_t*) malloc(COLL_KEYS * sizeof(uint64_t));
+    if(!TEST_CHECK(hashes != NULL))
+        return;
+
+    /* n^2 / 2^33 */
+    expected = (double) COLL_KEYS * (double) COLL_KEYS / 8589934592.0;
+
+    /* Sequential 8-byte integers. */
+    for(i = 0; i < COLL_KEYS; i++) {
+        uint64_t v = i;
+        memcpy(key, &v, 8);
+        hashes[i] = xxh3_64(0, key, 8);
+    }
+    coll = count_collisions(hashes, COLL_KEYS, 32);
+    if(!TEST_CHECK_(coll <= 3 * expected + 10, "sequential keys"))
+        TEST_MSG("Collisions: %u (expected about %.1f)", coll, expected);
+
+    /* 64-byte keys with exactly two bits set (all 130816 of them). */
+    {
+        uint8_t sparse[64];
+        size_t n = 0;
+        size_t b1, b2;
+
+        for(b1 = 0; b1 < 512; b1++) {
+            for(b2 = b1 + 1; b2 < 512; b2++) {
+                memset(sparse, 0, sizeof(sparse));
+                sparse[b1 / 8] |= (uint8_t) (1U << (b1 % 8));
+                sparse[b2 / 8] |= (uint8_t) (1U << (b2 % 8));
+                hashes[n++] = xxh3_64(0, sparse, sizeof(sparse));
+            }
+        }
+        coll = count_collisions(hashes, n, 32);
+        if(!TEST_CHECK_(coll <= 3 * ((double) n * (double) n / 8589934592.0) + 10, "sparse keys"))
+            TEST_MSG("Collisions: %u", coll);
+    }
+
+    /* The same key with different seeds. */
+    memset(key, 'x', sizeof(key));
+    for(i = 0; i < COLL_KEYS; i++)
+        hashes[i] = xxh3_64((uint64_t) i, key, 20);
+    coll = count_collisions(hashes, COLL_KEYS, 32);
+    if(!TEST_CHECK_(coll <= 3 * expected + 10, "seeds"))
+        TEST_MSG("Collisions: %u (expected about %.1f)", coll, expected);
+
+    free(hashes);
+}
+
+
+TEST_LIST = {
+    { "vectors",        test_vectors_str },
+    { "vectors-buffer", test_vectors_buffer },
+    { "streaming",      test_streaming },
+    { "avalanche",      test_avalanche },
+    { "collisions",     test_collisions },
+    { 0 }
+};
@@ -24,8 +24,11 @@
 #include "debug.h"
 #include "misc.h"
 
+#include "c-reusables/encode/hex.h"
+
 #include <stdio.h>
 #include <stdarg.h>
+#include <string.h>
 
 
 /*********************
@@ -34,8 +37,6 @@
 
 #if defined DEBUG && DEBUG >= 1
 
-#define DEBUG_DUMP_PER_LINE         16
-
 void
 MC_TRACE(const char* fmt, ...)
 {
@@ -68,26 +69,17 @@ MC_DUMP(const char* msg, void* addr, size_t n)
     BYTE* bytes = (BYTE*) addr;
     size_t offset = 0;
     size_t count;
-    char buffer[32 + 3 * DEBUG_DUMP_PER_LINE];
-    char* ptr;
-    int i;
+    char buffer[4 + HEX_DUMP_LINE_SIZE];
 
     last_error = GetLastError();
     MC_TRACE(msg);
 
+    memcpy(buffer, "    ", 4);
     while(offset < n) {
-        count = MC_MIN(n - offset, DEBUG_DUMP_PER_LINE);
-
-        ptr = buffer;
-        ptr += sprintf(ptr, "    %04lx:  ", (ULONG) offset);
-
-        for(i = 0; i < count; i++) {
-            ptr += sprintf(ptr, " %02x", bytes[offset + i]);
-            if(i == DEBUG_DUMP_PER_LINE/2 - 1)
-                ptr += sprintf(ptr, "  ");
-        }
-
-        MC_TRACE(buffer);
+        count = MC_MIN(n - offset, HEX_DUMP_PER_LINE);
+        hex_dump_line(bytes + offset, (unsigned) count, offset,
+                      buffer + 4, HEX_DUMP_LINE_SIZE);
+        MC_TRACE("%s", buffer);
         offset += count;
     }
 
@@ -25,8 +25,12 @@
 #include "labeledit.h"
 #include "mousedrag.h"
 #include "mousewheel.h"
-#include "rgn16.h"
 #include "table.h"
+#include "tableview.h"
+
+#include "c-reusables/data/cellcache.h"
+#include "c-reusables/data/fenwick.h"
+#include "c-reusables/data/region.h"
 
 
 /* Uncomment this to have more verbose traces about MC_GRID control. */
@@ -55,14 +59,36 @@ static const WCHAR grid_listview_tc[] = L"LISTVIEW";
 
 #define GRID_DEFAULT_SIZE               0xffff
 
+/* Default count of cells cached for an asynchronous data provider. */
+#define GRID_DEFAULT_CACHE_SIZE         8192
+
 #define CELL_DEF_PADDING_H              2
 #define CELL_DEF_PADDING_V              1
 
 #define DIVIDER_WIDTH                   10
 #define SMALL_DIVIDER_WIDTH             4
 
-#define COL_INVALID                     0xfffe   /* 0xffff is taken by MC_TABLE_HEADER */
-#define ROW_INVALID                     0xfffe
+/* Internally, we use 32-bit indexes of columns and rows, so that the table
+ * (or the virtual table of an owner data grid) may have more than 65534 rows
+ * (see MC_GM_RESIZEEX). The table uses the same indexes (GRID_HEADER ==
+ * TABLE_HEADER). Note (WORD) GRID_HEADER == MC_TABLE_HEADER, so casting an
+ * index to WORD is all we need to do for the 16-bit messages and
+ * notifications. The other direction has to go through grid_wide_index(). */
+#define GRID_HEADER                     MC_GHEADEREX
+#define COL_INVALID                     0xfffffffe   /* 0xffffffff is taken by GRID_HEADER */
+#define ROW_INVALID                     0xfffffffe
+
+/* Header cells in the cell cache of the asynchronous data provider. (The
+ * cache works with half-open rectangles, so GRID_HEADER + 1 would overflow.) */
+#define GRID_CACHE_HEADER               (GRID_HEADER - 1)
+
+/* Each extended notification has the code of its 16-bit counterpart + 32. */
+#define GRID_GN_EX(code)                ((code) + 32)
+
+/* Private message posted by the worker thread of the cell cache when some
+ * visible cells have been fetched (see grid_fetch_notify()). It takes the
+ * last ID from the range reserved for the grid messages. */
+#define GRID_WM_FETCHED                 MC_GM_LAST
 
 /* Modes for selection dragging (how to apply marquee) */
 #define DRAGSEL_NOOP                    0
@@ -95,6 +121,7 @@ struct grid_tag {
     HTHEME theme_listview;
     HFONT font;
     table_t* table;  /* may be NULL (MC_GS_OWNERDATA, MC_GS_NOTABLECREATE) */
+    table_view_t* view;  /* sort/filter view over the table (created lazily) */
 
     DWORD style                  : 16;
     DWORD no_redraw              :  1;
@@ -111,26 +138,41 @@ struct grid_tag {
     DWORD labeledit_considering  :  1;
     DWORD labeledit_timer        :  1;
     DWORD labeledit_started      :  1;  /* Editing of a label. */
+    DWORD ex_notifications       :  1;  /* MC_GM_RESIZEEX has been used. */
 
     /* If MC_GS_OWNERDATA, we need it here locally. If not, it is a cached
-     * value of table->col_count and table->row_count. */
-    WORD col_count;
-    WORD row_count;
-
-    WORD cache_hint[4];
+     * value of table->col_count and table->row_count (or view->row_count). */
+    DWORD col_count;
+    DWORD row_count;
+
+    DWORD cache_hint[4];
+
+    /* Asynchronous data provider (MC_GS_OWNERDATA only). The provider is
+     * called on the worker thread of the cache. */
+    CELLCACHE* cellcache;
+    DWORD cache_request[4]; /* Visible cells last requested from the cache. */
+    void* data_proc;        /* MC_GDATAPROCW or MC_GDATAPROCA */
+    void* data_ctx;
+    BOOL data_unicode;
+    mc_mutex_t fetch_mutex; /* Guards the members below. */
+    BOOL fetch_posted;      /* GRID_WM_FETCHED is on its way. */
+    CELLCACHE_RECT fetched[3];  /* Fetched visible cells and headers, per
+                                 * rectangle of grid_request_cells(). */
 
     /* Hot cell */
-    WORD hot_col;
-    WORD hot_row;
+    DWORD hot_col;
+    DWORD hot_row;
 
     /* Focused cell (or the cell with edit control if edit was started) */
-    WORD focused_col;
-    WORD focused_row;
+    DWORD focused_col;
+    DWORD focused_row;
 
     /* Selection */
-    rgn16_t selection;
-    WORD selmark_col;   /* selection mark for selecting with <SHIFT> key */
-    WORD selmark_row;
+    REGION selection;
+    REGION_CURSOR sel_cursor;   /* for the hit tests in grid_paint_cell() */
+    MC_GRECT* selection_rects;  /* selection exported for the API (or NULL) */
+    DWORD selmark_col;  /* selection mark for selecting with <SHIFT> key */
+    DWORD selmark_row;
 
     /* Cell geometry */
     WORD padding_h;
@@ -142,6 +184,12 @@ struct grid_tag {
     WORD* col_widths;   /* alloc'ed lazily */
     WORD* row_heights;  /* alloc'ed lazily */
 
+    /* Prefix sums of the effective column widths and row heights, so we can
+     * map between cells and pixel coordinates in O(log n). They are valid
+     * only when col_widths/row_heights are allocated. */
+    FENWICK col_index;
+    FENWICK row_index;
+
     /* Scrolling */
     int scroll_x;
     int scroll_x_max;   /* Sum of column widths (excluding header) */
@@ -155,8 +203,25 @@ static void grid_mouse_move(grid_t* grid, int x, int y);
 static void grid_labeledit_end(grid_t* grid, BOOL cancel);
 
 
+static inline DWORD
+grid_wide_index(WORD index)
+{
+    return (index == MC_TABLE_HEADER ? GRID_HEADER : index);
+}
+
+/* All the row indexes the grid works with are the rows as displayed. With a
+ * sort/filter view, they have to be translated when accessing the table. */
+static inline DWORD
+grid_table_row(grid_t* grid, DWORD row)
+{
+    if(grid->view != NULL  &&  row != GRID_HEADER)
+        return table_view_row(grid->view, row);
+    return row;
+}
+
+
 static inline WORD
-grid_col_width(grid_t* grid, WORD col)
+grid_col_width(grid_t* grid, DWORD col)
 {
     WORD width;
 
@@ -171,8 +236,8 @@ grid_col_width(grid_t* grid, WORD col)
     return width;
 }
 
-static inline  WORD
-grid_row_height(grid_t* grid, WORD row)
+static inline WORD
+grid_row_height(grid_t* grid, DWORD row)
 {
     WORD height;
 
@@ -206,12 +271,44 @@ grid_header_width(grid_t* grid)
 }
 
 static int
-grid_realloc_col_widths(grid_t* grid, WORD old_col_count, WORD new_col_count,
+grid_rebuild_col_index(grid_t* grid, DWORD col_count)
+{
+    int64_t* widths;
+    DWORD col;
+
+    widths = fenwick_build_begin(&grid->col_index, col_count);
+    if(widths == NULL  &&  col_count > 0)
+        return -1;
+
+    for(col = 0; col < col_count; col++)
+        widths[col] = grid_col_width(grid, col);
+    fenwick_build_end(&grid->col_index);
+    return 0;
+}
+
+static int
+grid_rebuild_row_index(grid_t* grid, DWORD row_count)
+{
+    int64_t* heights;
+    DWORD row;
+
+    heights = fenwick_build_begin(&grid->row_index, row_count);
+    if(heights == NULL  &&  row_count > 0)
+        return -1;
+
+    for(row = 0; row < row_count; row++)
+        heights[row] = grid_row_height(grid, row);
+    fenwick_build_end(&grid->row_index);
+    return 0;
+}
+
+static int
+grid_realloc_col_widths(grid_t* grid, DWORD old_col_count, DWORD new_col_count,
                         BOOL cannot_fail)
 {
     WORD* col_widths;
 
-    col_widths = realloc(grid->col_widths, new_col_count * sizeof(WORD));
+    col_widths = realloc(grid->col_widths, (size_t) new_col_count * sizeof(WORD));
     if(MC_ERR(col_widths == NULL)) {
         MC_TRACE("grid_realloc_col_widths: realloc() failed.");
         mc_send_notify(grid->notify_win, grid->win, NM_OUTOFMEMORY);
@@ -230,20 +327,31 @@ grid_realloc_col_widths(grid_t* grid, WORD old_col_count, WORD new_col_count,
     /* Set new columns to the default widths. */
     if(new_col_count > old_col_count) {
         memset(&col_widths[old_col_count], 0xff,
-               (new_col_count - old_col_count) * sizeof(WORD));
+               (size_t) (new_col_count - old_col_count) * sizeof(WORD));
     }
 
     grid->col_widths = col_widths;
+
+    if(MC_ERR(grid_rebuild_col_index(grid, new_col_count) != 0)) {
+        MC_TRACE("grid_realloc_col_widths: grid_rebuild_col_index() failed.");
+        mc_send_notify(grid->notify_win, grid->win, NM_OUTOFMEMORY);
+
+        /* Without the index, we cannot use the widths at all. */
+        free(grid->col_widths);
+        grid->col_widths = NULL;
+        return -1;
+    }
+
     return 0;
 }
 
 static int
-grid_realloc_row_heights(grid_t* grid, WORD old_row_count, WORD new_row_count,
+grid_realloc_row_heights(grid_t* grid, DWORD old_row_count, DWORD new_row_count,
                          BOOL cannot_fail)
 {
     WORD* row_heights;
 
-    row_heights = realloc(grid->row_heights, new_row_count * sizeof(WORD));
+    row_heights = realloc(grid->row_heights, (size_t) new_row_count * sizeof(WORD));
     if(MC_ERR(row_heights == NULL)) {
         MC_TRACE("grid_realloc_row_heights: realloc() failed.");
         mc_send_notify(grid->notify_win, grid->win, NM_OUTOFMEMORY);
@@ -262,119 +370,122 @@ grid_realloc_row_heights(grid_t* grid, WORD old_row_count, WORD new_row_count,
     /* Set new rows to the default heights. */
     if(new_row_count > old_row_count) {
         memset(&row_heights[old_row_count], 0xff,
-               (new_row_count - old_row_count) * sizeof(WORD));
+               (size_t) (new_row_count - old_row_count) * sizeof(WORD));
     }
 
     grid->row_heights = row_heights;
+
+    if(MC_ERR(grid_rebuild_row_index(grid, new_row_count) != 0)) {
+        MC_TRACE("grid_realloc_row_heights: grid_rebuild_row_index() failed.");
+        mc_send_notify(grid->notify_win, grid->win, NM_OUTOFMEMORY);
+
+        /* Without the index, we cannot use the heights at all. */
+        free(grid->row_heights);
+        grid->row_heights = NULL;
+        return -1;
+    }
+
     return 0;
 }
 
 static int
-grid_col2x_adv(grid_t* grid, WORD col0, int x0, WORD col)
+grid_col2x_adv(grid_t* grid, DWORD col0, int x0, DWORD col)
 {
-    WORD i;
-    int x = x0;
-
     if(grid->col_widths == NULL)
-        return x0 + (col-col0) * grid->def_col_width;
+        return x0 + ((int) col - (int) col0) * grid->def_col_width;
 
-    for(i = col0; i < col; i++)
-        x += grid_col_width(grid, i);
-    return x;
+    if(col >= col0)
+        return x0 + (int) fenwick_range_sum(&grid->col_index, col0, col);
+    else
+        return x0 - (int) fenwick_range_sum(&grid->col_index, col, col0);
 }
 
 static inline int
-grid_col2x(grid_t* grid, WORD col)
+grid_col2x(grid_t* grid, DWORD col)
 {
     return grid_col2x_adv(grid, 0, grid_header_width(grid) - grid->scroll_x, col);
 }
 
 static int
-grid_row2y_adv(grid_t* grid, WORD row0, int y0, WORD row)
+grid_row2y_adv(grid_t* grid, DWORD row0, int y0, DWORD row)
 {
-    WORD i;
-    int y = y0;
-
     if(grid->row_heights == NULL)
-        return y0 + (row-row0) * grid->def_row_height;
+        return y0 + ((int) row - (int) row0) * grid->def_row_height;
 
-    for(i = row0; i < row; i++)
-        y += grid_row_height(grid, i);
-    return y;
+    if(row >= row0)
+        return y0 + (int) fenwick_range_sum(&grid->row_index, row0, row);
+    else
+        return y0 - (int) fenwick_range_sum(&grid->row_index, row, row0);
 }
 
 static inline int
-grid_row2y(grid_t* grid, WORD row)
+grid_row2y(grid_t* grid, DWORD row)
 {
     return grid_row2y_adv(grid, 0, grid_header_height(grid) - grid->scroll_y, row);
 }
 
-static WORD
-grid_x2col_adv(grid_t* grid, WORD col0, int x0, int x)
+static DWORD
+grid_x2col_adv(grid_t* grid, DWORD col0, int x0, int x)
 {
-    WORD col;
-    int w;
-
-    if(grid->col_widths == NULL)
+    if(grid->col_widths == NULL) {
+        if(grid->def_col_width == 0)
+            return grid->col_count;
         return col0 + (x - x0) / grid->def_col_width;
-
-    x -= x0;
-    for(col = col0; col < grid->col_count; col++) {
-        w = grid_col_width(grid, col);
-        if(x < w)
-            break;
-        x -= w;
     }
-    return col;
+
+    /* Anything left of col0 maps to col0 itself. Zero-width (hidden)
+     * columns are skipped. Beyond the last column, we get col_count. */
+    if(x < x0)
+        return col0;
+    return (DWORD) fenwick_find(&grid->col_index,
+                (x - x0) + fenwick_prefix_sum(&grid->col_index, col0));
 }
 
-static inline WORD
+static inline DWORD
 grid_x2col(grid_t* grid, int x)
 {
     return grid_x2col_adv(grid, 0, grid_header_width(grid) - grid->scroll_x, x);
 }
 
-static WORD
-grid_y2row_adv(grid_t* grid, WORD row0, int y0, int y)
+static DWORD
+grid_y2row_adv(grid_t* grid, DWORD row0, int y0, int y)
 {
-    WORD row;
-    int h;
-
-    if(grid->row_heights == NULL)
+    if(grid->row_heights == NULL) {
+        if(grid->def_row_height == 0)
+            return grid->row_count;
         return row0 + (y - y0) / grid->def_row_height;
-
-    y -= y0;
-    for(row = row0; row < grid->row_count; row++) {
-        h = grid_row_height(grid, row);
-        if(y < h)
-            break;
-        y -= h;
     }
-    return row;
+
+    /* Anything above row0 maps to row0 itself. Zero-height (hidden) rows
+     * are skipped. Beyond the last row, we get row_count. */
+    if(y < y0)
+        return row0;
+    return (DWORD) fenwick_find(&grid->row_index,
+                (y - y0) + fenwick_prefix_sum(&grid->row_index, row0));
 }
 
-static inline WORD
+static inline DWORD
 grid_y2row(grid_t* grid, int y)
 {
     return grid_y2row_adv(grid, 0, grid_header_height(grid) - grid->scroll_y, y);
 }
 
 static void
-grid_region_rect(grid_t* grid, WORD col0, WORD row0,
-                 WORD col1, WORD row1, RECT* rect)
+grid_region_rect(grid_t* grid, DWORD col0, DWORD row0,
+                 DWORD col1, DWORD row1, RECT* rect)
 {
     int header_w, header_h;
 
     /* Note: Caller may never mix header and ordinary cells in one call,
      * because the latter is scrolled area, while the headers are not. Hence
      * it does not make any sense to mix theme together. */
-    MC_ASSERT(col1 > col0  ||  col0 == MC_TABLE_HEADER);
-    MC_ASSERT(row1 > row0  ||  row0 == MC_TABLE_HEADER);
+    MC_ASSERT(col1 > col0  ||  col0 == GRID_HEADER);
+    MC_ASSERT(row1 > row0  ||  row0 == GRID_HEADER);
 
     header_w = grid_header_width(grid);
     header_h = grid_header_height(grid);
 
-    if(col0 == MC_TABLE_HEADER) {
+    if(col0 == GRID_HEADER) {
         rect->left = 0;
         rect->right = header_w;
     } else {
@@ -382,7 +493,7 @@ grid_region_rect(grid_t* grid, WORD col0, WORD row0,
         rect->right = grid_col2x_adv(grid, col0, rect->left, col1);
     }
 
-    if(row0 == MC_TABLE_HEADER) {
+    if(row0 == GRID_HEADER) {
         rect->top = 0;
         rect->bottom = header_h;
     } else {
@@ -392,7 +503,7 @@ grid_region_rect(grid_t* grid, WORD col0, WORD row0,
 }
 
 static inline void
-grid_cell_rect(grid_t* grid, WORD col, WORD row, RECT* rect)
+grid_cell_rect(grid_t* grid, DWORD col, DWORD row, RECT* rect)
 {
     grid_region_rect(grid, col, row, col+1, row+1, rect);
 }
@@ -622,11 +733,11 @@ grid_setup_scrollbars(grid_t* grid, BOOL recalc_max)
 }
 
 static TCHAR*
-grid_alphabetic_number(TCHAR buffer[16], WORD num)
+grid_alphabetic_number(TCHAR buffer[16], DWORD num)
 {
     static const int digit_count = _T('Z') - _T('A');
     TCHAR* ptr;
-    WORD digit;
+    DWORD digit;
 
     num++;
     buffer[15] = _T('\0');
@@ -648,25 +759,360 @@ grid_alphabetic_number(TCHAR buffer[16], WORD num)
     return ptr;
 }
 
+/* Notifications carrying cell data come in two variants: MC_NMGDISPINFO with
+ * 16-bit indexes and, in the extended mode, MC_NMGDISPINFOEX. */
+typedef union grid_nmdispinfo_tag grid_nmdispinfo_t;
+union grid_nmdispinfo_tag {
+    NMHDR hdr;
+    MC_NMGDISPINFO classic;
+    MC_NMGDISPINFOEX ex;
+};
+
+/* Setup the header and the cell indexes of the notification. The code is
+ * that of the 16-bit variant. Returns pointer to the cell member. */
+static MC_TABLECELL*
+grid_nmdispinfo_init(grid_t* grid, grid_nmdispinfo_t* info, UINT code,
+                     DWORD col, DWORD row)
+{
+    info->hdr.hwndFrom = grid->win;
+    info->hdr.idFrom = GetWindowLong(grid->win, GWL_ID);
+
+    if(grid->ex_notifications) {
+        info->hdr.code = GRID_GN_EX(code);
+        info->ex.dwColumn = col;
+        info->ex.dwRow = row;
+        return &info->ex.cell;
+    } else {
+        info->hdr.code = code;
+        info->classic.wColumn = (WORD) col;
+        info->classic.wRow = (WORD) row;
+        return &info->classic.cell;
+    }
+}
+
 typedef struct grid_dispinfo_tag grid_dispinfo_t;
 struct grid_dispinfo_tag {
     TCHAR* text;
     DWORD flags;
     LPARAM lp;
+    BOOL free_text;
+    TCHAR buffer[TABLE_VALUE_BUFSIZE];  /* For formatted values of typed columns. */
 };
 
+/* With the asynchronous data provider, the cache keeps the data of each cell
+ * as the flags (DWORD) followed by the zero-terminated text (TCHAR[]). If the
+ * provider gives no text, there are just the flags. */
+static int
+grid_fetch_cell(CELLCACHE* cache, uint32_t x, uint32_t y, void* ctx)
+{
+    grid_t* grid = (grid_t*) ctx;
+    MC_NMGDISPINFOEX info;
+    TCHAR* text;
+    size_t len;
+    BYTE* data;
+    BOOL ok;
+    int ret;
+
+    /* Called on the worker thread of the cache: We cannot send messages to
+     * the control nor to its parent here. grid->data_proc and friends are
+     * stable while the cache lives (see grid_set_data_provider()). */
+    info.hdr.hwndFrom = grid->win;
+    info.hdr.idFrom = GetWindowLong(grid->win, GWL_ID);
+    info.hdr.code = (grid->data_unicode ? MC_GN_GETDISPINFOEXW : MC_GN_GETDISPINFOEXA);
+    info.dwColumn = (x != GRID_CACHE_HEADER ? x : GRID_HEADER);
+    info.dwRow = (y != GRID_CACHE_HEADER ? y : GRID_HEADER);
+    info.cell.fMask = MC_TCMF_TEXT | MC_TCMF_FLAGS;
+    info.cell.pszText = NULL;
+    info.cell.lParam = 0;
+    info.cell.dwFlags = 0;
+
+    if(grid->data_unicode)
+        ok = ((MC_GDATAPROCW) grid->data_proc)((MC_NMGDISPINFOEXW*) &info, grid->data_ctx);
+    else
+        ok = ((MC_GDATAPROCA) grid->data_proc)((MC_NMGDISPINFOEXA*) &info, grid->data_ctx);
+    if(!ok)
+        return -1;
+
+    if(grid->data_unicode == MC_IS_UNICODE) {
+        text = info.cell.pszText;
+    } else {
+        text = mc_str(info.cell.pszText, (grid->data_unicode ? MC_STRW : MC_STRA), MC_STRT);
+        if(MC_ERR(text == NULL  &&  info.cell.pszText != NULL)) {
+            MC_TRACE("grid_fetch_cell: mc_str() failed.");
+            return -1;
+        }
+    }
+
+    len = (text != NULL ? (_tcslen(text) + 1) * sizeof(TCHAR) : 0);
+    data = (BYTE*) malloc(sizeof(DWORD) + len);
+    if(MC_ERR(data == NULL)) {
+        MC_TRACE("grid_fetch_cell: malloc() failed.");
+        ret = -1;
+        goto out;
+    }
+    memcpy(data, &info.cell.dwFlags, sizeof(DWORD));
+    if(text != NULL)
+        memcpy(data + sizeof(DWORD), text, len);
+
+    ret = cellcache_put(cache, x, y, data, sizeof(DWORD) + len);
+    free(data);
+
+out:
+    if(text != info.cell.pszText)
+        free(text);
+    return ret;
+}
+
+static void
+grid_fetch_notify(CELLCACHE* cache, unsigned i, const CELLCACHE_RECT* done, void* ctx)
+{
+    grid_t* grid = (grid_t*) ctx;
+    CELLCACHE_RECT* fetched;
+    BOOL post;
+
+    /* Only the first three rectangles of the request are visible (cells and
+     * headers, see grid_request_cells()); the rest is prefetched ahead of
+     * scrolling. */
+    if(i >= 3)
+        return;
+
+    /* We are on the worker thread, where the geometry of the cells may be
+     * changing under our hands. So just remember what has been fetched and
+     * let the UI thread repaint it. Until it does, more fetches only extend
+     * the rectangles and do not post more messages. */
+    mc_mutex_lock(&grid->fetch_mutex);
+    fetched = &grid->fetched[i];
+    if(fetched->x0 >= fetched->x1  ||  fetched->y0 >= fetched->y1) {
+        *fetched = *done;
+    } else {
+        fetched->x0 = MC_MIN(fetched->x0, done->x0);
+        fetched->y0 = MC_MIN(fetched->y0, done->y0);
+        fetched->x1 = MC_MAX(fetched->x1, done->x1);
+        fetched->y1 = MC_MAX(fetched->y1, done->y1);
+    }
+    post = !grid->fetch_posted;
+    grid->fetch_posted = TRUE;
+    mc_mutex_unlock(&grid->fetch_mutex);
+
+    if(post)
+        MC_POST(grid->win, GRID_WM_FETCHED, 0, 0);
+}
+
+/* Handler of GRID_WM_FETCHED: Repaint the cells fetched by the worker thread
+ * since the last time. */
 static void
-grid_get_dispinfo(grid_t* grid, WORD col, WORD row, table_cell_t* cell,
+grid_fetched(grid_t* grid)
+{
+    CELLCACHE_RECT fetched[3];
+    RECT client;
+    RECT rect;
+    DWORD col0, row0, col1, row1;
+    unsigned i;
+
+    mc_mutex_lock(&grid->fetch_mutex);
+    memcpy(fetched, grid->fetched, sizeof(fetched));
+    memset(grid->fetched, 0, sizeof(grid->fetched));
+    grid->fetch_posted = FALSE;
+    mc_mutex_unlock(&grid->fetch_mutex);
+
+    if(grid->no_redraw)
+        return;
+
+    GetClientRect(grid->win, &client);
+
+    for(i = 0; i < MC_SIZEOF_ARRAY(fetched); i++) {
+        if(fetched[i].x0 >= fetched[i].x1  ||  fetched[i].y0 >= fetched[i].y1)
+            continue;
+
+        /* The grid may have shrunk meanwhile. */
+        if(fetched[i].x0 == GRID_CACHE_HEADER) {
+            col0 = GRID_HEADER;
+            col1 = GRID_HEADER;
+        } else {
+            col0 = fetched[i].x0;
+            col1 = MC_MIN(fetched[i].x1, grid->col_count);
+            if(col0 >= col1)
+                continue;
+        }
+        if(fetched[i].y0 == GRID_CACHE_HEADER) {
+            row0 = GRID_HEADER;
+            row1 = GRID_HEADER;
+        } else {
+            row0 = fetched[i].y0;
+            row1 = MC_MIN(fetched[i].y1, grid->row_count);
+            if(row0 >= row1)
+                continue;
+        }
+
+        /* The cells have been painted empty (on a miss), so there is no need
+         * to erase them. */
+        grid_region_rect(grid, col0, row0, col1, row1, &rect);
+        if(IntersectRect(&rect, &rect, &client))
+            InvalidateRect(grid->win, &rect, FALSE);
+    }
+}
+
+static inline uint32_t
+grid_cache_index(DWORD index)
+{
+    return (index != GRID_HEADER ? index : GRID_CACHE_HEADER);
+}
+
+static void
+grid_request_cells(grid_t* grid, DWORD col0, DWORD row0, DWORD col1, DWORD row1)
+{
+    CELLCACHE_RECT rects[5];
+    DWORD page;
+
+    /* Visible cells. */
+    rects[0].x0 = col0;
+    rects[0].y0 = row0;
+    rects[0].x1 = col1 + 1;
+    rects[0].y1 = row1 + 1;
+
+    /* Visible headers (only those painted from the app's data). */
+    memset(&rects[1], 0, 2 * sizeof(CELLCACHE_RECT));
+    if((grid->style & MC_GS_COLUMNHEADERMASK) == MC_GS_COLUMNHEADERNORMAL) {
+        rects[1].x0 = col0;
+        rects[1].y0 = GRID_CACHE_HEADER;
+        rects[1].x1 = col1 + 1;
+        rects[1].y1 = GRID_CACHE_HEADER + 1;
+    }
+    if((grid->style & MC_GS_ROWHEADERMASK) == MC_GS_ROWHEADERNORMAL) {
+        rects[2].x0 = GRID_CACHE_HEADER;
+        rects[2].y0 = row0;
+        rects[2].x1 = GRID_CACHE_HEADER + 1;
+        rects[2].y1 = row1 + 1;
+    }
+
+    /* A page below and a page above, ahead of scrolling. */
+    page = row1 - row0 + 1;
+    rects[3].x0 = col0;
+    rects[3].y0 = row1 + 1;
+    rects[3].x1 = col1 + 1;
+    rects[3].y1 = (grid->row_count - (row1 + 1) > page ? row1 + 1 + page : grid->row_count);
+    rects[4].x0 = col0;
+    rects[4].y0 = (row0 > page ? row0 - page : 0);
+    rects[4].x1 = col1 + 1;
+    rects[4].y1 = row0;
+
+    if(MC_ERR(cellcache_request(grid->cellcache, rects, MC_SIZEOF_ARRAY(rects)) != 0))
+        MC_TRACE("grid_request_cells: cellcache_request() failed.");
+}
+
+/* Ask the cache for the cells in the whole client area (and around it). We
+ * do not use the dirty rect of grid_paint() for this, as repainting of a
+ * single cell would replace the still pending request. */
+static void
+grid_request_visible(grid_t* grid)
+{
+    RECT client;
+    DWORD col0, row0, col1, row1;
+
+    if(grid->col_count == 0  ||  grid->row_count == 0)
+        return;
+
+    GetClientRect(grid->win, &client);
+    col0 = MC_MIN(grid_x2col(grid, grid_header_width(grid)), grid->col_count - 1);
+    row0 = MC_MIN(grid_y2row(grid, grid_header_height(grid)), grid->row_count - 1);
+    col1 = MC_MIN(grid_x2col(grid, client.right - 1), grid->col_count - 1);
+    row1 = MC_MIN(grid_y2row(grid, client.bottom - 1), grid->row_count - 1);
+    col1 = MC_MAX(col0, col1);
+    row1 = MC_MAX(row0, row1);
+
+    if(col0 == grid->cache_request[0]  &&  row0 == grid->cache_request[1]  &&
+       col1 == grid->cache_request[2]  &&  row1 == grid->cache_request[3])
+        return;
+
+    grid_request_cells(grid, col0, row0, col1, row1);
+    grid->cache_request[0] = col0;
+    grid->cache_request[1] = row0;
+    grid->cache_request[2] = col1;
+    grid->cache_request[3] = row1;
+}
+
+static inline void
+grid_reset_request(grid_t* grid)
+{
+    grid->cache_request[0] = COL_INVALID;
+}
+
+static void
+grid_get_cached_dispinfo(grid_t* grid, DWORD col, DWORD row,
+                         grid_dispinfo_t* di, DWORD mask)
+{
+    BYTE buf[sizeof(DWORD) + sizeof(di->buffer)];
+    BYTE* data = buf;
+    size_t size;
+
+    di->text = NULL;
+    di->flags = 0;
+
+    col = grid_cache_index(col);
+    row = grid_cache_index(row);
+
+    /* Never wait for the data: On a miss, paint the cell empty. It gets
+     * repainted when the worker thread fetches it. */
+    if(cellcache_get(grid->cellcache, col, row, buf, sizeof(buf), &size) != 0)
+        return;
+
+    if(size > sizeof(buf)) {
+        size_t alloc_size = size;
+
+        data = (BYTE*) malloc(alloc_size);
+        if(MC_ERR(data == NULL)) {
+            MC_TRACE("grid_get_cached_dispinfo: malloc() failed.");
+            memcpy(&di->flags, buf, sizeof(DWORD));
+            return;
+        }
+        /* The cell may have been evicted or refetched meanwhile. */
+        if(cellcache_get(grid->cellcache, col, row, data, alloc_size, &size) != 0  ||
+           size > alloc_size) {
+            free(data);
+            return;
+        }
+    }
+
+    memcpy(&di->flags, data, sizeof(DWORD));
+    if((mask & MC_TCMF_TEXT)  &&  size > sizeof(DWORD)) {
+        if(data == buf) {
+            memcpy(di->buffer, data + sizeof(DWORD), size - sizeof(DWORD));
+            di->text = di->buffer;
+        } else {
+            /* Reuse the buffer for the text. */
+            memmove(data, data + sizeof(DWORD), size - sizeof(DWORD));
+            di->text = (TCHAR*) data;
+            di->free_text = TRUE;
+            return;
+        }
+    }
+
+    if(data != buf)
+        free(data);
+}
+
+static void
+grid_get_dispinfo(grid_t* grid, DWORD col, DWORD row, table_cell_t* cell,
                   grid_dispinfo_t* di, DWORD mask)
 {
-    MC_NMGDISPINFO info;
+    grid_nmdispinfo_t info;
+    MC_TABLECELL* info_cell;
 
     MC_ASSERT((mask & ~(MC_TCMF_TEXT | MC_TCMF_PARAM | MC_TCMF_FLAGS)) == 0);
 
+    di->free_text = FALSE;
+
     /* Use what can be taken from the cell. */
     if(cell != NULL) {
         if(cell->text != MC_LPSTR_TEXTCALLBACK) {
             di->text = cell->text;
+            /* Values of typed columns are not stored as cell->text. */
+            if(di->text == NULL  &&  (mask & MC_TCMF_TEXT)  &&
+               col != GRID_HEADER  &&  row != GRID_HEADER) {
+                di->text = table_cell_text(grid->table, col,
+                                grid_table_row(grid, row),
+                                di->buffer, MC_SIZEOF_ARRAY(di->buffer));
+            }
             mask &= ~MC_TCMF_TEXT;
         }
 
@@ -678,35 +1124,41 @@ grid_get_dispinfo(grid_t* grid, WORD col, WORD row, table_cell_t* cell,
 
         if(mask == 0)
             return;
+    } else if(grid->cellcache != NULL  &&  !(mask & MC_TCMF_PARAM)  &&
+              (col != GRID_HEADER  ||  row != GRID_HEADER)) {
+        /* The asynchronous data provider does not give us lParam (nor the
+         * dead top left cell, which we never request). */
+        grid_get_cached_dispinfo(grid, col, row, di, mask);
+        return;
     }
 
     /* For the rest data, fire MC_GN_GETDISPINFO notification. */
-    info.hdr.hwndFrom = grid->win;
-    info.hdr.idFrom = GetWindowLong(grid->win, GWL_ID);
-    info.hdr.code = (grid->unicode_notifications ? MC_GN_GETDISPINFOW : MC_GN_GETDISPINFOA);
-    info.wColumn = col;
-    info.wRow = row;
-    info.cell.fMask = mask;
-    /* Set info.cell members to meaningful values. lParam may be needed by the
+    info_cell = grid_nmdispinfo_init(grid, &info,
+                (grid->unicode_notifications ? MC_GN_GETDISPINFOW : MC_GN_GETDISPINFOA),
+                col, row);
+    info_cell->fMask = mask;
+    /* Set info_cell members to meaningful values. lParam may be needed by the
      * app to find the requested data. Other members should be set to some
      * defaults to deal with broken apps which do not set the asked members. */
     if(cell != NULL) {
-        info.cell.pszText = NULL;
-        info.cell.lParam = cell->lp;
-        info.cell.dwFlags = cell->flags;
+        info_cell->pszText = NULL;
+        info_cell->lParam = cell->lp;
+        info_cell->dwFlags = cell->flags;
     } else {
-        info.cell.pszText = NULL;
-        info.cell.lParam = 0;
-        info.cell.dwFlags = 0;
+        info_cell->pszText = NULL;
+        info_cell->lParam = 0;
+        info_cell->dwFlags = 0;
     }
     MC_SEND(grid->notify_win, WM_NOTIFY, info.hdr.idFrom, &info);
 
     /* If needed, convert the text from parent to the expected format. */
     if(mask & MC_TCMF_TEXT) {
-        if(grid->unicode_notifications == MC_IS_UNICODE)
-            di->text = info.cell.pszText;
-        else
-            di->text = mc_str(info.cell.pszText, (grid->unicode_notifications ? MC_STRW : MC_STRA), MC_STRT);
+        if(grid->unicode_notifications == MC_IS_UNICODE) {
+            di->text = info_cell->pszText;
+        } else {
+            di->text = mc_str(info_cell->pszText, (grid->unicode_notifications ? MC_STRW : MC_STRA), MC_STRT);
+            di->free_text = TRUE;
+        }
     } else {
         /* Needed even when not asked for because of grid_free_dispinfo() */
         di->text = NULL;
@@ -715,19 +1167,18 @@ grid_get_dispinfo(grid_t* grid, WORD col, WORD row, table_cell_t* cell,
     /* Small optimization: We do not ask about the corresponding bits in the
      * mask for these. If not set, the assignment does no hurt and we save few
      * instructions. */
-    di->flags = info.cell.dwFlags;
+    di->flags = info_cell->dwFlags;
 }
 
 static inline void
 grid_free_dispinfo(grid_t* grid, table_cell_t* cell, grid_dispinfo_t* di)
 {
-    if(grid->unicode_notifications != MC_IS_UNICODE  &&
-       (cell == NULL || di->text != cell->text)  &&  di->text != NULL)
+    if(di->free_text  &&  di->text != NULL)
         free(di->text);
 }
 
 static void
-grid_paint_cell(grid_t* grid, WORD col, WORD row, table_cell_t* cell,
+grid_paint_cell(grid_t* grid, DWORD col, DWORD row, table_cell_t* cell,
                 HDC dc, RECT* rect, int control_cd_mode, MC_NMGCUSTOMDRAW* cd)
 {
     RECT content;
@@ -740,7 +1191,7 @@ grid_paint_cell(grid_t* grid, WORD col, WORD row, table_cell_t* cell,
     COLORREF text_color;
     COLORREF back_color;
 
-    is_selected = rgn16_contains_xy(&grid->selection, col, row);
+    is_selected = region_cursor_contains_xy(&grid->sel_cursor, col, row);
 
     /* If we are currently dragging a selection marquee, we want to display
      * selection state which would result from it if the user ends it right
@@ -789,7 +1240,7 @@ grid_paint_cell(grid_t* grid, WORD col, WORD row, table_cell_t* cell,
     is_hot = (col == grid->hot_col  &&  row == grid->hot_row  &&
               col < grid->col_count  &&  row < grid->row_count);  /* <-- avoid headers */
 
-    if(col == MC_TABLE_HEADER  &&  row == MC_TABLE_HEADER) {
+    if(col == GRID_HEADER  &&  row == GRID_HEADER) {
         grid_get_dispinfo(grid, col, row, cell, &di, MC_TCMF_FLAGS);
         di.text = NULL;
     } else {
@@ -810,6 +1261,8 @@ grid_paint_cell(grid_t* grid, WORD col, WORD row, table_cell_t* cell,
         cd->nmcd.dwDrawStage = CDDS_ITEMPREPAINT;
         mc_rect_copy(&cd->nmcd.rc, rect);
         cd->nmcd.dwItemSpec = (DWORD)MAKELONG(col, row);
+        cd->dwColumn = col;
+        cd->dwRow = row;
         cd->nmcd.uItemState = 0;
         if(is_selected)
             cd->nmcd.uItemState |= CDIS_SELECTED;
@@ -835,7 +1288,7 @@ grid_paint_cell(grid_t* grid, WORD col, WORD row, table_cell_t* cell,
     content.bottom = rect->bottom - grid->padding_v;
 
     /* Paint cell background */
-    if(col != MC_TABLE_HEADER  &&  row != MC_TABLE_HEADER) {
+    if(col != GRID_HEADER  &&  row != GRID_HEADER) {
         if(grid->theme_listitem_defined) {
             if(!IsWindowEnabled(grid->win)) {
                 state = LISS_DISABLED;
@@ -903,8 +1356,8 @@ grid_paint_cell(grid_t* grid, WORD col, WORD row, table_cell_t* cell,
 }
 
 static void
-grid_paint_header_cell(grid_t* grid, WORD col, WORD row, table_cell_t* cell,
-                       HDC dc, RECT* rect, int index, DWORD style,
+grid_paint_header_cell(grid_t* grid, DWORD col, DWORD row, table_cell_t* cell,
+                       HDC dc, RECT* rect, DWORD index, DWORD style,
                        int control_cd_mode, MC_NMGCUSTOMDRAW* cd)
 {
     table_cell_t tmp;
@@ -924,7 +1377,7 @@ grid_paint_header_cell(grid_t* grid, WORD col, WORD row, table_cell_t* cell,
         if(fabricate == MC_GS_COLUMNHEADERNUMBERED  ||
            fabricate == MC_GS_ROWHEADERNUMBERED)
         {
-            _stprintf(buffer, _T("%d"), index + 1);
+            _stprintf(buffer, _T("%lu"), (unsigned long) index + 1);
             tmp.text = buffer;
         } else {
             MC_ASSERT(fabricate == MC_GS_COLUMNHEADERALPHABETIC  ||
@@ -967,11 +1420,11 @@ grid_paint(void* control, HDC dc, RECT* dirty, BOOL erase)
     RECT rect;
     int header_w, header_h;
     int gridline_w;
-    int col0, row0;
+    DWORD col0, row0;
     int x0, y0;
-    int col, row;
-    int col_count = grid->col_count;
-    int row_count = grid->row_count;
+    DWORD col, row;
+    DWORD col_count = grid->col_count;
+    DWORD row_count = grid->row_count;
     table_t* table = grid->table;
     table_cell_t* cell;
     MC_NMGCUSTOMDRAW cd = { { { 0 }, 0 }, 0 };
@@ -1021,64 +1474,46 @@ grid_paint(void* control, HDC dc, RECT* dirty, BOOL erase)
     if(cd_mode & (CDRF_SKIPDEFAULT | CDRF_DOERASE))
         goto skip_control_paint;
 
-    /* Find 1st column in the dirty area. */
-    rect.left = header_w - grid->scroll_x;
-    col0 = 0;
-    x0 = 0;
-    for(col = 0; col < col_count; col++) {
-        rect.right = rect.left + grid_col_width(grid, col);
-        if(rect.right > header_w  &&  rect.right > dirty->left) {
-            col0 = col;
-            x0 = rect.left;
-            break;
-        }
-        rect.left = rect.right;
-    }
-
-    /* Find 1st row in the dirty area. */
-    row0 = 0;
-    y0 = 0;
-    rect.top = header_h - grid->scroll_y;
-    for(row = 0; row < row_count; row++) {
-        rect.bottom = rect.top + grid_row_height(grid, row);
-        if(rect.bottom > header_h  &&  rect.bottom > dirty->top) {
-            row0 = row;
-            y0 = rect.top;
-            break;
-        }
-        rect.top = rect.bottom;
-    }
+    /* Find 1st column and row in the dirty area. (This does not depend on
+     * the count of rows, so even huge virtual tables paint fast.) */
+    col0 = MC_MIN(grid_x2col(grid, MC_MAX(header_w, dirty->left)), col_count);
+    x0 = grid_col2x(grid, col0);
+    row0 = MC_MIN(grid_y2row(grid, MC_MAX(header_h, dirty->top)), row_count);
+    y0 = grid_row2y(grid, row0);
 
     /* If needed, send MC_GN_ODCACHEHINT */
-    if(grid->style & MC_GS_OWNERDATA) {
-        WORD col1, row1;
+    if((grid->style & MC_GS_OWNERDATA)  &&  col0 < col_count  &&  row0 < row_count) {
+        DWORD col1, row1;
 
-        rect.right = x0;
-        for(col1 = col0; col1+1 < grid->col_count; col1++) {
-            rect.right += grid_col_width(grid, col1);
-            if(rect.right >= dirty->right)
-                break;
-        }
-
-        rect.bottom = y0;
-        for(row1 = row0; row1+1 < grid->row_count; row1++) {
-            rect.bottom += grid_row_height(grid, row1);
-            if(rect.bottom >= dirty->bottom)
-                break;
-        }
+        col1 = MC_MIN(grid_x2col(grid, dirty->right - 1), col_count - 1);
+        col1 = MC_MAX(col0, col1);
+        row1 = MC_MIN(grid_y2row(grid, dirty->bottom - 1), row_count - 1);
+        row1 = MC_MAX(row0, row1);
 
         if(col0 != grid->cache_hint[0] || row0 != grid->cache_hint[1] ||
            col1 != grid->cache_hint[2] || row1 != grid->cache_hint[3]) {
-            MC_NMGCACHEHINT hint;
+            union {
+                NMHDR hdr;
+                MC_NMGCACHEHINT classic;
+                MC_NMGCACHEHINTEX ex;
+            } hint;
 
             hint.hdr.hwndFrom = grid->win;
             hint.hdr.idFrom = GetWindowLong(grid->win, GWL_ID);
-            hint.hdr.code = MC_GN_ODCACHEHINT;
-            hint.wColumnFrom = col0;
-            hint.wRowFrom = row0;
-            hint.wColumnTo = col1;
-            hint.wRowTo = row1;
-            GRID_TRACE("grid_paint: Sending MC_GN_ODCACHEHINT (%hu, %hu, %hu, %hu)",
+            if(grid->ex_notifications) {
+                hint.hdr.code = MC_GN_ODCACHEHINTEX;
+                hint.ex.dwColumnFrom = col0;
+                hint.ex.dwRowFrom = row0;
+                hint.ex.dwColumnTo = col1;
+                hint.ex.dwRowTo = row1;
+            } else {
+                hint.hdr.code = MC_GN_ODCACHEHINT;
+                hint.classic.wColumnFrom = (WORD) col0;
+                hint.classic.wRowFrom = (WORD) row0;
+                hint.classic.wColumnTo = (WORD) col1;
+                hint.classic.wRowTo = (WORD) row1;
+            }
+            GRID_TRACE("grid_paint: Sending MC_GN_ODCACHEHINT (%lu, %lu, %lu, %lu)",
                        col0, row0, col1, row1);
             MC_SEND(grid->notify_win, WM_NOTIFY, hint.hdr.idFrom, &hint);
 
@@ -1087,15 +1522,22 @@ grid_paint(void* control, HDC dc, RECT* dirty, BOOL erase)
             grid->cache_hint[2] = col1;
             grid->cache_hint[3] = row1;
         }
+
+        if(grid->cellcache != NULL)
+            grid_request_visible(grid);
     }
 
+    /* We paint in the row-major order (after the headers), so the cursor
+     * makes the selection hit tests cheap even for complex selections. */
+    region_cursor_init(&grid->sel_cursor, &grid->selection);
+
     /* Paint the "dead" top left header cell */
     if(header_w > 0  &&  header_h > 0  &&
        dirty->left < header_w  &&  dirty->top < header_h)
     {
         mc_rect_set(&rect, 0, 0, grid->header_width, grid->header_height);
-        grid_paint_header_cell(grid, MC_TABLE_HEADER, MC_TABLE_HEADER, NULL, dc,
-                               &rect, -1, 0, cd_mode, &cd);
+        grid_paint_header_cell(grid, GRID_HEADER, GRID_HEADER, NULL, dc,
+                               &rect, 0, 0, cd_mode, &cd);
     }
 
     /* Paint column headers */
@@ -1108,7 +1550,7 @@ grid_paint(void* control, HDC dc, RECT* dirty, BOOL erase)
 
         for(col = col0; col < col_count; col++) {
             rect.right = rect.left + grid_col_width(grid, col);
-            grid_paint_header_cell(grid, col, MC_TABLE_HEADER, (table ? &table->cols[col] : NULL),
+            grid_paint_header_cell(grid, col, GRID_HEADER, (table ? &table->cols[col] : NULL),
                                    dc, &rect, col, (grid->style & MC_GS_COLUMNHEADERMASK),
                                    cd_mode, &cd);
             rect.left = rect.right;
@@ -1126,9 +1568,11 @@ grid_paint(void* control, HDC dc, RECT* dirty, BOOL erase)
         mc_clip_set(dc, 0, header_h, header_w, client.bottom);
 
         for(row = row0; row < row_count; row++) {
+            DWORD table_row = grid_table_row(grid, row);
+
             rect.bottom = rect.top + grid_row_height(grid, row);
-            grid_paint_header_cell(grid, MC_TABLE_HEADER, row, (table ? &table->rows[row] : NULL),
-                                   dc, &rect, row, (grid->style & MC_GS_ROWHEADERMASK),
+            grid_paint_header_cell(grid, GRID_HEADER, row, (table ? table_row_header(table, table_row) : NULL),
+                                   dc, &rect, table_row, (grid->style & MC_GS_ROWHEADERMASK),
                                    cd_mode, &cd);
             rect.top = rect.bottom;
             if(rect.top >= dirty->bottom)
@@ -1195,11 +1639,13 @@ grid_paint(void* control, HDC dc, RECT* dirty, BOOL erase)
     mc_clip_set(dc, header_w, header_h, dirty->right, dirty->bottom);
     rect.top = y0;
     for(row = row0; row < row_count; row++) {
+        DWORD table_row = grid_table_row(grid, row);
+
         rect.bottom = rect.top + grid_row_height(grid, row) - gridline_w;
         rect.left = x0;
         for(col = col0; col < col_count; col++) {
             if(table != NULL)
-                cell = table_cell(table, col, row);
+                cell = table_cell(table, col, table_row);
             else
                 cell = NULL;
             rect.right = rect.left + grid_col_width(grid, col) - gridline_w;
@@ -1257,7 +1703,7 @@ skip_control_paint:
 }
 
 static inline void
-grid_invalidate_region(grid_t* grid, WORD col0, WORD row0, WORD col1, WORD row1)
+grid_invalidate_region(grid_t* grid, DWORD col0, DWORD row0, DWORD col1, DWORD row1)
 {
     RECT r;
 
@@ -1266,7 +1712,7 @@ grid_invalidate_region(grid_t* grid, WORD col0, WORD row0, WORD col1, WORD row1)
 }
 
 static inline void
-grid_invalidate_cell(grid_t* grid, WORD col, WORD row, BOOL extend_for_focus)
+grid_invalidate_cell(grid_t* grid, DWORD col, DWORD row, BOOL extend_for_focus)
 {
     RECT r;
 
@@ -1279,7 +1725,7 @@ grid_invalidate_cell(grid_t* grid, WORD col, WORD row, BOOL extend_for_focus)
 static inline void
 grid_invalidate_selection(grid_t* grid)
 {
-    const rgn16_rect_t* ext = rgn16_extents(&grid->selection);
+    const REGION_RECT* ext = region_extents(&grid->selection);
     if(ext != NULL)
         grid_invalidate_region(grid, ext->x0, ext->y0, ext->x1, ext->y1);
 }
@@ -1298,14 +1744,19 @@ grid_refresh(void* view, void* detail)
 
     switch(rd->event) {
         case TABLE_CELL_CHANGED:
-            if(!grid->no_redraw)
-                grid_invalidate_cell(grid, rd->param[0], rd->param[1], FALSE);
+            if(!grid->no_redraw) {
+                grid_invalidate_cell(grid, (DWORD) rd->param[0],
+                                     (DWORD) rd->param[1], FALSE);
+            }
             break;
 
         case TABLE_REGION_CHANGED:
-            if(!grid->no_redraw)
-                grid_invalidate_region(grid, rd->param[0], rd->param[1],
+            /* Only the top left corner may refer to the headers. */
+            if(!grid->no_redraw) {
+                grid_invalidate_region(grid, (DWORD) rd->param[0],
+                                       (DWORD) rd->param[1],
                                        rd->param[2], rd->param[3]);
+            }
             break;
 
         case TABLE_COLCOUNT_CHANGED:
@@ -1324,6 +1775,9 @@ grid_refresh(void* view, void* detail)
             if(grid->row_heights != NULL)
                 grid_realloc_row_heights(grid, grid->row_count, rd->param[1], TRUE);
             grid->row_count = rd->param[1];
+            /* The 16-bit notifications cannot refer to all the rows anymore. */
+            if(grid->row_count >= MC_TABLE_HEADER)
+                grid->ex_notifications = TRUE;
             grid_setup_scrollbars(grid, TRUE);
             if(!grid->no_redraw) {
                 /* TODO: optimize by invalidating minimal rect (new rows) and
@@ -1334,14 +1788,14 @@ grid_refresh(void* view, void* detail)
     }
 }
 
-static DWORD
-grid_hit_test_ex(grid_t* grid, MC_GHITTESTINFO* info, RECT* cell_rect)
+static BOOL
+grid_hit_test_ex(grid_t* grid, MC_GHITTESTINFOEX* info, RECT* cell_rect)
 {
     int x = info->pt.x;
     int y = info->pt.y;
     RECT client;
     int header_w, header_h;
-    WORD col, row;
+    DWORD col, row;
     int x0, x1, x2, x3;
     int y0, y1, y2, y3;
 
@@ -1360,9 +1814,9 @@ grid_hit_test_ex(grid_t* grid, MC_GHITTESTINFO* info, RECT* cell_rect)
         else if(y >= client.bottom)
             info->flags |= MC_GHT_BELOW;
 
-        info->wColumn = (WORD) -1;
-        info->wRow = (WORD) -1;
-        return (DWORD) -1;
+        info->dwColumn = (DWORD) -1;
+        info->dwRow = (DWORD) -1;
+        return FALSE;
     }
 
     /* Handle the "dead header cell" */
@@ -1370,26 +1824,23 @@ grid_hit_test_ex(grid_t* grid, MC_GHITTESTINFO* info, RECT* cell_rect)
     header_h = grid_header_height(grid);
     if(x < header_w  &&  y < header_h) {
         info->flags = MC_GHT_ONCOLUMNHEADER | MC_GHT_ONROWHEADER;
-        info->wColumn = MC_TABLE_HEADER;
-        info->wRow = MC_TABLE_HEADER;
+        info->dwColumn = GRID_HEADER;
+        info->dwRow = GRID_HEADER;
         if(cell_rect != NULL)
             mc_rect_set(cell_rect, 0, 0, header_w, header_h);
-        return MAKELRESULT(MC_TABLE_HEADER, MC_TABLE_HEADER);
+        return TRUE;
     }
 
     /* Handle column headers */
     if(y < header_h) {
-        info->wRow = MC_TABLE_HEADER;
+        info->dwRow = GRID_HEADER;
 
-        x3 = header_w - grid->scroll_x;
-        for(col = 0; col < grid->col_count; col++) {
+        col = grid_x2col(grid, x);
+        if(col < grid->col_count) {
             int divider_width;
 
-            x0 = x3;
-            x3 += grid_col_width(grid, col);
-
-            if(x >= x3)
-                continue;
+            x0 = grid_col2x(grid, col);
+            x3 = x0 + grid_col_width(grid, col);
 
             if(grid->style & MC_GS_RESIZABLECOLUMNS) {
                 if(x3 - x0 > 2 * DIVIDER_WIDTH)
@@ -1408,33 +1859,35 @@ grid_hit_test_ex(grid_t* grid, MC_GHITTESTINFO* info, RECT* cell_rect)
                     info->flags = MC_GHT_ONCOLUMNDIVIDER;
                 else
                     info->flags = MC_GHT_ONCOLUMNDIVOPEN;
-                info->wColumn = col - 1;
+                info->dwColumn = col - 1;
             } else if(x >= x2) {
                 info->flags = MC_GHT_ONCOLUMNDIVIDER;
-                info->wColumn = col;
+                info->dwColumn = col;
             } else {
                 info->flags = MC_GHT_ONCOLUMNHEADER;
-                info->wColumn = col;
+                info->dwColumn = col;
             }
 
             if(cell_rect != NULL)
-                grid_cell_rect(grid, info->wColumn, MC_TABLE_HEADER, cell_rect);
+                grid_cell_rect(grid, info->dwColumn, GRID_HEADER, cell_rect);
 
-            return MAKELRESULT(info->wColumn, MC_TABLE_HEADER);
+            return TRUE;
         }
 
         /* Treat a small area after the last column also as a part of the
          * column divider. */
         if((grid->style & MC_GS_RESIZABLECOLUMNS)  &&  grid->col_count > 0) {
+            x3 = grid_col2x(grid, grid->col_count);
+            x0 = x3 - grid_col_width(grid, grid->col_count - 1);
             if(x < x3 + DIVIDER_WIDTH / 2) {
                 if(grid_col_width(grid, grid->col_count - 1) > 0)
                     info->flags = MC_GHT_ONCOLUMNDIVIDER;
                 else
                     info->flags = MC_GHT_ONCOLUMNDIVOPEN;
-                info->wColumn = grid->col_count - 1;
+                info->dwColumn = grid->col_count - 1;
                 if(cell_rect != NULL)
                     mc_rect_set(cell_rect, x0, 0, x3, header_h);
-                return MAKELRESULT(info->wColumn, MC_TABLE_HEADER);
+                return TRUE;
             }
         }
 
@@ -1443,17 +1896,14 @@ grid_hit_test_ex(grid_t* grid, MC_GHITTESTINFO* info, RECT* cell_rect)
 
     /* Handle row headers */
     if(x < header_w) {
-        info->wColumn = MC_TABLE_HEADER;
+        info->dwColumn = GRID_HEADER;
 
-        y3 = header_h - grid->scroll_y;
-        for(row = 0; row < grid->row_count; row++) {
+        row = grid_y2row(grid, y);
+        if(row < grid->row_count) {
             int divider_width;
 
-            y0 = y3;
-            y3 += grid_row_height(grid, row);
-
-            if(y >= y3)
-                continue;
+            y0 = grid_row2y(grid, row);
+            y3 = y0 + grid_row_height(grid, row);
 
             if(grid->style & MC_GS_RESIZABLEROWS) {
                 if(y3 - y0 > 2 * DIVIDER_WIDTH)
@@ -1472,33 +1922,35 @@ grid_hit_test_ex(grid_t* grid, MC_GHITTESTINFO* info, RECT* cell_rect)
                     info->flags = MC_GHT_ONROWDIVIDER;
                 else
                     info->flags = MC_GHT_ONROWDIVOPEN;
-                info->wRow = row - 1;
+                info->dwRow = row - 1;
             } else if(y >= y2) {
                 info->flags = MC_GHT_ONROWDIVIDER;
-                info->wRow = row;
+                info->dwRow = row;
             } else {
                 info->flags = MC_GHT_ONROWHEADER;
-                info->wRow = row;
+                info->dwRow = row;
             }
 
             if(cell_rect != NULL)
-                grid_cell_rect(grid, MC_TABLE_HEADER, info->wRow, cell_rect);
+                grid_cell_rect(grid, GRID_HEADER, info->dwRow, cell_rect);
 
-            return MAKELRESULT(MC_TABLE_HEADER, info->wRow);
+            return TRUE;
         }
 
         /* Treat a small area after the last column also as a part of the
          * column divider. */
         if((grid->style & MC_GS_RESIZABLEROWS)  &&  grid->row_count > 0) {
+            y3 = grid_row2y(grid, grid->row_count);
+            y0 = y3 - grid_row_height(grid, grid->row_count - 1);
             if(y < y3 + DIVIDER_WIDTH / 2) {
                 if(grid_row_height(grid, grid->row_count - 1) > 0)
                     info->flags = MC_GHT_ONROWDIVIDER;
                 else
                     info->flags = MC_GHT_ONROWDIVOPEN;
-                info->wRow = grid->row_count - 1;
+                info->dwRow = grid->row_count - 1;
                 if(cell_rect != NULL)
                     mc_rect_set(cell_rect, 0, y0, header_w, y3);
-                return MAKELRESULT(MC_TABLE_HEADER, info->wRow);
+                return TRUE;
             }
         }
 
@@ -1506,60 +1958,61 @@ grid_hit_test_ex(grid_t* grid, MC_GHITTESTINFO* info, RECT* cell_rect)
     }
 
     /* Handle ordinary cells */
-    info->wColumn = (WORD) -1;
-    x3 = header_w - grid->scroll_x;
-    for(col = 0; col < grid->col_count; col++) {
-        x0 = x3;
-        x3 += grid_col_width(grid, col);
-        if(x < x3) {
-            info->wColumn = col;
-            break;
-        }
-    }
-    if(info->wColumn == (WORD) -1)
+    col = grid_x2col(grid, x);
+    if(col >= grid->col_count)
         goto nowhere;
-
-    info->wRow = (WORD) -1;
-    y3 = header_h - grid->scroll_y;
-    for(row = 0; row < grid->row_count; row++) {
-        y0 = y3;
-        y3 += grid_row_height(grid, row);
-        if(y < y3) {
-            info->wRow = row;
-            break;
-        }
-    }
-    if(info->wRow == (WORD) -1)
+    row = grid_y2row(grid, y);
+    if(row >= grid->row_count)
         goto nowhere;
 
+    info->dwColumn = col;
+    info->dwRow = row;
+    x0 = grid_col2x(grid, col);
+    x3 = x0 + grid_col_width(grid, col);
+    y0 = grid_row2y(grid, row);
+    y3 = y0 + grid_row_height(grid, row);
+
     info->flags = MC_GHT_ONNORMALCELL;
     if(cell_rect != NULL)
         mc_rect_set(cell_rect, x0, y0, x3, y3);
-    return MAKELRESULT(info->wColumn, info->wRow);
+    return TRUE;
 
     /* Nowhere. */
 nowhere:
     info->flags = MC_GHT_NOWHERE;
-    info->wColumn = (WORD) -1;
-    info->wRow = (WORD) -1;
-    return (DWORD) -1;
+    info->dwColumn = (DWORD) -1;
+    info->dwRow = (DWORD) -1;
+    return FALSE;
 }
 
-static inline DWORD
+static DWORD
 grid_hit_test(grid_t* grid, MC_GHITTESTINFO* info)
 {
-    return grid_hit_test_ex(grid, info, NULL);
+    MC_GHITTESTINFOEX info_ex;
+    BOOL found;
+
+    info_ex.pt = info->pt;
+    found = grid_hit_test_ex(grid, &info_ex, NULL);
+    info->flags = info_ex.flags;
+    info->wColumn = (WORD) info_ex.dwColumn;
+    info->wRow = (WORD) info_ex.dwRow;
+
+    return (found ? MAKELRESULT(info->wColumn, info->wRow) : (DWORD) -1);
 }
 
 static int
-grid_set_focused_cell(grid_t* grid, WORD col, WORD row)
+grid_set_focused_cell(grid_t* grid, DWORD col, DWORD row)
 {
-    WORD old_col = grid->focused_col;
-    WORD old_row = grid->focused_row;
-    MC_NMGFOCUSEDCELLCHANGE notif;
+    DWORD old_col = grid->focused_col;
+    DWORD old_row = grid->focused_row;
+    union {
+        NMHDR hdr;
+        MC_NMGFOCUSEDCELLCHANGE classic;
+        MC_NMGFOCUSEDCELLCHANGEEX ex;
+    } notif;
 
     if(MC_ERR(col >= grid->col_count  ||  row >= grid->row_count)) {
-        MC_TRACE("grid_set_focused_cell: Cell [%hu, %hu] out of range.",
+        MC_TRACE("grid_set_focused_cell: Cell [%lu, %lu] out of range.",
                  col, row);
         return -1;
     }
@@ -1570,11 +2023,19 @@ grid_set_focused_cell(grid_t* grid, WORD col, WORD row)
     /* Fire notification MC_GN_FOCUSEDCELLCHANGING */
     notif.hdr.hwndFrom = grid->win;
     notif.hdr.idFrom = GetWindowLong(grid->win, GWL_ID);
-    notif.hdr.code = MC_GN_FOCUSEDCELLCHANGING;
-    notif.wOldColumn = old_col;
-    notif.wOldRow = old_row;
-    notif.wNewColumn = col;
-    notif.wNewRow = row;
+    if(grid->ex_notifications) {
+        notif.hdr.code = MC_GN_FOCUSEDCELLCHANGINGEX;
+        notif.ex.dwOldColumn = old_col;
+        notif.ex.dwOldRow = old_row;
+        notif.ex.dwNewColumn = col;
+        notif.ex.dwNewRow = row;
+    } else {
+        notif.hdr.code = MC_GN_FOCUSEDCELLCHANGING;
+        notif.classic.wOldColumn = (WORD) old_col;
+        notif.classic.wOldRow = (WORD) old_row;
+        notif.classic.wNewColumn = (WORD) col;
+        notif.classic.wNewRow = (WORD) row;
+    }
     if(MC_SEND(grid->notify_win, WM_NOTIFY, notif.hdr.idFrom, &notif)) {
         /* Application suppresses the default processing */
         GRID_TRACE("grid_set_focused_cell: "
@@ -1591,7 +2052,7 @@ grid_set_focused_cell(grid_t* grid, WORD col, WORD row)
     grid->focused_row = row;
 
     /* Fire notification MC_GN_FOCUSEDCELLCHANGED. */
-    notif.hdr.code = MC_GN_FOCUSEDCELLCHANGED;
+    notif.hdr.code = (grid->ex_notifications ? MC_GN_FOCUSEDCELLCHANGEDEX : MC_GN_FOCUSEDCELLCHANGED);
     MC_SEND(grid->notify_win, WM_NOTIFY, notif.hdr.idFrom, &notif);
 
     /* Refresh */
@@ -1603,129 +2064,222 @@ grid_set_focused_cell(grid_t* grid, WORD col, WORD row)
     return 0;
 }
 
-static void
-grid_setup_MC_GSELECTION(MC_GSELECTION* gsel, rgn16_t* rgn)
+/* The public API describes the selection with MC_GRECT which has 16-bit
+ * members, while REGION uses 32-bit coordinates. Hence we have to convert
+ * whenever we expose the selection. (Without the extended mode, the values
+ * always fit as they are limited by the column and row counts. In the
+ * extended mode, we clamp them.)
+ *
+ * For the extended API, MC_GRECTEX is exactly REGION_RECT, so we can pass
+ * the REGION guts directly. */
+MC_STATIC_ASSERT(sizeof(MC_GRECTEX) == sizeof(REGION_RECT));
+MC_STATIC_ASSERT(MC_OFFSETOF(MC_GRECTEX, dwColumnFrom) == MC_OFFSETOF(REGION_RECT, x0));
+MC_STATIC_ASSERT(MC_OFFSETOF(MC_GRECTEX, dwRowFrom) == MC_OFFSETOF(REGION_RECT, y0));
+MC_STATIC_ASSERT(MC_OFFSETOF(MC_GRECTEX, dwColumnTo) == MC_OFFSETOF(REGION_RECT, x1));
+MC_STATIC_ASSERT(MC_OFFSETOF(MC_GRECTEX, dwRowTo) == MC_OFFSETOF(REGION_RECT, y1));
+
+static inline void
+grid_export_rect(MC_GRECT* grc, const REGION_RECT* rc)
+{
+    grc->wColumnFrom = (WORD) MC_MIN(rc->x0, 0xffff);
+    grc->wRowFrom = (WORD) MC_MIN(rc->y0, 0xffff);
+    grc->wColumnTo = (WORD) MC_MIN(rc->x1, 0xffff);
+    grc->wRowTo = (WORD) MC_MIN(rc->y1, 0xffff);
+}
+
+static int
+grid_export_rects(const REGION* rgn, MC_GRECT** p_rects)
 {
-    static const rgn16_rect_t empty_rc = { 0, 0, 0, 0 };
-    const rgn16_rect_t* extents;
-    const rgn16_rect_t* vec;
-    WORD n;
+    const REGION_RECT* vec;
+    MC_GRECT* rects;
+    UINT i, n;
+
+    n = region_rects(rgn, &vec);
+    if(n == 0) {
+        *p_rects = NULL;
+        return 0;
+    }
 
-    switch(rgn->n) {
-        case 0:     extents = &empty_rc;      vec = NULL;           n = 0;          break;
-        case 1:     extents = &rgn->s.rc;     vec = &rgn->s.rc;     n = 1;          break;
-        default:    extents = &rgn->c.vec[0]; vec = &rgn->c.vec[1]; n = rgn->n - 1; break;
+    rects = (MC_GRECT*) malloc(n * sizeof(MC_GRECT));
+    if(MC_ERR(rects == NULL)) {
+        MC_TRACE("grid_export_rects: malloc() failed.");
+        return -1;
     }
 
-    /* rgn16_rect_t and MC_GRECT are binary compatible. */
-    memcpy(&gsel->rcExtents, extents, sizeof(rgn16_rect_t));
-    gsel->uDataCount = n;
-    gsel->rcData = (MC_GRECT*) vec;
+    for(i = 0; i < n; i++)
+        grid_export_rect(&rects[i], &vec[i]);
+
+    *p_rects = rects;
+    return 0;
 }
 
-/* Warning: This function always consumes the 'sel', even when it fails. */
+/* Get the current selection as MC_GRECT array. It is cached until the
+ * selection changes. */
 static int
-grid_install_selection(grid_t* grid, rgn16_t* sel)
+grid_selection_rects(grid_t* grid, MC_GRECT** p_rects)
 {
-    MC_NMGSELECTIONCHANGE notif;
-    rgn16_t tmp;
+    if(grid->selection_rects == NULL) {
+        if(MC_ERR(grid_export_rects(&grid->selection, &grid->selection_rects) != 0)) {
+            MC_TRACE("grid_selection_rects: grid_export_rects() failed.");
+            return -1;
+        }
+    }
 
-    if(rgn16_equals_rgn(&grid->selection, sel)) {
-        rgn16_fini(sel);
+    *p_rects = grid->selection_rects;
+    return 0;
+}
+
+static void
+grid_setup_MC_GSELECTION(MC_GSELECTION* gsel, REGION* rgn, MC_GRECT* rects)
+{
+    static const REGION_RECT empty_rc = { 0, 0, 0, 0 };
+    const REGION_RECT* extents;
+    const REGION_RECT* vec;
+
+    extents = region_extents(rgn);
+    if(extents == NULL)
+        extents = &empty_rc;
+
+    grid_export_rect(&gsel->rcExtents, extents);
+    gsel->uDataCount = region_rects(rgn, &vec);
+    gsel->rcData = rects;
+}
+
+/* Note the rects are valid only until the REGION changes (or moves). */
+static void
+grid_setup_MC_GSELECTIONEX(MC_GSELECTIONEX* gsel, const REGION* rgn)
+{
+    static const REGION_RECT empty_rc = { 0, 0, 0, 0 };
+    const REGION_RECT* extents;
+    const REGION_RECT* vec;
+
+    extents = region_extents(rgn);
+    if(extents == NULL)
+        extents = &empty_rc;
+
+    memcpy(&gsel->rcExtents, extents, sizeof(MC_GRECTEX));
+    gsel->uDataCount = region_rects(rgn, &vec);
+    gsel->rcData = (MC_GRECTEX*) vec;
+}
+
+/* Warning: This function always consumes the 'sel', even when it fails. */
+static int
+grid_install_selection(grid_t* grid, REGION* sel)
+{
+    union {
+        NMHDR hdr;
+        MC_NMGSELECTIONCHANGE classic;
+        MC_NMGSELECTIONCHANGEEX ex;
+    } notif;
+    MC_GRECT* old_rects = NULL;
+    MC_GRECT* new_rects = NULL;
+    REGION tmp;
+
+    if(region_equals(&grid->selection, sel)) {
+        region_fini(sel);
         return 0;
     }
 
     /* Fire notification MC_GN_SELECTIONCHANGING */
     notif.hdr.hwndFrom = grid->win;
     notif.hdr.idFrom = GetWindowLong(grid->win, GWL_ID);
-    notif.hdr.code = MC_GN_SELECTIONCHANGING;
-    grid_setup_MC_GSELECTION(&notif.oldSelection, &grid->selection);
-    grid_setup_MC_GSELECTION(&notif.newSelection, sel);
+    if(grid->ex_notifications) {
+        notif.hdr.code = MC_GN_SELECTIONCHANGINGEX;
+        grid_setup_MC_GSELECTIONEX(&notif.ex.oldSelection, &grid->selection);
+        grid_setup_MC_GSELECTIONEX(&notif.ex.newSelection, sel);
+    } else {
+        if(MC_ERR(grid_selection_rects(grid, &old_rects) != 0  ||
+                  grid_export_rects(sel, &new_rects) != 0)) {
+            MC_TRACE("grid_install_selection: Cannot export the selection.");
+            region_fini(sel);
+            return -1;
+        }
+
+        notif.hdr.code = MC_GN_SELECTIONCHANGING;
+        grid_setup_MC_GSELECTION(&notif.classic.oldSelection, &grid->selection, old_rects);
+        grid_setup_MC_GSELECTION(&notif.classic.newSelection, sel, new_rects);
+    }
 
     if(MC_SEND(grid->notify_win, WM_NOTIFY, notif.hdr.idFrom, &notif)) {
         /* Application suppresses the processing */
         GRID_TRACE("grid_install_selection: "
                    "MC_GN_SELECTIONCHANGING suppresses the change.");
-        rgn16_fini(sel);
+        free(new_rects);
+        region_fini(sel);
         return -1;
     }
 
     /* Install the new selection
-     * (by swapping rgn16_t guts with the old selection). */
-    memcpy(&tmp, &grid->selection, sizeof(rgn16_t));
-    memcpy(&grid->selection, sel, sizeof(rgn16_t));
-    memcpy(sel, &tmp, sizeof(rgn16_t));
+     * (by swapping REGION guts with the old selection). The exported rects
+     * of the new selection become the cached ones. (In the extended mode,
+     * they are exported lazily when asked for.) */
+    memcpy(&tmp, &grid->selection, sizeof(REGION));
+    memcpy(&grid->selection, sel, sizeof(REGION));
+    memcpy(sel, &tmp, sizeof(REGION));
+    if(!grid->ex_notifications) {
+        grid->selection_rects = new_rects;
+    } else {
+        free(grid->selection_rects);
+        grid->selection_rects = NULL;
+    }
+    region_cursor_init(&grid->sel_cursor, &grid->selection);
 
     /* Refresh */
     if(!grid->no_redraw) {
-        const rgn16_rect_t* ext;
+        const REGION_RECT* ext;
 
-        ext = rgn16_extents(&grid->selection);
+        ext = region_extents(&grid->selection);
         if(ext != NULL)
             grid_invalidate_region(grid, ext->x0, ext->y0, ext->x1, ext->y1);
 
-        ext = rgn16_extents(sel);
+        ext = region_extents(sel);
         if(ext != NULL)
             grid_invalidate_region(grid, ext->x0, ext->y0, ext->x1, ext->y1);
     }
 
     /* Fire notification MC_GN_SELECTIONCHANGED */
-    notif.hdr.code = MC_GN_SELECTIONCHANGED;
+    if(grid->ex_notifications) {
+        /* The swapping above may have moved the rects. */
+        notif.hdr.code = MC_GN_SELECTIONCHANGEDEX;
+        grid_setup_MC_GSELECTIONEX(&notif.ex.oldSelection, sel);
+        grid_setup_MC_GSELECTIONEX(&notif.ex.newSelection, &grid->selection);
+    } else {
+        notif.hdr.code = MC_GN_SELECTIONCHANGED;
+    }
     MC_SEND(grid->notify_win, WM_NOTIFY, notif.hdr.idFrom, &notif);
 
     /* Free the original selection */
-    rgn16_fini(sel);
+    free(old_rects);
+    region_fini(sel);
 
     return 0;
 }
 
+/* Warning: This function may modify the 'rects'. */
 static int
-grid_set_selection(grid_t* grid, MC_GSELECTION* gsel)
+grid_set_selection_rects(grid_t* grid, REGION_RECT* rects, UINT n)
 {
-    UINT n = (gsel != NULL ? gsel->uDataCount : 0);
-    rgn16_t sel;
+    REGION sel;
 
     if(n == 0) {
-        rgn16_init(&sel);
+        region_init(&sel);
     } else if(n == 1) {
-        rgn16_init_with_rect(&sel, (rgn16_rect_t*) &gsel->rcData[0]);
+        region_init_with_rect(&sel, &rects[0]);
     } else {
         /* We have to be careful. On input, application can provide rect
-         * array which does not follow rgn16_t rules. Hence we create the
-         * selection by iterative unioning all the rects.
-         *
-         * TODO: Optimize this. We should only call union for whole sequences
-         *       of rects which follow the rgn16_t rules.
-         */
-        WORD i;
-
-        rgn16_init(&sel);
-
-        for(i = 0; i < gsel->uDataCount; i++) {
-            rgn16_t rgn_rc;
-            rgn16_t rgn_union;
-            rgn16_rect_t r;
-
-            r.x0 = gsel->rcData[i].wColumnFrom;
-            r.y0 = gsel->rcData[i].wRowFrom;
-            r.x1 = MC_MIN(gsel->rcData[i].wColumnTo, grid->col_count);
-            r.y1 = MC_MIN(gsel->rcData[i].wRowTo, grid->row_count);
-
-            if(r.x0 >= r.x1  ||  r.y0 >= r.y1) {
-                /* Skip empty rect */
-                continue;
-            }
-
-            rgn16_init_with_rect(&rgn_rc, &r);
-            if(MC_ERR(rgn16_union(&rgn_union, &sel, &rgn_rc)) != 0) {
-                MC_TRACE("grid_set_selection: rgn16_union() failed.");
-                rgn16_fini(&sel);
-                return -1;
-            }
-            rgn16_fini(&rgn_rc);
+         * array which does not follow REGION rules. Hence we create the
+         * selection as a union of all the rects. */
+        UINT i;
+
+        /* (Empty rects are skipped by region_init_with_rects().) */
+        for(i = 0; i < n; i++) {
+            rects[i].x1 = MC_MIN(rects[i].x1, grid->col_count);
+            rects[i].y1 = MC_MIN(rects[i].y1, grid->row_count);
+        }
 
-            rgn16_fini(&sel);
-            memcpy(&sel, &rgn_union, sizeof(rgn16_t));
+        if(MC_ERR(region_init_with_rects(&sel, rects, n) != 0)) {
+            MC_TRACE("grid_set_selection_rects: region_init_with_rects() failed.");
+            return -1;
         }
     }
 
@@ -1754,50 +2308,138 @@ grid_set_selection(grid_t* grid, MC_GSELECTION* gsel)
             break;
     }
 
-    if(MC_ERR(grid_install_selection(grid, &sel) != 0)) {
-        MC_TRACE("grid_set_selection: grid_install_selection() failed.");
-        return -1;
+    if(MC_ERR(grid_install_selection(grid, &sel) != 0)) {
+        MC_TRACE("grid_set_selection_rects: grid_install_selection() failed.");
+        return -1;
+    }
+
+    return 0;
+
+err_invalid_sel:
+    MC_TRACE("grid_set_selection_rects: Request selection refused due control style.");
+    region_fini(&sel);
+    SetLastError(ERROR_INVALID_PARAMETER);
+    return -1;
+}
+
+static int
+grid_set_selection(grid_t* grid, MC_GSELECTION* gsel)
+{
+    UINT n = (gsel != NULL ? gsel->uDataCount : 0);
+    REGION_RECT rect;
+    REGION_RECT* rects = &rect;
+    UINT i;
+    int ret;
+
+    if(n > 1) {
+        rects = (REGION_RECT*) malloc(n * sizeof(REGION_RECT));
+        if(MC_ERR(rects == NULL)) {
+            MC_TRACE("grid_set_selection: malloc() failed.");
+            return -1;
+        }
+    }
+
+    for(i = 0; i < n; i++) {
+        rects[i].x0 = gsel->rcData[i].wColumnFrom;
+        rects[i].y0 = gsel->rcData[i].wRowFrom;
+        rects[i].x1 = gsel->rcData[i].wColumnTo;
+        rects[i].y1 = gsel->rcData[i].wRowTo;
+    }
+
+    ret = grid_set_selection_rects(grid, rects, n);
+    if(MC_ERR(ret != 0))
+        MC_TRACE("grid_set_selection: grid_set_selection_rects() failed.");
+
+    if(rects != &rect)
+        free(rects);
+    return ret;
+}
+
+static int
+grid_set_selection_ex(grid_t* grid, MC_GSELECTIONEX* gsel)
+{
+    UINT n = (gsel != NULL ? gsel->uDataCount : 0);
+    REGION_RECT rect;
+    REGION_RECT* rects = &rect;
+    int ret;
+
+    if(n > 1) {
+        rects = (REGION_RECT*) malloc(n * sizeof(REGION_RECT));
+        if(MC_ERR(rects == NULL)) {
+            MC_TRACE("grid_set_selection_ex: malloc() failed.");
+            return -1;
+        }
     }
 
-    return 0;
+    /* Copy: grid_set_selection_rects() may modify it. */
+    if(n > 0)
+        memcpy(rects, gsel->rcData, n * sizeof(REGION_RECT));
 
-err_invalid_sel:
-    MC_TRACE("grid_set_selection: Request selection refused due control style.");
-    rgn16_fini(&sel);
-    SetLastError(ERROR_INVALID_PARAMETER);
-    return -1;
+    ret = grid_set_selection_rects(grid, rects, n);
+    if(MC_ERR(ret != 0))
+        MC_TRACE("grid_set_selection_ex: grid_set_selection_rects() failed.");
+
+    if(rects != &rect)
+        free(rects);
+    return ret;
 }
 
 static UINT
 grid_get_selection(grid_t* grid, MC_GSELECTION* gsel)
 {
-    static const rgn16_rect_t empty_rc = { 0, 0, 0, 0 };
-    const rgn16_rect_t* extents;
-    const rgn16_rect_t* vec;
-    WORD n;
-    rgn16_t* rgn = &grid->selection;
-
-    switch(rgn->n) {
-        case 0:     extents = &empty_rc;      vec = NULL;           n = 0;          break;
-        case 1:     extents = &rgn->s.rc;     vec = &rgn->s.rc;     n = 1;          break;
-        default:    extents = &rgn->c.vec[0]; vec = &rgn->c.vec[1]; n = rgn->n - 1; break;
-    }
+    static const REGION_RECT empty_rc = { 0, 0, 0, 0 };
+    const REGION_RECT* extents;
+    const REGION_RECT* vec;
+    UINT i, n;
 
+    n = region_rects(&grid->selection, &vec);
     if(gsel == NULL)
         return n;
 
-    gsel->rcExtents.wColumnFrom = extents->x0;
-    gsel->rcExtents.wRowFrom = extents->y0;
-    gsel->rcExtents.wColumnTo = extents->x1;
-    gsel->rcExtents.wRowTo = extents->y1;
+    extents = region_extents(&grid->selection);
+    if(extents == NULL)
+        extents = &empty_rc;
+    grid_export_rect(&gsel->rcExtents, extents);
 
     if(gsel->uDataCount == (UINT) -1) {
+        if(MC_ERR(grid_selection_rects(grid, &gsel->rcData) != 0)) {
+            MC_TRACE("grid_get_selection: grid_selection_rects() failed.");
+            gsel->uDataCount = 0;
+            gsel->rcData = NULL;
+            return 0;
+        }
         gsel->uDataCount = n;
-        gsel->rcData = (MC_GRECT*) vec;
     } else {
         gsel->uDataCount = MC_MIN(gsel->uDataCount, n);
-        if(gsel->uDataCount > 0)
-            memcpy(gsel->rcData, vec, gsel->uDataCount * sizeof(rgn16_rect_t));
+        for(i = 0; i < gsel->uDataCount; i++)
+            grid_export_rect(&gsel->rcData[i], &vec[i]);
+    }
+
+    return n;
+}
+
+static UINT
+grid_get_selection_ex(grid_t* grid, MC_GSELECTIONEX* gsel)
+{
+    const REGION_RECT* vec;
+    UINT n;
+
+    n = region_rects(&grid->selection, &vec);
+    if(gsel == NULL)
+        return n;
+
+    if(gsel->uDataCount == (UINT) -1) {
+        /* Valid until the selection changes (same as MC_GM_GETSELECTION). */
+        grid_setup_MC_GSELECTIONEX(gsel, &grid->selection);
+    } else {
+        UINT count = MC_MIN(gsel->uDataCount, n);
+        MC_GRECTEX* data = gsel->rcData;
+
+        grid_setup_MC_GSELECTIONEX(gsel, &grid->selection);
+        if(count > 0)
+            memcpy(data, gsel->rcData, count * sizeof(MC_GRECTEX));
+        gsel->uDataCount = count;
+        gsel->rcData = data;
     }
 
     return n;
@@ -1821,12 +2463,12 @@ grid_change_focus(grid_t* grid, BOOL setfocus)
 static BOOL
 grid_set_cursor(grid_t* grid)
 {
-    MC_GHITTESTINFO info;
+    MC_GHITTESTINFOEX info;
 
     GetCursorPos(&info.pt);
     ScreenToClient(grid->win, &info.pt);
 
-    grid_hit_test(grid, &info);
+    grid_hit_test_ex(grid, &info, NULL);
 
     if(info.flags & (MC_GHT_ONCOLUMNDIVIDER | MC_GHT_ONCOLUMNDIVOPEN |
                      MC_GHT_ONROWDIVIDER | MC_GHT_ONROWDIVOPEN)) {
@@ -1882,6 +2524,14 @@ grid_set_geometry(grid_t* grid, MC_GGEOMETRY* geom, BOOL invalidate)
         grid->def_row_height = font_size.cy + 2 * grid->padding_v;
     }
 
+    /* Default sizes may have changed: Update the prefix sums of all the
+     * columns/rows which use them. (Their count does not change, so this
+     * cannot fail.) */
+    if(grid->col_widths != NULL)
+        grid_rebuild_col_index(grid, grid->col_count);
+    if(grid->row_heights != NULL)
+        grid_rebuild_row_index(grid, grid->row_count);
+
     grid_setup_scrollbars(grid, TRUE);
 
     if(invalidate && !grid->no_redraw)
@@ -1917,8 +2567,43 @@ grid_get_geometry(grid_t* grid, MC_GGEOMETRY* geom)
     return 0;
 }
 
+/* Drop the cells from the cache of the asynchronous data provider. The
+ * parameters have the same meaning as for grid_redraw_cells(). */
+static void
+grid_invalidate_cached(grid_t* grid, DWORD col0, DWORD row0, DWORD col1, DWORD row1)
+{
+    CELLCACHE_RECT rc;
+    DWORD x0, y0, x1, y1;
+
+    x0 = (col0 != GRID_HEADER ? col0 : 0);
+    y0 = (row0 != GRID_HEADER ? row0 : 0);
+    x1 = (col1 != GRID_HEADER ? (DWORD) col1 + 1 : 0);
+    y1 = (row1 != GRID_HEADER ? (DWORD) row1 + 1 : 0);
+
+    /* Ordinary cells */
+    if(x0 < x1  &&  y0 < y1) {
+        rc.x0 = x0;  rc.y0 = y0;  rc.x1 = x1;  rc.y1 = y1;
+        cellcache_invalidate(grid->cellcache, &rc);
+    }
+
+    /* Row headers */
+    if(col0 == GRID_HEADER  &&  y0 < y1) {
+        rc.x0 = GRID_CACHE_HEADER;  rc.y0 = y0;  rc.x1 = GRID_CACHE_HEADER + 1;  rc.y1 = y1;
+        cellcache_invalidate(grid->cellcache, &rc);
+    }
+
+    /* Column headers */
+    if(row0 == GRID_HEADER  &&  x0 < x1) {
+        rc.x0 = x0;  rc.y0 = GRID_CACHE_HEADER;  rc.x1 = x1;  rc.y1 = GRID_CACHE_HEADER + 1;
+        cellcache_invalidate(grid->cellcache, &rc);
+    }
+
+    /* Make the next grid_paint() ask for the dropped cells again. */
+    grid_reset_request(grid);
+}
+
 static int
-grid_redraw_cells(grid_t* grid, WORD col0, WORD row0, WORD col1, WORD row1)
+grid_redraw_cells(grid_t* grid, DWORD col0, DWORD row0, DWORD col1, DWORD row1)
 {
     int header_w;
     int header_h;
@@ -1928,13 +2613,16 @@ grid_redraw_cells(grid_t* grid, WORD col0, WORD row0, WORD col1, WORD row1)
      * excluded. However here the region includes [col1, row1] to make the
      * public API consistent with LVM_REDRAWITEMS. */
 
-    if((col0 != MC_TABLE_HEADER  &&  col0 > col1)  ||
-       (row0 != MC_TABLE_HEADER  &&  row0 > row1)) {
+    if((col0 != GRID_HEADER  &&  col0 > col1)  ||
+       (row0 != GRID_HEADER  &&  row0 > row1)) {
         MC_TRACE("grid_redraw_cells: col0 > col1  ||  row0 > row1");
         SetLastError(ERROR_INVALID_PARAMETER);
         return -1;
     }
 
+    if(grid->cellcache != NULL)
+        grid_invalidate_cached(grid, col0, row0, col1, row1);
+
     if(grid->no_redraw)
         return 0;
 
@@ -1942,16 +2630,16 @@ grid_redraw_cells(grid_t* grid, WORD col0, WORD row0, WORD col1, WORD row1)
     header_h = grid_header_height(grid);
 
     /* Invalidate row headers */
-    if(col0 == MC_TABLE_HEADER) {
+    if(col0 == GRID_HEADER) {
         rect.left = 0;
         rect.right = header_w;
-        if(row0 != MC_TABLE_HEADER) {
+        if(row0 != GRID_HEADER) {
             rect.top = grid_row2y(grid, row0);
             rect.bottom = grid_row2y_adv(grid, row0, rect.top, row1+1);
         } else {
             rect.top = header_h;
-            if(row1 != MC_TABLE_HEADER)
-                rect.bottom = grid_row2y(grid, row0);
+            if(row1 != GRID_HEADER)
+                rect.bottom = grid_row2y(grid, row1+1);
             else
                 rect.bottom = rect.top;
         }
@@ -1960,16 +2648,16 @@ grid_redraw_cells(grid_t* grid, WORD col0, WORD row0, WORD col1, WORD row1)
     }
 
     /* Invalidate column headers */
-    if(row0 == MC_TABLE_HEADER) {
+    if(row0 == GRID_HEADER) {
         rect.top = 0;
         rect.bottom = header_h;
-        if(col0 != MC_TABLE_HEADER) {
+        if(col0 != GRID_HEADER) {
             rect.left = grid_col2x(grid, col0);
             rect.right = grid_col2x_adv(grid, col0, rect.left, col1+1);
         } else {
             rect.left = header_w;
-            if(col1 != MC_TABLE_HEADER)
-                rect.right = grid_col2x(grid, col0);
+            if(col1 != GRID_HEADER)
+                rect.right = grid_col2x(grid, col1+1);
             else
                 rect.right = rect.left;
         }
@@ -1978,13 +2666,13 @@ grid_redraw_cells(grid_t* grid, WORD col0, WORD row0, WORD col1, WORD row1)
     }
 
     /* Invalidate ordinary cells */
-    if(col1 == MC_TABLE_HEADER || row1 == MC_TABLE_HEADER) {
+    if(col1 == GRID_HEADER || row1 == GRID_HEADER) {
         /* Caller specified only some header cells. */
         return 0;
     }
-    if(col0 == MC_TABLE_HEADER)
+    if(col0 == GRID_HEADER)
         col0 = 0;
-    if(row0 == MC_TABLE_HEADER)
+    if(row0 == GRID_HEADER)
         row0 = 0;
     rect.left = grid_col2x(grid, col0);
     rect.top = grid_row2y(grid, row0);
@@ -1996,15 +2684,60 @@ grid_redraw_cells(grid_t* grid, WORD col0, WORD row0, WORD col1, WORD row1)
 }
 
 static int
-grid_set_col_width(grid_t* grid, WORD col, WORD width)
+grid_redraw_cells_ex(grid_t* grid, const MC_GRECTEX* rc)
+{
+    if(MC_ERR(rc == NULL  ||
+              (rc->dwColumnFrom != GRID_HEADER  &&  rc->dwColumnFrom >= rc->dwColumnTo)  ||
+              (rc->dwRowFrom != GRID_HEADER  &&  rc->dwRowFrom >= rc->dwRowTo))) {
+        MC_TRACE("grid_redraw_cells_ex: Invalid rectangle.");
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return -1;
+    }
+
+    /* MC_GRECTEX excludes the right and bottom edge, grid_redraw_cells()
+     * includes them. Zero there means only the header cells. */
+    return grid_redraw_cells(grid, rc->dwColumnFrom, rc->dwRowFrom,
+                (rc->dwColumnTo > 0 ? rc->dwColumnTo - 1 : GRID_HEADER),
+                (rc->dwRowTo > 0 ? rc->dwRowTo - 1 : GRID_HEADER));
+}
+
+/* Notifications about resizing of rows come in two variants, like
+ * grid_nmdispinfo_t. (Columns always use the 16-bit variant.) */
+typedef union grid_nmcolrowsize_tag grid_nmcolrowsize_t;
+union grid_nmcolrowsize_tag {
+    NMHDR hdr;
+    MC_NMGCOLROWSIZECHANGE classic;
+    MC_NMGCOLROWSIZECHANGEEX ex;
+};
+
+static void
+grid_nmcolrowsize_init(grid_t* grid, grid_nmcolrowsize_t* notif, UINT code,
+                       BOOL is_row, DWORD index, WORD size)
+{
+    notif->hdr.hwndFrom = grid->win;
+    notif->hdr.idFrom = GetWindowLong(grid->win, GWL_ID);
+
+    if(is_row  &&  grid->ex_notifications) {
+        notif->hdr.code = GRID_GN_EX(code);
+        notif->ex.dwColumnOrRow = index;
+        notif->ex.wWidthOrHeight = size;
+    } else {
+        notif->hdr.code = code;
+        notif->classic.wColumnOrRow = (WORD) index;
+        notif->classic.wWidthOrHeight = size;
+    }
+}
+
+static int
+grid_set_col_width(grid_t* grid, DWORD col, WORD width)
 {
     int old_width;
-    MC_NMGCOLROWSIZECHANGE notif;
+    grid_nmcolrowsize_t notif;
 
-    GRID_TRACE("grid_set_col_width(%p, %hu, %hu)", grid, col, width);
+    GRID_TRACE("grid_set_col_width(%p, %lu, %hu)", grid, col, width);
 
     if(MC_ERR(col >= grid->col_count)) {
-        MC_TRACE("grid_set_col_width: column %hu our of range.", col);
+        MC_TRACE("grid_set_col_width: column %lu our of range.", col);
         SetLastError(ERROR_INVALID_PARAMETER);
         return -1;
     }
@@ -2024,11 +2757,7 @@ grid_set_col_width(grid_t* grid, WORD col, WORD width)
         return 0;
 
     /* Fire notification MC_GN_COLUMNWIDTHCHANGING */
-    notif.hdr.hwndFrom = grid->win;
-    notif.hdr.idFrom = GetWindowLong(grid->win, GWL_ID);
-    notif.hdr.code = MC_GN_COLUMNWIDTHCHANGING;
-    notif.wColumnOrRow = col;
-    notif.wWidthOrHeight = width;
+    grid_nmcolrowsize_init(grid, &notif, MC_GN_COLUMNWIDTHCHANGING, FALSE, col, width);
     if(MC_SEND(grid->notify_win, WM_NOTIFY, notif.hdr.idFrom, &notif)) {
         /* Application suppresses the default processing */
         GRID_TRACE("grid_set_col_width: "
@@ -2040,6 +2769,7 @@ grid_set_col_width(grid_t* grid, WORD col, WORD width)
         grid_labeledit_end(grid, FALSE);
 
     grid->col_widths[col] = width;
+    fenwick_set(&grid->col_index, col, grid_col_width(grid, col));
 
     if(!grid->no_redraw) {
         RECT rect;
@@ -2069,10 +2799,10 @@ grid_set_col_width(grid_t* grid, WORD col, WORD width)
 }
 
 static LONG
-grid_get_col_width(grid_t* grid, WORD col)
+grid_get_col_width(grid_t* grid, DWORD col)
 {
     if(MC_ERR(col >= grid->col_count)) {
-        MC_TRACE("grid_get_col_width: column %hu our of range.", col);
+        MC_TRACE("grid_get_col_width: column %lu our of range.", col);
         SetLastError(ERROR_INVALID_PARAMETER);
         return -1;
     }
@@ -2081,15 +2811,15 @@ grid_get_col_width(grid_t* grid, WORD col)
 }
 
 static int
-grid_set_row_height(grid_t* grid, WORD row, WORD height)
+grid_set_row_height(grid_t* grid, DWORD row, WORD height)
 {
     int old_height;
-    MC_NMGCOLROWSIZECHANGE notif;
+    grid_nmcolrowsize_t notif;
 
-    GRID_TRACE("grid_set_row_height(%p, %hu, %hu)", grid, row, height);
+    GRID_TRACE("grid_set_row_height(%p, %lu, %hu)", grid, row, height);
 
     if(MC_ERR(row >= grid->row_count)) {
-        MC_TRACE("grid_set_row_height: row %hu our of range.", row);
+        MC_TRACE("grid_set_row_height: row %lu our of range.", row);
         SetLastError(ERROR_INVALID_PARAMETER);
         return -1;
     }
@@ -2109,11 +2839,7 @@ grid_set_row_height(grid_t* grid, WORD row, WORD height)
         return 0;
 
     /* Fire notification MC_GN_ROWHEIGHTCHANGING */
-    notif.hdr.hwndFrom = grid->win;
-    notif.hdr.idFrom = GetWindowLong(grid->win, GWL_ID);
-    notif.hdr.code = MC_GN_ROWHEIGHTCHANGING;
-    notif.wColumnOrRow = row;
-    notif.wWidthOrHeight = height;
+    grid_nmcolrowsize_init(grid, &notif, MC_GN_ROWHEIGHTCHANGING, TRUE, row, height);
     if(MC_SEND(grid->notify_win, WM_NOTIFY, notif.hdr.idFrom, &notif)) {
         /* Application suppresses the default processing */
         GRID_TRACE("grid_set_row_height: "
@@ -2125,6 +2851,7 @@ grid_set_row_height(grid_t* grid, WORD row, WORD height)
         grid_labeledit_end(grid, FALSE);
 
     grid->row_heights[row] = height;
+    fenwick_set(&grid->row_index, row, grid_row_height(grid, row));
 
     if(!grid->no_redraw) {
         RECT rect;
@@ -2147,17 +2874,17 @@ grid_set_row_height(grid_t* grid, WORD row, WORD height)
     grid_setup_scrollbars(grid, TRUE);
 
     /* Fire notification MC_GN_ROWHEIGHTCHANGED */
-    notif.hdr.code = MC_GN_ROWHEIGHTCHANGED;
+    notif.hdr.code = (grid->ex_notifications ? MC_GN_ROWHEIGHTCHANGEDEX : MC_GN_ROWHEIGHTCHANGED);
     MC_SEND(grid->notify_win, WM_NOTIFY, notif.hdr.idFrom, &notif);
 
     return 0;
 }
 
 static LONG
-grid_get_row_height(grid_t* grid, WORD row)
+grid_get_row_height(grid_t* grid, DWORD row)
 {
     if(MC_ERR(row >= grid->row_count)) {
-        MC_TRACE("grid_get_row_height: row %hu our of range.", row);
+        MC_TRACE("grid_get_row_height: row %lu our of range.", row);
         SetLastError(ERROR_INVALID_PARAMETER);
         return -1;
     }
@@ -2169,10 +2896,12 @@ static void
 grid_labeledit_callback(void* data, const TCHAR* text, BOOL save)
 {
     grid_t* grid = (grid_t*) data;
-    WORD col = grid->focused_col;
-    WORD row = grid->focused_row;
-    MC_NMGDISPINFO dispinfo;
-    MC_NMGDISPINFO dispinfo2;
+    DWORD col = grid->focused_col;
+    DWORD row = grid->focused_row;
+    grid_nmdispinfo_t dispinfo;
+    grid_nmdispinfo_t dispinfo2;
+    MC_TABLECELL* dispinfo_cell;
+    MC_TABLECELL* dispinfo2_cell;
     table_cell_t* cell;
     void* converted_text;
     BOOL parent_maintains_text;
@@ -2180,7 +2909,7 @@ grid_labeledit_callback(void* data, const TCHAR* text, BOOL save)
     GRID_TRACE("grid_labeledit_callback(%p, %S, %s)",
                grid, text, (save ? "save" : "cancel"));
 
-    cell = (grid->table != NULL ? table_cell(grid->table, col, row) : NULL);
+    cell = (grid->table != NULL ? table_cell(grid->table, col, grid_table_row(grid, row)) : NULL);
     parent_maintains_text = (cell == NULL  ||  cell->text == MC_LPSTR_TEXTCALLBACK);
 
     if(grid->unicode_notifications == MC_IS_UNICODE  ||  text == NULL)
@@ -2195,20 +2924,20 @@ grid_labeledit_callback(void* data, const TCHAR* text, BOOL save)
     grid->labeledit_started = FALSE;
 
     /* Setup MC_NMGDISPINFO for MC_GN_ENDLABELEDIT. */
-    dispinfo.hdr.hwndFrom = grid->win;
-    dispinfo.hdr.idFrom = GetWindowLong(grid->win, GWL_ID);
-    dispinfo.hdr.code = (grid->unicode_notifications ? MC_GN_ENDLABELEDITW : MC_GN_ENDLABELEDITA);
-    dispinfo.wColumn = col;
-    dispinfo.wRow = row;
-    dispinfo.cell.fMask = MC_TCMF_TEXT;
-    dispinfo.cell.lParam = (cell != NULL ? cell->lp : 0);
-    dispinfo.cell.pszText = converted_text;
+    dispinfo_cell = grid_nmdispinfo_init(grid, &dispinfo,
+                (grid->unicode_notifications ? MC_GN_ENDLABELEDITW : MC_GN_ENDLABELEDITA),
+                col, row);
+    dispinfo_cell->fMask = MC_TCMF_TEXT;
+    dispinfo_cell->lParam = (cell != NULL ? cell->lp : 0);
+    dispinfo_cell->pszText = converted_text;
 
     /* Remember copy of MC_NMGDISPINFO for MC_GN_SETDISPINFO below.
      * This prevents issues if parent changes contents of original dispinfo. */
     if(save  &&  parent_maintains_text) {
-        dispinfo2.hdr.code = (grid->unicode_notifications ? MC_GN_SETDISPINFOW : MC_GN_SETDISPINFOA);
-        memcpy(&dispinfo2, &dispinfo, sizeof(MC_NMGDISPINFO));
+        dispinfo2_cell = grid_nmdispinfo_init(grid, &dispinfo2,
+                (grid->unicode_notifications ? MC_GN_SETDISPINFOW : MC_GN_SETDISPINFOA),
+                col, row);
+        memcpy(dispinfo2_cell, dispinfo_cell, sizeof(MC_TABLECELL));
     }
 
     /* Fire MC_GN_ENDLABELEDIT. */
@@ -2223,8 +2952,8 @@ grid_labeledit_callback(void* data, const TCHAR* text, BOOL save)
         if(parent_maintains_text) {
             MC_SEND(grid->notify_win, WM_NOTIFY, dispinfo2.hdr.idFrom, &dispinfo2);
         } else {
-            if(MC_ERR(table_set_cell_data(grid->table, col, row, &dispinfo.cell,
-                        grid->unicode_notifications) != 0)) {
+            if(MC_ERR(table_set_cell_data(grid->table, col, grid_table_row(grid, row),
+                        dispinfo_cell, grid->unicode_notifications) != 0)) {
                 MC_TRACE("grid_labeledit_callback: table_set_cell_data() failed.");
             }
         }
@@ -2235,18 +2964,19 @@ grid_labeledit_callback(void* data, const TCHAR* text, BOOL save)
 }
 
 static HWND
-grid_labeledit_start(grid_t* grid, WORD col, WORD row)
+grid_labeledit_start(grid_t* grid, DWORD col, DWORD row)
 {
     RECT rect;
-    MC_NMGDISPINFO dispinfo;
+    grid_nmdispinfo_t dispinfo;
+    MC_TABLECELL* dispinfo_cell = NULL;
     table_cell_t* cell;
     grid_dispinfo_t di;
     HWND edit_win;
 
-    GRID_TRACE("grid_labeledit_start(%p, %d, %d)", grid, col, row);
+    GRID_TRACE("grid_labeledit_start(%p, %lu, %lu)", grid, col, row);
 
     if(col >= grid->col_count || row >= grid->row_count) {
-        MC_TRACE("grid_labeledit_start: Cell [%d, %d] not valid.", col, row);
+        MC_TRACE("grid_labeledit_start: Cell [%lu, %lu] not valid.", col, row);
         SetLastError(ERROR_INVALID_PARAMETER);
         return NULL;
     }
@@ -2260,7 +2990,7 @@ grid_labeledit_start(grid_t* grid, WORD col, WORD row)
     grid_set_focused_cell(grid, col, row);
 
     if(grid->table != NULL)
-        cell = table_cell(grid->table, col, row);
+        cell = table_cell(grid->table, col, grid_table_row(grid, row));
     else
         cell = NULL;
 
@@ -2286,18 +3016,16 @@ grid_labeledit_start(grid_t* grid, WORD col, WORD row)
     /* Fire MC_GN_BEGINLABELEDIT. Note this is after the edit window is already
      * created as the application may want to get it through MC_GM_GETEDITCONTROL
      * and customize it. */
-    dispinfo.hdr.hwndFrom = grid->win;
-    dispinfo.hdr.idFrom = GetWindowLong(grid->win, GWL_ID);
-    dispinfo.hdr.code = (grid->unicode_notifications ? MC_GN_BEGINLABELEDITW : MC_GN_BEGINLABELEDITA);
-    dispinfo.wColumn = col;
-    dispinfo.wRow = row;
-    dispinfo.cell.fMask = (MC_TCMF_TEXT | MC_TCMF_PARAM | MC_TCMF_FLAGS);
+    dispinfo_cell = grid_nmdispinfo_init(grid, &dispinfo,
+                (grid->unicode_notifications ? MC_GN_BEGINLABELEDITW : MC_GN_BEGINLABELEDITA),
+                col, row);
+    dispinfo_cell->fMask = (MC_TCMF_TEXT | MC_TCMF_PARAM | MC_TCMF_FLAGS);
     if(grid->unicode_notifications == MC_IS_UNICODE)
-        dispinfo.cell.pszText = di.text;
+        dispinfo_cell->pszText = di.text;
     else
-        dispinfo.cell.pszText = mc_str(di.text, MC_STRT, (grid->unicode_notifications ? MC_STRW : MC_STRA));
-    dispinfo.cell.lParam = di.lp;
-    dispinfo.cell.dwFlags = di.flags;
+        dispinfo_cell->pszText = mc_str(di.text, MC_STRT, (grid->unicode_notifications ? MC_STRW : MC_STRA));
+    dispinfo_cell->lParam = di.lp;
+    dispinfo_cell->dwFlags = di.flags;
     if(MC_SEND(grid->notify_win, WM_NOTIFY, dispinfo.hdr.idFrom, &dispinfo) != 0) {
         GRID_TRACE("grid_labeledit_start: MC_GN_BEGINLABELEDIT suppresses "
                    "the label editing.");
@@ -2316,8 +3044,9 @@ grid_labeledit_start(grid_t* grid, WORD col, WORD row)
     grid->labeledit_started = TRUE;
 
 out:
-    if(dispinfo.cell.pszText != di.text  &&  dispinfo.cell.pszText != NULL)
-        free(dispinfo.cell.pszText);
+    if(dispinfo_cell != NULL  &&  dispinfo_cell->pszText != di.text  &&
+       dispinfo_cell->pszText != NULL)
+        free(dispinfo_cell->pszText);
     grid_free_dispinfo(grid, cell, &di);
 
     return edit_win;
@@ -2338,9 +3067,9 @@ grid_labeledit_end(grid_t* grid, BOOL cancel)
 static int
 grid_reset_selection(grid_t* grid)
 {
-    rgn16_t sel;
+    REGION sel;
 
-    rgn16_init(&sel);
+    region_init(&sel);
     if(MC_ERR(grid_install_selection(grid, &sel) != 0)) {
         MC_TRACE("grid_reset_selection: grid_install_selection() failed.");
         return -1;
@@ -2350,11 +3079,11 @@ grid_reset_selection(grid_t* grid)
 }
 
 static int
-grid_select_cell(grid_t* grid, WORD col, WORD row)
+grid_select_cell(grid_t* grid, DWORD col, DWORD row)
 {
-    rgn16_t sel;
+    REGION sel;
 
-    rgn16_init_with_xy(&sel, col, row);
+    region_init_with_xy(&sel, col, row);
     if(MC_ERR(grid_install_selection(grid, &sel) != 0)) {
         MC_TRACE("grid_select_cell: grid_install_selection() failed.");
         return -1;
@@ -2364,12 +3093,12 @@ grid_select_cell(grid_t* grid, WORD col, WORD row)
 }
 
 static int
-grid_select_rect(grid_t* grid, WORD col0, WORD row0, WORD col1, WORD row1)
+grid_select_rect(grid_t* grid, DWORD col0, DWORD row0, DWORD col1, DWORD row1)
 {
-    rgn16_rect_t sel_rect = { col0, row0, col1, row1 };
-    rgn16_t sel;
+    REGION_RECT sel_rect = { col0, row0, col1, row1 };
+    REGION sel;
 
-    rgn16_init_with_rect(&sel, &sel_rect);
+    region_init_with_rect(&sel, &sel_rect);
     if(MC_ERR(grid_install_selection(grid, &sel) != 0)) {
         MC_TRACE("grid_select_rect: grid_install_selection() failed.");
         return -1;
@@ -2379,16 +3108,16 @@ grid_select_rect(grid_t* grid, WORD col0, WORD row0, WORD col1, WORD row1)
 }
 
 static int
-grid_select_rect_UNION(grid_t* grid, WORD col0, WORD row0, WORD col1, WORD row1)
+grid_select_rect_UNION(grid_t* grid, DWORD col0, DWORD row0, DWORD col1, DWORD row1)
 {
-    rgn16_rect_t sel_rect = { col0, row0, col1, row1 };
-    rgn16_t sel;
-    rgn16_t sel_union;
+    REGION_RECT sel_rect = { col0, row0, col1, row1 };
+    REGION sel;
+    REGION sel_union;
 
-    rgn16_init_with_rect(&sel, &sel_rect);
+    region_init_with_rect(&sel, &sel_rect);
 
-    if(MC_ERR(rgn16_union(&sel_union, &sel, &grid->selection) != 0)) {
-        MC_TRACE("grid_select_rect_UNION: rgn16_union() failed.");
+    if(MC_ERR(region_union(&sel_union, &sel, &grid->selection) != 0)) {
+        MC_TRACE("grid_select_rect_UNION: region_union() failed.");
         return -1;
     }
 
@@ -2401,16 +3130,16 @@ grid_select_rect_UNION(grid_t* grid, WORD col0, WORD row0, WORD col1, WORD row1)
 }
 
 static int
-grid_select_rect_XOR(grid_t* grid, WORD col0, WORD row0, WORD col1, WORD row1)
+grid_select_rect_XOR(grid_t* grid, DWORD col0, DWORD row0, DWORD col1, DWORD row1)
 {
-    rgn16_rect_t sel_rect = { col0, row0, col1, row1 };
-    rgn16_t sel;
-    rgn16_t sel_xor;
+    REGION_RECT sel_rect = { col0, row0, col1, row1 };
+    REGION sel;
+    REGION sel_xor;
 
-    rgn16_init_with_rect(&sel, &sel_rect);
+    region_init_with_rect(&sel, &sel_rect);
 
-    if(MC_ERR(rgn16_xor(&sel_xor, &sel, &grid->selection) != 0)) {
-        MC_TRACE("grid_select_rect_XOR: rgn16_xor() failed.");
+    if(MC_ERR(region_xor(&sel_xor, &sel, &grid->selection) != 0)) {
+        MC_TRACE("grid_select_rect_XOR: region_xor() failed.");
         return -1;
     }
 
@@ -2425,8 +3154,8 @@ grid_select_rect_XOR(grid_t* grid, WORD col0, WORD row0, WORD col1, WORD row1)
 static void
 grid_end_sel_drag(grid_t* grid, BOOL cancel)
 {
-    WORD col_count = grid->col_count;
-    WORD row_count = grid->row_count;
+    DWORD col_count = grid->col_count;
+    DWORD row_count = grid->row_count;
 
     MC_ASSERT(grid->seldrag_considering || grid->seldrag_started);
 
@@ -2437,7 +3166,7 @@ grid_end_sel_drag(grid_t* grid, BOOL cancel)
             int drag_hotspot_x, drag_hotspot_y;
             int drag_mode;
             int marquee_x0, marquee_y0, marquee_x1, marquee_y1;
-            WORD col0, row0, col1, row1;
+            DWORD col0, row0, col1, row1;
             int err = -1;
 
             drag_start_x = mousedrag_start_x;
@@ -2468,8 +3197,7 @@ grid_end_sel_drag(grid_t* grid, BOOL cancel)
             if(row1 >= grid->row_count)
                 row1 = grid->row_count - 1;
 
-            GRID_TRACE("grid_end_sel_drag: %d %d %d %d",
-                       (int) col0, (int) row0, (int) col1, (int) row1);
+            GRID_TRACE("grid_end_sel_drag: %lu %lu %lu %lu", col0, row0, col1, row1);
 
             /* Setup the selection. */
             switch(drag_mode) {
@@ -2503,8 +3231,8 @@ grid_end_sel_drag(grid_t* grid, BOOL cancel)
 
                 /* Remember the target of the dragging as the focused cell. */
                 if(grid->style & MC_GS_FOCUSEDCELL) {
-                    WORD focused_col = (drag_start_x < drag_hotspot_x) ? col1 : col0;
-                    WORD focused_row = (drag_start_y < drag_hotspot_y) ? row1 : row0;
+                    DWORD focused_col = (drag_start_x < drag_hotspot_x) ? col1 : col0;
+                    DWORD focused_row = (drag_start_y < drag_hotspot_y) ? row1 : row0;
 
                     grid_set_focused_cell(grid, focused_col, focused_row);
                 }
@@ -2532,31 +3260,29 @@ grid_end_sel_drag(grid_t* grid, BOOL cancel)
 static void
 grid_end_headersize_drag(grid_t* grid, BOOL cancel)
 {
-    MC_NMGCOLROWSIZECHANGE notif;
+    grid_nmcolrowsize_t notif;
+    BOOL is_col = grid->colsizedrag_started;
+    DWORD index = (DWORD) mousedrag_index;
 
     MC_ASSERT(grid->colsizedrag_started  ||  grid->rowsizedrag_started);
 
     if(cancel) {
-        if(grid->colsizedrag_started)
-            grid_set_col_width(grid, mousedrag_index, mousedrag_extra);
+        if(is_col)
+            grid_set_col_width(grid, index, mousedrag_extra);
         else
-            grid_set_row_height(grid, mousedrag_index, mousedrag_extra);
+            grid_set_row_height(grid, index, mousedrag_extra);
     }
 
     mousedrag_stop(grid->win);
     grid->colsizedrag_started = FALSE;
     grid->rowsizedrag_started = FALSE;
 
-    notif.hdr.hwndFrom = grid->win;
-    notif.hdr.idFrom = GetWindowLong(grid->win, GWL_ID);
-    if(grid->colsizedrag_started) {
-        notif.hdr.code = MC_GN_ENDCOLUMNTRACK;
-        notif.wColumnOrRow = mousedrag_index;
-        notif.wWidthOrHeight = grid_col_width(grid, mousedrag_index);
+    if(is_col) {
+        grid_nmcolrowsize_init(grid, &notif, MC_GN_ENDCOLUMNTRACK, FALSE,
+                               index, grid_col_width(grid, index));
     } else {
-        notif.hdr.code = MC_GN_ENDROWTRACK;
-        notif.wColumnOrRow = mousedrag_index;
-        notif.wWidthOrHeight = grid_row_height(grid, mousedrag_index);
+        grid_nmcolrowsize_init(grid, &notif, MC_GN_ENDROWTRACK, TRUE,
+                               index, grid_row_height(grid, index));
     }
     MC_SEND(grid->notify_win, WM_NOTIFY, notif.hdr.idFrom, &notif);
 
@@ -2575,14 +3301,20 @@ grid_end_any_drag(grid_t* grid, BOOL cancel)
         grid_end_headersize_drag(grid, TRUE);
 }
 
-static void
-grid_ensure_visible(grid_t* grid, WORD col, WORD row, BOOL partial)
+static int
+grid_ensure_visible(grid_t* grid, DWORD col, DWORD row, BOOL partial)
 {
     RECT viewport_rect;
     RECT cell_rect;
     int scroll_x = grid->scroll_x;
     int scroll_y = grid->scroll_y;
 
+    if(MC_ERR(col >= grid->col_count  ||  row >= grid->row_count)) {
+        MC_TRACE("grid_ensure_visible: Cell [%lu, %lu] not valid.", col, row);
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return -1;
+    }
+
     GetClientRect(grid->win, &viewport_rect);
     viewport_rect.left = grid_header_width(grid);
     viewport_rect.top = grid_header_height(grid);
@@ -2590,9 +3322,9 @@ grid_ensure_visible(grid_t* grid, WORD col, WORD row, BOOL partial)
     grid_cell_rect(grid, col, row, &cell_rect);
 
     if(partial  &&  mc_rect_overlaps_rect(&viewport_rect, &cell_rect))
-        return;
+        return 0;
     if(mc_rect_contains_rect(&viewport_rect, &cell_rect))
-        return;
+        return 0;
 
     if(cell_rect.left < viewport_rect.left)
         scroll_x -= viewport_rect.left - cell_rect.left;
@@ -2605,14 +3337,15 @@ grid_ensure_visible(grid_t* grid, WORD col, WORD row, BOOL partial)
         scroll_y += cell_rect.bottom - viewport_rect.bottom;
 
     grid_scroll_xy(grid, scroll_x, scroll_y);
+    return 0;
 }
 
 static void
 grid_mouse_move(grid_t* grid, int x, int y)
 {
     RECT cell_rect;
-    WORD hot_col = COL_INVALID;
-    WORD hot_row = ROW_INVALID;
+    DWORD hot_col = COL_INVALID;
+    DWORD hot_row = ROW_INVALID;
 
     /* Updating selection dragging (marquee). */
     if(grid->seldrag_considering) {
@@ -2655,10 +3388,10 @@ grid_mouse_move(grid_t* grid, int x, int y)
     if(grid->colsizedrag_started) {
         int right;
 
-        grid_cell_rect(grid, mousedrag_index, MC_TABLE_HEADER, &cell_rect);
+        grid_cell_rect(grid, (DWORD) mousedrag_index, GRID_HEADER, &cell_rect);
         right = MC_MAX(cell_rect.left, x - mousedrag_hotspot_x);
         if(right != cell_rect.right)
-            grid_set_col_width(grid, mousedrag_index, right - cell_rect.left);
+            grid_set_col_width(grid, (DWORD) mousedrag_index, right - cell_rect.left);
 
         return;
     }
@@ -2667,10 +3400,10 @@ grid_mouse_move(grid_t* grid, int x, int y)
     if(grid->rowsizedrag_started) {
         int bottom;
 
-        grid_cell_rect(grid, MC_TABLE_HEADER, mousedrag_index, &cell_rect);
+        grid_cell_rect(grid, GRID_HEADER, (DWORD) mousedrag_index, &cell_rect);
         bottom = MC_MAX(cell_rect.top, y - mousedrag_hotspot_y);
         if(bottom != cell_rect.bottom)
-            grid_set_row_height(grid, mousedrag_index, bottom - cell_rect.top);
+            grid_set_row_height(grid, (DWORD) mousedrag_index, bottom - cell_rect.top);
 
         return;
     }
@@ -2678,15 +3411,15 @@ grid_mouse_move(grid_t* grid, int x, int y)
     /* Hot tracking. */
     if(grid->theme_listview != NULL  &&  grid->theme_listitem_defined) {
         /* We paint hot item differently only with themes. */
-        MC_GHITTESTINFO info;
+        MC_GHITTESTINFOEX info;
 
         info.pt.x = x;
         info.pt.y = y;
-        grid_hit_test(grid, &info);
+        grid_hit_test_ex(grid, &info, NULL);
 
         if(info.flags & MC_GHT_ONNORMALCELL) {
-            hot_col = info.wColumn;
-            hot_row = info.wRow;
+            hot_col = info.dwColumn;
+            hot_row = info.dwRow;
         }
     }
     if(hot_col != grid->hot_col  ||  hot_row != grid->hot_row) {
@@ -2698,8 +3431,8 @@ grid_mouse_move(grid_t* grid, int x, int y)
                 grid_invalidate_cell(grid, hot_col, hot_row, FALSE);
         }
 
-        hot_col = grid->hot_col;
-        hot_row = grid->hot_row;
+        grid->hot_col = hot_col;
+        grid->hot_row = hot_row;
     }
 
     /* Ask for WM_LEAVE */
@@ -2721,30 +3454,30 @@ grid_mouse_leave(grid_t* grid)
 }
 
 static int
-grid_toggle_cell_selection(grid_t* grid, WORD col, WORD row)
+grid_toggle_cell_selection(grid_t* grid, DWORD col, DWORD row)
 {
-    rgn16_t sel;
+    REGION sel;
 
     if((grid->style & GRID_GS_SELMASK) == MC_GS_COMPLEXSEL) {
-        rgn16_t tmp;
+        REGION tmp;
         int err;
 
-        rgn16_init_with_xy(&tmp, col, row);
-        err = rgn16_xor(&sel, &grid->selection, &tmp);
-        rgn16_fini(&tmp);
+        region_init_with_xy(&tmp, col, row);
+        err = region_xor(&sel, &grid->selection, &tmp);
+        region_fini(&tmp);
         if(MC_ERR(err != 0)) {
-            MC_TRACE("grid_toggle_cell_selection: rgn16_xor() failed.");
+            MC_TRACE("grid_toggle_cell_selection: region_xor() failed.");
             return -1;
         }
     } else {
         /* In selection modes simpler then MC_GS_COMPLEXSEL we make the toggle
          * only work only within a single cell. */
-        const rgn16_rect_t* ext = rgn16_extents(&grid->selection);
+        const REGION_RECT* ext = region_extents(&grid->selection);
         if(ext != NULL  &&  col == ext->x0  &&  row == ext->y0  &&
                             col+1 == ext->x1  &&  row+1 == ext->y1)
-            rgn16_init(&sel);
+            region_init(&sel);
         else
-            rgn16_init_with_xy(&sel, col, row);
+            region_init_with_xy(&sel, col, row);
     }
 
     if(MC_ERR(grid_install_selection(grid, &sel) != 0)) {
@@ -2761,7 +3494,7 @@ grid_left_button_down(grid_t* grid, int x, int y)
     static const DWORD col_track_mask = MC_GHT_ONCOLUMNDIVIDER | MC_GHT_ONCOLUMNDIVOPEN;
     static const DWORD row_track_mask = MC_GHT_ONROWDIVIDER | MC_GHT_ONROWDIVOPEN;
 
-    MC_GHITTESTINFO info;
+    MC_GHITTESTINFOEX info;
     RECT cell_rect;
     BOOL control_pressed = (GetKeyState(VK_CONTROL) & 0x8000);
     BOOL shift_pressed = (GetKeyState(VK_SHIFT) & 0x8000);
@@ -2785,19 +3518,15 @@ grid_left_button_down(grid_t* grid, int x, int y)
 
     /* Column/row divider? Consider dragging mode to resize the column/row. */
     if(info.flags & (col_track_mask | row_track_mask)) {
-        MC_NMGCOLROWSIZECHANGE notif;
+        grid_nmcolrowsize_t notif;
 
         /* Fire MC_GN_BEGINCOLUMNTRACK or MC_GN_BEGINROWTRACK */
-        notif.hdr.hwndFrom = grid->win;
-        notif.hdr.idFrom = GetWindowLong(grid->win, GWL_ID);
         if(info.flags & col_track_mask) {
-            notif.hdr.code = MC_GN_BEGINCOLUMNTRACK;
-            notif.wColumnOrRow = info.wColumn;
-            notif.wWidthOrHeight = grid_col_width(grid, info.wColumn);
+            grid_nmcolrowsize_init(grid, &notif, MC_GN_BEGINCOLUMNTRACK, FALSE,
+                        info.dwColumn, grid_col_width(grid, info.dwColumn));
         } else {
-            notif.hdr.code = MC_GN_BEGINROWTRACK;
-            notif.wColumnOrRow = info.wRow;
-            notif.wWidthOrHeight = grid_row_height(grid, info.wRow);
+            grid_nmcolrowsize_init(grid, &notif, MC_GN_BEGINROWTRACK, TRUE,
+                        info.dwRow, grid_row_height(grid, info.dwRow));
         }
         if(MC_SEND(grid->notify_win, WM_NOTIFY, notif.hdr.idFrom, &notif) != 0) {
             /* Application suppresses the dragging mode. */
@@ -2808,13 +3537,13 @@ grid_left_button_down(grid_t* grid, int x, int y)
         if(mousedrag_start(grid->win, x, y) == MOUSEDRAG_STARTED) {
             if(info.flags & col_track_mask) {
                 grid->colsizedrag_started = TRUE;
-                mousedrag_index = info.wColumn;
-                mousedrag_extra = grid_col_width(grid, info.wColumn);
+                mousedrag_index = (int) info.dwColumn;
+                mousedrag_extra = grid_col_width(grid, info.dwColumn);
                 mousedrag_hotspot_x = x - cell_rect.right;
             } else {
                 grid->rowsizedrag_started = TRUE;
-                mousedrag_index = info.wRow;
-                mousedrag_extra = grid_row_height(grid, info.wRow);
+                mousedrag_index = (int) info.dwRow;
+                mousedrag_extra = grid_row_height(grid, info.dwRow);
                 mousedrag_hotspot_y = y - cell_rect.bottom;
             }
             SetCapture(grid->win);
@@ -2826,12 +3555,12 @@ grid_left_button_down(grid_t* grid, int x, int y)
 
     /* If clicking into focused cell, we start considering about its editing. */
     if(grid->style & MC_GS_EDITLABELS) {
-        if(info.wColumn == grid->focused_col && info.wRow == grid->focused_row) {
+        if(info.dwColumn == grid->focused_col && info.dwRow == grid->focused_row) {
             MC_ASSERT(!grid->labeledit_started);
             MC_ASSERT(!grid->labeledit_considering);
             grid->labeledit_considering = TRUE;
             GRID_TRACE("grid_left_button_down: Starting consideration of label "
-                       "edit for cell %d %d", grid->focused_col, grid->focused_row);
+                       "edit for cell %lu %lu", grid->focused_col, grid->focused_row);
         }
     }
 
@@ -2872,12 +3601,12 @@ grid_left_button_down(grid_t* grid, int x, int y)
         case MC_GS_SINGLESEL:
             /* Normal click sets the selection to the given cell. */
             if(info.flags & MC_GHT_ONNORMALCELL) {
-                if(grid_select_cell(grid, info.wColumn, info.wRow) == 0) {
-                    grid->selmark_col = info.wColumn;
-                    grid->selmark_row = info.wRow;
+                if(grid_select_cell(grid, info.dwColumn, info.dwRow) == 0) {
+                    grid->selmark_col = info.dwColumn;
+                    grid->selmark_row = info.dwRow;
 
                     if(grid->style & MC_GS_FOCUSEDCELL)
-                        grid_set_focused_cell(grid, info.wColumn, info.wRow);
+                        grid_set_focused_cell(grid, info.dwColumn, info.dwRow);
                 } else {
                     MC_TRACE("grid_left_button_down: grid_select_cell() failed.");
                 }
@@ -2907,13 +3636,13 @@ grid_left_button_up(grid_t* grid, int x, int y)
 
     /* Consider label editing. */
     if(grid->labeledit_considering) {
-        MC_GHITTESTINFO info;
+        MC_GHITTESTINFOEX info;
 
         info.pt.x = x;
         info.pt.y = y;
-        grid_hit_test(grid, &info);
+        grid_hit_test_ex(grid, &info, NULL);
 
-        if(info.wColumn == grid->focused_col  &&  info.wRow == grid->focused_row) {
+        if(info.dwColumn == grid->focused_col  &&  info.dwRow == grid->focused_row) {
             /* Note we delay the start after double-click timeout to give
              * WM_LBUTTONDBLCLK a chance. If the WM_LBUTTONDBLCLK comes in the
              * mean time we cancel the timer. */
@@ -2937,13 +3666,13 @@ grid_left_button_dblclick(grid_t* grid, int x, int y)
 
     /* Edit cell if MC_GS_EDITLABELS is set. */
     if(grid->style & MC_GS_EDITLABELS) {
-        MC_GHITTESTINFO info;
+        MC_GHITTESTINFOEX info;
 
         info.pt.x = x;
         info.pt.y = y;
-        grid_hit_test(grid, &info);
+        grid_hit_test_ex(grid, &info, NULL);
 
-        grid_labeledit_start(grid, info.wColumn, info.wRow);
+        grid_labeledit_start(grid, info.dwColumn, info.dwRow);
     }
 }
 
@@ -2965,8 +3694,8 @@ grid_right_button(grid_t* grid, int x, int y, BOOL dblclick)
     MC_SEND(grid->notify_win, WM_CONTEXTMENU, grid->win, MAKELPARAM(pt.x, pt.y));
 }
 
-static WORD
-grid_row_pgup_or_pgdn(grid_t* grid, WORD row, BOOL is_down)
+static DWORD
+grid_row_pgup_or_pgdn(grid_t* grid, DWORD row, BOOL is_down)
 {
     SCROLLINFO si;
     RECT rect;
@@ -2982,7 +3711,7 @@ grid_row_pgup_or_pgdn(grid_t* grid, WORD row, BOOL is_down)
         y = rect.bottom;
         do {
             y += grid_row_height(grid, row);
-            if(row >= grid->row_count)
+            if(row + 1 >= grid->row_count)
                 break;
             row++;
         } while(y < rect.top + (int)si.nPage);
@@ -3000,7 +3729,7 @@ grid_row_pgup_or_pgdn(grid_t* grid, WORD row, BOOL is_down)
 }
 
 static void
-grid_move_focus(grid_t* grid, WORD col, WORD row)
+grid_move_focus(grid_t* grid, DWORD col, DWORD row)
 {
     if(grid->col_count == 0  ||  grid->row_count == 0) {
         /* Empty table or no attached table. */
@@ -3016,8 +3745,8 @@ grid_move_focus(grid_t* grid, WORD col, WORD row)
 static void
 grid_key_down(grid_t* grid, int key)
 {
-    WORD old_focused_col = grid->focused_col;
-    WORD old_focused_row = grid->focused_row;
+    DWORD old_focused_col = grid->focused_col;
+    DWORD old_focused_row = grid->focused_row;
     BOOL control_pressed = (GetKeyState(VK_CONTROL) & 0x8000);
     BOOL shift_pressed = (GetKeyState(VK_SHIFT) & 0x8000);
     int err;
@@ -3098,7 +3827,7 @@ grid_key_down(grid_t* grid, int key)
 
         case VK_PRIOR:
             if(grid->style & MC_GS_FOCUSEDCELL) {
-                WORD row = grid_row_pgup_or_pgdn(grid, grid->focused_row, FALSE);
+                DWORD row = grid_row_pgup_or_pgdn(grid, grid->focused_row, FALSE);
                 grid_scroll(grid, TRUE, SB_PAGEUP, 1);
                 grid_move_focus(grid, grid->focused_col, row);
             } else {
@@ -3108,7 +3837,7 @@ grid_key_down(grid_t* grid, int key)
 
         case VK_NEXT:
             if(grid->style & MC_GS_FOCUSEDCELL) {
-                WORD row = grid_row_pgup_or_pgdn(grid, grid->focused_row, TRUE);
+                DWORD row = grid_row_pgup_or_pgdn(grid, grid->focused_row, TRUE);
                 grid_scroll(grid, TRUE, SB_PAGEDOWN, 1);
                 grid_move_focus(grid, grid->focused_col, row);
             } else {
@@ -3181,7 +3910,7 @@ grid_set_table(grid_t* grid, table_t* table)
     if(table != NULL) {
         table_ref(table);
     } else if(!(grid->style & (MC_GS_NOTABLECREATE | MC_GS_OWNERDATA))) {
-        table = table_create(0, 0);
+        table = table_create(0, 0, 0);
         if(MC_ERR(table == NULL)) {
             MC_TRACE("grid_set_table: table_create() failed.");
             return -1;
@@ -3200,10 +3929,16 @@ grid_set_table(grid_t* grid, table_t* table)
     if(grid->labeledit_started)
         grid_labeledit_end(grid, TRUE);
 
-    if(grid->table != NULL) {
+    /* The sort/filter view belongs to the old table. */
+    if(grid->view != NULL) {
+        table_view_uninstall_view(grid->view, grid);
+        table_view_destroy(grid->view);
+        grid->view = NULL;
+    } else if(grid->table != NULL) {
         table_uninstall_view(grid->table, grid);
-        table_unref(grid->table);
     }
+    if(grid->table != NULL)
+        table_unref(grid->table);
 
     grid->table = table;
 
@@ -3222,8 +3957,12 @@ grid_set_table(grid_t* grid, table_t* table)
 
     grid->focused_col = 0;
     grid->focused_row = 0;
+    grid->ex_notifications = (grid->row_count >= MC_TABLE_HEADER);
 
-    rgn16_clear(&grid->selection);
+    region_clear(&grid->selection);
+    region_cursor_init(&grid->sel_cursor, &grid->selection);
+    free(grid->selection_rects);
+    grid->selection_rects = NULL;
     grid->selmark_col = COL_INVALID;
     grid->selmark_row = ROW_INVALID;
 
@@ -3244,10 +3983,189 @@ grid_set_table(grid_t* grid, table_t* table)
     return 0;
 }
 
+static table_view_t*
+grid_get_view(grid_t* grid)
+{
+    table_view_t* view;
+
+    if(grid->view != NULL)
+        return grid->view;
+
+    if(MC_ERR(grid->table == NULL)) {
+        MC_TRACE("grid_get_view: No table installed.");
+        SetLastError(ERROR_NOT_SUPPORTED);
+        return NULL;
+    }
+
+    view = table_view_create(grid->table);
+    if(MC_ERR(view == NULL)) {
+        MC_TRACE("grid_get_view: table_view_create() failed.");
+        return NULL;
+    }
+
+    if(MC_ERR(table_view_install_view(view, grid, grid_refresh) != 0)) {
+        MC_TRACE("grid_get_view: table_view_install_view() failed.");
+        table_view_destroy(view);
+        return NULL;
+    }
+
+    /* From now on, we see the table only through the view. */
+    table_uninstall_view(grid->table, grid);
+    grid->view = view;
+    return view;
+}
+
+static int
+grid_sort(grid_t* grid, UINT key_count, const MC_GSORTKEY* keys)
+{
+    table_view_t* view;
+    table_sort_key_t* sort_keys = NULL;
+    UINT i;
+    int ret;
+
+    GRID_TRACE("grid_sort(%p, %u, %p)", grid, key_count, keys);
+
+    if(MC_ERR(key_count > 0  &&  keys == NULL)  ||  MC_ERR(key_count > 0xffff)) {
+        MC_TRACE("grid_sort: Invalid sort keys.");
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return -1;
+    }
+
+    view = grid_get_view(grid);
+    if(MC_ERR(view == NULL)) {
+        MC_TRACE("grid_sort: grid_get_view() failed.");
+        return -1;
+    }
+
+    if(grid->labeledit_started)
+        grid_labeledit_end(grid, FALSE);
+
+    if(key_count > 0) {
+        sort_keys = (table_sort_key_t*) malloc(key_count * sizeof(table_sort_key_t));
+        if(MC_ERR(sort_keys == NULL)) {
+            MC_TRACE("grid_sort: malloc() failed.");
+            return -1;
+        }
+        for(i = 0; i < key_count; i++) {
+            sort_keys[i].col = keys[i].wColumn;
+            sort_keys[i].flags = ((keys[i].dwFlags & MC_GSKF_DESCENDING) ? TABLE_SORT_DESCENDING : 0);
+            if(MC_ERR(keys[i].dwFlags & ~MC_GSKF_DESCENDING)) {
+                MC_TRACE("grid_sort: Unsupported flags 0x%lx", keys[i].dwFlags);
+                SetLastError(ERROR_INVALID_PARAMETER);
+                free(sort_keys);
+                return -1;
+            }
+        }
+    }
+
+    ret = table_view_set_sort(view, sort_keys, (WORD) key_count);
+    if(MC_ERR(ret != 0))
+        MC_TRACE("grid_sort: table_view_set_sort() failed.");
+
+    free(sort_keys);
+    return ret;
+}
+
+static int
+grid_show_row(grid_t* grid, DWORD row, BOOL show)
+{
+    table_view_t* view;
+
+    GRID_TRACE("grid_show_row(%p, %lu, %d)", grid, row, show);
+
+    view = grid_get_view(grid);
+    if(MC_ERR(view == NULL)) {
+        MC_TRACE("grid_show_row: grid_get_view() failed.");
+        return -1;
+    }
+
+    if(grid->labeledit_started)
+        grid_labeledit_end(grid, FALSE);
+
+    if(MC_ERR(table_view_show_row(view, row, show) != 0)) {
+        MC_TRACE("grid_show_row: table_view_show_row() failed.");
+        return -1;
+    }
+
+    return 0;
+}
+
+static WORD
+grid_get_table_row(grid_t* grid, WORD row)
+{
+    if(row >= grid->row_count)
+        return (WORD) -1;
+    return (WORD) grid_table_row(grid, row);
+}
+
+static WORD
+grid_get_view_row(grid_t* grid, WORD table_row)
+{
+    if(grid->view == NULL)
+        return (table_row < grid->row_count ? table_row : (WORD) -1);
+
+    if(table_row >= grid->view->table_row_count)
+        return (WORD) -1;
+    return (WORD) table_view_view_row(grid->view, table_row);   /* (WORD) TABLE_VIEW_HIDDEN == (WORD) -1 */
+}
+
+static int
+grid_set_data_provider(grid_t* grid, const MC_GDATAPROVIDERW* provider, BOOL unicode)
+{
+    size_t capacity;
+
+    if(provider != NULL) {
+        if(MC_ERR(!(grid->style & MC_GS_OWNERDATA))) {
+            MC_TRACE("grid_set_data_provider: Not supported without MC_GS_OWNERDATA.");
+            SetLastError(ERROR_NOT_SUPPORTED);
+            return -1;
+        }
+        if(MC_ERR(provider->pfnGetData == NULL)) {
+            MC_TRACE("grid_set_data_provider: pfnGetData == NULL");
+            SetLastError(ERROR_INVALID_PARAMETER);
+            return -1;
+        }
+    }
+
+    /* Stop the worker thread of the old cache before we touch anything it
+     * may be using. */
+    if(grid->cellcache != NULL) {
+        cellcache_destroy(grid->cellcache);
+        grid->cellcache = NULL;
+    }
+
+    if(provider != NULL) {
+        grid->data_proc = (void*) provider->pfnGetData;
+        grid->data_ctx = provider->pContext;
+        grid->data_unicode = unicode;
+
+        capacity = (provider->uCacheSize != 0 ? provider->uCacheSize : GRID_DEFAULT_CACHE_SIZE);
+        grid->cellcache = cellcache_create(capacity, grid_fetch_cell, grid_fetch_notify, grid);
+        if(MC_ERR(grid->cellcache == NULL)) {
+            MC_TRACE("grid_set_data_provider: cellcache_create() failed.");
+            return -1;
+        }
+        grid_reset_request(grid);
+    } else {
+        grid->data_proc = NULL;
+        grid->data_ctx = NULL;
+    }
+
+    /* Make grid_paint() send MC_GN_ODCACHEHINT again. */
+    grid->cache_hint[0] = 0;
+    grid->cache_hint[1] = 0;
+    grid->cache_hint[2] = 0;
+    grid->cache_hint[3] = 0;
+
+    if(!grid->no_redraw)
+        InvalidateRect(grid->win, NULL, TRUE);
+    return 0;
+}
+
 static int
-grid_resize_table(grid_t* grid, WORD col_count, WORD row_count)
+grid_resize_table(grid_t* grid, DWORD col_count, DWORD row_count)
 {
-    GRID_TRACE("grid_resize_table(%d, %d)", (int) col_count, (int) row_count);
+    GRID_TRACE("grid_resize_table(%lu, %lu)", col_count, row_count);
 
     if(grid->labeledit_started)
         grid_labeledit_end(grid, FALSE);
@@ -3266,6 +4184,12 @@ grid_resize_table(grid_t* grid, WORD col_count, WORD row_count)
         grid->col_count = col_count;
         grid->row_count = row_count;
 
+        /* For owner data, resizing usually means the data have changed. */
+        if(grid->cellcache != NULL) {
+            cellcache_invalidate(grid->cellcache, NULL);
+            grid_reset_request(grid);
+        }
+
         if(!grid->no_redraw) {
             InvalidateRect(grid->win, NULL, TRUE);
             grid_setup_scrollbars(grid, TRUE);
@@ -3275,6 +4199,31 @@ grid_resize_table(grid_t* grid, WORD col_count, WORD row_count)
     return 0;
 }
 
+static int
+grid_resize_ex(grid_t* grid, WORD col_count, DWORD row_count)
+{
+    GRID_TRACE("grid_resize_ex(%hu, %lu)", col_count, row_count);
+
+    /* The scrolling works with int pixel offsets, and the row index
+     * (grid->row_index) needs an int64_t per row, so cap the row count
+     * accordingly. */
+    if(MC_ERR(row_count >= GRID_CACHE_HEADER  ||
+              (uint64_t) row_count * grid->def_row_height > INT_MAX  ||
+              (uint64_t) row_count > SIZE_MAX / sizeof(int64_t))) {
+        MC_TRACE("grid_resize_ex: Too many rows (%lu).", row_count);
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return -1;
+    }
+
+    if(MC_ERR(grid_resize_table(grid, col_count, row_count) != 0)) {
+        MC_TRACE("grid_resize_ex: grid_resize_table() failed.");
+        return -1;
+    }
+
+    grid->ex_notifications = TRUE;
+    return 0;
+}
+
 static int
 grid_clear(grid_t* grid, DWORD what)
 {
@@ -3292,7 +4241,7 @@ grid_clear(grid_t* grid, DWORD what)
 }
 
 static int
-grid_set_cell(grid_t* grid, WORD col, WORD row, MC_TABLECELL* cell, BOOL unicode)
+grid_set_cell(grid_t* grid, DWORD col, DWORD row, MC_TABLECELL* cell, BOOL unicode)
 {
     if(MC_ERR(grid->table == NULL)) {
         SetLastError(ERROR_INVALID_HANDLE);
@@ -3300,10 +4249,17 @@ grid_set_cell(grid_t* grid, WORD col, WORD row, MC_TABLECELL* cell, BOOL unicode
         return -1;
     }
 
+    if(MC_ERR(grid->view != NULL  &&  row != GRID_HEADER  &&  row >= grid->row_count)) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        MC_TRACE("grid_set_cell: Row %lu does not exist.", row);
+        return -1;
+    }
+
     if(grid->labeledit_started)
         grid_labeledit_end(grid, FALSE);
 
-    if(MC_ERR(table_set_cell_data(grid->table, col, row, cell, unicode) != 0)) {
+    if(MC_ERR(table_set_cell_data(grid->table, col, grid_table_row(grid, row),
+                                  cell, unicode) != 0)) {
         MC_TRACE("grid_set_cell: table_set_cell_data() failed.");
         return -1;
     }
@@ -3312,7 +4268,7 @@ grid_set_cell(grid_t* grid, WORD col, WORD row, MC_TABLECELL* cell, BOOL unicode
 }
 
 static int
-grid_get_cell(grid_t* grid, WORD col, WORD row, MC_TABLECELL* cell, BOOL unicode)
+grid_get_cell(grid_t* grid, DWORD col, DWORD row, MC_TABLECELL* cell, BOOL unicode)
 {
     table_cell_t* c;
     grid_dispinfo_t di;
@@ -3323,7 +4279,13 @@ grid_get_cell(grid_t* grid, WORD col, WORD row, MC_TABLECELL* cell, BOOL unicode
         return -1;
     }
 
-    c = table_get_cell(grid->table, col, row);
+    if(MC_ERR(grid->view != NULL  &&  row != GRID_HEADER  &&  row >= grid->row_count)) {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        MC_TRACE("grid_get_cell: Row %lu does not exist.", row);
+        return -1;
+    }
+
+    c = table_get_cell(grid->table, col, grid_table_row(grid, row));
     if(MC_ERR(c == NULL)) {
         MC_TRACE("grid_get_cell: table_get_cell() failed.");
         return -1;
@@ -3332,7 +4294,7 @@ grid_get_cell(grid_t* grid, WORD col, WORD row, MC_TABLECELL* cell, BOOL unicode
     grid_get_dispinfo(grid, col, row, c, &di, cell->fMask);
 
     if(cell->fMask & MC_TCMF_TEXT) {
-        mc_str_inbuf(c->text, MC_STRT, cell->pszText,
+        mc_str_inbuf(di.text, MC_STRT, cell->pszText,
              (unicode ? MC_STRW : MC_STRA), cell->cchTextMax);
     }
 
@@ -3346,6 +4308,21 @@ grid_get_cell(grid_t* grid, WORD col, WORD row, MC_TABLECELL* cell, BOOL unicode
     return 0;
 }
 
+static int
+grid_get_cell_rect(grid_t* grid, DWORD col, DWORD row, RECT* rect)
+{
+    if(MC_ERR(col >= grid->col_count  ||  row >= grid->row_count)) {
+        MC_TRACE("grid_get_cell_rect: Column or row index out of range "
+                 "(size: %lux%lu; requested [%lu,%lu])",
+                 grid->col_count, grid->row_count, col, row);
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return -1;
+    }
+
+    grid_cell_rect(grid, col, row, rect);
+    return 0;
+}
+
 static void
 grid_notify_format(grid_t* grid)
 {
@@ -3388,7 +4365,11 @@ grid_style_changed(grid_t* grid, STYLESTRUCT* ss)
     grid->style = ss->styleNew;
 
     if((ss->styleNew & MC_GS_OWNERDATA) != (ss->styleOld & MC_GS_OWNERDATA)) {
+        grid_set_data_provider(grid, NULL, FALSE);
         grid_set_table(grid, NULL);
+    } else if(grid->cellcache != NULL) {
+        /* Header styles may change what cells we need. */
+        grid_reset_request(grid);
     }
 
     if((ss->styleNew & GRID_GS_SELMASK) != (ss->styleOld & GRID_GS_SELMASK)) {
@@ -3443,7 +4424,10 @@ grid_nccreate(HWND win, CREATESTRUCT* cs)
     grid->style = cs->style;
     grid->rtl = mc_is_rtl_exstyle(cs->dwExStyle);
 
-    rgn16_init(&grid->selection);
+    region_init(&grid->selection);
+    region_cursor_init(&grid->sel_cursor, &grid->selection);
+    fenwick_init(&grid->col_index);
+    fenwick_init(&grid->row_index);
 
     grid_set_geometry(grid, NULL, FALSE);
     grid_notify_format(grid);
@@ -3468,8 +4452,20 @@ grid_create(grid_t* grid)
 static void
 grid_destroy(grid_t* grid)
 {
-    if(grid->table != NULL) {
+    if(grid->cellcache != NULL) {
+        cellcache_destroy(grid->cellcache);
+        grid->cellcache = NULL;
+    }
+
+    if(grid->view != NULL) {
+        table_view_uninstall_view(grid->view, grid);
+        table_view_destroy(grid->view);
+        grid->view = NULL;
+    } else if(grid->table != NULL) {
         table_uninstall_view(grid->table, grid);
+    }
+
+    if(grid->table != NULL) {
         table_unref(grid->table);
         grid->table = NULL;
     }
@@ -3486,7 +4482,10 @@ grid_ncdestroy(grid_t* grid)
         free(grid->col_widths);
     if(grid->row_heights)
         free(grid->row_heights);
-    rgn16_fini(&grid->selection);
+    fenwick_fini(&grid->col_index);
+    fenwick_fini(&grid->row_index);
+    region_fini(&grid->selection);
+    free(grid->selection_rects);
     free(grid);
 }
 
@@ -3514,6 +4513,10 @@ grid_proc(HWND win, UINT msg, WPARAM wp, LPARAM lp)
             /* Keep it on WM_PAINT */
             return FALSE;
 
+        case GRID_WM_FETCHED:
+            grid_fetched(grid);
+            return 0;
+
         case MC_GM_GETTABLE:
             return (LRESULT) grid->table;
 
@@ -3527,19 +4530,24 @@ grid_proc(HWND win, UINT msg, WPARAM wp, LPARAM lp)
             return grid->row_count;
 
         case MC_GM_RESIZE:
-            return (grid_resize_table(grid, LOWORD(wp), HIWORD(wp)) == 0 ? TRUE : FALSE);
+            if(grid_resize_table(grid, LOWORD(wp), HIWORD(wp)) != 0)
+                return FALSE;
+            grid->ex_notifications = FALSE;
+            return TRUE;
 
         case MC_GM_CLEAR:
             return (grid_clear(grid, wp) == 0 ? TRUE : FALSE);
 
         case MC_GM_SETCELLW:
         case MC_GM_SETCELLA:
-            return (grid_set_cell(grid, LOWORD(wp), HIWORD(wp), (MC_TABLECELL*)lp,
+            return (grid_set_cell(grid, grid_wide_index(LOWORD(wp)),
+                                  grid_wide_index(HIWORD(wp)), (MC_TABLECELL*)lp,
                                   (msg == MC_GM_SETCELLW)) == 0 ? TRUE : FALSE);
 
         case MC_GM_GETCELLW:
         case MC_GM_GETCELLA:
-            return (grid_get_cell(grid, LOWORD(wp), HIWORD(wp), (MC_TABLECELL*)lp,
+            return (grid_get_cell(grid, grid_wide_index(LOWORD(wp)),
+                                  grid_wide_index(HIWORD(wp)), (MC_TABLECELL*)lp,
                                   (msg == MC_GM_GETCELLW)) == 0 ? TRUE : FALSE);
 
         case MC_GM_SETGEOMETRY:
@@ -3549,62 +4557,37 @@ grid_proc(HWND win, UINT msg, WPARAM wp, LPARAM lp)
             return (grid_get_geometry(grid, (MC_GGEOMETRY*)lp) == 0 ? TRUE : FALSE);
 
         case MC_GM_REDRAWCELLS:
-            return (grid_redraw_cells(grid, LOWORD(wp), HIWORD(wp),
-                                      LOWORD(lp), LOWORD(lp)) == 0 ? TRUE : FALSE);
+            return (grid_redraw_cells(grid, grid_wide_index(LOWORD(wp)),
+                                      grid_wide_index(HIWORD(wp)),
+                                      grid_wide_index(LOWORD(lp)),
+                                      grid_wide_index(HIWORD(lp))) == 0 ? TRUE : FALSE);
 
         case MC_GM_SETCOLUMNWIDTH:
-            return (grid_set_col_width(grid, wp, LOWORD(lp)) == 0 ? TRUE : FALSE);
+            return (grid_set_col_width(grid, (DWORD) wp, LOWORD(lp)) == 0 ? TRUE : FALSE);
 
         case MC_GM_GETCOLUMNWIDTH:
-            return grid_get_col_width(grid, wp);
+            return grid_get_col_width(grid, (DWORD) wp);
 
         case MC_GM_SETROWHEIGHT:
-            return (grid_set_row_height(grid, wp, LOWORD(lp)) == 0 ? TRUE : FALSE);
+            return (grid_set_row_height(grid, (DWORD) wp, LOWORD(lp)) == 0 ? TRUE : FALSE);
 
         case MC_GM_GETROWHEIGHT:
-            return grid_get_row_height(grid, wp);
+            return grid_get_row_height(grid, (DWORD) wp);
 
         case MC_GM_HITTEST:
             return (LRESULT) grid_hit_test(grid, (MC_GHITTESTINFO*) lp);
 
         case MC_GM_GETCELLRECT:
-        {
-            WORD col = LOWORD(wp);
-            WORD row = HIWORD(wp);
-            if(MC_ERR(col >= grid->col_count || row >= grid->row_count)) {
-                MC_TRACE("MC_GM_GETCELLRECT: Column or row index out of range "
-                         "(size: %ux%u; requested [%u,%u])",
-                         (unsigned) grid->col_count, (unsigned) grid->row_count,
-                         (unsigned) col, (unsigned) row);
-                SetLastError(ERROR_INVALID_PARAMETER);
-                return FALSE;
-            }
-            grid_cell_rect(grid, col, row, (RECT*) lp);
-            return TRUE;
-        }
+            return (grid_get_cell_rect(grid, LOWORD(wp), HIWORD(wp), (RECT*) lp) == 0 ? TRUE : FALSE);
 
         case MC_GM_ENSUREVISIBLE:
-        {
-            WORD col = LOWORD(wp);
-            WORD row = HIWORD(wp);
-            if(MC_ERR(col >= grid->col_count || row >= grid->row_count)) {
-                MC_TRACE("MC_GM_ENSUREVISIBLE: Column or row index out of range "
-                         "(size: %ux%u; requested [%u,%u])",
-                         (unsigned) grid->col_count, (unsigned) grid->row_count,
-                         (unsigned) col, (unsigned) row);
-                SetLastError(ERROR_INVALID_PARAMETER);
-                return FALSE;
-            }
-
-            grid_ensure_visible(grid, col, row, lp);
-            return TRUE;
-        }
+            return (grid_ensure_visible(grid, LOWORD(wp), HIWORD(wp), lp) == 0 ? TRUE : FALSE);
 
         case MC_GM_SETFOCUSEDCELL:
             return (grid_set_focused_cell(grid, LOWORD(wp), HIWORD(wp)) == 0 ? TRUE : FALSE);
 
         case MC_GM_GETFOCUSEDCELL:
-            return MAKELRESULT(grid->focused_col, grid->focused_row);
+            return MAKELRESULT((WORD) grid->focused_col, (WORD) grid->focused_row);
 
         case MC_GM_SETSELECTION:
             return (grid_set_selection(grid, (MC_GSELECTION*) lp) == 0 ? TRUE : FALSE);
@@ -3616,25 +4599,63 @@ grid_proc(HWND win, UINT msg, WPARAM wp, LPARAM lp)
             return (LRESULT) labeledit_win(win);
 
         case MC_GM_EDITLABEL:
-        {
-            WORD col = LOWORD(wp);
-            WORD row = HIWORD(wp);
-            if(MC_ERR(col >= grid->col_count || row >= grid->row_count)) {
-                MC_TRACE("MC_GM_EDITLABEL: Column or row index out of range "
-                         "(size: %ux%u; requested [%u,%u])",
-                         (unsigned) grid->col_count, (unsigned) grid->row_count,
-                         (unsigned) col, (unsigned) row);
-                return (LRESULT) NULL;
-            }
-
-            return (LRESULT) grid_labeledit_start(grid, col, row);
-        }
+            return (LRESULT) grid_labeledit_start(grid, LOWORD(wp), HIWORD(wp));
 
         case MC_GM_CANCELEDITLABEL:
             if(grid->labeledit_started)
                 grid_labeledit_end(grid, TRUE);
             return 0;
 
+        case MC_GM_SORT:
+            return (grid_sort(grid, (UINT) wp, (const MC_GSORTKEY*) lp) == 0 ? TRUE : FALSE);
+
+        case MC_GM_SHOWROW:
+            return (grid_show_row(grid, grid_wide_index((WORD) wp), (BOOL) lp) == 0 ? TRUE : FALSE);
+
+        case MC_GM_GETTABLEROW:
+            return grid_get_table_row(grid, (WORD) wp);
+
+        case MC_GM_GETVIEWROW:
+            return grid_get_view_row(grid, (WORD) wp);
+
+        case MC_GM_SETDATAPROVIDERW:
+        case MC_GM_SETDATAPROVIDERA:
+            return (grid_set_data_provider(grid, (const MC_GDATAPROVIDERW*) lp,
+                                           (msg == MC_GM_SETDATAPROVIDERW)) == 0 ? TRUE : FALSE);
+
+        case MC_GM_RESIZEEX:
+            return (grid_resize_ex(grid, (WORD) wp, (DWORD) lp) == 0 ? TRUE : FALSE);
+
+        case MC_GM_REDRAWCELLSEX:
+            return (grid_redraw_cells_ex(grid, (const MC_GRECTEX*) lp) == 0 ? TRUE : FALSE);
+
+        case MC_GM_HITTESTEX:
+            return grid_hit_test_ex(grid, (MC_GHITTESTINFOEX*) lp, NULL);
+
+        case MC_GM_GETCELLRECTEX:
+            return (grid_get_cell_rect(grid, (DWORD) ((RECT*) lp)->left, (DWORD) wp,
+                                       (RECT*) lp) == 0 ? TRUE : FALSE);
+
+        case MC_GM_ENSUREVISIBLEEX:
+            return (grid_ensure_visible(grid, LOWORD(lp), (DWORD) wp, HIWORD(lp)) == 0 ? TRUE : FALSE);
+
+        case MC_GM_SETFOCUSEDCELLEX:
+            return (grid_set_focused_cell(grid, (WORD) wp, (DWORD) lp) == 0 ? TRUE : FALSE);
+
+        case MC_GM_GETFOCUSEDCELLEX:
+            if(wp != 0)
+                *((WORD*) wp) = (WORD) grid->focused_col;
+            return grid->focused_row;
+
+        case MC_GM_SETSELECTIONEX:
+            return (grid_set_selection_ex(grid, (MC_GSELECTIONEX*) lp) == 0 ? TRUE : FALSE);
+
+        case MC_GM_GETSELECTIONEX:
+            return grid_get_selection_ex(grid, (MC_GSELECTIONEX*) lp);
+
+        case MC_GM_EDITLABELEX:
+            return (LRESULT) grid_labeledit_start(grid, (WORD) wp, (DWORD) lp);
+
         case WM_SETREDRAW:
             grid->no_redraw = !wp;
             if(!grid->no_redraw)
@@ -555,20 +555,6 @@ mc_dlus_from_pixels(HFONT font, int pixels, BOOL vert)
  *** Initialization ***
  **********************/
 
-#if DEBUG >= 2
-
-/* Unit testing forward declarations. */
-void rgn16_test(void);
-
-static void
-perform_unit_tests(void)
-{
-    rgn16_test();
-}
-
-#endif  /* #if DEBUG >= 2 */
-
-
 #ifdef DEBUG
     #define DEFINE_WIN_VERSION(id, workstation_name, server_name)           \
                 { id, workstation_name, server_name }
@@ -759,11 +745,6 @@ mc_init_module(void)
         }
     }
 
-#if DEBUG >= 2
-    /* In debug builds, we may want to run few basic unit tests. */
-    perform_unit_tests();
-#endif
-
     /* Success */
     return 0;
 }
@@ -37,123 +37,191 @@
 
 
 static inline void
-table_cell_clear(table_cell_t* cell)
+table_text_free(table_t* table, TCHAR* text)
 {
-    if(cell->text != NULL && cell->text != MC_LPSTR_TEXTCALLBACK)
-        free(cell->text);
+    if(table->intern != NULL)
+        intern_release(table->intern, text);
+    else
+        free(text);
 }
 
 static inline void
-table_refresh(table_t* table, table_refresh_detail_t* detail)
+table_cell_clear(table_t* table, table_cell_t* cell)
 {
-    view_list_refresh(&table->vlist, detail);
+    if(cell->text != NULL && cell->text != MC_LPSTR_TEXTCALLBACK)
+        table_text_free(table, cell->text);
 }
 
+/* Make the table's own copy of the string, converted to TCHAR. If the table
+ * interns its texts, the copy is shared with all the other cells holding the
+ * same text. */
+static TCHAR*
+table_text_dup(table_t* table, const void* str, mc_str_type_t str_type)
+{
+    TCHAR* tmp;
+    TCHAR* text;
 
-typedef struct table_cell_buffer_tag table_cell_buffer_t;
-struct table_cell_buffer_tag {
-    table_cell_t* cells;
-    table_cell_t* cols;
-    table_cell_t* rows;
-    int col_count;
-    int row_count;
-};
-
-static void
-table_init_region(table_cell_buffer_t* buf, const table_region_t* reg,
-                  BOOL init_cols, BOOL init_rows)
-{
-    if(reg->col1 - reg->col0 > 0  &&  reg->row1 - reg->row0 > 0) {
-        if(reg->col0 == 0  &&  reg->col1 == buf->col_count) {
-            /* Special case: If the region covers whole rows, we can do it with a
-             * single memset(). */
-            memset(buf->cells + reg->row0 * buf->col_count, 0,
-                   (reg->row1 - reg->row0) * buf->col_count * sizeof(table_cell_t));
-        } else {
-            int row;
+    if(table->intern == NULL)
+        return mc_str(str, str_type, MC_STRT);
 
-            for(row = reg->row0; row < reg->row1; row++) {
-                memset(buf->cells + row * buf->col_count + reg->col0, 0,
-                       (reg->col1 - reg->col0) * sizeof(table_cell_t));
-            }
+    if(str_type == MC_STRT) {
+        tmp = (TCHAR*) str;
+    } else {
+        tmp = mc_str(str, str_type, MC_STRT);
+        if(MC_ERR(tmp == NULL)) {
+            MC_TRACE("table_text_dup: mc_str() failed.");
+            return NULL;
         }
     }
 
-    if(init_cols  &&  reg->col1 - reg->col0 > 0) {
-        memset(buf->cols + reg->col0, 0,
-               (reg->col1 - reg->col0) * sizeof(table_cell_t));
-    }
+    /* Include the terminator so that the pool hands out proper strings. */
+    text = (TCHAR*) intern_acquire(table->intern, tmp,
+                                   (_tcslen(tmp) + 1) * sizeof(TCHAR));
+    if(MC_ERR(text == NULL))
+        MC_TRACE("table_text_dup: intern_acquire() failed.");
+
+    if(tmp != str)
+        free(tmp);
+    return text;
+}
 
-    if(init_rows  &&  reg->row1 - reg->row0 > 0) {
-        memset(buf->rows + reg->row0, 0,
-               (reg->row1 - reg->row0) * sizeof(table_cell_t));
+/* Extend the pending dirty region (empty if col0 >= col1 or row0 >= row1) to
+ * cover also the given one. */
+static void
+table_dirty_add(table_region_t* dirty, DWORD col0, DWORD row0, DWORD col1, DWORD row1)
+{
+    if(dirty->col0 >= dirty->col1  ||  dirty->row0 >= dirty->row1) {
+        dirty->col0 = col0;
+        dirty->row0 = row0;
+        dirty->col1 = col1;
+        dirty->row1 = row1;
+    } else {
+        dirty->col0 = MC_MIN(dirty->col0, col0);
+        dirty->row0 = MC_MIN(dirty->row0, row0);
+        dirty->col1 = MC_MAX(dirty->col1, col1);
+        dirty->row1 = MC_MAX(dirty->row1, row1);
     }
 }
 
 static void
-table_clear_region(table_cell_buffer_t* buf, const table_region_t* reg,
-                   BOOL clear_cols, BOOL clear_rows)
+table_flush_refresh(table_t* table)
 {
-    int col, row;
+    table_refresh_detail_t refresh_detail;
 
-    for(row = reg->row0; row < reg->row1; row++) {
-        for(col = reg->col0; col < reg->col1; col++)
-            table_cell_clear(buf->cells + row * buf->col_count + col);
+    refresh_detail.event = TABLE_REGION_CHANGED;
+
+    if(table->dirty_cells.col0 < table->dirty_cells.col1  &&
+       table->dirty_cells.row0 < table->dirty_cells.row1) {
+        refresh_detail.param[0] = table->dirty_cells.col0;
+        refresh_detail.param[1] = table->dirty_cells.row0;
+        refresh_detail.param[2] = table->dirty_cells.col1;
+        refresh_detail.param[3] = table->dirty_cells.row1;
+        view_list_refresh(&table->vlist, &refresh_detail);
     }
 
-    if(clear_cols) {
-        for(col = reg->col0; col < reg->col1; col++)
-            table_cell_clear(buf->cols + col);
+    /* Column headers are tracked as a region with rows [0,1). */
+    if(table->dirty_cols.col0 < table->dirty_cols.col1) {
+        refresh_detail.param[0] = table->dirty_cols.col0;
+        refresh_detail.param[1] = TABLE_HEADER;
+        refresh_detail.param[2] = table->dirty_cols.col1;
+        refresh_detail.param[3] = 0;
+        view_list_refresh(&table->vlist, &refresh_detail);
     }
 
-    if(clear_rows) {
-        for(row = reg->row0; col < reg->row1; row++)
-            table_cell_clear(buf->rows + row);
+    /* Row headers are tracked as a region with columns [0,1). */
+    if(table->dirty_rows.row0 < table->dirty_rows.row1) {
+        refresh_detail.param[0] = TABLE_HEADER;
+        refresh_detail.param[1] = table->dirty_rows.row0;
+        refresh_detail.param[2] = 0;
+        refresh_detail.param[3] = table->dirty_rows.row1;
+        view_list_refresh(&table->vlist, &refresh_detail);
     }
+
+    memset(&table->dirty_cells, 0, sizeof(table_region_t));
+    memset(&table->dirty_cols, 0, sizeof(table_region_t));
+    memset(&table->dirty_rows, 0, sizeof(table_region_t));
 }
 
 static void
-table_copy_region(table_cell_buffer_t* buf_dst, const table_region_t* reg_dst,
-                  table_cell_buffer_t* buf_src, const table_region_t* reg_src,
-                  BOOL copy_cols, BOOL copy_rows)
+table_refresh(table_t* table, table_refresh_detail_t* detail)
 {
-    MC_ASSERT(reg_dst->col1 - reg_dst->col0 == reg_src->col1 - reg_src->col0);
-    MC_ASSERT(reg_dst->row1 - reg_dst->row0 == reg_src->row1 - reg_src->row0);
-
-    if(reg_dst->col1 - reg_dst->col0 > 0  &&  reg_dst->row1 - reg_dst->row0 > 0) {
-        if(reg_dst->col0 == 0  &&  reg_dst->col1 == buf_dst->col_count  &&
-           reg_src->col0 == 0  &&  reg_src->col1 == buf_src->col_count)
-        {
-            /* Special case: If the both regions cover whole rows, we can do it
-             * with a single memcpy(). */
-            memcpy(buf_dst->cells + reg_dst->row0 * buf_dst->col_count,
-                   buf_src->cells + reg_src->row0 * buf_src->col_count,
-                   (reg_dst->row1 - reg_dst->row0) * buf_dst->col_count * sizeof(table_cell_t));
-        } else {
-            int row_dst, row_src;
-
-            for(row_dst = reg_dst->row0, row_src = reg_src->row0;
-                row_dst < reg_dst->row1;
-                row_dst++, row_src++)
-            {
-                memcpy(buf_dst->cells + row_dst * buf_dst->col_count + reg_dst->col0,
-                       buf_src->cells + row_src * buf_src->col_count + reg_src->col0,
-                       (reg_dst->col1 - reg_dst->col0) * sizeof(table_cell_t));
-            }
+    if(table->update_level > 0) {
+        DWORD col0 = detail->param[0];
+        DWORD row0 = detail->param[1];
+        DWORD col1, row1;
+
+        switch(detail->event) {
+            case TABLE_CELL_CHANGED:
+            case TABLE_REGION_CHANGED:
+                if(detail->event == TABLE_CELL_CHANGED) {
+                    col1 = col0 + 1;
+                    row1 = row0 + 1;
+                } else {
+                    col1 = detail->param[2];
+                    row1 = detail->param[3];
+                }
+
+                if(row0 == TABLE_HEADER)
+                    table_dirty_add(&table->dirty_cols, col0, 0, col1, 1);
+                else if(col0 == TABLE_HEADER)
+                    table_dirty_add(&table->dirty_rows, 0, row0, 1, row1);
+                else
+                    table_dirty_add(&table->dirty_cells, col0, row0, col1, row1);
+                return;
+
+            default:
+                /* The cells are going to move, so the pending region would
+                 * not be valid anymore after this event. */
+                table_flush_refresh(table);
+                break;
         }
     }
 
-    if(copy_cols  &&  reg_dst->col1 - reg_dst->col0 > 0) {
-        memcpy(buf_dst->cols + reg_dst->col0,
-               buf_src->cols + reg_src->col0,
-               (reg_dst->col1 - reg_dst->col0) * sizeof(table_cell_t));
+    view_list_refresh(&table->vlist, detail);
+}
+
+
+/* Release texts of the cells in the range of rows (and reset the cells). */
+static void
+table_cells_clear(table_t* table, ROPE* cells, DWORD row0, DWORD row1)
+{
+    table_cell_t* cell;
+    size_t row, n, i;
+
+    for(row = row0; row < row1; row += n) {
+        cell = (table_cell_t*) rope_span(cells, row, &n);
+        n = MC_MIN(n, row1 - row);
+        for(i = 0; i < n; i++)
+            table_cell_clear(table, &cell[i]);
+        memset(cell, 0, n * sizeof(table_cell_t));
     }
+}
+
+static void
+table_column_fini(table_t* table, table_column_t* column)
+{
+    if(column->type == MC_TCT_TEXT)
+        table_cells_clear(table, &column->cells, 0, (DWORD) rope_count(&column->cells));
+    else if(table_column_is_typed(column))
+        column_fini(&column->data);
 
-    if(copy_rows  &&  reg_dst->row1 - reg_dst->row0 > 0) {
-        memcpy(buf_dst->rows + reg_dst->row0,
-               buf_src->rows + reg_src->row0,
-               (reg_dst->row1 - reg_dst->row0) * sizeof(table_cell_t));
+    rope_fini(&column->cells);
+}
 
+static void
+table_column_init_cells(table_column_t* column, DWORD row0, DWORD row1)
+{
+    table_cell_t* cell;
+    size_t row, n, i;
+
+    for(row = row0; row < row1; row += n) {
+        cell = (table_cell_t*) rope_span(&column->cells, row, &n);
+        n = MC_MIN(n, row1 - row);
+        memset(cell, 0, n * sizeof(table_cell_t));
+        if(column->type == MC_TCT_CALLBACK) {
+            for(i = 0; i < n; i++)
+                cell[i].text = MC_LPSTR_TEXTCALLBACK;
+        }
     }
 }
 
@@ -161,152 +229,152 @@ static int
 table_resize_helper(table_t* table, int col_pos, int col_delta,
                                     int row_pos, int row_delta)
 {
-    table_cell_buffer_t buf_dst;
-    table_cell_buffer_t buf_src;
-    size_t size;
+    DWORD old_col_count = table->col_count;
+    DWORD old_row_count = table->row_count;
+    DWORD col_count = old_col_count + col_delta;
+    DWORD row_count = old_row_count + row_delta;
+    table_column_t* new_columns = NULL;
     table_refresh_detail_t refresh_detail;
-
-    buf_src.cells = table->cells;
-    buf_src.cols = table->cols;
-    buf_src.rows = table->rows;
-    buf_src.col_count = table->col_count;
-    buf_src.row_count = table->row_count;
-
-    buf_dst.col_count = table->col_count + col_delta;
-    buf_dst.row_count = table->row_count + row_delta;
+    int i, j;
 
     if(col_delta == 0)
-        col_pos = table->col_count;
+        col_pos = old_col_count;
     if(row_delta == 0)
-        row_pos = table->row_count;
-
-    size = (buf_dst.col_count * buf_dst.row_count) * sizeof(table_cell_t) +
-           buf_dst.col_count * sizeof(table_cell_t) +
-           buf_dst.row_count * sizeof(table_cell_t);
-
-    if(size == 0) {
-        /* Trivial case: Resizing to an empty table. */
-        table_region_t clear_reg = { 0, 0, buf_src.col_count, buf_src.row_count };
-        table_clear_region(&buf_src, &clear_reg, TRUE, TRUE);
-        free(buf_src.cells);
-
-        buf_dst.cells = NULL;
-        buf_dst.cols = NULL;
-        buf_dst.rows = NULL;
-    } else if(col_delta == 0  &&  row_delta > 0  &&  row_pos == buf_src.row_count) {
-        /* Optimized case: When just adding new rows at the end of the table,
-         * we can handle it more effectively with a realloc(). */
-        table_region_t init_reg = { 0, row_pos, buf_dst.col_count, buf_dst.row_count };
-
-        buf_dst.cells = (table_cell_t*) realloc(table->cells, size);
-        if(MC_ERR(buf_dst.cells == NULL)) {
-            MC_TRACE("table_resize_helper: realloc() failed");
+        row_pos = old_row_count;
+
+    /* Stage 1: Allocate everything we may need. Nothing is changed in a way
+     * visible to the outer world yet: On a failure, the buffers we have
+     * already grown are just bigger than necessary, and the (still empty)
+     * rows we have inserted are removed again. */
+    if(col_delta > 0) {
+        table_cell_t* cols;
+        table_column_t* columns;
+
+        cols = (table_cell_t*) realloc(table->cols, col_count * sizeof(table_cell_t));
+        if(MC_ERR(cols == NULL)) {
+            MC_TRACE("table_resize_helper: realloc(cols) failed.");
             return -1;
         }
+        table->cols = cols;
 
-        /* Move col/row headers to the proper new place. */
-        memmove(buf_dst.cells + (buf_dst.col_count * buf_dst.row_count),
-                buf_dst.cells + (buf_src.col_count * buf_src.row_count),
-                (buf_src.col_count + buf_src.row_count) * sizeof(table_cell_t));
-        buf_dst.cols = buf_dst.cells + (buf_dst.col_count * buf_dst.row_count);
-        buf_dst.rows = buf_dst.cols + buf_dst.col_count;
-
-        /* Init the new rows (and their headers). */
-        table_init_region(&buf_dst, &init_reg, FALSE, TRUE);
-    } else if(col_delta == 0  &&  row_delta < 0  &&  row_pos == buf_dst.row_count) {
-        /* Optimized case: When just removing some rows  at the end of the table.
-         * This is similar to the above but we have to handle the realloc() failure
-         * differently: If it fails we are in a situation when we have already
-         * destroyed the old stuff. */
-        table_region_t clear_reg = { 0, row_pos, buf_src.col_count, buf_src.row_count };
-        table_clear_region(&buf_src, &clear_reg, FALSE, TRUE);
-
-        /* Move col/row headers to the proper new place. */
-        memmove(buf_src.cells + (buf_dst.col_count * buf_dst.row_count),
-                buf_src.cells + (buf_src.col_count * buf_src.row_count),
-                (buf_dst.col_count + buf_dst.row_count) * sizeof(table_cell_t));
-
-        buf_dst.cells = (table_cell_t*) realloc(table->cells, size);
-        if(MC_ERR(buf_dst.cells == NULL)) {
-            MC_TRACE("table_resize_helper: realloc() failed. Cannot shrink.");
-            /* Work with the original bigger buffer.
-             * We just are just wasting some memory... */
+        columns = (table_column_t*) realloc(table->columns, col_count * sizeof(table_column_t));
+        if(MC_ERR(columns == NULL)) {
+            MC_TRACE("table_resize_helper: realloc(columns) failed.");
+            return -1;
         }
+        table->columns = columns;
+    }
 
-        buf_dst.cols = buf_dst.cells + (buf_dst.col_count * buf_dst.row_count);
-        buf_dst.rows = buf_dst.cols + buf_dst.col_count;
-    } else {
-        /* This is the most general and complex case when we may be adding
-         * or removing some columns and/or rows at the same time, anywhere
-         * in the table.
-         */
-        buf_dst.cells = (table_cell_t*) malloc(size);
-        if(MC_ERR(buf_dst.cells == NULL)) {
-            MC_TRACE("table_resize_helper: malloc() failed");
+    if(row_delta > 0) {
+        if(MC_ERR(rope_insert(&table->rows, row_pos, row_delta) != 0)) {
+            MC_TRACE("table_resize_helper: rope_insert(rows) failed.");
             return -1;
         }
-        buf_dst.cols = buf_dst.cells + (buf_dst.col_count * buf_dst.row_count);
-        buf_dst.rows = buf_dst.cols + buf_dst.col_count;
-
-        /*
-         *                     +---+-+---+
-         *    +---+---+        | A | | B |
-         *    | A | B |        +---+-+---+
-         *    +---+---+  --->  |         |
-         *    | C | D |        +---+-+---+
-         *    +---+---+        | C | | D |
-         *                     +---+-+---+
-         */
-        {
-            /* Copy the corner areas (A, B, C, D) which do not change */
-            table_region_t reg_src_A = { 0, 0, col_pos, row_pos };
-            table_region_t reg_dst_A = { 0, 0, col_pos, row_pos };
-            table_region_t reg_src_B = { col_pos + (col_delta >= 0 ? 0 : -col_delta), 0, buf_src.col_count, row_pos };
-            table_region_t reg_dst_B = { col_pos + (col_delta >= 0 ? col_delta : 0), 0, buf_dst.col_count, row_pos };
-            table_region_t reg_src_C = { 0, row_pos + (row_delta >= 0 ? 0 : -row_delta), col_pos, buf_src.row_count };
-            table_region_t reg_dst_C = { 0, row_pos + (row_delta >= 0 ? row_delta : 0), col_pos, buf_dst.row_count };
-            table_region_t reg_src_D = { col_pos + (col_delta >= 0 ? 0 : -col_delta), row_pos + (row_delta >= 0 ? 0 : -row_delta), buf_src.col_count, buf_src.row_count };
-            table_region_t reg_dst_D = { col_pos + (col_delta >= 0 ? col_delta : 0), row_pos + (row_delta >= 0 ? row_delta : 0), buf_dst.col_count, buf_dst.row_count };
-
-            table_copy_region(&buf_dst, &reg_dst_A, &buf_src, &reg_src_A, TRUE, TRUE);
-            table_copy_region(&buf_dst, &reg_dst_B, &buf_src, &reg_src_B, TRUE, FALSE);
-            table_copy_region(&buf_dst, &reg_dst_C, &buf_src, &reg_src_C, FALSE, TRUE);
-            table_copy_region(&buf_dst, &reg_dst_D, &buf_src, &reg_src_D, FALSE, FALSE);
-
-            /* Handle new/removed rows. */
-            if(row_delta > 0) {
-                table_region_t reg_dst_X = { 0, row_pos, buf_dst.col_count, row_pos + row_delta };
-                table_init_region(&buf_dst, &reg_dst_X, FALSE, TRUE);
-            } else if(row_delta < 0) {
-                table_region_t reg_src_X = { 0, row_pos, buf_src.col_count, row_pos - row_delta };
-                table_clear_region(&buf_src, &reg_src_X, FALSE, TRUE);
+
+        for(i = 0; i < old_col_count; i++) {
+            table_column_t* column = &table->columns[i];
+
+            if(table_column_is_typed(column)) {
+                if(MC_ERR(column_reserve(&column->data, row_count) != 0)) {
+                    MC_TRACE("table_resize_helper: column_reserve() failed.");
+                    goto err_rows;
+                }
+            }
+
+            if(MC_ERR(rope_insert(&column->cells, row_pos, row_delta) != 0)) {
+                MC_TRACE("table_resize_helper: rope_insert(cells) failed.");
+                goto err_rows;
             }
+        }
+    }
+
+    if(col_delta > 0) {
+        new_columns = (table_column_t*) malloc(col_delta * sizeof(table_column_t));
+        if(MC_ERR(new_columns == NULL)) {
+            MC_TRACE("table_resize_helper: malloc(new_columns) failed.");
+            i = old_col_count;
+            goto err_rows;
+        }
 
-            /* Handle new/removed columns.
-             * Beware they may be "interrupted" by an area of removed or
-             * added rows. */
-            if(col_delta > 0) {
-                table_region_t reg_dst_X0 = { reg_dst_A.col1, reg_dst_A.row0, reg_dst_B.col0, reg_dst_B.row1 };
-                table_region_t reg_dst_X1 = { reg_dst_C.col1, reg_dst_C.row0, reg_dst_D.col0, reg_dst_D.row1 };
-                table_init_region(&buf_dst, &reg_dst_X0, TRUE, FALSE);
-                table_init_region(&buf_dst, &reg_dst_X1, FALSE, FALSE);
-            } else if(col_delta < 0) {
-                table_region_t reg_src_X0 = { reg_src_A.col1, reg_src_A.row0, reg_src_B.col0, reg_src_B.row1 };
-                table_region_t reg_src_X1 = { reg_src_C.col1, reg_src_C.row0, reg_src_D.col0, reg_src_D.row1 };
-                table_clear_region(&buf_src, &reg_src_X0, TRUE, FALSE);
-                table_clear_region(&buf_src, &reg_src_X1, FALSE, FALSE);
+        for(i = 0; i < col_delta; i++) {
+            new_columns[i].type = MC_TCT_TEXT;
+            rope_init(&new_columns[i].cells, sizeof(table_cell_t), TABLE_CHUNK_ROWS);
+            if(MC_ERR(rope_insert(&new_columns[i].cells, 0, row_count) != 0)) {
+                MC_TRACE("table_resize_helper: rope_insert(cells) failed.");
+                for(j = 0; j <= i; j++)
+                    rope_fini(&new_columns[j].cells);
+                free(new_columns);
+                i = old_col_count;
+                goto err_rows;
             }
         }
+    }
+
+    /* Stage 2: Nothing can fail from now on. */
+
+    /* Remove or insert rows in all the old columns. (Including those which
+     * are going to be removed below; it does no harm.) */
+    if(row_delta < 0) {
+        int row_end = row_pos - row_delta;
+
+        for(i = 0; i < old_col_count; i++) {
+            table_column_t* column = &table->columns[i];
+
+            if(column->type == MC_TCT_TEXT)
+                table_cells_clear(table, &column->cells, row_pos, row_end);
+            else if(table_column_is_typed(column))
+                column_remove(&column->data, row_pos, -row_delta);
+            rope_remove(&column->cells, row_pos, -row_delta);
+        }
 
-        free(buf_src.cells);
+        table_cells_clear(table, &table->rows, row_pos, row_end);
+        rope_remove(&table->rows, row_pos, -row_delta);
+    } else if(row_delta > 0) {
+        /* The cells have been inserted (zeroed) in the stage 1 already. */
+        for(i = 0; i < old_col_count; i++) {
+            table_column_t* column = &table->columns[i];
+
+            if(table_column_is_typed(column))
+                column_insert(&column->data, row_pos, row_delta);   /* Reserved above. */
+            else if(column->type == MC_TCT_CALLBACK)
+                table_column_init_cells(column, row_pos, row_pos + row_delta);
+        }
     }
 
-    /* Install the new buffer. */
-    table->cells = buf_dst.cells;
-    table->cols = buf_dst.cols;
-    table->rows = buf_dst.rows;
-    table->col_count = buf_dst.col_count;
-    table->row_count = buf_dst.row_count;
+    /* Remove or insert columns. */
+    if(col_delta < 0) {
+        int col_end = col_pos - col_delta;
+
+        for(i = col_pos; i < col_end; i++) {
+            table_column_fini(table, &table->columns[i]);
+            table_cell_clear(table, &table->cols[i]);
+        }
+        memmove(table->columns + col_pos, table->columns + col_end,
+                (old_col_count - col_end) * sizeof(table_column_t));
+        memmove(table->cols + col_pos, table->cols + col_end,
+                (old_col_count - col_end) * sizeof(table_cell_t));
+    } else if(col_delta > 0) {
+        memmove(table->columns + col_pos + col_delta, table->columns + col_pos,
+                (old_col_count - col_pos) * sizeof(table_column_t));
+        memcpy(table->columns + col_pos, new_columns, col_delta * sizeof(table_column_t));
+        memmove(table->cols + col_pos + col_delta, table->cols + col_pos,
+                (old_col_count - col_pos) * sizeof(table_cell_t));
+        memset(table->cols + col_pos, 0, col_delta * sizeof(table_cell_t));
+        free(new_columns);
+    }
+
+    table->col_count = col_count;
+    table->row_count = row_count;
+
+    /* Release the buffers if the table has no columns. (We do not bother with
+     * shrinking them otherwise. The cells release their chunks as the rows
+     * are removed.) */
+    if(col_count == 0) {
+        free(table->columns);
+        free(table->cols);
+        table->columns = NULL;
+        table->cols = NULL;
+    }
 
     /* Refresh */
     if(col_delta != 0) {
@@ -325,17 +393,33 @@ table_resize_helper(table_t* table, int col_pos, int col_delta,
     }
 
     return 0;
+
+err_rows:
+    /* Remove the rows inserted into the first i columns. */
+    if(row_delta > 0) {
+        for(j = 0; j < i; j++)
+            rope_remove(&table->columns[j].cells, row_pos, row_delta);
+        rope_remove(&table->rows, row_pos, row_delta);
+    }
+    return -1;
 }
 
 int
-table_resize(table_t* table, WORD col_count, WORD row_count)
+table_resize(table_t* table, DWORD col_count, DWORD row_count)
 {
     int col_pos, col_delta;
     int row_pos, row_delta;
 
-    TABLE_TRACE("table_resize(%p): %hd x %hd --> %hd x %hd", table,
+    TABLE_TRACE("table_resize(%p): %lu x %lu --> %lu x %lu", table,
                 table->col_count, table->row_count, col_count, row_count);
 
+    if(MC_ERR(col_count > TABLE_MAX_COUNT  ||  row_count > TABLE_MAX_COUNT)) {
+        MC_TRACE("table_resize: Too many columns or rows (%lu x %lu)",
+                 col_count, row_count);
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return -1;
+    }
+
     if(col_count >= table->col_count) {
         col_pos = table->col_count;
         col_delta = col_count - table->col_count;
@@ -355,12 +439,49 @@ table_resize(table_t* table, WORD col_count, WORD row_count)
     return table_resize_helper(table, col_pos, col_delta, row_pos, row_delta);
 }
 
+int
+table_insert_rows(table_t* table, DWORD row_pos, DWORD count)
+{
+    TABLE_TRACE("table_insert_rows(%p, %lu, %lu)", table, row_pos, count);
+
+    if(MC_ERR(row_pos > table->row_count  ||
+              count > TABLE_MAX_COUNT - table->row_count)) {
+        MC_TRACE("table_insert_rows: Invalid rows (%lu, %lu), row count %lu",
+                 row_pos, count, table->row_count);
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return -1;
+    }
+
+    return table_resize_helper(table, 0, 0, row_pos, count);
+}
+
+int
+table_remove_rows(table_t* table, DWORD row_pos, DWORD count)
+{
+    TABLE_TRACE("table_remove_rows(%p, %lu, %lu)", table, row_pos, count);
+
+    if(MC_ERR(row_pos > table->row_count  ||  count > table->row_count - row_pos)) {
+        MC_TRACE("table_remove_rows: Invalid rows (%lu, %lu), row count %lu",
+                 row_pos, count, table->row_count);
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return -1;
+    }
+
+    return table_resize_helper(table, 0, 0, row_pos, -(int) count);
+}
+
 table_t*
-table_create(WORD col_count, WORD row_count)
+table_create(DWORD col_count, DWORD row_count, DWORD flags)
 {
     table_t* table;
 
-    TABLE_TRACE("table_create(%hd, %hd)", col_count, row_count);
+    TABLE_TRACE("table_create(%lu, %lu, 0x%lx)", col_count, row_count, flags);
+
+    if(MC_ERR(flags & ~MC_TF_INTERNTEXT)) {
+        MC_TRACE("table_create: Unsupported flags 0x%lx", flags);
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return NULL;
+    }
 
     table = (table_t*) malloc(sizeof(table_t));
     if(MC_ERR(table == NULL)) {
@@ -372,13 +493,32 @@ table_create(WORD col_count, WORD row_count)
     table->col_count = 0;
     table->row_count = 0;
     table->cols = NULL;
-    table->rows = NULL;
-    table->cells = NULL;
+    rope_init(&table->rows, sizeof(table_cell_t), TABLE_CHUNK_ROWS);
+    table->columns = NULL;
+    table->update_level = 0;
+    memset(&table->dirty_cells, 0, sizeof(table_region_t));
+    memset(&table->dirty_cols, 0, sizeof(table_region_t));
+    memset(&table->dirty_rows, 0, sizeof(table_region_t));
+    table->intern = NULL;
 
     view_list_init(&table->vlist);
 
+    if(flags & MC_TF_INTERNTEXT) {
+        table->intern = (INTERN*) malloc(sizeof(INTERN));
+        if(MC_ERR(table->intern == NULL)) {
+            MC_TRACE("table_create: malloc() failed.");
+            free(table);
+            return NULL;
+        }
+        intern_init(table->intern);
+    }
+
     if(MC_ERR(table_resize(table, col_count, row_count) != 0)) {
         MC_TRACE("table_create: table_resize() failed.");
+        if(table->intern != NULL) {
+            intern_fini(table->intern);
+            free(table->intern);
+        }
         free(table);
         return NULL;
     }
@@ -392,14 +532,23 @@ table_destroy(table_t* table)
     TABLE_TRACE("table_destroy(%p)", table);
     MC_ASSERT(table->refs == 0);
 
-    if(table->cells) {
-        int i, n;
+    if(table->columns != NULL) {
+        DWORD col;
 
-        n = table->col_count + table->row_count + table->col_count * table->row_count;
-        for(i = 0; i < n; i++)
-            table_cell_clear(&table->cells[i]);
+        for(col = 0; col < table->col_count; col++) {
+            table_column_fini(table, &table->columns[col]);
+            table_cell_clear(table, &table->cols[col]);
+        }
+        free(table->columns);
+        free(table->cols);
+    }
 
-        free(table->cells);
+    table_cells_clear(table, &table->rows, 0, table->row_count);
+    rope_fini(&table->rows);
+
+    if(table->intern != NULL) {
+        intern_fini(table->intern);
+        free(table->intern);
     }
 
     view_list_fini(&table->vlist);
@@ -407,72 +556,372 @@ table_destroy(table_t* table)
 }
 
 table_cell_t*
-table_get_cell(table_t* table, WORD col, WORD row)
+table_get_cell(table_t* table, DWORD col, DWORD row)
 {
-    TABLE_TRACE("table_get_cell(%p, %hd, %hd)", table, col, row);
+    TABLE_TRACE("table_get_cell(%p, %lu, %lu)", table, col, row);
 
-    if(MC_ERR(col >= table->col_count  &&  col != MC_TABLE_HEADER)) {
-        MC_TRACE("table_get_cell: Column ID %hd does not exist", col);
+    if(MC_ERR(col >= table->col_count  &&  col != TABLE_HEADER)) {
+        MC_TRACE("table_get_cell: Column ID %lu does not exist", col);
         SetLastError(ERROR_INVALID_PARAMETER);
         return NULL;
     }
-    if(MC_ERR(row >= table->row_count  &&  row != MC_TABLE_HEADER)) {
-        MC_TRACE("table_get_cell: Row ID %hd does not exist", row);
+    if(MC_ERR(row >= table->row_count  &&  row != TABLE_HEADER)) {
+        MC_TRACE("table_get_cell: Row ID %lu does not exist", row);
         SetLastError(ERROR_INVALID_PARAMETER);
         return NULL;
     }
-    if(MC_ERR(col == MC_TABLE_HEADER  &&  row == MC_TABLE_HEADER)) {
+    if(MC_ERR(col == TABLE_HEADER  &&  row == TABLE_HEADER)) {
         MC_TRACE("table_get_cell: The \"dead\" cell requested.");
         SetLastError(ERROR_INVALID_PARAMETER);
         return NULL;
     }
 
-    if(col == MC_TABLE_HEADER)
-        return &table->rows[row];
-    else if(row == MC_TABLE_HEADER)
+    if(col == TABLE_HEADER)
+        return table_row_header(table, row);
+    else if(row == TABLE_HEADER)
         return &table->cols[col];
     else
         return table_cell(table, col, row);
 }
 
+static int
+table_strcmp(const void* str1, size_t len1, const void* str2, size_t len2)
+{
+    /* The pool holds the strings including their terminators. */
+    return _tcscoll((const TCHAR*) str1, (const TCHAR*) str2);
+}
+
+TCHAR*
+table_cell_text(table_t* table, DWORD col, DWORD row, TCHAR* buf, int buf_size)
+{
+    table_column_t* column = &table->columns[col];
+    COLUMN* data = &column->data;
+
+    if(!table_column_is_typed(column))
+        return table_cell(table, col, row)->text;
+
+    if(column_is_null(data, row))
+        return NULL;
+
+    switch(column->type) {
+        case MC_TCT_INT64:
+            _sntprintf(buf, buf_size, _T("%I64d"), column_get_int64(data, row));
+            break;
+
+        case MC_TCT_DOUBLE:
+        {
+            double d = column_get_double(data, row);
+
+            /* Prefer the shorter format if it does not lose anything. */
+            _sntprintf(buf, buf_size, _T("%.15g"), d);
+            if(_tcstod(buf, NULL) != d)
+                _sntprintf(buf, buf_size, _T("%.17g"), d);
+            break;
+        }
+
+        case MC_TCT_STRING:
+            return (TCHAR*) column_get_string(data, row, NULL);
+    }
+
+    buf[buf_size - 1] = _T('\0');
+    return buf;
+}
+
+/* Store the text into a typed column. */
+static int
+table_column_set_text(table_column_t* column, DWORD row, const TCHAR* text)
+{
+    COLUMN* data = &column->data;
+    TCHAR* end;
+
+    MC_ASSERT(table_column_is_typed(column));
+
+    if(text == MC_LPSTR_TEXTCALLBACK) {
+        MC_TRACE("table_column_set_text: MC_LPSTR_TEXTCALLBACK not allowed "
+                 "in typed columns.");
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return -1;
+    }
+
+    if(text == NULL) {
+        column_set_null(data, row);
+        return 0;
+    }
+
+    switch(column->type) {
+        case MC_TCT_INT64:
+        {
+            __int64 i = _tcstoi64(text, &end, 10);
+            if(MC_ERR(end == text  ||  *end != _T('\0'))) {
+                MC_TRACE("table_column_set_text: '%S' is not an integer.", text);
+                SetLastError(ERROR_INVALID_DATA);
+                return -1;
+            }
+            column_set_int64(data, row, i);
+            break;
+        }
+
+        case MC_TCT_DOUBLE:
+        {
+            double d = _tcstod(text, &end);
+            if(MC_ERR(end == text  ||  *end != _T('\0'))) {
+                MC_TRACE("table_column_set_text: '%S' is not a number.", text);
+                SetLastError(ERROR_INVALID_DATA);
+                return -1;
+            }
+            column_set_double(data, row, d);
+            break;
+        }
+
+        case MC_TCT_STRING:
+            if(MC_ERR(column_set_string(data, row, text,
+                            (_tcslen(text) + 1) * sizeof(TCHAR)) != 0)) {
+                MC_TRACE("table_column_set_text: column_set_string() failed.");
+                return -1;
+            }
+            break;
+    }
+
+    return 0;
+}
+
 int
-table_set_cell_data(table_t* table, WORD col, WORD row, MC_TABLECELL* cell_data, BOOL unicode)
+table_set_column_type(table_t* table, DWORD col, DWORD type)
 {
-    table_cell_t* cell;
+    table_column_t* column;
+    table_column_t tmp;
+    TCHAR buf[TABLE_VALUE_BUFSIZE];
+    TCHAR* text;
+    TCHAR** texts = NULL;
     table_refresh_detail_t refresh_detail;
+    DWORD row;
 
-    TABLE_TRACE("table_set_cell_data(%p, %hd, %hd, %p, %s)",
-                table, col, row, cell_data, (unicode ? "unicode" : "ansi"));
+    TABLE_TRACE("table_set_column_type(%p, %lu, %lu)", table, col, type);
 
-    cell = table_get_cell(table, col, row);
-    if(MC_ERR(cell == NULL)) {
-        MC_TRACE("table_set_cell_data: table_get_cell() failed.");
+    if(MC_ERR(col >= table->col_count)) {
+        MC_TRACE("table_set_column_type: Column ID %lu does not exist", col);
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return -1;
+    }
+    if(MC_ERR(type > MC_TCT_CALLBACK)) {
+        MC_TRACE("table_set_column_type: Unsupported type %lu", type);
+        SetLastError(ERROR_INVALID_PARAMETER);
         return -1;
     }
 
+    column = &table->columns[col];
+    if(type == column->type)
+        return 0;
+
+    /* Build the new values aside so that the column stays intact on failure. */
+    tmp.type = type;
+    if(type == MC_TCT_TEXT  &&  column->type != MC_TCT_CALLBACK  &&  table->row_count > 0) {
+        texts = (TCHAR**) malloc(table->row_count * sizeof(TCHAR*));
+        if(MC_ERR(texts == NULL)) {
+            MC_TRACE("table_set_column_type: malloc() failed.");
+            return -1;
+        }
+        for(row = 0; row < table->row_count; row++) {
+            text = table_cell_text(table, col, row, buf, MC_SIZEOF_ARRAY(buf));
+            if(text != NULL) {
+                texts[row] = table_text_dup(table, text, MC_STRT);
+                if(MC_ERR(texts[row] == NULL)) {
+                    MC_TRACE("table_set_column_type: table_text_dup() failed.");
+                    while(row > 0) {
+                        row--;
+                        if(texts[row] != NULL)
+                            table_text_free(table, texts[row]);
+                    }
+                    free(texts);
+                    return -1;
+                }
+            } else {
+                texts[row] = NULL;
+            }
+        }
+    } else if(table_column_is_typed(&tmp)) {
+        column_init(&tmp.data, (type == MC_TCT_INT64) ? COLUMN_INT64 :
+                               (type == MC_TCT_DOUBLE) ? COLUMN_DOUBLE : COLUMN_STRING);
+        if(MC_ERR(column_insert(&tmp.data, 0, table->row_count) != 0)) {
+            MC_TRACE("table_set_column_type: column_insert() failed.");
+            column_fini(&tmp.data);
+            return -1;
+        }
+        if(column->type != MC_TCT_CALLBACK) {
+            for(row = 0; row < table->row_count; row++) {
+                text = table_cell_text(table, col, row, buf, MC_SIZEOF_ARRAY(buf));
+                if(text == MC_LPSTR_TEXTCALLBACK)
+                    text = NULL;
+                if(MC_ERR(table_column_set_text(&tmp, row, text) != 0)) {
+                    MC_TRACE("table_set_column_type: Cannot convert cell [%lu, %lu].", col, row);
+                    column_fini(&tmp.data);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    /* Release the old values and install the new ones. */
+    for(row = 0; row < table->row_count; row++) {
+        table_cell_t* cell = table_cell(table, col, row);
+
+        if(column->type == MC_TCT_TEXT)
+            table_cell_clear(table, cell);
+        if(type == MC_TCT_TEXT)
+            cell->text = (texts != NULL ? texts[row] : MC_LPSTR_TEXTCALLBACK);
+        else if(type == MC_TCT_CALLBACK)
+            cell->text = MC_LPSTR_TEXTCALLBACK;
+        else
+            cell->text = NULL;
+    }
+    free(texts);
+
+    if(table_column_is_typed(column))
+        column_fini(&column->data);
+    if(table_column_is_typed(&tmp))
+        memcpy(&column->data, &tmp.data, sizeof(COLUMN));
+    column->type = type;
+
+    /* Refresh */
+    if(table->row_count > 0) {
+        refresh_detail.event = TABLE_REGION_CHANGED;
+        refresh_detail.param[0] = col;
+        refresh_detail.param[1] = 0;
+        refresh_detail.param[2] = col + 1;
+        refresh_detail.param[3] = table->row_count;
+        table_refresh(table, &refresh_detail);
+    }
+
+    return 0;
+}
+
+static int
+table_column_minmax(table_t* table, DWORD col, BOOL max, DWORD* p_row)
+{
+    table_column_t* column;
+    size_t row;
+    int ret;
+
+    if(MC_ERR(col >= table->col_count  ||  !table_column_is_typed(&table->columns[col]))) {
+        MC_TRACE("table_column_minmax: Column %lu is not a typed column.", col);
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return -1;
+    }
+
+    column = &table->columns[col];
+    if(max)
+        ret = column_max(&column->data, table_strcmp, &row);
+    else
+        ret = column_min(&column->data, table_strcmp, &row);
+    if(ret != 0) {
+        /* No non-NULL value in the column. */
+        SetLastError(ERROR_NOT_FOUND);
+        return -1;
+    }
+
+    *p_row = (DWORD) row;
+    return 0;
+}
+
+int
+table_column_min(table_t* table, DWORD col, DWORD* p_row)
+{
+    return table_column_minmax(table, col, FALSE, p_row);
+}
+
+int
+table_column_max(table_t* table, DWORD col, DWORD* p_row)
+{
+    return table_column_minmax(table, col, TRUE, p_row);
+}
+
+int
+table_column_sort(table_t* table, DWORD col, BOOL descending, size_t* rows, size_t n)
+{
+    if(MC_ERR(col >= table->col_count  ||  !table_column_is_typed(&table->columns[col]))) {
+        MC_TRACE("table_column_sort: Column %lu is not a typed column.", col);
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return -1;
+    }
+
+    if(MC_ERR(column_sort(&table->columns[col].data, rows, n,
+                (descending ? COLUMN_SORT_DESC : 0), table_strcmp) != 0)) {
+        MC_TRACE("table_column_sort: column_sort() failed.");
+        return -1;
+    }
+
+    return 0;
+}
+
+/* Store the data into the cell, without any refresh. */
+static int
+table_store_cell_data(table_t* table, DWORD col, DWORD row, table_cell_t* cell,
+                      MC_TABLECELL* cell_data, BOOL unicode)
+{
     if(MC_ERR(cell_data->fMask & ~MC_TCMF_ALL)) {
-        MC_TRACE("table_set_cell_data: Unsupported pCell->fMask 0x%x", cell_data->fMask);
+        MC_TRACE("table_store_cell_data: Unsupported pCell->fMask 0x%x", cell_data->fMask);
         SetLastError(ERROR_INVALID_PARAMETER);
         return -1;
     }
 
     /* Set the cell */
     if(cell_data->fMask & MC_TCMF_TEXT) {
+        mc_str_type_t str_type = (unicode ? MC_STRW : MC_STRA);
         TCHAR* str;
 
-        if(cell_data->pszText == MC_LPSTR_TEXTCALLBACK) {
-            str = MC_LPSTR_TEXTCALLBACK;
-        } else if(cell_data->pszText != NULL) {
-            str = mc_str(cell_data->pszText, (unicode ? MC_STRW : MC_STRA), MC_STRT);
-            if(MC_ERR(str == NULL)) {
-                MC_TRACE("table_set_cell_data: mc_str() failed.");
-                return -1;
+        if(col == TABLE_HEADER  ||  row == TABLE_HEADER  ||
+           table->columns[col].type == MC_TCT_TEXT) {
+            if(cell_data->pszText == MC_LPSTR_TEXTCALLBACK) {
+                str = MC_LPSTR_TEXTCALLBACK;
+            } else if(cell_data->pszText != NULL) {
+                str = table_text_dup(table, cell_data->pszText, str_type);
+                if(MC_ERR(str == NULL)) {
+                    MC_TRACE("table_store_cell_data: table_text_dup() failed.");
+                    return -1;
+                }
+            } else {
+                str = NULL;
             }
+
+            table_cell_clear(table, cell);
+            cell->text = str;
         } else {
-            str = NULL;
+            table_column_t* column = &table->columns[col];
+            int ret;
+
+            /* Typed columns keep their own copy of the value, so the text is
+             * only a temporary one here. */
+            if(cell_data->pszText == MC_LPSTR_TEXTCALLBACK) {
+                str = MC_LPSTR_TEXTCALLBACK;
+            } else if(cell_data->pszText != NULL) {
+                str = mc_str(cell_data->pszText, str_type, MC_STRT);
+                if(MC_ERR(str == NULL)) {
+                    MC_TRACE("table_store_cell_data: mc_str() failed.");
+                    return -1;
+                }
+            } else {
+                str = NULL;
+            }
+
+            if(column->type == MC_TCT_CALLBACK) {
+                /* Nothing to store. Only allow the caller to confirm it. */
+                ret = (str == MC_LPSTR_TEXTCALLBACK ? 0 : -1);
+                if(MC_ERR(ret != 0)) {
+                    MC_TRACE("table_store_cell_data: Cannot set text in "
+                             "MC_TCT_CALLBACK column.");
+                    SetLastError(ERROR_INVALID_PARAMETER);
+                }
+            } else {
+                ret = table_column_set_text(column, row, str);
+                if(MC_ERR(ret != 0))
+                    MC_TRACE("table_store_cell_data: table_column_set_text() failed.");
+            }
+
+            if(str != NULL  &&  str != MC_LPSTR_TEXTCALLBACK)
+                free(str);
+            if(ret != 0)
+                return -1;
         }
-        table_cell_clear(cell);
-        cell->text = str;
     }
 
     if(cell_data->fMask & MC_TCMF_PARAM)
@@ -481,6 +930,29 @@ table_set_cell_data(table_t* table, WORD col, WORD row, MC_TABLECELL* cell_data,
     if(cell_data->fMask & MC_TCMF_FLAGS)
         cell->flags = cell_data->dwFlags;
 
+    return 0;
+}
+
+int
+table_set_cell_data(table_t* table, DWORD col, DWORD row, MC_TABLECELL* cell_data, BOOL unicode)
+{
+    table_cell_t* cell;
+    table_refresh_detail_t refresh_detail;
+
+    TABLE_TRACE("table_set_cell_data(%p, %lu, %lu, %p, %s)",
+                table, col, row, cell_data, (unicode ? "unicode" : "ansi"));
+
+    cell = table_get_cell(table, col, row);
+    if(MC_ERR(cell == NULL)) {
+        MC_TRACE("table_set_cell_data: table_get_cell() failed.");
+        return -1;
+    }
+
+    if(MC_ERR(table_store_cell_data(table, col, row, cell, cell_data, unicode) != 0)) {
+        MC_TRACE("table_set_cell_data: table_store_cell_data() failed.");
+        return -1;
+    }
+
     /* Refresh */
     refresh_detail.event = TABLE_CELL_CHANGED;
     refresh_detail.param[0] = col;
@@ -491,11 +963,82 @@ table_set_cell_data(table_t* table, WORD col, WORD row, MC_TABLECELL* cell_data,
 }
 
 int
-table_get_cell_data(table_t* table, WORD col, WORD row, MC_TABLECELL* cell_data, BOOL unicode)
+table_set_region_data(table_t* table, const table_region_t* reg,
+                      MC_TABLECELL* cells, BOOL unicode)
+{
+    DWORD col, row;
+    DWORD col_count;
+    MC_TABLECELL* cell_data;
+    table_refresh_detail_t refresh_detail;
+    int ret = 0;
+
+    TABLE_TRACE("table_set_region_data(%p, [%lu, %lu, %lu, %lu], %p, %s)",
+                table, reg->col0, reg->row0, reg->col1, reg->row1, cells,
+                (unicode ? "unicode" : "ansi"));
+
+    if(MC_ERR(reg->col0 > reg->col1  ||  reg->col1 > table->col_count  ||
+              reg->row0 > reg->row1  ||  reg->row1 > table->row_count)) {
+        MC_TRACE("table_set_region_data: Invalid region.");
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return -1;
+    }
+
+    col_count = reg->col1 - reg->col0;
+    cell_data = cells;
+    for(row = reg->row0; row < reg->row1; row++) {
+        for(col = reg->col0; col < reg->col1; col++) {
+            if(MC_ERR(table_store_cell_data(table, col, row, table_cell(table, col, row),
+                                            cell_data, unicode) != 0)) {
+                MC_TRACE("table_set_region_data: table_store_cell_data() failed "
+                         "for cell [%lu, %lu].", col, row);
+                ret = -1;
+                break;
+            }
+            cell_data++;
+        }
+
+        if(ret != 0) {
+            /* Refresh only the rows touched so far. */
+            row = (col > reg->col0 ? row + 1 : row);
+            break;
+        }
+    }
+
+    /* Refresh */
+    if(col_count > 0  &&  row > reg->row0) {
+        refresh_detail.event = TABLE_REGION_CHANGED;
+        refresh_detail.param[0] = reg->col0;
+        refresh_detail.param[1] = reg->row0;
+        refresh_detail.param[2] = reg->col1;
+        refresh_detail.param[3] = row;
+        table_refresh(table, &refresh_detail);
+    }
+
+    return ret;
+}
+
+void
+table_begin_update(table_t* table)
+{
+    table->update_level++;
+}
+
+void
+table_end_update(table_t* table)
+{
+    MC_ASSERT(table->update_level > 0);
+
+    table->update_level--;
+    if(table->update_level == 0)
+        table_flush_refresh(table);
+}
+
+int
+table_get_cell_data(table_t* table, DWORD col, DWORD row, MC_TABLECELL* cell_data, BOOL unicode)
 {
     table_cell_t* cell;
 
-    TABLE_TRACE("table_get_cell_data(%p, %hd, %hd, %p, %s)",
+    TABLE_TRACE("table_get_cell_data(%p, %lu, %lu, %p, %s)",
                 table, col, row, cell_data, (unicode ? "unicode" : "ansi"));
 
     cell = table_get_cell(table, col, row);
@@ -511,13 +1054,21 @@ table_get_cell_data(table_t* table, WORD col, WORD row, MC_TABLECELL* cell_data,
     }
 
     if(cell_data->fMask & MC_TCMF_TEXT) {
-        if(cell->text == MC_LPSTR_TEXTCALLBACK) {
+        TCHAR buf[TABLE_VALUE_BUFSIZE];
+        TCHAR* text;
+
+        if(col == TABLE_HEADER  ||  row == TABLE_HEADER)
+            text = cell->text;
+        else
+            text = table_cell_text(table, col, row, buf, MC_SIZEOF_ARRAY(buf));
+
+        if(text == MC_LPSTR_TEXTCALLBACK) {
             MC_TRACE("table_get_cell_data: Table cell contains "
                      "MC_LPSTR_TEXTCALLBACK and that cannot be asked for.");
             SetLastError(ERROR_INVALID_PARAMETER);
             return -1;
         } else {
-            mc_str_inbuf(cell->text, MC_STRT, cell_data->pszText,
+            mc_str_inbuf(text, MC_STRT, cell_data->pszText,
                          (unicode ? MC_STRW : MC_STRA), cell_data->cchTextMax);
         }
     }
@@ -537,11 +1088,11 @@ table_get_cell_data(table_t* table, WORD col, WORD row, MC_TABLECELL* cell_data,
  **************************/
 
 MC_HTABLE MCTRL_API
-mcTable_Create(WORD wColumnCount, WORD wRowCount, DWORD dwReserved)
+mcTable_Create(WORD wColumnCount, WORD wRowCount, DWORD dwFlags)
 {
     table_t* table;
 
-    table = table_create(wColumnCount, wRowCount);
+    table = table_create(wColumnCount, wRowCount, dwFlags);
     if(MC_ERR(table == NULL)) {
         MC_TRACE("mcTable_Create: table_create() failed.");
         return NULL;
@@ -550,6 +1101,20 @@ mcTable_Create(WORD wColumnCount, WORD wRowCount, DWORD dwReserved)
     return table;
 }
 
+MC_HTABLE MCTRL_API
+mcTable_CreateEx(DWORD dwColumnCount, DWORD dwRowCount, DWORD dwFlags)
+{
+    table_t* table;
+
+    table = table_create(dwColumnCount, dwRowCount, dwFlags);
+    if(MC_ERR(table == NULL)) {
+        MC_TRACE("mcTable_CreateEx: table_create() failed.");
+        return NULL;
+    }
+
+    return table;
+}
+
 void MCTRL_API
 mcTable_AddRef(MC_HTABLE hTable)
 {
@@ -567,11 +1132,23 @@ mcTable_Release(MC_HTABLE hTable)
 WORD MCTRL_API
 mcTable_ColumnCount(MC_HTABLE hTable)
 {
-    return (hTable ? ((table_t*) hTable)->col_count : 0);
+    return (WORD) MC_MIN(mcTable_ColumnCountEx(hTable), 0xffff);
 }
 
 WORD MCTRL_API
 mcTable_RowCount(MC_HTABLE hTable)
+{
+    return (WORD) MC_MIN(mcTable_RowCountEx(hTable), 0xffff);
+}
+
+DWORD MCTRL_API
+mcTable_ColumnCountEx(MC_HTABLE hTable)
+{
+    return (hTable ? ((table_t*) hTable)->col_count : 0);
+}
+
+DWORD MCTRL_API
+mcTable_RowCountEx(MC_HTABLE hTable)
 {
     return (hTable ? ((table_t*) hTable)->row_count : 0);
 }
@@ -587,39 +1164,100 @@ mcTable_Resize(MC_HTABLE hTable, WORD wColumnCount, WORD wRowCount)
     return TRUE;
 }
 
+BOOL MCTRL_API
+mcTable_ResizeEx(MC_HTABLE hTable, DWORD dwColumnCount, DWORD dwRowCount)
+{
+    if(MC_ERR(table_resize(hTable, dwColumnCount, dwRowCount) != 0)) {
+        MC_TRACE("mcTable_ResizeEx: table_resize() failed.");
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+BOOL MCTRL_API
+mcTable_InsertRows(MC_HTABLE hTable, WORD wRow, WORD wCount)
+{
+    table_t* table = (table_t*) hTable;
+
+    /* Do not grow the table beyond what the 16-bit indexes can address. */
+    if(MC_ERR(table->row_count + wCount >= MC_TABLE_HEADER)) {
+        MC_TRACE("mcTable_InsertRows: Too many rows, use mcTable_InsertRowsEx().");
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    if(MC_ERR(table_insert_rows(hTable, wRow, wCount) != 0)) {
+        MC_TRACE("mcTable_InsertRows: table_insert_rows() failed.");
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+BOOL MCTRL_API
+mcTable_RemoveRows(MC_HTABLE hTable, WORD wRow, WORD wCount)
+{
+    if(MC_ERR(table_remove_rows(hTable, wRow, wCount) != 0)) {
+        MC_TRACE("mcTable_RemoveRows: table_remove_rows() failed.");
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+BOOL MCTRL_API
+mcTable_InsertRowsEx(MC_HTABLE hTable, DWORD dwRow, DWORD dwCount)
+{
+    if(MC_ERR(table_insert_rows(hTable, dwRow, dwCount) != 0)) {
+        MC_TRACE("mcTable_InsertRowsEx: table_insert_rows() failed.");
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+BOOL MCTRL_API
+mcTable_RemoveRowsEx(MC_HTABLE hTable, DWORD dwRow, DWORD dwCount)
+{
+    if(MC_ERR(table_remove_rows(hTable, dwRow, dwCount) != 0)) {
+        MC_TRACE("mcTable_RemoveRowsEx: table_remove_rows() failed.");
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
 void MCTRL_API
 mcTable_Clear(MC_HTABLE hTable, DWORD dwWhat)
 {
     table_t* table = (table_t*) hTable;
-    table_cell_t* ptr[3];
-    int count[3];
-    int i, j, n = 0;
+    DWORD col;
     table_refresh_detail_t refresh_detail;
 
     if(dwWhat == 0)
         dwWhat = 0xffffffff;   /* clear everything */
 
     if(dwWhat & 0x1) {
-        ptr[n] = table->cells;
-        count[n] = table->col_count * table->row_count;
-        n++;
+        for(col = 0; col < table->col_count; col++) {
+            table_column_t* column = &table->columns[col];
+
+            if(column->type == MC_TCT_TEXT) {
+                table_cells_clear(table, &column->cells, 0, table->row_count);
+            } else if(table_column_is_typed(column)) {
+                column_clear(&column->data, 0, table->row_count);
+            }
+            /* (The column keeps its type.) */
+            table_column_init_cells(column, 0, table->row_count);
+        }
     }
     if(dwWhat & 0x2) {
-        ptr[n] = table->cols;
-        count[n] = table->col_count;
-        n++;
-    }
-    if(dwWhat & 0x4) {
-        ptr[n] = table->rows;
-        count[n] = table->row_count;
-        n++;
-    }
-
-    for(i = 0; i < n; i++) {
-        for(j = 0; j < count[i]; j++)
-            table_cell_clear(&ptr[i][j]);
-        memset(ptr[i], 0, count[i] * sizeof(table_cell_t));
+        for(col = 0; col < table->col_count; col++)
+            table_cell_clear(table, &table->cols[col]);
+        memset(table->cols, 0, table->col_count * sizeof(table_cell_t));
     }
+    if(dwWhat & 0x4)
+        table_cells_clear(table, &table->rows, 0, table->row_count);
 
     /* Refresh */
     refresh_detail.event = TABLE_REGION_CHANGED;
@@ -632,13 +1270,13 @@ mcTable_Clear(MC_HTABLE hTable, DWORD dwWhat)
     }
     if(dwWhat & 0x2) {
         refresh_detail.param[0] = 0;
-        refresh_detail.param[1] = MC_TABLE_HEADER;
+        refresh_detail.param[1] = TABLE_HEADER;
         refresh_detail.param[2] = table->col_count;
         refresh_detail.param[3] = 0;
         table_refresh(table, &refresh_detail);
     }
     if(dwWhat & 0x4) {
-        refresh_detail.param[0] = MC_TABLE_HEADER;
+        refresh_detail.param[0] = TABLE_HEADER;
         refresh_detail.param[1] = 0;
         refresh_detail.param[2] = 0;
         refresh_detail.param[3] = table->row_count;
@@ -649,7 +1287,8 @@ mcTable_Clear(MC_HTABLE hTable, DWORD dwWhat)
 BOOL MCTRL_API
 mcTable_SetCellW(MC_HTABLE hTable, WORD wCol, WORD wRow, MC_TABLECELLW* pCell)
 {
-    if(MC_ERR(table_set_cell_data(hTable, wCol, wRow, (MC_TABLECELL*)pCell, TRUE) != 0)) {
+    if(MC_ERR(table_set_cell_data(hTable, table_wide_index(wCol), table_wide_index(wRow),
+                                  (MC_TABLECELL*)pCell, TRUE) != 0)) {
         MC_TRACE("mcTable_SetCellW: table_set_cell_data() failed.");
         return FALSE;
     }
@@ -659,7 +1298,8 @@ mcTable_SetCellW(MC_HTABLE hTable, WORD wCol, WORD wRow, MC_TABLECELLW* pCell)
 BOOL MCTRL_API
 mcTable_SetCellA(MC_HTABLE hTable, WORD wCol, WORD wRow, MC_TABLECELLA* pCell)
 {
-    if(MC_ERR(table_set_cell_data(hTable, wCol, wRow, (MC_TABLECELL*)pCell, FALSE) != 0)) {
+    if(MC_ERR(table_set_cell_data(hTable, table_wide_index(wCol), table_wide_index(wRow),
+                                  (MC_TABLECELL*)pCell, FALSE) != 0)) {
         MC_TRACE("mcTable_SetCellA: table_set_cell_data() failed.");
         return FALSE;
     }
@@ -669,7 +1309,8 @@ mcTable_SetCellA(MC_HTABLE hTable, WORD wCol, WORD wRow, MC_TABLECELLA* pCell)
 BOOL MCTRL_API
 mcTable_GetCellW(MC_HTABLE hTable, WORD wCol, WORD wRow, MC_TABLECELLW* pCell)
 {
-    if(MC_ERR(table_get_cell_data(hTable, wCol, wRow, (MC_TABLECELL*)pCell, TRUE) != 0)) {
+    if(MC_ERR(table_get_cell_data(hTable, table_wide_index(wCol), table_wide_index(wRow),
+                                  (MC_TABLECELL*)pCell, TRUE) != 0)) {
         MC_TRACE("mcTable_GetCellA: table_get_cell_data() failed.");
         return FALSE;
     }
@@ -679,9 +1320,154 @@ mcTable_GetCellW(MC_HTABLE hTable, WORD wCol, WORD wRow, MC_TABLECELLW* pCell)
 BOOL MCTRL_API
 mcTable_GetCellA(MC_HTABLE hTable, WORD wCol, WORD wRow, MC_TABLECELLA* pCell)
 {
-    if(MC_ERR(table_get_cell_data(hTable, wCol, wRow, (MC_TABLECELL*)pCell, FALSE) != 0)) {
+    if(MC_ERR(table_get_cell_data(hTable, table_wide_index(wCol), table_wide_index(wRow),
+                                  (MC_TABLECELL*)pCell, FALSE) != 0)) {
         MC_TRACE("mcTable_GetCellA: table_get_cell_data() failed.");
         return FALSE;
     }
     return TRUE;
 }
+
+BOOL MCTRL_API
+mcTable_SetCellExW(MC_HTABLE hTable, DWORD dwCol, DWORD dwRow, MC_TABLECELLW* pCell)
+{
+    if(MC_ERR(table_set_cell_data(hTable, dwCol, dwRow, (MC_TABLECELL*)pCell, TRUE) != 0)) {
+        MC_TRACE("mcTable_SetCellExW: table_set_cell_data() failed.");
+        return FALSE;
+    }
+    return TRUE;
+}
+
+BOOL MCTRL_API
+mcTable_SetCellExA(MC_HTABLE hTable, DWORD dwCol, DWORD dwRow, MC_TABLECELLA* pCell)
+{
+    if(MC_ERR(table_set_cell_data(hTable, dwCol, dwRow, (MC_TABLECELL*)pCell, FALSE) != 0)) {
+        MC_TRACE("mcTable_SetCellExA: table_set_cell_data() failed.");
+        return FALSE;
+    }
+    return TRUE;
+}
+
+BOOL MCTRL_API
+mcTable_GetCellExW(MC_HTABLE hTable, DWORD dwCol, DWORD dwRow, MC_TABLECELLW* pCell)
+{
+    if(MC_ERR(table_get_cell_data(hTable, dwCol, dwRow, (MC_TABLECELL*)pCell, TRUE) != 0)) {
+        MC_TRACE("mcTable_GetCellExW: table_get_cell_data() failed.");
+        return FALSE;
+    }
+    return TRUE;
+}
+
+BOOL MCTRL_API
+mcTable_GetCellExA(MC_HTABLE hTable, DWORD dwCol, DWORD dwRow, MC_TABLECELLA* pCell)
+{
+    if(MC_ERR(table_get_cell_data(hTable, dwCol, dwRow, (MC_TABLECELL*)pCell, FALSE) != 0)) {
+        MC_TRACE("mcTable_GetCellExA: table_get_cell_data() failed.");
+        return FALSE;
+    }
+    return TRUE;
+}
+
+static BOOL
+table_set_region_helper(MC_HTABLE hTable, WORD wCol, WORD wRow,
+                        WORD wColumnCount, WORD wRowCount,
+                        MC_TABLECELL* pCells, BOOL unicode)
+{
+    table_region_t reg;
+
+    if(MC_ERR(wCol + wColumnCount > 0xffff  ||  wRow + wRowCount > 0xffff)) {
+        MC_TRACE("mcTable_SetRegion: Region out of range.");
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    reg.col0 = wCol;
+    reg.row0 = wRow;
+    reg.col1 = wCol + wColumnCount;
+    reg.row1 = wRow + wRowCount;
+
+    if(MC_ERR(table_set_region_data(hTable, &reg, pCells, unicode) != 0)) {
+        MC_TRACE("mcTable_SetRegion: table_set_region_data() failed.");
+        return FALSE;
+    }
+    return TRUE;
+}
+
+BOOL MCTRL_API
+mcTable_SetRegionW(MC_HTABLE hTable, WORD wCol, WORD wRow,
+                   WORD wColumnCount, WORD wRowCount, MC_TABLECELLW* pCells)
+{
+    return table_set_region_helper(hTable, wCol, wRow, wColumnCount, wRowCount,
+                                   (MC_TABLECELL*) pCells, TRUE);
+}
+
+BOOL MCTRL_API
+mcTable_SetRegionA(MC_HTABLE hTable, WORD wCol, WORD wRow,
+                   WORD wColumnCount, WORD wRowCount, MC_TABLECELLA* pCells)
+{
+    return table_set_region_helper(hTable, wCol, wRow, wColumnCount, wRowCount,
+                                   (MC_TABLECELL*) pCells, FALSE);
+}
+
+void MCTRL_API
+mcTable_BeginUpdate(MC_HTABLE hTable)
+{
+    if(hTable)
+        table_begin_update((table_t*) hTable);
+}
+
+void MCTRL_API
+mcTable_EndUpdate(MC_HTABLE hTable)
+{
+    if(hTable)
+        table_end_update((table_t*) hTable);
+}
+
+BOOL MCTRL_API
+mcTable_SetColumnType(MC_HTABLE hTable, WORD wCol, DWORD dwType)
+{
+    if(MC_ERR(table_set_column_type(hTable, wCol, dwType) != 0)) {
+        MC_TRACE("mcTable_SetColumnType: table_set_column_type() failed.");
+        return FALSE;
+    }
+    return TRUE;
+}
+
+DWORD MCTRL_API
+mcTable_GetColumnType(MC_HTABLE hTable, WORD wCol)
+{
+    table_t* table = (table_t*) hTable;
+
+    if(MC_ERR(table == NULL  ||  wCol >= table->col_count)) {
+        MC_TRACE("mcTable_GetColumnType: Column ID %hd does not exist", wCol);
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return (DWORD) -1;
+    }
+    return table_column_type(table, wCol);
+}
+
+BOOL MCTRL_API
+mcTable_GetPoolStats(MC_HTABLE hTable, MC_TABLEPOOLSTATS* pStats)
+{
+    table_t* table = (table_t*) hTable;
+    INTERN_STATS stats;
+
+    if(MC_ERR(table == NULL  ||  pStats == NULL)) {
+        MC_TRACE("mcTable_GetPoolStats: Invalid parameter.");
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+    if(MC_ERR(table->intern == NULL)) {
+        MC_TRACE("mcTable_GetPoolStats: The table has no text pool.");
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+    intern_stats(table->intern, &stats);
+    pStats->dwStrings = (DWORD) stats.strings;
+    pStats->ullLookups = stats.lookups;
+    pStats->ullHits = stats.hits;
+    pStats->ullBytes = stats.bytes;
+    pStats->ullBytesSaved = stats.bytes_saved;
+    return TRUE;
+}
@@ -28,6 +28,10 @@
 #include "misc.h"
 #include "viewlist.h"
 
+#include "c-reusables/data/column.h"
+#include "c-reusables/data/intern.h"
+#include "c-reusables/data/rope.h"
+
 
 typedef struct table_cell_tag table_cell_t;
 struct table_cell_tag {
@@ -37,48 +41,144 @@ struct table_cell_tag {
 };
 
 
+#define TABLE_CHUNK_ROWS        256
 
-typedef struct table_tag table_t;
-struct table_tag {
-    mc_ref_t refs;
-    WORD col_count;
-    WORD row_count;
-    table_cell_t* restrict cols;
-    table_cell_t* restrict rows;
-    table_cell_t* restrict cells;
+/* Internally, the table uses 32-bit indexes of columns and rows (see
+ * mcTable_CreateEx()). The header cells are addressed with TABLE_HEADER,
+ * which is the same as MC_TABLE_HEADEREX and GRID_HEADER. The 16-bit API
+ * has to translate MC_TABLE_HEADER with table_wide_index(). */
+#define TABLE_HEADER            MC_TABLE_HEADEREX
 
-    view_list_t vlist;
+/* The counts have to fit into int (see table_refresh_detail_t). */
+#define TABLE_MAX_COUNT         0x7fffffff
+
+static inline DWORD
+table_wide_index(WORD index)
+{
+    return (index == MC_TABLE_HEADER ? TABLE_HEADER : index);
+}
+
+/* The table is stored column by column. Every column has its own array of
+ * cells, split into chunks of TABLE_CHUNK_ROWS rows (c-reusables ROPE), so
+ * inserting or removing a row in the middle of a big table moves only the
+ * cells of a single chunk in each column.
+ *
+ * In typed columns (MC_TCT_INT64, MC_TCT_DOUBLE, MC_TCT_STRING), the cells
+ * hold only lp and flags, and the values live in a contiguous c-reusables
+ * COLUMN (with NULL as cell->text). In MC_TCT_CALLBACK columns cell->text is
+ * always MC_LPSTR_TEXTCALLBACK. */
+typedef struct table_column_tag table_column_t;
+struct table_column_tag {
+    ROPE cells;         /* Of table_cell_t. */
+    DWORD type;         /* MC_TCT_xxxx */
+    COLUMN data;        /* Only for MC_TCT_INT64, MC_TCT_DOUBLE, MC_TCT_STRING. */
 };
 
+static inline BOOL
+table_column_is_typed(const table_column_t* column)
+{
+    return (column->type == MC_TCT_INT64  ||  column->type == MC_TCT_DOUBLE  ||
+            column->type == MC_TCT_STRING);
+}
 
 
 typedef struct table_region_tag table_region_t;
 struct table_region_tag {
-    WORD col0;  /* [col0,row0] inclusive */
-    WORD row0;
-    WORD col1;  /* [col1,row1] exclusive */
-    WORD row1;
+    DWORD col0;  /* [col0,row0] inclusive */
+    DWORD row0;
+    DWORD col1;  /* [col1,row1] exclusive */
+    DWORD row1;
 };
 
 
 
-table_t* table_create(WORD col_count, WORD row_count);
+typedef struct table_tag table_t;
+struct table_tag {
+    mc_ref_t refs;
+    DWORD col_count;
+    DWORD row_count;
+    table_cell_t* restrict cols;
+    ROPE rows;          /* Row headers (of table_cell_t). */
+    table_column_t* restrict columns;
+
+    /* Between table_begin_update() and table_end_update(), the changes are
+     * not propagated to the views immediately. They are only collected in
+     * the dirty regions, to be refreshed all at once at the end. */
+    WORD update_level;
+    table_region_t dirty_cells;
+    table_region_t dirty_cols;  /* Column headers (row range is [0,1)). */
+    table_region_t dirty_rows;  /* Row headers (column range is [0,1)). */
+
+    /* If not NULL, all texts of the cells (as well as of the headers) are
+     * interned in the pool (see MC_TF_INTERNTEXT). */
+    INTERN* intern;
+
+    view_list_t vlist;
+};
+
+
+
+table_t* table_create(DWORD col_count, DWORD row_count, DWORD flags);
 void table_destroy(table_t* table);
 
-int table_resize(table_t* table, WORD col_count, WORD row_count);
+int table_resize(table_t* table, DWORD col_count, DWORD row_count);
 
-static inline table_cell_t* table_cell(table_t* table, WORD col, WORD row)
-    { return &table->cells[row * table->col_count + col]; }
+/* Insert or remove count rows at (or from) the position row_pos. The rows
+ * below it move, while keeping their data. */
+int table_insert_rows(table_t* table, DWORD row_pos, DWORD count);
+int table_remove_rows(table_t* table, DWORD row_pos, DWORD count);
 
-table_cell_t* table_get_cell(table_t* table, WORD col, WORD row);
+static inline table_cell_t* table_cell(table_t* table, DWORD col, DWORD row)
+    { return (table_cell_t*) rope_get(&table->columns[col].cells, row); }
+static inline table_cell_t* table_row_header(table_t* table, DWORD row)
+    { return (table_cell_t*) rope_get(&table->rows, row); }
+
+table_cell_t* table_get_cell(table_t* table, DWORD col, DWORD row);
 
 static inline void table_ref(table_t* table)
     { mc_ref(&table->refs); }
 static inline void table_unref(table_t* table)
     { if(mc_unref(&table->refs) == 0) table_destroy(table); }
 
-int table_set_cell_data(table_t* table, WORD col, WORD row, MC_TABLECELL* cell_data, BOOL unicode);
-int table_get_cell_data(table_t* table, WORD col, WORD row, MC_TABLECELL* cell_data, BOOL unicode);
+int table_set_cell_data(table_t* table, DWORD col, DWORD row, MC_TABLECELL* cell_data, BOOL unicode);
+int table_get_cell_data(table_t* table, DWORD col, DWORD row, MC_TABLECELL* cell_data, BOOL unicode);
+
+/* Set all (ordinary) cells in the region from the given array of
+ * (reg->col1 - reg->col0) * (reg->row1 - reg->row0) cells, row by row.
+ * The views get a single TABLE_REGION_CHANGED.
+ * If setting some cell fails, the function stops and returns -1; the cells
+ * set before it keep their new contents. */
+int table_set_region_data(table_t* table, const table_region_t* reg,
+                          MC_TABLECELL* cells, BOOL unicode);
+
+/* Batch more changes into a single refresh of the views. The calls may be
+ * nested. */
+void table_begin_update(table_t* table);
+void table_end_update(table_t* table);
+
+/* Buffer size (in characters) large enough for any formatted value of a typed
+ * column. */
+#define TABLE_VALUE_BUFSIZE     32
+
+/* Get text to display in the (ordinary, i.e. non-header) cell. For typed
+ * columns, the value is formatted into buf (or a pointer into the column's
+ * string pool is returned). Otherwise it is just cell->text (so the caller
+ * has to handle MC_LPSTR_TEXTCALLBACK). The result must not be freed. */
+TCHAR* table_cell_text(table_t* table, DWORD col, DWORD row, TCHAR* buf, int buf_size);
+
+int table_set_column_type(table_t* table, DWORD col, DWORD type);
+static inline DWORD table_column_type(table_t* table, DWORD col)
+    { return table->columns[col].type; }
+
+/* Whole-column operations for typed columns. They work over the contiguous
+ * value arrays and fail for MC_TCT_TEXT and MC_TCT_CALLBACK columns.
+ *
+ * table_column_sort() sorts the vector of row indexes (possibly a subset of
+ * all rows) by values in the column. The sort is stable and NULL values go
+ * last. */
+int table_column_min(table_t* table, DWORD col, DWORD* p_row);
+int table_column_max(table_t* table, DWORD col, DWORD* p_row);
+int table_column_sort(table_t* table, DWORD col, BOOL descending, size_t* rows, size_t n);
 
 
 
@@ -93,7 +193,7 @@ struct table_refresh_detail_tag {
         TABLE_ROWCOUNT_CHANGED   /* params: old_count, new_count, row_pos */
     } event;
 
-    int param[4];
+    int param[4];   /* TABLE_HEADER is passed as (int) TABLE_HEADER. */
 };
 
 
@@ -0,0 +1,713 @@
+/*
+ * mCtrl: Additional Win32 controls
+ * <https://github.com/mity/mctrl>
+ * <https://mctrl.org>
+ *
+ * Copyright (c) 2010-2020 Martin Mitas
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "tableview.h"
+
+#include "c-reusables/data/msort.h"
+
+
+/* Uncomment this to have more verbose traces from this module. */
+/*#define TABLE_VIEW_DEBUG     1*/
+
+#ifdef TABLE_VIEW_DEBUG
+    #define TABLE_VIEW_TRACE     MC_TRACE
+#else
+    #define TABLE_VIEW_TRACE     MC_NOOP
+#endif
+
+
+#define TABLE_VIEW_IS_HIDDEN(view, row)                                     \
+        ((view)->hidden[(row) >> 5] & (1U << ((row) & 31)))
+
+#define TABLE_VIEW_BITMAP_SIZE(row_count)                                   \
+        ((((size_t)(row_count) + 31) / 32) * sizeof(uint32_t))
+
+
+static void
+table_view_send(table_view_t* view, int event, int p0, int p1, int p2, int p3)
+{
+    table_refresh_detail_t detail;
+
+    detail.event = event;
+    detail.param[0] = p0;
+    detail.param[1] = p1;
+    detail.param[2] = p2;
+    detail.param[3] = p3;
+    view_list_refresh(&view->vlist, &detail);
+}
+
+/* Refresh all the ordinary cells and the row headers in the range of view
+ * rows. Empty ranges are not sent at all. */
+static void
+table_view_send_rows(table_view_t* view, DWORD view_row0, DWORD view_row1)
+{
+    if(view_row0 >= view_row1)
+        return;
+
+    if(view->table->col_count > 0) {
+        table_view_send(view, TABLE_REGION_CHANGED,
+                        0, view_row0, view->table->col_count, view_row1);
+    }
+    table_view_send(view, TABLE_REGION_CHANGED,
+                    TABLE_HEADER, view_row0, 0, view_row1);
+}
+
+/* Reallocate the index for the new count of the table rows. The rows
+ * [row_pos, row_pos + row_delta) have been inserted (or, for negative
+ * row_delta, [row_pos, row_pos - row_delta) removed).
+ *
+ * The surviving rows keep their order: They are renumbered and stored into
+ * the beginning of the new order[]. Returns their count (the caller has to
+ * put the inserted rows into the rest of order[]), or -1 on failure. */
+static int
+table_view_resize(table_view_t* view, int row_count, int row_pos, int row_delta)
+{
+    size_t* order;
+    DWORD* positions;
+    DWORD* rows;
+    DWORD* view_rows;
+    uint32_t* hidden;
+    int row, old_row;
+    size_t i, n;
+
+    order = (size_t*) malloc(MC_MAX(row_count, 1) * sizeof(size_t));
+    positions = (DWORD*) malloc(MC_MAX(row_count, 1) * sizeof(DWORD));
+    rows = (DWORD*) malloc(MC_MAX(row_count, 1) * sizeof(DWORD));
+    view_rows = (DWORD*) malloc(MC_MAX(row_count, 1) * sizeof(DWORD));
+    hidden = (uint32_t*) malloc(TABLE_VIEW_BITMAP_SIZE(MC_MAX(row_count, 1)));
+    if(MC_ERR(order == NULL  ||  positions == NULL  ||  rows == NULL  ||
+              view_rows == NULL  ||  hidden == NULL)) {
+        MC_TRACE("table_view_resize: malloc() failed.");
+        free(order);
+        free(positions);
+        free(rows);
+        free(view_rows);
+        free(hidden);
+        return -1;
+    }
+
+    /* Carry over the order. */
+    n = 0;
+    for(i = 0; i < view->table_row_count; i++) {
+        old_row = (int) view->order[i];
+        if(old_row < row_pos)
+            row = old_row;
+        else if(row_delta < 0  &&  old_row < row_pos - row_delta)
+            continue;
+        else
+            row = old_row + row_delta;
+
+        if(row < row_count)
+            order[n++] = row;
+    }
+
+    /* Carry over the filter. New rows are visible. */
+    memset(hidden, 0, TABLE_VIEW_BITMAP_SIZE(MC_MAX(row_count, 1)));
+    for(row = 0; row < row_count; row++) {
+        if(row < row_pos)
+            old_row = row;
+        else if(row < row_pos + row_delta)
+            continue;
+        else
+            old_row = row - row_delta;
+
+        if(old_row < (int) view->table_row_count  &&  TABLE_VIEW_IS_HIDDEN(view, old_row))
+            hidden[row >> 5] |= (1U << (row & 31));
+    }
+
+    free(view->order);
+    free(view->positions);
+    free(view->rows);
+    free(view->view_rows);
+    free(view->hidden);
+    view->order = order;
+    view->positions = positions;
+    view->rows = rows;
+    view->view_rows = view_rows;
+    view->hidden = hidden;
+    view->table_row_count = row_count;
+    return (int) n;
+}
+
+/* Rebuild the mapping between the table rows and view rows from the sort
+ * order and the filter. */
+static void
+table_view_reindex(table_view_t* view)
+{
+    DWORD i, row;
+    DWORD n = 0;
+
+    for(i = 0; i < view->table_row_count; i++) {
+        row = (DWORD) view->order[i];
+        view->positions[row] = i;
+        if(TABLE_VIEW_IS_HIDDEN(view, row)) {
+            view->view_rows[row] = TABLE_VIEW_HIDDEN;
+        } else {
+            view->view_rows[row] = n;
+            view->rows[n] = row;
+            n++;
+        }
+    }
+
+    view->row_count = n;
+}
+
+/* Compare two table rows by a single key. This has to be consistent with
+ * table_column_sort(): NULL values go last regardless of the sort direction,
+ * and doubles are compared by the same keys the radix sort uses (so that e.g.
+ * -0.0 and 0.0 or NaNs are ordered the same way). */
+static int
+table_view_cmp_key(table_t* table, const table_sort_key_t* key, size_t row1, size_t row2)
+{
+    table_column_t* column = &table->columns[key->col];
+    int cmp;
+
+    switch(column->type) {
+        case MC_TCT_TEXT:
+        {
+            /* (Called from more threads by msort_parallel(), so we must not
+             * use table_cell() which caches the chunk in the rope.) */
+            const TCHAR* text1 = ((const table_cell_t*) rope_get_const(&column->cells, row1))->text;
+            const TCHAR* text2 = ((const table_cell_t*) rope_get_const(&column->cells, row2))->text;
+
+            if(text1 == MC_LPSTR_TEXTCALLBACK)
+                text1 = NULL;
+            if(text2 == MC_LPSTR_TEXTCALLBACK)
+                text2 = NULL;
+
+            /* With interned texts, equal texts are also the same pointers. */
+            if(text1 == text2)
+                return 0;
+            if(text1 == NULL  ||  text2 == NULL)
+                return (text1 == NULL ? +1 : -1);
+            cmp = _tcscoll(text1, text2);
+            break;
+        }
+
+        case MC_TCT_INT64:
+        case MC_TCT_DOUBLE:
+        case MC_TCT_STRING:
+        {
+            int null1 = column_is_null(&column->data, row1);
+            int null2 = column_is_null(&column->data, row2);
+
+            if(null1  ||  null2)
+                return (null1 ? 1 : 0) - (null2 ? 1 : 0);
+
+            if(column->type == MC_TCT_INT64) {
+                int64_t v1 = column_get_int64(&column->data, row1);
+                int64_t v2 = column_get_int64(&column->data, row2);
+                cmp = (v1 < v2) ? -1 : (v1 > v2 ? +1 : 0);
+            } else if(column->type == MC_TCT_DOUBLE) {
+                uint64_t v1 = column_double_key(column_get_double(&column->data, row1));
+                uint64_t v2 = column_double_key(column_get_double(&column->data, row2));
+                cmp = (v1 < v2) ? -1 : (v1 > v2 ? +1 : 0);
+            } else {
+                /* The column stores each distinct string only once. */
+                const void* str1 = column_get_string(&column->data, row1, NULL);
+                const void* str2 = column_get_string(&column->data, row2, NULL);
+                if(str1 == str2)
+                    return 0;
+                cmp = _tcscoll((const TCHAR*) str1, (const TCHAR*) str2);
+            }
+            break;
+        }
+
+        default:
+            /* MC_TCT_CALLBACK: We have no data to sort by. */
+            return 0;
+    }
+
+    return (key->flags & TABLE_SORT_DESCENDING) ? -cmp : cmp;
+}
+
+typedef struct table_view_key_ctx_tag table_view_key_ctx_t;
+struct table_view_key_ctx_tag {
+    table_t* table;
+    const table_sort_key_t* key;
+};
+
+static int
+table_view_cmp_single_key(size_t row1, size_t row2, void* ctx)
+{
+    table_view_key_ctx_t* key_ctx = (table_view_key_ctx_t*) ctx;
+    return table_view_cmp_key(key_ctx->table, key_ctx->key, row1, row2);
+}
+
+/* Compare by all the keys. The ties are broken by the table order, so this
+ * is a total order consistent with the result of table_view_sort(). */
+static int
+table_view_cmp(size_t row1, size_t row2, void* ctx)
+{
+    table_view_t* view = (table_view_t*) ctx;
+    WORD i;
+    int cmp;
+
+    for(i = 0; i < view->key_count; i++) {
+        cmp = table_view_cmp_key(view->table, &view->keys[i], row1, row2);
+        if(cmp != 0)
+            return cmp;
+    }
+
+    return (row1 < row2) ? -1 : (row1 > row2 ? +1 : 0);
+}
+
+/* Sort all the rows. On failure, the order is left in some valid (but not
+ * sorted) state. */
+static int
+table_view_sort(table_view_t* view)
+{
+    table_t* table = view->table;
+    size_t n = view->table_row_count;
+    table_view_key_ctx_t key_ctx;
+    size_t i;
+    int k;
+    int ret = 0;
+
+    for(i = 0; i < n; i++)
+        view->order[i] = i;
+
+    /* Sort by each key, from the least significant one. As all the sorts are
+     * stable, the result is ordered by all the keys, and the ties keep the
+     * table order. Typed columns use the radix sort over their values; texts
+     * go through the (possibly parallel) merge sort. */
+    for(k = view->key_count - 1; k >= 0; k--) {
+        const table_sort_key_t* key = &view->keys[k];
+
+        switch(table_column_type(table, key->col)) {
+            case MC_TCT_TEXT:
+                key_ctx.table = table;
+                key_ctx.key = key;
+                ret = msort_parallel(view->order, n, table_view_cmp_single_key, &key_ctx, 0);
+                break;
+
+            case MC_TCT_CALLBACK:
+                ret = 0;
+                break;
+
+            default:
+                ret = table_column_sort(table, key->col,
+                            (key->flags & TABLE_SORT_DESCENDING), view->order, n);
+                break;
+        }
+
+        if(MC_ERR(ret != 0)) {
+            MC_TRACE("table_view_sort: Sorting by column %lu failed.", key->col);
+            break;
+        }
+    }
+
+    table_view_reindex(view);
+    return ret;
+}
+
+/* The value of the row in a sort key column has changed: Move the row to its
+ * new place. The row is found through the positions[] index and its new place
+ * by a binary search, so only the rows it passes over are renumbered. */
+static void
+table_view_move_row(table_view_t* view, DWORD col, DWORD row)
+{
+    size_t n = view->table_row_count;
+    size_t old_pos = view->positions[row];
+    size_t new_pos, pos, pos0, pos1;
+    DWORD old_view_row = view->view_rows[row];
+    DWORD new_view_row;
+    DWORD view_row;
+    DWORD r;
+
+    /* All the other rows are still sorted, so the row either stays, or moves
+     * before its predecessor, or after its successor. */
+    if(old_pos > 0  &&  table_view_cmp(row, view->order[old_pos-1], view) < 0) {
+        new_pos = msort_upper_bound(view->order, old_pos, row, table_view_cmp, view);
+        memmove(view->order + new_pos + 1, view->order + new_pos,
+                (old_pos - new_pos) * sizeof(size_t));
+        pos0 = new_pos;
+        pos1 = old_pos + 1;
+    } else if(old_pos + 1 < n  &&  table_view_cmp(row, view->order[old_pos+1], view) > 0) {
+        new_pos = old_pos + msort_upper_bound(view->order + old_pos + 1,
+                    n - old_pos - 1, row, table_view_cmp, view);
+        memmove(view->order + old_pos, view->order + old_pos + 1,
+                (new_pos - old_pos) * sizeof(size_t));
+        pos0 = old_pos;
+        pos1 = new_pos + 1;
+    } else {
+        if(old_view_row != TABLE_VIEW_HIDDEN)
+            table_view_send(view, TABLE_CELL_CHANGED, col, old_view_row, 0, 0);
+        return;
+    }
+    view->order[new_pos] = row;
+
+    TABLE_VIEW_TRACE("table_view_move_row: Row %lu moves from %lu to %lu.",
+                     row, (DWORD) old_pos, (DWORD) new_pos);
+
+    /* Only the rows in [pos0, pos1) have moved. The visible ones among them
+     * still occupy the same contiguous range of the view rows. */
+    view_row = TABLE_VIEW_HIDDEN;
+    for(pos = pos0; pos < pos1; pos++) {
+        r = (DWORD) view->order[pos];
+        view->positions[r] = (DWORD) pos;
+        if(!TABLE_VIEW_IS_HIDDEN(view, r))
+            view_row = MC_MIN(view_row, view->view_rows[r]);
+    }
+
+    if(old_view_row == TABLE_VIEW_HIDDEN)
+        return;
+
+    for(pos = pos0; pos < pos1; pos++) {
+        r = (DWORD) view->order[pos];
+        if(!TABLE_VIEW_IS_HIDDEN(view, r)) {
+            view->view_rows[r] = view_row;
+            view->rows[view_row] = r;
+            view_row++;
+        }
+    }
+
+    new_view_row = view->view_rows[row];
+    if(new_view_row == old_view_row) {
+        /* It has moved only over some hidden rows. */
+        table_view_send(view, TABLE_CELL_CHANGED, col, old_view_row, 0, 0);
+        return;
+    }
+
+    table_view_send_rows(view, MC_MIN(old_view_row, new_view_row),
+                         MC_MAX(old_view_row, new_view_row) + 1);
+}
+
+/* Put the k rows just inserted into the table at row_pos to their places in
+ * order[], where the first n rows are the old ones (already renumbered by
+ * table_view_resize()). Only the new rows are sorted, and then each of them
+ * is placed by a binary search, so this takes O(n + k log(n + k)). */
+static int
+table_view_insert_rows(table_view_t* view, size_t n, DWORD row_pos)
+{
+    size_t k = view->table_row_count - n;
+    size_t* new_rows;
+    size_t i, j, pos;
+
+    new_rows = (size_t*) malloc(k * sizeof(size_t));
+    if(MC_ERR(new_rows == NULL)) {
+        MC_TRACE("table_view_insert_rows: malloc() failed.");
+        return -1;
+    }
+
+    for(j = 0; j < k; j++)
+        new_rows[j] = row_pos + j;
+    if(view->key_count > 0) {
+        if(MC_ERR(msort(new_rows, k, table_view_cmp, view) != 0)) {
+            MC_TRACE("table_view_insert_rows: msort() failed.");
+            free(new_rows);
+            return -1;
+        }
+    }
+
+    /* Merge from the end, so that each old row is moved only once. */
+    i = n;
+    for(j = k; j > 0; j--) {
+        pos = msort_upper_bound(view->order, i, new_rows[j-1], table_view_cmp, view);
+        memmove(view->order + pos + j, view->order + pos, (i - pos) * sizeof(size_t));
+        view->order[pos + j - 1] = new_rows[j-1];
+        i = pos;
+    }
+
+    free(new_rows);
+    return 0;
+}
+
+static BOOL
+table_view_is_key(table_view_t* view, DWORD col0, DWORD col1)
+{
+    WORD i;
+
+    for(i = 0; i < view->key_count; i++) {
+        if(col0 <= view->keys[i].col  &&  view->keys[i].col < col1)
+            return TRUE;
+    }
+
+    return FALSE;
+}
+
+static void
+table_view_region_changed(table_view_t* view, DWORD col0, DWORD row0, DWORD col1, DWORD row1)
+{
+    DWORD view_row0 = TABLE_VIEW_HIDDEN;
+    DWORD view_row1 = 0;
+    DWORD view_row;
+    DWORD row;
+
+    /* Column headers do not depend on the rows at all. */
+    if(row0 == TABLE_HEADER) {
+        table_view_send(view, TABLE_REGION_CHANGED, col0, row0, col1, row1);
+        return;
+    }
+
+    row1 = MC_MIN(row1, view->table_row_count);
+
+    if(col0 != TABLE_HEADER  &&  table_view_is_key(view, col0, col1)) {
+        table_view_sort(view);
+        table_view_send_rows(view, 0, view->row_count);
+        return;
+    }
+
+    /* The rows are scattered over the view. Refresh the range covering them
+     * all. */
+    for(row = row0; row < row1; row++) {
+        view_row = view->view_rows[row];
+        if(view_row == TABLE_VIEW_HIDDEN)
+            continue;
+        view_row0 = MC_MIN(view_row0, view_row);
+        view_row1 = MC_MAX(view_row1, view_row + 1);
+    }
+    if(view_row0 < view_row1)
+        table_view_send(view, TABLE_REGION_CHANGED, col0, view_row0, col1, view_row1);
+}
+
+static void
+table_view_colcount_changed(table_view_t* view, int old_count, int new_count, int col_pos)
+{
+    int col_delta = new_count - old_count;
+    BOOL dropped = FALSE;
+    WORD i, n;
+
+    /* Drop keys of removed columns, and renumber the others. */
+    n = 0;
+    for(i = 0; i < view->key_count; i++) {
+        int col = view->keys[i].col;
+
+        if(col_delta < 0  &&  col >= col_pos  &&  col < col_pos - col_delta) {
+            dropped = TRUE;
+            continue;
+        }
+        if(col >= col_pos)
+            col += col_delta;
+
+        view->keys[n].col = col;
+        view->keys[n].flags = view->keys[i].flags;
+        n++;
+    }
+    view->key_count = n;
+
+    if(dropped)
+        table_view_sort(view);
+
+    table_view_send(view, TABLE_COLCOUNT_CHANGED, old_count, new_count, col_pos, 0);
+}
+
+static void
+table_view_rowcount_changed(table_view_t* view, int new_count, int row_pos)
+{
+    DWORD old_view_count = view->row_count;
+    int n;
+
+    /* The rows below the insertion/removal point are renumbered, but they
+     * keep their order. So only the new rows (if any) need to be sorted. */
+    n = table_view_resize(view, new_count, row_pos, new_count - (int) view->table_row_count);
+    if(MC_ERR(n < 0)) {
+        /* Better show less rows than the wrong ones. */
+        MC_TRACE("table_view_rowcount_changed: table_view_resize() failed.");
+        view->table_row_count = MC_MIN(view->table_row_count, (DWORD) new_count);
+        memset(view->hidden, 0, TABLE_VIEW_BITMAP_SIZE(view->table_row_count));
+        table_view_sort(view);
+    } else if(n < new_count  &&  table_view_insert_rows(view, n, row_pos) != 0) {
+        MC_TRACE("table_view_rowcount_changed: table_view_insert_rows() failed.");
+        table_view_sort(view);
+    } else {
+        table_view_reindex(view);
+    }
+
+    table_view_send(view, TABLE_ROWCOUNT_CHANGED, old_view_count, view->row_count, 0, 0);
+}
+
+static void
+table_view_refresh(void* v, void* detail)
+{
+    table_view_t* view = (table_view_t*) v;
+    table_refresh_detail_t* rd = (table_refresh_detail_t*) detail;
+    DWORD col, row, view_row;
+
+    switch(rd->event) {
+        case TABLE_CELL_CHANGED:
+            col = rd->param[0];
+            row = rd->param[1];
+            if(row == TABLE_HEADER) {
+                table_view_send(view, TABLE_CELL_CHANGED, col, row, 0, 0);
+                break;
+            }
+            if(row >= view->table_row_count)
+                break;
+            if(col != TABLE_HEADER  &&  table_view_is_key(view, col, col+1)) {
+                table_view_move_row(view, col, row);
+                break;
+            }
+            view_row = view->view_rows[row];
+            if(view_row != TABLE_VIEW_HIDDEN)
+                table_view_send(view, TABLE_CELL_CHANGED, col, view_row, 0, 0);
+            break;
+
+        case TABLE_REGION_CHANGED:
+            table_view_region_changed(view, rd->param[0], rd->param[1],
+                                      rd->param[2], rd->param[3]);
+            break;
+
+        case TABLE_COLCOUNT_CHANGED:
+            table_view_colcount_changed(view, rd->param[0], rd->param[1], rd->param[2]);
+            break;
+
+        case TABLE_ROWCOUNT_CHANGED:
+            table_view_rowcount_changed(view, rd->param[1], rd->param[2]);
+            break;
+    }
+}
+
+table_view_t*
+table_view_create(table_t* table)
+{
+    table_view_t* view;
+
+    TABLE_VIEW_TRACE("table_view_create(%p)", table);
+
+    view = (table_view_t*) malloc(sizeof(table_view_t));
+    if(MC_ERR(view == NULL)) {
+        MC_TRACE("table_view_create: malloc() failed.");
+        return NULL;
+    }
+
+    memset(view, 0, sizeof(table_view_t));
+    view->table = table;
+    view_list_init(&view->vlist);
+
+    if(MC_ERR(table_view_resize(view, table->row_count, 0, 0) < 0)) {
+        MC_TRACE("table_view_create: table_view_resize() failed.");
+        goto err_resize;
+    }
+    table_view_sort(view);  /* No keys yet, so this cannot fail. */
+
+    if(MC_ERR(table_install_view(table, view, table_view_refresh) != 0)) {
+        MC_TRACE("table_view_create: table_install_view() failed.");
+        goto err_install;
+    }
+
+    table_ref(table);
+    return view;
+
+err_install:
+    free(view->order);
+    free(view->positions);
+    free(view->rows);
+    free(view->view_rows);
+    free(view->hidden);
+err_resize:
+    view_list_fini(&view->vlist);
+    free(view);
+    return NULL;
+}
+
+void
+table_view_destroy(table_view_t* view)
+{
+    TABLE_VIEW_TRACE("table_view_destroy(%p)", view);
+
+    table_uninstall_view(view->table, view);
+    table_unref(view->table);
+
+    free(view->keys);
+    free(view->order);
+    free(view->positions);
+    free(view->rows);
+    free(view->view_rows);
+    free(view->hidden);
+    view_list_fini(&view->vlist);
+    free(view);
+}
+
+int
+table_view_set_sort(table_view_t* view, const table_sort_key_t* keys, WORD key_count)
+{
+    table_sort_key_t* new_keys = NULL;
+    WORD i;
+    int ret;
+
+    TABLE_VIEW_TRACE("table_view_set_sort(%p, %p, %hd)", view, keys, key_count);
+
+    for(i = 0; i < key_count; i++) {
+        if(MC_ERR(keys[i].col >= view->table->col_count)) {
+            MC_TRACE("table_view_set_sort: Column ID %lu does not exist", keys[i].col);
+            SetLastError(ERROR_INVALID_PARAMETER);
+            return -1;
+        }
+        if(MC_ERR(table_column_type(view->table, keys[i].col) == MC_TCT_CALLBACK)) {
+            MC_TRACE("table_view_set_sort: Cannot sort by MC_TCT_CALLBACK column.");
+            SetLastError(ERROR_INVALID_PARAMETER);
+            return -1;
+        }
+        if(MC_ERR(keys[i].flags & ~TABLE_SORT_DESCENDING)) {
+            MC_TRACE("table_view_set_sort: Unsupported flags 0x%x", keys[i].flags);
+            SetLastError(ERROR_INVALID_PARAMETER);
+            return -1;
+        }
+    }
+
+    if(key_count > 0) {
+        new_keys = (table_sort_key_t*) malloc(key_count * sizeof(table_sort_key_t));
+        if(MC_ERR(new_keys == NULL)) {
+            MC_TRACE("table_view_set_sort: malloc() failed.");
+            return -1;
+        }
+        memcpy(new_keys, keys, key_count * sizeof(table_sort_key_t));
+    }
+
+    free(view->keys);
+    view->keys = new_keys;
+    view->key_count = key_count;
+
+    ret = table_view_sort(view);
+    table_view_send_rows(view, 0, view->row_count);
+    return ret;
+}
+
+int
+table_view_show_row(table_view_t* view, DWORD row, BOOL show)
+{
+    DWORD old_count = view->row_count;
+
+    TABLE_VIEW_TRACE("table_view_show_row(%p, %lu, %d)", view, row, show);
+
+    if(row == TABLE_HEADER) {
+        memset(view->hidden, (show ? 0x00 : 0xff),
+               TABLE_VIEW_BITMAP_SIZE(view->table_row_count));
+    } else {
+        if(MC_ERR(row >= view->table_row_count)) {
+            MC_TRACE("table_view_show_row: Row ID %lu does not exist", row);
+            SetLastError(ERROR_INVALID_PARAMETER);
+            return -1;
+        }
+
+        if(show)
+            view->hidden[row >> 5] &= ~(1U << (row & 31));
+        else
+            view->hidden[row >> 5] |= (1U << (row & 31));
+    }
+
+    table_view_reindex(view);
+    if(view->row_count != old_count)
+        table_view_send(view, TABLE_ROWCOUNT_CHANGED, old_count, view->row_count, 0, 0);
+    return 0;
+}
@@ -0,0 +1,96 @@
+/*
+ * mCtrl: Additional Win32 controls
+ * <https://github.com/mity/mctrl>
+ * <https://mctrl.org>
+ *
+ * Copyright (c) 2010-2020 Martin Mitas
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef MC_TABLEVIEW_H
+#define MC_TABLEVIEW_H
+
+#include "misc.h"
+#include "table.h"
+
+
+/* Sort and filter view over a table.
+ *
+ * The view does not copy any cell data. It only keeps an index: all the table
+ * rows in the sort order (a permutation vector), and a bitmap of the rows
+ * filtered out. The visible rows are then addressed by their position in the
+ * view ("view rows"), which are translated to the table rows on access.
+ *
+ * The view installs itself as a view of the table and keeps the index up to
+ * date: A change of a cell in a sort key column only moves the row to its new
+ * position, and inserted rows are merged into the order. The refresh events
+ * are then forwarded, with the rows translated, to the views of the view
+ * (i.e. the view is a model for them).
+ */
+
+
+/* Flags of table_sort_key_t. */
+#define TABLE_SORT_DESCENDING       0x0001
+
+typedef struct table_sort_key_tag table_sort_key_t;
+struct table_sort_key_tag {
+    DWORD col;
+    WORD flags;
+};
+
+/* table_view_t::view_rows[] of rows filtered out. */
+#define TABLE_VIEW_HIDDEN           0xffffffff
+
+typedef struct table_view_tag table_view_t;
+struct table_view_tag {
+    table_t* table;
+    table_sort_key_t* keys;     /* The most significant key first. */
+    WORD key_count;
+    DWORD row_count;            /* Count of visible rows. */
+    DWORD table_row_count;      /* Count of the table rows the index covers. */
+    size_t* order;              /* All table rows in the sort order. */
+    DWORD* positions;           /* Table row -> position in order[]. */
+    DWORD* rows;                /* View row -> table row. */
+    DWORD* view_rows;           /* Table row -> view row (or TABLE_VIEW_HIDDEN). */
+    uint32_t* hidden;           /* Bitmap of the rows filtered out. */
+    view_list_t vlist;
+};
+
+
+table_view_t* table_view_create(table_t* table);
+void table_view_destroy(table_view_t* view);
+
+/* Set the sort keys (zero keys means the rows go in the table order). Rows
+ * equal in all the keys keep their order from the table. */
+int table_view_set_sort(table_view_t* view, const table_sort_key_t* keys, WORD key_count);
+
+/* Hide or show the table row. TABLE_HEADER means all rows. */
+int table_view_show_row(table_view_t* view, DWORD row, BOOL show);
+
+static inline DWORD table_view_row(table_view_t* view, DWORD view_row)
+    { return view->rows[view_row]; }
+static inline DWORD table_view_view_row(table_view_t* view, DWORD row)
+    { return view->view_rows[row]; }
+
+static inline int
+table_view_install_view(table_view_t* view, void* v, view_refresh_t refresh)
+    { return view_list_install_view(&view->vlist, v, refresh); }
+static inline void
+table_view_uninstall_view(table_view_t* view, void* v)
+    { view_list_uninstall_view(&view->vlist, v); }
+
+
+#endif  /* MC_TABLEVIEW_H */
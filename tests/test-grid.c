@@ -8,6 +8,259 @@
 #include <mCtrl/grid.h>
 
 
+/***************
+ *** Helpers ***
+ ***************/
+
+/* Count of MC_GN_GETDISPINFO and MC_GN_GETDISPINFOEX notifications the
+ * parent has got for ordinary cells and headers. (The dead top left cell is
+ * always asked for.) */
+static LONG dispinfo_count;
+static LONG dispinfo_ex_count;
+
+/* Log of the other notifications: The code, and the row they refer to (or
+ * (DWORD) -1 if not interesting). */
+#define NOTIF_LOG_SIZE      64
+static UINT notif_codes[NOTIF_LOG_SIZE];
+static DWORD notif_rows[NOTIF_LOG_SIZE];
+static int notif_count;
+static char setdispinfo_text[32];
+
+static LRESULT CALLBACK
+parent_proc(HWND win, UINT msg, WPARAM wp, LPARAM lp)
+{
+    if(msg == WM_NOTIFY) {
+        NMHDR* hdr = (NMHDR*) lp;
+        MC_NMGDISPINFOA* info = (MC_NMGDISPINFOA*) lp;
+        MC_NMGDISPINFOEXA* info_ex = (MC_NMGDISPINFOEXA*) lp;
+        DWORD row = (DWORD) -1;
+
+        switch(hdr->code) {
+            case MC_GN_GETDISPINFOA:
+            case MC_GN_GETDISPINFOW:
+                if(info->wColumn != MC_TABLE_HEADER  ||  info->wRow != MC_TABLE_HEADER)
+                    dispinfo_count++;
+                return 0;
+
+            case MC_GN_GETDISPINFOEXA:
+            case MC_GN_GETDISPINFOEXW:
+                if(info_ex->dwColumn != MC_GHEADEREX  ||  info_ex->dwRow != MC_GHEADEREX)
+                    dispinfo_ex_count++;
+                return 0;
+
+            case MC_GN_ODCACHEHINTEX:
+                row = ((MC_NMGCACHEHINTEX*) lp)->dwRowFrom;
+                break;
+
+            case MC_GN_FOCUSEDCELLCHANGEDEX:
+                row = ((MC_NMGFOCUSEDCELLCHANGEEX*) lp)->dwNewRow;
+                break;
+
+            case MC_GN_SELECTIONCHANGEDEX:
+                row = ((MC_NMGSELECTIONCHANGEEX*) lp)->newSelection.rcExtents.dwRowFrom;
+                break;
+
+            case MC_GN_ROWHEIGHTCHANGEDEX:
+                row = ((MC_NMGCOLROWSIZECHANGEEX*) lp)->dwColumnOrRow;
+                break;
+
+            case MC_GN_BEGINLABELEDITEXA:
+            case MC_GN_ENDLABELEDITEXA:
+                row = info_ex->dwRow;
+                break;
+
+            case MC_GN_SETDISPINFOEXA:
+                row = info_ex->dwRow;
+                if(info_ex->cell.pszText != NULL) {
+                    strncpy(setdispinfo_text, info_ex->cell.pszText, sizeof(setdispinfo_text) - 1);
+                    setdispinfo_text[sizeof(setdispinfo_text) - 1] = '\0';
+                }
+                break;
+        }
+
+        if(notif_count < NOTIF_LOG_SIZE) {
+            notif_codes[notif_count] = hdr->code;
+            notif_rows[notif_count] = row;
+            notif_count++;
+        }
+
+        /* Accept the new text of edited labels. */
+        if(hdr->code == MC_GN_ENDLABELEDITA  ||  hdr->code == MC_GN_ENDLABELEDITEXA)
+            return TRUE;
+        return 0;
+    }
+
+    return DefWindowProcA(win, msg, wp, lp);
+}
+
+/* Check whether the parent has got the notification (about the row). */
+static BOOL
+got_notification(UINT code, DWORD row)
+{
+    int i;
+
+    for(i = 0; i < notif_count; i++) {
+        if(notif_codes[i] == code  &&  (row == (DWORD) -1  ||  notif_rows[i] == row))
+            return TRUE;
+    }
+    return FALSE;
+}
+
+/* Create a visible owner data grid (with a parent to get its notifications). */
+static HWND
+create_ownerdata_grid(HWND* p_parent, DWORD style)
+{
+    static const char parent_class[] = "test-grid-parent";
+    WNDCLASSA wc = { 0 };
+    HWND grid;
+
+    TEST_CHECK(mcGrid_Initialize());
+
+    wc.lpfnWndProc = parent_proc;
+    wc.hInstance = GetModuleHandle(NULL);
+    wc.lpszClassName = parent_class;
+    RegisterClassA(&wc);    /* Fails harmlessly if already registered. */
+
+    *p_parent = CreateWindowExA(WS_EX_TOOLWINDOW | WS_EX_TOPMOST, parent_class, "",
+                WS_POPUP | WS_VISIBLE, 0, 0, 600, 400, NULL, NULL,
+                GetModuleHandle(NULL), NULL);
+    if(!TEST_CHECK(*p_parent != NULL))
+        return NULL;
+
+    grid = CreateWindowExA(0, MC_WC_GRIDA, "",
+                WS_CHILD | WS_VISIBLE | MC_GS_OWNERDATA | style, 0, 0, 600, 400,
+                *p_parent, NULL, GetModuleHandle(NULL), NULL);
+    if(TEST_CHECK(grid != NULL)) {
+        TEST_CHECK(SendMessage(grid, MC_GM_RESIZE, MAKEWPARAM(10, 1000), 0) == TRUE);
+        ValidateRect(grid, NULL);
+    }
+    return grid;
+}
+
+static void
+destroy_ownerdata_grid(HWND parent)
+{
+    DestroyWindow(parent);
+    mcGrid_Terminate();
+}
+
+/* Dispatch all pending messages but WM_PAINT, so that the update region of
+ * the control can be examined. */
+static void
+pump_messages(void)
+{
+    MSG msg;
+
+    while(PeekMessage(&msg, NULL, 0, WM_PAINT - 1, PM_REMOVE)  ||
+          PeekMessage(&msg, NULL, WM_PAINT + 1, (UINT) -1, PM_REMOVE)) {
+        TranslateMessage(&msg);
+        DispatchMessage(&msg);
+    }
+}
+
+static BOOL
+is_dirty(HWND grid, int c, int r)
+{
+    RECT rect;
+    HRGN rgn;
+    BOOL dirty = FALSE;
+
+    if(!TEST_CHECK(SendMessage(grid, MC_GM_GETCELLRECT, MAKEWPARAM(c, r), (LPARAM) &rect) == TRUE))
+        return FALSE;
+
+    rgn = CreateRectRgn(0, 0, 0, 0);
+    if(GetUpdateRgn(grid, rgn, FALSE) != NULLREGION)
+        dirty = PtInRegion(rgn, (rect.left + rect.right) / 2, (rect.top + rect.bottom) / 2);
+    DeleteObject(rgn);
+    return dirty;
+}
+
+/* Same as is_dirty(), for the extended mode. */
+static BOOL
+is_dirty_ex(HWND grid, DWORD c, DWORD r)
+{
+    RECT rect;
+    HRGN rgn;
+    BOOL dirty = FALSE;
+
+    rect.left = c;
+    if(!TEST_CHECK(SendMessage(grid, MC_GM_GETCELLRECTEX, r, (LPARAM) &rect) == TRUE))
+        return FALSE;
+
+    rgn = CreateRectRgn(0, 0, 0, 0);
+    if(GetUpdateRgn(grid, rgn, FALSE) != NULLREGION)
+        dirty = PtInRegion(rgn, (rect.left + rect.right) / 2, (rect.top + rect.bottom) / 2);
+    DeleteObject(rgn);
+    return dirty;
+}
+
+/* Repaint the whole control, counting the MC_GN_GETDISPINFO[EX]
+ * notifications. */
+static void
+repaint(HWND grid)
+{
+    dispinfo_count = 0;
+    dispinfo_ex_count = 0;
+    InvalidateRect(grid, NULL, TRUE);
+    UpdateWindow(grid);
+}
+
+/* Pump the messages until the cell gets dirty, or until the timeout. */
+static BOOL
+wait_dirty(HWND grid, int c, int r, DWORD timeout)
+{
+    DWORD start = GetTickCount();
+
+    while(TRUE) {
+        pump_messages();
+        if(is_dirty(grid, c, r))
+            return TRUE;
+        if(GetTickCount() - start > timeout)
+            return FALSE;
+        Sleep(10);
+    }
+}
+
+typedef struct provider_tag provider_t;
+struct provider_tag {
+    HANDLE entered;         /* Set when the callback is called. */
+    HANDLE gate;            /* If not NULL, the callback waits for it. */
+    DWORD sleep;            /* The callback takes so long (in ms). */
+    volatile LONG calls;
+    volatile LONG running;
+    volatile LONG got_origin;   /* The cell [0, 0] has been asked for. */
+};
+
+static BOOL CALLBACK
+provider_proc(MC_NMGDISPINFOEXA* info, void* ctx)
+{
+    provider_t* p = (provider_t*) ctx;
+    char buffer[32];
+
+    InterlockedIncrement(&p->running);
+    InterlockedIncrement(&p->calls);
+    SetEvent(p->entered);
+
+    if(p->gate != NULL)
+        WaitForSingleObject(p->gate, 10000);
+    if(p->sleep > 0)
+        Sleep(p->sleep);
+
+    if(info->dwColumn == 0  &&  info->dwRow == 0)
+        InterlockedExchange(&p->got_origin, 1);
+    sprintf(buffer, "[ %lu, %lu ]", info->dwColumn, info->dwRow);
+    info->cell.pszText = buffer;
+    info->cell.dwFlags = 0;
+
+    InterlockedDecrement(&p->running);
+    return TRUE;
+}
+
+
+/******************
+ *** Unit Tests ***
+ ******************/
+
 static void
 init_test(void)
 {
@@ -15,12 +268,271 @@ init_test(void)
     mcGrid_Terminate();
 }
 
+static void
+test_provider_fetch(void)
+{
+    HWND parent;
+    HWND grid;
+    provider_t p = { 0 };
+    MC_GDATAPROVIDERA dp;
+
+    grid = create_ownerdata_grid(&parent, 0);
+    if(grid == NULL)
+        return;
+
+    /* Without a provider, the grid asks the parent. */
+    dispinfo_count = 0;
+    InvalidateRect(grid, NULL, TRUE);
+    UpdateWindow(grid);
+    TEST_CHECK(dispinfo_count > 0);
+
+    p.entered = CreateEvent(NULL, TRUE, FALSE, NULL);
+    p.gate = CreateEvent(NULL, TRUE, FALSE, NULL);
+    dp.pfnGetData = provider_proc;
+    dp.pContext = &p;
+    dp.uCacheSize = 0;
+    TEST_CHECK(SendMessage(grid, MC_GM_SETDATAPROVIDERA, 0, (LPARAM) &dp) == TRUE);
+
+    /* Painting requests the visible page from the worker thread. Until the
+     * data are there, the cells are painted empty: The grid neither waits,
+     * nor falls back to asking the parent. */
+    dispinfo_count = 0;
+    InvalidateRect(grid, NULL, TRUE);
+    UpdateWindow(grid);
+    TEST_CHECK(WaitForSingleObject(p.entered, 5000) == WAIT_OBJECT_0);
+    TEST_CHECK(dispinfo_count == 0);
+    pump_messages();
+    TEST_CHECK(!is_dirty(grid, 0, 0));
+
+    /* When the worker fetches the cells, they get repainted from the cache. */
+    SetEvent(p.gate);
+    TEST_CHECK(wait_dirty(grid, 0, 0, 5000));
+    TEST_CHECK(p.got_origin);
+    UpdateWindow(grid);
+    TEST_CHECK(dispinfo_count == 0);
+
+    /* Resetting the provider brings the parent back. */
+    TEST_CHECK(SendMessage(grid, MC_GM_SETDATAPROVIDERA, 0, 0) == TRUE);
+    InvalidateRect(grid, NULL, TRUE);
+    UpdateWindow(grid);
+    TEST_CHECK(dispinfo_count > 0);
+
+    destroy_ownerdata_grid(parent);
+    CloseHandle(p.entered);
+    CloseHandle(p.gate);
+}
+
+static void
+test_provider_destroy(void)
+{
+    HWND parent;
+    HWND grid;
+    provider_t p = { 0 };
+    MC_GDATAPROVIDERA dp;
+    LONG calls;
+
+    grid = create_ownerdata_grid(&parent, 0);
+    if(grid == NULL)
+        return;
+
+    p.entered = CreateEvent(NULL, TRUE, FALSE, NULL);
+    p.sleep = 300;
+    dp.pfnGetData = provider_proc;
+    dp.pContext = &p;
+    dp.uCacheSize = 0;
+    TEST_CHECK(SendMessage(grid, MC_GM_SETDATAPROVIDERA, 0, (LPARAM) &dp) == TRUE);
+
+    InvalidateRect(grid, NULL, TRUE);
+    UpdateWindow(grid);
+    TEST_CHECK(WaitForSingleObject(p.entered, 5000) == WAIT_OBJECT_0);
+
+    /* Destroy it while the fetch is in flight. The worker has to finish the
+     * callback and stop before the control is gone. */
+    TEST_CHECK(DestroyWindow(parent));
+    TEST_CHECK(p.running == 0);
+    calls = p.calls;
+
+    /* No more fetches, and the messages the worker may have posted are
+     * harmless. */
+    Sleep(2 * p.sleep);
+    pump_messages();
+    TEST_CHECK(p.calls == calls);
+    TEST_CHECK(!IsWindow(grid));
+
+    mcGrid_Terminate();
+    CloseHandle(p.entered);
+}
+
+
+static void
+test_resize_ex(void)
+{
+    HWND parent;
+    HWND grid;
+
+    grid = create_ownerdata_grid(&parent, 0);
+    if(grid == NULL)
+        return;
+
+    repaint(grid);
+    TEST_CHECK(dispinfo_count > 0);
+    TEST_CHECK(dispinfo_ex_count == 0);
+
+    /* A refused resize leaves the control in the normal mode. */
+    TEST_CHECK(SendMessage(grid, MC_GM_RESIZEEX, 10, (LPARAM) MC_GHEADEREX) == FALSE);
+    TEST_CHECK(SendMessage(grid, MC_GM_GETROWCOUNT, 0, 0) == 1000);
+    repaint(grid);
+    TEST_CHECK(dispinfo_count > 0);
+    TEST_CHECK(dispinfo_ex_count == 0);
+
+    /* The extended mode. */
+    TEST_CHECK(SendMessage(grid, MC_GM_RESIZEEX, 12, 100000) == TRUE);
+    TEST_CHECK(SendMessage(grid, MC_GM_GETCOLUMNCOUNT, 0, 0) == 12);
+    TEST_CHECK(SendMessage(grid, MC_GM_GETROWCOUNT, 0, 0) == 100000);
+    repaint(grid);
+    TEST_CHECK(dispinfo_count == 0);
+    TEST_CHECK(dispinfo_ex_count > 0);
+
+    /* MC_GM_RESIZE switches back. */
+    TEST_CHECK(SendMessage(grid, MC_GM_RESIZE, MAKEWPARAM(10, 1000), 0) == TRUE);
+    TEST_CHECK(SendMessage(grid, MC_GM_GETROWCOUNT, 0, 0) == 1000);
+    repaint(grid);
+    TEST_CHECK(dispinfo_count > 0);
+    TEST_CHECK(dispinfo_ex_count == 0);
+
+    destroy_ownerdata_grid(parent);
+
+    /* Not supported without MC_GS_OWNERDATA. */
+    TEST_CHECK(mcGrid_Initialize());
+    grid = CreateWindowExA(WS_EX_TOOLWINDOW, MC_WC_GRIDA, "", WS_POPUP,
+                0, 0, 600, 400, NULL, NULL, GetModuleHandle(NULL), NULL);
+    if(TEST_CHECK(grid != NULL)) {
+        TEST_CHECK(SendMessage(grid, MC_GM_RESIZEEX, 10, 100000) == FALSE);
+        DestroyWindow(grid);
+    }
+    mcGrid_Terminate();
+}
+
+static void
+test_messages_ex(void)
+{
+    HWND parent;
+    HWND grid;
+    HWND edit;
+    RECT rect;
+    RECT client;
+    MC_GHITTESTINFOEX hti;
+    MC_GRECTEX rc;
+    MC_GRECTEX rc2;
+    MC_GSELECTIONEX sel;
+    WORD col;
+
+    grid = create_ownerdata_grid(&parent, MC_GS_RECTSEL | MC_GS_FOCUSEDCELL);
+    if(grid == NULL)
+        return;
+    TEST_CHECK(SendMessage(grid, MC_GM_RESIZEEX, 12, 100000) == TRUE);
+
+    /* Scrolling to a cell beyond the 16-bit range, and the hit test. */
+    notif_count = 0;
+    TEST_CHECK(SendMessage(grid, MC_GM_ENSUREVISIBLEEX, 99999, MAKELPARAM(9, TRUE)) == TRUE);
+    rect.left = 9;
+    TEST_CHECK(SendMessage(grid, MC_GM_GETCELLRECTEX, 99999, (LPARAM) &rect) == TRUE);
+    GetClientRect(grid, &client);
+    TEST_CHECK(rect.top >= client.top  &&  rect.bottom <= client.bottom);
+    TEST_CHECK(rect.left >= client.left  &&  rect.right <= client.right);
+
+    hti.pt.x = (rect.left + rect.right) / 2;
+    hti.pt.y = (rect.top + rect.bottom) / 2;
+    TEST_CHECK(SendMessage(grid, MC_GM_HITTESTEX, 0, (LPARAM) &hti) == TRUE);
+    TEST_CHECK(hti.dwColumn == 9);
+    TEST_CHECK(hti.dwRow == 99999);
+
+    UpdateWindow(grid);
+    TEST_CHECK(got_notification(MC_GN_ODCACHEHINTEX, (DWORD) -1));
+    TEST_CHECK(!got_notification(MC_GN_ODCACHEHINT, (DWORD) -1));
+
+    /* Repainting a single cell. */
+    ValidateRect(grid, NULL);
+    rc.dwColumnFrom = 9;
+    rc.dwRowFrom = 99999;
+    rc.dwColumnTo = 10;
+    rc.dwRowTo = 100000;
+    TEST_CHECK(SendMessage(grid, MC_GM_REDRAWCELLSEX, 0, (LPARAM) &rc) == TRUE);
+    TEST_CHECK(is_dirty_ex(grid, 9, 99999));
+    TEST_CHECK(!is_dirty_ex(grid, 8, 99998));
+    rc.dwRowTo = rc.dwRowFrom;
+    TEST_CHECK(SendMessage(grid, MC_GM_REDRAWCELLSEX, 0, (LPARAM) &rc) == FALSE);
+
+    /* Focus. */
+    notif_count = 0;
+    TEST_CHECK(SendMessage(grid, MC_GM_SETFOCUSEDCELLEX, 3, 99990) == TRUE);
+    col = 0;
+    TEST_CHECK(SendMessage(grid, MC_GM_GETFOCUSEDCELLEX, (WPARAM) &col, 0) == 99990);
+    TEST_CHECK(col == 3);
+    TEST_CHECK(got_notification(MC_GN_FOCUSEDCELLCHANGINGEX, (DWORD) -1));
+    TEST_CHECK(got_notification(MC_GN_FOCUSEDCELLCHANGEDEX, 99990));
+    TEST_CHECK(!got_notification(MC_GN_FOCUSEDCELLCHANGED, (DWORD) -1));
+    TEST_CHECK(SendMessage(grid, MC_GM_SETFOCUSEDCELLEX, 3, 100000) == FALSE);
+
+    /* Selection. */
+    notif_count = 0;
+    rc.dwColumnFrom = 1;
+    rc.dwRowFrom = 70000;
+    rc.dwColumnTo = 3;
+    rc.dwRowTo = 70010;
+    sel.uDataCount = 1;
+    sel.rcData = &rc;
+    TEST_CHECK(SendMessage(grid, MC_GM_SETSELECTIONEX, 0, (LPARAM) &sel) == TRUE);
+    TEST_CHECK(got_notification(MC_GN_SELECTIONCHANGINGEX, (DWORD) -1));
+    TEST_CHECK(got_notification(MC_GN_SELECTIONCHANGEDEX, 70000));
+    TEST_CHECK(!got_notification(MC_GN_SELECTIONCHANGED, (DWORD) -1));
+
+    TEST_CHECK(SendMessage(grid, MC_GM_GETSELECTIONEX, 0, 0) == 1);
+    sel.uDataCount = 1;
+    sel.rcData = &rc2;
+    TEST_CHECK(SendMessage(grid, MC_GM_GETSELECTIONEX, 0, (LPARAM) &sel) == 1);
+    TEST_CHECK(sel.uDataCount == 1);
+    TEST_CHECK(memcmp(&rc, &rc2, sizeof(MC_GRECTEX)) == 0);
+    TEST_CHECK(sel.rcExtents.dwRowFrom == 70000  &&  sel.rcExtents.dwRowTo == 70010);
+
+    /* Row height. */
+    notif_count = 0;
+    TEST_CHECK(SendMessage(grid, MC_GM_SETROWHEIGHT, 99999, MAKELPARAM(40, 0)) == TRUE);
+    TEST_CHECK(LOWORD(SendMessage(grid, MC_GM_GETROWHEIGHT, 99999, 0)) == 40);
+    TEST_CHECK(got_notification(MC_GN_ROWHEIGHTCHANGINGEX, (DWORD) -1));
+    TEST_CHECK(got_notification(MC_GN_ROWHEIGHTCHANGEDEX, 99999));
+    TEST_CHECK(!got_notification(MC_GN_ROWHEIGHTCHANGED, (DWORD) -1));
+
+    /* Label editing. The parent maintains the data, so it gets the new text
+     * via MC_GN_SETDISPINFOEX. */
+    notif_count = 0;
+    setdispinfo_text[0] = '\0';
+    edit = (HWND) SendMessage(grid, MC_GM_EDITLABELEX, 2, 99995);
+    if(TEST_CHECK(edit != NULL)) {
+        TEST_CHECK(got_notification(MC_GN_BEGINLABELEDITEXA, 99995));
+        SetWindowTextA(edit, "foo");
+
+        /* Moving the focus ends the editing, saving the text. */
+        TEST_CHECK(SendMessage(grid, MC_GM_SETFOCUSEDCELLEX, 2, 99996) == TRUE);
+        TEST_CHECK(got_notification(MC_GN_ENDLABELEDITEXA, 99995));
+        TEST_CHECK(got_notification(MC_GN_SETDISPINFOEXA, 99995));
+        TEST_CHECK(!got_notification(MC_GN_SETDISPINFOA, (DWORD) -1));
+        TEST_CHECK(strcmp(setdispinfo_text, "foo") == 0);
+    }
+
+    destroy_ownerdata_grid(parent);
+}
+
 
 /*****************
  *** Test List ***
  *****************/
 
 TEST_LIST = {
-    { "initialization", init_test },
+    { "initialization",     init_test },
+    { "provider-fetch",     test_provider_fetch },
+    { "provider-destroy",   test_provider_destroy },
+    { "resize-ex",          test_resize_ex },
+    { "messages-ex",        test_messages_ex },
     { 0 }
 };
@@ -5,7 +5,9 @@
 
 
 #include "acutest.h"
+#include <limits.h>
 #include <windows.h>
+#include <mCtrl/grid.h>
 #include <mCtrl/table.h>
 
 
@@ -69,6 +71,158 @@ check(MC_HTABLE table, int c, int r, LPARAM lp)
         TEST_CHECK_(cell.lParam == lp, " cell [%d, %d]", c, r);
 }
 
+static void
+check_text(MC_HTABLE table, int c, int r, const char* text)
+{
+    MC_TABLECELLA cell;
+    char buffer[64];
+
+    cell.fMask = MC_TCMF_TEXT;
+    cell.pszText = buffer;
+    cell.cchTextMax = sizeof(buffer);
+
+    if(TEST_CHECK(mcTable_GetCellA(table, c, r, &cell) == TRUE)) {
+        TEST_CHECK_(strcmp(buffer, text) == 0, " cell [%d, %d]", c, r);
+        TEST_MSG("Expected: '%s'", text);
+        TEST_MSG("Produced: '%s'", buffer);
+    }
+}
+
+static BOOL
+set_text(MC_HTABLE table, int c, int r, const char* text)
+{
+    MC_TABLECELLA cell;
+
+    cell.fMask = MC_TCMF_TEXT;
+    cell.pszText = (char*) text;
+    return mcTable_SetCellA(table, c, r, &cell);
+}
+
+/* The table does not expose its refresh events directly, so we watch what
+ * a grid control showing the table invalidates. */
+static HWND
+create_grid(MC_HTABLE table)
+{
+    HWND grid;
+
+    TEST_CHECK(mcGrid_Initialize());
+    grid = CreateWindowExA(WS_EX_TOOLWINDOW | WS_EX_TOPMOST, MC_WC_GRIDA, "",
+                WS_POPUP | WS_VISIBLE, 0, 0, 600, 400, NULL, NULL,
+                GetModuleHandle(NULL), NULL);
+    if(TEST_CHECK(grid != NULL)) {
+        TEST_CHECK(SendMessage(grid, MC_GM_SETTABLE, 0, (LPARAM) table) == TRUE);
+        ValidateRect(grid, NULL);
+    }
+    return grid;
+}
+
+static void
+destroy_grid(HWND grid)
+{
+    DestroyWindow(grid);
+    mcGrid_Terminate();
+}
+
+static BOOL
+is_dirty(HWND grid, int c, int r)
+{
+    RECT rect;
+    HRGN rgn;
+    BOOL dirty = FALSE;
+
+    /* MC_GM_GETCELLRECT does not accept the header cells. The row header
+     * spans to the left of the first column. */
+    if(!TEST_CHECK(SendMessage(grid, MC_GM_GETCELLRECT,
+                MAKEWPARAM((c != MC_TABLE_HEADER ? c : 0), r), (LPARAM) &rect) == TRUE))
+        return FALSE;
+    if(c == MC_TABLE_HEADER) {
+        rect.right = rect.left;
+        rect.left = 0;
+    }
+
+    rgn = CreateRectRgn(0, 0, 0, 0);
+    if(GetUpdateRgn(grid, rgn, FALSE) != NULLREGION)
+        dirty = PtInRegion(rgn, (rect.left + rect.right) / 2, (rect.top + rect.bottom) / 2);
+    DeleteObject(rgn);
+    return dirty;
+}
+
+
+/* Value of the cell in an INT64 column, or INT_MAX for an empty one. */
+static int
+get_int(MC_HTABLE table, int c, int r)
+{
+    MC_TABLECELLA cell;
+    char buffer[32];
+
+    cell.fMask = MC_TCMF_TEXT;
+    cell.pszText = buffer;
+    cell.cchTextMax = sizeof(buffer);
+    if(!TEST_CHECK(mcTable_GetCellA(table, c, r, &cell) == TRUE))
+        return INT_MAX;
+    return (buffer[0] != '\0' ? atoi(buffer) : INT_MAX);
+}
+
+/* Check the grid presents exactly the rows not hidden, sorted (stable, empty
+ * cells last) by the column col, as a sort from scratch would do. */
+static void
+check_view(HWND grid, MC_HTABLE table, int col, BOOL desc, const BOOL* hidden)
+{
+    int row_count = mcTable_RowCount(table);
+    int* rows;
+    int* values;
+    int i, j, n;
+    MC_GSORTKEY key;
+
+    rows = (int*) malloc(row_count * sizeof(int) + 1);
+    values = (int*) malloc(row_count * sizeof(int) + 1);
+
+    /* The reference: insertion sort of the visible rows. */
+    n = 0;
+    for(i = 0; i < row_count; i++) {
+        int v;
+
+        if(hidden[i])
+            continue;
+        v = get_int(table, col, i);
+        for(j = n; j > 0; j--) {
+            int w = values[j-1];
+            if(v == INT_MAX)
+                break;
+            if(w != INT_MAX  &&  (desc ? w >= v : w <= v))
+                break;
+            rows[j] = rows[j-1];
+            values[j] = values[j-1];
+        }
+        rows[j] = i;
+        values[j] = v;
+        n++;
+    }
+
+    TEST_CHECK_(SendMessage(grid, MC_GM_GETROWCOUNT, 0, 0) == n, "row count %d", n);
+    for(i = 0; i < n; i++) {
+        TEST_CHECK_(SendMessage(grid, MC_GM_GETTABLEROW, i, 0) == rows[i],
+                    "view row %d is table row %d", i, rows[i]);
+        TEST_CHECK_(SendMessage(grid, MC_GM_GETVIEWROW, rows[i], 0) == i,
+                    "table row %d is view row %d", rows[i], i);
+    }
+    for(i = 0; i < row_count; i++) {
+        if(hidden[i])
+            TEST_CHECK_(SendMessage(grid, MC_GM_GETVIEWROW, i, 0) == (WORD) -1, "table row %d hidden", i);
+    }
+    TEST_CHECK(SendMessage(grid, MC_GM_GETTABLEROW, n, 0) == (WORD) -1);
+
+    /* Sorting again from scratch gives the same order. */
+    key.wColumn = col;
+    key.dwFlags = (desc ? MC_GSKF_DESCENDING : 0);
+    TEST_CHECK(SendMessage(grid, MC_GM_SORT, 1, (LPARAM) &key) == TRUE);
+    for(i = 0; i < n; i++)
+        TEST_CHECK_(SendMessage(grid, MC_GM_GETTABLEROW, i, 0) == rows[i], "re-sorted view row %d", i);
+
+    free(rows);
+    free(values);
+}
+
 
 /******************
  *** Unit Tests ***
@@ -219,6 +373,662 @@ test_remove_row(void)
     mcTable_Release(table);
 }
 
+static void
+test_insert_rows(void)
+{
+    MC_HTABLE table;
+
+    table = create_and_populate(4, 4);
+    TEST_CHECK(mcTable_SetColumnType(table, 2, MC_TCT_STRING) == TRUE);
+
+    TEST_CHECK(mcTable_InsertRows(table, 1, 2) == TRUE);
+    TEST_CHECK(mcTable_ColumnCount(table) == 4);
+    TEST_CHECK(mcTable_RowCount(table) == 6);
+
+    check(table, MC_TABLE_HEADER, 0, MAKELPARAM(MC_TABLE_HEADER, 0));
+    check(table, MC_TABLE_HEADER, 3, MAKELPARAM(MC_TABLE_HEADER, 1));
+    check(table, 2, MC_TABLE_HEADER, MAKELPARAM(2, MC_TABLE_HEADER));
+
+    /* The rows below have moved down. */
+    check(table, 0, 0, MAKELPARAM(0, 0));
+    check(table, 1, 3, MAKELPARAM(1, 1));
+    check(table, 3, 5, MAKELPARAM(3, 3));
+    check_text(table, 2, 4, "[ 2, 2 ]");
+
+    /* Check the new rows are zeroed. */
+    check(table, MC_TABLE_HEADER, 1, MAKELPARAM(0, 0));
+    check(table, 0, 1, MAKELPARAM(0, 0));
+    check(table, 3, 2, MAKELPARAM(0, 0));
+    check_text(table, 2, 2, "");
+
+    /* Inserting at the end appends. */
+    TEST_CHECK(mcTable_InsertRows(table, 6, 1) == TRUE);
+    TEST_CHECK(mcTable_RowCount(table) == 7);
+    check(table, 3, 5, MAKELPARAM(3, 3));
+
+    TEST_CHECK(mcTable_InsertRows(table, 8, 1) == FALSE);
+    TEST_CHECK(mcTable_InsertRows(table, 0, 0xffff - 7) == FALSE);
+    TEST_CHECK(mcTable_RowCount(table) == 7);
+
+    mcTable_Release(table);
+}
+
+static void
+test_remove_rows(void)
+{
+    MC_HTABLE table;
+
+    table = create_and_populate(4, 5);
+    TEST_CHECK(mcTable_SetColumnType(table, 2, MC_TCT_STRING) == TRUE);
+
+    TEST_CHECK(mcTable_RemoveRows(table, 1, 2) == TRUE);
+    TEST_CHECK(mcTable_ColumnCount(table) == 4);
+    TEST_CHECK(mcTable_RowCount(table) == 3);
+
+    check(table, MC_TABLE_HEADER, 0, MAKELPARAM(MC_TABLE_HEADER, 0));
+    check(table, MC_TABLE_HEADER, 1, MAKELPARAM(MC_TABLE_HEADER, 3));
+    check(table, 2, MC_TABLE_HEADER, MAKELPARAM(2, MC_TABLE_HEADER));
+
+    /* The rows below have moved up. */
+    check(table, 0, 0, MAKELPARAM(0, 0));
+    check(table, 1, 1, MAKELPARAM(1, 3));
+    check(table, 3, 2, MAKELPARAM(3, 4));
+    check_text(table, 2, 2, "[ 2, 4 ]");
+
+    TEST_CHECK(mcTable_RemoveRows(table, 2, 2) == FALSE);
+    TEST_CHECK(mcTable_RemoveRows(table, 4, 0) == FALSE);
+    TEST_CHECK(mcTable_RemoveRows(table, 0, 3) == TRUE);
+    TEST_CHECK(mcTable_RowCount(table) == 0);
+
+    mcTable_Release(table);
+}
+
+static void
+test_large_table(void)
+{
+    MC_HTABLE table;
+    MC_TABLECELLA cell;
+    char buffer[32];
+    HWND grid;
+
+    table = mcTable_CreateEx(2, 100000, 0);
+    if(!TEST_CHECK(table != NULL))
+        return;
+    TEST_CHECK(mcTable_ColumnCountEx(table) == 2);
+    TEST_CHECK(mcTable_RowCountEx(table) == 100000);
+    TEST_CHECK(mcTable_RowCount(table) == 0xffff);
+
+    /* Row 0xffff is an ordinary row for the extended functions. */
+    cell.fMask = MC_TCMF_TEXT | MC_TCMF_PARAM;
+    cell.pszText = (char*) "x";
+    cell.lParam = 1;
+    TEST_CHECK(mcTable_SetCellExA(table, 1, 0xffff, &cell) == TRUE);
+    cell.pszText = (char*) "header";
+    cell.lParam = 2;
+    TEST_CHECK(mcTable_SetCellExA(table, MC_TABLE_HEADEREX, 70000, &cell) == TRUE);
+    TEST_CHECK(mcTable_SetCellExA(table, 2, 0, &cell) == FALSE);
+    TEST_CHECK(mcTable_SetCellExA(table, 0, 100000, &cell) == FALSE);
+
+    /* The cells move with the rows. */
+    TEST_CHECK(mcTable_InsertRowsEx(table, 10, 5) == TRUE);
+    TEST_CHECK(mcTable_RemoveRowsEx(table, 0, 65000) == TRUE);
+    TEST_CHECK(mcTable_RowCountEx(table) == 100000 + 5 - 65000);
+    TEST_CHECK(mcTable_RowCount(table) == 100000 + 5 - 65000);
+    check(table, 1, 0xffff + 5 - 65000, 1);
+    check_text(table, 1, 0xffff + 5 - 65000, "x");
+    check(table, MC_TABLE_HEADER, 70000 + 5 - 65000, 2);
+
+    cell.fMask = MC_TCMF_TEXT;
+    cell.pszText = buffer;
+    cell.cchTextMax = sizeof(buffer);
+    TEST_CHECK(mcTable_GetCellExA(table, MC_TABLE_HEADEREX, 70000 + 5 - 65000, &cell) == TRUE);
+    TEST_CHECK(strcmp(buffer, "header") == 0);
+
+    /* The 16-bit functions do not grow the table beyond what they can
+     * address. */
+    TEST_CHECK(mcTable_ResizeEx(table, 2, 70000) == TRUE);
+    TEST_CHECK(mcTable_InsertRows(table, 0, 1) == FALSE);
+    TEST_CHECK(mcTable_InsertRowsEx(table, 0, 1) == TRUE);
+    TEST_CHECK(mcTable_RowCountEx(table) == 70001);
+
+    /* The grid switches to the extended mode for such table. */
+    grid = create_grid(table);
+    TEST_CHECK(SendMessage(grid, MC_GM_GETROWCOUNT, 0, 0) == 70001);
+    TEST_CHECK(SendMessage(grid, MC_GM_RESIZEEX, 2, 80000) == TRUE);
+    TEST_CHECK(mcTable_RowCountEx(table) == 80000);
+    TEST_CHECK(SendMessage(grid, MC_GM_GETROWCOUNT, 0, 0) == 80000);
+    destroy_grid(grid);
+
+    mcTable_Release(table);
+}
+
+static void
+test_intern_text(void)
+{
+    MC_HTABLE table;
+    MC_TABLECELLA cell;
+    MC_TABLEPOOLSTATS stats;
+    char buffer[32];
+    int c, r;
+
+    table = mcTable_Create(4, 4, 0);
+    TEST_CHECK(mcTable_GetPoolStats(table, &stats) == FALSE);
+    mcTable_Release(table);
+
+    table = mcTable_Create(4, 4, MC_TF_INTERNTEXT);
+    TEST_CHECK(table != NULL);
+
+    for(r = 0; r < 4; r++) {
+        for(c = 0; c < 4; c++) {
+            cell.fMask = MC_TCMF_TEXT;
+            cell.pszText = (r % 2 == 0) ? "even" : "odd";
+            TEST_CHECK(mcTable_SetCellA(table, c, r, &cell) == TRUE);
+        }
+    }
+
+    TEST_CHECK(mcTable_GetPoolStats(table, &stats) == TRUE);
+    TEST_CHECK(stats.dwStrings == 2);
+    TEST_CHECK(stats.ullLookups == 16);
+    TEST_CHECK(stats.ullHits == 14);
+
+    cell.fMask = MC_TCMF_TEXT;
+    cell.pszText = buffer;
+    cell.cchTextMax = sizeof(buffer);
+    TEST_CHECK(mcTable_GetCellA(table, 3, 2, &cell) == TRUE);
+    TEST_CHECK(strcmp(buffer, "even") == 0);
+
+    /* Removing all the "odd" rows releases the text from the pool. */
+    TEST_CHECK(mcTable_Resize(table, 4, 1) == TRUE);
+    TEST_CHECK(mcTable_GetPoolStats(table, &stats) == TRUE);
+    TEST_CHECK(stats.dwStrings == 1);
+
+    mcTable_Release(table);
+}
+
+static void
+test_type_int64(void)
+{
+    MC_HTABLE table;
+    MC_TABLECELLA cell;
+
+    table = mcTable_Create(2, 3, 0);
+    TEST_CHECK(table != NULL);
+    TEST_CHECK(mcTable_GetColumnType(table, 0) == MC_TCT_TEXT);
+
+    TEST_CHECK(set_text(table, 0, 0, "42") == TRUE);
+    TEST_CHECK(set_text(table, 0, 1, "-7") == TRUE);
+    TEST_CHECK(set_text(table, 0, 2, "9223372036854775807") == TRUE);
+    TEST_CHECK(set_text(table, 1, 0, "123") == TRUE);
+    TEST_CHECK(set_text(table, 1, 1, "abc") == TRUE);
+
+    cell.fMask = MC_TCMF_PARAM;
+    cell.lParam = 1234;
+    TEST_CHECK(mcTable_SetCellA(table, 0, 1, &cell) == TRUE);
+
+    /* Text -> INT64. */
+    TEST_CHECK(mcTable_SetColumnType(table, 0, MC_TCT_INT64) == TRUE);
+    TEST_CHECK(mcTable_GetColumnType(table, 0) == MC_TCT_INT64);
+    check_text(table, 0, 0, "42");
+    check_text(table, 0, 1, "-7");
+    check_text(table, 0, 2, "9223372036854775807");
+    check(table, 0, 1, 1234);
+
+    /* Unparsable text is refused, the column is left intact. */
+    TEST_CHECK(mcTable_SetColumnType(table, 1, MC_TCT_INT64) == FALSE);
+    TEST_CHECK(mcTable_GetColumnType(table, 1) == MC_TCT_TEXT);
+    check_text(table, 1, 0, "123");
+    check_text(table, 1, 1, "abc");
+
+    TEST_CHECK(set_text(table, 0, 0, "12x") == FALSE);
+    TEST_CHECK(set_text(table, 0, 0, "") == FALSE);
+    check_text(table, 0, 0, "42");
+    TEST_CHECK(set_text(table, 0, 0, "-9223372036854775808") == TRUE);
+    check_text(table, 0, 0, "-9223372036854775808");
+
+    /* INT64 -> text. */
+    TEST_CHECK(mcTable_SetColumnType(table, 0, MC_TCT_TEXT) == TRUE);
+    TEST_CHECK(mcTable_GetColumnType(table, 0) == MC_TCT_TEXT);
+    check_text(table, 0, 0, "-9223372036854775808");
+    check_text(table, 0, 1, "-7");
+    check(table, 0, 1, 1234);
+    TEST_CHECK(set_text(table, 0, 1, "no longer a number") == TRUE);
+
+    mcTable_Release(table);
+}
+
+static void
+test_type_double(void)
+{
+    MC_HTABLE table;
+
+    table = mcTable_Create(2, 3, 0);
+    TEST_CHECK(table != NULL);
+
+    TEST_CHECK(set_text(table, 0, 0, "0.1") == TRUE);
+    TEST_CHECK(set_text(table, 0, 1, "-2.5e10") == TRUE);
+    TEST_CHECK(set_text(table, 0, 2, "42") == TRUE);
+    TEST_CHECK(set_text(table, 1, 0, "1.5.2") == TRUE);
+
+    /* Text -> DOUBLE. The shorter "%.15g" is used where it is exact. */
+    TEST_CHECK(mcTable_SetColumnType(table, 0, MC_TCT_DOUBLE) == TRUE);
+    TEST_CHECK(mcTable_GetColumnType(table, 0) == MC_TCT_DOUBLE);
+    check_text(table, 0, 0, "0.1");
+    check_text(table, 0, 1, "-25000000000");
+    check_text(table, 0, 2, "42");
+
+    /* ... and "%.17g" where "%.15g" would not read back the same number. */
+    TEST_CHECK(set_text(table, 0, 2, "0.30000000000000004") == TRUE);
+    check_text(table, 0, 2, "0.30000000000000004");
+    TEST_CHECK(set_text(table, 0, 2, "1.0000000000000002") == TRUE);
+    check_text(table, 0, 2, "1.0000000000000002");
+
+    /* Unparsable text is refused. */
+    TEST_CHECK(mcTable_SetColumnType(table, 1, MC_TCT_DOUBLE) == FALSE);
+    TEST_CHECK(mcTable_GetColumnType(table, 1) == MC_TCT_TEXT);
+    check_text(table, 1, 0, "1.5.2");
+    TEST_CHECK(set_text(table, 0, 0, "1.5.2") == FALSE);
+    check_text(table, 0, 0, "0.1");
+
+    /* DOUBLE -> text round-trips. */
+    TEST_CHECK(mcTable_SetColumnType(table, 0, MC_TCT_TEXT) == TRUE);
+    check_text(table, 0, 0, "0.1");
+    check_text(table, 0, 2, "1.0000000000000002");
+    TEST_CHECK(mcTable_SetColumnType(table, 0, MC_TCT_DOUBLE) == TRUE);
+    check_text(table, 0, 2, "1.0000000000000002");
+
+    mcTable_Release(table);
+}
+
+static void
+test_type_refresh(void)
+{
+    MC_HTABLE table;
+    HWND grid;
+
+    table = create_and_populate(3, 3);
+    grid = create_grid(table);
+
+    TEST_CHECK(mcTable_SetColumnType(table, 1, MC_TCT_STRING) == TRUE);
+    TEST_CHECK(is_dirty(grid, 1, 0));
+    TEST_CHECK(is_dirty(grid, 1, 2));
+    TEST_CHECK(!is_dirty(grid, 0, 0));
+    TEST_CHECK(!is_dirty(grid, 2, 2));
+    ValidateRect(grid, NULL);
+
+    /* No change, no refresh. */
+    TEST_CHECK(mcTable_SetColumnType(table, 1, MC_TCT_STRING) == TRUE);
+    TEST_CHECK(!is_dirty(grid, 1, 0));
+
+    /* Failed conversion does not refresh anything either. */
+    TEST_CHECK(mcTable_SetColumnType(table, 2, MC_TCT_INT64) == FALSE);
+    TEST_CHECK(!is_dirty(grid, 2, 0));
+
+    TEST_CHECK(mcTable_SetColumnType(table, 1, MC_TCT_TEXT) == TRUE);
+    TEST_CHECK(is_dirty(grid, 1, 1));
+    check_text(table, 1, 1, "[ 1, 1 ]");
+
+    destroy_grid(grid);
+    mcTable_Release(table);
+}
+
+static void
+test_region_data(void)
+{
+    MC_HTABLE table;
+    MC_TABLECELLA cells[6];
+    char buffer[6][32];
+    int c, r, i;
+
+    table = create_and_populate(4, 4);
+
+    for(i = 0; i < 6; i++) {
+        sprintf(buffer[i], "region %d", i);
+        cells[i].fMask = MC_TCMF_TEXT | MC_TCMF_PARAM;
+        cells[i].pszText = buffer[i];
+        cells[i].lParam = 100 + i;
+    }
+
+    /* 3 columns x 2 rows, ordered row by row. */
+    TEST_CHECK(mcTable_SetRegionA(table, 1, 2, 3, 2, cells) == TRUE);
+
+    for(r = 0; r < 4; r++) {
+        for(c = 0; c < 4; c++) {
+            if(c >= 1  &&  r >= 2) {
+                i = (r - 2) * 3 + (c - 1);
+                check_text(table, c, r, buffer[i]);
+                check(table, c, r, 100 + i);
+            } else {
+                check(table, c, r, MAKELPARAM(c, r));
+            }
+        }
+    }
+
+    /* Empty region is a no-op. */
+    TEST_CHECK(mcTable_SetRegionA(table, 0, 0, 0, 0, cells) == TRUE);
+    check(table, 0, 0, MAKELPARAM(0, 0));
+
+    mcTable_Release(table);
+}
+
+static void
+test_region_invalid(void)
+{
+    MC_HTABLE table;
+    MC_TABLECELLA cells[4];
+    int i;
+
+    table = create_and_populate(4, 4);
+
+    for(i = 0; i < 4; i++) {
+        cells[i].fMask = MC_TCMF_PARAM;
+        cells[i].lParam = 100 + i;
+    }
+
+    SetLastError(0);
+    TEST_CHECK(mcTable_SetRegionA(table, 3, 0, 2, 1, cells) == FALSE);
+    TEST_CHECK(GetLastError() == ERROR_INVALID_PARAMETER);
+    TEST_CHECK(mcTable_SetRegionA(table, 0, 3, 1, 2, cells) == FALSE);
+    TEST_CHECK(mcTable_SetRegionA(table, 0xfffe, 0, 4, 1, cells) == FALSE);
+    TEST_CHECK(mcTable_SetRegionA(table, MC_TABLE_HEADER, 0, 1, 1, cells) == FALSE);
+
+    /* Nothing has been touched. */
+    check(table, 3, 0, MAKELPARAM(3, 0));
+    check(table, 0, 3, MAKELPARAM(0, 3));
+    check(table, 0, 0, MAKELPARAM(0, 0));
+
+    mcTable_Release(table);
+}
+
+static void
+test_region_partial_failure(void)
+{
+    MC_HTABLE table;
+    MC_TABLECELLA cells[4];
+    HWND grid;
+
+    table = create_and_populate(3, 3);
+    TEST_CHECK(set_text(table, 1, 0, "1") == TRUE);
+    TEST_CHECK(set_text(table, 1, 1, "2") == TRUE);
+    TEST_CHECK(set_text(table, 1, 2, "3") == TRUE);
+    TEST_CHECK(mcTable_SetColumnType(table, 1, MC_TCT_INT64) == TRUE);
+    grid = create_grid(table);
+
+    /* The last cell cannot be stored into the INT64 column. */
+    cells[0].fMask = MC_TCMF_TEXT;
+    cells[0].pszText = "a";
+    cells[1].fMask = MC_TCMF_TEXT;
+    cells[1].pszText = "10";
+    cells[2].fMask = MC_TCMF_TEXT;
+    cells[2].pszText = "b";
+    cells[3].fMask = MC_TCMF_TEXT;
+    cells[3].pszText = "not a number";
+    TEST_CHECK(mcTable_SetRegionA(table, 0, 0, 2, 2, cells) == FALSE);
+
+    /* The cells before the failed one keep their new contents... */
+    check_text(table, 0, 0, "a");
+    check_text(table, 1, 0, "10");
+    check_text(table, 0, 1, "b");
+    check_text(table, 1, 1, "2");
+
+    /* ... and are refreshed. */
+    TEST_CHECK(is_dirty(grid, 0, 0));
+    TEST_CHECK(is_dirty(grid, 1, 0));
+    TEST_CHECK(is_dirty(grid, 0, 1));
+    TEST_CHECK(!is_dirty(grid, 0, 2));
+    TEST_CHECK(!is_dirty(grid, 2, 0));
+
+    destroy_grid(grid);
+    mcTable_Release(table);
+}
+
+static void
+test_update_nested(void)
+{
+    MC_HTABLE table;
+    HWND grid;
+
+    table = create_and_populate(4, 4);
+    grid = create_grid(table);
+
+    mcTable_BeginUpdate(table);
+    mcTable_BeginUpdate(table);
+    TEST_CHECK(set_text(table, 0, 0, "x") == TRUE);
+    TEST_CHECK(set_text(table, 2, 3, "y") == TRUE);
+    TEST_CHECK(set_text(table, MC_TABLE_HEADER, 1, "row") == TRUE);
+    TEST_CHECK(!is_dirty(grid, 0, 0));
+
+    /* The inner end does not end the batch. */
+    mcTable_EndUpdate(table);
+    TEST_CHECK(!is_dirty(grid, 0, 0));
+    TEST_CHECK(!is_dirty(grid, 2, 3));
+    TEST_CHECK(!is_dirty(grid, MC_TABLE_HEADER, 1));
+
+    /* The outer end refreshes all of it at once. */
+    mcTable_EndUpdate(table);
+    TEST_CHECK(is_dirty(grid, 0, 0));
+    TEST_CHECK(is_dirty(grid, 2, 3));
+    TEST_CHECK(is_dirty(grid, MC_TABLE_HEADER, 1));
+    TEST_CHECK(!is_dirty(grid, 3, 0));
+    ValidateRect(grid, NULL);
+
+    /* An empty batch refreshes nothing. */
+    mcTable_BeginUpdate(table);
+    mcTable_EndUpdate(table);
+    TEST_CHECK(!is_dirty(grid, 0, 0));
+
+    check_text(table, 0, 0, "x");
+    check_text(table, 2, 3, "y");
+
+    destroy_grid(grid);
+    mcTable_Release(table);
+}
+
+static void
+test_update_rowcount(void)
+{
+    MC_HTABLE table;
+    HWND grid;
+
+    table = create_and_populate(4, 4);
+    grid = create_grid(table);
+
+    mcTable_BeginUpdate(table);
+    TEST_CHECK(set_text(table, 1, 3, "gone") == TRUE);
+
+    /* Changing the row count flushes the pending changes first, so nothing
+     * refers to the removed row afterwards. */
+    TEST_CHECK(mcTable_Resize(table, 4, 2) == TRUE);
+    TEST_CHECK(SendMessage(grid, MC_GM_GETROWCOUNT, 0, 0) == 2);
+    ValidateRect(grid, NULL);
+
+    TEST_CHECK(set_text(table, 0, 1, "kept") == TRUE);
+    TEST_CHECK(!is_dirty(grid, 0, 1));
+
+    mcTable_EndUpdate(table);
+    TEST_CHECK(is_dirty(grid, 0, 1));
+    TEST_CHECK(!is_dirty(grid, 1, 1));
+    TEST_CHECK(!is_dirty(grid, 1, 0));
+
+    check_text(table, 0, 1, "kept");
+    TEST_CHECK(mcTable_RowCount(table) == 2);
+
+    destroy_grid(grid);
+    mcTable_Release(table);
+}
+
+
+static void
+test_view_incremental(void)
+{
+    const int N = 50;
+    MC_HTABLE table;
+    MC_GSORTKEY key;
+    HWND grid;
+    BOOL hidden[64] = { 0 };
+    char buffer[32];
+    int r, view_row;
+
+    table = mcTable_Create(2, N, 0);
+    TEST_CHECK(table != NULL);
+    for(r = 0; r < N; r++) {
+        sprintf(buffer, "%d", (r * 7) % 13);    /* Plenty of equal keys. */
+        TEST_CHECK(set_text(table, 0, r, buffer) == TRUE);
+    }
+    TEST_CHECK(mcTable_SetColumnType(table, 0, MC_TCT_INT64) == TRUE);
+    grid = create_grid(table);
+
+    key.wColumn = 0;
+    key.dwFlags = 0;
+    TEST_CHECK(SendMessage(grid, MC_GM_SORT, 1, (LPARAM) &key) == TRUE);
+    check_view(grid, table, 0, FALSE, hidden);
+
+    /* Filter some rows out. */
+    for(r = 0; r < N; r += 5) {
+        TEST_CHECK(SendMessage(grid, MC_GM_SHOWROW, r, FALSE) == TRUE);
+        hidden[r] = TRUE;
+    }
+    check_view(grid, table, 0, FALSE, hidden);
+
+    /* Editing a key cell moves just the row (hidden or not). */
+    for(r = 0; r < N; r += 3) {
+        sprintf(buffer, "%d", 12 - (r % 17));
+        TEST_CHECK(set_text(table, 0, r, buffer) == TRUE);
+        check_view(grid, table, 0, FALSE, hidden);
+    }
+    ValidateRect(grid, NULL);
+    TEST_CHECK(set_text(table, 0, 1, "-100") == TRUE);
+    TEST_CHECK(SendMessage(grid, MC_GM_GETTABLEROW, 0, 0) == 1);
+    TEST_CHECK(is_dirty(grid, 0, 0));
+
+    /* Other columns do not affect the order. */
+    TEST_CHECK(set_text(table, 1, 1, "foo") == TRUE);
+    check_view(grid, table, 0, FALSE, hidden);
+
+    /* Appended rows are merged into the order. Their cells are empty at
+     * first, then set one by one. */
+    TEST_CHECK(mcTable_Resize(table, 2, N + 10) == TRUE);
+    check_view(grid, table, 0, FALSE, hidden);
+    for(r = N; r < N + 10; r++) {
+        sprintf(buffer, "%d", r % 4);
+        TEST_CHECK(set_text(table, 0, r, buffer) == TRUE);
+        check_view(grid, table, 0, FALSE, hidden);
+    }
+    TEST_CHECK(SendMessage(grid, MC_GM_SHOWROW, N + 1, FALSE) == TRUE);
+    hidden[N + 1] = TRUE;
+
+    /* Removing rows keeps the filter of the rest. */
+    TEST_CHECK(mcTable_Resize(table, 2, N - 7) == TRUE);
+    memset(hidden + N - 7, 0, (sizeof(hidden) / sizeof(hidden[0]) - (N - 7)) * sizeof(BOOL));
+    check_view(grid, table, 0, FALSE, hidden);
+    TEST_CHECK(mcTable_Resize(table, 2, N) == TRUE);
+    check_view(grid, table, 0, FALSE, hidden);
+
+    /* Descending. */
+    key.dwFlags = MC_GSKF_DESCENDING;
+    TEST_CHECK(SendMessage(grid, MC_GM_SORT, 1, (LPARAM) &key) == TRUE);
+    check_view(grid, table, 0, TRUE, hidden);
+    TEST_CHECK(set_text(table, 0, 2, "1000") == TRUE);
+    TEST_CHECK(SendMessage(grid, MC_GM_GETTABLEROW, 0, 0) == 2);
+    check_view(grid, table, 0, TRUE, hidden);
+
+    /* Show all the rows. */
+    TEST_CHECK(SendMessage(grid, MC_GM_SHOWROW, MC_TABLE_HEADER, TRUE) == TRUE);
+    memset(hidden, 0, sizeof(hidden));
+    check_view(grid, table, 0, TRUE, hidden);
+    TEST_CHECK(SendMessage(grid, MC_GM_SHOWROW, N, TRUE) == FALSE);
+
+    /* No keys: The table order. */
+    TEST_CHECK(SendMessage(grid, MC_GM_SORT, 0, 0) == TRUE);
+    for(r = 0; r < N; r++) {
+        view_row = (int) SendMessage(grid, MC_GM_GETVIEWROW, r, 0);
+        TEST_CHECK_(view_row == r, "row %d", r);
+    }
+
+    destroy_grid(grid);
+    mcTable_Release(table);
+}
+
+static void
+test_view_insert_remove(void)
+{
+    const int N = 40;
+    MC_HTABLE table;
+    MC_GSORTKEY key;
+    HWND grid;
+    BOOL hidden[64] = { 0 };
+    char buffer[32];
+    int r;
+
+    table = mcTable_Create(1, N, 0);
+    TEST_CHECK(table != NULL);
+    for(r = 0; r < N; r++) {
+        sprintf(buffer, "%d", (r * 11) % 7);
+        TEST_CHECK(set_text(table, 0, r, buffer) == TRUE);
+    }
+    TEST_CHECK(mcTable_SetColumnType(table, 0, MC_TCT_INT64) == TRUE);
+    grid = create_grid(table);
+
+    key.wColumn = 0;
+    key.dwFlags = 0;
+    TEST_CHECK(SendMessage(grid, MC_GM_SORT, 1, (LPARAM) &key) == TRUE);
+    for(r = 0; r < N; r += 4) {
+        TEST_CHECK(SendMessage(grid, MC_GM_SHOWROW, r, FALSE) == TRUE);
+        hidden[r] = TRUE;
+    }
+    check_view(grid, table, 0, FALSE, hidden);
+
+    /* Rows inserted in the middle are merged into the order, and the filter
+     * moves with the rows below them. */
+    TEST_CHECK(mcTable_InsertRows(table, 10, 5) == TRUE);
+    memmove(hidden + 15, hidden + 10, (N - 10) * sizeof(BOOL));
+    memset(hidden + 10, 0, 5 * sizeof(BOOL));
+    check_view(grid, table, 0, FALSE, hidden);
+    for(r = 10; r < 15; r++) {
+        sprintf(buffer, "%d", r - 12);
+        TEST_CHECK(set_text(table, 0, r, buffer) == TRUE);
+        check_view(grid, table, 0, FALSE, hidden);
+    }
+
+    TEST_CHECK(mcTable_RemoveRows(table, 3, 9) == TRUE);
+    memmove(hidden + 3, hidden + 12, (N + 5 - 12) * sizeof(BOOL));
+    memset(hidden + N + 5 - 9, 0, 9 * sizeof(BOOL));
+    check_view(grid, table, 0, FALSE, hidden);
+
+    TEST_CHECK(mcTable_RemoveRows(table, 0, 1) == TRUE);
+    memmove(hidden, hidden + 1, (N + 5 - 9 - 1) * sizeof(BOOL));
+    hidden[N + 5 - 9 - 1] = FALSE;
+    check_view(grid, table, 0, FALSE, hidden);
+
+    destroy_grid(grid);
+    mcTable_Release(table);
+}
+
+static void
+test_view_empty(void)
+{
+    MC_HTABLE table;
+    MC_GSORTKEY key = { 0, 0 };
+    HWND grid;
+
+    /* Neither sorting nor filtering may refresh an empty range. */
+    table = mcTable_Create(0, 5, 0);
+    grid = create_grid(table);
+    TEST_CHECK(SendMessage(grid, MC_GM_SORT, 0, 0) == TRUE);
+    TEST_CHECK(SendMessage(grid, MC_GM_SHOWROW, 1, FALSE) == TRUE);
+    TEST_CHECK(SendMessage(grid, MC_GM_GETROWCOUNT, 0, 0) == 4);
+    TEST_CHECK(SendMessage(grid, MC_GM_GETVIEWROW, 1, 0) == (WORD) -1);
+    destroy_grid(grid);
+    mcTable_Release(table);
+
+    table = mcTable_Create(2, 0, 0);
+    grid = create_grid(table);
+    TEST_CHECK(SendMessage(grid, MC_GM_SORT, 1, (LPARAM) &key) == TRUE);
+    TEST_CHECK(mcTable_SetColumnType(table, 0, MC_TCT_INT64) == TRUE);
+    TEST_CHECK(SendMessage(grid, MC_GM_GETROWCOUNT, 0, 0) == 0);
+    TEST_CHECK(SendMessage(grid, MC_GM_GETTABLEROW, 0, 0) == (WORD) -1);
+    destroy_grid(grid);
+    mcTable_Release(table);
+}
 
 
 /*****************
@@ -233,5 +1043,20 @@ TEST_LIST = {
     { "resize-append-column",   test_append_column },
     { "resize-append-row",      test_append_row },
     { "resize-remove-row",      test_remove_row },
+    { "insert-rows",            test_insert_rows },
+    { "remove-rows",            test_remove_rows },
+    { "large-table",            test_large_table },
+    { "intern-text",            test_intern_text },
+    { "type-int64",             test_type_int64 },
+    { "type-double",            test_type_double },
+    { "type-refresh",           test_type_refresh },
+    { "region-data",            test_region_data },
+    { "region-invalid",         test_region_invalid },
+    { "region-partial-failure", test_region_partial_failure },
+    { "update-nested",          test_update_nested },
+    { "update-rowcount",        test_update_rowcount },
+    { "view-incremental",       test_view_incremental },
+    { "view-insert-remove",     test_view_insert_remove },
+    { "view-empty",             test_view_empty },
     { 0 }
 };